@@ -0,0 +1,87 @@
+// Flash attention forward pass of one fp16 head of dimension 64, with
+// 128-query blocks iterating over 64-key blocks
+module {
+func @attention_fwd(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg2: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg3: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg4: i32 {tt.divisibility = 16 : i32}, %arg5: i32, %arg6: f32) {
+    %c0 = arith.constant 0 : index
+    %c64 = arith.constant 64 : index
+    %c64_i32 = arith.constant 64 : i32
+    %c128_i32 = arith.constant 128 : i32
+    %cst = arith.constant dense<0.000000e+00> : tensor<128x64xf32>
+    %cst_0 = arith.constant dense<0xFF800000> : tensor<128xf32>
+    %cst_1 = arith.constant dense<0.000000e+00> : tensor<128xf32>
+    %0 = tt.get_program_id {axis = 0 : i32} : i32
+    %1 = arith.muli %0, %c128_i32 : i32
+    %2 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+    %3 = tt.splat %1 : (i32) -> tensor<128xi32>
+    %4 = arith.addi %3, %2 : tensor<128xi32>
+    %5 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32>
+    // q: [128 x 64] rows of Q
+    %6 = tt.expand_dims %4 {axis = 1 : i32} : (tensor<128xi32>) -> tensor<128x1xi32>
+    %7 = tt.splat %arg4 : (i32) -> tensor<128x1xi32>
+    %8 = arith.muli %6, %7 : tensor<128x1xi32>
+    %9 = tt.expand_dims %5 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %10 = tt.broadcast %8 : (tensor<128x1xi32>) -> tensor<128x64xi32>
+    %11 = tt.broadcast %9 : (tensor<1x64xi32>) -> tensor<128x64xi32>
+    %12 = arith.addi %10, %11 : tensor<128x64xi32>
+    %13 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<128x64x!tt.ptr<f16>>
+    %14 = tt.addptr %13, %12 : tensor<128x64x!tt.ptr<f16>>, tensor<128x64xi32>
+    %15 = tt.load %14 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x64xf16>
+    // k: [64 x 64] block of K, transposed
+    %16 = tt.expand_dims %5 {axis = 0 : i32} : (tensor<64xi32>) -> tensor<1x64xi32>
+    %17 = tt.splat %arg4 : (i32) -> tensor<1x64xi32>
+    %18 = arith.muli %16, %17 : tensor<1x64xi32>
+    %19 = tt.expand_dims %5 {axis = 1 : i32} : (tensor<64xi32>) -> tensor<64x1xi32>
+    %20 = tt.broadcast %18 : (tensor<1x64xi32>) -> tensor<64x64xi32>
+    %21 = tt.broadcast %19 : (tensor<64x1xi32>) -> tensor<64x64xi32>
+    %22 = arith.addi %20, %21 : tensor<64x64xi32>
+    %23 = tt.splat %arg1 : (!tt.ptr<f16>) -> tensor<64x64x!tt.ptr<f16>>
+    %24 = tt.addptr %23, %22 : tensor<64x64x!tt.ptr<f16>>, tensor<64x64xi32>
+    // v: [64 x 64] block of V
+    %25 = tt.splat %arg4 : (i32) -> tensor<64x1xi32>
+    %26 = arith.muli %19, %25 : tensor<64x1xi32>
+    %27 = tt.broadcast %26 : (tensor<64x1xi32>) -> tensor<64x64xi32>
+    %28 = tt.broadcast %16 : (tensor<1x64xi32>) -> tensor<64x64xi32>
+    %29 = arith.addi %27, %28 : tensor<64x64xi32>
+    %30 = tt.splat %arg2 : (!tt.ptr<f16>) -> tensor<64x64x!tt.ptr<f16>>
+    %31 = tt.addptr %30, %29 : tensor<64x64x!tt.ptr<f16>>, tensor<64x64xi32>
+    %32 = arith.muli %arg4, %c64_i32 : i32
+    %33 = tt.splat %32 : (i32) -> tensor<64x64xi32>
+    %34 = tt.splat %arg6 : (f32) -> tensor<128x64xf32>
+    %35 = arith.index_cast %arg5 : i32 to index
+    %36:5 = scf.for %arg7 = %c0 to %35 step %c64 iter_args(%arg8 = %cst, %arg9 = %cst_0, %arg10 = %cst_1, %arg11 = %24, %arg12 = %31) -> (tensor<128x64xf32>, tensor<128xf32>, tensor<128xf32>, tensor<64x64x!tt.ptr<f16>>, tensor<64x64x!tt.ptr<f16>>) {
+      %k = tt.load %arg11 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xf16>
+      %qk = tt.dot %15, %k, %cst {allowTF32 = true, transA = false, transB = false} : tensor<128x64xf16> * tensor<64x64xf16> -> tensor<128x64xf32>
+      %s = arith.mulf %qk, %34 : tensor<128x64xf32>
+      // online softmax: rescale the running sums to the new row maxima
+      %m_ij = tt.reduce %s {redOp = 12 : i32, axis = 1 : i32} : tensor<128x64xf32> -> tensor<128xf32>
+      %gt = arith.cmpf ogt, %arg9, %m_ij : tensor<128xf32>
+      %m_new = select %gt, %arg9, %m_ij : tensor<128xi1>, tensor<128xf32>
+      %m_2d = tt.expand_dims %m_new {axis = 1 : i32} : (tensor<128xf32>) -> tensor<128x1xf32>
+      %m_bc = tt.broadcast %m_2d : (tensor<128x1xf32>) -> tensor<128x64xf32>
+      %s_c = arith.subf %s, %m_bc : tensor<128x64xf32>
+      %p = math.exp %s_c : tensor<128x64xf32>
+      %m_d = arith.subf %arg9, %m_new : tensor<128xf32>
+      %alpha = math.exp %m_d : tensor<128xf32>
+      %l_ij = tt.reduce %p {redOp = 2 : i32, axis = 1 : i32} : tensor<128x64xf32> -> tensor<128xf32>
+      %l_s = arith.mulf %arg10, %alpha : tensor<128xf32>
+      %l_new = arith.addf %l_s, %l_ij : tensor<128xf32>
+      %a_2d = tt.expand_dims %alpha {axis = 1 : i32} : (tensor<128xf32>) -> tensor<128x1xf32>
+      %a_bc = tt.broadcast %a_2d : (tensor<128x1xf32>) -> tensor<128x64xf32>
+      %acc = arith.mulf %arg8, %a_bc : tensor<128x64xf32>
+      %p16 = arith.truncf %p : tensor<128x64xf32> to tensor<128x64xf16>
+      %v = tt.load %arg12 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<64x64xf16>
+      %acc_new = tt.dot %p16, %v, %acc {allowTF32 = true, transA = false, transB = false} : tensor<128x64xf16> * tensor<64x64xf16> -> tensor<128x64xf32>
+      %k_next = tt.addptr %arg11, %33 : tensor<64x64x!tt.ptr<f16>>, tensor<64x64xi32>
+      %v_next = tt.addptr %arg12, %33 : tensor<64x64x!tt.ptr<f16>>, tensor<64x64xi32>
+      scf.yield %acc_new, %m_new, %l_new, %k_next, %v_next : tensor<128x64xf32>, tensor<128xf32>, tensor<128xf32>, tensor<64x64x!tt.ptr<f16>>, tensor<64x64x!tt.ptr<f16>>
+    }
+    %37 = tt.expand_dims %36#2 {axis = 1 : i32} : (tensor<128xf32>) -> tensor<128x1xf32>
+    %38 = tt.broadcast %37 : (tensor<128x1xf32>) -> tensor<128x64xf32>
+    %39 = arith.divf %36#0, %38 : tensor<128x64xf32>
+    %40 = arith.truncf %39 : tensor<128x64xf32> to tensor<128x64xf16>
+    %41 = tt.splat %arg3 : (!tt.ptr<f16>) -> tensor<128x64x!tt.ptr<f16>>
+    %42 = tt.addptr %41, %12 : tensor<128x64x!tt.ptr<f16>>, tensor<128x64xi32>
+    tt.store %42, %40 : tensor<128x64xf16>
+    return
+  }
+}
@@ -0,0 +1,49 @@
+// Layer normalization of fp16 rows of up to 1024 columns, one row per program,
+// with the statistics accumulated in fp32
+module {
+func @layer_norm_fwd(%arg0: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg2: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg3: !tt.ptr<f16> {tt.divisibility = 16 : i32}, %arg4: i32 {tt.divisibility = 16 : i32}, %arg5: i32, %arg6: f32) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<1024xf16>
+    %cst_0 = arith.constant 1.000000e+00 : f32
+    %0 = tt.get_program_id {axis = 0 : i32} : i32
+    %1 = arith.muli %0, %arg4 : i32
+    %2 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32>
+    %3 = tt.splat %arg5 : (i32) -> tensor<1024xi32>
+    %4 = arith.cmpi slt, %2, %3 : tensor<1024xi32>
+    %5 = tt.addptr %arg0, %1 : !tt.ptr<f16>, i32
+    %6 = tt.splat %5 : (!tt.ptr<f16>) -> tensor<1024x!tt.ptr<f16>>
+    %7 = tt.addptr %6, %2 : tensor<1024x!tt.ptr<f16>>, tensor<1024xi32>
+    %8 = tt.load %7, %4, %cst {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf16>
+    %9 = arith.extf %8 : tensor<1024xf16> to tensor<1024xf32>
+    %10 = arith.sitofp %arg5 : i32 to f32
+    %11 = tt.reduce %9 {redOp = 2 : i32, axis = 0 : i32} : tensor<1024xf32> -> f32
+    %12 = arith.divf %11, %10 : f32
+    %13 = arith.mulf %9, %9 : tensor<1024xf32>
+    %14 = tt.reduce %13 {redOp = 2 : i32, axis = 0 : i32} : tensor<1024xf32> -> f32
+    %15 = arith.divf %14, %10 : f32
+    %16 = arith.mulf %12, %12 : f32
+    %17 = arith.subf %15, %16 : f32
+    %18 = arith.addf %17, %arg6 : f32
+    %19 = math.sqrt %18 : f32
+    %20 = arith.divf %cst_0, %19 : f32
+    %21 = tt.splat %arg2 : (!tt.ptr<f16>) -> tensor<1024x!tt.ptr<f16>>
+    %22 = tt.addptr %21, %2 : tensor<1024x!tt.ptr<f16>>, tensor<1024xi32>
+    %23 = tt.load %22, %4, %cst {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf16>
+    %24 = arith.extf %23 : tensor<1024xf16> to tensor<1024xf32>
+    %25 = tt.splat %arg3 : (!tt.ptr<f16>) -> tensor<1024x!tt.ptr<f16>>
+    %26 = tt.addptr %25, %2 : tensor<1024x!tt.ptr<f16>>, tensor<1024xi32>
+    %27 = tt.load %26, %4, %cst {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf16>
+    %28 = arith.extf %27 : tensor<1024xf16> to tensor<1024xf32>
+    %29 = tt.splat %12 : (f32) -> tensor<1024xf32>
+    %30 = arith.subf %9, %29 : tensor<1024xf32>
+    %31 = tt.splat %20 : (f32) -> tensor<1024xf32>
+    %32 = arith.mulf %30, %31 : tensor<1024xf32>
+    %33 = arith.mulf %32, %24 : tensor<1024xf32>
+    %34 = arith.addf %33, %28 : tensor<1024xf32>
+    %35 = arith.truncf %34 : tensor<1024xf32> to tensor<1024xf16>
+    %36 = tt.addptr %arg1, %1 : !tt.ptr<f16>, i32
+    %37 = tt.splat %36 : (!tt.ptr<f16>) -> tensor<1024x!tt.ptr<f16>>
+    %38 = tt.addptr %37, %2 : tensor<1024x!tt.ptr<f16>>, tensor<1024xi32>
+    tt.store %38, %35, %4 : tensor<1024xf16>
+    return
+  }
+}
@@ -0,0 +1,27 @@
+// Row-wise softmax of fp32 rows of up to 1024 columns, one row per program
+module {
+func @softmax_kernel(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg2: i32 {tt.divisibility = 16 : i32}, %arg3: i32) {
+    %cst = arith.constant dense<0xFF800000> : tensor<1024xf32>
+    %0 = tt.get_program_id {axis = 0 : i32} : i32
+    %1 = arith.muli %0, %arg2 : i32
+    %2 = tt.addptr %arg1, %1 : !tt.ptr<f32>, i32
+    %3 = tt.make_range {end = 1024 : i32, start = 0 : i32} : tensor<1024xi32>
+    %4 = tt.splat %2 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+    %5 = tt.addptr %4, %3 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+    %6 = tt.splat %arg3 : (i32) -> tensor<1024xi32>
+    %7 = arith.cmpi slt, %3, %6 : tensor<1024xi32>
+    %8 = tt.load %5, %7, %cst {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<1024xf32>
+    %9 = tt.reduce %8 {redOp = 12 : i32, axis = 0 : i32} : tensor<1024xf32> -> f32
+    %10 = tt.splat %9 : (f32) -> tensor<1024xf32>
+    %11 = arith.subf %8, %10 : tensor<1024xf32>
+    %12 = math.exp %11 : tensor<1024xf32>
+    %13 = tt.reduce %12 {redOp = 2 : i32, axis = 0 : i32} : tensor<1024xf32> -> f32
+    %14 = tt.splat %13 : (f32) -> tensor<1024xf32>
+    %15 = arith.divf %12, %14 : tensor<1024xf32>
+    %16 = tt.addptr %arg0, %1 : !tt.ptr<f32>, i32
+    %17 = tt.splat %16 : (!tt.ptr<f32>) -> tensor<1024x!tt.ptr<f32>>
+    %18 = tt.addptr %17, %3 : tensor<1024x!tt.ptr<f32>>, tensor<1024xi32>
+    tt.store %18, %15, %7 : tensor<1024xf32>
+    return
+  }
+}
@@ -0,0 +1,212 @@
+#include "mlir/Dialect/GPU/GPUDialect.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/LLVMIR/NVVMDialect.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser.h"
+#include "mlir/Pass/PassManager.h"
+
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/Membar.h"
+#include "triton/Conversion/TritonGPUToLLVM/TritonGPUToLLVMPass.h"
+#include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "triton/Target/LLVMIR/LLVMIRTranslation.h"
+#include "triton/Target/PTX/PTXTranslation.h"
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Microbenchmarks of the passes run by compiler.py, on canned TTIR kernels.
+// Each pass is timed on the output of the passes before it, and reports the
+// number of operations it leaves in the module; the lowering to LLVM also
+// reports the number of LLVM and PTX instructions emitted, e.g.
+//
+//   triton-bench --benchmark_filter='Pipeline/' --benchmark_format=json
+//
+// Kernels are read from $TRITON_BENCH_DIR, bin/bench by default.
+
+using namespace mlir;
+
+namespace {
+
+constexpr int numWarps = 4;
+constexpr int numStages = 3;
+constexpr int computeCapability = 80;
+constexpr int ptxVersion = 74;
+
+const char *const kernels[] = {"gemm", "attention", "layernorm", "softmax"};
+
+struct Stage {
+  const char *name;
+  std::function<std::unique_ptr<Pass>()> create;
+};
+
+// The passes of ttir_to_ttgir and ttgir_to_llir, in order
+const std::vector<Stage> &getStages() {
+  static const std::vector<Stage> stages = {
+      {"ConvertTritonToTritonGPU",
+       [] { return triton::createConvertTritonToTritonGPUPass(numWarps); }},
+      {"Coalesce", [] { return createTritonGPUCoalescePass(); }},
+      {"Combine",
+       [] { return createTritonGPUCombineOpsPass(computeCapability); }},
+      {"PeelLoops", [] { return createTritonGPUPeelLoopsPass(); }},
+      {"HoistInvariantLoads",
+       [] { return createTritonGPUHoistInvariantLoadsPass(); }},
+      {"Pipeline",
+       [] {
+         return createTritonGPUPipelinePass(numStages, computeCapability);
+       }},
+      {"Prefetch", [] { return createTritonGPUPrefetchPass(); }},
+      {"CombineCleanup",
+       [] {
+         return createTritonGPUCombineOpsPass(computeCapability,
+                                              /*cleanup=*/true);
+       }},
+      {"LayoutPropagation",
+       [] { return createTritonGPULayoutPropagationPass(); }},
+      {"DecomposeConversions",
+       [] { return createTritonGPUDecomposeConversionsPass(); }},
+      {"SplitDots", [] { return createTritonGPUSplitDotsPass(); }},
+      {"ConvertTritonGPUToLLVM",
+       [] {
+         return triton::createConvertTritonGPUToLLVMPass(computeCapability);
+       }},
+  };
+  return stages;
+}
+
+MLIRContext &getContext() {
+  static MLIRContext *context = [] {
+    DialectRegistry registry;
+    registry.insert<triton::TritonDialect, triton::gpu::TritonGPUDialect,
+                    math::MathDialect, arith::ArithmeticDialect,
+                    StandardOpsDialect, scf::SCFDialect, gpu::GPUDialect,
+                    LLVM::LLVMDialect, NVVM::NVVMDialect>();
+    auto *context = new MLIRContext(registry);
+    // passes must not load dialects as they run, and a single thread gives
+    // steadier timings
+    context->loadAllAvailableDialects();
+    context->disableMultiThreading();
+    return context;
+  }();
+  return *context;
+}
+
+void runPass(ModuleOp mod, std::unique_ptr<Pass> pass) {
+  PassManager pm(mod.getContext());
+  pm.addPass(std::move(pass));
+  if (failed(pm.run(mod)))
+    llvm::report_fatal_error("pass failed");
+}
+
+// Returns `kernel` after the first `numRun` stages
+OwningOpRef<ModuleOp> loadKernel(StringRef kernel, size_t numRun) {
+  const char *dir = std::getenv("TRITON_BENCH_DIR");
+  std::string path =
+      std::string(dir ? dir : TRITON_BENCH_INPUTS) + "/" + kernel.str() +
+      ".mlir";
+  OwningOpRef<ModuleOp> mod(parseSourceFile(path, &getContext()));
+  if (!mod)
+    llvm::report_fatal_error("cannot parse " + path);
+  for (size_t i = 0; i < numRun; ++i)
+    runPass(*mod, getStages()[i].create());
+  return mod;
+}
+
+int64_t countOps(ModuleOp mod) {
+  int64_t count = 0;
+  mod.walk([&](Operation *op) { count += op->getNumRegions() == 0; });
+  return count;
+}
+
+// Times stage `stageIdx` on a fresh copy of its input at each iteration
+void benchmarkStage(benchmark::State &state, StringRef kernel,
+                    size_t stageIdx) {
+  OwningOpRef<ModuleOp> input = loadKernel(kernel, stageIdx);
+  OwningOpRef<ModuleOp> output;
+  for (auto _ : state) {
+    state.PauseTiming();
+    output = input->clone();
+    auto pass = getStages()[stageIdx].create();
+    state.ResumeTiming();
+    runPass(*output, std::move(pass));
+  }
+  state.counters["ops"] = countOps(*output);
+  if (stageIdx + 1 != getStages().size())
+    return;
+  llvm::LLVMContext llvmContext;
+  auto llvmMod = triton::translateLLVMToLLVMIR(&llvmContext, *output);
+  if (!llvmMod)
+    llvm::report_fatal_error("translation to LLVM IR failed");
+  state.counters["llvm_instructions"] = llvmMod->getInstructionCount();
+  // statements of the PTX body end with a semicolon
+  std::string ptx =
+      triton::translateLLVMIRToPTX(*llvmMod, computeCapability, ptxVersion);
+  state.counters["ptx_instructions"] =
+      std::count(ptx.begin(), ptx.end(), ';');
+}
+
+// Times the shared memory allocation and the barrier insertion, which the
+// lowering to LLVM runs first, on its input
+void benchmarkAllocation(benchmark::State &state, StringRef kernel) {
+  OwningOpRef<ModuleOp> input = loadKernel(kernel, getStages().size() - 1);
+  size_t size = 0;
+  for (auto _ : state) {
+    Allocation allocation(*input);
+    size = allocation.getSharedMemorySize();
+  }
+  state.counters["shared_bytes"] = size;
+}
+
+void benchmarkMembar(benchmark::State &state, StringRef kernel) {
+  OwningOpRef<ModuleOp> input = loadKernel(kernel, getStages().size() - 1);
+  OwningOpRef<ModuleOp> output;
+  for (auto _ : state) {
+    state.PauseTiming();
+    output = input->clone();
+    Allocation allocation(*output);
+    state.ResumeTiming();
+    MembarAnalysis membar(&allocation);
+    membar.run();
+  }
+  int64_t barriers = 0;
+  output->walk([&](gpu::BarrierOp) { ++barriers; });
+  state.counters["barriers"] = barriers;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  for (const char *kernel : kernels) {
+    for (size_t i = 0; i < getStages().size(); ++i)
+      benchmark::RegisterBenchmark(
+          (std::string(getStages()[i].name) + "/" + kernel).c_str(),
+          benchmarkStage, StringRef(kernel), i)
+          ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(
+        (std::string("Allocation/") + kernel).c_str(), benchmarkAllocation,
+        StringRef(kernel))
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark((std::string("Membar/") + kernel).c_str(),
+                                 benchmarkMembar, StringRef(kernel))
+        ->Unit(benchmark::kMicrosecond);
+  }
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
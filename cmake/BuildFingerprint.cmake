@@ -0,0 +1,26 @@
+# Writes the MD5 of the sources listed in SOURCES_FILE, relative to ROOT, and
+# of EXTRA to OUTPUT as the TRITON_BUILD_FINGERPRINT macro. OUTPUT is left
+# untouched when the fingerprint doesn't change, so that the files including
+# it are not rebuilt.
+#
+#   cmake -DROOT=<dir> -DSOURCES_FILE=<file> -DEXTRA=<string> -DOUTPUT=<file>
+#         -P BuildFingerprint.cmake
+
+file(STRINGS ${SOURCES_FILE} sources)
+list(SORT sources)
+set(hashes "${EXTRA}\n")
+foreach(source IN LISTS sources)
+  file(MD5 ${source} hash)
+  file(RELATIVE_PATH path ${ROOT} ${source})
+  string(APPEND hashes "${path} ${hash}\n")
+endforeach()
+string(MD5 fingerprint "${hashes}")
+
+set(content "#define TRITON_BUILD_FINGERPRINT \"${fingerprint}\"\n")
+set(previous "")
+if(EXISTS ${OUTPUT})
+  file(READ ${OUTPUT} previous)
+endif()
+if(NOT previous STREQUAL content)
+  file(WRITE ${OUTPUT} "${content}")
+endif()
@@ -1,6 +1,8 @@
 #ifndef TRITON_ANALYSIS_ALIAS_H
 #define TRITON_ANALYSIS_ALIAS_H
 
+#include "triton/Analysis/Allocation.h"
+
 #include "mlir/Analysis/AliasAnalysis.h"
 #include "mlir/Analysis/DataFlowAnalysis.h"
 #include "llvm/ADT/DenseSet.h"
@@ -12,12 +14,31 @@ public:
   AliasInfo() = default;
   AliasInfo(Value value) { insert(value); }
 
-  void insert(Value value) { allocs.insert(value); }
+  /// Adds `value` to the allocations aliased, of which the bytes in
+  /// `interval` (relative to the start of the allocation) are spanned. The
+  /// default interval spans the whole allocation.
+  void insert(Value value, Interval<size_t> interval = Interval<size_t>()) {
+    if (allocs.insert(value).second) {
+      intervals[value] = interval;
+      return;
+    }
+    auto &span = intervals[value];
+    span = Interval<size_t>(std::min(span.start(), interval.start()),
+                            std::max(span.end(), interval.end()));
+  }
 
   const DenseSet<Value> &getAllocs() const { return allocs; }
 
+  /// Returns the bytes of `alloc` spanned, relative to its start.
+  Interval<size_t> getInterval(Value alloc) const {
+    return intervals.lookup(alloc);
+  }
+
   bool operator==(const AliasInfo &other) const {
-    return allocs == other.allocs;
+    return allocs == other.allocs &&
+           llvm::all_of(allocs, [&](Value alloc) {
+             return getInterval(alloc) == other.getInterval(alloc);
+           });
   }
 
   /// The pessimistic value state of a value without alias
@@ -53,8 +74,24 @@ private:
   /// Therefore, v1's liveness range is the union of v3, v4, and v6
   /// v2's liveness range is the union of v4 and v5.
   DenseSet<Value> allocs;
+
+  /// The bytes of each allocation spanned: subviews (tensor.extract_slice at
+  /// constant offsets) only span their slice of the allocation, and joins span
+  /// the union of the intervals joined.
+  DenseMap<Value, Interval<size_t>> intervals;
 };
 
+/// Returns the constant of `ofr`, an offset or a size of a subview, if any.
+Optional<int64_t> getConstantOffset(OpFoldResult ofr);
+
+/// Returns the bytes of a shared tensor of type `type` spanned by its
+/// sub-tensor at `offsets` with `sizes`, relative to the start of the tensor.
+/// Rows along the fastest-varying dimension are always covered in full because
+/// swizzling permutes the elements within a row.
+Interval<size_t> getSubTensorInterval(RankedTensorType type,
+                                      ArrayRef<int64_t> offsets,
+                                      ArrayRef<int64_t> sizes);
+
 //===----------------------------------------------------------------------===//
 // Shared Memory Alias Analysis
 //===----------------------------------------------------------------------===//
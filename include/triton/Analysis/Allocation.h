@@ -16,9 +16,22 @@ namespace mlir {
 namespace triton {
 class AllocationAnalysis;
 
+/// Returns the shape of the scratch buffer of `op`, padded, which holds one
+/// replica of the tensor at a time, or all of it at once if `whole` is set.
 SmallVector<unsigned>
 getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
-                             unsigned &outVec);
+                             unsigned &outVec, bool whole = false);
+
+/// Returns the XOR swizzle of the scratch buffer of `op` under which the
+/// stores of its source layout and the loads of its destination layout are
+/// free of bank conflicts, in which case the buffer is not padded. Returns a
+/// null attribute if the buffer is padded instead.
+triton::gpu::SharedEncodingAttr
+getSwizzleForCvtLayout(triton::gpu::ConvertLayoutOp op, bool whole = false);
+
+/// Returns true if `op` converts an mma accumulator to the blocked layout of
+/// the stores it feeds, e.g. in the epilogue of a GEMM.
+bool isEpilogueCvtLayout(triton::gpu::ConvertLayoutOp op);
 
 } // namespace triton
 
@@ -75,6 +88,24 @@ public:
     return bufferSet.at(bufferId).size;
   }
 
+  /// Returns the shared memory interval allocated to the given buffer.
+  Interval<size_t> getAllocatedInterval(BufferId bufferId) const {
+    auto &buffer = bufferSet.at(bufferId);
+    return Interval<size_t>(buffer.offset, buffer.offset + buffer.size);
+  }
+
+  /// Returns the liveness range of the given buffer, expressed in the
+  /// post-order ids of the operations nested under the analyzed operation.
+  Interval<size_t> getLiveness(BufferId bufferId) const {
+    return bufferSet.at(bufferId).liveness;
+  }
+
+  /// Returns true if the given buffer is the temporary storage of an
+  /// operation rather than the storage of a value.
+  bool isScratchBuffer(BufferId bufferId) const {
+    return bufferSet.at(bufferId).kind == BufferT::BufferKind::Scratch;
+  }
+
   /// Returns the buffer id of the given value.
   /// This interface only returns the allocated buffer id.
   /// If you want to get all the buffer ids that are associated with the given
@@ -100,6 +131,18 @@ public:
     return bufferIds;
   }
 
+  /// Returns the shared memory interval of the given buffer spanned by
+  /// `value`, which only covers its slice when `value` is a subview of the
+  /// buffer at constant offsets.
+  Interval<size_t> getAliasedInterval(Value value, BufferId bufferId) const {
+    auto whole = getAllocatedInterval(bufferId);
+    auto it = aliasInterval.find({value, bufferId});
+    if (it == aliasInterval.end() || it->second.end() > whole.size())
+      return whole;
+    return Interval<size_t>(whole.start() + it->second.start(),
+                            whole.start() + it->second.end());
+  }
+
   /// Returns the scratch buffer id of the given value.
   BufferId getBufferId(Operation *operation) const {
     if (opScratch.count(operation)) {
@@ -112,6 +155,12 @@ public:
   /// Returns the size of total shared memory allocated
   size_t getSharedMemorySize() const { return sharedMemorySize; }
 
+  /// Returns true if the scratch buffer of the layout conversion `operation`
+  /// holds its whole tensor, which is then exchanged in one replica.
+  bool isStagedWhole(Operation *operation) const {
+    return wholeScratch.count(operation);
+  }
+
   bool isIntersected(BufferId lhsId, BufferId rhsId) const {
     if (lhsId == InvalidBufferId || rhsId == InvalidBufferId)
       return false;
@@ -131,17 +180,20 @@ private:
     BufferKind kind;
     BufferId id;
     size_t size;
+    /// Offsets are multiples of this number of bytes
+    size_t alignment;
     size_t offset;
+    Interval<size_t> liveness;
 
     bool operator==(const BufferT &other) const { return id == other.id; }
     bool operator<(const BufferT &other) const { return id < other.id; }
 
     BufferT() : BufferT(BufferKind::Explicit) {}
     BufferT(BufferKind kind)
-        : kind(kind), id(InvalidBufferId), size(0), offset(0) {}
-    BufferT(BufferKind kind, size_t size) : BufferT(kind, size, 0) {}
-    BufferT(BufferKind kind, size_t size, size_t offset)
-        : kind(kind), id(nextId++), size(size), offset(offset) {}
+        : kind(kind), id(InvalidBufferId), size(0), alignment(1), offset(0) {}
+    BufferT(BufferKind kind, size_t size, size_t alignment = 1)
+        : kind(kind), id(nextId++), size(size), alignment(alignment),
+          offset(0) {}
 
     bool intersects(const BufferT &other) const {
       return Interval<size_t>(offset, offset + size)
@@ -173,8 +225,11 @@ private:
     }
   }
 
-  void addAlias(Value value, Value alloc) {
-    aliasBuffer[value].insert(valueBuffer[alloc]);
+  void addAlias(Value value, Value alloc, Interval<size_t> interval) {
+    auto *buffer = valueBuffer[alloc];
+    aliasBuffer[value].insert(buffer);
+    if (buffer)
+      aliasInterval[{value, buffer->id}] = interval;
   }
 
 private:
@@ -182,7 +237,12 @@ private:
   OpScratchMapT opScratch;
   ValueBufferMapT valueBuffer;
   AliasBufferMapT aliasBuffer;
+  /// (Value, BufferId) -> bytes of the buffer aliased by the value, relative
+  /// to its start
+  DenseMap<std::pair<Value, BufferId>, Interval<size_t>> aliasInterval;
   BufferSetT bufferSet;
+  /// Layout conversions whose scratch buffer holds their whole tensor
+  DenseSet<Operation *> wholeScratch;
   size_t sharedMemorySize = 0;
 
   friend class triton::AllocationAnalysis;
@@ -19,15 +19,18 @@ namespace mlir {
 class AxisInfo {
 public:
   typedef SmallVector<int, 4> DimVectorT;
+  /// Inclusive lower and upper bounds of an integer value
+  typedef std::pair<int64_t, int64_t> RangeT;
 
 public:
   // Default constructor
   AxisInfo() : AxisInfo({}, {}, {}) {}
   // Construct contiguity info with known contiguity
   AxisInfo(DimVectorT knownContiguity, DimVectorT knownDivisibility,
-           DimVectorT knownConstancy)
+           DimVectorT knownConstancy, Optional<RangeT> knownRange = llvm::None)
       : contiguity(knownContiguity), divisibility(knownDivisibility),
-        constancy(knownConstancy), rank(contiguity.size()) {
+        constancy(knownConstancy), range(knownRange),
+        rank(contiguity.size()) {
     assert(knownDivisibility.size() == (size_t)rank);
     assert(knownConstancy.size() == (size_t)rank);
   }
@@ -42,13 +45,20 @@ public:
   int getConstancy(size_t d) const { return constancy[d]; }
   const DimVectorT &getConstancy() const { return constancy; }
 
+  const Optional<RangeT> &getRange() const { return range; }
+  void setRange(Optional<RangeT> knownRange) { range = knownRange; }
+  // True if every element is known to be non-zero (e.g., an all-true mask)
+  bool isAlwaysTrue() const {
+    return range && (range->first > 0 || range->second < 0);
+  }
+
   int getRank() const { return rank; }
 
   // Comparison
   bool operator==(const AxisInfo &other) const {
     return (contiguity == other.contiguity) &&
            (divisibility == other.divisibility) &&
-           (constancy == other.constancy);
+           (constancy == other.constancy) && (range == other.range);
   }
 
   /// The pessimistic value state of the contiguity is unknown.
@@ -57,7 +67,9 @@ public:
   }
   static AxisInfo getPessimisticValueState(Value value);
 
-  // The gcd of both arguments for each dimension
+  // The gcd of both arguments for each dimension. The range is only kept
+  // when both arguments agree on it, so that values carried by loops reach
+  // a fixpoint after a single iteration
   static AxisInfo join(const AxisInfo &lhs, const AxisInfo &rhs);
 
 private:
@@ -104,6 +116,17 @@ private:
   /// would have constancy [1, 4]
   DimVectorT constancy;
 
+  /// The _range_ information holds the smallest and
+  /// largest values taken by all the elements, when
+  /// they are known. Boolean values are zero-extended.
+  /// It is tracked through integer arithmetic so that
+  /// comparisons such as `offs < N` can be proven to
+  /// always hold when the shapes and bounds are static.
+  /// For example
+  /// [8, 9, 10, 11, 12, 13, 14, 15]
+  /// would have range [8, 15]
+  Optional<RangeT> range;
+
   // number of dimensions of the lattice
   int rank;
 };
@@ -125,6 +148,9 @@ private:
       const std::function<int(AxisInfo, AxisInfo, int)> &getDivisibility,
       const std::function<int(AxisInfo, AxisInfo, int)> &getConstancy);
 
+  Optional<AxisInfo::RangeT>
+  visitRange(Operation *op, ArrayRef<LatticeElement<AxisInfo> *> operands);
+
 public:
   using ForwardDataFlowAnalysis<AxisInfo>::ForwardDataFlowAnalysis;
 
@@ -134,9 +160,30 @@ public:
 
   unsigned getPtrVectorSize(Value ptr);
 
+  /// Returns the width of the vectors in which `ptr` can be accessed along
+  /// `axis`, given the elements each thread of its layout holds along it.
+  unsigned getPtrVectorSize(Value ptr, unsigned axis);
+
   unsigned getPtrAlignment(Value ptr);
 
+  /// Returns the number of contiguous and aligned elements of `ptr` along
+  /// `axis`.
+  unsigned getPtrAlignment(Value ptr, unsigned axis);
+
   unsigned getMaskAlignment(Value mask);
+
+  /// Returns the number of elements along `axis` sharing the same value of
+  /// `mask`.
+  unsigned getMaskAlignment(Value mask, unsigned axis);
+
+  /// Returns the number of elements along `axis` over which `mask` can only go
+  /// from true to false, such as `offsets < lengths` with contiguous offsets,
+  /// which is at least its alignment. The elements of such a group that are
+  /// masked out all follow the first one when it is not.
+  unsigned getRaggedMaskAlignment(Value mask, unsigned axis);
+
+  // True if all the elements of `mask` are provably true
+  bool isMaskAlwaysTrue(Value mask);
 };
 
 } // namespace mlir
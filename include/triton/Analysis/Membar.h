@@ -4,6 +4,9 @@
 #include "Allocation.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
+#include <map>
+#include <set>
+
 namespace mlir {
 
 class OpBuilder;
@@ -26,63 +29,92 @@ public:
   /// a shared memory read. If the temporary storage is written but not read,
   /// it is considered as the problem of the operation itself but not the membar
   /// analysis.
+  /// Accesses are tracked per byte interval: reads of subviews
+  /// (tensor.extract_slice, and the values the alias analysis derives from
+  /// them) and writes of insert_slice_async/tensor.insert_slice at static
+  /// offsets only cover the sub-tensor they touch, so that accesses to
+  /// disjoint slices of the same buffer (e.g., different stages of a
+  /// pipelined buffer) do not require a barrier.
+  /// Barriers that are not preceded by any shared memory access since the
+  /// previous barrier of the same block are removed.
   /// The following circumstances are not considered yet:
-  /// - Double buffers
-  /// - N buffers
+  /// - Slices at dynamic offsets, which cover their whole buffer
   MembarAnalysis(Allocation *allocation) : allocation(allocation) {}
 
   /// Runs the membar analysis to the given operation, inserts a barrier if
   /// necessary.
   void run();
 
+  /// Returns the barriers inserted by the last run, in insertion order.
+  ArrayRef<Operation *> getInsertedBarriers() const { return barriers; }
+
+  /// Returns the number of barriers the last run did not need, either because
+  /// the conflicting accesses touch disjoint intervals of their buffers, or
+  /// because a barrier was redundant with the previous one.
+  unsigned getNumEliminatedBarriers() const { return numEliminatedBarriers; }
+
 private:
   struct RegionInfo {
-    using BufferIdSetT = Allocation::BufferIdSetT;
+    using BufferId = Allocation::BufferId;
+    using IntervalSetT = std::set<Interval<size_t>>;
+    /// Buffer -> accessed intervals, in shared memory addresses
+    using BufferIntervalMapT = std::map<BufferId, IntervalSetT>;
 
-    BufferIdSetT syncReadBuffers;
-    BufferIdSetT syncWriteBuffers;
+    BufferIntervalMapT syncReadIntervals;
+    BufferIntervalMapT syncWriteIntervals;
 
     RegionInfo() = default;
-    RegionInfo(const BufferIdSetT &syncReadBuffers,
-               const BufferIdSetT &syncWriteBuffers)
-        : syncReadBuffers(syncReadBuffers), syncWriteBuffers(syncWriteBuffers) {
-    }
 
     /// Unions two RegionInfo objects.
     void join(const RegionInfo &other) {
-      syncReadBuffers.insert(other.syncReadBuffers.begin(),
-                             other.syncReadBuffers.end());
-      syncWriteBuffers.insert(other.syncWriteBuffers.begin(),
-                              other.syncWriteBuffers.end());
+      join(syncReadIntervals, other.syncReadIntervals);
+      join(syncWriteIntervals, other.syncWriteIntervals);
     }
 
-    /// Returns true if buffers in two RegionInfo objects are intersected.
-    bool isIntersected(const RegionInfo &other, Allocation *allocation) const {
-      return /*RAW*/ isIntersected(syncWriteBuffers, other.syncReadBuffers,
-                                   allocation) ||
+    /// Returns true if the accesses in two RegionInfo objects are intersected.
+    /// If `precise` is false, whole buffers are compared instead of the
+    /// accessed intervals.
+    bool isIntersected(const RegionInfo &other, Allocation *allocation,
+                       bool precise = true) const {
+      return /*RAW*/ isIntersected(syncWriteIntervals, other.syncReadIntervals,
+                                   allocation, precise) ||
              /*WAR*/
-             isIntersected(syncReadBuffers, other.syncWriteBuffers,
-                           allocation) ||
+             isIntersected(syncReadIntervals, other.syncWriteIntervals,
+                           allocation, precise) ||
              /*WAW*/
-             isIntersected(syncWriteBuffers, other.syncWriteBuffers,
-                           allocation);
+             isIntersected(syncWriteIntervals, other.syncWriteIntervals,
+                           allocation, precise);
     }
 
     /// Clears the buffers because a barrier is inserted.
     void sync() {
-      syncReadBuffers.clear();
-      syncWriteBuffers.clear();
+      syncReadIntervals.clear();
+      syncWriteIntervals.clear();
     }
 
   private:
-    /// Returns true if buffers in two sets are intersected.
-    bool isIntersected(const BufferIdSetT &lhs, const BufferIdSetT &rhs,
-                       Allocation *allocation) const {
-      return std::any_of(lhs.begin(), lhs.end(), [&](auto lhsId) {
-        return std::any_of(rhs.begin(), rhs.end(), [&](auto rhsId) {
-          return allocation->isIntersected(lhsId, rhsId);
-        });
-      });
+    static void join(BufferIntervalMapT &lhs, const BufferIntervalMapT &rhs) {
+      for (auto &[bufferId, intervals] : rhs)
+        lhs[bufferId].insert(intervals.begin(), intervals.end());
+    }
+
+    /// Returns true if accesses in two maps are intersected.
+    bool isIntersected(const BufferIntervalMapT &lhs,
+                       const BufferIntervalMapT &rhs, Allocation *allocation,
+                       bool precise) const {
+      for (auto &[lhsId, lhsIntervals] : lhs) {
+        for (auto &[rhsId, rhsIntervals] : rhs) {
+          if (!allocation->isIntersected(lhsId, rhsId))
+            continue;
+          if (!precise)
+            return true;
+          for (auto &lhsInterval : lhsIntervals)
+            for (auto &rhsInterval : rhsIntervals)
+              if (lhsInterval.intersects(rhsInterval))
+                return true;
+        }
+      }
+      return false;
     }
   };
 
@@ -110,8 +142,34 @@ private:
   void transfer(Operation *operation, RegionInfo *blockInfo,
                 OpBuilder *builder);
 
+  /// Returns the shared memory interval of `bufferId` read through `value`,
+  /// as given by the alias analysis.
+  Interval<size_t> getReadInterval(Value value,
+                                   Allocation::BufferId bufferId) const;
+
+  /// Returns the shared memory interval of `bufferId` written by the
+  /// insert_slice_async or tensor.insert_slice operation `op`.
+  Interval<size_t> getWriteInterval(Operation *op,
+                                    Allocation::BufferId bufferId) const;
+
+  /// Returns the shared memory interval of `bufferId` covered by the
+  /// sub-tensor of `tensor` at `offsets` with `sizes`. Unknown offsets or
+  /// sizes make it cover the whole buffer.
+  Interval<size_t> getSliceInterval(Value tensor,
+                                    ArrayRef<Optional<int64_t>> offsets,
+                                    ArrayRef<Optional<int64_t>> sizes,
+                                    Allocation::BufferId bufferId) const;
+
+  /// Removes the barriers that are not preceded by any shared memory access
+  /// since the previous barrier of the same block.
+  void removeRedundantBarriers(Operation *operation);
+
 private:
   Allocation *allocation;
+  SmallVector<Operation *> barriers;
+  /// Operations that only avoided a barrier thanks to precise intervals
+  DenseSet<Operation *> relaxedOps;
+  unsigned numEliminatedBarriers = 0;
 };
 
 } // namespace mlir
@@ -0,0 +1,34 @@
+#ifndef TRITON_ANALYSIS_SHARED_MEMORY_REPORT_H
+#define TRITON_ANALYSIS_SHARED_MEMORY_REPORT_H
+
+#include "Allocation.h"
+#include "Membar.h"
+
+#include <string>
+
+namespace mlir {
+
+//===----------------------------------------------------------------------===//
+// Shared Memory Report
+//===----------------------------------------------------------------------===//
+
+/// Returns a JSON description of the shared memory used by the operation
+/// analyzed by `allocation`, once `membar` has run on it:
+/// - "size": the total shared memory size in bytes
+/// - "buffers": the offset, size and liveness range of each buffer, and the
+///   operation that owns it
+/// - "barriers": the barriers inserted by the membar analysis, and the
+///   operation each of them guards
+/// - "eliminated_barriers": the number of barriers the membar analysis found
+///   unnecessary
+/// - "accesses": for each load from or store to a swizzled shared tensor, a
+///   static estimate of the number of wavefronts (shared memory transactions)
+///   issued by the first access of warp 0, next to the conflict-free number.
+/// Liveness ranges and operation ids are post-order ids of the operations, as
+/// numbered by the allocation analysis.
+std::string getSharedMemoryReport(const Allocation &allocation,
+                                  const MembarAnalysis &membar);
+
+} // namespace mlir
+
+#endif // TRITON_ANALYSIS_SHARED_MEMORY_REPORT_H
@@ -10,8 +10,21 @@ namespace mlir {
 
 class ReduceOpHelper {
 public:
-  explicit ReduceOpHelper(triton::ReduceOp op) : op(op) {
+  explicit ReduceOpHelper(triton::ReduceOp op)
+      : op(op.getOperation()), axis(op.axis()) {
     srcTy = op.operand().getType().cast<RankedTensorType>();
+    srcElementTypes.push_back(srcTy.getElementType());
+    // argmin/argmax also carry the index of the element
+    if (triton::ReduceOp::withIndex(op.redOp()))
+      srcElementTypes.push_back(IntegerType::get(op.getContext(), 32));
+  }
+
+  explicit ReduceOpHelper(triton::GenericReduceOp op)
+      : op(op.getOperation()), axis(op.axis()) {
+    srcTy = op.operands()[0].getType().cast<RankedTensorType>();
+    for (Value operand : op.operands())
+      srcElementTypes.push_back(
+          operand.getType().cast<RankedTensorType>().getElementType());
   }
 
   ArrayRef<int64_t> getSrcShape() { return srcTy.getShape(); }
@@ -20,6 +33,10 @@ public:
 
   bool isFastReduction();
 
+  /// Returns true if the reduced axis lives entirely within a warp, so that
+  /// the reduction needs neither shared memory nor a barrier.
+  bool isWarpSynchronous();
+
   unsigned getInterWarpSize();
 
   unsigned getIntraWarpSize();
@@ -30,11 +47,87 @@ public:
 
   SmallVector<SmallVector<unsigned>> getScratchConfigsFast();
 
+  /// Returns the offset in bytes of the buffer of each accumulated value,
+  /// followed by their total size, when each buffer holds `elems` elements.
+  /// Buffers are 8-byte aligned.
+  SmallVector<unsigned> getScratchOffsetsInBytes(unsigned elems);
+
   unsigned getScratchSizeInBytes();
 
 private:
-  triton::ReduceOp op;
+  Operation *op;
+  unsigned axis;
+  RankedTensorType srcTy{};
+  SmallVector<Type> srcElementTypes;
+};
+
+/// Describes how the elements of one axis of a blocked tensor are spread
+/// over the threads, for the lowerings that move data along that axis.
+class AxisLoweringHelper {
+public:
+  AxisLoweringHelper(RankedTensorType srcTy, unsigned axis)
+      : srcTy(srcTy), axis(axis) {}
+
+  ArrayRef<int64_t> getSrcShape() { return srcTy.getShape(); }
+
+  Attribute getSrcLayout() { return srcTy.getEncoding(); }
+
+  unsigned getAxis() { return axis; }
+
+  /// Returns true if the layout of the operand is supported by the lowering.
+  bool isSupported();
+
+  /// Returns the number of contiguous elements of the axis held by each
+  /// thread.
+  unsigned getAxisSizePerThread();
+
+  /// Returns the number of lanes of a warp holding distinct elements of the
+  /// axis.
+  unsigned getAxisNumThreadsPerWarp();
+
+  /// Returns the number of warps holding distinct elements of the axis.
+  unsigned getAxisNumWarps();
+
+  /// Returns the number of times the layout is repeated along the axis.
+  unsigned getAxisNumBlocks();
+
+protected:
   RankedTensorType srcTy{};
+  unsigned axis;
+};
+
+class ScanLoweringHelper : public AxisLoweringHelper {
+public:
+  explicit ScanLoweringHelper(triton::ScanOp op)
+      : AxisLoweringHelper(op.operand().getType().cast<RankedTensorType>(),
+                           op.axis()) {}
+
+  /// Returns the shape of the buffer holding the partial result of each warp
+  /// and block along the scanned axis: the shape of the operand with the axis
+  /// replaced by their number.
+  SmallVector<unsigned> getScratchConfig();
+
+  unsigned getScratchSizeInBytes();
+};
+
+class SortLoweringHelper : public AxisLoweringHelper {
+public:
+  explicit SortLoweringHelper(triton::SortOp op)
+      : AxisLoweringHelper(op.operand().getType().cast<RankedTensorType>(),
+                           op.axis()),
+        op(op) {}
+
+  /// Returns true if the sorted axis is spread over several warps, whose
+  /// elements are exchanged through shared memory.
+  bool isCrossWarp();
+
+  /// Returns true if only the first elements of the sorted axis are kept.
+  bool isTopK();
+
+  unsigned getScratchSizeInBytes();
+
+private:
+  triton::SortOp op;
 };
 
 bool isSharedEncoding(Value value);
@@ -43,10 +136,24 @@ bool maybeSharedAllocationOp(Operation *op);
 
 bool maybeAliasOp(Operation *op);
 
+/// Returns true if `op` multiplies f16 or bf16 activations with int8 weights,
+/// or with pairs of int4 weights packed along K.
+bool isWeightOnlyQuantizedDot(triton::DotOp op);
+
+/// Returns true if the weights of the weight-only quantized dot `op` are
+/// pairs of int4 values packed along K.
+bool isPackedInt4Dot(triton::DotOp op);
+
 bool supportMMA(triton::DotOp op, int version);
 
 bool supportMMA(Value value, int version);
 
+/// Returns true if the operands of `op`, stored in shared memory with the
+/// given orders, can be read in place by the warpgroup MMAs of `numWarps`
+/// warps.
+bool supportWGMMA(triton::DotOp op, ArrayRef<unsigned> aOrder,
+                  ArrayRef<unsigned> bOrder, int numWarps);
+
 Type getElementType(Value value);
 
 std::string getValueOperandName(Value value, AsmState &state);
@@ -77,8 +184,59 @@ SmallVector<RES_T> reorder(ArrayRef<T> input, ArrayRef<unsigned> order) {
   return result;
 }
 
-bool isMmaToDotShortcut(triton::gpu::MmaEncodingAttr &mmaLayout,
-                        triton::gpu::DotOperandEncodingAttr &dotOperandLayout);
+/// Returns whether the conversion of \p srcTy to \p dstTy reuses the
+/// accumulator fragments of mma.sync as $a fragments, in registers.
+bool isMmaToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy);
+
+/// Returns the multi-dimensional index of `linear` in `shape`, whose
+/// dimensions are ordered from the fastest to the slowest varying in `order`.
+SmallVector<unsigned> delinearize(unsigned linear, ArrayRef<unsigned> shape,
+                                  ArrayRef<unsigned> order);
+
+/// Describes a conversion between two distributed layouts that keep every
+/// element in the warp that holds it, so that it can be done with warp
+/// shuffles instead of shared memory. Register `r` of lane `l` is read from
+/// lane `laneMap(l) ^ srcLanes[r]`, where `laneMap(l)` xors `laneBits[i]` for
+/// each bit `i` set in `l`. The register read is `srcRegs[r]`, xor'ed with
+/// `regBit` when the parity of the bits of `l` in `regSelMask` is odd.
+struct WarpShuffleConversion {
+  SmallVector<unsigned> srcRegs;
+  SmallVector<unsigned> srcLanes;
+  SmallVector<unsigned> laneBits;
+  unsigned regBit = 0;
+  unsigned regSelMask = 0;
+
+  /// Returns true if every lane already holds the elements it needs, so that
+  /// the conversion only renames registers.
+  bool isRegisterPermutation() const;
+
+  /// Returns the number of 32-bit shuffles per thread.
+  unsigned getNumShuffles() const;
+};
+
+/// Returns the shuffle-based lowering of the conversion from `srcTy` to
+/// `dstTy`, if both are blocked or mma (version 2) layouts that tile the tensor
+/// without replication, and each lane needs at most two source registers for
+/// each of its destination registers.
+Optional<WarpShuffleConversion>
+getWarpShuffleConversion(RankedTensorType srcTy, RankedTensorType dstTy);
+
+/// Shared memory transactions issued by one warp-wide access, next to the
+/// number a conflict-free access of the same width would issue.
+struct SharedMemoryWavefronts {
+  unsigned wavefronts;
+  unsigned idealWavefronts;
+
+  bool isConflictFree() const { return wavefronts == idealWavefronts; }
+};
+
+/// Counts the wavefronts needed to serve `addrs`, thread `i` accessing
+/// `vecBytes` contiguous bytes from byte address `addrs[i]`. Accesses wider
+/// than a bank are split into phases of 128 bytes; within a phase, threads
+/// hitting distinct words of the same bank are serialized, while threads
+/// hitting the same word are served by a broadcast.
+SharedMemoryWavefronts countSharedMemoryWavefronts(ArrayRef<unsigned> addrs,
+                                                   unsigned vecBytes);
 
 /// Multi-root DAG topological sort.
 /// Performs a topological sort of the Operation in the `toSort` SetVector.
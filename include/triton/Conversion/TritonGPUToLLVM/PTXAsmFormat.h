@@ -5,6 +5,7 @@
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include <map>
 #include <memory>
 #include <string>
 
@@ -71,6 +72,22 @@ struct PTXInstrExecution;
 //
 // There are several derived instruction type for typical instructions, for
 // example, the PtxIOInstr for ld and st instructions.
+//
+// LLVM cannot share values across inline asm blocks, so a builder may batch
+// the instructions of several elements into a single block. A builder created
+// with `shareOperands` binds each input value once: all the operands created
+// for the same value and constraint, or for constants of the same value (a
+// pool of the immediates materialized in registers), print the same $n, e.g.
+//
+//   PTXBuilder builder(/*shareOperands=*/true);
+//   auto &st = *builder.create("st.global.b32");
+//   st(builder.newAddrOperand(ptr, "l", 0), builder.newOperand(v0, "r"))
+//       .predicate(pred);
+//   st(builder.newAddrOperand(ptr, "l", 4), builder.newOperand(v1, "r"))
+//       .predicate(pred);
+//
+// binds `ptr` and `pred` to a single operand each. Output operands are never
+// shared, and sharing is not supported with onlyAttachMLIRArgs.
 struct PTXBuilder {
   struct Operand {
     std::string constraint;
@@ -100,6 +117,9 @@ struct PTXBuilder {
     std::string dump() const;
   };
 
+  explicit PTXBuilder(bool shareOperands = false)
+      : shareOperands(shareOperands) {}
+
   template <typename INSTR = PTXInstr, typename... Args>
   INSTR *create(Args &&...args) {
     instrs.emplace_back(std::make_unique<INSTR>(this, args...));
@@ -171,6 +191,9 @@ private:
     return argArchive.back().get();
   }
 
+  // Create a new input operand bound to `value`, with its own $n.
+  Operand *newInputOperand(mlir::Value value, StringRef constraint);
+
   // Make the operands in argArchive follow the provided \param order.
   void reorderArgArchive(ArrayRef<Operand *> order) {
     assert(order.size() == argArchive.size());
@@ -195,6 +218,10 @@ protected:
   llvm::SmallVector<std::unique_ptr<PTXInstrCommon>, 2> instrs;
   llvm::SmallVector<std::unique_ptr<PTXInstrExecution>, 4> executions;
   int oprCounter{};
+
+  bool shareOperands{};
+  // (Value or constant attribute, constraint) -> shared input operand
+  std::map<std::pair<const void *, std::string>, Operand *> sharedOperands;
 };
 
 // PTX instruction common interface.
@@ -291,8 +318,9 @@ struct PTXInstrExecution {
 
   // Prefix a !predicate to the instruction.
   PTXInstrExecution &predicateNot(mlir::Value value, StringRef constraint) {
-    pred = instr->builder->newOperand(value, constraint);
-    pred->repr = [](int idx) { return "@!$" + std::to_string(idx); };
+    pred = instr->builder->newOperand(value, constraint, [](int idx) {
+      return "@!$" + std::to_string(idx);
+    });
     return *this;
   }
 
@@ -13,7 +13,9 @@ template <typename T> class OperationPass;
 namespace triton {
 
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonGPUToLLVMPass(int computeCapability = 80);
+createConvertTritonGPUToLLVMPass(int computeCapability = 80,
+                                 bool fastMath = false,
+                                 bool nativeLoadStore = false);
 
 } // namespace triton
 
@@ -11,13 +11,19 @@ template <typename T> class OperationPass;
 namespace triton {
 
 constexpr static char AttrNumWarpsName[] = "triton_gpu.num-warps";
+constexpr static char AttrThreadsPerWarpName[] = "triton_gpu.threads-per-warp";
+constexpr static char AttrNumCTAsName[] = "triton_gpu.num-ctas";
+constexpr static char AttrPidRemapName[] = "triton_gpu.pid-remap";
 
 // Create the pass with numWarps passed from cl::opt.
 std::unique_ptr<OperationPass<ModuleOp>> createConvertTritonToTritonGPUPass();
 
-// Create the pass with numWarps set explicitly.
+// Create the pass with numWarps, threadsPerWarp, numCTAs and pidRemap set
+// explicitly.
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonToTritonGPUPass(int numWarps);
+createConvertTritonToTritonGPUPass(int numWarps, int threadsPerWarp = 32,
+                                   int numCTAs = 1,
+                                   const std::string &pidRemap = "");
 
 } // namespace triton
 } // namespace mlir
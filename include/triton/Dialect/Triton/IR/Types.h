@@ -7,4 +7,19 @@
 #define GET_TYPEDEF_CLASSES
 #include "triton/Dialect/Triton/IR/Types.h.inc"
 
+namespace mlir {
+namespace triton {
+
+/// Returns true if `type` is one of the float8 types: the custom 8-bit
+/// float, or one of the E4M3 and E5M2 formats supported by the tensor cores
+/// of sm_89 and later.
+bool isFloat8(Type type);
+
+/// Returns the bit width of an integer or floating-point type, including the
+/// float8 types that are not builtin MLIR floats.
+unsigned getIntOrFloatBitWidth(Type type);
+
+} // namespace triton
+} // namespace mlir
+
 #endif // TRITON_IR_TYPES_H_
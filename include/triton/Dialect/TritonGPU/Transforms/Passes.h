@@ -4,24 +4,39 @@
 #include "mlir/Pass/Pass.h"
 
 namespace mlir {
-std::unique_ptr<Pass> createTritonGPUPipelinePass(int numStages = 2);
+std::unique_ptr<Pass> createTritonGPUPipelinePass(int numStages = 2,
+                                                  int computeCapability = 80,
+                                                  bool issueCopiesFirst = false);
 
 // TODO(Keren): prefetch pass not working yet
-std::unique_ptr<Pass> createTritonGPUPrefetchPass();
+std::unique_ptr<Pass> createTritonGPUPrefetchPass(int prefetchWidth = 0);
 
 std::unique_ptr<Pass> createTritonGPUCanonicalizeLoopsPass();
 
+std::unique_ptr<Pass> createTritonGPUPeelLoopsPass();
+
+std::unique_ptr<Pass> createTritonGPUInstrumentPass(bool automatic = false,
+                                                    int capacity = 256);
+
+std::unique_ptr<Pass> createTritonGPUHoistInvariantLoadsPass();
+
 std::unique_ptr<Pass> createTritonGPUCoalescePass();
 
 std::unique_ptr<Pass> createTritonGPUReorderInstructionsPass();
 
+std::unique_ptr<Pass> createTritonGPULayoutPropagationPass();
+
+std::unique_ptr<Pass>
+createTritonGPUScheduleInstructionsPass(int registerBudget = 192);
+
 std::unique_ptr<Pass> createTritonGPUDecomposeConversionsPass();
 
-std::unique_ptr<Pass> createTritonGPUCombineOpsPass(int computeCapability = 80);
+std::unique_ptr<Pass> createTritonGPUSplitDotsPass(int registerBudget = 192);
 
-std::unique_ptr<Pass> createTritonGPUVerifier();
+std::unique_ptr<Pass> createTritonGPUCombineOpsPass(int computeCapability = 80,
+                                                    bool cleanup = false);
 
-std::unique_ptr<Pass> createTritonGPUUpdateMmaForVoltaPass();
+std::unique_ptr<Pass> createTritonGPUVerifier();
 
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
@@ -14,6 +14,10 @@ namespace mlir {
 class ModuleOp;
 } // namespace mlir
 
+namespace triton {
+class CompileTimings;
+} // namespace triton
+
 namespace mlir {
 namespace triton {
 
@@ -22,14 +26,36 @@ void addExternalLibs(mlir::ModuleOp &module,
                      const std::vector<std::string> &names,
                      const std::vector<std::string> &paths);
 
-// Translate TritonGPU dialect to LLVMIR, return null if failed.
+// Options of the LLVM optimizations of a kernel
+struct LLVMOptions {
+  // level of the default LLVM pipeline, from 0 to 3
+  int optLevel = 3;
+  // passes of the pipeline to skip, named as in `opt -passes` (e.g., "licm")
+  // or by class (e.g., "LICMPass")
+  std::vector<std::string> disabledPasses;
+  // registers per thread the kernels may use (`.maxnreg`), 0 for no limit
+  int maxRegisters = 0;
+  // CTAs that must fit on one SM at once (`.minnctapersm`), which bounds the
+  // registers ptxas allocates per thread; 0 for no bound
+  int minBlocksPerSM = 0;
+};
+
+// Translate TritonGPU dialect to LLVMIR, return null if failed. The times of
+// the passes and of the LLVM optimizations are recorded in `timings` if any.
+// `fastMath` lowers transcendental functions to approximate instructions, and
+// `nativeLoadStore` global loads and stores to LLVM ones where possible.
 std::unique_ptr<llvm::Module>
 translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
-                           mlir::ModuleOp module, int computeCapability);
+                           mlir::ModuleOp module, int computeCapability,
+                           ::triton::CompileTimings *timings = nullptr,
+                           bool fastMath = false, bool nativeLoadStore = false,
+                           const LLVMOptions &options = LLVMOptions());
 
 // Translate mlir LLVM dialect to LLVMIR, return null if failed.
 std::unique_ptr<llvm::Module>
-translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module);
+translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
+                      ::triton::CompileTimings *timings = nullptr,
+                      const LLVMOptions &options = LLVMOptions());
 
 } // namespace triton
 } // namespace mlir
@@ -1,7 +1,9 @@
 #ifndef TRITON_TARGET_PTXTRANSLATION_H
 #define TRITON_TARGET_PTXTRANSLATION_H
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace llvm {
 class Module;
@@ -9,8 +11,25 @@ class Module;
 
 namespace triton {
 
-// Translate TritonGPU IR to PTX code.
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version);
+// Contraction of floating-point multiplications and additions into FMAs by
+// the backend: any of them (Fast), those of llvm.fmuladd only (On), or none
+// (Off)
+enum class FPContraction { Fast, On, Off };
+
+// Translate TritonGPU IR to PTX code. `fastMath` lets the backend assume no
+// NaNs, infinities and signed zeros, and use approximate divisions and square
+// roots. `optLevel` (0 to 3) is the optimization level of the code generator.
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 bool fastMath = false, int optLevel = 3,
+                                 FPContraction contraction = FPContraction::Fast);
+
+// Link the LLVM modules of several kernels into one, which translates to a
+// single PTX module with an entry point per kernel. Functions other than the
+// kernels are made internal, so that the libdevice functions linked into each
+// module don't clash. Returns null if the modules can't be linked (e.g., two
+// kernels have the same name).
+std::unique_ptr<llvm::Module>
+linkKernelModules(std::vector<std::unique_ptr<llvm::Module>> modules);
 
 } // namespace triton
 
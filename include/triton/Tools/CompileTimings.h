@@ -0,0 +1,83 @@
+#ifndef TRITON_TOOLS_COMPILETIMINGS_H
+#define TRITON_TOOLS_COMPILETIMINGS_H
+
+#include "mlir/Pass/PassInstrumentation.h"
+#include "llvm/ADT/DenseMap.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace triton {
+
+// Wall-clock times, in seconds, of the passes and stages that compile a
+// kernel, in the order in which they complete. Passes run several times in a
+// pipeline (e.g., tritongpu-combine) are recorded once per run.
+class CompileTimings {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void record(const std::string &name, double seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    records.emplace_back(name, seconds);
+  }
+
+  // Records the time elapsed since `start`
+  void record(const std::string &name, Clock::time_point start) {
+    record(name, std::chrono::duration<double>(Clock::now() - start).count());
+  }
+
+  std::vector<std::pair<std::string, double>> getRecords() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return records;
+  }
+
+private:
+  mutable std::mutex mutex;
+  std::vector<std::pair<std::string, double>> records;
+};
+
+// Records the time spent in each pass run by an MLIR pass manager, under the
+// command line argument of the pass. Passes nested in the pipelines of other
+// operations may run on several threads at once.
+class PassTimingInstrumentation : public mlir::PassInstrumentation {
+public:
+  explicit PassTimingInstrumentation(CompileTimings &timings)
+      : timings(timings) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    starts[{pass, op}] = CompileTimings::Clock::now();
+  }
+
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+    CompileTimings::Clock::time_point start;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = starts.find({pass, op});
+      if (it == starts.end())
+        return;
+      start = it->second;
+      starts.erase(it);
+    }
+    // Pipeline adaptors have no argument, their passes are recorded instead
+    if (!pass->getArgument().empty())
+      timings.record(pass->getArgument().str(), start);
+  }
+
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override {
+    runAfterPass(pass, op);
+  }
+
+private:
+  CompileTimings &timings;
+  std::mutex mutex;
+  llvm::DenseMap<std::pair<mlir::Pass *, mlir::Operation *>,
+                 CompileTimings::Clock::time_point>
+      starts;
+};
+
+} // namespace triton
+
+#endif // TRITON_TOOLS_COMPILETIMINGS_H
@@ -1,19 +1,100 @@
 #include "triton/Analysis/Alias.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
 namespace mlir {
 
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+Optional<int64_t> getConstantOffset(OpFoldResult ofr) {
+  if (auto attr = ofr.dyn_cast<Attribute>())
+    return attr.cast<IntegerAttr>().getInt();
+  APInt value;
+  if (matchPattern(ofr.get<Value>(), m_ConstantInt(&value)))
+    return value.getSExtValue();
+  return llvm::None;
+}
+
+Interval<size_t> getSubTensorInterval(RankedTensorType type,
+                                      ArrayRef<int64_t> offsets,
+                                      ArrayRef<int64_t> sizes) {
+  auto shape = type.getShape();
+  unsigned rank = shape.size();
+  auto sharedOrder = type.getEncoding().cast<SharedEncodingAttr>().getOrder();
+  // Multi-buffered tensors keep the order of a single buffer, and the buffers
+  // are stored one after the other (see AllocTensorOpConversion)
+  SmallVector<unsigned> order;
+  if (sharedOrder.size() + 1 == rank) {
+    for (auto idx : sharedOrder)
+      order.push_back(idx + 1);
+    order.push_back(0);
+  } else {
+    order.assign(sharedOrder.begin(), sharedOrder.end());
+  }
+  SmallVector<int64_t> strides(rank);
+  int64_t stride = 1;
+  for (auto idx : order) {
+    strides[idx] = stride;
+    stride *= shape[idx];
+  }
+  unsigned fastest = order[0];
+  size_t start = 0;
+  size_t end = shape[fastest];
+  for (unsigned d = 0; d < rank; ++d) {
+    if (d == fastest)
+      continue;
+    start += offsets[d] * strides[d];
+    end += (offsets[d] + sizes[d] - 1) * strides[d];
+  }
+  size_t bytes = triton::getIntOrFloatBitWidth(type.getElementType()) / 8;
+  return Interval<size_t>(start * bytes, end * bytes);
+}
+
+static size_t getSizeInBytes(Value value) {
+  auto type = value.getType().cast<RankedTensorType>();
+  return type.getNumElements() *
+         triton::getIntOrFloatBitWidth(type.getElementType()) / 8;
+}
+
+/// Returns the bytes of an allocation spanned by the subview `sliceOp` of a
+/// value that spans `interval` of it. The slice is only located when its
+/// source is stored contiguously in `interval`, and its offsets and sizes are
+/// constant.
+static Interval<size_t> getSliceInterval(tensor::ExtractSliceOp sliceOp,
+                                         Interval<size_t> interval) {
+  auto srcType = sliceOp.source().getType().cast<RankedTensorType>();
+  if (interval.size() != getSizeInBytes(sliceOp.source()))
+    return interval;
+  SmallVector<int64_t> offsets;
+  SmallVector<int64_t> sizes;
+  for (auto offset : sliceOp.getMixedOffsets()) {
+    auto value = getConstantOffset(offset);
+    if (!value)
+      return interval;
+    offsets.push_back(*value);
+  }
+  for (auto size : sliceOp.getMixedSizes()) {
+    auto value = getConstantOffset(size);
+    if (!value)
+      return interval;
+    sizes.push_back(*value);
+  }
+  auto slice = getSubTensorInterval(srcType, offsets, sizes);
+  return Interval<size_t>(interval.start() + slice.start(),
+                          interval.start() + slice.end());
+}
+
 AliasInfo AliasInfo::join(const AliasInfo &lhs, const AliasInfo &rhs) {
   if (lhs == rhs)
     return lhs;
   AliasInfo ret;
   for (auto value : lhs.allocs) {
-    ret.insert(value);
+    ret.insert(value, lhs.getInterval(value));
   }
   for (auto value : rhs.allocs) {
-    ret.insert(value);
+    ret.insert(value, rhs.getInterval(value));
   }
   return ret;
 }
@@ -25,11 +106,18 @@ ChangeResult SharedMemoryAliasAnalysis::visitOperation(
   if (maybeSharedAllocationOp(op)) {
     // These ops may allocate a new shared memory buffer.
     auto result = op->getResult(0);
-    // XXX(Keren): the following ops are always aliasing for now
-    if (isa<tensor::ExtractSliceOp, triton::TransOp>(op)) {
+    // The following ops alias their source: extract_slice only spans its
+    // slice of it
+    if (auto sliceOp = dyn_cast<tensor::ExtractSliceOp>(op)) {
       // extract_slice %src
+      auto &srcInfo = operands[0]->getValue();
+      for (auto alloc : srcInfo.getAllocs())
+        aliasInfo.insert(alloc,
+                         getSliceInterval(sliceOp, srcInfo.getInterval(alloc)));
+      pessimistic = false;
+    } else if (isa<triton::TransOp>(op)) {
       // trans %src
-      aliasInfo = AliasInfo(operands[0]->getValue());
+      aliasInfo = operands[0]->getValue();
       pessimistic = false;
     } else if (isa<tensor::InsertSliceOp, triton::gpu::InsertSliceAsyncOp>(
                    op)) {
@@ -37,8 +125,13 @@ ChangeResult SharedMemoryAliasAnalysis::visitOperation(
       // insert_slice %src into %dst[%offsets]
       aliasInfo = AliasInfo(operands[1]->getValue());
       pessimistic = false;
+    } else if (auto insertOp = dyn_cast<triton::gpu::InsertSliceTMAOp>(op)) {
+      // insert_slice_tma %desc[%coords], %dst, %index, %pred
+      aliasInfo = AliasInfo(
+          operands[insertOp.coords().size() + 1]->getValue());
+      pessimistic = false;
     } else if (isSharedEncoding(result)) {
-      aliasInfo.insert(result);
+      aliasInfo.insert(result, Interval<size_t>(0, getSizeInBytes(result)));
       pessimistic = false;
     }
   }
@@ -6,6 +6,7 @@
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
 
 #include <algorithm>
 #include <limits>
@@ -51,20 +52,18 @@ getCvtOrder(const Attribute &srcLayout, const Attribute &dstLayout) {
   return {inOrd, outOrd};
 }
 
-SmallVector<unsigned>
-getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
-                             unsigned &outVec) {
+/// Returns the shape of the region of the tensor exchanged by the threads
+/// of the CTA at each replica of `op`, or of the whole tensor if `whole` is
+/// set, before padding, along with the number of contiguous elements each
+/// thread stores and loads along outOrd[0].
+static SmallVector<unsigned>
+getRepShapeForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
+                        unsigned &outVec, bool whole = false) {
   auto srcTy = op.src().getType().cast<RankedTensorType>();
   auto dstTy = op.result().getType().cast<RankedTensorType>();
   Attribute srcLayout = srcTy.getEncoding();
   Attribute dstLayout = dstTy.getEncoding();
 
-  // MmaToDotShortcut doesn't use shared mem
-  if (auto mmaLayout = srcLayout.dyn_cast<MmaEncodingAttr>())
-    if (auto dotOperandLayout = dstLayout.dyn_cast<DotOperandEncodingAttr>())
-      if (isMmaToDotShortcut(mmaLayout, dotOperandLayout))
-        return {};
-
   assert(srcLayout && dstLayout &&
          "Unexpect layout in getScratchConfigForCvtLayout()");
   auto [inOrd, outOrd] = getCvtOrder(srcLayout, dstLayout);
@@ -81,15 +80,164 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
   auto dstShapePerCTA = getShapePerCTA(dstLayout, dstShape);
 
   unsigned rank = dstTy.getRank();
-  SmallVector<unsigned> paddedRepShape(rank);
-  unsigned pad = std::max(inVec, outVec);
+  SmallVector<unsigned> repShape(rank);
   for (unsigned d = 0; d < rank; ++d) {
-    paddedRepShape[d] =
+    repShape[d] =
         std::max(std::min<unsigned>(srcTy.getShape()[d], srcShapePerCTA[d]),
                  std::min<unsigned>(dstTy.getShape()[d], dstShapePerCTA[d]));
+    if (whole)
+      repShape[d] = std::max<unsigned>(repShape[d], dstShape[d]);
+  }
+  return repShape;
+}
+
+/// Returns the byte offsets, in the buffer of shape `repShape` (row-major
+/// along `order`) swizzled by (`swizzleVec`, `perPhase`, `maxPhase`), of the
+/// vectors of `vec` elements that the threads of the blocked tensor `type`
+/// access at each replica, in the order of processReplica. Each run of
+/// warp-size offsets is one warp-wide access.
+static SmallVector<unsigned>
+getCvtLayoutAccessOffsets(RankedTensorType type, ArrayRef<unsigned> repShape,
+                          ArrayRef<unsigned> order, unsigned vec,
+                          unsigned elemBytes, unsigned swizzleVec,
+                          unsigned perPhase, unsigned maxPhase) {
+  auto layout = type.getEncoding().cast<BlockedEncodingAttr>();
+  auto shape = type.getShape();
+  auto sizePerThread = layout.getSizePerThread();
+  auto threadsPerWarp = layout.getThreadsPerWarp();
+  auto warpsPerCTA = layout.getWarpsPerCTA();
+  auto layoutOrder = layout.getOrder();
+  auto shapePerCTA = getShapePerCTA(layout, shape);
+  unsigned warpSize = product<unsigned>(threadsPerWarp);
+  unsigned rank = shape.size();
+  SmallVector<unsigned> numCTAs(rank);
+  for (unsigned d = 0; d < rank; ++d)
+    numCTAs[d] = repShape[d] / std::min<unsigned>(shape[d], shapePerCTA[d]);
+  unsigned row = order[1];
+  unsigned col = order[0];
+  SmallVector<unsigned> offsets;
+  SmallVector<unsigned> coord(rank);
+  for (unsigned cta = 0; cta < product<unsigned>(numCTAs); ++cta)
+    for (unsigned warp = 0; warp < product<unsigned>(warpsPerCTA); ++warp)
+      for (unsigned elem = 0; elem < product<unsigned>(sizePerThread);
+           elem += vec)
+        for (unsigned lane = 0; lane < warpSize; ++lane) {
+          auto ctaId = delinearize(cta, numCTAs, layoutOrder);
+          auto warpId = delinearize(warp, warpsPerCTA, layoutOrder);
+          auto laneId = delinearize(lane, threadsPerWarp, layoutOrder);
+          auto elemId = delinearize(elem, sizePerThread, layoutOrder);
+          // Warps and lanes wrap around when the tensor is smaller than the
+          // layout, as in emitBaseIndexForBlockedLayout
+          for (unsigned d = 0; d < rank; ++d) {
+            unsigned maxWarps =
+                ceil<unsigned>(shape[d], sizePerThread[d] * threadsPerWarp[d]);
+            unsigned maxThreads = ceil<unsigned>(shape[d], sizePerThread[d]);
+            coord[d] = ((warpId[d] % maxWarps) * threadsPerWarp[d] +
+                        laneId[d] % maxThreads) *
+                           sizePerThread[d] +
+                       elemId[d] + ctaId[d] * shapePerCTA[d];
+            coord[d] %= repShape[d];
+          }
+          unsigned phase = (coord[row] / perPhase) % maxPhase;
+          unsigned colOff = ((coord[col] / swizzleVec) ^ phase) * swizzleVec +
+                            coord[col] % swizzleVec;
+          offsets.push_back((coord[row] * repShape[col] + colOff) * elemBytes);
+        }
+  return offsets;
+}
+
+/// Returns true if every warp-wide access of `offsets`, as laid out by
+/// getCvtLayoutAccessOffsets for warps of `warpSize` threads, is free of bank
+/// conflicts.
+static bool isConflictFree(ArrayRef<unsigned> offsets, unsigned vecBytes,
+                           unsigned warpSize) {
+  for (size_t i = 0; i < offsets.size(); i += warpSize) {
+    auto access = offsets.slice(i, warpSize);
+    if (!countSharedMemoryWavefronts(access, vecBytes).isConflictFree())
+      return false;
   }
+  return true;
+}
+
+/// Searches the XOR swizzles of the unpadded buffer of `op` for the smallest
+/// one under which both the stores of the source layout and the loads of the
+/// destination layout are free of bank conflicts. Returns a null attribute if
+/// there is none, or if the layouts are not 2D blocked layouts.
+static SharedEncodingAttr
+findSwizzleForCvtLayout(triton::gpu::ConvertLayoutOp op,
+                        ArrayRef<unsigned> repShape, unsigned inVec,
+                        unsigned outVec) {
+  auto srcTy = op.src().getType().cast<RankedTensorType>();
+  auto dstTy = op.result().getType().cast<RankedTensorType>();
+  auto srcLayout = srcTy.getEncoding().dyn_cast<BlockedEncodingAttr>();
+  auto dstLayout = dstTy.getEncoding().dyn_cast<BlockedEncodingAttr>();
+  if (!srcLayout || !dstLayout || repShape.size() != 2)
+    return {};
+  auto elemTy = srcTy.getElementType();
+  unsigned elemBytes =
+      elemTy.isa<triton::PointerType>()
+          ? kPtrBitWidth / 8
+          : std::max<int>(8, triton::getIntOrFloatBitWidth(elemTy)) / 8;
+  // Vectors wider than 16 bytes are split into several accesses
+  unsigned maxAccessVec = std::max<unsigned>(1, 16 / elemBytes);
+  unsigned storeVec = std::min(inVec, maxAccessVec);
+  unsigned loadVec = std::min(outVec, maxAccessVec);
+  auto outOrd = getOrder(dstLayout);
+  auto isConflictFreeSwizzle = [&](unsigned vec, unsigned perPhase,
+                                   unsigned maxPhase) {
+    auto stores = getCvtLayoutAccessOffsets(srcTy, repShape, outOrd, storeVec,
+                                            elemBytes, vec, perPhase, maxPhase);
+    auto loads = getCvtLayoutAccessOffsets(dstTy, repShape, outOrd, loadVec,
+                                           elemBytes, vec, perPhase, maxPhase);
+    return isConflictFree(stores, storeVec * elemBytes,
+                          product<unsigned>(srcLayout.getThreadsPerWarp())) &&
+           isConflictFree(loads, loadVec * elemBytes,
+                          product<unsigned>(dstLayout.getThreadsPerWarp()));
+  };
+
+  auto *ctx = op.getContext();
+  if (isConflictFreeSwizzle(1, 1, 1))
+    return SharedEncodingAttr::get(ctx, 1, 1, 1, outOrd);
+  // Swizzled vectors must not split the vectors of the threads
+  unsigned minVec = std::max(inVec, outVec);
+  unsigned rows = repShape[outOrd[1]];
+  unsigned cols = repShape[outOrd[0]];
+  for (unsigned maxPhase = 2; maxPhase * minVec <= cols; maxPhase *= 2)
+    for (unsigned vec = minVec; vec * maxPhase <= cols; vec *= 2)
+      for (unsigned perPhase = 1; perPhase * maxPhase <= rows; perPhase *= 2)
+        if (isConflictFreeSwizzle(vec, perPhase, maxPhase))
+          return SharedEncodingAttr::get(ctx, vec, perPhase, maxPhase,
+                                         outOrd);
+  return {};
+}
+
+SharedEncodingAttr getSwizzleForCvtLayout(triton::gpu::ConvertLayoutOp op,
+                                          bool whole) {
+  unsigned inVec = 0;
+  unsigned outVec = 0;
+  auto repShape = getRepShapeForCvtLayout(op, inVec, outVec, whole);
+  return findSwizzleForCvtLayout(op, repShape, inVec, outVec);
+}
+
+SmallVector<unsigned>
+getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
+                             unsigned &outVec, bool whole) {
+  auto srcTy = op.src().getType().cast<RankedTensorType>();
+  auto dstTy = op.result().getType().cast<RankedTensorType>();
+  Attribute dstLayout = dstTy.getEncoding();
+
+  // MmaToDotShortcut doesn't use shared mem
+  if (isMmaToDotShortcut(srcTy, dstTy))
+    return {};
+
+  auto paddedRepShape = getRepShapeForCvtLayout(op, inVec, outVec, whole);
+  unsigned rank = paddedRepShape.size();
   if (rank == 1)
     return paddedRepShape;
+  // A swizzle that avoids bank conflicts saves the padding
+  if (findSwizzleForCvtLayout(op, paddedRepShape, inVec, outVec))
+    return paddedRepShape;
+  unsigned pad = std::max(inVec, outVec);
   unsigned paddedDim = 1;
   if (auto dstBlockedLayout = dstLayout.dyn_cast<BlockedEncodingAttr>()) {
     paddedDim = dstBlockedLayout.getOrder()[0];
@@ -98,6 +246,21 @@ getScratchConfigForCvtLayout(triton::gpu::ConvertLayoutOp op, unsigned &inVec,
   return paddedRepShape;
 }
 
+bool isEpilogueCvtLayout(triton::gpu::ConvertLayoutOp op) {
+  auto srcTy = op.src().getType().cast<RankedTensorType>();
+  auto dstTy = op.result().getType().cast<RankedTensorType>();
+  auto mmaLayout = srcTy.getEncoding().dyn_cast<MmaEncodingAttr>();
+  // Volta accumulators are exchanged by processReplicaForMMAV1
+  if (!mmaLayout || mmaLayout.isVolta() || srcTy.getRank() != 2 ||
+      !dstTy.getEncoding().isa<BlockedEncodingAttr>())
+    return false;
+  return !op.result().use_empty() &&
+         llvm::all_of(op.result().getUsers(), [&](Operation *user) {
+           auto store = dyn_cast<triton::StoreOp>(user);
+           return store && store.value() == op.result();
+         });
+}
+
 // TODO: extend beyond scalars
 SmallVector<unsigned> getScratchConfigForAtomicRMW(triton::AtomicRMWOp op) {
   SmallVector<unsigned> smemShape;
@@ -133,9 +296,49 @@ private:
   using GraphT = DenseMap<BufferT *, DenseSet<BufferT *>>;
 
   void run() {
+    operation->walk([&](triton::DotOp dotOp) {
+      auto mmaLayout = dotOp.getResult()
+                           .getType()
+                           .cast<RankedTensorType>()
+                           .getEncoding()
+                           .dyn_cast<triton::gpu::MmaEncodingAttr>();
+      if (mmaLayout && mmaLayout.isHopper())
+        hasWGMMA = true;
+    });
     getValuesAndSizes();
     resolveLiveness();
     computeOffsets();
+    stageEpiloguesWhole();
+  }
+
+  /// Grows the scratch buffers of the epilogue conversions (see
+  /// isEpilogueCvtLayout) to hold their whole tensor when this does not
+  /// increase the shared memory of the kernel, i.e. when the buffers dead by
+  /// then (e.g., the operands of the loop of a GEMM) leave room for it. The
+  /// accumulator is then stored to shared memory, and loaded back in the
+  /// layout of its stores, in one replica rather than one per tile of the
+  /// CTA, each separated from the next by a barrier.
+  void stageEpiloguesWhole() {
+    size_t limit = allocation->sharedMemorySize;
+    operation->walk([&](triton::gpu::ConvertLayoutOp cvtLayout) {
+      auto *buffer = allocation->opScratch.lookup(cvtLayout);
+      if (!buffer || !isEpilogueCvtLayout(cvtLayout))
+        return;
+      size_t bytes = getCvtLayoutScratchBytes(cvtLayout, /*whole=*/true);
+      if (bytes <= buffer->size || bytes > limit)
+        return;
+      size_t size = buffer->size;
+      buffer->size = bytes;
+      allocation->sharedMemorySize = 0;
+      computeOffsets();
+      if (allocation->sharedMemorySize <= limit) {
+        allocation->wholeScratch.insert(cvtLayout);
+        return;
+      }
+      buffer->size = size;
+      allocation->sharedMemorySize = 0;
+      computeOffsets();
+    });
   }
 
   /// Initializes explicitly defined shared memory values for a given operation.
@@ -154,19 +357,64 @@ private:
         // Bytes could be a different value once we support padding or other
         // allocation policies.
         auto tensorType = result.getType().dyn_cast<RankedTensorType>();
-        auto bytes = tensorType.getNumElements() *
-                     tensorType.getElementTypeBitWidth() / 8;
-        allocation->addBuffer<BufferT::BufferKind::Explicit>(result, bytes);
+        auto bytes =
+            tensorType.getNumElements() *
+            triton::getIntOrFloatBitWidth(tensorType.getElementType()) / 8;
+        // The swizzling of bulk tensor copies and of the operands read by
+        // warpgroup MMAs is a function of the address bits, up to 1024-byte
+        // boundaries
+        size_t alignment = 1;
+        auto sharedLayout =
+            tensorType.getEncoding().cast<triton::gpu::SharedEncodingAttr>();
+        if (llvm::any_of(result.getUsers(),
+                         [](Operation *user) {
+                           return isa<triton::gpu::InsertSliceTMAOp>(user);
+                         }) ||
+            (hasWGMMA && sharedLayout.getMaxPhase() > 1))
+          alignment = 1024;
+        allocation->addBuffer<BufferT::BufferKind::Explicit>(result, bytes,
+                                                             alignment);
       }
     }
   }
 
+  /// Returns the bytes of the scratch buffer of `cvtLayout`, see
+  /// getScratchConfigForCvtLayout.
+  static size_t getCvtLayoutScratchBytes(triton::gpu::ConvertLayoutOp cvtLayout,
+                                         bool whole) {
+    unsigned inVec = 0;
+    unsigned outVec = 0;
+    auto smemShape =
+        getScratchConfigForCvtLayout(cvtLayout, inVec, outVec, whole);
+    unsigned elems = std::accumulate(smemShape.begin(), smemShape.end(), 1,
+                                     std::multiplies{});
+    auto elemTy =
+        cvtLayout.src().getType().cast<RankedTensorType>().getElementType();
+    return elemTy.isa<triton::PointerType>()
+               ? elems * kPtrBitWidth / 8
+               : elems *
+                     std::max<int>(8, triton::getIntOrFloatBitWidth(elemTy)) /
+                     8;
+  }
+
   /// Initializes temporary shared memory for a given operation.
   void getScratchValueSize(Operation *op) {
     if (auto reduceOp = dyn_cast<triton::ReduceOp>(op)) {
       ReduceOpHelper helper(reduceOp);
       unsigned bytes = helper.getScratchSizeInBytes();
       allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (auto reduceOp = dyn_cast<triton::GenericReduceOp>(op)) {
+      ReduceOpHelper helper(reduceOp);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (auto scanOp = dyn_cast<triton::ScanOp>(op)) {
+      ScanLoweringHelper helper(scanOp);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+    } else if (auto sortOp = dyn_cast<triton::SortOp>(op)) {
+      SortLoweringHelper helper(sortOp);
+      unsigned bytes = helper.getScratchSizeInBytes();
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
     } else if (auto cvtLayout = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
       auto srcTy = cvtLayout.src().getType().cast<RankedTensorType>();
       auto dstTy = cvtLayout.result().getType().cast<RankedTensorType>();
@@ -178,19 +426,14 @@ private:
         return;
       }
       // ConvertLayoutOp with both input/output non-shared_layout
-      // TODO: Besides of implementing ConvertLayoutOp via shared memory, it's
-      //       also possible to realize it with other approaches in restricted
-      //       conditions, such as warp-shuffle
-      unsigned inVec = 0;
-      unsigned outVec = 0;
-      auto smemShape = getScratchConfigForCvtLayout(cvtLayout, inVec, outVec);
-      unsigned elems = std::accumulate(smemShape.begin(), smemShape.end(), 1,
-                                       std::multiplies{});
-      auto bytes =
-          srcTy.getElementType().isa<triton::PointerType>()
-              ? elems * kPtrBitWidth / 8
-              : elems * std::max<int>(8, srcTy.getElementTypeBitWidth()) / 8;
-      allocation->addBuffer<BufferT::BufferKind::Scratch>(op, bytes);
+      // Conversions that keep every element in its warp are done with warp
+      // shuffles, without shared memory.
+      if (getWarpShuffleConversion(srcTy, dstTy))
+        return;
+      // The rows stored by stmatrix in the epilogue are 16-byte aligned
+      size_t alignment = isEpilogueCvtLayout(cvtLayout) ? 16 : 1;
+      allocation->addBuffer<BufferT::BufferKind::Scratch>(
+          op, getCvtLayoutScratchBytes(cvtLayout, /*whole=*/false), alignment);
     } else if (auto atomicRMWOp = dyn_cast<triton::AtomicRMWOp>(op)) {
       auto value = op->getOperand(0);
       // only scalar requires scratch memory
@@ -230,7 +473,7 @@ private:
       auto &info = latticeElement->getValue();
       if (!info.getAllocs().empty()) {
         for (auto alloc : info.getAllocs()) {
-          allocation->addAlias(value, alloc);
+          allocation->addAlias(value, alloc, info.getInterval(alloc));
         }
       }
     }
@@ -348,6 +591,9 @@ private:
     resolveExplicitBufferLiveness(getValueLivenessRange);
     resolveAliasBufferLiveness(getValueLivenessRange);
     resolveScratchBufferLiveness(operationId);
+
+    for (auto bufferIter : bufferRange)
+      bufferIter.first->liveness = bufferIter.second;
   }
 
   /// Computes the shared memory offsets for all related values.
@@ -366,6 +612,8 @@ private:
     buildInterferenceGraph(buffers, bufferStart, interference);
 
     allocate(buffers, bufferStart, interference);
+
+    compact(buffers);
   }
 
   /// Computes the initial shared memory offsets.
@@ -474,14 +722,50 @@ private:
     // color0: [0, 7), [0, 8), [0, 15) -> [0, 7), [0, 8), [0, 15)
     // color1: [7, 9) -> [0 + 1 * 15, 9 + 1 * 15) -> [15, 24)
     // color2: [8, 12) -> [8 + 2 * 15, 12 + 2 * 15) -> [38, 42)
-    // TODO(Keren): We are wasting memory here.
-    // Nodes with color2 can actually start with 24.
+    // The holes this leaves (color2 could start at 24) are filled by compact.
     for (auto x : buffers) {
       size_t adj = 0;
       for (auto y : interference.lookup(x)) {
         adj = std::max(adj, bufferStart.lookup(y) + y->size);
       }
       x->offset = bufferStart.lookup(x) + colors.lookup(x) * adj;
+    }
+  }
+
+  /// Packs the offsets computed by the graph coloring as tightly as possible.
+  /// Buffers are visited in increasing order of their colored offsets, and
+  /// each one is moved to the lowest address that does not overlap any
+  /// previously placed buffer whose liveness range intersects its own, and
+  /// that is a multiple of its alignment.
+  /// Visiting buffers in this order keeps the layout of the coloring when it
+  /// is already tight, and fills the holes left by the color * adj shift
+  /// otherwise (e.g., color2 in the example above can start at 24).
+  void compact(const SmallVector<BufferT *> &buffers) {
+    SmallVector<BufferT *> sortedBuffers = buffers;
+    std::stable_sort(sortedBuffers.begin(), sortedBuffers.end(),
+                     [&](BufferT *x, BufferT *y) {
+                       if (x->offset != y->offset)
+                         return x->offset < y->offset;
+                       return bufferRange.lookup(x).start() <
+                              bufferRange.lookup(y).start();
+                     });
+    SmallVector<BufferT *> placed;
+    for (auto *x : sortedBuffers) {
+      auto xOpRange = bufferRange.lookup(x);
+      SmallVector<Interval<size_t>> occupied;
+      for (auto *y : placed) {
+        if (xOpRange.intersects(bufferRange.lookup(y)))
+          occupied.push_back({y->offset, y->offset + y->size});
+      }
+      llvm::sort(occupied);
+      size_t offset = 0;
+      for (auto &range : occupied) {
+        if (offset + x->size <= range.start())
+          break;
+        offset = llvm::alignTo(std::max(offset, range.end()), x->alignment);
+      }
+      x->offset = offset;
+      placed.push_back(x);
       allocation->sharedMemorySize =
           std::max(allocation->sharedMemorySize, x->offset + x->size);
     }
@@ -491,6 +775,8 @@ private:
   Operation *operation;
   Allocation *allocation;
   BufferRangeMapT bufferRange;
+  /// Whether the operands of some dot are read in place by wgmma
+  bool hasWGMMA = false;
 };
 } // namespace triton
 
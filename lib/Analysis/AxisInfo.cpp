@@ -1,7 +1,10 @@
 #include "mlir/Analysis/DataFlowAnalysis.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/Matchers.h"
+#include "llvm/Support/CheckedArithmetic.h"
 #include "llvm/Support/raw_ostream.h"
 #include <iostream>
+#include <limits>
 
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
@@ -35,6 +38,21 @@ static int gcd(int a, int b) {
   return gcd_impl(a, b, &x, &y);
 }
 
+// Range of the induction variable of a loop with static bounds
+static Optional<AxisInfo::RangeT> getInductionVarRange(scf::ForOp forOp) {
+  APInt lb, ub, step;
+  if (!matchPattern(forOp.getLowerBound(), m_ConstantInt(&lb)) ||
+      !matchPattern(forOp.getUpperBound(), m_ConstantInt(&ub)) ||
+      !matchPattern(forOp.getStep(), m_ConstantInt(&step)))
+    return llvm::None;
+  int64_t lower = lb.getSExtValue();
+  int64_t upper = ub.getSExtValue();
+  int64_t stride = step.getSExtValue();
+  if (stride <= 0 || upper <= lower)
+    return llvm::None;
+  return AxisInfo::RangeT{lower, lower + (upper - lower - 1) / stride * stride};
+}
+
 AxisInfo AxisInfo::getPessimisticValueState(Value value) {
   size_t rank = 1;
   if (TensorType ty = value.getType().dyn_cast<TensorType>())
@@ -55,10 +73,15 @@ AxisInfo AxisInfo::getPessimisticValueState(Value value) {
         divHint = attr.cast<IntegerAttr>().getValue().getZExtValue();
     }
   }
+  Optional<RangeT> range;
+  if (blockArg && blockArg.getOwner()->getParentOp())
+    if (auto forOp = dyn_cast<scf::ForOp>(blockArg.getOwner()->getParentOp()))
+      if (forOp.getInductionVar() == value)
+        range = getInductionVarRange(forOp);
   DimVectorT contiguity(rank, 1);
   DimVectorT divisibility(rank, divHint);
   DimVectorT constancy(rank, 1);
-  return AxisInfo(contiguity, divisibility, constancy);
+  return AxisInfo(contiguity, divisibility, constancy, range);
 }
 
 // The gcd of both arguments for each dimension
@@ -72,7 +95,10 @@ AxisInfo AxisInfo::join(const AxisInfo &lhs, const AxisInfo &rhs) {
         gcd(lhs.getDivisibility(d), rhs.getDivisibility(d)));
     retConstancy.push_back(gcd(lhs.getConstancy(d), rhs.getConstancy(d)));
   }
-  return AxisInfo(retContiguity, retDivisibility, retConstancy);
+  Optional<RangeT> retRange;
+  if (lhs.getRange() == rhs.getRange())
+    retRange = lhs.getRange();
+  return AxisInfo(retContiguity, retDivisibility, retConstancy, retRange);
 }
 
 //===----------------------------------------------------------------------===//
@@ -96,6 +122,226 @@ AxisInfo AxisInfoAnalysis::visitBinaryOp(
   return AxisInfo(newContiguity, newDivisibility, newConstancy);
 }
 
+// Width of the (element) integer type, or 0 if `type` isn't an integer
+static unsigned getIntBitWidth(Type type) {
+  Type elemTy = getElementTypeOrSelf(type);
+  if (elemTy.isIndex())
+    return 64;
+  if (auto intTy = elemTy.dyn_cast<IntegerType>())
+    return intTy.getWidth();
+  return 0;
+}
+
+// Returns `range` if all its values are representable in an integer of
+// `bitwidth` bits, whose values are signed except for booleans
+static Optional<AxisInfo::RangeT> fitRange(Optional<AxisInfo::RangeT> range,
+                                           unsigned bitwidth) {
+  if (!range || bitwidth == 0 || bitwidth > 64)
+    return llvm::None;
+  int64_t min = 0;
+  int64_t max = 1;
+  if (bitwidth == 64) {
+    min = std::numeric_limits<int64_t>::min();
+    max = std::numeric_limits<int64_t>::max();
+  } else if (bitwidth > 1) {
+    max = (int64_t(1) << (bitwidth - 1)) - 1;
+    min = -max - 1;
+  }
+  if (range->first < min || range->second > max)
+    return llvm::None;
+  return range;
+}
+
+// Returns true (resp. false) if the comparison holds (resp. doesn't hold) for
+// all the values in the ranges of its operands
+static Optional<bool> evaluateCmp(arith::CmpIPredicate predicate,
+                                  AxisInfo::RangeT lhs, AxisInfo::RangeT rhs) {
+  using arith::CmpIPredicate;
+  bool nonNegative = lhs.first >= 0 && rhs.first >= 0;
+  bool disjoint = lhs.second < rhs.first || rhs.second < lhs.first;
+  bool sameConstant = lhs.first == lhs.second && lhs == rhs;
+  auto decide = [](bool isTrue, bool isFalse) -> Optional<bool> {
+    if (isTrue)
+      return true;
+    if (isFalse)
+      return false;
+    return llvm::None;
+  };
+  switch (predicate) {
+  case CmpIPredicate::eq:
+    return decide(sameConstant, disjoint);
+  case CmpIPredicate::ne:
+    return decide(disjoint, sameConstant);
+  case CmpIPredicate::ult:
+    if (!nonNegative)
+      return llvm::None;
+    LLVM_FALLTHROUGH;
+  case CmpIPredicate::slt:
+    return decide(lhs.second < rhs.first, lhs.first >= rhs.second);
+  case CmpIPredicate::ule:
+    if (!nonNegative)
+      return llvm::None;
+    LLVM_FALLTHROUGH;
+  case CmpIPredicate::sle:
+    return decide(lhs.second <= rhs.first, lhs.first > rhs.second);
+  case CmpIPredicate::ugt:
+    if (!nonNegative)
+      return llvm::None;
+    LLVM_FALLTHROUGH;
+  case CmpIPredicate::sgt:
+    return decide(lhs.first > rhs.second, lhs.second <= rhs.first);
+  case CmpIPredicate::uge:
+    if (!nonNegative)
+      return llvm::None;
+    LLVM_FALLTHROUGH;
+  case CmpIPredicate::sge:
+    return decide(lhs.first >= rhs.second, lhs.second < rhs.first);
+  }
+  return llvm::None;
+}
+
+Optional<AxisInfo::RangeT> AxisInfoAnalysis::visitRange(
+    Operation *op, ArrayRef<LatticeElement<AxisInfo> *> operands) {
+  using RangeT = AxisInfo::RangeT;
+  if (op->getNumResults() != 1)
+    return llvm::None;
+  unsigned bitwidth = getIntBitWidth(op->getResult(0).getType());
+  if (bitwidth == 0 || bitwidth > 64)
+    return llvm::None;
+  auto getRange = [&](unsigned i) -> Optional<RangeT> {
+    if (i >= operands.size())
+      return llvm::None;
+    return operands[i]->getValue().getRange();
+  };
+  auto toInt = [&](const APInt &value) -> int64_t {
+    return bitwidth == 1 ? value.getZExtValue() : value.getSExtValue();
+  };
+  Optional<RangeT> range;
+  // Constants
+  if (auto constant = dyn_cast<arith::ConstantOp>(op)) {
+    if (auto intAttr = constant.getValue().dyn_cast<IntegerAttr>()) {
+      int64_t value = toInt(intAttr.getValue());
+      range = RangeT{value, value};
+    } else if (auto denseAttr =
+                   constant.getValue().dyn_cast<DenseIntElementsAttr>()) {
+      if (denseAttr.isSplat()) {
+        int64_t value = toInt(denseAttr.getSplatValue<APInt>());
+        range = RangeT{value, value};
+      } else {
+        for (const APInt &apValue : denseAttr.getValues<APInt>()) {
+          int64_t value = toInt(apValue);
+          range = range ? RangeT{std::min(range->first, value),
+                                 std::max(range->second, value)}
+                        : RangeT{value, value};
+        }
+      }
+    }
+  }
+  if (auto makeRange = dyn_cast<triton::MakeRangeOp>(op))
+    range = RangeT{makeRange.start(), int64_t(makeRange.end()) - 1};
+  // The grid is at most (2^31 - 1) x 65535 x 65535
+  if (auto pid = dyn_cast<triton::GetProgramIdOp>(op))
+    range = RangeT{0, pid.axis() == 0 ? (1ll << 31) - 2 : 65534};
+  if (auto numPrograms = dyn_cast<triton::GetNumProgramsOp>(op))
+    range = RangeT{1, numPrograms.axis() == 0 ? (1ll << 31) - 1 : 65535};
+  // Operations that don't change the values
+  if (isa<arith::TruncIOp, arith::IndexCastOp,
+          triton::SplatOp, triton::BroadcastOp, triton::ExpandDimsOp,
+          triton::ViewOp, triton::gpu::ConvertLayoutOp,
+          mlir::UnrealizedConversionCastOp>(op))
+    range = getRange(0);
+  // i1 ranges are zero-extended: true sign-extends to -1
+  if (isa<arith::ExtSIOp>(op)) {
+    range = getRange(0);
+    if (range && getIntBitWidth(op->getOperand(0).getType()) == 1)
+      range = RangeT{-range->second, -range->first};
+  }
+  if (isa<arith::ExtUIOp>(op)) {
+    unsigned srcBitwidth = getIntBitWidth(op->getOperand(0).getType());
+    range = getRange(0);
+    if (range && range->first < 0)
+      range = srcBitwidth < 64 ? RangeT{0, (int64_t(1) << srcBitwidth) - 1}
+                               : Optional<RangeT>();
+  }
+  // Select
+  if (isa<mlir::SelectOp, triton::gpu::SelectOp>(op)) {
+    auto cond = getRange(0);
+    auto trueRange = getRange(1);
+    auto falseRange = getRange(2);
+    if (cond && cond->first == cond->second)
+      range = cond->first ? trueRange : falseRange;
+    else if (trueRange && falseRange)
+      range = RangeT{std::min(trueRange->first, falseRange->first),
+                     std::max(trueRange->second, falseRange->second)};
+  }
+  // Binary operations
+  auto lhs = getRange(0);
+  auto rhs = getRange(1);
+  if (!lhs || !rhs || op->getNumOperands() != 2)
+    return fitRange(range, bitwidth);
+  bool nonNegative = lhs->first >= 0 && rhs->first >= 0;
+  auto toRange = [](Optional<int64_t> lower,
+                    Optional<int64_t> upper) -> Optional<RangeT> {
+    if (!lower || !upper)
+      return llvm::None;
+    return RangeT{*lower, *upper};
+  };
+  if (isa<arith::AddIOp>(op))
+    range = toRange(llvm::checkedAdd(lhs->first, rhs->first),
+                    llvm::checkedAdd(lhs->second, rhs->second));
+  if (isa<arith::SubIOp>(op))
+    range = toRange(llvm::checkedSub(lhs->first, rhs->second),
+                    llvm::checkedSub(lhs->second, rhs->first));
+  if (isa<arith::MulIOp>(op)) {
+    SmallVector<Optional<int64_t>, 4> products = {
+        llvm::checkedMul(lhs->first, rhs->first),
+        llvm::checkedMul(lhs->first, rhs->second),
+        llvm::checkedMul(lhs->second, rhs->first),
+        llvm::checkedMul(lhs->second, rhs->second)};
+    if (llvm::all_of(products, [](Optional<int64_t> p) { return p; })) {
+      range = RangeT{*products[0], *products[0]};
+      for (Optional<int64_t> product : products)
+        range = RangeT{std::min(range->first, *product),
+                       std::max(range->second, *product)};
+    }
+  }
+  if (isa<arith::DivSIOp, arith::DivUIOp>(op) && nonNegative &&
+      rhs->first > 0)
+    range = RangeT{lhs->first / rhs->second, lhs->second / rhs->first};
+  if (isa<arith::RemSIOp, arith::RemUIOp>(op) && nonNegative &&
+      rhs->first > 0)
+    range = RangeT{lhs->second < rhs->first ? lhs->first : 0,
+                   std::min(lhs->second, rhs->second - 1)};
+  if (isa<arith::MinSIOp>(op) || (isa<arith::MinUIOp>(op) && nonNegative))
+    range = RangeT{std::min(lhs->first, rhs->first),
+                   std::min(lhs->second, rhs->second)};
+  if (isa<arith::MaxSIOp>(op) || (isa<arith::MaxUIOp>(op) && nonNegative))
+    range = RangeT{std::max(lhs->first, rhs->first),
+                   std::max(lhs->second, rhs->second)};
+  bool constants = lhs->first == lhs->second && rhs->first == rhs->second;
+  if (isa<arith::AndIOp>(op) && nonNegative)
+    range = RangeT{constants ? lhs->first & rhs->first : 0,
+                   std::min(lhs->second, rhs->second)};
+  if (isa<arith::OrIOp>(op) && nonNegative) {
+    uint64_t upper = std::max(lhs->second, rhs->second);
+    range = RangeT{constants ? lhs->first | rhs->first
+                             : std::max(lhs->first, rhs->first),
+                   constants ? lhs->first | rhs->first
+                             : int64_t(llvm::NextPowerOf2(upper) - 1)};
+  }
+  Optional<arith::CmpIPredicate> predicate;
+  if (auto cmp = dyn_cast<arith::CmpIOp>(op))
+    predicate = cmp.predicate();
+  if (auto cmp = dyn_cast<triton::gpu::CmpIOp>(op))
+    predicate = cmp.predicate();
+  if (predicate) {
+    range = RangeT{0, 1};
+    if (Optional<bool> result = evaluateCmp(*predicate, *lhs, *rhs))
+      range = RangeT{*result, *result};
+  }
+  return fitRange(range, bitwidth);
+}
+
 ChangeResult AxisInfoAnalysis::visitOperation(
     Operation *op, ArrayRef<LatticeElement<AxisInfo> *> operands) {
   AxisInfo curr;
@@ -264,9 +510,14 @@ ChangeResult AxisInfoAnalysis::visitOperation(
   if (llvm::isa<mlir::UnrealizedConversionCastOp>(op)) {
     curr = operands[0]->getValue();
   }
+  // Keep the range of the values even when nothing is known on their axes
+  Optional<AxisInfo::RangeT> range = visitRange(op, operands);
+  if (curr.getRank() == 0 && range)
+    curr = AxisInfo::getPessimisticValueState(op->getResult(0));
   if (curr.getRank() == 0) {
     return markAllPessimisticFixpoint(op->getResults());
   }
+  curr.setRange(range);
 
   // join all lattice elements
   ChangeResult result = ChangeResult::NoChange;
@@ -280,30 +531,42 @@ unsigned AxisInfoAnalysis::getPtrVectorSize(Value ptr) {
   auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
   if (!tensorTy)
     return 1;
-  auto layout = tensorTy.getEncoding();
-  auto shape = tensorTy.getShape();
-
   // Here order should be ordered by contiguous first, so the first element
   // should have the largest contiguous.
-  auto order = triton::gpu::getOrder(layout);
-  unsigned align = getPtrAlignment(ptr);
+  auto order = triton::gpu::getOrder(tensorTy.getEncoding());
+  return getPtrVectorSize(ptr, order[0]);
+}
+
+unsigned AxisInfoAnalysis::getPtrVectorSize(Value ptr, unsigned axis) {
+  auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return 1;
+  auto layout = tensorTy.getEncoding();
+  auto shape = tensorTy.getShape();
 
-  unsigned contigPerThread = triton::gpu::getSizePerThread(layout)[order[0]];
+  unsigned align = getPtrAlignment(ptr, axis);
+  unsigned contigPerThread = triton::gpu::getSizePerThread(layout)[axis];
   unsigned vec = std::min(align, contigPerThread);
-  vec = std::min<unsigned>(shape[order[0]], vec);
+  vec = std::min<unsigned>(shape[axis], vec);
 
   return vec;
 }
 
 unsigned AxisInfoAnalysis::getPtrAlignment(Value ptr) {
+  auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return 1;
+  auto order = triton::gpu::getOrder(tensorTy.getEncoding());
+  return getPtrAlignment(ptr, order[0]);
+}
+
+unsigned AxisInfoAnalysis::getPtrAlignment(Value ptr, unsigned axis) {
   auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
   if (!tensorTy)
     return 1;
   auto axisInfo = lookupLatticeElement(ptr)->getValue();
-  auto layout = tensorTy.getEncoding();
-  auto order = triton::gpu::getOrder(layout);
-  unsigned maxMultiple = axisInfo.getDivisibility(order[0]);
-  unsigned maxContig = axisInfo.getContiguity(order[0]);
+  unsigned maxMultiple = axisInfo.getDivisibility(axis);
+  unsigned maxContig = axisInfo.getContiguity(axis);
   unsigned alignment = std::min(maxMultiple, maxContig);
   return alignment;
 }
@@ -313,9 +576,63 @@ unsigned AxisInfoAnalysis::getMaskAlignment(Value mask) {
   if (!tensorTy)
     return 1;
   auto maskOrder = triton::gpu::getOrder(tensorTy.getEncoding());
+  return getMaskAlignment(mask, maskOrder[0]);
+}
+
+unsigned AxisInfoAnalysis::getMaskAlignment(Value mask, unsigned axis) {
+  auto tensorTy = mask.getType().dyn_cast<RankedTensorType>();
+  if (!tensorTy)
+    return 1;
   auto maskAxis = lookupLatticeElement(mask)->getValue();
-  auto alignment = std::max<unsigned>(maskAxis.getConstancy(maskOrder[0]), 1);
+  // A mask that is always true doesn't constrain the vectorization
+  if (maskAxis.isAlwaysTrue())
+    return tensorTy.getNumElements();
+  auto alignment = std::max<unsigned>(maskAxis.getConstancy(axis), 1);
   return alignment;
 }
 
+unsigned AxisInfoAnalysis::getRaggedMaskAlignment(Value mask, unsigned axis) {
+  unsigned alignment = getMaskAlignment(mask, axis);
+  Operation *op = mask.getDefiningOp();
+  if (!op)
+    return alignment;
+  if (auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op))
+    return std::max(alignment, getRaggedMaskAlignment(cvt.src(), axis));
+  // The conjunction with a mask constant over the group keeps its prefix
+  if (isa<arith::AndIOp>(op))
+    return std::max(alignment,
+                    std::min(getRaggedMaskAlignment(op->getOperand(0), axis),
+                             getRaggedMaskAlignment(op->getOperand(1), axis)));
+  Optional<arith::CmpIPredicate> predicate;
+  if (auto cmp = dyn_cast<arith::CmpIOp>(op))
+    predicate = cmp.predicate();
+  if (auto cmp = dyn_cast<triton::gpu::CmpIOp>(op))
+    predicate = cmp.predicate();
+  if (!predicate)
+    return alignment;
+  using arith::CmpIPredicate;
+  switch (*predicate) {
+  case CmpIPredicate::slt:
+  case CmpIPredicate::sle:
+  case CmpIPredicate::ult:
+  case CmpIPredicate::ule:
+    break;
+  default:
+    return alignment;
+  }
+  // Increasing offsets compared to bounds constant over the group
+  auto *lhs = lookupLatticeElement(op->getOperand(0));
+  auto *rhs = lookupLatticeElement(op->getOperand(1));
+  if (!lhs || !rhs)
+    return alignment;
+  unsigned group = std::min(lhs->getValue().getContiguity(axis),
+                            rhs->getValue().getConstancy(axis));
+  return std::max(alignment, group);
+}
+
+bool AxisInfoAnalysis::isMaskAlwaysTrue(Value mask) {
+  auto *latticeElement = lookupLatticeElement(mask);
+  return latticeElement && latticeElement->getValue().isAlwaysTrue();
+}
+
 } // namespace mlir
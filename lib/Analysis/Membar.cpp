@@ -7,11 +7,129 @@
 
 namespace mlir {
 
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
 void MembarAnalysis::run() {
   auto *operation = allocation->getOperation();
   RegionInfo regionInfo;
   OpBuilder builder(operation);
+  barriers.clear();
+  relaxedOps.clear();
   dfsOperation(operation, &regionInfo, &builder);
+  // Loop bodies are traversed twice, and the second traversal may still
+  // insert a barrier before an operation relaxed by the first one.
+  numEliminatedBarriers = llvm::count_if(relaxedOps, [](Operation *op) {
+    return !isa_and_nonnull<gpu::BarrierOp>(op->getPrevNode());
+  });
+  removeRedundantBarriers(operation);
+}
+
+Interval<size_t>
+MembarAnalysis::getSliceInterval(Value tensor,
+                                 ArrayRef<Optional<int64_t>> offsets,
+                                 ArrayRef<Optional<int64_t>> sizes,
+                                 Allocation::BufferId bufferId) const {
+  auto whole = allocation->getAliasedInterval(tensor, bufferId);
+  auto type = tensor.getType().cast<RankedTensorType>();
+  if (!type.getEncoding() || !type.getEncoding().isa<SharedEncodingAttr>())
+    return whole;
+  // The position of a sub-tensor is only known within a tensor stored
+  // contiguously in the interval it spans
+  if (type.getNumElements() *
+          triton::getIntOrFloatBitWidth(type.getElementType()) / 8 !=
+      whole.size())
+    return whole;
+  SmallVector<int64_t> staticOffsets;
+  SmallVector<int64_t> staticSizes;
+  for (auto offset : offsets) {
+    if (!offset)
+      return whole;
+    staticOffsets.push_back(*offset);
+  }
+  for (auto size : sizes) {
+    if (!size)
+      return whole;
+    staticSizes.push_back(*size);
+  }
+  auto interval = getSubTensorInterval(type, staticOffsets, staticSizes);
+  return Interval<size_t>(whole.start() + interval.start(),
+                          whole.start() + interval.end());
+}
+
+Interval<size_t>
+MembarAnalysis::getReadInterval(Value value,
+                                Allocation::BufferId bufferId) const {
+  // Subviews, and the values derived from them (e.g., their transposition or
+  // the iteration arguments they are passed to), only span their slices
+  return allocation->getAliasedInterval(value, bufferId);
+}
+
+Interval<size_t>
+MembarAnalysis::getWriteInterval(Operation *op,
+                                 Allocation::BufferId bufferId) const {
+  SmallVector<Optional<int64_t>> offsets;
+  SmallVector<Optional<int64_t>> sizes;
+  Value dst;
+  if (auto insertOp = dyn_cast<triton::gpu::InsertSliceAsyncOp>(op)) {
+    dst = insertOp.dst();
+    auto shape = dst.getType().cast<RankedTensorType>().getShape();
+    unsigned axis = insertOp.axis();
+    auto index = getConstantOffset(insertOp.index());
+    for (unsigned d = 0; d < shape.size(); ++d) {
+      offsets.push_back(d == axis ? index : Optional<int64_t>(0));
+      sizes.push_back(d == axis ? 1 : shape[d]);
+    }
+  } else if (auto insertOp = dyn_cast<triton::gpu::InsertSliceTMAOp>(op)) {
+    dst = insertOp.dst();
+    auto shape = dst.getType().cast<RankedTensorType>().getShape();
+    auto index = getConstantOffset(insertOp.index());
+    for (unsigned d = 0; d < shape.size(); ++d) {
+      offsets.push_back(d == 0 ? index : Optional<int64_t>(0));
+      sizes.push_back(d == 0 ? 1 : shape[d]);
+    }
+  } else {
+    auto insertOp = cast<tensor::InsertSliceOp>(op);
+    dst = insertOp.dest();
+    for (auto offset : insertOp.getMixedOffsets())
+      offsets.push_back(getConstantOffset(offset));
+    for (auto size : insertOp.getMixedSizes())
+      sizes.push_back(getConstantOffset(size));
+  }
+  return getSliceInterval(dst, offsets, sizes, bufferId);
+}
+
+void MembarAnalysis::removeRedundantBarriers(Operation *operation) {
+  auto mayAccessSharedMemory = [&](Operation *op) {
+    if (op->getNumRegions() || isa<triton::gpu::AsyncWaitOp>(op) ||
+        allocation->getBufferId(op) != Allocation::InvalidBufferId)
+      return true;
+    for (Value value : op->getOperands())
+      if (!allocation->getBufferIds(value).empty())
+        return true;
+    for (Value value : op->getResults())
+      if (allocation->getBufferId(value) != Allocation::InvalidBufferId)
+        return true;
+    return false;
+  };
+  SmallVector<Operation *> redundantBarriers;
+  operation->walk([&](Block *block) {
+    // Unknown accesses may precede the first barrier of a block
+    bool accessed = true;
+    for (auto &op : block->getOperations()) {
+      if (isa<gpu::BarrierOp>(op)) {
+        if (!accessed)
+          redundantBarriers.push_back(&op);
+        accessed = false;
+      } else if (mayAccessSharedMemory(&op)) {
+        accessed = true;
+      }
+    }
+  });
+  for (auto *barrier : redundantBarriers) {
+    llvm::erase_value(barriers, barrier);
+    barrier->erase();
+    ++numEliminatedBarriers;
+  }
 }
 
 void MembarAnalysis::dfsOperation(Operation *operation,
@@ -71,7 +189,7 @@ void MembarAnalysis::transfer(Operation *op, RegionInfo *regionInfo,
     // Do not insert barriers before control flow operations and
     // alloc/extract/insert
     // alloc is an allocation op without memory write.
-    // FIXME(Keren): extract_slice is always alias for now
+    // extract_slice only creates a subview of its source.
     return;
   }
 
@@ -88,7 +206,7 @@ void MembarAnalysis::transfer(Operation *op, RegionInfo *regionInfo,
     regionInfo->sync();
     OpBuilder::InsertionGuard g(*builder);
     builder->setInsertionPointAfter(op);
-    builder->create<gpu::BarrierOp>(op->getLoc());
+    barriers.push_back(builder->create<gpu::BarrierOp>(op->getLoc()));
     regionInfo->sync();
     return;
   }
@@ -98,13 +216,14 @@ void MembarAnalysis::transfer(Operation *op, RegionInfo *regionInfo,
     for (auto bufferId : allocation->getBufferIds(value)) {
       if (bufferId != Allocation::InvalidBufferId) {
         if (isa<triton::gpu::InsertSliceAsyncOp>(op) ||
+            isa<triton::gpu::InsertSliceTMAOp>(op) ||
             isa<tensor::InsertSliceOp>(op)) {
-          // FIXME(Keren): insert_slice and insert_slice_async are always alias
-          // for now
-          curRegionInfo.syncWriteBuffers.insert(bufferId);
+          curRegionInfo.syncWriteIntervals[bufferId].insert(
+              getWriteInterval(op, bufferId));
         } else {
           // ConvertLayoutOp: shared memory -> registers
-          curRegionInfo.syncReadBuffers.insert(bufferId);
+          curRegionInfo.syncReadIntervals[bufferId].insert(
+              getReadInterval(value, bufferId));
         }
       }
     }
@@ -113,21 +232,28 @@ void MembarAnalysis::transfer(Operation *op, RegionInfo *regionInfo,
     // ConvertLayoutOp: registers -> shared memory
     auto bufferId = allocation->getBufferId(value);
     if (bufferId != Allocation::InvalidBufferId) {
-      curRegionInfo.syncWriteBuffers.insert(bufferId);
+      curRegionInfo.syncWriteIntervals[bufferId].insert(
+          allocation->getAllocatedInterval(bufferId));
     }
   }
   // Scratch buffer is considered as both shared memory write & read
   auto bufferId = allocation->getBufferId(op);
   if (bufferId != Allocation::InvalidBufferId) {
-    curRegionInfo.syncWriteBuffers.insert(bufferId);
-    curRegionInfo.syncReadBuffers.insert(bufferId);
+    curRegionInfo.syncWriteIntervals[bufferId].insert(
+        allocation->getAllocatedInterval(bufferId));
+    curRegionInfo.syncReadIntervals[bufferId].insert(
+        allocation->getAllocatedInterval(bufferId));
   }
 
   if (regionInfo->isIntersected(curRegionInfo, allocation)) {
     OpBuilder::InsertionGuard g(*builder);
     builder->setInsertionPoint(op);
-    builder->create<gpu::BarrierOp>(op->getLoc());
+    barriers.push_back(builder->create<gpu::BarrierOp>(op->getLoc()));
     regionInfo->sync();
+  } else if (regionInfo->isIntersected(curRegionInfo, allocation,
+                                       /*precise=*/false)) {
+    // Whole buffers conflict, but the accessed intervals do not
+    relaxedOps.insert(op);
   }
   // Update the region info, even if barrier is inserted, we have to maintain
   // the current op's read/write buffers.
@@ -0,0 +1,249 @@
+#include "triton/Analysis/SharedMemoryReport.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+
+#include "mlir/Dialect/GPU/GPUDialect.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "llvm/Support/JSON.h"
+
+using ::mlir::triton::gpu::BlockedEncodingAttr;
+using ::mlir::triton::gpu::DotOperandEncodingAttr;
+using ::mlir::triton::gpu::MmaEncodingAttr;
+using ::mlir::triton::gpu::SharedEncodingAttr;
+
+namespace mlir {
+
+namespace {
+
+/// Shared memory transactions issued by one warp-wide access.
+struct WavefrontEstimate {
+  unsigned vecBytes;
+  unsigned wavefronts;
+  unsigned idealWavefronts;
+};
+
+std::string printLoc(Location loc) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  loc.print(os);
+  return os.str();
+}
+
+unsigned getElementBytes(RankedTensorType type) {
+  auto elemTy = type.getElementType();
+  if (elemTy.isa<triton::PointerType>())
+    return 8;
+  return std::max<unsigned>(1, triton::getIntOrFloatBitWidth(elemTy) / 8);
+}
+
+/// Returns the element offset of (row, col) in a swizzled 2D shared tensor,
+/// where col runs along order[0]. See getSwizzledSharedPtrs in the LLVM
+/// lowering for the reference computation.
+unsigned getSwizzledOffset(SharedEncodingAttr layout, ArrayRef<int64_t> shape,
+                           unsigned row, unsigned col) {
+  auto order = layout.getOrder();
+  unsigned vec = layout.getVec();
+  unsigned phase = (row / layout.getPerPhase()) % layout.getMaxPhase();
+  unsigned colOff = ((col / vec) ^ phase) * vec + col % vec;
+  return row * shape[order[0]] + colOff;
+}
+
+WavefrontEstimate countWavefronts(ArrayRef<unsigned> addrs,
+                                  unsigned vecBytes) {
+  auto count = countSharedMemoryWavefronts(addrs, vecBytes);
+  return {vecBytes, count.wavefronts, count.idealWavefronts};
+}
+
+/// Estimates the first access of warp 0 to the swizzled shared tensor
+/// `sharedTy` from the blocked tensor `distributedTy`, using vectors as wide
+/// as both layouts allow along their common contiguous dimension.
+Optional<WavefrontEstimate>
+estimateBlockedAccess(RankedTensorType distributedTy,
+                      RankedTensorType sharedTy) {
+  auto blockedLayout =
+      distributedTy.getEncoding().dyn_cast<BlockedEncodingAttr>();
+  auto sharedLayout = sharedTy.getEncoding().cast<SharedEncodingAttr>();
+  if (!blockedLayout || distributedTy.getRank() != 2)
+    return llvm::None;
+  // Multi-buffered tensors are accessed one 2D slice at a time
+  auto shape = sharedTy.getShape().take_back(2);
+  auto inOrder = blockedLayout.getOrder();
+  auto outOrder = sharedLayout.getOrder();
+  auto sizePerThread = blockedLayout.getSizePerThread();
+  auto threadsPerWarp = blockedLayout.getThreadsPerWarp();
+  unsigned elemBytes = getElementBytes(sharedTy);
+  unsigned inVec = inOrder[0] == outOrder[0] ? sizePerThread[inOrder[0]] : 1;
+  unsigned vec = std::min(inVec, sharedLayout.getVec());
+  vec = std::max(1u, std::min(vec, 16 / elemBytes));
+
+  SmallVector<unsigned> addrs;
+  for (unsigned lane = 0; lane < product<unsigned>(threadsPerWarp); ++lane) {
+    SmallVector<unsigned> coord(2);
+    unsigned rem = lane;
+    for (unsigned d : inOrder) {
+      coord[d] = (rem % threadsPerWarp[d]) * sizePerThread[d] % shape[d];
+      rem /= threadsPerWarp[d];
+    }
+    unsigned offset = getSwizzledOffset(sharedLayout, shape, coord[outOrder[1]],
+                                        coord[outOrder[0]]);
+    addrs.push_back(offset * elemBytes);
+  }
+  return countWavefronts(addrs, vec * elemBytes);
+}
+
+/// Estimates one ldmatrix phase, in which 8 threads provide the addresses of
+/// 8 consecutive 16-byte rows of the swizzled shared tensor.
+Optional<WavefrontEstimate> estimateLdmatrix(RankedTensorType sharedTy) {
+  auto sharedLayout = sharedTy.getEncoding().cast<SharedEncodingAttr>();
+  if (sharedTy.getRank() != 2)
+    return llvm::None;
+  auto shape = sharedTy.getShape();
+  unsigned elemBytes = getElementBytes(sharedTy);
+  SmallVector<unsigned> addrs;
+  for (unsigned row = 0; row < 8; ++row)
+    addrs.push_back(getSwizzledOffset(sharedLayout, shape, row, 0) *
+                    elemBytes);
+  return countWavefronts(addrs, 16);
+}
+
+/// Returns the estimate for a conversion from or to shared memory, if its
+/// lowering is modeled.
+Optional<WavefrontEstimate>
+estimateConversion(RankedTensorType distributedTy, RankedTensorType sharedTy) {
+  auto encoding = distributedTy.getEncoding();
+  if (encoding.isa<BlockedEncodingAttr>())
+    return estimateBlockedAccess(distributedTy, sharedTy);
+  if (auto dotOpLayout = encoding.dyn_cast<DotOperandEncodingAttr>()) {
+    auto mmaLayout = dotOpLayout.getParent().dyn_cast<MmaEncodingAttr>();
+    // Only the ldmatrix path of mma v2 is modeled
+    if (mmaLayout && mmaLayout.isAmpere() &&
+        triton::getIntOrFloatBitWidth(sharedTy.getElementType()) <= 16)
+      return estimateLdmatrix(sharedTy);
+  }
+  return llvm::None;
+}
+
+llvm::json::Array getBufferIds(const Allocation &allocation, Value value) {
+  auto bufferIds = allocation.getBufferIds(value);
+  SmallVector<Allocation::BufferId> sortedIds(bufferIds.begin(),
+                                              bufferIds.end());
+  llvm::sort(sortedIds);
+  llvm::json::Array ids;
+  for (auto id : sortedIds)
+    ids.push_back(static_cast<int64_t>(id));
+  return ids;
+}
+
+} // namespace
+
+std::string getSharedMemoryReport(const Allocation &allocation,
+                                  const MembarAnalysis &membar) {
+  auto *operation = allocation.getOperation();
+  auto insertedBarriers = membar.getInsertedBarriers();
+  DenseSet<Operation *> barrierSet(insertedBarriers.begin(),
+                                   insertedBarriers.end());
+  // Number operations the same way as the allocation analysis did, i.e.,
+  // before the barriers were inserted.
+  DenseMap<Operation *, size_t> operationId;
+  operation->walk<WalkOrder::PostOrder>([&](Operation *op) {
+    if (!barrierSet.count(op))
+      operationId[op] = operationId.size();
+  });
+
+  llvm::json::Array buffers;
+  llvm::json::Array accesses;
+  auto addBuffer = [&](Allocation::BufferId id, Operation *owner) {
+    auto liveness = allocation.getLiveness(id);
+    buffers.push_back(llvm::json::Object{
+        {"id", static_cast<int64_t>(id)},
+        {"kind", allocation.isScratchBuffer(id) ? "scratch" : "explicit"},
+        {"offset", static_cast<int64_t>(allocation.getOffset(id))},
+        {"size", static_cast<int64_t>(allocation.getAllocatedSize(id))},
+        {"liveness",
+         llvm::json::Array{static_cast<int64_t>(liveness.start()),
+                           static_cast<int64_t>(liveness.end())}},
+        {"op", owner->getName().getStringRef()},
+        {"op_id", static_cast<int64_t>(operationId.lookup(owner))},
+        {"loc", printLoc(owner->getLoc())}});
+  };
+  auto addAccess = [&](Operation *op, StringRef kind, Value sharedValue,
+                       Optional<WavefrontEstimate> estimate) {
+    llvm::json::Object access{
+        {"op", op->getName().getStringRef()},
+        {"op_id", static_cast<int64_t>(operationId.lookup(op))},
+        {"loc", printLoc(op->getLoc())},
+        {"kind", kind},
+        {"buffers", getBufferIds(allocation, sharedValue)}};
+    if (estimate) {
+      access["vec_bytes"] = static_cast<int64_t>(estimate->vecBytes);
+      access["wavefronts"] = static_cast<int64_t>(estimate->wavefronts);
+      access["ideal_wavefronts"] =
+          static_cast<int64_t>(estimate->idealWavefronts);
+    }
+    accesses.push_back(std::move(access));
+  };
+  auto isShared = [](Value value) {
+    auto type = value.getType().dyn_cast<RankedTensorType>();
+    return type && type.getEncoding() &&
+           type.getEncoding().isa<SharedEncodingAttr>();
+  };
+
+  operation->walk<WalkOrder::PreOrder>([&](Operation *op) {
+    for (Value result : op->getResults()) {
+      auto id = allocation.getBufferId(result);
+      if (id != Allocation::InvalidBufferId)
+        addBuffer(id, op);
+    }
+    auto scratchId = allocation.getBufferId(op);
+    if (scratchId != Allocation::InvalidBufferId)
+      addBuffer(scratchId, op);
+
+    if (auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op)) {
+      auto srcTy = cvt.src().getType().cast<RankedTensorType>();
+      auto dstTy = cvt.result().getType().cast<RankedTensorType>();
+      if (isShared(cvt.result()) && !isShared(cvt.src()))
+        addAccess(op, "store", cvt.result(), estimateConversion(srcTy, dstTy));
+      else if (isShared(cvt.src()) && !isShared(cvt.result()))
+        addAccess(op, "load", cvt.src(), estimateConversion(dstTy, srcTy));
+    } else if (auto insert = dyn_cast<triton::gpu::InsertSliceAsyncOp>(op)) {
+      auto srcTy = insert.src().getType().cast<RankedTensorType>();
+      auto dstTy = insert.dst().getType().cast<RankedTensorType>();
+      addAccess(op, "store", insert.dst(),
+                estimateBlockedAccess(srcTy, dstTy));
+    } else if (auto insert = dyn_cast<triton::gpu::InsertSliceTMAOp>(op)) {
+      // Bulk copies are not issued by the threads of the CTA
+      addAccess(op, "store", insert.dst(), llvm::None);
+    } else if (auto insert = dyn_cast<tensor::InsertSliceOp>(op)) {
+      auto srcTy = insert.source().getType().cast<RankedTensorType>();
+      auto dstTy = insert.dest().getType().cast<RankedTensorType>();
+      if (isShared(insert.dest()) && !isShared(insert.source()))
+        addAccess(op, "store", insert.dest(),
+                  estimateBlockedAccess(srcTy, dstTy));
+    }
+  });
+
+  llvm::json::Array barriers;
+  for (auto *barrier : insertedBarriers) {
+    auto *next = barrier->getNextNode();
+    llvm::json::Object entry{{"loc", printLoc(barrier->getLoc())}};
+    if (next) {
+      entry["before"] = next->getName().getStringRef();
+      entry["before_id"] = static_cast<int64_t>(operationId.lookup(next));
+    }
+    barriers.push_back(std::move(entry));
+  }
+
+  llvm::json::Object report{
+      {"size", static_cast<int64_t>(allocation.getSharedMemorySize())},
+      {"buffers", std::move(buffers)},
+      {"barriers", std::move(barriers)},
+      {"eliminated_barriers",
+       static_cast<int64_t>(membar.getNumEliminatedBarriers())},
+      {"accesses", std::move(accesses)}};
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << llvm::json::Value(std::move(report));
+  return os.str();
+}
+
+} // namespace mlir
@@ -2,19 +2,29 @@
 #include "mlir/IR/Dialect.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <limits>
+#include <set>
 
 namespace mlir {
 
 bool ReduceOpHelper::isFastReduction() {
   auto srcLayout = srcTy.getEncoding();
-  auto axis = op.axis();
   return axis == triton::gpu::getOrder(srcLayout)[0];
 }
 
+bool ReduceOpHelper::isWarpSynchronous() {
+  auto srcLayout = srcTy.getEncoding();
+  // The result layout of the shuffles is only derived for blocked layouts
+  return isFastReduction() &&
+         srcLayout.isa<triton::gpu::BlockedEncodingAttr>() &&
+         triton::gpu::getWarpsPerCTA(srcLayout)[axis] == 1;
+}
+
 unsigned ReduceOpHelper::getInterWarpSize() {
   auto srcLayout = srcTy.getEncoding();
   auto srcShape = srcTy.getShape();
-  auto axis = op.axis();
   auto srcReduceDimSize = static_cast<unsigned>(srcShape[axis]);
   unsigned sizeIntraWarps = getIntraWarpSize();
   return std::min(srcReduceDimSize / sizeIntraWarps,
@@ -24,7 +34,6 @@ unsigned ReduceOpHelper::getInterWarpSize() {
 unsigned ReduceOpHelper::getIntraWarpSize() {
   auto srcLayout = srcTy.getEncoding();
   auto srcShape = srcTy.getShape();
-  auto axis = op.axis();
   auto srcReduceDimSize = static_cast<unsigned>(srcShape[axis]);
   return std::min(srcReduceDimSize,
                   triton::gpu::getThreadsPerWarp(srcLayout)[axis]);
@@ -32,25 +41,22 @@ unsigned ReduceOpHelper::getIntraWarpSize() {
 
 unsigned ReduceOpHelper::getThreadsReductionAxis() {
   auto srcLayout = srcTy.getEncoding();
-  auto axis = op.axis();
   return triton::gpu::getThreadsPerWarp(srcLayout)[axis] *
          triton::gpu::getWarpsPerCTA(srcLayout)[axis];
 }
 
 SmallVector<unsigned> ReduceOpHelper::getScratchConfigBasic() {
-  auto axis = op.axis();
   auto smemShape = convertType<unsigned>(getSrcShape());
   smemShape[axis] = std::min(smemShape[axis], getThreadsReductionAxis());
   return smemShape;
 }
 
 SmallVector<SmallVector<unsigned>> ReduceOpHelper::getScratchConfigsFast() {
-  auto axis = op.axis();
   SmallVector<SmallVector<unsigned>> smemShapes(3);
 
   auto argLayout = srcTy.getEncoding();
   auto argLayoutMma = argLayout.dyn_cast<triton::gpu::MmaEncodingAttr>();
-  if (argLayoutMma && argLayoutMma.getVersionMajor() == 2 &&
+  if (argLayoutMma && (argLayoutMma.isAmpere() || argLayoutMma.isHopper()) &&
       triton::gpu::getWarpsPerCTA(argLayout)[axis] == 1)
     return {{1, 1}, {1, 1}};
 
@@ -60,16 +66,20 @@ SmallVector<SmallVector<unsigned>> ReduceOpHelper::getScratchConfigsFast() {
 
   /// FIXME(Qingyi): This size is actually larger than required.
   /// shared memory block1:
-  auto mod = op.getOperation()->getParentOfType<ModuleOp>();
+  auto mod = op->getParentOfType<ModuleOp>();
   unsigned numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
-  smemShapes[1].push_back(numWarps * 32);
+  unsigned threadsPerWarp =
+      triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+  smemShapes[1].push_back(numWarps * threadsPerWarp);
 
   return smemShapes;
 }
 
 unsigned ReduceOpHelper::getScratchSizeInBytes() {
   unsigned elems = 0;
-  if (isFastReduction()) {
+  if (isWarpSynchronous()) {
+    return 0;
+  } else if (isFastReduction()) {
     auto smemShapes = getScratchConfigsFast();
     for (const auto &smemShape : smemShapes)
       elems = std::max(elems, product<unsigned>(smemShape));
@@ -78,13 +88,83 @@ unsigned ReduceOpHelper::getScratchSizeInBytes() {
     elems = product<unsigned>(smemShape);
   }
 
-  auto tensorType = op.operand().getType().cast<RankedTensorType>();
-  unsigned bytes = elems * tensorType.getElementTypeBitWidth() / 8;
+  return getScratchOffsetsInBytes(elems).back();
+}
+
+SmallVector<unsigned>
+ReduceOpHelper::getScratchOffsetsInBytes(unsigned elems) {
+  SmallVector<unsigned> offsets = {0};
+  for (Type elementType : srcElementTypes) {
+    unsigned bytes =
+        elems * ceil<unsigned>(elementType.getIntOrFloatBitWidth(), 8);
+    offsets.push_back(offsets.back() + llvm::alignTo(bytes, 8));
+  }
+  return offsets;
+}
+
+bool AxisLoweringHelper::isSupported() {
+  auto srcLayout = srcTy.getEncoding().dyn_cast_or_null<
+      triton::gpu::BlockedEncodingAttr>();
+  if (!srcLayout || !srcTy.getElementType().isIntOrFloat())
+    return false;
+  return srcLayout.getSizePerThread()[axis] <= getSrcShape()[axis];
+}
+
+unsigned AxisLoweringHelper::getAxisSizePerThread() {
+  return triton::gpu::getSizePerThread(getSrcLayout())[axis];
+}
+
+unsigned AxisLoweringHelper::getAxisNumThreadsPerWarp() {
+  // lanes beyond the end of the axis wrap around
+  auto axisSize = static_cast<unsigned>(getSrcShape()[axis]);
+  return std::min(triton::gpu::getThreadsPerWarp(getSrcLayout())[axis],
+                  ceil<unsigned>(axisSize, getAxisSizePerThread()));
+}
+
+unsigned AxisLoweringHelper::getAxisNumWarps() {
+  auto axisSize = static_cast<unsigned>(getSrcShape()[axis]);
+  unsigned threadsPerWarp =
+      triton::gpu::getThreadsPerWarp(getSrcLayout())[axis];
+  return std::min(triton::gpu::getWarpsPerCTA(getSrcLayout())[axis],
+                  ceil<unsigned>(axisSize,
+                                 getAxisSizePerThread() * threadsPerWarp));
+}
+
+unsigned AxisLoweringHelper::getAxisNumBlocks() {
+  auto axisSize = static_cast<unsigned>(getSrcShape()[axis]);
+  unsigned shapePerCTA = triton::gpu::getShapePerCTA(getSrcLayout())[axis];
+  return ceil<unsigned>(axisSize, shapePerCTA);
+}
+
+SmallVector<unsigned> ScanLoweringHelper::getScratchConfig() {
+  auto smemShape = convertType<unsigned>(getSrcShape());
+  smemShape[axis] = getAxisNumWarps() * getAxisNumBlocks();
+  return smemShape;
+}
+
+unsigned ScanLoweringHelper::getScratchSizeInBytes() {
+  // partial results are carried in registers within a single warp and block
+  if (!isSupported() || getAxisNumWarps() * getAxisNumBlocks() == 1)
+    return 0;
+  unsigned elems = product<unsigned>(getScratchConfig());
+  return elems * ceil<unsigned>(srcTy.getElementTypeBitWidth(), 8);
+}
+
+bool SortLoweringHelper::isCrossWarp() { return getAxisNumWarps() > 1; }
 
-  if (triton::ReduceOp::withIndex(op.redOp()))
-    bytes += elems * sizeof(int32_t);
+bool SortLoweringHelper::isTopK() {
+  auto dstTy = op.result().getType().cast<RankedTensorType>();
+  return dstTy.getShape()[axis] < getSrcShape()[axis];
+}
 
-  return bytes;
+unsigned SortLoweringHelper::getScratchSizeInBytes() {
+  // stages within warps use registers and shuffles only, the whole operand
+  // goes through shared memory to exchange elements across warps and to
+  // gather the first elements in the layout of the result
+  if (!isSupported() || (!isCrossWarp() && !isTopK()))
+    return 0;
+  unsigned elems = product<int64_t>(getSrcShape());
+  return elems * ceil<unsigned>(srcTy.getElementTypeBitWidth(), 8);
 }
 
 bool isSharedEncoding(Value value) {
@@ -113,9 +193,22 @@ bool maybeSharedAllocationOp(Operation *op) {
 bool maybeAliasOp(Operation *op) {
   return isa<tensor::ExtractSliceOp>(op) || isa<triton::TransOp>(op) ||
          isa<triton::gpu::InsertSliceAsyncOp>(op) ||
+         isa<triton::gpu::InsertSliceTMAOp>(op) ||
          isa<tensor::InsertSliceOp>(op);
 }
 
+bool isWeightOnlyQuantizedDot(triton::DotOp op) {
+  auto aElemTy = op.a().getType().cast<RankedTensorType>().getElementType();
+  auto bElemTy = op.b().getType().cast<RankedTensorType>().getElementType();
+  return (aElemTy.isF16() || aElemTy.isBF16()) && bElemTy.isInteger(8);
+}
+
+bool isPackedInt4Dot(triton::DotOp op) {
+  auto aShape = op.a().getType().cast<RankedTensorType>().getShape();
+  auto bShape = op.b().getType().cast<RankedTensorType>().getShape();
+  return isWeightOnlyQuantizedDot(op) && bShape[0] * 2 == aShape[1];
+}
+
 bool supportMMA(triton::DotOp op, int version) {
   // Refer to mma section for the data type supported by Volta and Hopper
   // Tensor Core in
@@ -125,6 +218,9 @@ bool supportMMA(triton::DotOp op, int version) {
   if (aElemTy.isF32() && bElemTy.isF32()) {
     return op.allowTF32() && version >= 2;
   }
+  // $b is only dequantized to the mma.sync layout of $a
+  if (isWeightOnlyQuantizedDot(op))
+    return version == 2;
   return supportMMA(op.a(), version) && supportMMA(op.b(), version);
 }
 
@@ -132,12 +228,48 @@ bool supportMMA(Value value, int version) {
   // Tell whether a DotOp support HMMA by the operand type(either $a or $b).
   // We cannot get both the operand types(in TypeConverter), here we assume the
   // types of both the operands are identical here.
-  assert((version == 1 || version == 2) &&
+  assert((version == 1 || version == 2 || version == 3) &&
          "Unexpected MMA layout version found");
   auto elemTy = value.getType().cast<RankedTensorType>().getElementType();
   return elemTy.isF16() || elemTy.isBF16() ||
          (elemTy.isF32() && version >= 2) ||
-         (elemTy.isInteger(8) && version >= 2);
+         (elemTy.isInteger(8) && version == 2) ||
+         (elemTy.isa<triton::Float8E4M3Type, triton::Float8E5M2Type>() &&
+          version >= 2);
+}
+
+bool supportWGMMA(triton::DotOp op, ArrayRef<unsigned> aOrder,
+                  ArrayRef<unsigned> bOrder, int numWarps) {
+  auto aTy = op.a().getType().cast<RankedTensorType>();
+  auto bTy = op.b().getType().cast<RankedTensorType>();
+  auto dTy = op.getResult().getType().cast<RankedTensorType>();
+  Type elemTy = aTy.getElementType();
+  if (elemTy != bTy.getElementType() || !dTy.getElementType().isF32())
+    return false;
+  // 3xTF32 dots are only split for mma.sync
+  bool isTF32 = elemTy.isF32() && op.allowTF32() && !op.tf32x3();
+  bool isFp8 = elemTy.isa<triton::Float8E4M3Type, triton::Float8E5M2Type>();
+  if (!elemTy.isF16() && !elemTy.isBF16() && !isTF32 && !isFp8)
+    return false;
+  // Every warpgroup computes 64 rows of the tile per instruction
+  int64_t M = aTy.getShape()[0];
+  int64_t K = aTy.getShape()[1];
+  int64_t N = bTy.getShape()[1];
+  if (numWarps % 4 != 0 || M % (16 * numWarps) != 0 || N % 8 != 0)
+    return false;
+  // The contiguous rows of the tiles must be exactly one 32, 64 or 128-byte
+  // swizzling atom: the swizzling of the shared layout is then the one wgmma
+  // expects
+  int64_t bytes = triton::getIntOrFloatBitWidth(elemTy) / 8;
+  auto isSwizzleAtom = [](int64_t rowBytes) {
+    return rowBytes == 32 || rowBytes == 64 || rowBytes == 128;
+  };
+  if (aOrder[0] != 1 || !isSwizzleAtom(K * bytes))
+    return false;
+  // B is either K-major or, for 16-bit types, transposed
+  if (bOrder[0] == 0)
+    return true;
+  return bytes == 2 && isSwizzleAtom(N * bytes);
 }
 
 Type getElementType(Value value) {
@@ -154,14 +286,244 @@ std::string getValueOperandName(Value value, AsmState &state) {
   return opName;
 }
 
-bool isMmaToDotShortcut(triton::gpu::MmaEncodingAttr &mmaLayout,
-                        triton::gpu::DotOperandEncodingAttr &dotOperandLayout) {
-  // dot_op<opIdx=0, parent=#mma> = #mma
-  // when #mma = MmaEncoding<version=2, warpsPerCTA=[..., 1]>
+bool isMmaToDotShortcut(RankedTensorType srcTy, RankedTensorType dstTy) {
+  auto mmaLayout = srcTy.getEncoding().dyn_cast<triton::gpu::MmaEncodingAttr>();
+  auto dotOperandLayout =
+      dstTy.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
+  if (!mmaLayout || !dotOperandLayout || dotOperandLayout.getOpIdx() != 0)
+    return false;
+  auto parent =
+      dotOperandLayout.getParent().dyn_cast<triton::gpu::MmaEncodingAttr>();
+  if (!parent || parent.getVersionMajor() != 2)
+    return false;
+  // dot_op<opIdx=0, parent=#mma1> = #mma0
+  // when #mma0 = MmaEncoding<version=2, warpsPerCTA=[w, 1]> and #mma1 is an
+  // MmaEncoding<version=2, warpsPerCTA=[w, ...]>: with all its warps along M,
+  // each thread holds the accumulators of the rows and columns of the $a
+  // fragments it needs, and $a is replicated along N. The accumulators of
+  // 16-bit elements are already in the order of the m16n8k16 $a fragments;
+  // those of m16n8k8 (tf32) and m16n8k32 (8-bit) are not.
   return mmaLayout.getVersionMajor() == 2 &&
          mmaLayout.getWarpsPerCTA()[1] == 1 &&
-         dotOperandLayout.getOpIdx() == 0 &&
-         dotOperandLayout.getParent() == mmaLayout;
+         parent.getWarpsPerCTA()[0] == mmaLayout.getWarpsPerCTA()[0] &&
+         srcTy.getElementType().getIntOrFloatBitWidth() == 16;
+}
+
+SmallVector<unsigned> delinearize(unsigned linear, ArrayRef<unsigned> shape,
+                                  ArrayRef<unsigned> order) {
+  SmallVector<unsigned> multiDim(shape.size());
+  for (unsigned d : order) {
+    multiDim[d] = linear % shape[d];
+    linear /= shape[d];
+  }
+  return multiDim;
+}
+
+namespace {
+
+/// Returns the row-major index of the element held by each register of each
+/// lane of each warp, at `(warpId * 32 + laneId) * elemsPerThread + reg`, in
+/// the order used by emitIndices. Returns an empty vector if the layout is not
+/// supported or does not tile `type` exactly.
+SmallVector<unsigned> getElementIds(RankedTensorType type) {
+  auto shape = type.getShape();
+  unsigned rank = shape.size();
+  auto layout = type.getEncoding();
+  SmallVector<unsigned> ids;
+  auto linearize = [&](ArrayRef<unsigned> coords) {
+    unsigned id = 0;
+    for (unsigned d = 0; d < rank; ++d)
+      id = id * shape[d] + coords[d];
+    return id;
+  };
+  if (auto blocked = layout.dyn_cast<triton::gpu::BlockedEncodingAttr>()) {
+    auto sizePerThread = blocked.getSizePerThread();
+    auto threadsPerWarp = blocked.getThreadsPerWarp();
+    auto warpsPerCTA = blocked.getWarpsPerCTA();
+    auto order = blocked.getOrder();
+    auto shapePerCTA = triton::gpu::getShapePerCTA(blocked);
+    if (product<unsigned>(threadsPerWarp) != 32)
+      return {};
+    SmallVector<unsigned> tilesPerDim(rank);
+    for (unsigned d = 0; d < rank; ++d) {
+      if (shape[d] % shapePerCTA[d])
+        return {};
+      tilesPerDim[d] = shape[d] / shapePerCTA[d];
+    }
+    unsigned totalSizePerThread = product<unsigned>(sizePerThread);
+    unsigned elems = totalSizePerThread * product<unsigned>(tilesPerDim);
+    unsigned numWarps = product<unsigned>(warpsPerCTA);
+    SmallVector<unsigned> coords(rank);
+    for (unsigned warp = 0; warp < numWarps; ++warp)
+      for (unsigned lane = 0; lane < 32; ++lane)
+        for (unsigned reg = 0; reg < elems; ++reg) {
+          auto warpId = delinearize(warp, warpsPerCTA, order);
+          auto laneId = delinearize(lane, threadsPerWarp, order);
+          auto tileId =
+              delinearize(reg / totalSizePerThread, tilesPerDim, order);
+          auto elemId =
+              delinearize(reg % totalSizePerThread, sizePerThread, order);
+          for (unsigned d = 0; d < rank; ++d)
+            coords[d] = tileId[d] * shapePerCTA[d] +
+                        (warpId[d] * threadsPerWarp[d] + laneId[d]) *
+                            sizePerThread[d] +
+                        elemId[d];
+          ids.push_back(linearize(coords));
+        }
+    return ids;
+  }
+  auto mma = layout.dyn_cast<triton::gpu::MmaEncodingAttr>();
+  if (!mma || !(mma.isAmpere() || mma.isHopper()) || rank != 2)
+    return {};
+  auto warpsPerCTA = mma.getWarpsPerCTA();
+  unsigned rowsPerCTA = 16 * warpsPerCTA[0];
+  unsigned colsPerCTA = 8 * warpsPerCTA[1];
+  if (shape[0] % rowsPerCTA || shape[1] % colsPerCTA)
+    return {};
+  unsigned repsN = shape[1] / colsPerCTA;
+  unsigned elems = shape[0] / rowsPerCTA * repsN * 4;
+  unsigned numWarps = warpsPerCTA[0] * warpsPerCTA[1];
+  for (unsigned warp = 0; warp < numWarps; ++warp)
+    for (unsigned lane = 0; lane < 32; ++lane)
+      for (unsigned reg = 0; reg < elems; ++reg) {
+        unsigned rep = reg / 4;
+        unsigned row = rep / repsN * rowsPerCTA + warp % warpsPerCTA[0] * 16 +
+                       lane / 4 + reg % 4 / 2 * 8;
+        unsigned col = rep % repsN * colsPerCTA + warp / warpsPerCTA[0] * 8 +
+                       lane % 4 * 2 + reg % 2;
+        ids.push_back(linearize({row, col}));
+      }
+  return ids;
+}
+
+} // namespace
+
+bool WarpShuffleConversion::isRegisterPermutation() const {
+  if (regSelMask || llvm::any_of(srcLanes, [](unsigned l) { return l != 0; }))
+    return false;
+  for (unsigned i = 0; i < laneBits.size(); ++i)
+    if (laneBits[i] != (1u << i))
+      return false;
+  return true;
+}
+
+unsigned WarpShuffleConversion::getNumShuffles() const {
+  if (isRegisterPermutation())
+    return 0;
+  return srcRegs.size() * (regSelMask ? 2 : 1);
+}
+
+Optional<WarpShuffleConversion>
+getWarpShuffleConversion(RankedTensorType srcTy, RankedTensorType dstTy) {
+  constexpr unsigned kNone = std::numeric_limits<unsigned>::max();
+  auto srcIds = getElementIds(srcTy);
+  auto dstIds = getElementIds(dstTy);
+  unsigned numElems = srcTy.getNumElements();
+  if (srcIds.size() != numElems || dstIds.size() != numElems)
+    return llvm::None;
+  unsigned warpSize = product<unsigned>(
+      triton::gpu::getThreadsPerWarp(srcTy.getEncoding()));
+  if (warpSize !=
+      product<unsigned>(triton::gpu::getThreadsPerWarp(dstTy.getEncoding())))
+    return llvm::None;
+  unsigned numWarps = product<unsigned>(
+      triton::gpu::getWarpsPerCTA(srcTy.getEncoding()));
+  if (numWarps !=
+      product<unsigned>(triton::gpu::getWarpsPerCTA(dstTy.getEncoding())))
+    return llvm::None;
+  unsigned elemsPerThread = numElems / (numWarps * warpSize);
+
+  // Thread and register holding each element in the source layout
+  SmallVector<unsigned> srcThread(numElems, kNone);
+  SmallVector<unsigned> srcReg(numElems);
+  for (unsigned i = 0; i < numElems; ++i) {
+    unsigned id = srcIds[i];
+    if (srcThread[id] != kNone)
+      return llvm::None;
+    srcThread[id] = i / elemsPerThread;
+    srcReg[id] = i % elemsPerThread;
+  }
+
+  // Source lane and register read by each register of each lane, which must
+  // be the same for all warps
+  SmallVector<unsigned> lanes(elemsPerThread * warpSize, kNone);
+  SmallVector<unsigned> regs(elemsPerThread * warpSize, kNone);
+  SmallVector<bool> seen(numElems, false);
+  for (unsigned i = 0; i < numElems; ++i) {
+    unsigned id = dstIds[i];
+    if (seen[id])
+      return llvm::None;
+    seen[id] = true;
+    unsigned thread = i / elemsPerThread;
+    if (srcThread[id] / warpSize != thread / warpSize)
+      return llvm::None;
+    unsigned idx = (i % elemsPerThread) * warpSize + thread % warpSize;
+    unsigned lane = srcThread[id] % warpSize;
+    if (lanes[idx] != kNone && (lanes[idx] != lane || regs[idx] != srcReg[id]))
+      return llvm::None;
+    lanes[idx] = lane;
+    regs[idx] = srcReg[id];
+  }
+
+  // Both the source lane and the source register must be affine in the bits
+  // of the lane id, and the register can only take two values
+  WarpShuffleConversion cvt;
+  for (unsigned i = 0; (1u << i) < warpSize; ++i) {
+    cvt.laneBits.push_back(lanes[1u << i] ^ lanes[0]);
+    unsigned regBit = regs[1u << i] ^ regs[0];
+    if (!regBit)
+      continue;
+    if (cvt.regBit && cvt.regBit != regBit)
+      return llvm::None;
+    cvt.regBit = regBit;
+    cvt.regSelMask |= 1u << i;
+  }
+  for (unsigned reg = 0; reg < elemsPerThread; ++reg) {
+    cvt.srcLanes.push_back(lanes[reg * warpSize]);
+    cvt.srcRegs.push_back(regs[reg * warpSize]);
+    for (unsigned lane = 0; lane < warpSize; ++lane) {
+      unsigned expectedLane = cvt.srcLanes.back();
+      for (unsigned i = 0; i < cvt.laneBits.size(); ++i)
+        if (lane & (1u << i))
+          expectedLane ^= cvt.laneBits[i];
+      unsigned expectedReg = cvt.srcRegs.back();
+      if (llvm::countPopulation(lane & cvt.regSelMask) % 2)
+        expectedReg ^= cvt.regBit;
+      unsigned idx = reg * warpSize + lane;
+      if (lanes[idx] != expectedLane || regs[idx] != expectedReg)
+        return llvm::None;
+    }
+  }
+  return cvt;
+}
+
+SharedMemoryWavefronts countSharedMemoryWavefronts(ArrayRef<unsigned> addrs,
+                                                   unsigned vecBytes) {
+  // Shared memory has 32 banks of 4 bytes, and serves 128 bytes per wavefront.
+  constexpr unsigned kNumBanks = 32;
+  constexpr unsigned kBankBytes = 4;
+  constexpr unsigned kWavefrontBytes = kNumBanks * kBankBytes;
+  constexpr unsigned kThreadsPerWarp = 32;
+  unsigned threadsPerPhase =
+      vecBytes <= kBankBytes ? kThreadsPerWarp : kWavefrontBytes / vecBytes;
+  unsigned wavefronts = 0;
+  for (size_t begin = 0; begin < addrs.size(); begin += threadsPerPhase) {
+    size_t end = std::min<size_t>(begin + threadsPerPhase, addrs.size());
+    SmallVector<std::set<unsigned>> bankWords(kNumBanks);
+    for (size_t i = begin; i < end; ++i)
+      for (unsigned byte = 0; byte < vecBytes; byte += kBankBytes) {
+        unsigned word = (addrs[i] + byte) / kBankBytes;
+        bankWords[word % kNumBanks].insert(word);
+      }
+    size_t degree = 1;
+    for (auto &words : bankWords)
+      degree = std::max(degree, words.size());
+    wavefronts += degree;
+  }
+  unsigned totalBytes = addrs.size() * vecBytes;
+  unsigned ideal = std::max<unsigned>(
+      1, (totalBytes + kWavefrontBytes - 1) / kWavefrontBytes);
+  return {wavefronts, ideal};
 }
 
 namespace {
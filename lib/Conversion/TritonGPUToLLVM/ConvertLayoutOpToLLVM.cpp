@@ -9,6 +9,7 @@ using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
 using ::mlir::LLVM::getStridesFromShapeAndOrder;
 using ::mlir::LLVM::getStructFromElements;
 using ::mlir::LLVM::MMA16816ConversionHelper;
+using ::mlir::LLVM::shflIdxSync;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::getContigPerThread;
 using ::mlir::triton::gpu::getElemsPerThread;
@@ -21,8 +22,13 @@ using ::mlir::triton::gpu::SharedEncodingAttr;
 struct ConvertLayoutOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::ConvertLayoutOp> {
 public:
-  using ConvertTritonGPUOpToLLVMPattern<
-      triton::gpu::ConvertLayoutOp>::ConvertTritonGPUOpToLLVMPattern;
+  explicit ConvertLayoutOpConversion(
+      LLVMTypeConverter &typeConverter, const Allocation *allocation,
+      Value smem, IndexCacheInfo indexCacheInfo, int computeCapability,
+      PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::gpu::ConvertLayoutOp>(
+            typeConverter, allocation, smem, indexCacheInfo, benefit),
+        computeCapability(computeCapability) {}
 
   LogicalResult
   matchAndRewrite(triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
@@ -41,7 +47,14 @@ public:
         dstLayout.isa<DotOperandEncodingAttr>()) {
       return lowerSharedToDotOperand(op, adaptor, rewriter);
     }
+    if (srcLayout.isa<SharedEncodingAttr>() &&
+        dstLayout.isa<BlockedEncodingAttr>()) {
+      return lowerSharedToDistributed(op, adaptor, rewriter);
+    }
     if (isaDistributedLayout(srcLayout) && isaDistributedLayout(dstLayout)) {
+      if (auto shuffle = getWarpShuffleConversion(srcTy, dstTy))
+        return lowerDistributedToDistributedWithShuffles(op, adaptor, rewriter,
+                                                         *shuffle);
       return lowerDistributedToDistributed(op, adaptor, rewriter);
     }
     if (srcLayout.isa<MmaEncodingAttr>() &&
@@ -90,73 +103,163 @@ private:
       return multiDimOffset;
     }
     if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-      SmallVector<Value> mmaColIdx(4);
-      SmallVector<Value> mmaRowIdx(2);
-      Value threadId = getThreadId(rewriter, loc);
-      Value warpSize = idx_val(32);
-      Value laneId = urem(threadId, warpSize);
-      Value warpId = udiv(threadId, warpSize);
-      // TODO: fix the bug in MMAEncodingAttr document
-      SmallVector<Value> multiDimWarpId(2);
-      multiDimWarpId[0] = urem(warpId, idx_val(mmaLayout.getWarpsPerCTA()[0]));
-      multiDimWarpId[1] = udiv(warpId, idx_val(mmaLayout.getWarpsPerCTA()[0]));
-      Value _1 = idx_val(1);
-      Value _2 = idx_val(2);
-      Value _4 = idx_val(4);
-      Value _8 = idx_val(8);
-      Value _16 = idx_val(16);
-      if (mmaLayout.isAmpere()) {
-        multiDimWarpId[0] = urem(multiDimWarpId[0], idx_val(shape[0] / 16));
-        multiDimWarpId[1] = urem(multiDimWarpId[1], idx_val(shape[1] / 8));
-        Value mmaGrpId = udiv(laneId, _4);
-        Value mmaGrpIdP8 = add(mmaGrpId, _8);
-        Value mmaThreadIdInGrp = urem(laneId, _4);
-        Value mmaThreadIdInGrpM2 = mul(mmaThreadIdInGrp, _2);
-        Value mmaThreadIdInGrpM2P1 = add(mmaThreadIdInGrpM2, _1);
-        Value rowWarpOffset = mul(multiDimWarpId[0], _16);
-        mmaRowIdx[0] = add(mmaGrpId, rowWarpOffset);
-        mmaRowIdx[1] = add(mmaGrpIdP8, rowWarpOffset);
-        Value colWarpOffset = mul(multiDimWarpId[1], _8);
-        mmaColIdx[0] = add(mmaThreadIdInGrpM2, colWarpOffset);
-        mmaColIdx[1] = add(mmaThreadIdInGrpM2P1, colWarpOffset);
-      } else if (mmaLayout.isVolta()) {
-        // Volta doesn't follow the pattern here."
-      } else {
-        llvm_unreachable("Unexpected MMALayout version");
-      }
-
       assert(rank == 2);
-      SmallVector<Value> multiDimOffset(rank);
-      if (mmaLayout.isAmpere()) {
-        multiDimOffset[0] = elemId < 2 ? mmaRowIdx[0] : mmaRowIdx[1];
-        multiDimOffset[1] = elemId % 2 == 0 ? mmaColIdx[0] : mmaColIdx[1];
-        multiDimOffset[0] = add(
-            multiDimOffset[0], idx_val(multiDimCTAInRepId[0] * shapePerCTA[0]));
-        multiDimOffset[1] = add(
-            multiDimOffset[1], idx_val(multiDimCTAInRepId[1] * shapePerCTA[1]));
-      } else if (mmaLayout.isVolta()) {
-        auto [isARow, isBRow, isAVec4, isBVec4, mmaId] =
-            mmaLayout.decodeVoltaLayoutStates();
-        auto coords = DotOpMmaV1ConversionHelper::getMNCoords(
-            threadId, rewriter, mmaLayout.getWarpsPerCTA(), shape, isARow,
-            isBRow, isAVec4, isBVec4);
-        return DotOpMmaV1ConversionHelper::getCoord(elemId, coords);
-      } else {
-        llvm_unreachable("Unexpected MMALayout version");
+      if (mmaLayout.isVolta()) {
+        // Volta doesn't follow the pattern here: the elements of a thread are
+        // at constant offsets from its first one, whose coordinates are
+        // emitted once per function
+        auto multiDimBase =
+            emitBaseIndexForLayout(loc, rewriter, mmaLayout, shape);
+        auto offsets = emitOffsetForLayout(mmaLayout, shape);
+        SmallVector<Value> multiDimOffset(rank);
+        for (unsigned d = 0; d < rank; ++d)
+          multiDimOffset[d] =
+              add(multiDimBase[d], i32_val(offsets[elemId][d]));
+        return multiDimOffset;
       }
+      if (!mmaLayout.isAmpere() && !mmaLayout.isHopper())
+        llvm_unreachable("Unexpected MMALayout version");
+      // Elements 0 and 1 are in adjacent columns, elements 2 and 3 are
+      // eight rows below them
+      auto multiDimBase =
+          emitBaseIndexForLayout(loc, rewriter, mmaLayout, shape);
+      SmallVector<Value> multiDimOffset(rank);
+      multiDimOffset[0] =
+          add(multiDimBase[0], idx_val(multiDimCTAInRepId[0] * shapePerCTA[0] +
+                                       (elemId < 2 ? 0 : 8)));
+      multiDimOffset[1] =
+          add(multiDimBase[1],
+              idx_val(multiDimCTAInRepId[1] * shapePerCTA[1] + elemId % 2));
       return multiDimOffset;
     }
     llvm_unreachable("unexpected layout in getMultiDimOffset");
   }
 
-  // shared memory rd/st for blocked or mma layout with data padding
+  // Offset of `multiDimOffset` in the 2D buffer of shape `repShape`, whose
+  // rows (along outOrd[0]) are xor-swizzled by `swizzle`
+  Value linearizeSwizzled(ConversionPatternRewriter &rewriter, Location loc,
+                          ArrayRef<Value> multiDimOffset,
+                          ArrayRef<unsigned> repShape,
+                          ArrayRef<unsigned> outOrd,
+                          SharedEncodingAttr swizzle) const {
+    Value row = multiDimOffset[outOrd[1]];
+    Value col = multiDimOffset[outOrd[0]];
+    Value vec = idx_val(swizzle.getVec());
+    Value phase = urem(udiv(row, idx_val(swizzle.getPerPhase())),
+                       idx_val(swizzle.getMaxPhase()));
+    Value colOff = add(mul(xor_(udiv(col, vec), phase), vec), urem(col, vec));
+    return add(mul(row, idx_val(repShape[outOrd[0]])), colOff);
+  }
+
+  // Whether the stores of the mma layout `type` to the padded buffer can use
+  // stmatrix, which stores the two 8x8 matrices of 16-bit elements a warp
+  // holds in each tile of the CTA in one instruction. Each lane gives the
+  // address of a row of 8 contiguous elements, which must be 16-byte aligned.
+  bool canUseStmatrix(RankedTensorType type, ArrayRef<unsigned> paddedRepShape,
+                      ArrayRef<unsigned> outOrd,
+                      SharedEncodingAttr swizzle) const {
+    auto mmaLayout = type.getEncoding().dyn_cast<MmaEncodingAttr>();
+    if (computeCapability < 90 || !mmaLayout || mmaLayout.isVolta() || swizzle)
+      return false;
+    auto elemTy = type.getElementType();
+    return elemTy.isIntOrFloat() && elemTy.getIntOrFloatBitWidth() == 16 &&
+           type.getRank() == 2 && outOrd[0] == 1 && paddedRepShape[1] % 8 == 0;
+  }
+
+  // shared memory st for mma layout with data padding, with stmatrix (see
+  // canUseStmatrix)
+  void processReplicaWithStmatrix(Location loc,
+                                  ConversionPatternRewriter &rewriter,
+                                  RankedTensorType type,
+                                  ArrayRef<unsigned> numCTAsEachRep,
+                                  ArrayRef<unsigned> multiDimRepId,
+                                  ArrayRef<unsigned> paddedRepShape,
+                                  ArrayRef<unsigned> outOrd,
+                                  SmallVector<Value> &vals, Value smemBase,
+                                  SmallVector<Value> &elemOffsets) const {
+    auto *ctx = rewriter.getContext();
+    auto layout = type.getEncoding();
+    auto rank = type.getRank();
+    auto accumNumCTAsEachRep = product<unsigned>(numCTAsEachRep);
+    auto accumSizePerThread = product<unsigned>(getSizePerThread(layout));
+    auto shapePerCTA = getShapePerCTA(layout, type.getShape());
+    auto order = getOrder(layout);
+    SmallVector<unsigned> numCTAs(rank);
+    for (unsigned d = 0; d < rank; ++d) {
+      numCTAs[d] = ceil<unsigned>(type.getShape()[d], shapePerCTA[d]);
+    }
+    auto llvmElemTy = getTypeConverter()->convertType(type.getElementType());
+
+    // Elements 0 and 1 of a lane are in row lane / 4 of the 16x8 tile of its
+    // warp, at column 2 * (lane % 4), and elements 2 and 3 eight rows below.
+    // Lane i gives the address of row i % 8 of matrix i / 8, i.e. of row i of
+    // the tile; the addresses of lanes 16 to 31 are ignored.
+    if (elemOffsets.empty()) {
+      SmallVector<unsigned> firstCTAInRepId(rank, 0);
+      SmallVector<Value> multiDimOffset =
+          getMultiDimOffset(layout, loc, rewriter, 0, type.getShape(),
+                            firstCTAInRepId, shapePerCTA);
+      Value laneId = urem(getThreadId(rewriter, loc), idx_val(32));
+      Value row = add(sub(multiDimOffset[0], udiv(laneId, idx_val(4))),
+                      urem(laneId, idx_val(16)));
+      Value col =
+          sub(multiDimOffset[1], mul(urem(laneId, idx_val(4)), idx_val(2)));
+      SmallVector<Value> rowStart = {row, col};
+      elemOffsets.push_back(
+          linearize(rewriter, loc, rowStart, paddedRepShape, outOrd));
+    }
+
+    auto pairTy = vec_ty(llvmElemTy, 2);
+    for (unsigned ctaId = 0; ctaId < accumNumCTAsEachRep; ++ctaId) {
+      auto multiDimCTAInRepId =
+          getMultiDimIndex<unsigned>(ctaId, numCTAsEachRep, order);
+      SmallVector<unsigned> multiDimCTAId(rank);
+      for (const auto &it : llvm::enumerate(multiDimCTAInRepId)) {
+        auto d = it.index();
+        multiDimCTAId[d] = multiDimRepId[d] * numCTAsEachRep[d] + it.value();
+      }
+
+      auto linearCTAId =
+          getLinearIndex<unsigned>(multiDimCTAId, numCTAs, order);
+      SmallVector<unsigned> multiDimCTAOffset(rank);
+      for (unsigned d = 0; d < rank; ++d)
+        multiDimCTAOffset[d] = multiDimCTAInRepId[d] * shapePerCTA[d];
+      unsigned ctaOffset = getLinearIndex<unsigned>(multiDimCTAOffset,
+                                                    paddedRepShape, outOrd);
+      Value offset = elemOffsets[0];
+      if (ctaOffset != 0)
+        offset = add(offset, idx_val(ctaOffset));
+      Value ptr = gep(ptr_ty(llvmElemTy, 3), smemBase, offset);
+
+      // Each register of stmatrix holds two adjacent elements of a row
+      auto pack = [&](unsigned elemId) {
+        Value pair = undef(pairTy);
+        for (unsigned v = 0; v < 2; ++v)
+          pair = insert_element(
+              pairTy, pair, vals[elemId + linearCTAId * accumSizePerThread + v],
+              idx_val(v));
+        return bitcast(pair, i32_ty);
+      };
+      PTXBuilder builder;
+      auto *addrOpr = builder.newAddrOperand(ptr, "r");
+      auto *valsOpr = builder.newListOperand({{pack(0), "r"}, {pack(2), "r"}});
+      auto &stmatrix =
+          *builder.create("stmatrix.sync.aligned.m8n8.x2.shared.b16");
+      stmatrix(addrOpr, valsOpr);
+      builder.launch(rewriter, loc, void_ty(ctx));
+    }
+  }
+
+  // shared memory rd/st for blocked or mma layout with data padding, or with
+  // the xor swizzle `swizzle` if it isn't null
   void processReplica(Location loc, ConversionPatternRewriter &rewriter,
                       bool stNotRd, RankedTensorType type,
                       ArrayRef<unsigned> numCTAsEachRep,
                       ArrayRef<unsigned> multiDimRepId, unsigned vec,
                       ArrayRef<unsigned> paddedRepShape,
                       ArrayRef<unsigned> outOrd, SmallVector<Value> &vals,
-                      Value smemBase) const {
+                      Value smemBase, SmallVector<Value> &elemOffsets,
+                      SharedEncodingAttr swizzle) const {
     auto accumNumCTAsEachRep = product<unsigned>(numCTAsEachRep);
     auto layout = type.getEncoding();
     auto blockedLayout = layout.dyn_cast<BlockedEncodingAttr>();
@@ -182,6 +285,22 @@ private:
 
     auto llvmElemTy = getTypeConverter()->convertType(elemTy);
 
+    // The offset of an element is affine in the id of its CTA: the offsets of
+    // the elements of the first CTA are computed once and shared by all the
+    // replicas, and the other CTAs only add a constant to them. This doesn't
+    // hold once the rows are swizzled, and each CTA computes its own offsets.
+    bool isSwizzled = swizzle && swizzle.getMaxPhase() > 1;
+    if (elemOffsets.empty() && !isSwizzled) {
+      SmallVector<unsigned> firstCTAInRepId(rank, 0);
+      for (unsigned elemId = 0; elemId < accumSizePerThread; elemId += vec) {
+        SmallVector<Value> multiDimOffset =
+            getMultiDimOffset(layout, loc, rewriter, elemId, type.getShape(),
+                              firstCTAInRepId, shapePerCTA);
+        elemOffsets.push_back(
+            linearize(rewriter, loc, multiDimOffset, paddedRepShape, outOrd));
+      }
+    }
+
     for (unsigned ctaId = 0; ctaId < accumNumCTAsEachRep; ++ctaId) {
       auto multiDimCTAInRepId =
           getMultiDimIndex<unsigned>(ctaId, numCTAsEachRep, order);
@@ -193,15 +312,24 @@ private:
 
       auto linearCTAId =
           getLinearIndex<unsigned>(multiDimCTAId, numCTAs, order);
-      // TODO: This is actually redundant index calculation, we should
-      //       consider of caching the index calculation result in case
-      //       of performance issue observed.
+      SmallVector<unsigned> multiDimCTAOffset(rank);
+      for (unsigned d = 0; d < rank; ++d)
+        multiDimCTAOffset[d] = multiDimCTAInRepId[d] * shapePerCTA[d];
+      unsigned ctaOffset = getLinearIndex<unsigned>(multiDimCTAOffset,
+                                                    paddedRepShape, outOrd);
       for (unsigned elemId = 0; elemId < accumSizePerThread; elemId += vec) {
-        SmallVector<Value> multiDimOffset =
-            getMultiDimOffset(layout, loc, rewriter, elemId, type.getShape(),
-                              multiDimCTAInRepId, shapePerCTA);
-        Value offset =
-            linearize(rewriter, loc, multiDimOffset, paddedRepShape, outOrd);
+        Value offset;
+        if (isSwizzled) {
+          SmallVector<Value> multiDimOffset =
+              getMultiDimOffset(layout, loc, rewriter, elemId, type.getShape(),
+                                multiDimCTAInRepId, shapePerCTA);
+          offset = linearizeSwizzled(rewriter, loc, multiDimOffset,
+                                     paddedRepShape, outOrd, swizzle);
+        } else {
+          offset = elemOffsets[elemId / vec];
+          if (ctaOffset != 0)
+            offset = add(offset, idx_val(ctaOffset));
+        }
 
         auto elemPtrTy = ptr_ty(llvmElemTy, 3);
         Value ptr = gep(elemPtrTy, smemBase, offset);
@@ -285,8 +413,6 @@ private:
       std::vector<std::pair<SmallVector<Value>, Value>> coord2val(
           accumSizePerThread);
       for (unsigned elemId = 0; elemId < accumSizePerThread; ++elemId) {
-        // TODO[Superjomn]: Move the coordinate computation out of loop, it is
-        // duplicate in Volta.
         SmallVector<Value> multiDimOffset =
             getMultiDimOffset(layout, loc, rewriter, elemId, type.getShape(),
                               multiDimCTAInRepId, shapePerCTA);
@@ -365,7 +491,7 @@ private:
     auto srcShapePerCTA = getShapePerCTA(srcLayout, srcTy.getShape());
     auto dstShapePerCTA = getShapePerCTA(dstLayout, shape);
 
-    // For Volta, all the coords for a CTA are calculated.
+    // Volta accumulators are stored and loaded by processReplicaForMMAV1
     bool isSrcMmaV1{}, isDstMmaV1{};
     if (auto mmaLayout = srcLayout.dyn_cast<MmaEncodingAttr>()) {
       isSrcMmaV1 = mmaLayout.isVolta();
@@ -382,10 +508,14 @@ private:
                    sliceLayout.getParent().cast<MmaEncodingAttr>().isVolta();
     }
 
+    // The scratch buffer of the epilogue conversions that fit in the shared
+    // memory left by dead buffers holds the whole tensor, which is then
+    // exchanged in one replica
+    bool whole = allocation->isStagedWhole(op);
     for (unsigned d = 0; d < rank; ++d) {
       unsigned inPerCTA = std::min<unsigned>(shape[d], srcShapePerCTA[d]);
       unsigned outPerCTA = std::min<unsigned>(shape[d], dstShapePerCTA[d]);
-      unsigned maxPerCTA = std::max(inPerCTA, outPerCTA);
+      unsigned maxPerCTA = whole ? shape[d] : std::max(inPerCTA, outPerCTA);
       numReplicates[d] = ceil<unsigned>(shape[d], maxPerCTA);
       inNumCTAsEachRep[d] = maxPerCTA / inPerCTA;
       outNumCTAsEachRep[d] = maxPerCTA / outPerCTA;
@@ -397,14 +527,24 @@ private:
     auto accumNumReplicates = product<unsigned>(numReplicates);
     // unsigned elems = getElemsPerThread(srcTy);
     auto vals = getElementsFromStruct(loc, adaptor.src(), rewriter);
+    unsigned outElems = getElemsPerThread(dstTy);
+    auto outOrd = getOrder(dstLayout);
     unsigned inVec = 0;
     unsigned outVec = 0;
-    auto paddedRepShape = getScratchConfigForCvtLayout(op, inVec, outVec);
+    auto paddedRepShape =
+        getScratchConfigForCvtLayout(op, inVec, outVec, whole);
+    // The buffer is swizzled rather than padded when swizzling avoids all the
+    // bank conflicts
+    auto swizzle = getSwizzleForCvtLayout(op, whole);
+    bool useStmatrix =
+        !isSrcMmaV1 && canUseStmatrix(srcTy, paddedRepShape, outOrd, swizzle);
 
-    unsigned outElems = getElemsPerThread(dstTy);
-    auto outOrd = getOrder(dstLayout);
     SmallVector<Value> outVals(outElems);
 
+    // Shared memory offsets of the elements of the first CTA, emitted during
+    // the first replica and reused by the following ones
+    SmallVector<Value> inElemOffsets;
+    SmallVector<Value> outElemOffsets;
     for (unsigned repId = 0; repId < accumNumReplicates; ++repId) {
       auto multiDimRepId =
           getMultiDimIndex<unsigned>(repId, numReplicates, outOrd);
@@ -417,10 +557,14 @@ private:
           processReplicaForMMAV1(loc, rewriter, /*stNotRd*/ true, srcTy,
                                  multiDimRepId, inVec, paddedRepShape, outOrd,
                                  vals, smemBase, shape);
+        else if (useStmatrix)
+          processReplicaWithStmatrix(loc, rewriter, srcTy, inNumCTAsEachRep,
+                                     multiDimRepId, paddedRepShape, outOrd,
+                                     vals, smemBase, inElemOffsets);
         else
           processReplica(loc, rewriter, /*stNotRd*/ true, srcTy,
                          inNumCTAsEachRep, multiDimRepId, inVec, paddedRepShape,
-                         outOrd, vals, smemBase);
+                         outOrd, vals, smemBase, inElemOffsets, swizzle);
       } else {
         assert(0 && "ConvertLayout with input layout not implemented");
         return failure();
@@ -437,7 +581,8 @@ private:
         else
           processReplica(loc, rewriter, /*stNotRd*/ false, dstTy,
                          outNumCTAsEachRep, multiDimRepId, outVec,
-                         paddedRepShape, outOrd, outVals, smemBase);
+                         paddedRepShape, outOrd, outVals, smemBase,
+                         outElemOffsets, swizzle);
       } else {
         assert(0 && "ConvertLayout with output layout not implemented");
         return failure();
@@ -453,6 +598,62 @@ private:
     return success();
   }
 
+  // blocked/mma -> blocked/mma, when every element stays in its warp.
+  // Registers are exchanged with warp shuffles, without shared memory.
+  LogicalResult lowerDistributedToDistributedWithShuffles(
+      triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter,
+      const WarpShuffleConversion &shuffle) const {
+    auto loc = op.getLoc();
+    auto srcTy = op.src().getType().cast<RankedTensorType>();
+    auto dstTy = op.result().getType().cast<RankedTensorType>();
+    auto llvmElemTy = getTypeConverter()->convertType(dstTy.getElementType());
+    auto vals = getElementsFromStruct(loc, adaptor.src(), rewriter);
+    unsigned outElems = shuffle.srcRegs.size();
+    SmallVector<Value> outVals(outElems);
+
+    if (shuffle.isRegisterPermutation()) {
+      for (unsigned reg = 0; reg < outElems; ++reg)
+        outVals[reg] = vals[shuffle.srcRegs[reg]];
+    } else {
+      unsigned warpSize = product<unsigned>(
+          triton::gpu::getThreadsPerWarp(srcTy.getEncoding()));
+      Value laneId = urem(getThreadId(rewriter, loc), idx_val(warpSize));
+      auto isLaneBitSet = [&](unsigned i) {
+        return icmp_ne(and_(laneId, i32_val(1u << i)), i32_val(0));
+      };
+      // Lane read by the first register, and parity of the lane bits that
+      // select the source register
+      Value srcLaneBase = i32_val(0);
+      Value regSel = int_val(1, 0);
+      for (unsigned i = 0; i < shuffle.laneBits.size(); ++i) {
+        if (shuffle.laneBits[i])
+          srcLaneBase = xor_(srcLaneBase,
+                             select(isLaneBitSet(i),
+                                    i32_val(shuffle.laneBits[i]), i32_val(0)));
+        if (shuffle.regSelMask & (1u << i))
+          regSel = xor_(regSel, isLaneBitSet(i));
+      }
+      for (unsigned reg = 0; reg < outElems; ++reg) {
+        Value srcLane = xor_(srcLaneBase, i32_val(shuffle.srcLanes[reg]));
+        unsigned srcReg = shuffle.srcRegs[reg];
+        outVals[reg] = shflIdxSync(loc, rewriter, vals[srcReg], srcLane);
+        if (shuffle.regSelMask) {
+          Value other = shflIdxSync(loc, rewriter,
+                                    vals[srcReg ^ shuffle.regBit], srcLane);
+          outVals[reg] = select(regSel, other, outVals[reg]);
+        }
+      }
+    }
+
+    SmallVector<Type> types(outElems, llvmElemTy);
+    auto *ctx = llvmElemTy.getContext();
+    Type structTy = struct_ty(types);
+    Value result = getStructFromElements(loc, outVals, rewriter, structTy);
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
   // blocked -> shared.
   // Swizzling in shared memory to avoid bank conflict. Normally used for
   // A/B operands of dots.
@@ -489,6 +690,51 @@ private:
     return success();
   }
 
+  // shared -> blocked.
+  // The tensors staged in shared memory once for several conversions (see
+  // the DecomposeConversions pass) are read back with the same swizzled
+  // addresses as they were written with.
+  LogicalResult
+  lowerSharedToDistributed(triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
+                           ConversionPatternRewriter &rewriter) const {
+    auto loc = op.getLoc();
+    auto *ctx = rewriter.getContext();
+    Value src = op.src();
+    Value dst = op.result();
+    auto srcTy = src.getType().cast<RankedTensorType>();
+    auto dstTy = dst.getType().cast<RankedTensorType>();
+    assert(dstTy.getRank() == 2 &&
+           "Unexpected rank of ConvertLayout(shared->blocked)");
+    auto srcSharedLayout = srcTy.getEncoding().cast<SharedEncodingAttr>();
+    auto dstLayout = dstTy.getEncoding();
+    auto outOrd = getOrder(dstLayout);
+    assert(outOrd == srcSharedLayout.getOrder() &&
+           "ConvertLayout(shared->blocked) must keep the order");
+    auto elemTy = getTypeConverter()->convertType(dstTy.getElementType());
+    auto smemObj =
+        getSharedMemoryObjectFromStruct(loc, adaptor.src(), rewriter);
+    unsigned outVec = getContigPerThread(dstLayout)[outOrd[0]];
+    unsigned minVec = std::min(outVec, srcSharedLayout.getVec());
+    SmallVector<Value> offsetVals = smemObj.offsets;
+    SmallVector<Value> strides = smemObj.strides;
+    DenseMap<unsigned, Value> sharedPtrs =
+        getSwizzledSharedPtrs(loc, outVec, dstTy, srcSharedLayout, elemTy,
+                              smemObj, rewriter, offsetVals, strides);
+    unsigned outElems = getElemsPerThread(dstTy);
+    auto wordTy = vec_ty(elemTy, minVec);
+    SmallVector<Value> outVals(outElems);
+    for (unsigned i = 0; i < outElems; i += minVec) {
+      Value word = load(bitcast(sharedPtrs[i], ptr_ty(wordTy, 3)));
+      for (unsigned v = 0; v < minVec; ++v)
+        outVals[i + v] = extract_element(elemTy, word, i32_val(v));
+    }
+    SmallVector<Type> types(outElems, elemTy);
+    Value result = getStructFromElements(loc, outVals, rewriter,
+                                         struct_ty(types));
+    rewriter.replaceOp(op, result);
+    return success();
+  }
+
   // shared -> mma_operand
   LogicalResult
   lowerSharedToDotOperand(triton::gpu::ConvertLayoutOp op, OpAdaptor adaptor,
@@ -544,11 +790,7 @@ private:
     auto loc = op.getLoc();
     auto srcTy = op.src().getType().cast<RankedTensorType>();
     auto dstTy = op.result().getType().cast<RankedTensorType>();
-    auto srcLayout = srcTy.getEncoding();
-    auto dstLayout = dstTy.getEncoding();
-    auto srcMmaLayout = srcLayout.cast<MmaEncodingAttr>();
-    auto dstDotLayout = dstLayout.cast<DotOperandEncodingAttr>();
-    if (isMmaToDotShortcut(srcMmaLayout, dstDotLayout)) {
+    if (isMmaToDotShortcut(srcTy, dstTy)) {
       // get source values
       auto vals = getElementsFromStruct(loc, adaptor.src(), rewriter);
       unsigned elems = getElemsPerThread(srcTy);
@@ -601,6 +843,10 @@ private:
     auto loc = op.getLoc();
     Value src = op.src();
     Value dst = op.result();
+    // wgmma reads its operands from shared memory: the dot operand is the
+    // shared memory object itself
+    if (mmaLayout.isHopper())
+      return adaptor.src();
     bool isHMMA = supportMMA(dst, mmaLayout.getVersionMajor());
 
     auto smemObj =
@@ -651,6 +897,34 @@ private:
     }
     return res;
   }
+
+  int computeCapability;
+};
+
+struct DequantizeOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::DequantizeOp> {
+public:
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::DequantizeOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::DequantizeOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    auto dstTy = op.result().getType().cast<RankedTensorType>();
+    auto dotOperandLayout = dstTy.getEncoding().cast<DotOperandEncodingAttr>();
+    auto mmaLayout = dotOperandLayout.getParent().dyn_cast<MmaEncodingAttr>();
+    if (!mmaLayout || !mmaLayout.isAmpere() ||
+        dotOperandLayout.getOpIdx() != 1)
+      return failure();
+    auto smemObj =
+        getSharedMemoryObjectFromStruct(loc, adaptor.src(), rewriter);
+    MMA16816ConversionHelper mmaHelper(dstTy, mmaLayout,
+                                       getThreadId(rewriter, loc), rewriter,
+                                       getTypeConverter(), loc);
+    rewriter.replaceOp(op, mmaHelper.dequantizeB(op.src(), dstTy, smemObj));
+    return success();
+  }
 };
 
 void populateConvertLayoutOpToLLVMPatterns(
@@ -658,7 +932,10 @@ void populateConvertLayoutOpToLLVMPatterns(
     int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
     const Allocation *allocation, Value smem,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
+    int computeCapability, PatternBenefit benefit) {
   patterns.add<ConvertLayoutOpConversion>(typeConverter, allocation, smem,
-                                          indexCacheInfo, benefit);
+                                          indexCacheInfo, computeCapability,
+                                          benefit);
+  patterns.add<DequantizeOpConversion>(typeConverter, allocation, smem,
+                                       indexCacheInfo, benefit);
 }
@@ -505,13 +505,14 @@ struct DotOpMmaV1ConversionHelper {
     return M / shapePerCTAM * param.rep[0];
   }
 
-  using CoordTy = SmallVector<Value, 2>;
-  // Get the coordinates(m,n) of the elements emit by a thread in accumulator.
-  static SmallVector<CoordTy>
-  getMNCoords(Value thread, ConversionPatternRewriter &rewriter,
-              ArrayRef<unsigned> wpt, ArrayRef<int64_t> shape, bool isARow,
-              bool isBRow, bool isAVec4, bool isBVec4) {
-
+  // Get the coordinates (m,n) of the first element of the accumulator held
+  // by `thread`. The other elements are at constant offsets from it, see
+  // getMNOffsets.
+  static SmallVector<Value> getMNBase(Value thread,
+                                      ConversionPatternRewriter &rewriter,
+                                      ArrayRef<unsigned> wpt, bool isARow,
+                                      bool isBRow, bool isAVec4,
+                                      bool isBVec4) {
     auto *ctx = thread.getContext();
     auto loc = UnknownLoc::get(ctx);
     Value _1 = i32_val(1);
@@ -527,7 +528,6 @@ struct DotOpMmaV1ConversionHelper {
 
     SmallVector<int, 2> rep({aParam.rep[0], bParam.rep[1]});
     SmallVector<int, 2> spw({aParam.spw[0], bParam.spw[1]});
-    SmallVector<unsigned, 2> shapePerCTA({spw[0] * wpt[0], spw[1] * wpt[1]});
 
     Value lane = urem(thread, _32);
     Value warp = udiv(thread, _32);
@@ -541,7 +541,6 @@ struct DotOpMmaV1ConversionHelper {
     Value offWarpN = mul(warp1, i32_val(spw[1]));
     // quad offset
     Value offQuadM = mul(udiv(and_(lane, _16), _4), _fpw0);
-    Value offQuadN = mul(udiv(and_(lane, _16), _4), _fpw1);
     // pair offset
     Value offPairM = udiv(urem(lane, _16), _4);
     offPairM = urem(offPairM, _fpw0);
@@ -555,56 +554,51 @@ struct DotOpMmaV1ConversionHelper {
     offPairM = mul(offPairM, i32_val(rep[0] / 2));
     offQuadM = mul(offQuadM, i32_val(rep[0] / 2));
     offPairN = mul(offPairN, i32_val(rep[1] / 2));
-    offQuadN = mul(offQuadN, i32_val(rep[1] / 2));
 
     // quad pair offset
     Value offLaneM = add(offPairM, offQuadM);
-    Value offLaneN = add(offPairN, offQuadN);
-    // a, b offset
+    // a offset
     Value offsetAM = add(offWarpM, offLaneM);
-    Value offsetBN = add(offWarpN, offLaneN);
-    // m indices
     Value offsetCM = add(and_(lane, _1), offsetAM);
-    SmallVector<Value> idxM;
+    Value offsetCN = add((and_(lane, _2)), (add(offWarpN, offPairN)));
+    return {offsetCM, offsetCN};
+  }
+
+  // Get the offsets (m,n) of the elements of the accumulator held by a thread
+  // from the first one, in the order of its values: the elements along M
+  // come first.
+  static SmallVector<SmallVector<unsigned>>
+  getMNOffsets(ArrayRef<unsigned> wpt, ArrayRef<int64_t> shape, bool isARow,
+               bool isBRow, bool isAVec4, bool isBVec4) {
+    DotOpMmaV1ConversionHelper::AParam aParam(isARow, isAVec4);
+    DotOpMmaV1ConversionHelper::BParam bParam(isBRow, isBVec4);
+
+    SmallVector<int, 2> rep({aParam.rep[0], bParam.rep[1]});
+    SmallVector<int, 2> spw({aParam.spw[0], bParam.spw[1]});
+    SmallVector<unsigned, 2> shapePerCTA({spw[0] * wpt[0], spw[1] * wpt[1]});
+
+    // m offsets
+    SmallVector<unsigned> offM;
     for (unsigned m = 0; m < shape[0]; m += shapePerCTA[0])
       for (unsigned mm = 0; mm < rep[0]; ++mm)
-        idxM.push_back(add(offsetCM, i32_val(m + mm * 2)));
+        offM.push_back(m + mm * 2);
 
-    // n indices
-    Value offsetCN = add((and_(lane, _2)), (add(offWarpN, offPairN)));
-    SmallVector<Value> idxN;
+    // n offsets
+    SmallVector<unsigned> offN;
     for (int n = 0; n < shape[1]; n += shapePerCTA[1]) {
       for (int nn = 0; nn < rep[1]; ++nn) {
-        idxN.push_back(add(offsetCN, i32_val(n + nn / 2 * 4 +
-                                             (nn % 2) * 2 * fpw[1] * rep[1])));
-        idxN.push_back(
-            add(offsetCN,
-                i32_val(n + nn / 2 * 4 + (nn % 2) * 2 * fpw[1] * rep[1] + 1)));
-      }
-    }
-
-    SmallVector<SmallVector<Value>> axes({idxM, idxN});
-
-    // product the axis M and axis N to get coords, ported from
-    // generator::init_idx method from triton2.0
-
-    // TODO[Superjomn]: check the order.
-    SmallVector<CoordTy> coords;
-    for (Value x1 : axes[1]) {   // N
-      for (Value x0 : axes[0]) { // M
-        SmallVector<Value, 2> idx(2);
-        idx[0] = x0; // M
-        idx[1] = x1; // N
-        coords.push_back(std::move(idx));
+        offN.push_back(n + nn / 2 * 4 + (nn % 2) * 2 * fpw[1] * rep[1]);
+        offN.push_back(n + nn / 2 * 4 + (nn % 2) * 2 * fpw[1] * rep[1] + 1);
       }
     }
 
-    return coords; // {M,N} in row-major
-  }
-
-  // \param elemId the offset of the element in a thread
-  static CoordTy getCoord(int elemId, ArrayRef<CoordTy> coords) {
-    return coords[elemId];
+    // product the axis M and axis N, ported from generator::init_idx method
+    // from triton2.0
+    SmallVector<SmallVector<unsigned>> offsets;
+    for (unsigned n : offN)
+      for (unsigned m : offM)
+        offsets.push_back({m, n});
+    return offsets;
   }
 
 private:
@@ -619,6 +613,8 @@ struct DotOpMmaV2ConversionHelper {
     FP32_FP16_FP16_FP32 = 0, // default
     FP32_BF16_BF16_FP32,
     FP32_TF32_TF32_FP32,
+    FP32_FP8E4M3_FP8E4M3_FP32, // sm_89 and later
+    FP32_FP8E5M2_FP8E5M2_FP32, // sm_89 and later
     // integer tensor core instr
     INT32_INT1_INT1_INT32, // Not implemented
     INT32_INT4_INT4_INT32, // Not implemented
@@ -667,6 +663,8 @@ struct DotOpMmaV2ConversionHelper {
       return ptr_ty(type::i16Ty(ctx), 3);
     case TensorCoreType::FP32_TF32_TF32_FP32:
       return ptr_ty(type::f32Ty(ctx), 3);
+    case TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32:
+    case TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32:
     case TensorCoreType::INT32_INT8_INT8_INT32:
       return ptr_ty(type::i8Ty(ctx), 3);
     default:
@@ -700,6 +698,8 @@ struct DotOpMmaV2ConversionHelper {
       return bf16x2Pack4Ty;
     case TensorCoreType::FP32_TF32_TF32_FP32:
       return fp32Pack4Ty;
+    case TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32:
+    case TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32:
     case TensorCoreType::INT32_INT8_INT8_INT32:
       return i8x4Pack4Ty;
     default:
@@ -717,6 +717,8 @@ struct DotOpMmaV2ConversionHelper {
       return vec_ty(type::bf16Ty(ctx), 2);
     case TensorCoreType::FP32_TF32_TF32_FP32:
       return type::f32Ty(ctx);
+    case TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32:
+    case TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32:
     case TensorCoreType::INT32_INT8_INT8_INT32:
       return type::i32Ty(ctx);
     default:
@@ -739,6 +741,8 @@ struct DotOpMmaV2ConversionHelper {
     case TensorCoreType::FP32_BF16_BF16_FP32:
       return fp32x4Ty;
     case TensorCoreType::FP32_TF32_TF32_FP32:
+    case TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32:
+    case TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32:
       return fp32x4Ty;
     case TensorCoreType::INT32_INT8_INT8_INT32:
       return i32x4Ty;
@@ -777,6 +781,10 @@ struct DotOpMmaV2ConversionHelper {
       return TensorCoreType::FP32_TF32_TF32_FP32;
     if (elemTy.isBF16())
       return TensorCoreType::FP32_BF16_BF16_FP32;
+    if (elemTy.isa<triton::Float8E4M3Type>())
+      return TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32;
+    if (elemTy.isa<triton::Float8E5M2Type>())
+      return TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32;
     if (elemTy.isInteger(8))
       return TensorCoreType::INT32_INT8_INT8_INT32;
     return TensorCoreType::NOT_APPLICABLE;
@@ -810,6 +818,12 @@ struct DotOpMmaV2ConversionHelper {
       if (aTy.getElementType().isF32() && bTy.getElementType().isF32() &&
           op.allowTF32())
         return TensorCoreType::FP32_TF32_TF32_FP32;
+      if (aTy.getElementType().isa<triton::Float8E4M3Type>() &&
+          bTy.getElementType().isa<triton::Float8E4M3Type>())
+        return TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32;
+      if (aTy.getElementType().isa<triton::Float8E5M2Type>() &&
+          bTy.getElementType().isa<triton::Float8E5M2Type>())
+        return TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32;
     } else if (dTy.getElementType().isInteger(32)) {
       if (aTy.getElementType().isInteger(8) &&
           bTy.getElementType().isInteger(8))
@@ -831,6 +845,8 @@ private:
           {TensorCoreType::FP32_FP16_FP16_FP32, {16, 8, 16}},
           {TensorCoreType::FP32_BF16_BF16_FP32, {16, 8, 16}},
           {TensorCoreType::FP32_TF32_TF32_FP32, {16, 8, 8}},
+          {TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32, {16, 8, 32}},
+          {TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32, {16, 8, 32}},
 
           {TensorCoreType::INT32_INT1_INT1_INT32, {16, 8, 256}},
           {TensorCoreType::INT32_INT4_INT4_INT32, {16, 8, 64}},
@@ -846,6 +862,8 @@ private:
           {TensorCoreType::FP32_FP16_FP16_FP32, {8, 8, 8}},
           {TensorCoreType::FP32_BF16_BF16_FP32, {8, 8, 8}},
           {TensorCoreType::FP32_TF32_TF32_FP32, {8, 8, 4}},
+          {TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32, {8, 8, 16}},
+          {TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32, {8, 8, 16}},
 
           {TensorCoreType::INT32_INT1_INT1_INT32, {8, 8, 64}},
           {TensorCoreType::INT32_INT4_INT4_INT32, {8, 8, 32}},
@@ -863,6 +881,10 @@ private:
        "mma.sync.aligned.m16n8k16.row.col.f32.bf16.bf16.f32"},
       {TensorCoreType::FP32_TF32_TF32_FP32,
        "mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32"},
+      {TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32,
+       "mma.sync.aligned.m16n8k32.row.col.f32.e4m3.e4m3.f32"},
+      {TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32,
+       "mma.sync.aligned.m16n8k32.row.col.f32.e5m2.e5m2.f32"},
 
       {TensorCoreType::INT32_INT1_INT1_INT32,
        "mma.sync.aligned.m16n8k256.row.col.s32.b1.b1.s32.xor.popc"},
@@ -877,6 +899,8 @@ private:
       {TensorCoreType::FP32_FP16_FP16_FP32, 8},
       {TensorCoreType::FP32_BF16_BF16_FP32, 8},
       {TensorCoreType::FP32_TF32_TF32_FP32, 4},
+      {TensorCoreType::FP32_FP8E4M3_FP8E4M3_FP32, 16},
+      {TensorCoreType::FP32_FP8E5M2_FP8E5M2_FP32, 16},
 
       {TensorCoreType::INT32_INT1_INT1_INT32, 128},
       {TensorCoreType::INT32_INT4_INT4_INT32, 32},
@@ -1492,6 +1516,86 @@ struct MMA16816ConversionHelper {
     return result;
   }
 
+  // Loading the int8, or packed int4, $b of a weight-only quantized dot from
+  // smem and dequantizing it to the 16-bit float layout of $b, returns a
+  // LLVM::Struct. \param type is the dequantized type of $b.
+  Value dequantizeB(Value tensor, RankedTensorType type,
+                    const SharedMemoryObject &smemObj) {
+    auto tensorTy = tensor.getType().cast<RankedTensorType>();
+    auto sharedLayout = tensorTy.getEncoding().cast<SharedEncodingAttr>();
+    auto order = sharedLayout.getOrder();
+    int K = type.getShape()[0];
+    int N = type.getShape()[1];
+    bool isInt4 = tensorTy.getShape()[0] * 2 == K;
+    bool isBF16 = type.getElementType().isBF16();
+    int numRepK = getNumRepK(type, K);
+    int numRepN = getNumRepN(type, N);
+
+    // Each thread holds the pairs of rows (k, k + 1) of column n of $b, with
+    // k = 2 * (lane % 4) + 8 * kMat and n = lane / 4 + 8 * warpN +
+    // 8 * wpt[1] * repN, that mma.m16n8k16 expects.
+    Value warpN = getWarpN(N);
+    Value lane4 = urem(lane, i32_val(4));
+    Value colBase = add(udiv(lane, i32_val(4)), mul(warpN, i32_val(8)));
+
+    Type bytePtrTy = ptr_ty(i8_ty, 3);
+    Value cSwizzleOffset = smemObj.getCSwizzleOffset(order[0]);
+    Value base =
+        bitcast(smemObj.getBaseBeforeSwizzle(order[0], loc, rewriter),
+                bytePtrTy);
+    int vec = sharedLayout.getVec();
+    int perPhase = sharedLayout.getPerPhase();
+    int maxPhase = sharedLayout.getMaxPhase();
+    // Pointer to the byte at (k, n) of the swizzled tile
+    auto getPtr = [&](Value k, Value n) -> Value {
+      Value idx[2] = {k, n};
+      Value col = add(idx[order[0]], cSwizzleOffset);
+      Value row = idx[order[1]];
+      Value phase = urem(udiv(row, i32_val(perPhase)), i32_val(maxPhase));
+      Value colOff = add(mul(xor_(udiv(col, i32_val(vec)), phase),
+                             i32_val(vec)),
+                         urem(col, i32_val(vec)));
+      Value offset = add(mul(row, smemObj.strides[order[1]]),
+                         mul(colOff, smemObj.strides[order[0]]));
+      return gep(bytePtrTy, base, offset);
+    };
+    // Adjacent rows of an int8 tile are contiguous in the same swizzling
+    // vector if the tile is K-major
+    bool loadPairs = order[0] == 0 && (vec >= 2 || maxPhase == 1);
+
+    // Loads the two weights of rows (k, k + 1) into the low bits of an i32
+    auto loadWeights = [&](Value k, Value n) -> Value {
+      if (isInt4)
+        return zext(i32_ty, load(getPtr(udiv(k, i32_val(2)), n)));
+      if (loadPairs)
+        return zext(i32_ty, load(bitcast(getPtr(k, n), ptr_ty(i16_ty, 3))));
+      Value pair = undef(vec_ty(i8_ty, 2));
+      pair = insert_element(vec_ty(i8_ty, 2), pair, load(getPtr(k, n)),
+                            i32_val(0));
+      pair = insert_element(vec_ty(i8_ty, 2), pair,
+                            load(getPtr(add(k, i32_val(1)), n)), i32_val(1));
+      return zext(i32_ty, bitcast(pair, i16_ty));
+    };
+
+    Type elemTy = typeConverter->convertType(type)
+                      .cast<LLVM::LLVMStructType>()
+                      .getBody()[0];
+    ValueTable hb;
+    for (int n = 0; n < 2 * std::max(numRepN / 2, 1); ++n) {
+      // Without a second repetition along N, the table is padded with the
+      // first one, as ldmatrix does
+      Value col = add(colBase, i32_val(std::min(n, numRepN - 1) * 8 * wpt[1]));
+      for (int kMat = 0; kMat < 2 * numRepK; ++kMat) {
+        Value row = add(mul(lane4, i32_val(2)), i32_val(8 * kMat));
+        Value weights = loadWeights(row, col);
+        hb[{n, kMat}] =
+            bitcast(dequantizeWeightPair(weights, isInt4, isBF16), elemTy);
+      }
+    }
+    return composeValuesToDotOperandLayoutStruct(hb, std::max(numRepN / 2, 1),
+                                                 numRepK);
+  }
+
   // Loading $c to registers, returns a Value.
   Value loadC(Value tensor, Value llTensor) const {
     auto tensorTy = tensor.getType().cast<RankedTensorType>();
@@ -1537,7 +1641,20 @@ struct MMA16816ConversionHelper {
         loadedB, std::max(numRepN / 2, 1), numRepK);
     auto fc = getElementsFromStruct(loc, loadedC, rewriter);
 
-    auto callMma = [&](unsigned m, unsigned n, unsigned k) {
+    // 3xTF32: a = aHi + aLo and b = bHi + bLo, the small products are
+    // accumulated first and aLo * bLo is dropped.
+    ValueTable haLo, hbLo;
+    bool isTF32x3 = op.tf32x3() && DotOpMmaV2ConversionHelper::getMmaType(op) ==
+                                       TensorCoreType::FP32_TF32_TF32_FP32;
+    if (isTF32x3) {
+      for (auto &[idx, val] : ha)
+        std::tie(val, haLo[idx]) = splitTF32(val);
+      for (auto &[idx, val] : hb)
+        std::tie(val, hbLo[idx]) = splitTF32(val);
+    }
+
+    auto callMma = [&](ValueTable &va, ValueTable &vb, unsigned m, unsigned n,
+                       unsigned k) {
       unsigned colsPerThread = numRepN * 2;
       PTXBuilder builder;
       auto &mma = *builder.create(helper.getMmaInstr().str());
@@ -1545,13 +1662,13 @@ struct MMA16816ConversionHelper {
       bool isIntMMA = dTensorTy.getElementType().isInteger(32);
       auto retArgs = builder.newListOperand(4, isIntMMA ? "=r" : "=f");
       auto aArgs = builder.newListOperand({
-          {ha[{m, k}], "r"},
-          {ha[{m + 1, k}], "r"},
-          {ha[{m, k + 1}], "r"},
-          {ha[{m + 1, k + 1}], "r"},
+          {va[{m, k}], "r"},
+          {va[{m + 1, k}], "r"},
+          {va[{m, k + 1}], "r"},
+          {va[{m + 1, k + 1}], "r"},
       });
       auto bArgs =
-          builder.newListOperand({{hb[{n, k}], "r"}, {hb[{n, k + 1}], "r"}});
+          builder.newListOperand({{vb[{n, k}], "r"}, {vb[{n, k + 1}], "r"}});
       auto cArgs = builder.newListOperand();
       for (int i = 0; i < 4; ++i) {
         cArgs->listAppend(builder.newOperand(fc[m * colsPerThread + 4 * n + i],
@@ -1570,8 +1687,13 @@ struct MMA16816ConversionHelper {
 
     for (int k = 0; k < numRepK; ++k)
       for (int m = 0; m < numRepM; ++m)
-        for (int n = 0; n < numRepN; ++n)
-          callMma(2 * m, n, 2 * k);
+        for (int n = 0; n < numRepN; ++n) {
+          if (isTF32x3) {
+            callMma(haLo, hb, 2 * m, n, 2 * k);
+            callMma(ha, hbLo, 2 * m, n, 2 * k);
+          }
+          callMma(ha, hb, 2 * m, n, 2 * k);
+        }
 
     Type resElemTy = dTensorTy.getElementType();
 
@@ -1589,6 +1711,72 @@ struct MMA16816ConversionHelper {
   }
 
 private:
+  // Splits the f32 held by \param val into its tf32 part and the remainder,
+  // which is exact in f32 and whose own tf32 rounding is the only error left.
+  std::pair<Value, Value> splitTF32(Value val) const {
+    Type ty = val.getType();
+    // tf32 keeps the top 10 of the 23 mantissa bits
+    Value hi = bitcast(and_(bitcast(val, i32_ty), i32_val(~0x1fff)), ty);
+    Value lo = rewriter.create<LLVM::FSubOp>(loc, val, hi);
+    return {hi, lo};
+  }
+
+  // Converts the two int8 weights held by the low 16 bits of \param weights,
+  // or the two int4 weights of its low byte, to a pair of f16 or bf16 values
+  // packed in an i32. 16-bit float weights are built around a magic number
+  // whose mantissa holds the unsigned (offset) weight, then shifted back.
+  Value dequantizeWeightPair(Value weights, bool isInt4, bool isBF16) const {
+    PTXBuilder builder;
+    std::string ptxAsm;
+    if (isInt4 && !isBF16)
+      // 1024 + (w + 8) in f16 is 0x6400 | (w + 8)
+      ptxAsm = "{                                                \n"
+               ".reg .b32 a, b;                                  \n"
+               "xor.b32 a, $1, 0x88;                             \n"
+               "shl.b32 b, a, 12;                                \n"
+               "or.b32 a, a, b;                                  \n"
+               "lop3.b32 a, a, 0x000f000f, 0x64006400, 0xea;     \n"
+               "mov.b32 b, 0x64086408;                           \n"
+               "sub.f16x2 $0, a, b;                              \n"
+               "}";
+    else if (isInt4)
+      // 128 + (w + 8) in bf16 is 0x4300 | (w + 8)
+      ptxAsm = "{                                                \n"
+               ".reg .b32 a, b, c;                               \n"
+               "xor.b32 a, $1, 0x88;                             \n"
+               "shl.b32 b, a, 12;                                \n"
+               "or.b32 a, a, b;                                  \n"
+               "lop3.b32 a, a, 0x000f000f, 0x43004300, 0xea;     \n"
+               "mov.b32 b, 0x3f803f80;                           \n"
+               "mov.b32 c, 0xc308c308;                           \n"
+               "fma.rn.bf16x2 $0, a, b, c;                       \n"
+               "}";
+    else if (!isBF16)
+      // 1024 + (w + 128) in f16 is 0x6400 | (w + 128)
+      ptxAsm = "{                                                \n"
+               ".reg .b32 a, b;                                  \n"
+               "prmt.b32 a, $1, 0x64646464, 0x5140;              \n"
+               "xor.b32 a, a, 0x00800080;                        \n"
+               "mov.b32 b, 0x64806480;                           \n"
+               "sub.f16x2 $0, a, b;                              \n"
+               "}";
+    else
+      // int8 values are exact in bf16: truncate their f32 conversions
+      ptxAsm = "{                                                \n"
+               ".reg .b32 a, b;                                  \n"
+               "prmt.b32 a, $1, 0, 0x8880;                       \n"
+               "prmt.b32 b, $1, 0, 0x9991;                       \n"
+               "cvt.rn.f32.s32 a, a;                             \n"
+               "cvt.rn.f32.s32 b, b;                             \n"
+               "prmt.b32 $0, a, b, 0x7632;                       \n"
+               "}";
+    auto &call = *builder.create(ptxAsm);
+    auto *res = builder.newOperand("=r");
+    auto *in = builder.newOperand(weights, "r");
+    call({res, in}, /*onlyAttachMLIRArgs=*/true);
+    return builder.launch(rewriter, loc, i32_ty, false);
+  }
+
   std::function<void(int, int)>
   getLoadMatrixFn(Value tensor, const SharedMemoryObject &smemObj,
                   MmaEncodingAttr mmaLayout, int wpt, uint32_t kOrder,
@@ -1600,7 +1788,8 @@ private:
     auto sharedLayout = tensorTy.getEncoding().cast<SharedEncodingAttr>();
     const int perPhase = sharedLayout.getPerPhase();
     const int maxPhase = sharedLayout.getMaxPhase();
-    const int elemBytes = tensorTy.getElementTypeBitWidth() / 8;
+    const int elemBytes =
+        triton::getIntOrFloatBitWidth(tensorTy.getElementType()) / 8;
     auto order = sharedLayout.getOrder();
 
     // the original register_lds2, but discard the prefetch logic.
@@ -1701,6 +1890,81 @@ private:
   }
 };
 
+// Helper for conversion of DotOp with mma<version=3>, that is sm>=90. The
+// operands are read by wgmma.mma_async straight from their swizzled shared
+// memory tiles, through matrix descriptors.
+struct DotOpMmaV3ConversionHelper {
+  MmaEncodingAttr mmaLayout;
+
+  explicit DotOpMmaV3ConversionHelper(MmaEncodingAttr mmaLayout)
+      : mmaLayout(mmaLayout) {}
+
+  // Rows of the tile computed by the instruction of a warpgroup
+  static constexpr int instrM = 64;
+  // Bytes of each row of the operands read along K by an instruction
+  static constexpr int instrKBytes = 32;
+  static constexpr int warpsPerWarpGroup = 4;
+
+  // Get the widest N, up to 256, of an instruction tiling N.
+  static int getInstrN(int N) {
+    for (int n = std::min(N, 256); n > 8; n -= 8)
+      if (N % n == 0)
+        return n;
+    return 8;
+  }
+
+  // Get the number of rows of the tile computed by the warpgroups together.
+  int getRowsPerRep() const {
+    return instrM * mmaLayout.getWarpsPerCTA()[0] / warpsPerWarpGroup;
+  }
+
+  static std::string getOperandType(Type elemTy) {
+    if (elemTy.isF16())
+      return "f16";
+    if (elemTy.isBF16())
+      return "bf16";
+    if (elemTy.isF32())
+      return "tf32";
+    if (elemTy.isa<triton::Float8E4M3Type>())
+      return "e4m3";
+    if (elemTy.isa<triton::Float8E5M2Type>())
+      return "e5m2";
+    llvm::report_fatal_error("Unsupported operand type of wgmma");
+  }
+
+  // Get the layout type of a descriptor, from the bytes of the rows of the
+  // tile: the swizzling of the shared layout spans exactly one row.
+  static uint64_t getSwizzleMode(int rowBytes) {
+    switch (rowBytes) {
+    case 128:
+      return 1;
+    case 64:
+      return 2;
+    case 32:
+      return 3;
+    default:
+      llvm::report_fatal_error("Unsupported row size of wgmma operands");
+    }
+  }
+
+  // Get the matrix descriptor of the tile starting at shared memory address
+  // `addr`, whose rows are `rowBytes` long:
+  //   bits 0-13:  start address >> 4
+  //   bits 16-29: leading dimension byte offset >> 4, unused as the tile spans
+  //               a single swizzling atom along its rows
+  //   bits 32-45: stride dimension byte offset >> 4, between groups of 8 rows
+  //   bits 62-63: swizzling mode
+  static Value getDescriptor(Value addr, int rowBytes,
+                             ConversionPatternRewriter &rewriter,
+                             Location loc) {
+    uint64_t strideBytes = 8 * rowBytes;
+    uint64_t desc = (uint64_t(1) << 16) | ((strideBytes >> 4) << 32) |
+                    (getSwizzleMode(rowBytes) << 62);
+    Value start = zext(i64_ty, and_(udiv(addr, i32_val(16)), i32_val(0x3FFF)));
+    return add(int_val(64, desc), start);
+  }
+};
+
 // Helper for conversion of FMA DotOp.
 struct DotOpFMAConversionHelper {
   Attribute layout;
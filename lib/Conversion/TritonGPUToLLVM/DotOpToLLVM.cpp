@@ -7,11 +7,13 @@ using namespace mlir::triton;
 
 using ::mlir::LLVM::DotOpFMAConversionHelper;
 using ::mlir::LLVM::DotOpMmaV1ConversionHelper;
+using ::mlir::LLVM::DotOpMmaV3ConversionHelper;
 using ::mlir::LLVM::getElementsFromStruct;
 using ::mlir::LLVM::getStructFromElements;
 using ::mlir::LLVM::MMA16816ConversionHelper;
 using ::mlir::triton::gpu::DotOperandEncodingAttr;
 using ::mlir::triton::gpu::MmaEncodingAttr;
+using ::mlir::triton::gpu::SharedEncodingAttr;
 
 struct DotOpConversion : public ConvertTritonGPUOpToLLVMPattern<triton::DotOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -39,6 +41,8 @@ struct DotOpConversion : public ConvertTritonGPUOpToLLVMPattern<triton::DotOp> {
         return convertMMA884(op, adaptor, rewriter);
       if (mmaLayout.isAmpere())
         return convertMMA16816(op, adaptor, rewriter);
+      if (mmaLayout.isHopper())
+        return convertWGMMA(op, adaptor, rewriter);
 
       llvm::report_fatal_error(
           "Unsupported MMA kind found when converting DotOp to LLVM.");
@@ -217,6 +221,126 @@ private:
     return success();
   }
 
+  /// Convert to wgmma.mma_async. Every instruction of the dot is issued before
+  /// a single wait, so that the tensor cores run asynchronously with the
+  /// warpgroups, and with the copies issued before the dot, until the end of
+  /// the dot.
+  LogicalResult convertWGMMA(triton::DotOp op, OpAdaptor adaptor,
+                             ConversionPatternRewriter &rewriter) const {
+    auto *ctx = op.getContext();
+    auto loc = op.getLoc();
+
+    auto ATensorTy = op.a().getType().cast<RankedTensorType>();
+    auto BTensorTy = op.b().getType().cast<RankedTensorType>();
+    auto DTensorTy = op.getResult().getType().cast<RankedTensorType>();
+    auto mmaLayout = DTensorTy.getEncoding().cast<MmaEncodingAttr>();
+    DotOpMmaV3ConversionHelper helper(mmaLayout);
+
+    // The operands are converted from shared memory, whose tiles hold
+    // exactly one swizzling atom per row
+    auto getOrder = [](Value operand) {
+      auto cvt = operand.getDefiningOp<triton::gpu::ConvertLayoutOp>();
+      assert(cvt && "wgmma operands should be converted from shared memory");
+      return cvt.src()
+          .getType()
+          .cast<RankedTensorType>()
+          .getEncoding()
+          .cast<SharedEncodingAttr>()
+          .getOrder();
+    };
+    bool isBTransposed = getOrder(op.b())[0] == 1;
+
+    auto AShape = ATensorTy.getShape();
+    auto BShape = BTensorTy.getShape();
+    int M = AShape[0];
+    int K = AShape[1];
+    int N = BShape[1];
+    int elemBytes =
+        triton::getIntOrFloatBitWidth(ATensorTy.getElementType()) / 8;
+    int instrK = DotOpMmaV3ConversionHelper::instrKBytes / elemBytes;
+    int instrN = DotOpMmaV3ConversionHelper::getInstrN(N);
+    int rowsPerRep = helper.getRowsPerRep();
+    int numRepM = M / rowsPerRep;
+    int numRepN = N / instrN;
+    int numRepK = K / instrK;
+    int aRowBytes = K * elemBytes;
+    int bRowBytes = (isBTransposed ? N : K) * elemBytes;
+
+    // Each warpgroup computes 64 consecutive rows of each repetition along M
+    auto aSmem = getSharedMemoryObjectFromStruct(loc, adaptor.a(), rewriter);
+    auto bSmem = getSharedMemoryObjectFromStruct(loc, adaptor.b(), rewriter);
+    Value warpGroup = udiv(getThreadId(rewriter, loc), i32_val(128));
+    Value aBase = add(ptrtoint(i32_ty, aSmem.base),
+                      mul(warpGroup, i32_val(64 * aRowBytes)));
+    Value bBase = ptrtoint(i32_ty, bSmem.base);
+    int instrKBytes = DotOpMmaV3ConversionHelper::instrKBytes;
+    auto getADescriptor = [&](int m, int k) {
+      int offset = m * rowsPerRep * aRowBytes + k * instrKBytes;
+      return helper.getDescriptor(add(aBase, i32_val(offset)), aRowBytes,
+                                  rewriter, loc);
+    };
+    auto getBDescriptor = [&](int n, int k) {
+      int offset = isBTransposed
+                       ? k * instrK * bRowBytes
+                       : n * instrN * bRowBytes + k * instrKBytes;
+      return helper.getDescriptor(add(bBase, i32_val(offset)), bRowBytes,
+                                  rewriter, loc);
+    };
+
+    // The accumulators of a warp are ordered as for mma.16816: each
+    // instruction updates the instrN / 2 consecutive accumulators of its
+    // columns
+    SmallVector<Value> acc = getElementsFromStruct(loc, adaptor.c(), rewriter);
+    PTXBuilder builder;
+    SmallVector<PTXBuilder::Operand *> dOprs;
+    for (size_t i = 0; i < acc.size(); ++i)
+      dOprs.push_back(builder.newOperand("=f"));
+    for (size_t i = 0; i < acc.size(); ++i)
+      builder.newOperand(acc[i], std::to_string(i));
+    auto *scaleD = builder.newOperand(int_val(1, 1), "b");
+
+    // Writes to shared memory of the generic proxy must be made visible to
+    // the async proxy through which wgmma reads its operands
+    auto &proxyFence = *builder.create<>("fence.proxy.async.shared::cta");
+    proxyFence();
+    auto &fence = *builder.create<>("wgmma.fence.sync.aligned");
+    fence();
+    std::string opType =
+        DotOpMmaV3ConversionHelper::getOperandType(ATensorTy.getElementType());
+    auto &wgmma = *builder.create<>(
+        llvm::formatv("wgmma.mma_async.sync.aligned.m64n{0}k{1}.f32.{2}.{2}",
+                      instrN, instrK, opType)
+            .str());
+    for (int k = 0; k < numRepK; ++k)
+      for (int m = 0; m < numRepM; ++m)
+        for (int n = 0; n < numRepN; ++n) {
+          auto *dList = builder.newListOperand();
+          for (int i = 0; i < instrN / 2; ++i)
+            dList->listAppend(dOprs[m * N / 2 + n * instrN / 2 + i]);
+          SmallVector<PTXBuilder::Operand *> oprs = {
+              dList, builder.newOperand(getADescriptor(m, k), "l"),
+              builder.newOperand(getBDescriptor(n, k), "l"), scaleD,
+              builder.newConstantOperand(1), builder.newConstantOperand(1)};
+          // Only 16-bit operands can be transposed
+          if (elemBytes == 2) {
+            oprs.push_back(builder.newConstantOperand(0));
+            oprs.push_back(builder.newConstantOperand(isBTransposed));
+          }
+          wgmma(oprs);
+        }
+    auto &commit = *builder.create<>("wgmma.commit_group.sync.aligned");
+    commit();
+    auto &wait = *builder.create<>("wgmma.wait_group.sync.aligned");
+    wait(builder.newConstantOperand(0));
+
+    Type structTy = struct_ty(SmallVector<Type>(acc.size(), f32_ty));
+    Value res = builder.launch(rewriter, loc, structTy);
+    for (size_t i = 0; i < acc.size(); ++i)
+      acc[i] = extract_val(f32_ty, res, i32_arr_attr(i));
+    rewriter.replaceOp(op, getStructFromElements(loc, acc, rewriter, structTy));
+    return success();
+  }
+
   LogicalResult convertFMADot(triton::DotOp op, OpAdaptor adaptor,
                               ConversionPatternRewriter &rewriter) const {
     auto *ctx = rewriter.getContext();
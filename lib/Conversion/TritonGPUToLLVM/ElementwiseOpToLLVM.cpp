@@ -9,8 +9,11 @@ using ::mlir::triton::gpu::getElemsPerThread;
 
 struct FpToFpOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::FpToFpOp> {
-  using ConvertTritonGPUOpToLLVMPattern<
-      triton::FpToFpOp>::ConvertTritonGPUOpToLLVMPattern;
+  explicit FpToFpOpConversion(LLVMTypeConverter &typeConverter,
+                              int computeCapability, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::FpToFpOp>(typeConverter,
+                                                          benefit),
+        computeCapability(computeCapability) {}
 
   static SmallVector<Value>
   convertFp8x4ToFp16x4(Location loc, ConversionPatternRewriter &rewriter,
@@ -284,6 +287,218 @@ struct FpToFpOpConversion
     return builder.launch(rewriter, loc, i16_ty, false);
   }
 
+  static bool isOcpFp8(Type type) {
+    return type.isa<triton::Float8E4M3Type, triton::Float8E5M2Type>();
+  }
+
+  static Value packFp8x4(Location loc, ConversionPatternRewriter &rewriter,
+                         ArrayRef<Value> values) {
+    auto fp8x4VecTy = vec_ty(i8_ty, 4);
+    Value fp8x4Vec = undef(fp8x4VecTy);
+    for (int i = 0; i < 4; ++i)
+      fp8x4Vec = insert_element(fp8x4VecTy, fp8x4Vec, values[i], i32_val(i));
+    return bitcast(fp8x4Vec, i32_ty);
+  }
+
+  static SmallVector<Value> unpackFp8x4(Location loc,
+                                        ConversionPatternRewriter &rewriter,
+                                        Value fp8x4Vec) {
+    SmallVector<Value> values;
+    for (int i = 0; i < 4; ++i)
+      values.push_back(extract_element(i8_ty, fp8x4Vec, i32_val(i)));
+    return values;
+  }
+
+  static SmallVector<Value> packFp16x2x2(Location loc,
+                                         ConversionPatternRewriter &rewriter,
+                                         ArrayRef<Value> values) {
+    auto fp16x2VecTy = vec_ty(f16_ty, 2);
+    SmallVector<Value> fp16x2Vecs;
+    for (int i = 0; i < 4; i += 2) {
+      Value fp16x2Vec = undef(fp16x2VecTy);
+      fp16x2Vec =
+          insert_element(fp16x2VecTy, fp16x2Vec, values[i], i32_val(0));
+      fp16x2Vec =
+          insert_element(fp16x2VecTy, fp16x2Vec, values[i + 1], i32_val(1));
+      fp16x2Vecs.push_back(bitcast(fp16x2Vec, i32_ty));
+    }
+    return fp16x2Vecs;
+  }
+
+  static SmallVector<Value> unpackFp16x2x2(Location loc,
+                                           ConversionPatternRewriter &rewriter,
+                                           PTXBuilder &builder) {
+    auto ctx = rewriter.getContext();
+    auto fp16x2VecTy = vec_ty(f16_ty, 2);
+    auto fp16x2x2StructTy =
+        struct_ty(SmallVector<Type>{fp16x2VecTy, fp16x2VecTy});
+    auto fp16x2x2Struct =
+        builder.launch(rewriter, loc, fp16x2x2StructTy, false);
+    SmallVector<Value> values;
+    for (int i = 0; i < 2; ++i) {
+      auto fp16x2Vec =
+          extract_val(fp16x2VecTy, fp16x2x2Struct, i32_arr_attr(i));
+      values.push_back(extract_element(f16_ty, fp16x2Vec, i32_val(0)));
+      values.push_back(extract_element(f16_ty, fp16x2Vec, i32_val(1)));
+    }
+    return values;
+  }
+
+  // Converts E4M3 or E5M2 (`format`) to f16, two values per instruction
+  static SmallVector<Value>
+  convertOcpFp8x4ToFp16x4Native(StringRef format, Location loc,
+                                ConversionPatternRewriter &rewriter,
+                                ArrayRef<Value> values) {
+    std::string cvt = ("cvt.rn.f16x2." + format + "x2").str();
+    std::string ptxAsm = "{                     \n"
+                         ".reg .b16 a<2>;       \n"
+                         "mov.b32 {a0, a1}, $2; \n" +
+                         cvt + " $0, a0;        \n" + cvt +
+                         " $1, a1;        \n"
+                         "}";
+    PTXBuilder builder;
+    auto &call = *builder.create(ptxAsm);
+    auto *o0 = builder.newOperand("=r");
+    auto *o1 = builder.newOperand("=r");
+    auto *i = builder.newOperand(packFp8x4(loc, rewriter, values), "r");
+    call({o0, o1, i}, /*onlyAttachMLIRArgs=*/true);
+    return unpackFp16x2x2(loc, rewriter, builder);
+  }
+
+  // Converts f16 to E4M3 or E5M2 (`format`), two values per instruction,
+  // saturating to the largest finite value
+  static SmallVector<Value>
+  convertFp16x4ToOcpFp8x4Native(StringRef format, Location loc,
+                                ConversionPatternRewriter &rewriter,
+                                ArrayRef<Value> values) {
+    std::string cvt = ("cvt.rn.satfinite." + format + "x2.f16x2").str();
+    std::string ptxAsm = "{                     \n"
+                         ".reg .b16 a<2>;       \n" +
+                         cvt + " a0, $1;        \n" + cvt +
+                         " a1, $2;        \n"
+                         "mov.b32 $0, {a0, a1}; \n"
+                         "}";
+    PTXBuilder builder;
+    auto &call = *builder.create(ptxAsm);
+    SmallVector<PTXBuilder::Operand *> operands = {builder.newOperand("=r")};
+    for (Value fp16x2Vec : packFp16x2x2(loc, rewriter, values))
+      operands.push_back(builder.newOperand(fp16x2Vec, "r"));
+    call(operands, /*onlyAttachMLIRArgs=*/true);
+    auto fp8x4Vec = builder.launch(rewriter, loc, vec_ty(i8_ty, 4), false);
+    return unpackFp8x4(loc, rewriter, fp8x4Vec);
+  }
+
+  // E5M2 values are the upper byte of the f16 values
+  static SmallVector<Value>
+  convertFp8E5M2x4ToFp16x4(Location loc, ConversionPatternRewriter &rewriter,
+                           ArrayRef<Value> values) {
+    PTXBuilder builder;
+    auto &call = *builder.create("{                           \n"
+                                 "prmt.b32 $0, 0, $2, 0x5040; \n"
+                                 "prmt.b32 $1, 0, $2, 0x7060; \n"
+                                 "}");
+    auto *o0 = builder.newOperand("=r");
+    auto *o1 = builder.newOperand("=r");
+    auto *i = builder.newOperand(packFp8x4(loc, rewriter, values), "r");
+    call({o0, o1, i}, /*onlyAttachMLIRArgs=*/true);
+    return unpackFp16x2x2(loc, rewriter, builder);
+  }
+
+  // Rounds f16 values to their upper byte, to nearest with ties away from
+  // zero
+  static SmallVector<Value>
+  convertFp16x4ToFp8E5M2x4(Location loc, ConversionPatternRewriter &rewriter,
+                           ArrayRef<Value> values) {
+    PTXBuilder builder;
+    auto &call = *builder.create("{                                      \n"
+                                 ".reg .b32 a<2>, b<2>;                  \n"
+                                 "lop3.b32 a0, $1, 0x7fff7fff, 0, 0xc0;  \n"
+                                 "lop3.b32 a1, $2, 0x7fff7fff, 0, 0xc0;  \n"
+                                 "add.u32 a0, a0, 0x00800080;            \n"
+                                 "add.u32 a1, a1, 0x00800080;            \n"
+                                 "lop3.b32 b0, $1, 0x80008000, a0, 0xea; \n"
+                                 "lop3.b32 b1, $2, 0x80008000, a1, 0xea; \n"
+                                 "prmt.b32 $0, b0, b1, 0x7531;           \n"
+                                 "}");
+    SmallVector<PTXBuilder::Operand *> operands = {builder.newOperand("=r")};
+    for (Value fp16x2Vec : packFp16x2x2(loc, rewriter, values))
+      operands.push_back(builder.newOperand(fp16x2Vec, "r"));
+    call(operands, /*onlyAttachMLIRArgs=*/true);
+    auto fp8x4Vec = builder.launch(rewriter, loc, vec_ty(i8_ty, 4), false);
+    return unpackFp8x4(loc, rewriter, fp8x4Vec);
+  }
+
+  // The custom fp8 format is E4M3 with the exponent bias of f16: E4M3 values
+  // are the custom fp8 values scaled by 2^8
+  static SmallVector<Value>
+  convertFp8E4M3x4ToFp16x4(Location loc, ConversionPatternRewriter &rewriter,
+                           ArrayRef<Value> values) {
+    auto fp16Values = convertFp8x4ToFp16x4(loc, rewriter, values[0], values[1],
+                                           values[2], values[3]);
+    Value scale = rewriter.create<LLVM::ConstantOp>(
+        loc, f16_ty, rewriter.getF16FloatAttr(256.0));
+    for (Value &value : fp16Values)
+      value = fmul(value, scale);
+    return fp16Values;
+  }
+
+  // Does not saturate: values beyond the E4M3 range are not representable
+  static SmallVector<Value>
+  convertFp16x4ToFp8E4M3x4(Location loc, ConversionPatternRewriter &rewriter,
+                           ArrayRef<Value> values) {
+    Value scale = rewriter.create<LLVM::ConstantOp>(
+        loc, f16_ty, rewriter.getF16FloatAttr(1.0 / 256.0));
+    SmallVector<Value> scaled;
+    for (Value value : values)
+      scaled.push_back(fmul(value, scale));
+    return convertFp16x4ToFp8x4(loc, rewriter, scaled[0], scaled[1], scaled[2],
+                                scaled[3]);
+  }
+
+  // Converts four values from or to the E4M3 or E5M2 formats through f16,
+  // which represents both of them exactly. sm_89 and later convert between
+  // f16 and fp8 with dedicated instructions.
+  SmallVector<Value> convertOcpFp8x4(Type srcEltType, Type dstEltType,
+                                     Location loc,
+                                     ConversionPatternRewriter &rewriter,
+                                     ArrayRef<Value> values) const {
+    bool isNative = computeCapability >= 89;
+    if (isOcpFp8(srcEltType)) {
+      bool isE4M3 = srcEltType.isa<triton::Float8E4M3Type>();
+      SmallVector<Value> results;
+      if (isNative)
+        results = convertOcpFp8x4ToFp16x4Native(isE4M3 ? "e4m3" : "e5m2", loc,
+                                                rewriter, values);
+      else if (isE4M3)
+        results = convertFp8E4M3x4ToFp16x4(loc, rewriter, values);
+      else
+        results = convertFp8E5M2x4ToFp16x4(loc, rewriter, values);
+      for (Value &result : results) {
+        if (dstEltType.isF32() || dstEltType.isF64())
+          result = rewriter.create<LLVM::FPExtOp>(loc, dstEltType, result);
+        else if (dstEltType.isBF16())
+          result = convertFp32ToBf16(
+              loc, rewriter,
+              rewriter.create<LLVM::FPExtOp>(loc, f32_ty, result));
+      }
+      return results;
+    }
+    SmallVector<Value> fp16Values;
+    for (Value value : values) {
+      if (srcEltType.isBF16())
+        value = convertBf16ToFp32(loc, rewriter, value);
+      if (!srcEltType.isF16())
+        value = rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, value);
+      fp16Values.push_back(value);
+    }
+    bool isE4M3 = dstEltType.isa<triton::Float8E4M3Type>();
+    if (isNative)
+      return convertFp16x4ToOcpFp8x4Native(isE4M3 ? "e4m3" : "e5m2", loc,
+                                           rewriter, fp16Values);
+    return isE4M3 ? convertFp16x4ToFp8E4M3x4(loc, rewriter, fp16Values)
+                  : convertFp16x4ToFp8E5M2x4(loc, rewriter, fp16Values);
+  }
+
   LogicalResult
   matchAndRewrite(triton::FpToFpOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -296,13 +511,19 @@ struct FpToFpOpConversion
     SmallVector<Value> resultVals;
 
     // Select convertor
-    if (srcEltType.isa<triton::Float8Type>() ||
-        dstEltType.isa<triton::Float8Type>()) {
+    if (triton::isFloat8(srcEltType) || triton::isFloat8(dstEltType)) {
       std::function<SmallVector<Value>(Location, ConversionPatternRewriter &,
                                        const Value &, const Value &,
                                        const Value &, const Value &)>
           convertor;
-      if (srcEltType.isa<triton::Float8Type>() && dstEltType.isF16()) {
+      if (isOcpFp8(srcEltType) || isOcpFp8(dstEltType)) {
+        convertor = [&](Location loc, ConversionPatternRewriter &rewriter,
+                        const Value &v0, const Value &v1, const Value &v2,
+                        const Value &v3) {
+          return convertOcpFp8x4(srcEltType, dstEltType, loc, rewriter,
+                                 {v0, v1, v2, v3});
+        };
+      } else if (srcEltType.isa<triton::Float8Type>() && dstEltType.isF16()) {
         convertor = convertFp8x4ToFp16x4;
       } else if (srcEltType.isF16() && dstEltType.isa<triton::Float8Type>()) {
         convertor = convertFp16x4ToFp8x4;
@@ -347,6 +568,9 @@ struct FpToFpOpConversion
     rewriter.replaceOp(op, result);
     return success();
   }
+
+private:
+  int computeCapability;
 };
 
 template <typename SourceOp, typename ConcreteT>
@@ -374,7 +598,36 @@ public:
     auto *concreteThis = static_cast<const ConcreteT *>(this);
     auto operands = getOperands(rewriter, adaptor, elems, loc);
     SmallVector<Value> resultVals(elems);
+    // The elements with the same operands as an earlier one, e.g. along the
+    // broadcast dimensions of the operands, reuse its result
+    SmallVector<int> repeatOf(elems, -1);
+    DenseMap<ArrayRef<Value>, unsigned> firstWithOperands;
     for (unsigned i = 0; i < elems; ++i) {
+      auto it = firstWithOperands.try_emplace(operands[i], i);
+      if (!it.second)
+        repeatOf[i] = it.first->second;
+    }
+    // Consecutive elements of a thread are processed in pairs by ops that
+    // have a packed 2-way instruction for their type
+    if (concreteThis->isPackable(op)) {
+      for (unsigned i = 0; i + 1 < elems; i += 2) {
+        if (repeatOf[i] >= 0 || repeatOf[i + 1] >= 0)
+          continue;
+        auto [res0, res1] = concreteThis->createPackedDestOp(
+            op, adaptor, rewriter, elemTy, operands[i], operands[i + 1], loc);
+        if (!bool(res0) || !bool(res1))
+          return failure();
+        resultVals[i] = res0;
+        resultVals[i + 1] = res1;
+      }
+    }
+    for (unsigned i = 0; i < elems; ++i) {
+      if (resultVals[i])
+        continue;
+      if (repeatOf[i] >= 0) {
+        resultVals[i] = resultVals[repeatOf[i]];
+        continue;
+      }
       resultVals[i] = concreteThis->createDestOp(op, adaptor, rewriter, elemTy,
                                                  operands[i], loc);
       if (!bool(resultVals[i]))
@@ -386,6 +639,21 @@ public:
     return success();
   }
 
+  // Overridden by the ops with a packed lowering
+  bool isPackable(SourceOp op) const { return false; }
+
+  std::pair<Value, Value>
+  createPackedDestOp(SourceOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands0, ValueRange operands1,
+                     Location loc) const {
+    auto *concreteThis = static_cast<const ConcreteT *>(this);
+    return {concreteThis->createDestOp(op, adaptor, rewriter, elemTy,
+                                       operands0, loc),
+            concreteThis->createDestOp(op, adaptor, rewriter, elemTy,
+                                       operands1, loc)};
+  }
+
 protected:
   SmallVector<SmallVector<Value>>
   getOperands(ConversionPatternRewriter &rewriter, OpAdaptor adaptor,
@@ -592,6 +860,45 @@ struct FDivOpConversion
   }
 };
 
+// Applies the binary `DestOp` to the element pairs `operands0` and
+// `operands1` of f16 or bf16 values with one packed instruction. fp16 uses
+// an LLVM op on `vector<2xf16>`, selected to `{add,sub,mul}.f16x2`; bf16,
+// represented as i16, uses `bf16x2Asm` on the two values bitcast to a b32.
+template <typename DestOp>
+static std::pair<Value, Value>
+createPackedBinaryOp(ConversionPatternRewriter &rewriter, Location loc,
+                     Type elemTy, bool isBF16, ValueRange operands0,
+                     ValueRange operands1, const char *bf16x2Asm) {
+  auto vecTy = vec_ty(elemTy, 2);
+  auto pack = [&](Value v0, Value v1) -> Value {
+    Value vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, v0, i32_val(0));
+    return insert_element(vecTy, vec, v1, i32_val(1));
+  };
+  Value lhs = pack(operands0[0], operands1[0]);
+  Value rhs = pack(operands0[1], operands1[1]);
+  Value res;
+  if (isBF16) {
+    PTXBuilder builder;
+    auto &instr = *builder.create<PTXInstr>(bf16x2Asm);
+    auto resOpr = builder.newOperand("=r");
+    auto lhsOpr = builder.newOperand(bitcast(lhs, i32_ty), "r");
+    auto rhsOpr = builder.newOperand(bitcast(rhs, i32_ty), "r");
+    instr({resOpr, lhsOpr, rhsOpr}, /*onlyAttachMLIRArgs=*/true);
+    res = bitcast(builder.launch(rewriter, loc, i32_ty, false), vecTy);
+  } else {
+    res = rewriter.create<DestOp>(loc, vecTy, lhs, rhs);
+  }
+  return {extract_element(elemTy, res, i32_val(0)),
+          extract_element(elemTy, res, i32_val(1))};
+}
+
+static bool isPackable16BitFloat(Value lhs, Value rhs) {
+  auto lhsElemTy = getElementType(lhs);
+  auto rhsElemTy = getElementType(rhs);
+  return lhsElemTy == rhsElemTy && (lhsElemTy.isF16() || lhsElemTy.isBF16());
+}
+
 struct FMulOpConversion
     : ElementwiseOpConversionBase<mlir::arith::MulFOp, FMulOpConversion> {
   using Base =
@@ -620,6 +927,23 @@ struct FMulOpConversion
                                            operands[1]);
     }
   }
+
+  bool isPackable(mlir::arith::MulFOp op) const {
+    return isPackable16BitFloat(op.getLhs(), op.getRhs());
+  }
+
+  std::pair<Value, Value>
+  createPackedDestOp(mlir::arith::MulFOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands0, ValueRange operands1,
+                     Location loc) const {
+    auto ptxAsm = " { .reg .b32 c;            \n"
+                  "    mov.b32 c, 0x80008000U; \n" // -0.0, -0.0
+                  "    fma.rn.bf16x2 $0, $1, $2, c; } \n";
+    return createPackedBinaryOp<LLVM::FMulOp>(
+        rewriter, loc, elemTy, getElementType(op.getLhs()).isBF16(),
+        operands0, operands1, ptxAsm);
+  }
 };
 
 struct FAddOpConversion
@@ -650,6 +974,23 @@ struct FAddOpConversion
                                            operands[1]);
     }
   }
+
+  bool isPackable(mlir::arith::AddFOp op) const {
+    return isPackable16BitFloat(op.getLhs(), op.getRhs());
+  }
+
+  std::pair<Value, Value>
+  createPackedDestOp(mlir::arith::AddFOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands0, ValueRange operands1,
+                     Location loc) const {
+    auto ptxAsm = "{ .reg .b32 c;             \n"
+                  "   mov.b32 c, 0x3f803f80U; \n" // 1.0, 1.0
+                  "   fma.rn.bf16x2 $0, $1, c, $2; } \n";
+    return createPackedBinaryOp<LLVM::FAddOp>(
+        rewriter, loc, elemTy, getElementType(op.getLhs()).isBF16(),
+        operands0, operands1, ptxAsm);
+  }
 };
 
 struct FSubOpConversion
@@ -680,6 +1021,23 @@ struct FSubOpConversion
                                            operands[1]);
     }
   }
+
+  bool isPackable(mlir::arith::SubFOp op) const {
+    return isPackable16BitFloat(op.getLhs(), op.getRhs());
+  }
+
+  std::pair<Value, Value>
+  createPackedDestOp(mlir::arith::SubFOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands0, ValueRange operands1,
+                     Location loc) const {
+    auto ptxAsm = " { .reg .b32 c;            \n"
+                  "    mov.b32 c, 0xbf80bf80U; \n" // -1.0, -1.0
+                  "    fma.rn.bf16x2 $0, $2, c, $1;} \n";
+    return createPackedBinaryOp<LLVM::FSubOp>(
+        rewriter, loc, elemTy, getElementType(op.getLhs()).isBF16(),
+        operands0, operands1, ptxAsm);
+  }
 };
 
 struct SIToFPOpConversion
@@ -791,12 +1149,225 @@ struct ExpOpConversionApprox
   }
 };
 
+// Lowerings of the fast-math mode to the approximate instructions of PTX, on
+// fp32 and on fp16 (evaluated in fp32). Maximum errors given by the PTX ISA:
+//
+//   exp2        ex2.approx.f32, 2 ulp
+//   exp         ex2.approx.f32 of x * log2(e), 2 ulp plus the rounding of the
+//               product, which grows with |x|
+//   log2        lg2.approx.f32, absolute error 2^-22.6
+//   log         lg2.approx.f32 times ln(2), absolute error 2^-22
+//   sin, cos    {sin,cos}.approx.f32, absolute error 2^-20.9 in [-pi, pi],
+//               growing with |x| outside of it
+//   rsqrt       rsqrt.approx.f32, relative error 2^-22.9
+//   tanh        tanh.approx.f32 (sm_75+), relative error 2^-11
+//
+// Divisions already use div.full.f32 (2 ulp); the fast-math mode also lets
+// LLVM lower square roots and the divisions it emits with sqrt.approx.f32 and
+// div.approx.f32 (see translateLLVMIRToPTX).
+static Value createApproxFunc(ConversionPatternRewriter &rewriter,
+                              Location loc, StringRef func, Type elemTy,
+                              Value x) {
+  if (!elemTy.isF32() && !elemTy.isF16())
+    return {};
+  if (elemTy.isF16())
+    x = rewriter.create<LLVM::FPExtOp>(loc, f32_ty, x);
+  const double log2e = 1.4426950408889634;
+  const double ln2 = 0.6931471805599453;
+  std::string instr = func.str();
+  if (func == "exp" || func == "exp2")
+    instr = "ex2";
+  else if (func == "log" || func == "log2")
+    instr = "lg2";
+  if (func == "exp")
+    x = fmul(f32_ty, x, f32_val(log2e));
+
+  PTXBuilder ptxBuilder;
+  auto &approx = ptxBuilder.create<PTXInstr>(instr)->o("approx").o("f32");
+  auto output = ptxBuilder.newOperand("=f");
+  auto input = ptxBuilder.newOperand(x, "f");
+  approx(output, input);
+  Value ret = ptxBuilder.launch(rewriter, loc, f32_ty, false);
+  if (func == "log")
+    ret = fmul(f32_ty, ret, f32_val(ln2));
+  if (elemTy.isF16())
+    ret = rewriter.create<LLVM::FPTruncOp>(loc, f16_ty, ret);
+  return ret;
+}
+
+template <typename SourceOp>
+struct ApproxOpConversion
+    : ElementwiseOpConversionBase<SourceOp, ApproxOpConversion<SourceOp>> {
+  using Base =
+      ElementwiseOpConversionBase<SourceOp, ApproxOpConversion<SourceOp>>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  ApproxOpConversion(LLVMTypeConverter &typeConverter, StringRef func,
+                     PatternBenefit benefit)
+      : Base(typeConverter, benefit), func(func.str()) {}
+
+  Value createDestOp(SourceOp op, Adaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands, Location loc) const {
+    return createApproxFunc(rewriter, loc, func, elemTy, operands[0]);
+  }
+
+private:
+  std::string func;
+};
+
+// Calls of the fp32 libdevice functions that have an approximation
+struct ExtElemwiseOpConversionApprox
+    : ElementwiseOpConversionBase<triton::ExtElemwiseOp,
+                                  ExtElemwiseOpConversionApprox> {
+  using Base = ElementwiseOpConversionBase<triton::ExtElemwiseOp,
+                                           ExtElemwiseOpConversionApprox>;
+  using Adaptor = typename Base::OpAdaptor;
+
+  ExtElemwiseOpConversionApprox(LLVMTypeConverter &typeConverter,
+                                int computeCapability, PatternBenefit benefit)
+      : Base(typeConverter, benefit), computeCapability(computeCapability) {}
+
+  Value createDestOp(triton::ExtElemwiseOp op, OpAdaptor adaptor,
+                     ConversionPatternRewriter &rewriter, Type elemTy,
+                     ValueRange operands, Location loc) const {
+    StringRef func = getApproxFunc(op.symbol());
+    if (func.empty() || operands.size() != 1 || !elemTy.isF32())
+      return {};
+    return createApproxFunc(rewriter, loc, func, elemTy, operands[0]);
+  }
+
+private:
+  StringRef getApproxFunc(StringRef symbol) const {
+    if (!symbol.consume_front("__nv_"))
+      return {};
+    symbol.consume_front("fast_");
+    if (!symbol.consume_back("f"))
+      return {};
+    if (symbol == "tanh")
+      return computeCapability >= 75 ? symbol : StringRef();
+    for (StringRef func : {"exp", "exp2", "log", "log2", "sin", "cos", "rsqrt"})
+      if (symbol == func)
+        return symbol;
+    return {};
+  }
+
+  int computeCapability;
+};
+
+// Philox4x32 gives 4 outputs per counter, one for each of the 4 consecutive
+// offsets of a group. When the offsets are known to be contiguous in groups
+// of 4 held in consecutive registers (with the same seeds), each evaluation
+// provides all the elements of a group. Otherwise, every element does its own
+// evaluation and keeps the output selected by its offset.
+struct PhiloxOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::PhiloxOp> {
+  PhiloxOpConversion(LLVMTypeConverter &typeConverter,
+                     AxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+      : ConvertTritonGPUOpToLLVMPattern<triton::PhiloxOp>(typeConverter,
+                                                          benefit),
+        axisAnalysisPass(axisAnalysisPass) {}
+
+  LogicalResult
+  matchAndRewrite(triton::PhiloxOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Location loc = op->getLoc();
+    auto offsets = getElementsFromStruct(loc, adaptor.offset(), rewriter);
+    auto seedLo = getElementsFromStruct(loc, adaptor.seedLo(), rewriter);
+    auto seedHi = getElementsFromStruct(loc, adaptor.seedHi(), rewriter);
+    unsigned nRounds = op.nRounds();
+    unsigned vec = isGroupedPerThread(op) ? 4 : 1;
+
+    SmallVector<Value> resultVals(offsets.size());
+    for (unsigned i = 0; i < offsets.size(); i += vec) {
+      Value counter =
+          rewriter.create<LLVM::LShrOp>(loc, offsets[i], i32_val(2));
+      auto outputs =
+          philox(loc, rewriter, counter, seedLo[i], seedHi[i], nRounds);
+      if (vec == 4) {
+        for (unsigned j = 0; j < 4; ++j)
+          resultVals[i + j] = outputs[j];
+        continue;
+      }
+      Value idx = and_(offsets[i], i32_val(3));
+      Value ret = outputs[3];
+      for (int j = 2; j >= 0; --j)
+        ret = select(icmp_eq(idx, i32_val(j)), outputs[j], ret);
+      resultVals[i] = ret;
+    }
+
+    Type structTy = getTypeConverter()->convertType(op.getType());
+    Value view = getStructFromElements(loc, resultVals, rewriter, structTy);
+    rewriter.replaceOp(op, view);
+    return success();
+  }
+
+private:
+  bool isGroupedPerThread(triton::PhiloxOp op) const {
+    auto tensorTy = op.getType().cast<RankedTensorType>();
+    auto layout =
+        tensorTy.getEncoding().dyn_cast<triton::gpu::BlockedEncodingAttr>();
+    if (!layout)
+      return false;
+    unsigned dim = layout.getOrder()[0];
+    if (layout.getSizePerThread()[dim] % 4 != 0)
+      return false;
+    if (axisAnalysisPass.getPtrAlignment(op.offset()) % 4 != 0)
+      return false;
+    for (Value seed : {op.seedLo(), op.seedHi()}) {
+      auto axisInfo = axisAnalysisPass.lookupLatticeElement(seed)->getValue();
+      if (axisInfo.getConstancy(dim) % 4 != 0)
+        return false;
+    }
+    auto offset = emitOffsetForLayout(layout, tensorTy.getShape());
+    for (unsigned i = 0; i < offset.size(); ++i) {
+      SmallVector<unsigned> expected = offset[i - i % 4];
+      if (expected[dim] % 4 != 0)
+        return false;
+      expected[dim] += i % 4;
+      if (offset[i] != expected)
+        return false;
+    }
+    return true;
+  }
+
+  SmallVector<Value, 4> philox(Location loc,
+                               ConversionPatternRewriter &rewriter, Value c0,
+                               Value k0, Value k1, unsigned nRounds) const {
+    const uint32_t keyA = 0x9E3779B9, keyB = 0xBB67AE85;
+    const uint32_t roundA = 0xD2511F53, roundB = 0xCD9E8D57;
+    auto u32_val = [&](uint32_t v) {
+      return i32_val(static_cast<int32_t>(v));
+    };
+    auto umulhi = [&](uint32_t a, Value b) -> Value {
+      Value prod = mul(zext(i64_ty, b), int_val(64, a));
+      Value hi = rewriter.create<LLVM::LShrOp>(loc, prod, int_val(64, 32));
+      return rewriter.create<LLVM::TruncOp>(loc, i32_ty, hi);
+    };
+    Value c1 = i32_val(0), c2 = i32_val(0), c3 = i32_val(0);
+    for (unsigned r = 0; r < nRounds; ++r) {
+      Value _c0 = c0, _c2 = c2;
+      c0 = xor_(xor_(umulhi(roundB, _c2), c1), k0);
+      c2 = xor_(xor_(umulhi(roundA, _c0), c3), k1);
+      c1 = mul(u32_val(roundB), _c2);
+      c3 = mul(u32_val(roundA), _c0);
+      k0 = add(k0, u32_val(keyA));
+      k1 = add(k1, u32_val(keyB));
+    }
+    return {c0, c1, c2, c3};
+  }
+
+  AxisInfoAnalysis &axisAnalysisPass;
+};
+
 void populateElementwiseOpToLLVMPatterns(mlir::LLVMTypeConverter &typeConverter,
                                          RewritePatternSet &patterns,
                                          int numWarps,
                                          AxisInfoAnalysis &axisInfoAnalysis,
                                          const Allocation *allocation,
-                                         Value smem, PatternBenefit benefit) {
+                                         Value smem, int computeCapability,
+                                         bool fastMath,
+                                         PatternBenefit benefit) {
 #define POPULATE_TERNARY_OP(SRC_OP, DST_OP)                                    \
   patterns.add<ElementwiseOpConversion<SRC_OP, DST_OP>>(typeConverter, benefit);
   POPULATE_TERNARY_OP(triton::gpu::SelectOp, LLVM::SelectOp)
@@ -850,12 +1421,27 @@ void populateElementwiseOpToLLVMPatterns(mlir::LLVMTypeConverter &typeConverter,
   patterns.add<FPToSIOpConversion>(typeConverter, benefit);
   patterns.add<SIToFPOpConversion>(typeConverter, benefit);
 
-  patterns.add<FpToFpOpConversion>(typeConverter, benefit);
+  patterns.add<FpToFpOpConversion>(typeConverter, computeCapability, benefit);
 
   patterns.add<ExtElemwiseOpConversion>(typeConverter, benefit);
+  patterns.add<PhiloxOpConversion>(typeConverter, axisInfoAnalysis, benefit);
   // ExpOpConversionApprox will try using ex2.approx if the input type is FP32.
   // For FP64 input type, ExpOpConversionApprox will return failure and
   // ElementwiseOpConversion<math::ExpOp, math::ExpOp> defined below will call
   // __nv_expf for higher-precision calculation
   patterns.add<ExpOpConversionApprox>(typeConverter, benefit);
+
+  if (fastMath) {
+    PatternBenefit approxBenefit = benefit.getBenefit() + 1;
+    patterns.add<ApproxOpConversion<math::ExpOp>>(typeConverter, "exp",
+                                                  approxBenefit);
+    patterns.add<ApproxOpConversion<math::LogOp>>(typeConverter, "log",
+                                                  approxBenefit);
+    patterns.add<ApproxOpConversion<math::SinOp>>(typeConverter, "sin",
+                                                  approxBenefit);
+    patterns.add<ApproxOpConversion<math::CosOp>>(typeConverter, "cos",
+                                                  approxBenefit);
+    patterns.add<ExtElemwiseOpConversionApprox>(
+        typeConverter, computeCapability, approxBenefit);
+  }
 }
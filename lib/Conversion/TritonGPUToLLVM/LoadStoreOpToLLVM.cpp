@@ -8,15 +8,21 @@ using namespace mlir;
 using namespace mlir::triton;
 
 using ::mlir::LLVM::getElementsFromStruct;
+using ::mlir::LLVM::getMBarrierPtr;
 using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
 using ::mlir::LLVM::getStructFromElements;
+using ::mlir::LLVM::shflIdxSync;
 using ::mlir::triton::gpu::getElemsPerThread;
 using ::mlir::triton::gpu::SharedEncodingAttr;
 
 // Contains some helper functions for both Load and Store conversions.
 struct LoadStoreConversionBase {
-  explicit LoadStoreConversionBase(AxisInfoAnalysis &axisAnalysisPass)
-      : axisAnalysisPass(axisAnalysisPass) {}
+  explicit LoadStoreConversionBase(AxisInfoAnalysis &axisAnalysisPass,
+                                   int computeCapability = 80,
+                                   bool nativeLoadStore = false)
+      : axisAnalysisPass(axisAnalysisPass),
+        computeCapability(computeCapability),
+        nativeLoadStore(nativeLoadStore) {}
 
   // Get corresponding LLVM element values of \param value.
   static SmallVector<Value> getLLVMElems(Value value, Value llValue,
@@ -35,12 +41,172 @@ struct LoadStoreConversionBase {
     return axisAnalysisPass.getPtrVectorSize(ptr);
   }
 
+  // Returns the axis along which the accesses to \param ptr under \param mask
+  // are the widest, and sets \param vec to their width. Threads holding
+  // several elements along more than one axis of a blocked layout can access
+  // vectors along an axis other than order[0]. With \param ragged, a vector
+  // may be predicated by the mask of its first element.
+  unsigned getVectorAxis(Value ptr, Value mask, unsigned &vec,
+                         bool ragged = false) const {
+    auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
+    vec = 1;
+    if (!tensorTy)
+      return 0;
+    auto getAxisVectorSize = [&](unsigned axis) {
+      unsigned size = axisAnalysisPass.getPtrVectorSize(ptr, axis);
+      if (mask)
+        size = std::min(
+            size, ragged ? axisAnalysisPass.getRaggedMaskAlignment(mask, axis)
+                         : axisAnalysisPass.getMaskAlignment(mask, axis));
+      return size;
+    };
+    auto order = triton::gpu::getOrder(tensorTy.getEncoding());
+    unsigned axis = order[0];
+    vec = getAxisVectorSize(axis);
+    if (!tensorTy.getEncoding().isa<triton::gpu::BlockedEncodingAttr>())
+      return axis;
+    for (unsigned d : order) {
+      unsigned size = getAxisVectorSize(d);
+      if (size > vec) {
+        axis = d;
+        vec = size;
+      }
+    }
+    return axis;
+  }
+
+  // Returns the order in which each thread accesses the elements of \param
+  // ptr, so that the elements of each vector are contiguous along \param
+  // axis: the i-th element accessed is the element `order[i]` of the thread.
+  static SmallVector<unsigned> getAccessOrder(Value ptr, unsigned axis) {
+    unsigned numElems = getElemsPerThread(ptr.getType());
+    SmallVector<unsigned> accessOrder(numElems);
+    std::iota(accessOrder.begin(), accessOrder.end(), 0);
+    auto tensorTy = ptr.getType().dyn_cast<RankedTensorType>();
+    if (!tensorTy)
+      return accessOrder;
+    auto blockedLayout =
+        tensorTy.getEncoding().dyn_cast<triton::gpu::BlockedEncodingAttr>();
+    if (!blockedLayout || blockedLayout.getOrder()[0] == axis)
+      return accessOrder;
+    // Elements of the tile of each thread are visited along `axis` first
+    auto order = blockedLayout.getOrder();
+    auto sizePerThread = blockedLayout.getSizePerThread();
+    SmallVector<unsigned> tileOrder{axis};
+    for (unsigned d : order)
+      if (d != axis)
+        tileOrder.push_back(d);
+    unsigned tileSize = product<unsigned>(sizePerThread);
+    for (unsigned i = 0; i < numElems; ++i) {
+      auto multiDimId =
+          getMultiDimIndex<unsigned>(i % tileSize, sizePerThread, tileOrder);
+      accessOrder[i] = i / tileSize * tileSize +
+                       getLinearIndex<unsigned>(multiDimId, sizePerThread,
+                                                order);
+    }
+    return accessOrder;
+  }
+
+  static SmallVector<Value> permute(ArrayRef<Value> elems,
+                                    ArrayRef<unsigned> order) {
+    if (elems.empty())
+      return {};
+    SmallVector<Value> permuted;
+    for (unsigned i : order)
+      permuted.push_back(elems[i]);
+    return permuted;
+  }
+
   unsigned getMaskAlignment(Value mask) const {
     return axisAnalysisPass.getMaskAlignment(mask);
   }
 
+  bool isMaskAlwaysTrue(Value mask) const {
+    return mask && axisAnalysisPass.isMaskAlwaysTrue(mask);
+  }
+
+  // Returns whether global accesses of \param elemTy with these hints are
+  // lowered to LLVM loads and stores, which LLVM can schedule, merge and
+  // analyze, rather than to inline PTX. LLVM has no equivalent of the
+  // eviction policies nor of the .cg and .wt cache modifiers; .cs maps to
+  // non-temporal accesses.
+  bool useLLVMAccesses(triton::CacheModifier cache,
+                       triton::EvictionPolicy evict, Type elemTy) const {
+    if (!nativeLoadStore || evict != triton::EvictionPolicy::NORMAL)
+      return false;
+    // i1 elements are accessed as bytes by the inline PTX
+    if (elemTy.isInteger(1))
+      return false;
+    return cache == triton::CacheModifier::NONE ||
+           cache == triton::CacheModifier::CA ||
+           cache == triton::CacheModifier::CS;
+  }
+
+  // Emits the operations built by \param thenBuilder in a block executed only
+  // when \param pred is true (always if it is null), and returns the values
+  // they yield, or \param elseVals when \param pred is false.
+  static SmallVector<Value>
+  createPredicatedBlock(ConversionPatternRewriter &rewriter, Location loc,
+                        Value pred, ValueRange elseVals,
+                        function_ref<SmallVector<Value>()> thenBuilder) {
+    if (!pred)
+      return thenBuilder();
+    Block *prevBlock = rewriter.getInsertionBlock();
+    Block *endBlock =
+        rewriter.splitBlock(prevBlock, rewriter.getInsertionPoint());
+    SmallVector<Value> results;
+    for (Value val : elseVals)
+      results.push_back(endBlock->addArgument(val.getType(), loc));
+    Block *thenBlock = rewriter.createBlock(endBlock);
+    SmallVector<Value> thenVals = thenBuilder();
+    rewriter.create<LLVM::BrOp>(loc, thenVals, endBlock);
+    rewriter.setInsertionPointToEnd(prevBlock);
+    rewriter.create<LLVM::CondBrOp>(loc, pred, thenBlock, ValueRange(),
+                                    endBlock, elseVals);
+    rewriter.setInsertionPointToStart(endBlock);
+    return results;
+  }
+
+  // Returns \param ptr as a pointer to \param vecTy in the same address space
+  static Value getVectorPtr(ConversionPatternRewriter &rewriter, Location loc,
+                            Value ptr, VectorType vecTy) {
+    auto ptrTy = ptr.getType().cast<LLVM::LLVMPointerType>();
+    return bitcast(ptr, ptr_ty(vecTy, ptrTy.getAddressSpace()));
+  }
+
+  // Create the L2 cache policy matching \param evict, to be passed to the
+  // `L2::cache_hint` qualifier of global loads and stores. Returns a null
+  // value for the default policy or if the target has no L2 cache hints.
+  Value createL2CachePolicy(triton::EvictionPolicy evict,
+                            ConversionPatternRewriter &rewriter,
+                            Location loc) const {
+    if (computeCapability < 80)
+      return Value();
+    std::string l2Priority;
+    switch (evict) {
+    case triton::EvictionPolicy::EVICT_FIRST:
+    case triton::EvictionPolicy::NO_ALLOCATE:
+      l2Priority = "L2::evict_first";
+      break;
+    case triton::EvictionPolicy::EVICT_LAST:
+      l2Priority = "L2::evict_last";
+      break;
+    default:
+      return Value();
+    }
+    PTXBuilder ptxBuilder;
+    auto &createPolicy = ptxBuilder.create<>("createpolicy")
+                             ->o("fractional")
+                             .o(l2Priority)
+                             .b(64);
+    createPolicy(ptxBuilder.newOperand("=l"));
+    return ptxBuilder.launch(rewriter, loc, i64_ty, /*hasSideEffect=*/false);
+  }
+
 protected:
   AxisInfoAnalysis &axisAnalysisPass;
+  int computeCapability;
+  bool nativeLoadStore;
 };
 
 struct LoadOpConversion
@@ -50,9 +216,11 @@ struct LoadOpConversion
       triton::LoadOp>::ConvertTritonGPUOpToLLVMPattern;
 
   LoadOpConversion(LLVMTypeConverter &converter,
-                   AxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+                   AxisInfoAnalysis &axisAnalysisPass, int computeCapability,
+                   bool nativeLoadStore, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::LoadOp>(converter, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability,
+                                nativeLoadStore) {}
 
   LogicalResult
   matchAndRewrite(triton::LoadOp op, OpAdaptor adaptor,
@@ -69,23 +237,34 @@ struct LoadOpConversion
     Value llMask = adaptor.mask();
     Value llOther = adaptor.other();
 
+    // Masks that are always true need no predication
+    if (isMaskAlwaysTrue(mask))
+      mask = llMask = other = llOther = Value();
+
     // Determine the vectorization size
     Type valueTy = op.getResult().getType();
     Type valueElemTy =
         typeConverter->convertType(getElementTypeOrSelf(valueTy));
-    unsigned vec = getVectorSize(ptr);
+    unsigned vec = 1;
+    unsigned axis =
+        getVectorAxis(ptr, llMask ? mask : Value(), vec, op.ragged());
     unsigned numElems = getElemsPerThread(ptr.getType());
-    if (llMask)
-      vec = std::min<size_t>(vec, getMaskAlignment(mask));
+    auto accessOrder = getAccessOrder(ptr, axis);
+    // The masked-out elements of ragged vectors loaded under the mask of their
+    // first element are replaced by `other` after the load
+    bool selectOther =
+        llMask && other && vec > axisAnalysisPass.getMaskAlignment(mask, axis);
 
     // Get the LLVM values for pointers
-    auto ptrElems = getLLVMElems(ptr, llPtr, rewriter, loc);
+    auto ptrElems =
+        permute(getLLVMElems(ptr, llPtr, rewriter, loc), accessOrder);
     assert(ptrElems.size() == numElems);
 
     // Get the LLVM values for mask
     SmallVector<Value> maskElems;
     if (llMask) {
-      maskElems = getLLVMElems(mask, llMask, rewriter, loc);
+      maskElems =
+          permute(getLLVMElems(mask, llMask, rewriter, loc), accessOrder);
       assert(maskElems.size() == numElems);
     }
 
@@ -100,15 +279,42 @@ struct LoadOpConversion
       otherIsSplatConstInt = true;
       splatVal = constAttr.getSplatValue<APInt>().getSExtValue();
     }
-    auto otherElems = getLLVMElems(other, llOther, rewriter, loc);
+    auto otherElems =
+        permute(getLLVMElems(other, llOther, rewriter, loc), accessOrder);
 
     // vectorized iteration through all the pointer/mask/other elements
     const int valueElemNbits =
         std::max(8u, valueElemTy.getIntOrFloatBitWidth());
     const int numVecs = numElems / vec;
 
+    Value l2Policy = createL2CachePolicy(op.evict(), rewriter, loc);
+    bool llvmLoads = useLLVMAccesses(op.cache(), op.evict(), valueElemTy);
+    unsigned alignment = vec * valueElemNbits / 8;
+
     SmallVector<Value> loadedVals;
     for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+      if (llvmLoads) {
+        // Masked-out elements are `other`, or undefined without it
+        auto vecTy = vec_ty(valueElemTy, vec);
+        Value otherVec = undef(vecTy);
+        for (size_t ii = 0; other && ii < vec; ++ii)
+          otherVec = insert_element(vecTy, otherVec,
+                                    otherElems[vecStart + ii], i32_val(ii));
+        Value vecPtr = getVectorPtr(rewriter, loc, ptrElems[vecStart], vecTy);
+        Value pred = llMask ? maskElems[vecStart] : Value();
+        Value loaded =
+            createPredicatedBlock(rewriter, loc, pred, otherVec, [&] {
+              auto ld = rewriter.create<LLVM::LoadOp>(
+                  loc, vecPtr, alignment, op.isVolatile(),
+                  /*isNonTemporal=*/op.cache() == triton::CacheModifier::CS);
+              return SmallVector<Value>{ld.getResult()};
+            })[0];
+        for (size_t ii = 0; ii < vec; ++ii)
+          loadedVals.push_back(
+              extract_element(valueElemTy, loaded, i32_val(ii)));
+        continue;
+      }
+
       // TODO: optimization when ptr is GEP with constant offset
       size_t in_off = 0;
 
@@ -119,11 +325,8 @@ struct LoadOpConversion
       const size_t wordNElems = width / valueElemNbits;
       assert(wordNElems * nWords * numVecs == numElems);
 
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-      const bool hasL2EvictPolicy = false;
-
-      PTXBuilder ptxBuilder;
+      // The predicate is bound once for the load and the moves of `other`
+      PTXBuilder ptxBuilder(/*shareOperands=*/true);
 
       Value pred = mask ? maskElems[vecStart] : int_val(1, 1);
 
@@ -148,19 +351,21 @@ struct LoadOpConversion
                      .global()
                      .o("ca", op.cache() == triton::CacheModifier::CA)
                      .o("cg", op.cache() == triton::CacheModifier::CG)
+                     .o("cs", op.cache() == triton::CacheModifier::CS)
+                     .o("nc", op.cache() == triton::CacheModifier::NC)
                      .o("L1::evict_first",
                         op.evict() == triton::EvictionPolicy::EVICT_FIRST)
                      .o("L1::evict_last",
                         op.evict() == triton::EvictionPolicy::EVICT_LAST)
-                     .o("L1::cache_hint", hasL2EvictPolicy)
+                     .o("L1::no_allocate",
+                        op.evict() == triton::EvictionPolicy::NO_ALLOCATE)
+                     .o("L2::cache_hint", bool(l2Policy))
                      .v(nWords)
                      .b(width);
 
       PTXBuilder::Operand *evictOpr{};
-
-      // Here lack a mlir::Value to bind to this operation, so disabled.
-      // if (has_l2_evict_policy)
-      //   evictOpr = ptxBuilder.newOperand(l2Evict, "l");
+      if (l2Policy)
+        evictOpr = ptxBuilder.newOperand(l2Policy, "l");
 
       if (!evictOpr)
         ld(dstsOpr, addrOpr).predicate(pred, "b");
@@ -202,10 +407,6 @@ struct LoadOpConversion
                        ? LLVM::LLVMStructType::getLiteral(getContext(), retTys)
                        : retTys[0];
 
-      // TODO: if (has_l2_evict_policy)
-      // auto asmDialectAttr =
-      // LLVM::AsmDialectAttr::get(rewriter.getContext(),
-      //                                                 LLVM::AsmDialect::AD_ATT);
       Value ret = ptxBuilder.launch(rewriter, loc, retTy);
 
       // Extract and store return values
@@ -231,9 +432,17 @@ struct LoadOpConversion
       }
     } // end vec
 
+    for (unsigned i = 0; selectOther && i < numElems; ++i)
+      loadedVals[i] = select(maskElems[i], loadedVals[i], otherElems[i]);
+
+    // Put the loaded values back in the order of the layout
+    SmallVector<Value> resultVals(numElems);
+    for (unsigned i = 0; i < numElems; ++i)
+      resultVals[accessOrder[i]] = loadedVals[i];
+
     Type llvmResultStructTy = getTypeConverter()->convertType(valueTy);
     Value resultStruct =
-        getStructFromElements(loc, loadedVals, rewriter, llvmResultStructTy);
+        getStructFromElements(loc, resultVals, rewriter, llvmResultStructTy);
     rewriter.replaceOp(op, {resultStruct});
     return success();
   }
@@ -246,9 +455,11 @@ struct StoreOpConversion
       triton::StoreOp>::ConvertTritonGPUOpToLLVMPattern;
 
   StoreOpConversion(LLVMTypeConverter &converter,
-                    AxisInfoAnalysis &axisAnalysisPass, PatternBenefit benefit)
+                    AxisInfoAnalysis &axisAnalysisPass, int computeCapability,
+                    bool nativeLoadStore, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::StoreOp>(converter, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability,
+                                nativeLoadStore) {}
 
   LogicalResult
   matchAndRewrite(triton::StoreOp op, OpAdaptor adaptor,
@@ -261,6 +472,9 @@ struct StoreOpConversion
     Value llMask = adaptor.mask();
     Value llValue = adaptor.value();
 
+    if (isMaskAlwaysTrue(mask))
+      mask = llMask = Value();
+
     auto loc = op->getLoc();
     MLIRContext *ctx = rewriter.getContext();
 
@@ -268,29 +482,60 @@ struct StoreOpConversion
     Type valueElemTy =
         typeConverter->convertType(getElementTypeOrSelf(valueTy));
 
-    unsigned vec = getVectorSize(ptr);
+    // Determine the vectorization size
+    unsigned vec = 1;
+    unsigned axis = getVectorAxis(ptr, llMask ? mask : Value(), vec);
     unsigned numElems = getElemsPerThread(ptr.getType());
+    auto accessOrder = getAccessOrder(ptr, axis);
 
-    auto ptrElems = getLLVMElems(ptr, llPtr, rewriter, loc);
-    auto valueElems = getLLVMElems(value, llValue, rewriter, loc);
+    auto ptrElems =
+        permute(getLLVMElems(ptr, llPtr, rewriter, loc), accessOrder);
+    auto valueElems =
+        permute(getLLVMElems(value, llValue, rewriter, loc), accessOrder);
     assert(ptrElems.size() == valueElems.size());
 
-    // Determine the vectorization size
     SmallVector<Value> maskElems;
     if (llMask) {
-      maskElems = getLLVMElems(mask, llMask, rewriter, loc);
+      maskElems =
+          permute(getLLVMElems(mask, llMask, rewriter, loc), accessOrder);
       assert(valueElems.size() == maskElems.size());
-
-      unsigned maskAlign = getMaskAlignment(mask);
-      vec = std::min(vec, maskAlign);
     }
 
     const size_t dtsize =
         std::max<int>(1, valueElemTy.getIntOrFloatBitWidth() / 8);
     const size_t valueElemNbits = dtsize * 8;
 
+    Value l2Policy = createL2CachePolicy(op.evict(), rewriter, loc);
+
+    // The stores of up to `storesPerAsm` vectors are emitted in a single asm
+    // block, sharing the operands of the cache policy, of masks and of
+    // constants.
+    constexpr int storesPerAsm = 8;
+    std::unique_ptr<PTXBuilder> ptxBuilder;
+    int numBatched = 0;
+    bool llvmStores = useLLVMAccesses(op.cache(), op.evict(), valueElemTy);
+
     const int numVecs = numElems / vec;
     for (size_t vecStart = 0; vecStart < numElems; vecStart += vec) {
+      if (llvmStores) {
+        auto vecTy = vec_ty(valueElemTy, vec);
+        Value vecVal = undef(vecTy);
+        for (size_t ii = 0; ii < vec; ++ii)
+          vecVal = insert_element(vecTy, vecVal,
+                                  bitcast(valueElems[vecStart + ii],
+                                          valueElemTy),
+                                  i32_val(ii));
+        Value vecPtr = getVectorPtr(rewriter, loc, ptrElems[vecStart], vecTy);
+        Value pred = llMask ? maskElems[vecStart] : Value();
+        createPredicatedBlock(rewriter, loc, pred, {}, [&] {
+          rewriter.create<LLVM::StoreOp>(
+              loc, vecVal, vecPtr, vec * dtsize, /*isVolatile=*/false,
+              /*isNonTemporal=*/op.cache() == triton::CacheModifier::CS);
+          return SmallVector<Value>();
+        });
+        continue;
+      }
+
       // TODO: optimization when ptr is AddPtr with constant offset
       size_t in_off = 0;
 
@@ -301,9 +546,6 @@ struct StoreOpConversion
       const size_t wordNElems = width / valueElemNbits;
       assert(wordNElems * nWords * numVecs == numElems);
 
-      // TODO(Superjomn) Add cache policy fields to StoreOp.
-      // TODO(Superjomn) Deal with cache policy here.
-
       Type valArgTy = IntegerType::get(ctx, width);
       auto wordTy = vec_ty(valueElemTy, wordNElems);
 
@@ -330,25 +572,42 @@ struct StoreOpConversion
       }
 
       // Prepare the PTX inline asm.
-      PTXBuilder ptxBuilder;
-      auto *asmArgList = ptxBuilder.newListOperand(asmArgs);
+      if (!ptxBuilder)
+        ptxBuilder = std::make_unique<PTXBuilder>(/*shareOperands=*/true);
+      auto *asmArgList = ptxBuilder->newListOperand(asmArgs);
 
       Value maskVal = llMask ? maskElems[vecStart] : int_val(1, 1);
 
       auto *asmAddr =
-          ptxBuilder.newAddrOperand(ptrElems[vecStart], "l", in_off);
+          ptxBuilder->newAddrOperand(ptrElems[vecStart], "l", in_off);
 
       auto &ptxStoreInstr =
-          ptxBuilder.create<>("st")->global().v(nWords).b(width);
-      ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
-
-      Type boolTy = getTypeConverter()->convertType(rewriter.getIntegerType(1));
-      llvm::SmallVector<Type> argTys({boolTy, ptr.getType()});
-      argTys.insert(argTys.end(), nWords, valArgTy);
-
-      auto asmReturnTy = void_ty(ctx);
+          ptxBuilder->create<>("st")
+              ->global()
+              .o("cg", op.cache() == triton::CacheModifier::CG)
+              .o("cs", op.cache() == triton::CacheModifier::CS)
+              .o("wt", op.cache() == triton::CacheModifier::WT)
+              .o("L1::evict_first",
+                 op.evict() == triton::EvictionPolicy::EVICT_FIRST)
+              .o("L1::evict_last",
+                 op.evict() == triton::EvictionPolicy::EVICT_LAST)
+              .o("L1::no_allocate",
+                 op.evict() == triton::EvictionPolicy::NO_ALLOCATE)
+              .o("L2::cache_hint", bool(l2Policy))
+              .v(nWords)
+              .b(width);
+      if (l2Policy)
+        ptxStoreInstr(asmAddr, asmArgList,
+                      ptxBuilder->newOperand(l2Policy, "l"))
+            .predicate(maskVal, "b");
+      else
+        ptxStoreInstr(asmAddr, asmArgList).predicate(maskVal, "b");
 
-      ptxBuilder.launch(rewriter, loc, asmReturnTy);
+      if (++numBatched == storesPerAsm || vecStart + vec == numElems) {
+        ptxBuilder->launch(rewriter, loc, void_ty(ctx));
+        ptxBuilder.reset();
+        numBatched = 0;
+      }
     }
     rewriter.eraseOp(op);
     return success();
@@ -439,10 +698,10 @@ struct AtomicRMWOpConversion
   AtomicRMWOpConversion(LLVMTypeConverter &converter,
                         const Allocation *allocation, Value smem,
                         AxisInfoAnalysis &axisAnalysisPass,
-                        PatternBenefit benefit)
+                        int computeCapability, PatternBenefit benefit)
       : ConvertTritonGPUOpToLLVMPattern<triton::AtomicRMWOp>(
             converter, allocation, smem, benefit),
-        LoadStoreConversionBase(axisAnalysisPass) {}
+        LoadStoreConversionBase(axisAnalysisPass, computeCapability) {}
 
   LogicalResult
   matchAndRewrite(triton::AtomicRMWOp op, OpAdaptor adaptor,
@@ -468,6 +727,14 @@ struct AtomicRMWOpConversion
                 : op.getResult().getType();
     const size_t valueElemNbits = valueElemTy.getIntOrFloatBitWidth();
     auto elemsPerThread = getElemsPerThread(val.getType());
+    // When the old values are not used, the update is issued as a reduction
+    // (red), which doesn't wait for memory to respond.
+    bool isReduction = valueTy && op.getResult().use_empty() &&
+                       atomicRmwAttr != RMWOp::XCHG;
+    bool isWarpAggregated =
+        isReduction && op.warp_aggregate() && isAggregatable(atomicRmwAttr);
+    if (valueTy && op.grid_sync())
+      return op.emitError("grid_sync is only supported by scalar atomics");
     // vec = 1 for scalar
     auto vec = getVectorSize(ptr);
     Value mask = int_val(1, 1);
@@ -475,7 +742,11 @@ struct AtomicRMWOpConversion
     // tensor
     if (valueTy) {
       auto valTy = val.getType().cast<RankedTensorType>();
-      vec = std::min<unsigned>(vec, valTy.getElementType().isF16() ? 2 : 1);
+      vec = std::min<unsigned>(vec, getMaxVectorSize(valTy.getElementType(),
+                                                     atomicRmwAttr,
+                                                     isReduction));
+      if (isWarpAggregated)
+        vec = 1;
       // mask
       auto shape = valueTy.getShape();
       auto numElements = product(shape);
@@ -483,29 +754,61 @@ struct AtomicRMWOpConversion
                                  i32_val(numElements)));
     }
 
+    // A vector reduction of more than two f16 is issued as a vector of f16x2
+    bool isF16x2 = valueElemNbits == 16 && vec >= 2;
+    unsigned wordNElems = isF16x2 ? 2 : 1;
+    unsigned nWords = vec / wordNElems;
+    Type wordTy = isF16x2 ? vec_ty(valueElemTy, 2) : valueElemTy;
     auto vecTy = vec_ty(valueElemTy, vec);
     SmallVector<Value> resultVals(elemsPerThread);
     for (size_t i = 0; i < elemsPerThread; i += vec) {
-      Value rmwVal = undef(vecTy);
-      for (int ii = 0; ii < vec; ++ii) {
-        Value iiVal = createIndexAttrConstant(
-            rewriter, loc, getTypeConverter()->getIndexType(), ii);
-        rmwVal = insert_element(vecTy, rmwVal, valElements[i + ii], iiVal);
-      }
-
       Value rmwPtr = ptrElements[i];
       Value rmwMask = maskElements[i];
       rmwMask = and_(rmwMask, mask);
+      if (isWarpAggregated) {
+        // Only one lane of each group of lanes with the same destination
+        // issues the reduction, with the combined value of the group
+        Value rmwVal = valElements[i];
+        Value isLeader;
+        rmwVal = aggregateInWarp(loc, rewriter, atomicRmwAttr, rmwPtr, rmwVal,
+                                 rmwMask, isLeader);
+        valElements[i] = rmwVal;
+        rmwMask = and_(rmwMask, isLeader);
+      }
+      SmallVector<Value> words(nWords);
+      for (unsigned w = 0; w < nWords; ++w) {
+        Value word = isF16x2 ? undef(wordTy) : valElements[i + w];
+        for (unsigned ii = 0; isF16x2 && ii < wordNElems; ++ii) {
+          Value iiVal = createIndexAttrConstant(
+              rewriter, loc, getTypeConverter()->getIndexType(), ii);
+          word = insert_element(wordTy, word,
+                                valElements[i + w * wordNElems + ii], iiVal);
+        }
+        words[w] = word;
+      }
+
       std::string sTy;
       PTXBuilder ptxBuilderAtomicRMW;
-      std::string tyId = valueElemNbits * vec == 64
-                             ? "l"
-                             : (valueElemNbits * vec == 32 ? "r" : "h");
-      auto *dstOpr = ptxBuilderAtomicRMW.newOperand("=" + tyId);
+      unsigned wordNbits = valueElemNbits * wordNElems;
+      std::string tyId =
+          wordNbits == 64 ? "l" : (wordNbits == 32 ? "r" : "h");
+      // Reductions don't return the old value
+      PTXBuilder::Operand *dstOpr =
+          isReduction ? nullptr : ptxBuilderAtomicRMW.newOperand("=" + tyId);
       auto *ptrOpr = ptxBuilderAtomicRMW.newAddrOperand(rmwPtr, "l");
-      auto *valOpr = ptxBuilderAtomicRMW.newOperand(rmwVal, tyId);
+      PTXBuilder::Operand *valOpr;
+      if (nWords == 1) {
+        valOpr = ptxBuilderAtomicRMW.newOperand(words[0], tyId);
+      } else {
+        SmallVector<std::pair<Value, std::string>> wordOprs;
+        for (Value word : words)
+          wordOprs.emplace_back(word, tyId);
+        valOpr = ptxBuilderAtomicRMW.newListOperand(wordOprs);
+      }
 
-      auto &atom = ptxBuilderAtomicRMW.create<>("atom")->global().o("gpu");
+      auto &atom = ptxBuilderAtomicRMW.create<>(isReduction ? "red" : "atom")
+                       ->global()
+                       .o("gpu");
       auto rmwOp = stringifyRMWOp(atomicRmwAttr).str();
       auto sBits = std::to_string(valueElemNbits);
       switch (atomicRmwAttr) {
@@ -525,7 +828,7 @@ struct AtomicRMWOpConversion
         rmwOp = "add";
         rmwOp += (valueElemNbits == 16 ? ".noftz" : "");
         sTy = "f" + sBits;
-        sTy += (vec == 2 && valueElemNbits == 16) ? "x2" : "";
+        sTy += isF16x2 ? "x2" : "";
         break;
       case RMWOp::MAX:
         sTy = "s" + sBits;
@@ -547,8 +850,14 @@ struct AtomicRMWOpConversion
       default:
         return failure();
       }
-      atom.o(rmwOp).o(sTy);
-      if (valueTy) {
+      atom.o(rmwOp).v(nWords, nWords > 1).o(sTy);
+      if (isReduction) {
+        atom(ptrOpr, valOpr).predicate(rmwMask);
+        ptxBuilderAtomicRMW.launch(rewriter, loc, void_ty(ctx));
+        // The old values are never read
+        for (int ii = 0; ii < vec; ++ii)
+          resultVals[i + ii] = undef(valueElemTy);
+      } else if (valueTy) {
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto retType = vec == 1 ? valueElemTy : vecTy;
         auto ret = ptxBuilderAtomicRMW.launch(rewriter, loc, retType);
@@ -557,6 +866,10 @@ struct AtomicRMWOpConversion
               vec == 1 ? ret : extract_element(valueElemTy, ret, idx_val(ii));
         }
       } else {
+        // With grid_sync, the writes of the other threads are ordered before
+        // the fence of the thread issuing the update by the barrier
+        if (op.grid_sync())
+          barrier();
         PTXBuilder ptxBuilderMemfence;
         auto memfenc = ptxBuilderMemfence.create<PTXInstr>("membar")->o("gl");
         memfenc();
@@ -565,6 +878,10 @@ struct AtomicRMWOpConversion
         rmwMask = and_(rmwMask, icmp_eq(tid, i32_val(0)));
         atom(dstOpr, ptrOpr, valOpr).predicate(rmwMask);
         auto old = ptxBuilderAtomicRMW.launch(rewriter, loc, valueElemTy);
+        // ... and the writes it observes are ordered before the reads of all
+        // the threads by the fence and the barrier below
+        if (op.grid_sync())
+          ptxBuilderMemfence.launch(rewriter, loc, ASMReturnTy);
         Value atomPtr = getSharedMemoryBase(loc, rewriter, op.getOperation());
         atomPtr = bitcast(atomPtr, ptr_ty(valueElemTy, 3));
         store(old, atomPtr);
@@ -582,6 +899,116 @@ struct AtomicRMWOpConversion
     }
     return success();
   }
+
+private:
+  // Returns the maximal number of contiguous elements updated by a single
+  // atomic instruction.
+  unsigned getMaxVectorSize(Type elemTy, RMWOp rmwOp, bool isReduction) const {
+    if (rmwOp != RMWOp::FADD)
+      return 1;
+    // red.global.add.v{2,4}.{f32,f16x2} is only available on sm_90
+    if (isReduction && computeCapability >= 90) {
+      if (elemTy.isF32())
+        return 4;
+      if (elemTy.isF16())
+        return 8;
+    }
+    return elemTy.isF16() ? 2 : 1;
+  }
+
+  static bool isAggregatable(RMWOp rmwOp) {
+    switch (rmwOp) {
+    case RMWOp::AND:
+    case RMWOp::OR:
+    case RMWOp::XOR:
+    case RMWOp::ADD:
+    case RMWOp::FADD:
+    case RMWOp::MAX:
+    case RMWOp::MIN:
+    case RMWOp::UMAX:
+    case RMWOp::UMIN:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  Value combine(Location loc, ConversionPatternRewriter &rewriter,
+                RMWOp rmwOp, Value lhs, Value rhs) const {
+    switch (rmwOp) {
+    case RMWOp::AND:
+      return and_(lhs, rhs);
+    case RMWOp::OR:
+      return rewriter.create<LLVM::OrOp>(loc, lhs, rhs);
+    case RMWOp::XOR:
+      return xor_(lhs, rhs);
+    case RMWOp::ADD:
+      return add(lhs, rhs);
+    case RMWOp::FADD:
+      return fadd(lhs, rhs);
+    case RMWOp::MAX:
+      return smax(lhs, rhs);
+    case RMWOp::MIN:
+      return smin(lhs, rhs);
+    case RMWOp::UMAX:
+      return umax(lhs, rhs);
+    case RMWOp::UMIN:
+      return umin(lhs, rhs);
+    default:
+      llvm_unreachable("unsupported warp-aggregated atomic");
+    }
+  }
+
+  // Combine the values of the active lanes of the warp that update the same
+  // address. The lanes of a group are ranked by lane id, and the values are
+  // reduced with a tree: at step s, the lane of rank r (r % 2s == 0) gathers
+  // the partial result of the lane of rank r + s, which is found with fns.
+  // The lane of rank 0 of each group holds the combined value of the group,
+  // and sets \param isLeader.
+  Value aggregateInWarp(Location loc, ConversionPatternRewriter &rewriter,
+                        RMWOp rmwOp, Value ptr, Value val, Value pred,
+                        Value &isLeader) const {
+    Value laneId = urem(tid_val(), i32_val(32));
+
+    PTXBuilder matchBuilder;
+    auto &match = matchBuilder.create<>("match")->o("any").o("sync").b(64);
+    auto *peersOpr = matchBuilder.newOperand("=r");
+    auto *addrOpr = matchBuilder.newOperand(ptrtoint(i64_ty, ptr), "l");
+    match(peersOpr, addrOpr, matchBuilder.newConstantOperand("0xffffffff"));
+    Value peers = matchBuilder.launch(rewriter, loc, i32_ty, false);
+
+    PTXBuilder ballotBuilder;
+    auto &ballot = ballotBuilder.create<>("vote")->o("sync").o("ballot").b(32);
+    auto *activeOpr = ballotBuilder.newOperand("=r");
+    auto *predOpr = ballotBuilder.newOperand(pred, "b");
+    ballot(activeOpr, predOpr, ballotBuilder.newConstantOperand("0xffffffff"));
+    Value active = ballotBuilder.launch(rewriter, loc, i32_ty, false);
+    peers = and_(peers, active);
+
+    Value laneBit = rewriter.create<LLVM::ShlOp>(loc, i32_val(1), laneId);
+    Value laneMaskLt = sub(laneBit, i32_val(1));
+    Value rank =
+        rewriter.create<LLVM::CtPopOp>(loc, i32_ty, and_(peers, laneMaskLt));
+
+    Value acc = val;
+    for (unsigned s = 1; s < 32; s *= 2) {
+      PTXBuilder fnsBuilder;
+      auto &fns = fnsBuilder.create<>("fns")->b(32);
+      auto *srcOpr = fnsBuilder.newOperand("=r");
+      fns(srcOpr, fnsBuilder.newOperand(peers, "r"),
+          fnsBuilder.newOperand(laneId, "r"),
+          fnsBuilder.newConstantOperand(s + 1));
+      Value srcLane = fnsBuilder.launch(rewriter, loc, i32_ty, false);
+      // All the lanes take part in the shuffle
+      Value other = shflIdxSync(loc, rewriter, acc, srcLane);
+      Value isReceiver = icmp_eq(urem(rank, i32_val(2 * s)), i32_val(0));
+      Value hasSource = icmp_ne(srcLane, i32_val(-1));
+      acc = select(and_(isReceiver, hasSource),
+                   combine(loc, rewriter, rmwOp, acc, other), acc);
+    }
+    isLeader = icmp_eq(rank, i32_val(0));
+    return acc;
+  }
 };
 
 struct InsertSliceOpConversion
@@ -807,21 +1234,116 @@ struct InsertSliceAsyncOpConversion
   }
 };
 
+struct InsertSliceTMAOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::InsertSliceTMAOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::InsertSliceTMAOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::InsertSliceTMAOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // insert_slice_tma %desc[%col, %row], %dst, %index, %pred
+    auto loc = op.getLoc();
+    auto dstTy = op.dst().getType().cast<RankedTensorType>();
+    auto elemTy = getTypeConverter()->convertType(dstTy.getElementType());
+    assert(adaptor.coords().size() == 2 &&
+           "insert_slice_tma: Unexpected number of coordinates");
+
+    // The copy writes the whole slice %index along the first axis
+    auto smemObj =
+        getSharedMemoryObjectFromStruct(loc, adaptor.dst(), rewriter);
+    Value dstPtr = gep(ptr_ty(elemTy, 3), smemObj.base,
+                       mul(adaptor.index(), smemObj.strides[0]));
+    Value mbarrier = getMBarrierPtr(loc, rewriter, op, op.mbarrier(),
+                                    adaptor.index());
+    unsigned bytes = product<int64_t>(dstTy.getShape().drop_front()) *
+                     triton::getIntOrFloatBitWidth(dstTy.getElementType()) / 8;
+
+    // A multicast copy writes the same rows of the slice into every CTA of
+    // the cluster, and each CTA copies its own share of the rows. The slice
+    // must be free in all the CTAs before any of them overwrites it. Each
+    // mbarrier still expects the bytes of the whole slice.
+    Value row = adaptor.coords()[1];
+    unsigned multicast = op.multicast();
+    if (multicast > 1) {
+      PTXBuilder fenceBuilder;
+      auto &fence = *fenceBuilder.create<>("fence.proxy.async.shared::cta");
+      fence();
+      fenceBuilder.launch(rewriter, loc, void_ty(getContext()));
+      clusterBarrier(loc, rewriter);
+      int64_t shareRows = dstTy.getShape()[1] / multicast;
+      Value firstRow =
+          mul(getClusterCTARank(loc, rewriter), i32_val(shareRows));
+      dstPtr = gep(ptr_ty(elemTy, 3), dstPtr,
+                   mul(firstRow, i32_val(dstTy.getShape()[2])));
+      row = add(row, firstRow);
+    }
+
+    // A single thread issues the copy. It arrives on the mbarrier whether the
+    // copy is issued or not, so that the phase of every slice completes.
+    // The fence orders the previous reads of the slice before the copy.
+    Value isThread0 = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    Value pred = and_(adaptor.pred(), isThread0);
+    Value txBytes = select(adaptor.pred(), i32_val(bytes), i32_val(0));
+
+    PTXBuilder ptxBuilder;
+    auto *ptxAsm =
+        "{\n"
+        ".reg .b64 state;\n"
+        "@$6 fence.proxy.async.shared::cta;\n"
+        "@$6 mbarrier.arrive.expect_tx.shared.b64 state, [$0], $1;\n"
+        "@$7 cp.async.bulk.tensor.2d.shared::cluster.global.mbarrier::"
+        "complete_tx::bytes [$2], [$3, {$4, $5}], [$0];\n"
+        "}";
+    auto *multicastAsm =
+        "{\n"
+        ".reg .b64 state;\n"
+        "@$6 mbarrier.arrive.expect_tx.shared.b64 state, [$0], $1;\n"
+        "@$7 cp.async.bulk.tensor.2d.shared::cluster.global.mbarrier::"
+        "complete_tx::bytes.multicast::cluster [$2], [$3, {$4, $5}], [$0], "
+        "$8;\n"
+        "}";
+    auto &copy = *ptxBuilder.create(multicast > 1 ? multicastAsm : ptxAsm);
+    SmallVector<PTXBuilder::Operand *, 9> operands = {
+        ptxBuilder.newOperand(mbarrier, "r"),
+        ptxBuilder.newOperand(txBytes, "r"),
+        ptxBuilder.newOperand(dstPtr, "r"),
+        ptxBuilder.newOperand(adaptor.desc(), "l"),
+        ptxBuilder.newOperand(adaptor.coords()[0], "r"),
+        ptxBuilder.newOperand(row, "r"),
+        ptxBuilder.newOperand(isThread0, "b"),
+        ptxBuilder.newOperand(pred, "b")};
+    if (multicast > 1) {
+      Value ctaMask = int_val(16, (1 << multicast) - 1);
+      operands.push_back(ptxBuilder.newOperand(ctaMask, "h"));
+    }
+    copy(operands, /*onlyAttachMLIRArgs=*/true);
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+
+    rewriter.replaceOp(op, adaptor.dst());
+    return success();
+  }
+};
+
 void populateLoadStoreOpToLLVMPatterns(
     mlir::LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
     int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
     const Allocation *allocation, Value smem,
     ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
-    PatternBenefit benefit) {
-  patterns.add<LoadOpConversion>(typeConverter, axisInfoAnalysis, benefit);
-  patterns.add<StoreOpConversion>(typeConverter, axisInfoAnalysis, benefit);
+    int computeCapability, bool nativeLoadStore, PatternBenefit benefit) {
+  patterns.add<LoadOpConversion>(typeConverter, axisInfoAnalysis,
+                                 computeCapability, nativeLoadStore, benefit);
+  patterns.add<StoreOpConversion>(typeConverter, axisInfoAnalysis,
+                                  computeCapability, nativeLoadStore, benefit);
   patterns.add<AtomicCASOpConversion>(typeConverter, allocation, smem,
                                       axisInfoAnalysis, benefit);
   patterns.add<AtomicRMWOpConversion>(typeConverter, allocation, smem,
-                                      axisInfoAnalysis, benefit);
+                                      axisInfoAnalysis, computeCapability,
+                                      benefit);
   patterns.add<InsertSliceOpConversion>(typeConverter, allocation, smem,
                                         indexCacheInfo, benefit);
   patterns.add<InsertSliceAsyncOpConversion>(typeConverter, allocation, smem,
                                              indexCacheInfo, axisInfoAnalysis,
                                              benefit);
+  patterns.add<InsertSliceTMAOpConversion>(typeConverter, benefit);
 }
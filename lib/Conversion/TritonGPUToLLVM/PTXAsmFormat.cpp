@@ -1,6 +1,7 @@
 #include "triton/Conversion/TritonGPUToLLVM/PTXAsmFormat.h"
 
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/Support/raw_ostream.h"
 // TODO(Superjomn): unify to llvm::raw_string_ostream
@@ -22,13 +23,36 @@ std::string strJoin(llvm::ArrayRef<std::string> strs,
   return osStr;
 }
 
+PTXInstr::Operand *PTXBuilder::newInputOperand(mlir::Value value,
+                                               StringRef constraint) {
+  argArchive.emplace_back(std::make_unique<Operand>(value, constraint));
+  auto *opr = argArchive.back().get();
+  opr->idx = oprCounter++;
+  return opr;
+}
+
 PTXInstr::Operand *
 PTXBuilder::newOperand(mlir::Value value, StringRef constraint,
                        std::function<std::string(int)> formatter) {
-  argArchive.emplace_back(std::make_unique<Operand>(value, constraint));
-  auto *opr = argArchive.back().get();
+  if (!shareOperands || constraint.startswith("=")) {
+    auto *opr = newInputOperand(value, constraint);
+    opr->repr = formatter;
+    return opr;
+  }
+  // Constants of the same value share their operand
+  const void *key = value.getAsOpaquePointer();
+  Attribute cst;
+  if (matchPattern(value, m_Constant(&cst)))
+    key = cst.getAsOpaquePointer();
+  Operand *&shared = sharedOperands[{key, constraint.str()}];
+  if (!shared)
+    shared = newInputOperand(value, constraint);
+  if (!formatter)
+    return shared;
+  // Print the shared operand with `formatter`, without binding it again
+  auto *opr = newOperand();
+  opr->idx = shared->idx;
   opr->repr = formatter;
-  opr->idx = oprCounter++;
   return opr;
 }
 
@@ -110,14 +134,11 @@ std::string PTXInstr::Operand::dump() const {
 
 PTXInstr::Operand *PTXBuilder::newAddrOperand(mlir::Value addr,
                                               StringRef constraint, int off) {
-  auto *opr = newOperand(addr, constraint);
-  opr->repr = [off](int idx) -> std::string {
+  return newOperand(addr, constraint, [off](int idx) -> std::string {
     std::stringstream ss;
     ss << "[ $" << idx << " + " << off << " ]";
     return ss.str();
-  };
-
-  return opr;
+  });
 }
 
 std::string PTXBuilder::dump() const {
@@ -1,4 +1,5 @@
 #include "ReduceOpToLLVM.h"
+#include "mlir/IR/BlockAndValueMapping.h"
 
 using namespace mlir;
 using namespace mlir::triton;
@@ -19,7 +20,10 @@ public:
   LogicalResult
   matchAndRewrite(triton::ReduceOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
-    if (ReduceOpHelper(op).isFastReduction())
+    ReduceOpHelper helper(op);
+    if (helper.isWarpSynchronous())
+      return matchAndRewriteWarpSync(op, adaptor, rewriter);
+    if (helper.isFastReduction())
       return matchAndRewriteFast(op, adaptor, rewriter);
     return matchAndRewriteBasic(op, adaptor, rewriter);
   }
@@ -133,6 +137,64 @@ private:
     }
   }
 
+  // Reduce the values held by each thread along the reduced axis. Results are
+  // keyed by the offset of the first element, with the axis offset set to 0.
+  void reduceWithinThreads(
+      triton::ReduceOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter,
+      std::map<SmallVector<unsigned>, Value> &accs,
+      std::map<SmallVector<unsigned>, Value> &accIndices,
+      std::map<SmallVector<unsigned>, SmallVector<Value>> &indices) const {
+    Location loc = op->getLoc();
+    unsigned axis = adaptor.axis();
+    bool withIndex = triton::ReduceOp::withIndex(op.redOp());
+    auto srcTy = op.operand().getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding();
+    auto srcShape = srcTy.getShape();
+
+    unsigned srcElems = getElemsPerThread(srcTy);
+    auto srcIndices = emitIndices(loc, rewriter, srcLayout, srcShape);
+    auto srcValues = getElementsFromStruct(loc, adaptor.operand(), rewriter);
+
+    SmallVector<SmallVector<unsigned>> offset =
+        emitOffsetForLayout(srcLayout, srcShape);
+
+    for (unsigned i = 0; i < srcElems; ++i) {
+      SmallVector<unsigned> key = offset[i];
+      key[axis] = 0;
+      bool isFirst = accs.find(key) == accs.end();
+      if (!withIndex) {
+        accumulate(rewriter, loc, op.redOp(), accs[key], srcValues[i], isFirst);
+      } else {
+        Value curIndex = srcIndices[i][axis];
+        accumulateWithIndex(rewriter, loc, op.redOp(), accs[key],
+                            accIndices[key], srcValues[i], curIndex, isFirst);
+      }
+      if (isFirst)
+        indices[key] = srcIndices[i];
+    }
+  }
+
+  // Butterfly shuffles over the lanes of the reduced axis. Since the axis is
+  // the fastest-varying dimension of the lane id, lanes that hold other rows
+  // are never mixed, and every lane ends up with the result of its row.
+  void reduceWithinWarps(triton::ReduceOp op,
+                         ConversionPatternRewriter &rewriter, Location loc,
+                         unsigned sizeIntraWarps, Value &acc,
+                         Value &accIndex) const {
+    bool withIndex = triton::ReduceOp::withIndex(op.redOp());
+    for (unsigned N = sizeIntraWarps / 2; N > 0; N >>= 1) {
+      Value shfl = shflSync(loc, rewriter, acc, N);
+      if (!withIndex) {
+        accumulate(rewriter, loc, op.redOp(), acc, shfl, false);
+      } else {
+        Value shflIndex = shflSync(loc, rewriter, accIndex, N);
+        accumulateWithIndex(rewriter, loc, op.redOp(), acc, accIndex, shfl,
+                            shflIndex, false);
+      }
+    }
+  }
+
   // Use shared memory for reduction within warps and across warps
   LogicalResult
   matchAndRewriteBasic(triton::ReduceOp op, OpAdaptor adaptor,
@@ -285,8 +347,6 @@ private:
 
     auto srcTy = op.operand().getType().cast<RankedTensorType>();
     auto srcLayout = srcTy.getEncoding();
-    auto srcShape = srcTy.getShape();
-    auto srcRank = srcTy.getRank();
     auto order = getOrder(srcLayout);
 
     auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcLayout);
@@ -309,35 +369,15 @@ private:
     unsigned sizeIntraWarps = helper.getIntraWarpSize();
     unsigned sizeInterWarps = helper.getInterWarpSize();
 
-    unsigned srcElems = getElemsPerThread(srcTy);
-    auto srcIndices = emitIndices(loc, rewriter, srcLayout, srcShape);
-    auto srcValues = getElementsFromStruct(loc, adaptor.operand(), rewriter);
-
-    SmallVector<SmallVector<unsigned>> offset =
-        emitOffsetForLayout(srcLayout, srcShape);
-
     std::map<SmallVector<unsigned>, Value> accs;
     std::map<SmallVector<unsigned>, Value> accIndices;
     std::map<SmallVector<unsigned>, SmallVector<Value>> indices;
 
     // reduce within threads
-    for (unsigned i = 0; i < srcElems; ++i) {
-      SmallVector<unsigned> key = offset[i];
-      key[axis] = 0;
-      bool isFirst = accs.find(key) == accs.end();
-      if (!withIndex) {
-        accumulate(rewriter, loc, op.redOp(), accs[key], srcValues[i], isFirst);
-      } else {
-        Value curIndex = srcIndices[i][axis];
-        accumulateWithIndex(rewriter, loc, op.redOp(), accs[key],
-                            accIndices[key], srcValues[i], curIndex, isFirst);
-      }
-      if (isFirst)
-        indices[key] = srcIndices[i];
-    }
+    reduceWithinThreads(op, adaptor, rewriter, accs, accIndices, indices);
 
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = i32_val(32);
+    Value warpSize = i32_val(product<unsigned>(threadsPerWarp));
     Value warpId = udiv(threadId, warpSize);
     Value laneId = urem(threadId, warpSize);
 
@@ -361,16 +401,7 @@ private:
         accIndex = accIndices[key];
 
       // Reduce within warps
-      for (unsigned N = sizeIntraWarps / 2; N > 0; N >>= 1) {
-        Value shfl = shflSync(loc, rewriter, acc, N);
-        if (!withIndex) {
-          accumulate(rewriter, loc, op.redOp(), acc, shfl, false);
-        } else {
-          Value shflIndex = shflSync(loc, rewriter, accIndex, N);
-          accumulateWithIndex(rewriter, loc, op.redOp(), acc, accIndex, shfl,
-                              shflIndex, false);
-        }
-      }
+      reduceWithinWarps(op, rewriter, loc, sizeIntraWarps, acc, accIndex);
 
       SmallVector<Value> writeIdx = indices[key];
       writeIdx[axis] = (sizeInterWarps == 1) ? zero : warpIdAxis;
@@ -393,7 +424,8 @@ private:
     // Each thread needs to process:
     //   elemsPerThread = sizeInterWarps * s1 * s2 .. Sn / numThreads
     unsigned numThreads =
-        product<unsigned>(triton::gpu::getWarpsPerCTA(srcLayout)) * 32;
+        product<unsigned>(triton::gpu::getWarpsPerCTA(srcLayout)) *
+        product<unsigned>(threadsPerWarp);
     unsigned elemsPerThread = std::max<unsigned>(elems / numThreads, 1);
     Value readOffset = threadId;
     for (unsigned round = 0; round < elemsPerThread; ++round) {
@@ -477,6 +509,433 @@ private:
 
     return success();
   }
+
+  // The reduced axis lives entirely within a warp: finish with butterfly
+  // shuffles, without going through shared memory or synchronizing warps.
+  // Rows that are held by other lanes of the same warp (threadsPerWarp along
+  // the axis < 32) are reduced by the same shuffles.
+  LogicalResult
+  matchAndRewriteWarpSync(triton::ReduceOp op, OpAdaptor adaptor,
+                          ConversionPatternRewriter &rewriter) const {
+    Location loc = op->getLoc();
+    unsigned axis = adaptor.axis();
+    bool withIndex = triton::ReduceOp::withIndex(op.redOp());
+
+    auto srcTy = op.operand().getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding();
+    auto llvmElemTy = getTypeConverter()->convertType(srcTy.getElementType());
+    auto llvmIndexTy = getTypeConverter()->getIndexType();
+
+    ReduceOpHelper helper(op);
+    unsigned sizeIntraWarps = helper.getIntraWarpSize();
+
+    std::map<SmallVector<unsigned>, Value> accs;
+    std::map<SmallVector<unsigned>, Value> accIndices;
+    std::map<SmallVector<unsigned>, SmallVector<Value>> indices;
+
+    // reduce within threads
+    reduceWithinThreads(op, adaptor, rewriter, accs, accIndices, indices);
+
+    // reduce within warps
+    for (auto &it : accs) {
+      const SmallVector<unsigned> &key = it.first;
+      Value accIndex = withIndex ? accIndices[key] : Value();
+      reduceWithinWarps(op, rewriter, loc, sizeIntraWarps, it.second,
+                        accIndex);
+      if (withIndex)
+        accIndices[key] = accIndex;
+    }
+
+    // set output values
+    if (auto resultTy = op.getType().dyn_cast<RankedTensorType>()) {
+      // nd-tensor where n >= 1
+      // The elements of the slice layout are the elements of the source
+      // layout with the reduced axis padded to 1.
+      auto resultShape = resultTy.getShape();
+      SmallVector<int64_t> paddedShape(resultShape.begin(), resultShape.end());
+      paddedShape.insert(paddedShape.begin() + axis, 1);
+      SmallVector<SmallVector<unsigned>> resultOffsets =
+          emitOffsetForLayout(srcLayout, paddedShape);
+      unsigned resultElems = getElemsPerThread(resultTy);
+      assert(resultOffsets.size() == resultElems);
+
+      SmallVector<Value> resultVals(resultElems);
+      for (unsigned i = 0; i < resultElems; ++i) {
+        SmallVector<unsigned> key = resultOffsets[i];
+        key[axis] = 0;
+        assert(accs.count(key) && "result element not held by the thread");
+        resultVals[i] = withIndex ? accIndices[key] : accs[key];
+      }
+
+      SmallVector<Type> resultTypes(resultElems,
+                                    withIndex ? llvmIndexTy : llvmElemTy);
+      Type structTy =
+          LLVM::LLVMStructType::getLiteral(this->getContext(), resultTypes);
+      Value ret = getStructFromElements(loc, resultVals, rewriter, structTy);
+      rewriter.replaceOp(op, ret);
+    } else {
+      // 0d-tensor -> scalar
+      assert(accs.size() == 1);
+      auto it = accs.begin();
+      Value resultVal = withIndex ? accIndices[it->first] : it->second;
+      rewriter.replaceOp(op, resultVal);
+    }
+
+    return success();
+  }
+};
+
+// Reduces all the operands of tt.generic_reduce in lockstep, along the same
+// paths as ReduceOpConversion: within threads, then with butterfly shuffles
+// within warps and, unless the axis lives in a single warp, across warps
+// through shared memory. Each operand has its own buffer in shared memory.
+struct GenericReduceOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::GenericReduceOp> {
+public:
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::GenericReduceOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::GenericReduceOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    ReduceOpHelper helper(op);
+    if (helper.isWarpSynchronous())
+      return matchAndRewriteWarpSync(op, adaptor, rewriter);
+    if (helper.isFastReduction())
+      return matchAndRewriteFast(op, adaptor, rewriter);
+    return matchAndRewriteBasic(op, adaptor, rewriter);
+  }
+
+private:
+  using Accs = std::map<SmallVector<unsigned>, SmallVector<Value>>;
+
+  // Emits the combine region on the accumulated values `acc` and the current
+  // elements `cur`, and stores the combined values into `acc`. The region
+  // only holds scalar operations, which are converted after this pattern.
+  void accumulate(ConversionPatternRewriter &rewriter,
+                  triton::GenericReduceOp op, SmallVector<Value> &acc,
+                  ArrayRef<Value> cur, bool isFirst) const {
+    if (isFirst) {
+      acc = SmallVector<Value>(cur.begin(), cur.end());
+      return;
+    }
+    Block &combineBlock = op.combineOp().front();
+    unsigned numOperands = acc.size();
+    BlockAndValueMapping mapping;
+    for (unsigned i = 0; i < numOperands; ++i) {
+      mapping.map(combineBlock.getArgument(i), acc[i]);
+      mapping.map(combineBlock.getArgument(numOperands + i), cur[i]);
+    }
+    for (Operation &combineOp : combineBlock.without_terminator())
+      rewriter.clone(combineOp, mapping);
+    auto ret =
+        cast<triton::GenericReduceReturnOp>(combineBlock.getTerminator());
+    for (unsigned i = 0; i < numOperands; ++i)
+      acc[i] = mapping.lookupOrDefault(ret.result()[i]);
+  }
+
+  // Returns the pointers to the buffers of the operands, holding `elems`
+  // elements each.
+  SmallVector<Value> getSmemBases(triton::GenericReduceOp op, unsigned elems,
+                                  ConversionPatternRewriter &rewriter) const {
+    Location loc = op->getLoc();
+    ReduceOpHelper helper(op);
+    auto offsets = helper.getScratchOffsetsInBytes(elems);
+    Value base = getSharedMemoryBase(loc, rewriter, op.getOperation());
+    SmallVector<Value> bases;
+    for (auto it : llvm::enumerate(op.operands())) {
+      auto elemTy =
+          it.value().getType().cast<RankedTensorType>().getElementType();
+      auto llvmElemTy = getTypeConverter()->convertType(elemTy);
+      Value ptr = gep(base.getType(), base, i32_val(offsets[it.index()]));
+      bases.push_back(bitcast(ptr, ptr_ty(llvmElemTy, 3)));
+    }
+    return bases;
+  }
+
+  // Reduce the values held by each thread along the reduced axis. Results are
+  // keyed by the offset of the first element, with the axis offset set to 0.
+  void reduceWithinThreads(
+      triton::GenericReduceOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter, Accs &accs,
+      std::map<SmallVector<unsigned>, SmallVector<Value>> &indices) const {
+    Location loc = op->getLoc();
+    unsigned axis = op.axis();
+    auto srcTy = op.operands()[0].getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding();
+    auto srcShape = srcTy.getShape();
+
+    unsigned srcElems = getElemsPerThread(srcTy);
+    auto srcIndices = emitIndices(loc, rewriter, srcLayout, srcShape);
+    SmallVector<SmallVector<Value>> srcValues;
+    for (Value operand : adaptor.operands())
+      srcValues.push_back(getElementsFromStruct(loc, operand, rewriter));
+
+    SmallVector<SmallVector<unsigned>> offset =
+        emitOffsetForLayout(srcLayout, srcShape);
+
+    for (unsigned i = 0; i < srcElems; ++i) {
+      SmallVector<unsigned> key = offset[i];
+      key[axis] = 0;
+      bool isFirst = accs.find(key) == accs.end();
+      SmallVector<Value> cur;
+      for (auto &values : srcValues)
+        cur.push_back(values[i]);
+      accumulate(rewriter, op, accs[key], cur, isFirst);
+      if (isFirst)
+        indices[key] = srcIndices[i];
+    }
+  }
+
+  void reduceWithinWarps(triton::GenericReduceOp op,
+                         ConversionPatternRewriter &rewriter, Location loc,
+                         unsigned sizeIntraWarps,
+                         SmallVector<Value> &acc) const {
+    for (unsigned N = sizeIntraWarps / 2; N > 0; N >>= 1) {
+      SmallVector<Value> shfl;
+      for (Value value : acc)
+        shfl.push_back(shflSync(loc, rewriter, value, N));
+      accumulate(rewriter, op, acc, shfl, false);
+    }
+  }
+
+  // Reads the results from the first element of the axis in shared memory.
+  void replaceWithSmemResults(triton::GenericReduceOp op,
+                              ArrayRef<Value> smemBases,
+                              ArrayRef<unsigned> smemShape,
+                              ArrayRef<unsigned> order,
+                              ConversionPatternRewriter &rewriter) const {
+    Location loc = op->getLoc();
+    unsigned axis = op.axis();
+    SmallVector<Value> results;
+    for (auto it : llvm::enumerate(op.getResults())) {
+      Value smemBase = smemBases[it.index()];
+      auto resultTy = it.value().getType().dyn_cast<RankedTensorType>();
+      if (!resultTy) {
+        // 0d-tensor -> scalar
+        results.push_back(load(smemBase));
+        continue;
+      }
+      // nd-tensor where n >= 1
+      auto resultIndices = emitIndices(loc, rewriter, resultTy.getEncoding(),
+                                       resultTy.getShape());
+      SmallVector<Value> resultVals;
+      for (SmallVector<Value> readIdx : resultIndices) {
+        readIdx.insert(readIdx.begin() + axis, i32_val(0));
+        Value readOffset = linearize(rewriter, loc, readIdx, smemShape, order);
+        Value readPtr = gep(smemBase.getType(), smemBase, readOffset);
+        resultVals.push_back(load(readPtr));
+      }
+      Type structTy = getTypeConverter()->convertType(resultTy);
+      results.push_back(
+          getStructFromElements(loc, resultVals, rewriter, structTy));
+    }
+    rewriter.replaceOp(op, results);
+  }
+
+  // Use shared memory for reduction within warps and across warps
+  LogicalResult
+  matchAndRewriteBasic(triton::GenericReduceOp op, OpAdaptor adaptor,
+                       ConversionPatternRewriter &rewriter) const {
+    Location loc = op->getLoc();
+    unsigned axis = op.axis();
+    auto srcTy = op.operands()[0].getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding().cast<BlockedEncodingAttr>();
+    auto srcOrd = srcLayout.getOrder();
+
+    ReduceOpHelper helper(op);
+    auto smemShape = helper.getScratchConfigBasic();
+    unsigned elems = product<unsigned>(smemShape);
+    auto smemBases = getSmemBases(op, elems, rewriter);
+
+    Accs accs;
+    std::map<SmallVector<unsigned>, SmallVector<Value>> indices;
+    reduceWithinThreads(op, adaptor, rewriter, accs, indices);
+
+    Value zero = i32_val(0);
+    Value sizePerThread = i32_val(srcLayout.getSizePerThread()[axis]);
+
+    // reduce across threads
+    for (auto &it : accs) {
+      SmallVector<Value> &acc = it.second;
+      SmallVector<Value> writeIdx = indices[it.first];
+      writeIdx[axis] = udiv(writeIdx[axis], sizePerThread);
+      Value writeOffset = linearize(rewriter, loc, writeIdx, smemShape, srcOrd);
+      SmallVector<Value> writePtrs;
+      for (unsigned i = 0; i < acc.size(); ++i) {
+        writePtrs.push_back(
+            gep(smemBases[i].getType(), smemBases[i], writeOffset));
+        store(acc[i], writePtrs[i]);
+      }
+
+      SmallVector<Value> readIdx(writeIdx.size(), zero);
+      for (int N = smemShape[axis] / 2; N > 0; N >>= 1) {
+        readIdx[axis] = i32_val(N);
+        Value readMask = icmp_slt(writeIdx[axis], i32_val(N));
+        Value readOffset = select(
+            readMask, linearize(rewriter, loc, readIdx, smemShape, srcOrd),
+            zero);
+        barrier();
+        SmallVector<Value> cur;
+        for (Value writePtr : writePtrs)
+          cur.push_back(load(gep(writePtr.getType(), writePtr, readOffset)));
+        accumulate(rewriter, op, acc, cur, false);
+        barrier();
+        for (unsigned i = 0; i < acc.size(); ++i)
+          store(acc[i], writePtrs[i]);
+      }
+    }
+
+    barrier();
+
+    replaceWithSmemResults(op, smemBases, smemShape, srcOrd, rewriter);
+    return success();
+  }
+
+  // Use warp shuffle for reduction within warps and shared memory for data
+  // exchange across warps
+  LogicalResult matchAndRewriteFast(triton::GenericReduceOp op,
+                                    OpAdaptor adaptor,
+                                    ConversionPatternRewriter &rewriter) const {
+    Location loc = op->getLoc();
+    unsigned axis = op.axis();
+    auto srcTy = op.operands()[0].getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding();
+    auto order = getOrder(srcLayout);
+    auto threadsPerWarp = triton::gpu::getThreadsPerWarp(srcLayout);
+    auto warpsPerCTA = triton::gpu::getWarpsPerCTA(srcLayout);
+
+    ReduceOpHelper helper(op);
+    auto smemShapes = helper.getScratchConfigsFast();
+    unsigned elems = product<unsigned>(smemShapes[0]);
+    unsigned maxElems = std::max(elems, product<unsigned>(smemShapes[1]));
+    auto smemBases = getSmemBases(op, maxElems, rewriter);
+
+    unsigned sizeIntraWarps = helper.getIntraWarpSize();
+    unsigned sizeInterWarps = helper.getInterWarpSize();
+
+    Accs accs;
+    std::map<SmallVector<unsigned>, SmallVector<Value>> indices;
+    reduceWithinThreads(op, adaptor, rewriter, accs, indices);
+
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpSize = i32_val(product<unsigned>(threadsPerWarp));
+    Value warpId = udiv(threadId, warpSize);
+    Value laneId = urem(threadId, warpSize);
+
+    Value laneIdAxis =
+        delinearize(rewriter, loc, laneId, threadsPerWarp, order)[axis];
+    Value warpIdAxis =
+        delinearize(rewriter, loc, warpId, warpsPerCTA, order)[axis];
+
+    Value zero = i32_val(0);
+    Value laneZero = icmp_eq(laneIdAxis, zero);
+
+    for (auto &it : accs) {
+      SmallVector<Value> &acc = it.second;
+      // reduce within warps
+      reduceWithinWarps(op, rewriter, loc, sizeIntraWarps, acc);
+
+      SmallVector<Value> writeIdx = indices[it.first];
+      writeIdx[axis] = (sizeInterWarps == 1) ? zero : warpIdAxis;
+      Value writeOffset =
+          linearize(rewriter, loc, writeIdx, smemShapes[0], order);
+      for (unsigned i = 0; i < acc.size(); ++i) {
+        Value writePtr = gep(smemBases[i].getType(), smemBases[i], writeOffset);
+        storeShared(rewriter, loc, writePtr, acc[i], laneZero);
+      }
+    }
+
+    barrier();
+
+    // The second round of shuffle reduction, over the sizeInterWarps partial
+    // results of each row (see ReduceOpConversion::matchAndRewriteFast)
+    unsigned numThreads =
+        product<unsigned>(warpsPerCTA) * product<unsigned>(threadsPerWarp);
+    unsigned elemsPerThread = std::max<unsigned>(elems / numThreads, 1);
+    Value readOffset = threadId;
+    for (unsigned round = 0; round < elemsPerThread; ++round) {
+      SmallVector<Value> ptrs;
+      SmallVector<Value> acc;
+      for (Value smemBase : smemBases) {
+        ptrs.push_back(gep(smemBase.getType(), smemBase, readOffset));
+        acc.push_back(load(ptrs.back()));
+      }
+
+      for (unsigned N = sizeInterWarps / 2; N > 0; N >>= 1) {
+        SmallVector<Value> shfl;
+        for (Value value : acc)
+          shfl.push_back(shflSync(loc, rewriter, value, N));
+        accumulate(rewriter, op, acc, shfl, false);
+      }
+
+      // only the first thread in each sizeInterWarps is writing
+      Value threadIsNeeded = icmp_slt(threadId, i32_val(elems));
+      Value laneIdModSizeInterWarpsIsZero =
+          icmp_eq(urem(laneId, i32_val(sizeInterWarps)), zero);
+      Value pred = and_(threadIsNeeded, laneIdModSizeInterWarpsIsZero);
+      for (unsigned i = 0; i < acc.size(); ++i)
+        storeShared(rewriter, loc, ptrs[i], acc[i], pred);
+
+      if (round != elemsPerThread - 1)
+        readOffset = add(readOffset, i32_val(numThreads));
+    }
+
+    barrier();
+
+    replaceWithSmemResults(op, smemBases, smemShapes[0], order, rewriter);
+    return success();
+  }
+
+  // The reduced axis lives entirely within a warp: finish with butterfly
+  // shuffles, without going through shared memory or synchronizing warps.
+  LogicalResult
+  matchAndRewriteWarpSync(triton::GenericReduceOp op, OpAdaptor adaptor,
+                          ConversionPatternRewriter &rewriter) const {
+    Location loc = op->getLoc();
+    unsigned axis = op.axis();
+    auto srcTy = op.operands()[0].getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding();
+
+    ReduceOpHelper helper(op);
+    unsigned sizeIntraWarps = helper.getIntraWarpSize();
+
+    Accs accs;
+    std::map<SmallVector<unsigned>, SmallVector<Value>> indices;
+    reduceWithinThreads(op, adaptor, rewriter, accs, indices);
+    for (auto &it : accs)
+      reduceWithinWarps(op, rewriter, loc, sizeIntraWarps, it.second);
+
+    SmallVector<Value> results;
+    for (auto it : llvm::enumerate(op.getResults())) {
+      unsigned i = it.index();
+      auto resultTy = it.value().getType().dyn_cast<RankedTensorType>();
+      if (!resultTy) {
+        // 0d-tensor -> scalar
+        assert(accs.size() == 1);
+        results.push_back(accs.begin()->second[i]);
+        continue;
+      }
+      // nd-tensor where n >= 1
+      // The elements of the slice layout are the elements of the source
+      // layout with the reduced axis padded to 1.
+      auto resultShape = resultTy.getShape();
+      SmallVector<int64_t> paddedShape(resultShape.begin(), resultShape.end());
+      paddedShape.insert(paddedShape.begin() + axis, 1);
+      SmallVector<Value> resultVals;
+      for (SmallVector<unsigned> key :
+           emitOffsetForLayout(srcLayout, paddedShape)) {
+        key[axis] = 0;
+        assert(accs.count(key) && "result element not held by the thread");
+        resultVals.push_back(accs[key][i]);
+      }
+      Type structTy = getTypeConverter()->convertType(resultTy);
+      results.push_back(
+          getStructFromElements(loc, resultVals, rewriter, structTy));
+    }
+    rewriter.replaceOp(op, results);
+    return success();
+  }
 };
 
 void populateReduceOpToLLVMPatterns(
@@ -487,4 +946,6 @@ void populateReduceOpToLLVMPatterns(
     PatternBenefit benefit) {
   patterns.add<ReduceOpConversion>(typeConverter, allocation, smem,
                                    indexCacheInfo, benefit);
+  patterns.add<GenericReduceOpConversion>(typeConverter, allocation, smem,
+                                          indexCacheInfo, benefit);
 }
@@ -0,0 +1,213 @@
+#include "ScanOpToLLVM.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::getElementsFromStruct;
+using ::mlir::LLVM::getStructFromElements;
+using ::mlir::LLVM::shflUpSync;
+using ::mlir::LLVM::storeShared;
+using ::mlir::triton::gpu::getOrder;
+using ::mlir::triton::gpu::getThreadsPerWarp;
+using ::mlir::triton::gpu::getWarpsPerCTA;
+
+// Elements along the axis are laid out as blocks of warps of lanes of
+// contiguous elements. The scan combines, in that order,
+//  1. the elements of each thread, sequentially;
+//  2. the lanes of each warp, with Kogge-Stone shuffles on the last element
+//     of each thread;
+//  3. the warps and blocks, with the last lane of each warp publishing its
+//     total in shared memory. This step is skipped when the axis fits in a
+//     single warp and block.
+// The combine region is applied with the accumulated value on the left, so
+// it only needs to be associative.
+struct ScanOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::ScanOp> {
+public:
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::ScanOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    ScanLoweringHelper helper(op);
+    if (!helper.isSupported())
+      return failure();
+
+    Location loc = op->getLoc();
+    unsigned axis = op.axis();
+    auto srcTy = op.operand().getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding();
+    auto srcShape = srcTy.getShape();
+    auto order = getOrder(srcLayout);
+    auto threadsPerWarp = getThreadsPerWarp(srcLayout);
+    auto warpsPerCTA = getWarpsPerCTA(srcLayout);
+
+    unsigned sizePerThread = helper.getAxisSizePerThread();
+    unsigned numLanes = helper.getAxisNumThreadsPerWarp();
+    unsigned numWarps = helper.getAxisNumWarps();
+    unsigned numBlocks = helper.getAxisNumBlocks();
+
+    auto srcValues = getElementsFromStruct(loc, adaptor.operand(), rewriter);
+    auto srcIndices = emitIndices(loc, rewriter, srcLayout, srcShape);
+    SmallVector<SmallVector<unsigned>> offset =
+        emitOffsetForLayout(srcLayout, srcShape);
+
+    // Elements of each row held by the thread, in the order of the axis.
+    // Rows are keyed by the offset of their elements with the axis set to 0.
+    std::map<SmallVector<unsigned>, SmallVector<unsigned>> rows;
+    for (unsigned i = 0; i < offset.size(); ++i) {
+      SmallVector<unsigned> key = offset[i];
+      key[axis] = 0;
+      rows[key].push_back(i);
+    }
+    for (auto &it : rows)
+      llvm::stable_sort(it.second, [&](unsigned lhs, unsigned rhs) {
+        return offset[lhs][axis] < offset[rhs][axis];
+      });
+
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpSize = i32_val(product<unsigned>(threadsPerWarp));
+    Value warpId = udiv(threadId, warpSize);
+    Value laneId = urem(threadId, warpSize);
+    // lanes and warps beyond the end of the axis hold copies of the first ones
+    Value laneIdAxis =
+        urem(delinearize(rewriter, loc, laneId, threadsPerWarp, order)[axis],
+             i32_val(numLanes));
+    Value warpIdAxis =
+        urem(delinearize(rewriter, loc, warpId, warpsPerCTA, order)[axis],
+             i32_val(numWarps));
+    // distance between the ids of consecutive lanes along the axis
+    unsigned laneStride = 1;
+    for (unsigned d : order) {
+      if (d == axis)
+        break;
+      laneStride *= threadsPerWarp[d];
+    }
+
+    // scan within threads and warps
+    std::map<SmallVector<unsigned>, SmallVector<Value>> warpTotals;
+    for (auto &it : rows) {
+      const SmallVector<unsigned> &elems = it.second;
+      assert(elems.size() == sizePerThread * numBlocks);
+      for (unsigned b = 0; b < numBlocks; ++b) {
+        unsigned begin = b * sizePerThread;
+        for (unsigned j = 1; j < sizePerThread; ++j) {
+          Value &cur = srcValues[elems[begin + j]];
+          cur = combine(rewriter, op, srcValues[elems[begin + j - 1]], cur);
+        }
+        Value acc = srcValues[elems[begin + sizePerThread - 1]];
+        for (unsigned k = 1; k < numLanes; k <<= 1) {
+          Value shfl = shflUpSync(loc, rewriter, acc, k * laneStride);
+          acc = select(icmp_uge(laneIdAxis, i32_val(k)),
+                       combine(rewriter, op, shfl, acc), acc);
+        }
+        // the last lane now holds the total of the warp
+        warpTotals[it.first].push_back(acc);
+        if (numLanes == 1)
+          continue;
+        // combine with the total of the previous lanes
+        Value prefix = shflUpSync(loc, rewriter, acc, laneStride);
+        Value hasPrefix = icmp_ne(laneIdAxis, i32_val(0));
+        for (unsigned j = 0; j < sizePerThread; ++j) {
+          Value &cur = srcValues[elems[begin + j]];
+          cur = select(hasPrefix, combine(rewriter, op, prefix, cur), cur);
+        }
+      }
+    }
+
+    // scan across warps and blocks
+    if (numWarps * numBlocks > 1) {
+      auto llvmElemTy =
+          getTypeConverter()->convertType(srcTy.getElementType());
+      auto elemPtrTy = LLVM::LLVMPointerType::get(llvmElemTy, 3);
+      Value smemBase = getSharedMemoryBase(loc, rewriter, op.getOperation());
+      smemBase = bitcast(smemBase, elemPtrTy);
+      auto smemShape = helper.getScratchConfig();
+      auto getTotalPtr = [&](const SmallVector<unsigned> &key, Value idxAxis) {
+        SmallVector<Value> idx = srcIndices[rows[key].front()];
+        idx[axis] = idxAxis;
+        Value smemOffset = linearize(rewriter, loc, idx, smemShape, order);
+        return gep(elemPtrTy, smemBase, smemOffset);
+      };
+
+      Value isLastLane = icmp_eq(laneIdAxis, i32_val(numLanes - 1));
+      for (auto &it : warpTotals)
+        for (unsigned b = 0; b < numBlocks; ++b) {
+          Value idxAxis = add(i32_val(b * numWarps), warpIdAxis);
+          storeShared(rewriter, loc, getTotalPtr(it.first, idxAxis),
+                      it.second[b], isLastLane);
+        }
+      barrier();
+
+      for (auto &it : rows) {
+        const SmallVector<unsigned> &elems = it.second;
+        // total of the previous blocks, the same for all threads
+        Value blockCarry;
+        for (unsigned b = 0; b < numBlocks; ++b) {
+          // carry of the previous warps of the block; only valid, if there is
+          // no block carry, in the threads of the warps but the first one
+          Value carry = blockCarry;
+          Value carryValid;
+          for (unsigned w = 0; w < numWarps; ++w) {
+            Value total =
+                load(getTotalPtr(it.first, i32_val(b * numWarps + w)));
+            if (w + 1 < numWarps) {
+              Value isPrev = icmp_ult(i32_val(w), warpIdAxis);
+              if (!carry) {
+                carry = total;
+                carryValid = isPrev;
+              } else {
+                carry = select(isPrev, combine(rewriter, op, carry, total),
+                               carry);
+              }
+            }
+            if (b + 1 < numBlocks)
+              blockCarry =
+                  blockCarry ? combine(rewriter, op, blockCarry, total) : total;
+          }
+          if (!carry)
+            continue;
+          unsigned begin = b * sizePerThread;
+          for (unsigned j = 0; j < sizePerThread; ++j) {
+            Value &cur = srcValues[elems[begin + j]];
+            Value combined = combine(rewriter, op, carry, cur);
+            cur = carryValid ? Value(select(carryValid, combined, cur))
+                             : combined;
+          }
+        }
+      }
+    }
+
+    Type structTy = getTypeConverter()->convertType(srcTy);
+    Value ret = getStructFromElements(loc, srcValues, rewriter, structTy);
+    rewriter.replaceOp(op, ret);
+    return success();
+  }
+
+private:
+  // Emits the combine region of `op` on `acc` and `cur`. The region only
+  // holds scalar operations, which are converted after this pattern.
+  Value combine(ConversionPatternRewriter &rewriter, triton::ScanOp op,
+                Value acc, Value cur) const {
+    Block &combineBlock = op.combineOp().front();
+    BlockAndValueMapping mapping;
+    mapping.map(combineBlock.getArgument(0), acc);
+    mapping.map(combineBlock.getArgument(1), cur);
+    for (Operation &combineOp : combineBlock.without_terminator())
+      rewriter.clone(combineOp, mapping);
+    auto ret = cast<triton::ScanReturnOp>(combineBlock.getTerminator());
+    return mapping.lookupOrDefault(ret.result());
+  }
+};
+
+void populateScanOpToLLVMPatterns(
+    mlir::LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
+    const Allocation *allocation, Value smem,
+    ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+    PatternBenefit benefit) {
+  patterns.add<ScanOpConversion>(typeConverter, allocation, smem,
+                                 indexCacheInfo, benefit);
+}
@@ -0,0 +1,183 @@
+#include "SortOpToLLVM.h"
+
+using namespace mlir;
+using namespace mlir::triton;
+
+using ::mlir::LLVM::getElementsFromStruct;
+using ::mlir::LLVM::getStructFromElements;
+using ::mlir::LLVM::shflSync;
+using ::mlir::triton::gpu::getOrder;
+using ::mlir::triton::gpu::getThreadsPerWarp;
+
+// Bitonic sorting network over the elements of the axis. Each
+// compare-exchange stage pairs the elements whose positions along the axis
+// differ by a single bit, and is done according to where that bit comes
+// from in the layout:
+//  - the register (the contiguous elements of the thread, or the repetitions
+//    of the layout): both elements are held by the thread;
+//  - the lane id: the elements are exchanged with butterfly shuffles;
+//  - the warp id: the elements are exchanged through shared memory.
+// When the result is shorter than the operand, the sorted operand is stored
+// to shared memory and its first elements are read back in the layout of the
+// result.
+struct SortOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::SortOp> {
+public:
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::SortOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SortOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    SortLoweringHelper helper(op);
+    if (!helper.isSupported())
+      return failure();
+
+    Location loc = op->getLoc();
+    unsigned axis = op.axis();
+    bool descending = op.descending();
+    auto srcTy = op.operand().getType().cast<RankedTensorType>();
+    auto dstTy = op.result().getType().cast<RankedTensorType>();
+    auto srcLayout = srcTy.getEncoding();
+    auto srcShape = srcTy.getShape();
+    auto order = getOrder(srcLayout);
+    auto threadsPerWarp = getThreadsPerWarp(srcLayout);
+    bool isFloat = srcTy.getElementType().isa<FloatType>();
+
+    unsigned axisSize = srcShape[axis];
+    unsigned sizePerThread = helper.getAxisSizePerThread();
+    // positions from sizePerThread to laneBits are told apart by the lane id,
+    // from laneBits to warpBits by the warp id
+    unsigned laneBits = sizePerThread * helper.getAxisNumThreadsPerWarp();
+    unsigned warpBits = laneBits * helper.getAxisNumWarps();
+
+    auto values = getElementsFromStruct(loc, adaptor.operand(), rewriter);
+    auto srcIndices = emitIndices(loc, rewriter, srcLayout, srcShape);
+    SmallVector<SmallVector<unsigned>> offset =
+        emitOffsetForLayout(srcLayout, srcShape);
+    std::map<SmallVector<unsigned>, unsigned> regAt;
+    for (unsigned i = 0; i < offset.size(); ++i)
+      regAt[offset[i]] = i;
+
+    // distance between the ids of consecutive lanes along the axis
+    unsigned laneStride = 1;
+    for (unsigned d : order) {
+      if (d == axis)
+        break;
+      laneStride *= threadsPerWarp[d];
+    }
+
+    auto isRegisterBit = [&](unsigned bit) {
+      return bit < sizePerThread || bit >= warpBits;
+    };
+    // whether `bit` is set in the position of element `i` along the axis
+    auto testBit = [&](unsigned i, unsigned bit) -> Value {
+      if (isRegisterBit(bit))
+        return int_val(1, (offset[i][axis] & bit) != 0);
+      return icmp_ne(and_(srcIndices[i][axis], i32_val(bit)), i32_val(0));
+    };
+    auto orderPair = [&](Value a, Value b) -> std::pair<Value, Value> {
+      Value lt = isFloat ? Value(fcmp_olt(a, b)) : Value(icmp_slt(a, b));
+      return {select(lt, a, b), select(lt, b, a)};
+    };
+
+    Value smemBase;
+    auto smemShape = convertType<unsigned>(srcShape);
+    if (helper.getScratchSizeInBytes() > 0) {
+      auto llvmElemTy =
+          getTypeConverter()->convertType(srcTy.getElementType());
+      auto elemPtrTy = LLVM::LLVMPointerType::get(llvmElemTy, 3);
+      smemBase = getSharedMemoryBase(loc, rewriter, op.getOperation());
+      smemBase = bitcast(smemBase, elemPtrTy);
+    }
+    auto getPtr = [&](ArrayRef<Value> idx) -> Value {
+      Value smemOffset = linearize(rewriter, loc, idx, smemShape, order);
+      return gep(smemBase.getType(), smemBase, smemOffset);
+    };
+    // set once shared memory is read, before it can be written again
+    bool pendingBarrier = false;
+
+    for (unsigned k = 2; k <= axisSize; k <<= 1) {
+      for (unsigned j = k >> 1; j > 0; j >>= 1) {
+        if (isRegisterBit(j)) {
+          for (unsigned i = 0; i < values.size(); ++i) {
+            if (offset[i][axis] & j)
+              continue;
+            SmallVector<unsigned> partnerOffset = offset[i];
+            partnerOffset[axis] |= j;
+            unsigned p = regAt.lookup(partnerOffset);
+            auto [mn, mx] = orderPair(values[i], values[p]);
+            // the lower element gets the minimum in ascending subsequences
+            if (isRegisterBit(k)) {
+              bool minFirst = ((offset[i][axis] & k) != 0) == descending;
+              values[i] = minFirst ? mn : mx;
+              values[p] = minFirst ? mx : mn;
+            } else {
+              Value minFirst = xor_(testBit(i, k), int_val(1, !descending));
+              values[i] = select(minFirst, mn, mx);
+              values[p] = select(minFirst, mx, mn);
+            }
+          }
+          continue;
+        }
+
+        SmallVector<Value> partners(values.size());
+        if (j < laneBits) {
+          for (unsigned i = 0; i < values.size(); ++i)
+            partners[i] = shflSync(loc, rewriter, values[i],
+                                   j / sizePerThread * laneStride);
+        } else {
+          if (pendingBarrier)
+            barrier();
+          for (unsigned i = 0; i < values.size(); ++i)
+            store(values[i], getPtr(srcIndices[i]));
+          barrier();
+          for (unsigned i = 0; i < values.size(); ++i) {
+            SmallVector<Value> idx = srcIndices[i];
+            idx[axis] = xor_(idx[axis], i32_val(j));
+            partners[i] = load(getPtr(idx));
+          }
+          pendingBarrier = true;
+        }
+        for (unsigned i = 0; i < values.size(); ++i) {
+          auto [mn, mx] = orderPair(values[i], partners[i]);
+          Value keepMin = xor_(xor_(testBit(i, j), testBit(i, k)),
+                               int_val(1, !descending));
+          values[i] = select(keepMin, mn, mx);
+        }
+      }
+    }
+
+    if (helper.isTopK()) {
+      auto dstShape = dstTy.getShape();
+      if (pendingBarrier)
+        barrier();
+      for (unsigned i = 0; i < values.size(); ++i) {
+        // the elements of the repetitions past the result are dropped
+        if (offset[i][axis] < dstShape[axis])
+          store(values[i], getPtr(srcIndices[i]));
+      }
+      barrier();
+      auto dstIndices =
+          emitIndices(loc, rewriter, dstTy.getEncoding(), dstShape);
+      values.clear();
+      for (const auto &idx : dstIndices)
+        values.push_back(load(getPtr(idx)));
+    }
+
+    Type structTy = getTypeConverter()->convertType(dstTy);
+    Value ret = getStructFromElements(loc, values, rewriter, structTy);
+    rewriter.replaceOp(op, ret);
+    return success();
+  }
+};
+
+void populateSortOpToLLVMPatterns(
+    mlir::LLVMTypeConverter &typeConverter, RewritePatternSet &patterns,
+    int numWarps, AxisInfoAnalysis &axisInfoAnalysis,
+    const Allocation *allocation, Value smem,
+    ConvertTritonGPUOpToLLVMPatternBase::IndexCacheInfo &indexCacheInfo,
+    PatternBenefit benefit) {
+  patterns.add<SortOpConversion>(typeConverter, allocation, smem,
+                                 indexCacheInfo, benefit);
+}
@@ -6,6 +6,7 @@ using namespace mlir;
 using namespace mlir::triton;
 
 using ::mlir::LLVM::getElementsFromStruct;
+using ::mlir::LLVM::getMBarrierPtr;
 using ::mlir::LLVM::getSharedMemoryObjectFromStruct;
 using ::mlir::LLVM::getStructFromElements;
 using ::mlir::triton::gpu::getElemsPerThread;
@@ -353,17 +354,100 @@ struct GetProgramIdOpConversion
     Location loc = op->getLoc();
     assert(op.axis() < 3);
 
-    Value blockId = rewriter.create<::mlir::gpu::BlockIdOp>(
-        loc, rewriter.getIndexType(), dims[op.axis()]);
-    auto llvmIndexTy = getTypeConverter()->getIndexType();
-    rewriter.replaceOpWithNewOp<UnrealizedConversionCastOp>(
-        op, TypeRange{llvmIndexTy}, ValueRange{blockId});
+    auto mod = op->getParentOfType<ModuleOp>();
+    StringRef remap = triton::gpu::TritonGPUDialect::getPidRemap(mod);
+    if (remap.empty() || op.axis() == 2) {
+      rewriter.replaceOp(
+          op, getGridValue<::mlir::gpu::BlockIdOp>(rewriter, loc, op.axis()));
+      return success();
+    }
+
+    // The programs of the x-y plane are numbered in the order in which they
+    // are launched, x first, and that number is mapped back to a position in
+    // the plane by the rasterization of the module.
+    Value gridX = getGridValue<::mlir::gpu::GridDimOp>(rewriter, loc, 0);
+    Value gridY = getGridValue<::mlir::gpu::GridDimOp>(rewriter, loc, 1);
+    Value linear =
+        add(getGridValue<::mlir::gpu::BlockIdOp>(rewriter, loc, 0),
+            mul(getGridValue<::mlir::gpu::BlockIdOp>(rewriter, loc, 1), gridX));
+    std::pair<Value, Value> pid;
+    StringRef group = remap;
+    unsigned groupSize;
+    if (group.consume_front("grouped-") && !group.getAsInteger(10, groupSize) &&
+        groupSize > 0)
+      pid = groupedPid(rewriter, loc, linear, gridX, gridY, groupSize);
+    else if (remap == "morton")
+      pid = mortonPid(rewriter, loc, linear, gridX, gridY);
+    else
+      return op.emitError("unknown program id remap ") << remap;
+    rewriter.replaceOp(op, op.axis() == 0 ? pid.first : pid.second);
     return success();
   }
 
   static constexpr mlir::gpu::Dimension dims[] = {mlir::gpu::Dimension::x,
                                                   mlir::gpu::Dimension::y,
                                                   mlir::gpu::Dimension::z};
+
+private:
+  template <typename OpTy>
+  Value getGridValue(ConversionPatternRewriter &rewriter, Location loc,
+                     unsigned axis) const {
+    Value value =
+        rewriter.create<OpTy>(loc, rewriter.getIndexType(), dims[axis]);
+    auto llvmIndexTy = getTypeConverter()->getIndexType();
+    return rewriter
+        .create<UnrealizedConversionCastOp>(loc, TypeRange{llvmIndexTy},
+                                            ValueRange{value})
+        .getResult(0);
+  }
+
+  // Groups of `groupSize` consecutive x go through all the y before the next
+  // group starts, as in the L2-friendly ordering of the matmul tutorial.
+  std::pair<Value, Value> groupedPid(ConversionPatternRewriter &rewriter,
+                                     Location loc, Value linear, Value gridX,
+                                     Value gridY, unsigned groupSize) const {
+    Value group = i32_val(groupSize);
+    Value width = mul(group, gridY);
+    Value firstX = mul(udiv(linear, width), group);
+    Value size = umin(sub(gridX, firstX), group);
+    Value inGroup = urem(linear, width);
+    return {add(firstX, urem(inGroup, size)), udiv(inGroup, size)};
+  }
+
+  // Z-order curve, interleaving the bits of x and y from the least
+  // significant one, until the bits of the smaller extent run out. Only a
+  // bijection when both extents are powers of two, other grids keep the
+  // order of the launch.
+  std::pair<Value, Value> mortonPid(ConversionPatternRewriter &rewriter,
+                                    Location loc, Value linear, Value gridX,
+                                    Value gridY) const {
+    Value one = i32_val(1);
+    Value x = i32_val(0);
+    Value y = i32_val(0);
+    Value bit = i32_val(0);
+    // gridDim.y is smaller than 2^16, the bits of x left after 16 levels are
+    // the most significant bits of the linear id
+    const unsigned levels = 16;
+    for (unsigned k = 0; k < levels; ++k) {
+      Value hasX = icmp_ugt(gridX, i32_val(1u << k));
+      Value hasY = icmp_ugt(gridY, i32_val(1u << k));
+      Value bitX = and_(lshr(linear, bit), one);
+      x = or_(x, select(hasX, shl(bitX, i32_val(k)), i32_val(0)));
+      bit = add(bit, zext(i32_ty, hasX));
+      Value bitY = and_(lshr(linear, bit), one);
+      y = or_(y, select(hasY, shl(bitY, i32_val(k)), i32_val(0)));
+      bit = add(bit, zext(i32_ty, hasY));
+    }
+    Value highX = shl(lshr(linear, bit), i32_val(levels));
+    x = or_(x, select(icmp_ugt(gridX, i32_val(1u << levels)), highX,
+                      i32_val(0)));
+    Value isPow2 = and_(
+        icmp_eq(and_(gridX, sub(gridX, one)), i32_val(0)),
+        icmp_eq(and_(gridY, sub(gridY, one)), i32_val(0)));
+    Value launchX = getGridValue<::mlir::gpu::BlockIdOp>(rewriter, loc, 0);
+    Value launchY = getGridValue<::mlir::gpu::BlockIdOp>(rewriter, loc, 1);
+    return {select(isPow2, x, launchX), select(isPow2, y, launchY)};
+  }
 };
 
 struct GetNumProgramsOpConversion
@@ -537,6 +621,81 @@ struct AsyncWaitOpConversion
   }
 };
 
+struct InitMBarrierOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::InitMBarrierOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::InitMBarrierOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::InitMBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    // The mbarriers may still be waited on by a previous loop. In a cluster,
+    // the multicast copies of the other CTAs also arrive on them.
+    auto mod = op->getParentOfType<ModuleOp>();
+    bool inCluster = triton::gpu::TritonGPUDialect::getNumCTAs(mod) > 1;
+    if (inCluster)
+      clusterBarrier(loc, rewriter);
+    else
+      barrier();
+    Value isThread0 = icmp_eq(getThreadId(rewriter, loc), i32_val(0));
+    PTXBuilder ptxBuilder;
+    for (unsigned i = 0; i < op.num(); ++i) {
+      Value mbarrier =
+          getMBarrierPtr(loc, rewriter, op, op.id(), i32_val(i));
+      auto &init = *ptxBuilder.create<>("mbarrier.init.shared.b64");
+      init(ptxBuilder.newAddrOperand(mbarrier, "r"),
+           ptxBuilder.newConstantOperand(1))
+          .predicate(isThread0, "b");
+    }
+    // Make the initialization visible to the bulk copies
+    auto &fence = *ptxBuilder.create<>("fence.proxy.async.shared::cta");
+    fence();
+    if (inCluster) {
+      auto &clusterFence =
+          *ptxBuilder.create<>("fence.mbarrier_init.release.cluster");
+      clusterFence();
+    }
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+    if (inCluster)
+      clusterBarrier(loc, rewriter);
+    else
+      barrier();
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+struct WaitMBarrierOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::WaitMBarrierOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::gpu::WaitMBarrierOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::gpu::WaitMBarrierOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = op.getLoc();
+    Value mbarrier =
+        getMBarrierPtr(loc, rewriter, op, op.id(), adaptor.index());
+    PTXBuilder ptxBuilder;
+    auto *ptxAsm = "{\n"
+                   ".reg .pred complete;\n"
+                   "waitLoop:\n"
+                   "mbarrier.try_wait.parity.shared.b64 complete, [$0], $1;\n"
+                   "@!complete bra.uni waitLoop;\n"
+                   "}";
+    auto &wait = *ptxBuilder.create(ptxAsm);
+    wait({ptxBuilder.newOperand(mbarrier, "r"),
+          ptxBuilder.newOperand(adaptor.phase(), "r")},
+         /*onlyAttachMLIRArgs=*/true);
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
 struct AsyncCommitGroupOpConversion
     : public ConvertTritonGPUOpToLLVMPattern<triton::gpu::AsyncCommitGroupOp> {
   using ConvertTritonGPUOpToLLVMPattern<
@@ -555,6 +714,109 @@ struct AsyncCommitGroupOpConversion
   }
 };
 
+struct ProfileMarkOpConversion
+    : public ConvertTritonGPUOpToLLVMPattern<triton::ProfileMarkOp> {
+  using ConvertTritonGPUOpToLLVMPattern<
+      triton::ProfileMarkOp>::ConvertTritonGPUOpToLLVMPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ProfileMarkOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    // The kernels compiled without profiling have no buffer
+    if (!op.buffer() || !op.id()) {
+      rewriter.eraseOp(op);
+      return success();
+    }
+    Location loc = op->getLoc();
+    auto mod = op->getParentOfType<ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
+    int capacity = triton::gpu::TritonGPUDialect::getProfileCapacity(mod);
+
+    // Every thread counts the marks it reached, the first lane of each warp
+    // writes the first `capacity` of them
+    Value counter = getCounter(op, rewriter);
+    Value slot = load(counter);
+    store(add(slot, i32_val(1)), counter);
+    Value threadId = getThreadId(rewriter, loc);
+    Value warpId = udiv(threadId, i32_val(threadsPerWarp));
+    Value laneId = urem(threadId, i32_val(threadsPerWarp));
+    Value pred =
+        and_(icmp_eq(laneId, i32_val(0)), icmp_ult(slot, i32_val(capacity)));
+
+    // The records of a warp follow those of the previous warps of the
+    // program, in the order in which the programs are launched
+    Value gridX = getGridValue<::mlir::gpu::GridDimOp>(rewriter, loc, 0);
+    Value gridY = getGridValue<::mlir::gpu::GridDimOp>(rewriter, loc, 1);
+    Value program = add(
+        getGridValue<::mlir::gpu::BlockIdOp>(rewriter, loc, 0),
+        mul(gridX, add(getGridValue<::mlir::gpu::BlockIdOp>(rewriter, loc, 1),
+                       mul(gridY, getGridValue<::mlir::gpu::BlockIdOp>(
+                                      rewriter, loc, 2)))));
+    Value warp = add(mul(zext(i64_ty, program), int_val(64, numWarps)),
+                     zext(i64_ty, warpId));
+    Value record =
+        add(mul(warp, int_val(64, capacity)), zext(i64_ty, slot));
+    Value ptr = gep(ptr_ty(i64_ty, 1), adaptor.buffer(),
+                    mul(record, int_val(64, 2)));
+
+    Value tag = i32_val((*op.id() << 1 | op.isEnd()) + 1);
+    PTXBuilder ptxBuilder;
+    auto *ptxAsm = "{\n"
+                   ".reg .b32 sm;\n"
+                   ".reg .b64 tag, clock;\n"
+                   "mov.u32 sm, %smid;\n"
+                   "mov.b64 tag, {$1, sm};\n"
+                   "mov.u64 clock, %clock64;\n"
+                   "@$2 st.global.v2.b64 [$0], {tag, clock};\n"
+                   "}";
+    auto &mark = *ptxBuilder.create(ptxAsm);
+    mark({ptxBuilder.newOperand(ptr, "l"), ptxBuilder.newOperand(tag, "r"),
+          ptxBuilder.newOperand(pred, "b")},
+         /*onlyAttachMLIRArgs=*/true);
+    ptxBuilder.launch(rewriter, loc, void_ty(getContext()));
+
+    rewriter.eraseOp(op);
+    return success();
+  }
+
+private:
+  // Returns the number of marks reached by the thread, kept in a variable of
+  // the function that LLVM promotes to a register
+  Value getCounter(Operation *op, ConversionPatternRewriter &rewriter) const {
+    auto funcOp = op->getParentOfType<LLVM::LLVMFuncOp>();
+    auto it = counters.find(funcOp);
+    if (it != counters.end())
+      return it->second;
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(&funcOp.getBody().front());
+    Location loc = funcOp.getLoc();
+    Value counter = rewriter.create<LLVM::AllocaOp>(loc, ptr_ty(i32_ty),
+                                                    i32_val(1),
+                                                    /*alignment=*/4);
+    store(i32_val(0), counter);
+    counters[funcOp] = counter;
+    return counter;
+  }
+
+  template <typename OpTy>
+  Value getGridValue(ConversionPatternRewriter &rewriter, Location loc,
+                     unsigned axis) const {
+    static constexpr mlir::gpu::Dimension dims[] = {mlir::gpu::Dimension::x,
+                                                    mlir::gpu::Dimension::y,
+                                                    mlir::gpu::Dimension::z};
+    Value value =
+        rewriter.create<OpTy>(loc, rewriter.getIndexType(), dims[axis]);
+    auto llvmIndexTy = getTypeConverter()->getIndexType();
+    return rewriter
+        .create<UnrealizedConversionCastOp>(loc, TypeRange{llvmIndexTy},
+                                            ValueRange{value})
+        .getResult(0);
+  }
+
+  mutable DenseMap<Operation *, Value> counters;
+};
+
 namespace mlir {
 namespace LLVM {
 
@@ -595,7 +857,10 @@ void populateTritonGPUToLLVMPatterns(
                                          benefit);
   patterns.add<GetProgramIdOpConversion>(typeConverter, benefit);
   patterns.add<GetNumProgramsOpConversion>(typeConverter, benefit);
+  patterns.add<InitMBarrierOpConversion>(typeConverter, benefit);
+  patterns.add<WaitMBarrierOpConversion>(typeConverter, benefit);
   patterns.add<MakeRangeOpConversion>(typeConverter, indexCacheInfo, benefit);
   patterns.add<ReturnOpConversion>(typeConverter, benefit);
   patterns.add<PrintfOpConversion>(typeConverter, benefit);
+  patterns.add<ProfileMarkOpConversion>(typeConverter, benefit);
 }
@@ -7,6 +7,7 @@
 #include "triton/Analysis/Allocation.h"
 
 //
+#include "DotOpHelpers.h"
 #include "Utility.h"
 #include "mlir/IR/TypeUtilities.h"
 #include "triton/Analysis/AxisInfo.h"
@@ -169,7 +170,8 @@ struct CacheKeyDenseMapInfo {
 class ConvertTritonGPUOpToLLVMPatternBase {
 public:
   // Two levels of value cache in emitting indices calculation:
-  // Key: pair<layout, shape>
+  // Key: pair<layout, shape>, the values live in the entry block of the
+  // function being converted.
   struct IndexCacheInfo {
     DenseMap<IndexCacheKeyT, SmallVector<Value>, CacheKeyDenseMapInfo>
         *baseIndexCache;
@@ -506,6 +508,7 @@ public:
     auto cache = indexCacheInfo.baseIndexCache;
     assert(cache && "baseIndexCache is nullptr");
     auto insertPt = indexCacheInfo.indexInsertPoint;
+    resetIndexCacheOnNewFunc(rewriter);
     if (cache->count(key) > 0) {
       return cache->lookup(key);
     } else {
@@ -518,7 +521,7 @@ public:
       } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
         if (mmaLayout.isVolta())
           result = emitBaseIndexForMmaLayoutV1(loc, rewriter, mmaLayout, shape);
-        if (mmaLayout.isAmpere())
+        if (mmaLayout.isAmpere() || mmaLayout.isHopper())
           result = emitBaseIndexForMmaLayoutV2(loc, rewriter, mmaLayout, shape);
       } else {
         llvm_unreachable("unsupported emitBaseIndexForLayout");
@@ -536,7 +539,7 @@ public:
     if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
       if (mmaLayout.isVolta())
         return emitOffsetForMmaLayoutV1(mmaLayout, shape);
-      if (mmaLayout.isAmpere())
+      if (mmaLayout.isAmpere() || mmaLayout.isHopper())
         return emitOffsetForMmaLayoutV2(mmaLayout, shape);
     }
     llvm_unreachable("unsupported emitOffsetForLayout");
@@ -553,6 +556,7 @@ public:
     auto cache = indexCacheInfo.indexCache;
     assert(cache && "indexCache is nullptr");
     auto insertPt = indexCacheInfo.indexInsertPoint;
+    resetIndexCacheOnNewFunc(b);
     if (cache->count(key) > 0) {
       return cache->lookup(key);
     } else {
@@ -577,6 +581,22 @@ public:
   }
 
 private:
+  // The cached indices are materialized in the entry block of the function
+  // being converted, they are dropped when moving on to another function.
+  void resetIndexCacheOnNewFunc(ConversionPatternRewriter &rewriter) const {
+    auto insertPt = indexCacheInfo.indexInsertPoint;
+    if (!insertPt->isSet())
+      return;
+    Operation *func = rewriter.getInsertionBlock()->getParentOp();
+    if (!isa<LLVM::LLVMFuncOp>(func))
+      func = func->getParentOfType<LLVM::LLVMFuncOp>();
+    if (insertPt->getBlock()->getParentOp() == func)
+      return;
+    indexCacheInfo.baseIndexCache->clear();
+    indexCacheInfo.indexCache->clear();
+    *insertPt = OpBuilder::InsertPoint();
+  }
+
   void restoreInsertionPointIfSet(OpBuilder::InsertPoint *insertPt,
                                   ConversionPatternRewriter &rewriter) const {
     if (insertPt->isSet()) {
@@ -599,11 +619,11 @@ private:
                                 const BlockedEncodingAttr &blocked_layout,
                                 ArrayRef<int64_t> shape) const {
     Value threadId = getThreadId(rewriter, loc);
-    Value warpSize = idx_val(32);
-    Value laneId = urem(threadId, warpSize);
-    Value warpId = udiv(threadId, warpSize);
     auto sizePerThread = blocked_layout.getSizePerThread();
     auto threadsPerWarp = blocked_layout.getThreadsPerWarp();
+    Value warpSize = idx_val(product<unsigned>(threadsPerWarp));
+    Value laneId = urem(threadId, warpSize);
+    Value warpId = udiv(threadId, warpSize);
     auto warpsPerCTA = blocked_layout.getWarpsPerCTA();
     auto order = blocked_layout.getOrder();
     unsigned rank = shape.size();
@@ -695,30 +715,20 @@ private:
   emitBaseIndexForMmaLayoutV1(Location loc, ConversionPatternRewriter &rewriter,
                               const MmaEncodingAttr &mmaLayout,
                               ArrayRef<int64_t> shape) const {
-    llvm_unreachable("emitIndicesForMmaLayoutV1 not implemented");
+    auto [isARow, isBRow, isAVec4, isBVec4, mmaId] =
+        mmaLayout.decodeVoltaLayoutStates();
+    return DotOpMmaV1ConversionHelper::getMNBase(
+        getThreadId(rewriter, loc), rewriter, mmaLayout.getWarpsPerCTA(),
+        isARow, isBRow, isAVec4, isBVec4);
   }
 
   SmallVector<SmallVector<unsigned>>
   emitOffsetForMmaLayoutV1(const MmaEncodingAttr &mmaLayout,
                            ArrayRef<int64_t> shape) const {
-    SmallVector<SmallVector<unsigned>> ret;
-
-    for (unsigned i = 0; i < shape[0];
-         i += getShapePerCTA(mmaLayout, shape)[0]) {
-      for (unsigned j = 0; j < shape[1];
-           j += getShapePerCTA(mmaLayout, shape)[1]) {
-        ret.push_back({i, j});
-        ret.push_back({i, j + 1});
-        ret.push_back({i + 2, j});
-        ret.push_back({i + 2, j + 1});
-        ret.push_back({i, j + 8});
-        ret.push_back({i, j + 9});
-        ret.push_back({i + 2, j + 8});
-        ret.push_back({i + 2, j + 9});
-      }
-    }
-
-    return ret;
+    auto [isARow, isBRow, isAVec4, isBVec4, mmaId] =
+        mmaLayout.decodeVoltaLayoutStates();
+    return DotOpMmaV1ConversionHelper::getMNOffsets(
+        mmaLayout.getWarpsPerCTA(), shape, isARow, isBRow, isAVec4, isBVec4);
   }
 
   SmallVector<Value>
@@ -735,6 +745,14 @@ private:
     Value warpId = udiv(threadId, warpSize);
     Value warpId0 = urem(warpId, warpsPerCTA[0]);
     Value warpId1 = urem(udiv(warpId, warpsPerCTA[0]), warpsPerCTA[1]);
+    // Wrap around warpId0/warpId1 in case the tile of the warps is larger
+    // than the tensor
+    unsigned maxWarps0 = ceil<unsigned>(shape[0], 16);
+    unsigned maxWarps1 = ceil<unsigned>(shape[1], 8);
+    if (maxWarps0 < _warpsPerCTA[0])
+      warpId0 = urem(warpId0, idx_val(maxWarps0));
+    if (maxWarps1 < _warpsPerCTA[1])
+      warpId1 = urem(warpId1, idx_val(maxWarps1));
     Value offWarp0 = mul(warpId0, idx_val(16));
     Value offWarp1 = mul(warpId1, idx_val(8));
 
@@ -769,10 +787,6 @@ private:
   SmallVector<SmallVector<Value>> emitIndicesForDistributedLayout(
       Location loc, ConversionPatternRewriter &rewriter,
       const Attribute &layout, ArrayRef<int64_t> shape) const {
-    if (auto mmaLayout = layout.template dyn_cast<MmaEncodingAttr>()) {
-      assert(!mmaLayout.isVolta());
-    }
-
     // step 1, delinearize threadId to get the base index
     auto multiDimBase = emitBaseIndexForLayout(loc, rewriter, layout, shape);
     // step 2, get offset of each element
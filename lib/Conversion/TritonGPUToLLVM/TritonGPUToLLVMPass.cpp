@@ -11,6 +11,7 @@
 #include "triton/Analysis/Allocation.h"
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Analysis/Membar.h"
+#include "triton/Analysis/SharedMemoryReport.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 
@@ -19,6 +20,8 @@
 #include "ElementwiseOpToLLVM.h"
 #include "LoadStoreOpToLLVM.h"
 #include "ReduceOpToLLVM.h"
+#include "ScanOpToLLVM.h"
+#include "SortOpToLLVM.h"
 #include "TritonGPUToLLVM.h"
 #include "TypeConverter.h"
 #include "ViewOpToLLVM.h"
@@ -65,8 +68,9 @@ namespace {
 /// information.
 struct FuncOpConversion : public FuncOpConversionBase {
   FuncOpConversion(LLVMTypeConverter &converter, int numWarps,
-                   PatternBenefit benefit)
-      : FuncOpConversionBase(converter, benefit), numWarps(numWarps) {}
+                   int threadsPerWarp, PatternBenefit benefit)
+      : FuncOpConversionBase(converter, benefit), numWarps(numWarps),
+        threadsPerWarp(threadsPerWarp) {}
 
   LogicalResult
   matchAndRewrite(FuncOp funcOp, OpAdaptor adaptor,
@@ -84,7 +88,8 @@ struct FuncOpConversion : public FuncOpConversionBase {
     // Set an attribute for maxntidx, it could be used in latter LLVM codegen
     // for `nvvm.annotation` metadata.
     newFuncOp->setAttr("nvvm.maxntid",
-                       rewriter.getIntegerAttr(i32_ty, 32 * numWarps));
+                       rewriter.getIntegerAttr(i32_ty,
+                                               threadsPerWarp * numWarps));
 
     rewriter.eraseOp(funcOp);
     return success();
@@ -92,14 +97,19 @@ struct FuncOpConversion : public FuncOpConversionBase {
 
 private:
   int numWarps{0};
+  int threadsPerWarp{32};
 };
 
 class ConvertTritonGPUToLLVM
     : public ConvertTritonGPUToLLVMBase<ConvertTritonGPUToLLVM> {
 
 public:
-  explicit ConvertTritonGPUToLLVM(int computeCapability)
-      : computeCapability(computeCapability) {}
+  explicit ConvertTritonGPUToLLVM(int computeCapability, bool fastMath,
+                                  bool nativeLoadStore)
+      : computeCapability(computeCapability) {
+    this->fastMath = fastMath;
+    this->nativeLoadStore = nativeLoadStore;
+  }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
@@ -112,6 +122,7 @@ public:
     TritonLLVMConversionTarget target(*context);
 
     int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    int threadsPerWarp = triton::gpu::TritonGPUDialect::getThreadsPerWarp(mod);
 
     // Step 1: Decompose unoptimized layout conversions to use shared memory
     // Step 2: Decompose insert_slice_async to use load + insert_slice for
@@ -139,6 +150,9 @@ public:
     Allocation allocation(mod);
     MembarAnalysis membarPass(&allocation);
     membarPass.run();
+    auto sharedReport = getSharedMemoryReport(allocation, membarPass);
+    mod->setAttr("triton_gpu.shared_report",
+                 StringAttr::get(context, sharedReport));
 
     // Step 4
     RewritePatternSet scf_patterns(context);
@@ -153,7 +167,8 @@ public:
 
     // Step 5
     RewritePatternSet func_patterns(context);
-    func_patterns.add<FuncOpConversion>(typeConverter, numWarps, /*benefit=*/1);
+    func_patterns.add<FuncOpConversion>(typeConverter, numWarps,
+                                        threadsPerWarp, /*benefit=*/1);
     if (failed(
             applyPartialConversion(mod, funcTarget, std::move(func_patterns))))
       return signalPassFailure();
@@ -162,6 +177,7 @@ public:
     AxisInfoAnalysis axisInfoAnalysis(mod.getContext());
     axisInfoAnalysis.run(mod);
     initSharedMemory(allocation.getSharedMemorySize(), typeConverter);
+    initMBarriers();
     mod->setAttr("triton_gpu.shared",
                  mlir::IntegerAttr::get(mlir::IntegerType::get(context, 32),
                                         allocation.getSharedMemorySize()));
@@ -183,7 +199,8 @@ public:
     // ConvertLayoutOp
     populateConvertLayoutOpToLLVMPatterns(typeConverter, patterns, numWarps,
                                           axisInfoAnalysis, &allocation, smem,
-                                          indexCacheInfo, /*benefit=*/10);
+                                          indexCacheInfo, computeCapability,
+                                          /*benefit=*/10);
     // DotOp
     populateDotOpToLLVMPatterns(typeConverter, patterns, numWarps,
                                 axisInfoAnalysis, &allocation, smem,
@@ -191,15 +208,25 @@ public:
     // ElementwiseOp
     populateElementwiseOpToLLVMPatterns(typeConverter, patterns, numWarps,
                                         axisInfoAnalysis, &allocation, smem,
+                                        computeCapability, fastMath,
                                         /*benefit=*/10);
     // LoadStoreOp
     populateLoadStoreOpToLLVMPatterns(typeConverter, patterns, numWarps,
                                       axisInfoAnalysis, &allocation, smem,
-                                      indexCacheInfo, /*benefit=*/10);
+                                      indexCacheInfo, computeCapability,
+                                      nativeLoadStore, /*benefit=*/10);
     // ReduceOp
     populateReduceOpToLLVMPatterns(typeConverter, patterns, numWarps,
                                    axisInfoAnalysis, &allocation, smem,
                                    indexCacheInfo, /*benefit=*/10);
+    // ScanOp
+    populateScanOpToLLVMPatterns(typeConverter, patterns, numWarps,
+                                 axisInfoAnalysis, &allocation, smem,
+                                 indexCacheInfo, /*benefit=*/10);
+    // SortOp
+    populateSortOpToLLVMPatterns(typeConverter, patterns, numWarps,
+                                 axisInfoAnalysis, &allocation, smem,
+                                 indexCacheInfo, /*benefit=*/10);
     // ViewOp
     populateViewOpToLLVMPatterns(typeConverter, patterns, numWarps,
                                  axisInfoAnalysis, &allocation, smem,
@@ -237,9 +264,23 @@ private:
     // Set array size 0 and external linkage indicates that we use dynamic
     // shared allocation to allow a larger shared memory size for each kernel.
     auto arrayTy = LLVM::LLVMArrayType::get(elemTy, 0);
+    // The slices written by the tensor memory accelerator and the operands of
+    // warpgroup MMAs are aligned to 1024 bytes from the start of the
+    // allocation
+    unsigned alignment = 0;
+    mod.walk([&](triton::gpu::InsertSliceTMAOp) { alignment = 1024; });
+    mod.walk([&](triton::DotOp dotOp) {
+      auto mmaLayout = dotOp.getResult()
+                           .getType()
+                           .cast<RankedTensorType>()
+                           .getEncoding()
+                           .dyn_cast<triton::gpu::MmaEncodingAttr>();
+      if (mmaLayout && mmaLayout.isHopper())
+        alignment = 1024;
+    });
     auto global = b.create<LLVM::GlobalOp>(
         loc, arrayTy, /*isConstant=*/false, LLVM::Linkage::External,
-        "global_smem", /*value=*/Attribute(), /*alignment=*/0,
+        "global_smem", /*value=*/Attribute(), alignment,
         mlir::gpu::GPUDialect::getWorkgroupAddressSpace());
     SmallVector<LLVM::LLVMFuncOp> funcs;
     mod.walk([&](LLVM::LLVMFuncOp func) { funcs.push_back(func); });
@@ -252,6 +293,23 @@ private:
     smem = b.create<LLVM::BitcastOp>(loc, ptrTy, smem);
   }
 
+  // Allocate the mbarriers of each group in static shared memory, outside of
+  // the buffers of the allocation
+  void initMBarriers() {
+    ModuleOp mod = getOperation();
+    OpBuilder b(mod.getBodyRegion());
+    DenseSet<unsigned> groups;
+    mod.walk([&](triton::gpu::InitMBarrierOp op) {
+      if (!groups.insert(op.id()).second)
+        return;
+      auto arrayTy = LLVM::LLVMArrayType::get(b.getI64Type(), op.num());
+      b.create<LLVM::GlobalOp>(
+          op.getLoc(), arrayTy, /*isConstant=*/false, LLVM::Linkage::Internal,
+          LLVM::getMBarrierGroupName(op.id()), /*value=*/Attribute(),
+          /*alignment=*/8, mlir::gpu::GPUDialect::getWorkgroupAddressSpace());
+    });
+  }
+
   void decomposeMmaToDotOperand(ModuleOp mod, int numWarps) const {
     // Replace `mma -> dot_op` with `mma -> blocked -> dot_op`
     // unless certain conditions are met
@@ -263,7 +321,7 @@ private:
           srcType.getEncoding().dyn_cast<triton::gpu::MmaEncodingAttr>();
       auto dstDotOp =
           dstType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
-      if (srcMma && dstDotOp && !isMmaToDotShortcut(srcMma, dstDotOp)) {
+      if (srcMma && dstDotOp && !isMmaToDotShortcut(srcType, dstType)) {
         auto tmpType = RankedTensorType::get(
             dstType.getShape(), dstType.getElementType(),
             triton::gpu::BlockedEncodingAttr::get(
@@ -365,7 +423,8 @@ private:
           insertSliceAsyncOp.getLoc(), tmpTy, insertSliceAsyncOp.src(),
           insertSliceAsyncOp.mask(), insertSliceAsyncOp.other(),
           insertSliceAsyncOp.cache(), insertSliceAsyncOp.evict(),
-          insertSliceAsyncOp.isVolatile());
+          insertSliceAsyncOp.isVolatile(), /*multicast=*/false,
+          /*ragged=*/false);
 
       // insert_slice
       auto axis = insertSliceAsyncOp.axis();
@@ -414,8 +473,10 @@ namespace mlir {
 namespace triton {
 
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertTritonGPUToLLVMPass(int computeCapability) {
-  return std::make_unique<::ConvertTritonGPUToLLVM>(computeCapability);
+createConvertTritonGPUToLLVMPass(int computeCapability, bool fastMath,
+                                 bool nativeLoadStore) {
+  return std::make_unique<::ConvertTritonGPUToLLVM>(
+      computeCapability, fastMath, nativeLoadStore);
 }
 
 } // namespace triton
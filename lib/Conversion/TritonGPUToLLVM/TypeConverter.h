@@ -37,6 +37,12 @@ public:
     addConversion([&](triton::Float8Type type) -> llvm::Optional<Type> {
       return IntegerType::get(type.getContext(), 8);
     });
+    addConversion([&](triton::Float8E4M3Type type) -> llvm::Optional<Type> {
+      return IntegerType::get(type.getContext(), 8);
+    });
+    addConversion([&](triton::Float8E5M2Type type) -> llvm::Optional<Type> {
+      return IntegerType::get(type.getContext(), 8);
+    });
     // Internally store bfloat16 as int16
     addConversion([&](BFloat16Type type) -> llvm::Optional<Type> {
       return IntegerType::get(type.getContext(), 16);
@@ -49,6 +55,23 @@ public:
                                       type.getAddressSpace());
   }
 
+  // The struct of a SharedMemoryObject: base pointer, strides and offsets
+  Type convertSharedMemoryObjectType(RankedTensorType type) {
+    auto ctx = type.getContext();
+    SmallVector<Type, 4> types;
+    // base ptr
+    auto ptrType =
+        LLVM::LLVMPointerType::get(convertType(type.getElementType()), 3);
+    types.push_back(ptrType);
+    // shape dims
+    auto rank = type.getRank();
+    // offsets + strides
+    for (auto i = 0; i < rank * 2; i++) {
+      types.push_back(IntegerType::get(ctx, 32));
+    }
+    return LLVM::LLVMStructType::getLiteral(ctx, types);
+  }
+
   llvm::Optional<Type> convertTritonTensorType(RankedTensorType type) {
     auto ctx = type.getContext();
     Attribute layout = type.getEncoding();
@@ -63,18 +86,7 @@ public:
       return LLVM::LLVMStructType::getLiteral(ctx, types);
     } else if (auto shared_layout =
                    layout.dyn_cast_or_null<SharedEncodingAttr>()) {
-      SmallVector<Type, 4> types;
-      // base ptr
-      auto ptrType =
-          LLVM::LLVMPointerType::get(convertType(type.getElementType()), 3);
-      types.push_back(ptrType);
-      // shape dims
-      auto rank = type.getRank();
-      // offsets + strides
-      for (auto i = 0; i < rank * 2; i++) {
-        types.push_back(IntegerType::get(ctx, 32));
-      }
-      return LLVM::LLVMStructType::getLiteral(ctx, types);
+      return convertSharedMemoryObjectType(type);
     } else if (auto dotOpLayout =
                    layout.dyn_cast_or_null<DotOperandEncodingAttr>()) {
       if (dotOpLayout.getParent()
@@ -88,6 +100,9 @@ public:
         auto mmaLayout = dotOpLayout.getParent().cast<MmaEncodingAttr>();
         auto wpt = mmaLayout.getWarpsPerCTA();
         Type elemTy = convertType(type.getElementType());
+        // wgmma reads its operands from shared memory
+        if (mmaLayout.isHopper())
+          return convertSharedMemoryObjectType(type);
         if (mmaLayout.isAmpere()) {
           const llvm::DenseMap<int, Type> targetTyMap = {
               {32, vec_ty(elemTy, 1)},
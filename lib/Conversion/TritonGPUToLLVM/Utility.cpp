@@ -30,7 +30,22 @@ SmallVector<Value> getElementsFromStruct(Location loc, Value llvmStruct,
   ArrayRef<Type> types =
       llvmStruct.getType().cast<LLVM::LLVMStructType>().getBody();
   SmallVector<Value> results(types.size());
+  // The elements inserted by the patterns that built the struct are used
+  // directly, so that the users of splats and broadcasts see the same scalar
+  // values repeated rather than copies of them
+  Value container = llvmStruct;
+  while (auto insert = container.getDefiningOp<LLVM::InsertValueOp>()) {
+    auto position = insert.position();
+    if (position.size() != 1)
+      break;
+    unsigned i = position[0].cast<IntegerAttr>().getInt();
+    if (!results[i])
+      results[i] = insert.value();
+    container = insert.container();
+  }
   for (unsigned i = 0; i < types.size(); ++i) {
+    if (results[i])
+      continue;
     Type type = types[i];
     results[i] = extract_val(type, llvmStruct, i64_arr_attr(i));
   }
@@ -124,6 +139,14 @@ Value shflSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
     vec = insert_element(vecTy, vec, val1, i32_val(1));
     return bitcast(vec, val.getType());
   }
+  if (bits < 32) {
+    Type type = val.getType();
+    Type intTy = rewriter.getIntegerType(bits);
+    Value asInt = type.isa<IntegerType>() ? val : bitcast(val, intTy);
+    Value word = shflSync(loc, rewriter, zext(i32_ty, asInt), i);
+    Value narrow = rewriter.create<LLVM::TruncOp>(loc, intTy, word);
+    return type.isa<IntegerType>() ? narrow : bitcast(narrow, type);
+  }
 
   PTXBuilder builder;
   auto &shfl = builder.create("shfl.sync")->o("bfly").o("b32");
@@ -136,5 +159,115 @@ Value shflSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
   return builder.launch(rewriter, loc, val.getType(), false);
 }
 
+std::string getMBarrierGroupName(int id) {
+  return "tma_mbarrier_" + std::to_string(id);
+}
+
+Value getMBarrierPtr(Location loc, ConversionPatternRewriter &rewriter,
+                     Operation *op, int id, Value index) {
+  auto global = op->getParentOfType<ModuleOp>().lookupSymbol<LLVM::GlobalOp>(
+      getMBarrierGroupName(id));
+  assert(global && "mbarriers are allocated before the conversion");
+  Type ptrTy = ptr_ty(i64_ty, 3);
+  Value base = bitcast(address_of(global), ptrTy);
+  return gep(ptrTy, base, index);
+}
+
+Value getClusterCTARank(Location loc, ConversionPatternRewriter &rewriter) {
+  PTXBuilder builder;
+  auto &mov = *builder.create("mov.u32 $0, %cluster_ctarank;");
+  mov({builder.newOperand("=r")}, /*onlyAttachMLIRArgs=*/true);
+  return builder.launch(rewriter, loc, i32_ty, /*hasSideEffect=*/false);
+}
+
+void clusterBarrier(Location loc, ConversionPatternRewriter &rewriter) {
+  PTXBuilder builder;
+  auto &sync = *builder.create("barrier.cluster.arrive.release.aligned;\n"
+                               "barrier.cluster.wait.acquire.aligned;");
+  sync({}, /*onlyAttachMLIRArgs=*/true);
+  builder.launch(rewriter, loc, void_ty(rewriter.getContext()));
+}
+
+Value shflIdxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  Value i) {
+  Type type = val.getType();
+  if (type.isa<LLVM::LLVMPointerType>()) {
+    Value asInt = ptrtoint(rewriter.getIntegerType(64), val);
+    return inttoptr(type, shflIdxSync(loc, rewriter, asInt, i));
+  }
+
+  unsigned bits = type.getIntOrFloatBitWidth();
+  if (bits == 64) {
+    Type vecTy = vec_ty(f32_ty, 2);
+    Value vec = bitcast(val, vecTy);
+    Value val0 = extract_element(f32_ty, vec, i32_val(0));
+    Value val1 = extract_element(f32_ty, vec, i32_val(1));
+    val0 = shflIdxSync(loc, rewriter, val0, i);
+    val1 = shflIdxSync(loc, rewriter, val1, i);
+    vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, val0, i32_val(0));
+    vec = insert_element(vecTy, vec, val1, i32_val(1));
+    return bitcast(vec, type);
+  }
+  if (bits < 32) {
+    Type intTy = rewriter.getIntegerType(bits);
+    Value asInt = type.isa<IntegerType>() ? val : bitcast(val, intTy);
+    Value word = shflIdxSync(loc, rewriter, zext(i32_ty, asInt), i);
+    Value narrow = rewriter.create<LLVM::TruncOp>(loc, intTy, word);
+    return type.isa<IntegerType>() ? narrow : bitcast(narrow, type);
+  }
+
+  PTXBuilder builder;
+  auto &shfl = builder.create("shfl.sync")->o("idx").o("b32");
+  auto *dOpr = builder.newOperand("=r");
+  auto *aOpr = builder.newOperand(val, "r");
+  auto *bOpr = builder.newOperand(i, "r");
+  auto *cOpr = builder.newConstantOperand("0x1f");
+  auto *maskOpr = builder.newConstantOperand("0xffffffff");
+  shfl(dOpr, aOpr, bOpr, cOpr, maskOpr);
+  return builder.launch(rewriter, loc, type, false);
+}
+
+Value shflUpSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                 int i) {
+  Type type = val.getType();
+  if (type.isa<LLVM::LLVMPointerType>()) {
+    Value asInt = ptrtoint(rewriter.getIntegerType(64), val);
+    return inttoptr(type, shflUpSync(loc, rewriter, asInt, i));
+  }
+
+  unsigned bits = type.getIntOrFloatBitWidth();
+  if (bits == 64) {
+    Type vecTy = vec_ty(f32_ty, 2);
+    Value vec = bitcast(val, vecTy);
+    Value val0 = extract_element(f32_ty, vec, i32_val(0));
+    Value val1 = extract_element(f32_ty, vec, i32_val(1));
+    val0 = shflUpSync(loc, rewriter, val0, i);
+    val1 = shflUpSync(loc, rewriter, val1, i);
+    vec = undef(vecTy);
+    vec = insert_element(vecTy, vec, val0, i32_val(0));
+    vec = insert_element(vecTy, vec, val1, i32_val(1));
+    return bitcast(vec, type);
+  }
+  if (bits < 32) {
+    Type intTy = rewriter.getIntegerType(bits);
+    Value asInt = type.isa<IntegerType>() ? val : bitcast(val, intTy);
+    Value word = shflUpSync(loc, rewriter, zext(i32_ty, asInt), i);
+    Value narrow = rewriter.create<LLVM::TruncOp>(loc, intTy, word);
+    return type.isa<IntegerType>() ? narrow : bitcast(narrow, type);
+  }
+
+  PTXBuilder builder;
+  auto &shfl = builder.create("shfl.sync")->o("up").o("b32");
+  auto *dOpr = builder.newOperand("=r");
+  auto *aOpr = builder.newOperand(val, "r");
+  auto *bOpr = builder.newConstantOperand(i);
+  // lanes below `i` keep their own value
+  auto *cOpr = builder.newConstantOperand("0x0");
+  auto *maskOpr = builder.newConstantOperand("0xffffffff");
+  shfl(dOpr, aOpr, bOpr, cOpr, maskOpr);
+  return builder.launch(rewriter, loc, type, false);
+}
+
 } // namespace LLVM
 } // namespace mlir
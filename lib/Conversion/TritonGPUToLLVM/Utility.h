@@ -27,6 +27,9 @@
 #define fmin(...) rewriter.create<LLVM::MinNumOp>(loc, __VA_ARGS__)
 #define and_(...) rewriter.create<LLVM::AndOp>(loc, __VA_ARGS__)
 #define xor_(...) rewriter.create<LLVM::XOrOp>(loc, __VA_ARGS__)
+#define or_(...) rewriter.create<LLVM::OrOp>(loc, __VA_ARGS__)
+#define shl(...) rewriter.create<LLVM::ShlOp>(loc, __VA_ARGS__)
+#define lshr(...) rewriter.create<LLVM::LShrOp>(loc, __VA_ARGS__)
 #define bitcast(val__, type__)                                                 \
   rewriter.create<LLVM::BitcastOp>(loc, type__, val__)
 #define gep(...) rewriter.create<LLVM::GEPOp>(loc, __VA_ARGS__)
@@ -71,6 +74,7 @@
 #define undef(...) rewriter.create<LLVM::UndefOp>(loc, __VA_ARGS__)
 
 // Types
+#define i64_ty rewriter.getIntegerType(64)
 #define i32_ty rewriter.getIntegerType(32)
 #define i16_ty rewriter.getIntegerType(16)
 #define ui32_ty rewriter.getIntegerType(32, false)
@@ -266,6 +270,30 @@ Value storeShared(ConversionPatternRewriter &rewriter, Location loc, Value ptr,
 Value shflSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
                int i);
 
+/// Returns the value of `val` held by lane `i` of the warp.
+Value shflIdxSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                  Value i);
+
+/// Returns the value of `val` held by the lane `i` below the current one, or
+/// `val` itself for the first `i` lanes of the warp.
+Value shflUpSync(Location loc, ConversionPatternRewriter &rewriter, Value val,
+                 int i);
+
+/// Returns the name of the shared memory array holding the mbarriers of
+/// group `id`.
+std::string getMBarrierGroupName(int id);
+
+/// Returns a pointer to mbarrier `index` of group `id`.
+Value getMBarrierPtr(Location loc, ConversionPatternRewriter &rewriter,
+                     Operation *op, int id, Value index);
+
+/// Returns the rank of the current CTA in its thread-block cluster.
+Value getClusterCTARank(Location loc, ConversionPatternRewriter &rewriter);
+
+/// Synchronizes all the threads of the thread-block cluster, and orders their
+/// previous accesses to shared memory before the following ones.
+void clusterBarrier(Location loc, ConversionPatternRewriter &rewriter);
+
 } // namespace LLVM
 } // namespace mlir
 
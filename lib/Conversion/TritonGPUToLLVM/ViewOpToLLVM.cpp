@@ -123,7 +123,7 @@ struct SplatOpConversion
       ConversionPatternRewriter &rewriter, Location loc) {
     auto tensorTy = resType.cast<RankedTensorType>();
     auto shape = tensorTy.getShape();
-    if (layout.isAmpere()) {
+    if (layout.isAmpere() || layout.isHopper()) {
       auto [repM, repN] = DotOpMmaV2ConversionHelper::getRepMN(tensorTy);
       size_t fcSize = 4 * repM * repN;
 
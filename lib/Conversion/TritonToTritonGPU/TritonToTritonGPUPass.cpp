@@ -233,15 +233,18 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
     auto origShape = origType.getShape();
     auto typeConverter = getTypeConverter<TritonGPUTypeConverter>();
     int numWarps = typeConverter->getNumWarps();
+    int threadsPerWarp = typeConverter->getThreadsPerWarp();
+    int numThreads = numWarps * threadsPerWarp;
 
     SmallVector<unsigned> retSizePerThread = {1, 1};
-    if (origShape[0] * origShape[1] / (numWarps * 32) >= 4)
+    if (origShape[0] * origShape[1] / numThreads >= 4)
       retSizePerThread = {2, 2};
-    if (origShape[0] * origShape[1] / (numWarps * 32) >= 16)
+    if (origShape[0] * origShape[1] / numThreads >= 16)
       retSizePerThread = {4, 4};
     SmallVector<unsigned> retOrder = {1, 0};
     Attribute dEncoding = triton::gpu::BlockedEncodingAttr::get(
-        getContext(), origShape, retSizePerThread, retOrder, numWarps);
+        getContext(), origShape, retSizePerThread, retOrder, numWarps,
+        threadsPerWarp);
     RankedTensorType retType =
         RankedTensorType::get(origShape, origType.getElementType(), dEncoding);
     // a & b must be of smem layout
@@ -271,7 +274,8 @@ struct TritonDotPattern : public OpConversionPattern<triton::DotOp> {
     c = rewriter.create<triton::gpu::ConvertLayoutOp>(c.getLoc(), retType, c);
 
     rewriter.replaceOpWithNewOp<triton::DotOp>(op, retType, a, b, c,
-                                               adaptor.allowTF32());
+                                               adaptor.allowTF32(),
+                                               adaptor.tf32x3());
     return success();
   }
 };
@@ -333,7 +337,7 @@ struct TritonLoadPattern : public OpConversionPattern<triton::LoadOp> {
     rewriter.replaceOpWithNewOp<triton::LoadOp>(
         op, typeConverter->convertType(op.getType()), adaptor.ptr(),
         adaptor.mask(), adaptor.other(), adaptor.cache(), adaptor.evict(),
-        adaptor.isVolatile());
+        adaptor.isVolatile(), op.multicastAttr(), op.raggedAttr());
     return success();
   }
 };
@@ -345,7 +349,8 @@ struct TritonStorePattern : public OpConversionPattern<triton::StoreOp> {
   matchAndRewrite(triton::StoreOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
     rewriter.replaceOpWithNewOp<triton::StoreOp>(
-        op, adaptor.ptr(), adaptor.value(), adaptor.mask());
+        op, adaptor.ptr(), adaptor.value(), adaptor.mask(), adaptor.cache(),
+        adaptor.evict());
     return success();
   }
 };
@@ -373,7 +378,8 @@ struct TritonAtomicRMWPattern
                   ConversionPatternRewriter &rewriter) const override {
     rewriter.replaceOpWithNewOp<triton::AtomicRMWOp>(
         op, typeConverter->convertType(op.getType()), adaptor.atomic_rmw_op(),
-        adaptor.ptr(), adaptor.val(), adaptor.mask());
+        adaptor.ptr(), adaptor.val(), adaptor.mask(), op.warp_aggregateAttr(),
+        op.grid_syncAttr());
     return success();
   }
 };
@@ -439,6 +445,67 @@ struct TritonReducePattern : public OpConversionPattern<triton::ReduceOp> {
   }
 };
 
+struct TritonGenericReducePattern
+    : public OpConversionPattern<triton::GenericReduceOp> {
+  using OpConversionPattern<triton::GenericReduceOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::GenericReduceOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto newReduce = rewriter.create<triton::GenericReduceOp>(
+        op.getLoc(), adaptor.operands(), adaptor.axis());
+    // the combine function works on scalars, it is moved as is
+    rewriter.inlineRegionBefore(op.combineOp(), newReduce.combineOp(),
+                                newReduce.combineOp().end());
+    rewriter.replaceOp(op, newReduce.getResults());
+    return success();
+  }
+};
+
+struct TritonScanPattern : public OpConversionPattern<triton::ScanOp> {
+  using OpConversionPattern<triton::ScanOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::ScanOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto newScan = rewriter.create<triton::ScanOp>(
+        op.getLoc(), adaptor.operand().getType(), adaptor.operand(),
+        adaptor.axis());
+    // the combine function works on scalars, it is moved as is
+    rewriter.inlineRegionBefore(op.combineOp(), newScan.combineOp(),
+                                newScan.combineOp().end());
+    rewriter.replaceOp(op, newScan.getResult());
+    return success();
+  }
+};
+
+struct TritonSortPattern : public OpConversionPattern<triton::SortOp> {
+  using OpConversionPattern<triton::SortOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::SortOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Type retType = getTypeConverter()->convertType(op.getType());
+    rewriter.replaceOpWithNewOp<triton::SortOp>(
+        op, retType, adaptor.operand(), adaptor.axis(), adaptor.descending());
+    return success();
+  }
+};
+
+struct TritonPhiloxPattern : public OpConversionPattern<triton::PhiloxOp> {
+  using OpConversionPattern<triton::PhiloxOp>::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(triton::PhiloxOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Type retType = getTypeConverter()->convertType(op.getType());
+    rewriter.replaceOpWithNewOp<triton::PhiloxOp>(
+        op, retType, adaptor.offset(), adaptor.seedLo(), adaptor.seedHi(),
+        adaptor.nRounds());
+    return success();
+  }
+};
+
 struct TritonPrintfPattern : public OpConversionPattern<triton::PrintfOp> {
   using OpConversionPattern<PrintfOp>::OpConversionPattern;
 
@@ -462,10 +529,11 @@ void populateTritonPatterns(TritonGPUTypeConverter &typeConverter,
       TritonGenericPattern<triton::PtrToIntOp>,
       TritonGenericPattern<triton::SplatOp>, TritonBroadcastPattern,
       TritonGenericPattern<triton::AddPtrOp>, TritonCatPattern,
-      TritonReducePattern, TritonTransPattern, TritonExpandDimsPattern,
+      TritonReducePattern, TritonGenericReducePattern, TritonScanPattern,
+      TritonSortPattern, TritonTransPattern, TritonExpandDimsPattern,
       TritonMakeRangePattern, TritonDotPattern, TritonLoadPattern,
-      TritonStorePattern, TritonExtElemwisePattern, TritonPrintfPattern,
-      TritonAtomicRMWPattern>(typeConverter, context);
+      TritonStorePattern, TritonExtElemwisePattern, TritonPhiloxPattern,
+      TritonPrintfPattern, TritonAtomicRMWPattern>(typeConverter, context);
 }
 
 //
@@ -585,13 +653,19 @@ class ConvertTritonToTritonGPU
 public:
   ConvertTritonToTritonGPU() = default;
   // constructor with some parameters set explicitly.
-  ConvertTritonToTritonGPU(int numWarps) { this->numWarps = numWarps; }
+  ConvertTritonToTritonGPU(int numWarps, int threadsPerWarp, int numCTAs,
+                           const std::string &pidRemap) {
+    this->numWarps = numWarps;
+    this->threadsPerWarp = threadsPerWarp;
+    this->numCTAs = numCTAs;
+    this->pidRemap = pidRemap;
+  }
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp mod = getOperation();
     // type converter
-    TritonGPUTypeConverter typeConverter(context, numWarps);
+    TritonGPUTypeConverter typeConverter(context, numWarps, threadsPerWarp);
     TritonGPUConversionTarget target(*context, typeConverter);
     // rewrite patterns
     RewritePatternSet patterns(context);
@@ -613,6 +687,15 @@ public:
     mod->setAttr(
         AttrNumWarpsName,
         IntegerAttr::get(i32_ty, llvm::APInt(32, numWarps.getValue())));
+    mod->setAttr(
+        AttrThreadsPerWarpName,
+        IntegerAttr::get(i32_ty, llvm::APInt(32, threadsPerWarp.getValue())));
+    mod->setAttr(AttrNumCTAsName,
+                 IntegerAttr::get(i32_ty, llvm::APInt(32, numCTAs.getValue())));
+    // Programs keep the order of the grid unless a remap is given
+    if (!pidRemap.getValue().empty())
+      mod->setAttr(AttrPidRemapName,
+                   StringAttr::get(context, pidRemap.getValue()));
 
     // update layouts
     //  broadcast src => multicast, dst => broadcasted
@@ -624,8 +707,12 @@ public:
 } // namespace
 
 std::unique_ptr<OperationPass<ModuleOp>>
-mlir::triton::createConvertTritonToTritonGPUPass(int numWarps) {
-  return std::make_unique<::ConvertTritonToTritonGPU>(numWarps);
+mlir::triton::createConvertTritonToTritonGPUPass(int numWarps,
+                                                 int threadsPerWarp,
+                                                 int numCTAs,
+                                                 const std::string &pidRemap) {
+  return std::make_unique<::ConvertTritonToTritonGPU>(numWarps, threadsPerWarp,
+                                                      numCTAs, pidRemap);
 }
 
 std::unique_ptr<OperationPass<ModuleOp>>
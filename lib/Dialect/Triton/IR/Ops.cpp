@@ -107,7 +107,13 @@ ParseResult parseStoreOp(OpAsmParser &parser, OperationState &result) {
 void printStoreOp(OpAsmPrinter &printer, StoreOp storeOp) {
   printer << " ";
   printer << storeOp.getOperation()->getOperands();
-  printer.printOptionalAttrDict(storeOp->getAttrs(), /*elidedAttrs=*/{});
+  // Default cache and eviction policies are not printed.
+  SmallVector<StringRef> elidedAttrs;
+  if (storeOp.cache() == CacheModifier::NONE)
+    elidedAttrs.push_back(storeOp.cacheAttrName());
+  if (storeOp.evict() == EvictionPolicy::NORMAL)
+    elidedAttrs.push_back(storeOp.evictAttrName());
+  printer.printOptionalAttrDict(storeOp->getAttrs(), elidedAttrs);
   printer << " : ";
   printer.printStrippedAttrOrType(storeOp.value().getType());
 }
@@ -139,9 +145,9 @@ bool FpToFpOp::areCastCompatible(::mlir::TypeRange inputs,
   }
   // Check whether fp8 <=> fp16, bf16, f32, f64
   // Make `srcEltType` always the fp8 side
-  if (dstEltType.dyn_cast<mlir::triton::Float8Type>())
+  if (mlir::triton::isFloat8(dstEltType))
     std::swap(srcEltType, dstEltType);
-  if (!srcEltType.dyn_cast<mlir::triton::Float8Type>())
+  if (!mlir::triton::isFloat8(srcEltType))
     return false;
   return dstEltType.isF16() || dstEltType.isBF16() || dstEltType.isF32() ||
          dstEltType.isF64();
@@ -150,7 +156,15 @@ bool FpToFpOp::areCastCompatible(::mlir::TypeRange inputs,
 //-- StoreOp --
 void StoreOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
                     ::mlir::Value ptr, ::mlir::Value value) {
-  StoreOp::build(builder, state, ptr, value, mlir::Value());
+  StoreOp::build(builder, state, ptr, value, mlir::Value(),
+                 triton::CacheModifier::NONE, triton::EvictionPolicy::NORMAL);
+}
+
+void StoreOp::build(::mlir::OpBuilder &builder, ::mlir::OperationState &state,
+                    ::mlir::Value ptr, ::mlir::Value value,
+                    ::mlir::triton::CacheModifier cache,
+                    ::mlir::triton::EvictionPolicy evict) {
+  StoreOp::build(builder, state, ptr, value, mlir::Value(), cache, evict);
 }
 
 //-- LoadOp --
@@ -301,6 +315,39 @@ mlir::LogicalResult mlir::triton::ReduceOp::inferReturnTypes(
   return mlir::success();
 }
 
+//-- GenericReduceOp --
+mlir::LogicalResult mlir::triton::GenericReduceOp::inferReturnTypes(
+    MLIRContext *context, Optional<Location> location, ValueRange operands,
+    DictionaryAttr attributes, RegionRange regions,
+    SmallVectorImpl<Type> &inferredReturnTypes) {
+  int axis = attributes.get("axis").cast<IntegerAttr>().getInt();
+  for (Value arg : operands) {
+    auto argTy = arg.getType().cast<RankedTensorType>();
+    auto retShape = argTy.getShape().vec();
+    retShape.erase(retShape.begin() + axis);
+    if (retShape.empty()) {
+      // 0d-tensor -> scalar
+      inferredReturnTypes.push_back(argTy.getElementType());
+      continue;
+    }
+    // nd-tensor where n >= 1
+    Attribute argEncoding = argTy.getEncoding();
+    Attribute retEncoding;
+    if (argEncoding) {
+      Dialect &dialect = argEncoding.getDialect();
+      auto inferLayoutInterface =
+          dyn_cast<DialectInferLayoutInterface>(&dialect);
+      if (inferLayoutInterface
+              ->inferReduceOpEncoding(argEncoding, axis, retEncoding)
+              .failed())
+        return mlir::failure();
+    }
+    inferredReturnTypes.push_back(
+        RankedTensorType::get(retShape, argTy.getElementType(), retEncoding));
+  }
+  return mlir::success();
+}
+
 bool mlir::triton::ReduceOp::withIndex(mlir::triton::RedOp redOp) {
   return redOp == mlir::triton::RedOp::ARGMIN ||
          redOp == mlir::triton::RedOp::ARGMAX ||
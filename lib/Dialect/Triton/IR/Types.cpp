@@ -37,3 +37,19 @@ Type PointerType::parse(AsmParser &parser) {
 void PointerType::print(AsmPrinter &printer) const {
   printer << "<" << getPointeeType() << ">";
 }
+
+namespace mlir {
+namespace triton {
+
+bool isFloat8(Type type) {
+  return type.isa<Float8Type, Float8E4M3Type, Float8E5M2Type>();
+}
+
+unsigned getIntOrFloatBitWidth(Type type) {
+  if (isFloat8(type))
+    return 8;
+  return type.getIntOrFloatBitWidth();
+}
+
+} // namespace triton
+} // namespace mlir
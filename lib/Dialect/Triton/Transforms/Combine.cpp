@@ -86,8 +86,9 @@ public:
       return mlir::failure();
 
     rewriter.replaceOpWithNewOp<triton::LoadOp>(
-        op, loadOp.ptr(), loadOp.mask(), falseValue, loadOp.cache(),
-        loadOp.evict(), loadOp.isVolatile());
+        op, loadOp.getType(), loadOp.ptr(), loadOp.mask(), falseValue,
+        loadOp.cache(), loadOp.evict(), loadOp.isVolatile(),
+        loadOp.multicast(), loadOp.ragged());
     return mlir::success();
   }
 };
@@ -119,7 +120,8 @@ struct CanonicalizeMaskedLoadPattern
       // mask = splat(1)
       rewriter.replaceOpWithNewOp<triton::LoadOp>(
           loadOp, loadOp.getType(), loadOp.ptr(), Value(), Value(),
-          loadOp.cache(), loadOp.evict(), loadOp.isVolatile());
+          loadOp.cache(), loadOp.evict(), loadOp.isVolatile(),
+          loadOp.multicast(), loadOp.ragged());
     } else {
       // mask = splat(0)
 
@@ -164,8 +166,9 @@ struct CanonicalizeMaskedStorePattern
 
     if (splatMask.getSplatValue<IntegerAttr>().getValue() == true) {
       // mask = splat(1)
-      rewriter.replaceOpWithNewOp<triton::StoreOp>(storeOp, storeOp.ptr(),
-                                                   storeOp.value());
+      rewriter.replaceOpWithNewOp<triton::StoreOp>(
+          storeOp, storeOp.ptr(), storeOp.value(), storeOp.cache(),
+          storeOp.evict());
     } else {
       // mask = splat(0)
       rewriter.eraseOp(storeOp);
@@ -0,0 +1,242 @@
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+#include "triton/Dialect/Triton/IR/Dialect.h"
+#include "triton/Dialect/Triton/Transforms/Passes.h"
+
+#include <memory>
+
+using namespace mlir;
+
+namespace {
+
+bool isPtrTensor(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  return tensorType &&
+         tensorType.getElementType().isa<triton::PointerType>();
+}
+
+// Type of the offsets of the pointers of type `type`
+Type getOffsetType(Type type) {
+  auto i32Ty = IntegerType::get(type.getContext(), 32);
+  if (auto tensorType = type.dyn_cast<RankedTensorType>())
+    return RankedTensorType::get(tensorType.getShape(), i32Ty,
+                                 tensorType.getEncoding());
+  return i32Ty;
+}
+
+// Whether `value` is a kernel argument whose offsets fit in 32 bits
+bool isRoot(Value value) {
+  auto arg = value.dyn_cast<BlockArgument>();
+  if (!arg || !arg.getOwner()->isEntryBlock())
+    return false;
+  auto fun = dyn_cast<FuncOp>(arg.getOwner()->getParentOp());
+  if (!fun)
+    return false;
+  auto attr = fun.getArgAttrOfType<IntegerAttr>(arg.getArgNumber(),
+                                                "tt.pointer_range");
+  return attr && attr.getInt() == 32;
+}
+
+class PointerOffsets {
+public:
+  explicit PointerOffsets(MLIRContext *context) : builder(context) {}
+
+  // Returns the kernel argument that `ptr` is derived from with addptr,
+  // splat, broadcast, expand_dims, view and the loops, or a null value.
+  Value getRoot(Value ptr) {
+    auto it = assumed.find(ptr);
+    if (it != assumed.end())
+      return it->second;
+    if (isRoot(ptr))
+      return ptr;
+    if (auto arg = ptr.dyn_cast<BlockArgument>()) {
+      auto forOp = dyn_cast<scf::ForOp>(arg.getOwner()->getParentOp());
+      if (!forOp || arg.getArgNumber() == 0)
+        return Value();
+      return getLoopRoot(forOp, arg.getArgNumber() - 1);
+    }
+    Operation *op = ptr.getDefiningOp();
+    if (auto forOp = dyn_cast<scf::ForOp>(op))
+      return getLoopRoot(forOp, ptr.cast<OpResult>().getResultNumber());
+    if (auto addPtr = dyn_cast<triton::AddPtrOp>(op))
+      return getRoot(addPtr.ptr());
+    if (isa<triton::SplatOp, triton::BroadcastOp, triton::ExpandDimsOp,
+            triton::ViewOp>(op))
+      return getRoot(op->getOperand(0));
+    return Value();
+  }
+
+  // Returns the i32 offsets of `ptr` from its root, which are built next to
+  // the definition of `ptr`. The loops that carry `ptr` are rewritten to
+  // carry its offsets.
+  Value getOffset(Value ptr) {
+    auto it = offsets.find(ptr);
+    if (it != offsets.end())
+      return it->second;
+    Value offset;
+    Location loc = ptr.getLoc();
+    if (isRoot(ptr)) {
+      builder.setInsertionPointToStart(ptr.cast<BlockArgument>().getOwner());
+      offset = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+    } else if (auto arg = ptr.dyn_cast<BlockArgument>()) {
+      auto forOp = cast<scf::ForOp>(arg.getOwner()->getParentOp());
+      bool converted = convertLoopArg(forOp, arg.getArgNumber() - 1);
+      assert(converted && "loop argument without a root");
+      offset = arg;
+    } else if (auto forOp = ptr.getDefiningOp<scf::ForOp>()) {
+      bool converted =
+          convertLoopArg(forOp, ptr.cast<OpResult>().getResultNumber());
+      assert(converted && "loop result without a root");
+      offset = ptr;
+    } else if (auto addPtr = ptr.getDefiningOp<triton::AddPtrOp>()) {
+      Value base = getOffset(addPtr.ptr());
+      builder.setInsertionPointAfter(addPtr);
+      offset = builder.create<arith::AddIOp>(
+          loc, base, castToI32(loc, addPtr.offset()));
+    } else {
+      Operation *op = ptr.getDefiningOp();
+      Value src = getOffset(op->getOperand(0));
+      builder.setInsertionPointAfter(op);
+      Type type = getOffsetType(ptr.getType());
+      if (isa<triton::SplatOp>(op))
+        offset = builder.create<triton::SplatOp>(loc, type, src);
+      else if (isa<triton::BroadcastOp>(op))
+        offset = builder.create<triton::BroadcastOp>(loc, type, src);
+      else if (auto expandDims = dyn_cast<triton::ExpandDimsOp>(op))
+        offset = builder.create<triton::ExpandDimsOp>(loc, type, src,
+                                                      expandDims.axisAttr());
+      else
+        offset = builder.create<triton::ViewOp>(loc, type, src);
+    }
+    offsets[ptr] = offset;
+    return offset;
+  }
+
+  // Rewrites the i-th pointer tensor carried by `forOp` into its offsets, if
+  // it has the same root on entry and in every iteration.
+  bool convertLoopArg(scf::ForOp forOp, unsigned i) {
+    Value root = getLoopRoot(forOp, i);
+    if (!root)
+      return false;
+    Value iterArg = forOp.getRegionIterArgs()[i];
+    Type ptrType = iterArg.getType();
+    Type offsetType = getOffsetType(ptrType);
+    Location loc = forOp.getLoc();
+    Value initOffset = getOffset(forOp.getInitArgs()[i]);
+    forOp.getIterOpOperands()[i].set(initOffset);
+    // the body uses the pointers rebuilt from the offsets
+    iterArg.setType(offsetType);
+    builder.setInsertionPointToStart(forOp.getBody());
+    Value ptr = rebase(loc, root, iterArg, ptrType);
+    iterArg.replaceAllUsesExcept(ptr, ptr.getDefiningOp());
+    offsets[iterArg] = iterArg;
+    Operation *yield = forOp.getBody()->getTerminator();
+    yield->setOperand(i, getOffset(yield->getOperand(i)));
+    // and so do the users of the loop
+    Value result = forOp.getResult(i);
+    result.setType(offsetType);
+    builder.setInsertionPointAfter(forOp);
+    Value resultPtr = rebase(loc, root, result, ptrType);
+    result.replaceAllUsesExcept(resultPtr, resultPtr.getDefiningOp());
+    offsets[result] = result;
+    return true;
+  }
+
+  // Rewrites the pointer operand of a memory instruction as
+  // addptr(splat(root), offsets)
+  void rebaseOperand(Operation *op) {
+    Value ptr = op->getOperand(0);
+    if (!isPtrTensor(ptr.getType()) || isRebased(ptr))
+      return;
+    Value root = getRoot(ptr);
+    if (!root)
+      return;
+    Value offset = getOffset(ptr);
+    builder.setInsertionPoint(op);
+    op->setOperand(0, rebase(op->getLoc(), root, offset, ptr.getType()));
+  }
+
+private:
+  Value getLoopRoot(scf::ForOp forOp, unsigned i) {
+    Value iterArg = forOp.getRegionIterArgs()[i];
+    if (!isPtrTensor(iterArg.getType()))
+      return Value();
+    auto it = assumed.find(iterArg);
+    if (it != assumed.end())
+      return it->second;
+    Value root = getRoot(forOp.getInitArgs()[i]);
+    if (!root)
+      return Value();
+    assumed[iterArg] = root;
+    Operation *yield = forOp.getBody()->getTerminator();
+    Value yieldRoot = getRoot(yield->getOperand(i));
+    assumed.erase(iterArg);
+    return yieldRoot == root ? root : Value();
+  }
+
+  Value castToI32(Location loc, Value offset) {
+    Type type = getOffsetType(offset.getType());
+    unsigned width =
+        getElementTypeOrSelf(offset.getType()).getIntOrFloatBitWidth();
+    if (width < 32)
+      return builder.create<arith::ExtSIOp>(loc, type, offset);
+    if (width > 32)
+      return builder.create<arith::TruncIOp>(loc, type, offset);
+    return offset;
+  }
+
+  Value rebase(Location loc, Value root, Value offset, Type ptrType) {
+    Value base = builder.create<triton::SplatOp>(loc, ptrType, root);
+    return builder.create<triton::AddPtrOp>(loc, ptrType, base, offset);
+  }
+
+  bool isRebased(Value ptr) {
+    auto addPtr = ptr.getDefiningOp<triton::AddPtrOp>();
+    if (!addPtr || !getElementTypeOrSelf(addPtr.offset().getType())
+                         .isInteger(32))
+      return false;
+    auto splat = addPtr.ptr().getDefiningOp<triton::SplatOp>();
+    return splat && isRoot(splat.src());
+  }
+
+  OpBuilder builder;
+  // roots of the loop arguments whose root is being computed
+  DenseMap<Value, Value> assumed;
+  DenseMap<Value, Value> offsets;
+};
+
+} // anonymous namespace
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/Triton/Transforms/Passes.h.inc"
+
+class RewritePointerOffsetsPass
+    : public TritonRewritePointerOffsetsBase<RewritePointerOffsetsPass> {
+public:
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    PointerOffsets pointerOffsets(&getContext());
+    // the outer loops are rewritten first, so that the inner loops are
+    // initialized from the offsets of the outer ones
+    SmallVector<scf::ForOp> forOps;
+    m.walk<WalkOrder::PreOrder>(
+        [&](scf::ForOp forOp) { forOps.push_back(forOp); });
+    for (scf::ForOp forOp : forOps)
+      for (unsigned i = 0; i < forOp.getNumRegionIterArgs(); ++i)
+        pointerOffsets.convertLoopArg(forOp, i);
+    SmallVector<Operation *> memOps;
+    m.walk([&](Operation *op) {
+      if (isa<triton::LoadOp, triton::StoreOp, triton::AtomicRMWOp>(op))
+        memOps.push_back(op);
+    });
+    for (Operation *op : memOps)
+      pointerOffsets.rebaseOperand(op);
+  }
+};
+
+std::unique_ptr<mlir::Pass> mlir::triton::createRewritePointerOffsetsPass() {
+  return std::make_unique<RewritePointerOffsetsPass>();
+}
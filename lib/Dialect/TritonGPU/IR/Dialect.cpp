@@ -64,7 +64,7 @@ unsigned getElemsPerThread(Attribute layout, ArrayRef<int64_t> shape) {
 }
 
 unsigned getElemsPerThread(Type type) {
-  if (type.isIntOrIndexOrFloat() || type.isa<triton::Float8Type>() ||
+  if (type.isIntOrIndexOrFloat() || triton::isFloat8(type) ||
       type.isa<triton::PointerType>())
     return 1;
   auto tensorType = type.cast<RankedTensorType>();
@@ -79,7 +79,7 @@ SmallVector<unsigned> getThreadsPerWarp(const Attribute &layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
     if (mmaLayout.isVolta())
       return {4, 8};
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {8, 4};
   }
   assert(0 && "getThreadsPerWarp not implemented");
@@ -109,7 +109,7 @@ SmallVector<unsigned> getSizePerThread(const Attribute &layout) {
     // ret.erase(ret.begin() + sliceLayout.getDim());
     return ret;
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return {2, 2};
     } else if (mmaLayout.isVolta()) {
       return {1, 2};
@@ -145,7 +145,8 @@ SmallVector<unsigned> getSizePerThread(const Attribute &layout) {
 
 SmallVector<unsigned> getContigPerThread(Attribute layout) {
   if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    assert(mmaLayout.isVolta() || mmaLayout.isAmpere());
+    assert(mmaLayout.isVolta() || mmaLayout.isAmpere() ||
+           mmaLayout.isHopper());
     return {1, 2};
   } else {
     return getSizePerThread(layout);
@@ -159,7 +160,7 @@ SmallVector<unsigned> getThreadsPerCTA(const Attribute &layout) {
       threads.push_back(blockedLayout.getThreadsPerWarp()[d] *
                         blockedLayout.getWarpsPerCTA()[d]);
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.getVersionMajor() == 2) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       threads = {8 * mmaLayout.getWarpsPerCTA()[0],
                  4 * mmaLayout.getWarpsPerCTA()[1]};
     } else
@@ -188,7 +189,7 @@ SmallVector<unsigned> getShapePerCTA(const Attribute &layout,
       shape.push_back(getShapePerCTA(parent, tensorShape)[d]);
     }
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere())
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper())
       return {16 * mmaLayout.getWarpsPerCTA()[0],
               8 * mmaLayout.getWarpsPerCTA()[1]};
     if (mmaLayout.isVolta()) {
@@ -220,7 +221,7 @@ SmallVector<unsigned> getShapePerCTA(const Attribute &layout,
                   "supported yet");
     }
   } else if (auto mmaLayout = layout.dyn_cast<MmaEncodingAttr>()) {
-    if (mmaLayout.isAmpere()) {
+    if (mmaLayout.isAmpere() || mmaLayout.isHopper()) {
       return {16 * mmaLayout.getWarpsPerCTA()[0],
               8 * mmaLayout.getWarpsPerCTA()[1]};
     } else if (mmaLayout.isVolta()) {
@@ -384,7 +385,8 @@ unsigned SliceEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape) const {
 unsigned MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape) const {
   size_t rank = shape.size();
   assert(rank == 2 && "Unexpected rank of mma layout");
-  assert((isVolta() || isAmpere()) && "Only version 1 and 2 is supported");
+  assert((isVolta() || isAmpere() || isHopper()) &&
+         "Only version 1, 2 and 3 are supported");
 
   int res = 0;
   if (isVolta()) {
@@ -393,7 +395,7 @@ unsigned MmaEncodingAttr::getElemsPerThread(ArrayRef<int64_t> shape) const {
     // Each warp-level mma884 will perform a m16xn16xk4 mma, thus get a m16xn16
     // matrix as result.
     res = mmasRow * mmasCol * (16 * 16 / 32);
-  } else if (isAmpere()) {
+  } else if (isAmpere() || isHopper()) {
     unsigned elemsCol = ceil<unsigned>(shape[0], 16 * getWarpsPerCTA()[0]) * 2;
     unsigned elemsRow = ceil<unsigned>(shape[1], 8 * getWarpsPerCTA()[1]) * 2;
     res = elemsCol * elemsRow;
@@ -604,6 +606,8 @@ bool MmaEncodingAttr::isVolta() const { return getVersionMajor() == 1; }
 
 bool MmaEncodingAttr::isAmpere() const { return getVersionMajor() == 2; }
 
+bool MmaEncodingAttr::isHopper() const { return getVersionMajor() == 3; }
+
 // Get [isARow, isBRow, isAVec4, isBVec4, id] from versionMinor
 std::tuple<bool, bool, bool, bool, int>
 MmaEncodingAttr::decodeVoltaLayoutStates() const {
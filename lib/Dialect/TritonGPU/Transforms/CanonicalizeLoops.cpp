@@ -1,4 +1,7 @@
-#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 
@@ -10,46 +13,224 @@ using namespace mlir::triton;
 
 namespace {
 
+bool isPtrTensor(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  return tensorType && tensorType.getElementType().isa<triton::PointerType>();
+}
+
+// Whether `value` splats a scalar that is available before `forOp`
+bool isInvariantSplat(scf::ForOp forOp, Value value) {
+  if (auto splat = value.getDefiningOp<triton::SplatOp>())
+    return forOp.isDefinedOutsideOfLoop(splat.src());
+  DenseElementsAttr attr;
+  return matchPattern(value, m_Constant(&attr)) && attr.isSplat();
+}
+
+Value getSplatScalar(OpBuilder &builder, Value value) {
+  if (auto splat = value.getDefiningOp<triton::SplatOp>())
+    return splat.src();
+  DenseElementsAttr attr;
+  matchPattern(value, m_Constant(&attr));
+  return builder.create<arith::ConstantOp>(value.getLoc(),
+                                           attr.getSplatValue<Attribute>());
+}
+
+// Matches addptr(...addptr(splat(base), offsets), splat(s1))..., splat(sn)),
+// and returns the splats of s1 ... sn in `steps`
+bool matchBase(scf::ForOp forOp, Value ptr, Value &base, Value &offsets,
+               SmallVectorImpl<Value> &steps) {
+  auto addPtr = ptr.getDefiningOp<triton::AddPtrOp>();
+  if (!addPtr)
+    return false;
+  if (auto splat = addPtr.ptr().getDefiningOp<triton::SplatOp>()) {
+    base = splat.src();
+    offsets = addPtr.offset();
+    return forOp.isDefinedOutsideOfLoop(offsets);
+  }
+  if (!isInvariantSplat(forOp, addPtr.offset()) ||
+      !matchBase(forOp, addPtr.ptr(), base, offsets, steps))
+    return false;
+  steps.push_back(addPtr.offset());
+  return true;
+}
+
+// Replaces `forOp` with a loop that carries its iter args `kept`, followed by
+// `extraInits`. The yield of the new loop only forwards the kept operands,
+// the caller appends those of the extra iter args. The iter args that are
+// not kept must only be used by the yield.
+scf::ForOp rebuildLoop(scf::ForOp forOp, ArrayRef<unsigned> kept,
+                       ValueRange extraInits) {
+  OpBuilder builder(forOp);
+  SmallVector<Value> inits;
+  for (unsigned i : kept)
+    inits.push_back(forOp.getInitArgs()[i]);
+  inits.append(extraInits.begin(), extraInits.end());
+  auto newForOp = builder.create<scf::ForOp>(
+      forOp.getLoc(), forOp.getLowerBound(), forOp.getUpperBound(),
+      forOp.getStep(), inits);
+  Block *newBody = newForOp.getBody();
+  if (!newBody->empty())
+    newBody->getTerminator()->erase();
+  newBody->getOperations().splice(newBody->end(),
+                                  forOp.getBody()->getOperations());
+  forOp.getInductionVar().replaceAllUsesWith(newForOp.getInductionVar());
+  Operation *yield = newBody->getTerminator();
+  SmallVector<Value> yields;
+  for (auto it : llvm::enumerate(kept)) {
+    forOp.getRegionIterArgs()[it.value()].replaceAllUsesWith(
+        newForOp.getRegionIterArgs()[it.index()]);
+    forOp.getResult(it.value()).replaceAllUsesWith(
+        newForOp.getResult(it.index()));
+    yields.push_back(yield->getOperand(it.value()));
+  }
+  yield->setOperands(yields);
+  forOp.erase();
+  return newForOp;
+}
+
+// A pointer tensor carried as addptr(P, splat(s)), with P = addptr(splat(b),
+// offsets) on entry, is rebuilt in the body from the scalar pointer
+// b + k * s, which is carried instead. The offsets stay live across the loop
+// in place of the pointers, i.e., as 32-bit rather than 64-bit values when
+// they are i32, and the old iter arg is left dead.
+scf::ForOp strengthReducePointers(scf::ForOp forOp) {
+  Operation *yield = forOp.getBody()->getTerminator();
+  SmallVector<unsigned> reduced;
+  SmallVector<Value> bases, offsets;
+  OpBuilder builder(forOp);
+  for (unsigned i = 0; i < forOp.getNumRegionIterArgs(); ++i) {
+    Value iterArg = forOp.getRegionIterArgs()[i];
+    if (!isPtrTensor(iterArg.getType()))
+      continue;
+    auto next = yield->getOperand(i).getDefiningOp<triton::AddPtrOp>();
+    if (!next || next.ptr() != iterArg ||
+        !isInvariantSplat(forOp, next.offset()))
+      continue;
+    Value base, offset;
+    SmallVector<Value> steps;
+    if (!matchBase(forOp, forOp.getInitArgs()[i], base, offset, steps))
+      continue;
+    // the steps already taken before the loop, e.g. by its prologue once
+    // it is pipelined, are added to the base
+    for (Value step : steps)
+      base = builder.create<triton::AddPtrOp>(
+          forOp.getLoc(), base.getType(), base,
+          getSplatScalar(builder, step));
+    reduced.push_back(i);
+    bases.push_back(base);
+    offsets.push_back(offset);
+  }
+  if (reduced.empty())
+    return forOp;
+  unsigned numArgs = forOp.getNumRegionIterArgs();
+  SmallVector<unsigned> kept;
+  for (unsigned i = 0; i < numArgs; ++i)
+    kept.push_back(i);
+  scf::ForOp newForOp = rebuildLoop(forOp, kept, bases);
+  Block *body = newForOp.getBody();
+  yield = body->getTerminator();
+  SmallVector<Value> yields(yield->getOperands());
+  for (auto it : llvm::enumerate(reduced)) {
+    unsigned i = it.value();
+    Value iterArg = newForOp.getRegionIterArgs()[i];
+    Value base = newForOp.getRegionIterArgs()[numArgs + it.index()];
+    Value offset = offsets[it.index()];
+    Type type = iterArg.getType();
+    Location loc = iterArg.getLoc();
+    auto next = yield->getOperand(i).getDefiningOp<triton::AddPtrOp>();
+    builder.setInsertionPoint(yield);
+    yields.push_back(builder.create<triton::AddPtrOp>(
+        loc, base.getType(), base, getSplatScalar(builder, next.offset())));
+    builder.setInsertionPointToStart(body);
+    Value ptr = builder.create<triton::AddPtrOp>(
+        loc, type, builder.create<triton::SplatOp>(loc, type, base), offset);
+    iterArg.replaceAllUsesWith(ptr);
+    Value result = newForOp.getResult(i);
+    if (!result.use_empty()) {
+      builder.setInsertionPointAfter(newForOp);
+      Value finalBase = newForOp.getResult(numArgs + it.index());
+      result.replaceAllUsesWith(builder.create<triton::AddPtrOp>(
+          loc, type, builder.create<triton::SplatOp>(loc, type, finalBase),
+          offset));
+    }
+  }
+  yield->setOperands(yields);
+  return newForOp;
+}
+
+// Removes the iter args whose values neither reach a side effect nor a use
+// after the loop, along with the computation of their next values
+scf::ForOp eliminateDeadIterArgs(scf::ForOp forOp) {
+  Block *body = forOp.getBody();
+  Operation *yield = body->getTerminator();
+  unsigned numArgs = forOp.getNumRegionIterArgs();
+  SmallVector<bool> live(numArgs);
+  SmallVector<Value> worklist;
+  DenseSet<Operation *> needed;
+  auto markNeeded = [&](Operation *op) {
+    if (!needed.insert(op).second)
+      return;
+    op->walk([&](Operation *nested) {
+      worklist.append(nested->operand_begin(), nested->operand_end());
+    });
+  };
+  for (unsigned i = 0; i < numArgs; ++i)
+    if (!forOp.getResult(i).use_empty()) {
+      live[i] = true;
+      worklist.push_back(yield->getOperand(i));
+    }
+  for (Operation &op : body->without_terminator())
+    if (!wouldOpBeTriviallyDead(&op))
+      markNeeded(&op);
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    if (auto arg = value.dyn_cast<BlockArgument>()) {
+      if (arg.getOwner() != body || arg.getArgNumber() == 0)
+        continue;
+      unsigned i = arg.getArgNumber() - 1;
+      if (!live[i]) {
+        live[i] = true;
+        worklist.push_back(yield->getOperand(i));
+      }
+      continue;
+    }
+    if (Operation *op = body->findAncestorOpInBlock(*value.getDefiningOp()))
+      if (op != yield)
+        markNeeded(op);
+  }
+  if (llvm::all_of(live, [](bool isLive) { return isLive; }))
+    return forOp;
+  // the dead iter args yield themselves, which leaves the computation of
+  // their next values unused
+  for (unsigned i = 0; i < numArgs; ++i)
+    if (!live[i])
+      yield->setOperand(i, forOp.getRegionIterArgs()[i]);
+  for (Operation &op :
+       llvm::make_early_inc_range(llvm::reverse(body->without_terminator())))
+    if (!needed.count(&op))
+      op.erase();
+  SmallVector<unsigned> kept;
+  for (unsigned i = 0; i < numArgs; ++i)
+    if (live[i])
+      kept.push_back(i);
+  return rebuildLoop(forOp, kept, {});
+}
+
 struct CanonicalizePass
     : public TritonGPUCanonicalizeLoopsBase<CanonicalizePass> {
   CanonicalizePass() = default;
 
   void runOnOperation() override {
-
-    // Canonicalize pass may have created dead code that
-    // standard scf.for canonicalization cannot handle
-    // as of LLVM 14. For example, the iteration arguments
-    // for the pointer of the synchronous loads that are
-    // discarded.
-    // The following piece of code is a workaround to
-    // very crudely remove dead code, by making an iteration
-    // argument yield itself if it is not used to create
-    // side effects anywhere.
-    getOperation()->walk([&](scf::ForOp forOp) -> void {
-      for (size_t i = 0; i < forOp.getNumResults(); ++i) {
-        // condition 1: no other iter arguments depend on it
-        SetVector<Operation *> fwdSlice;
-        mlir::getForwardSlice(forOp.getRegionIterArgs()[i], &fwdSlice);
-        Operation *yieldOp = forOp.getBody()->getTerminator();
-        bool noOtherDependency = std::all_of(
-            yieldOp->operand_begin(), yieldOp->operand_end(), [&](Value arg) {
-              return arg == yieldOp->getOperand(i) ||
-                     !fwdSlice.contains(arg.getDefiningOp());
-            });
-        // condition 2: final value is not used after the loop
-        auto retVal = forOp.getResult(i);
-        bool noUserAfterLoop = retVal.getUsers().empty();
-        // yielding the region iter arg will cause loop canonicalization
-        // to clean up the dead code
-        if (noOtherDependency && noUserAfterLoop) {
-          yieldOp->setOperand(i, forOp.getRegionIterArgs()[i]);
-        }
-      }
-    });
+    // the inner loops are rewritten first, so that the outer loops see
+    // which of their values they still use
+    SmallVector<scf::ForOp> forOps;
+    getOperation()->walk([&](scf::ForOp forOp) { forOps.push_back(forOp); });
+    for (scf::ForOp forOp : forOps)
+      eliminateDeadIterArgs(strengthReducePointers(forOp));
   }
 };
 } // anonymous namespace
 
 std::unique_ptr<Pass> mlir::createTritonGPUCanonicalizeLoopsPass() {
   return std::make_unique<CanonicalizePass>();
-}
\ No newline at end of file
+}
@@ -1,76 +1,324 @@
+#include "mlir/Analysis/SliceAnalysis.h"
 #include "triton/Analysis/AxisInfo.h"
 #include "triton/Analysis/Utility.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include <limits>
 #include <numeric>
 
+#include "Utility.h"
+
 using namespace mlir;
 using namespace mlir::triton;
 
 #define GEN_PASS_CLASSES
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
+//===----------------------------------------------------------------------===//
+//
+// Loads and stores that share their index computations, or that exchange data,
+// are coalesced together: each group of them is given the blocked layout that
+// minimizes the number of global memory transactions of the whole group, unless
+// the transactions saved by letting each operation pick its own layout pay for
+// the layout conversions between them. Threads may hold several elements along
+// two axes, so that e.g. the load and the store of a transposition can both be
+// vectorized within a single layout.
+//
+// Transactions are estimated statically from the axis analysis, by simulating
+// the accesses of the first warp: every instruction costs an issue slot and
+// one unit per 32-byte sector it touches.
+//
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+constexpr unsigned kGlobalIssueCost = 1;
+constexpr unsigned kSectorBytes = 32;
+
+// What the axis analysis knows about the pointers of a memory operation
+struct MemAccessInfo {
+  Operation *op;
+  Value ptr;
+  Value mask;
+  // Axes in decreasing order of contiguity
+  SmallVector<unsigned, 4> order;
+  SmallVector<unsigned, 4> contiguity;
+  SmallVector<unsigned, 4> alignment;
+  unsigned numBits;
+  // Elements accessed by each thread along order[0] in its own layout
+  unsigned perThread;
+};
+
+} // namespace
+
 struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
-  Attribute getCoalescedEncoding(AxisInfoAnalysis &axisInfo, Value ptr,
-                                 int numWarps) {
+  MemAccessInfo getMemAccessInfo(AxisInfoAnalysis &axisInfo, Operation *op,
+                                 Value ptr, Value mask, int numWarps) {
     auto origType = ptr.getType().cast<RankedTensorType>();
     // Get the shape of the tensor.
     size_t rank = origType.getRank();
     AxisInfo info = axisInfo.lookupLatticeElement(ptr)->getValue();
+    MemAccessInfo access{op, ptr, mask};
+    for (unsigned d = 0; d < rank; ++d) {
+      access.contiguity.push_back(info.getContiguity(d));
+      access.alignment.push_back(
+          std::min(info.getDivisibility(d), info.getContiguity(d)));
+    }
     // Layout order in decreasing order of contiguity
-    SmallVector<unsigned, 4> order(rank);
-    std::iota(order.begin(), order.end(), 0);
-    auto contiguity = info.getContiguity();
-    std::sort(order.begin(), order.end(), [&](unsigned x, unsigned y) {
-      return contiguity[x] > contiguity[y];
-    });
+    access.order.resize(rank);
+    std::iota(access.order.begin(), access.order.end(), 0);
+    std::sort(access.order.begin(), access.order.end(),
+              [&](unsigned x, unsigned y) {
+                return access.contiguity[x] > access.contiguity[y];
+              });
 
     int numElems = product(origType.getShape());
-    int numThreads = numWarps * 32;
+    int numThreads = numWarps * threadsPerWarp;
     int numElemsPerThread = std::max(numElems / numThreads, 1);
 
     // Thread tile size depends on memory alignment
-    SmallVector<unsigned, 4> sizePerThread(rank, 1);
     PointerType ptrType = origType.getElementType().cast<PointerType>();
     auto pointeeType = ptrType.getPointeeType();
-    unsigned numBits = pointeeType.isa<triton::Float8Type>()
-                           ? 8
-                           : pointeeType.getIntOrFloatBitWidth();
-    unsigned maxMultiple = info.getDivisibility(order[0]);
-    unsigned maxContig = info.getContiguity(order[0]);
-    unsigned alignment = std::min(maxMultiple, maxContig);
-    unsigned perThread = std::min(alignment, 128 / numBits);
-    sizePerThread[order[0]] = std::min<int>(perThread, numElemsPerThread);
-
-    SmallVector<unsigned> dims(rank);
-    std::iota(dims.begin(), dims.end(), 0);
+    access.numBits = triton::getIntOrFloatBitWidth(pointeeType);
+    unsigned perThread =
+        std::min(access.alignment[access.order[0]], 128 / access.numBits);
+    access.perThread = std::min<int>(perThread, numElemsPerThread);
+    return access;
+  }
+
+  Attribute getCoalescedEncoding(const MemAccessInfo &access, int numWarps) {
+    auto origType = access.ptr.getType().cast<RankedTensorType>();
+    SmallVector<unsigned, 4> sizePerThread(origType.getRank(), 1);
+    sizePerThread[access.order[0]] = access.perThread;
     // create encoding
-    Attribute encoding = triton::gpu::BlockedEncodingAttr::get(
-        &getContext(), origType.getShape(), sizePerThread, order, numWarps);
-    return encoding;
+    return triton::gpu::BlockedEncodingAttr::get(
+        &getContext(), origType.getShape(), sizePerThread, access.order,
+        numWarps, threadsPerWarp);
   }
 
-  std::function<Type(Type)> getTypeConverter(AxisInfoAnalysis &axisInfo,
-                                             Value ptr, int numWarps) {
-    Attribute encoding = getCoalescedEncoding(axisInfo, ptr, numWarps);
-    return [encoding](Type _type) {
-      RankedTensorType type = _type.cast<RankedTensorType>();
-      return RankedTensorType::get(type.getShape(), type.getElementType(),
-                                   encoding);
+  // Returns the layout in which each thread holds the vectors of `first`
+  // along its contiguous axis, and as many of them as possible to form the
+  // vectors of `second` along its own contiguous axis.
+  Attribute getCombinedEncoding(const MemAccessInfo &first,
+                                const MemAccessInfo &second, int numWarps) {
+    auto origType = first.ptr.getType().cast<RankedTensorType>();
+    unsigned rank = origType.getRank();
+    int numThreads = numWarps * threadsPerWarp;
+    int numElemsPerThread =
+        std::max<int>(product(origType.getShape()) / numThreads, 1);
+    unsigned firstAxis = first.order[0];
+    unsigned secondAxis = second.order[0];
+    SmallVector<unsigned, 4> sizePerThread(rank, 1);
+    sizePerThread[firstAxis] = first.perThread;
+    int remaining = std::max<int>(numElemsPerThread / first.perThread, 1);
+    sizePerThread[secondAxis] = std::min<int>(second.perThread, remaining);
+    SmallVector<unsigned, 4> order{firstAxis, secondAxis};
+    for (unsigned d : first.order)
+      if (d != firstAxis && d != secondAxis)
+        order.push_back(d);
+    return triton::gpu::BlockedEncodingAttr::get(&getContext(),
+                                                 origType.getShape(),
+                                                 sizePerThread, order,
+                                                 numWarps, threadsPerWarp);
+  }
+
+  // Returns the estimated cost of the global memory transactions of `access`
+  // in `encoding`. The accesses are vectorized the way the lowering does it,
+  // along the axis of the widest vectors.
+  unsigned getTransactionCost(AxisInfoAnalysis &axisInfo,
+                              const MemAccessInfo &access, Attribute encoding) {
+    auto layout = encoding.cast<triton::gpu::BlockedEncodingAttr>();
+    auto shape = access.ptr.getType().cast<RankedTensorType>().getShape();
+    unsigned rank = shape.size();
+    SmallVector<unsigned> sizePerThread(layout.getSizePerThread().begin(),
+                                        layout.getSizePerThread().end());
+    SmallVector<unsigned> lanesPerWarp(layout.getThreadsPerWarp().begin(),
+                                       layout.getThreadsPerWarp().end());
+    SmallVector<unsigned> order(layout.getOrder().begin(),
+                                layout.getOrder().end());
+    SmallVector<unsigned> shapePerCTA(rank), tiles(rank), wrap(rank);
+    for (unsigned d = 0; d < rank; ++d) {
+      shapePerCTA[d] =
+          sizePerThread[d] * lanesPerWarp[d] * layout.getWarpsPerCTA()[d];
+      tiles[d] = ceil<unsigned>(shape[d], shapePerCTA[d]);
+      wrap[d] = ceil<unsigned>(shape[d], sizePerThread[d]);
+    }
+    unsigned tileSize = product<unsigned>(sizePerThread);
+    unsigned numElems = tileSize * product<unsigned>(tiles);
+
+    auto load = dyn_cast<triton::LoadOp>(access.op);
+    bool ragged = load && load.ragged();
+    auto getAxisVectorSize = [&](unsigned axis) {
+      unsigned size = std::min<unsigned>(
+          {access.alignment[axis], sizePerThread[axis],
+           static_cast<unsigned>(shape[axis])});
+      if (access.mask)
+        size = std::min(
+            size, ragged ? axisInfo.getRaggedMaskAlignment(access.mask, axis)
+                         : axisInfo.getMaskAlignment(access.mask, axis));
+      return size;
     };
+    unsigned axis = order[0];
+    unsigned vec = getAxisVectorSize(axis);
+    for (unsigned d : order) {
+      unsigned size = getAxisVectorSize(d);
+      if (size > vec) {
+        axis = d;
+        vec = size;
+      }
+    }
+    vec = std::min(vec, std::max(128 / access.numBits, 1u));
+    SmallVector<unsigned> tileOrder{axis};
+    for (unsigned d : order)
+      if (d != axis)
+        tileOrder.push_back(d);
+
+    // Elements are contiguous in memory by runs along the most contiguous
+    // axis of the pointers; runs are assumed to be scattered otherwise.
+    unsigned contigAxis = access.order[0];
+    unsigned contig = access.contiguity[contigAxis];
+    unsigned elemBytes = std::max(access.numBits / 8, 1u);
+    unsigned sectorsPerRun = ceil<unsigned>(contig * elemBytes, kSectorBytes);
+    unsigned cost = 0;
+    for (unsigned start = 0; start < numElems; start += vec) {
+      llvm::DenseSet<int64_t> sectors;
+      for (unsigned lane = 0; lane < product<unsigned>(lanesPerWarp); ++lane) {
+        auto laneId = delinearize(lane, lanesPerWarp, order);
+        for (unsigned i = start; i < std::min(start + vec, numElems); ++i) {
+          auto tileId = delinearize(i / tileSize, tiles, order);
+          auto elemId = delinearize(i % tileSize, sizePerThread, tileOrder);
+          int64_t key = 0;
+          for (unsigned d = 0; d < rank; ++d) {
+            int64_t coord = (tileId[d] * shapePerCTA[d] +
+                             laneId[d] % wrap[d] * sizePerThread[d] +
+                             elemId[d]) %
+                            shape[d];
+            int64_t extent = shape[d];
+            if (d == contigAxis) {
+              coord = coord / contig * sectorsPerRun +
+                      coord % contig * elemBytes / kSectorBytes;
+              extent = ceil<int64_t>(shape[d], contig) * sectorsPerRun;
+            }
+            key = key * extent + coord;
+          }
+          sectors.insert(key);
+        }
+      }
+      cost += kGlobalIssueCost + sectors.size();
+    }
+    return cost;
   }
 
-  template <class T>
-  void coalesceOp(AxisInfoAnalysis &axisInfo, Operation *op, Value ptr,
-                  OpBuilder builder) {
-    RankedTensorType ty = ptr.getType().template dyn_cast<RankedTensorType>();
-    if (!ty)
+  // Groups the memory operations whose layouts are best chosen together:
+  // those with the same shape that share index computations, or whose
+  // operands depend on the result of the other.
+  SmallVector<SmallVector<unsigned>>
+  getGroups(ArrayRef<MemAccessInfo> accesses) {
+    // Constants, splats and ranges are cheap to rematerialize in any layout,
+    // and the slices stop at loops and functions
+    auto isShared = [](Operation *op) {
+      return op->getNumRegions() == 0 &&
+             !isa<arith::ConstantOp, triton::SplatOp, triton::MakeRangeOp>(op);
+    };
+    SmallVector<SetVector<Operation *>> slices;
+    for (const MemAccessInfo &access : accesses) {
+      SetVector<Operation *> slice;
+      getBackwardSlice(access.op, &slice, isShared);
+      if (isa<triton::LoadOp>(access.op))
+        slice.insert(access.op);
+      slices.push_back(slice);
+    }
+    llvm::EquivalenceClasses<unsigned> classes;
+    for (unsigned i = 0; i < accesses.size(); ++i) {
+      classes.insert(i);
+      auto shape =
+          accesses[i].ptr.getType().cast<RankedTensorType>().getShape();
+      for (unsigned j = 0; j < i; ++j) {
+        if (accesses[j].ptr.getType().cast<RankedTensorType>().getShape() !=
+            shape)
+          continue;
+        if (llvm::any_of(slices[i],
+                         [&](Operation *op) { return slices[j].count(op); }))
+          classes.unionSets(i, j);
+      }
+    }
+    SmallVector<SmallVector<unsigned>> groups;
+    for (auto it = classes.begin(); it != classes.end(); ++it) {
+      if (!it->isLeader())
+        continue;
+      SmallVector<unsigned> group(classes.member_begin(it),
+                                  classes.member_end());
+      llvm::sort(group);
+      groups.push_back(group);
+    }
+    llvm::sort(groups, [](ArrayRef<unsigned> lhs, ArrayRef<unsigned> rhs) {
+      return lhs.front() < rhs.front();
+    });
+    return groups;
+  }
+
+  // Assigns a layout to each of the operations of `group`
+  void assignEncodings(AxisInfoAnalysis &axisInfo,
+                       ArrayRef<MemAccessInfo> accesses,
+                       ArrayRef<unsigned> group, int numWarps,
+                       SmallVectorImpl<Attribute> &encodings) {
+    // Cost of letting each operation pick its own layout, plus the conversion
+    // of their values to a common layout
+    unsigned separateCost = 0;
+    SmallVector<Attribute> candidates;
+    for (unsigned i : group) {
+      encodings[i] = getCoalescedEncoding(accesses[i], numWarps);
+      separateCost += getTransactionCost(axisInfo, accesses[i], encodings[i]);
+      if (encodings[i] != encodings[group.front()]) {
+        auto ptrType = accesses[i].ptr.getType().cast<RankedTensorType>();
+        auto valueType = RankedTensorType::get(
+            ptrType.getShape(),
+            ptrType.getElementType().cast<PointerType>().getPointeeType(),
+            encodings[i]);
+        separateCost +=
+            getLayoutConversionCost(valueType, encodings[group.front()]);
+      }
+      if (!llvm::is_contained(candidates, encodings[i]))
+        candidates.push_back(encodings[i]);
+    }
+    if (candidates.size() == 1)
       return;
-    auto mod = op->getParentOfType<ModuleOp>();
-    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    // Layouts vectorizing the accesses of two operations along different axes
+    for (unsigned i : group)
+      for (unsigned j : group) {
+        if (accesses[i].order[0] == accesses[j].order[0])
+          continue;
+        auto encoding =
+            getCombinedEncoding(accesses[i], accesses[j], numWarps);
+        if (!llvm::is_contained(candidates, encoding))
+          candidates.push_back(encoding);
+      }
+    Attribute best;
+    unsigned bestCost = std::numeric_limits<unsigned>::max();
+    for (Attribute encoding : candidates) {
+      unsigned cost = 0;
+      for (unsigned i : group)
+        cost += getTransactionCost(axisInfo, accesses[i], encoding);
+      if (cost < bestCost) {
+        best = encoding;
+        bestCost = cost;
+      }
+    }
+    if (bestCost > separateCost)
+      return;
+    for (unsigned i : group)
+      encodings[i] = best;
+  }
 
-    AxisInfo info = axisInfo.lookupLatticeElement(ptr)->getValue();
-    auto convertType = getTypeConverter(axisInfo, ptr, numWarps);
+  template <class T>
+  void coalesceOp(Attribute encoding, Operation *op, OpBuilder builder) {
+    auto convertType = [encoding](Type _type) {
+      RankedTensorType type = _type.cast<RankedTensorType>();
+      return RankedTensorType::get(type.getShape(), type.getElementType(),
+                                   encoding);
+    };
     // convert operands
     SmallVector<Value, 4> newArgs;
     for (auto v : op->getOperands()) {
@@ -104,11 +352,58 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
 
   void runOnOperation() override {
     Operation *op = getOperation();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(getOperation());
+    threadsPerWarp =
+        triton::gpu::TritonGPUDialect::getThreadsPerWarp(getOperation());
     // Run axis info analysis
     AxisInfoAnalysis axisInfo(&getContext());
     axisInfo.run(op);
     OpBuilder builder(op);
 
+    // Masks that are provably all-true would only limit the vectorization
+    op->walk([&](Operation *curr) {
+      if (auto load = dyn_cast<triton::LoadOp>(curr)) {
+        if (load.mask() && axisInfo.isMaskAlwaysTrue(load.mask())) {
+          load.maskMutable().clear();
+          load.otherMutable().clear();
+        }
+      }
+      if (auto store = dyn_cast<triton::StoreOp>(curr))
+        if (store.mask() && axisInfo.isMaskAlwaysTrue(store.mask()))
+          store.maskMutable().clear();
+    });
+
+    // Loads and stores are coalesced by groups, other memory ops on their own
+    SmallVector<MemAccessInfo> accesses;
+    op->walk([&](Operation *curr) {
+      Value ptr, mask;
+      if (auto load = dyn_cast<triton::LoadOp>(curr)) {
+        ptr = load.ptr();
+        mask = load.mask();
+      } else if (auto store = dyn_cast<triton::StoreOp>(curr)) {
+        ptr = store.ptr();
+        mask = store.mask();
+      }
+      if (ptr && ptr.getType().isa<RankedTensorType>())
+        accesses.push_back(
+            getMemAccessInfo(axisInfo, curr, ptr, mask, numWarps));
+    });
+    SmallVector<Attribute> encodings(accesses.size());
+    for (auto &group : getGroups(accesses))
+      assignEncodings(axisInfo, accesses, group, numWarps, encodings);
+    DenseMap<Operation *, Attribute> groupEncodings;
+    for (unsigned i = 0; i < accesses.size(); ++i)
+      groupEncodings[accesses[i].op] = encodings[i];
+
+    auto getEncoding = [&](Operation *curr, Value ptr) -> Attribute {
+      if (!ptr.getType().isa<RankedTensorType>())
+        return {};
+      if (Attribute encoding = groupEncodings.lookup(curr))
+        return encoding;
+      return getCoalescedEncoding(
+          getMemAccessInfo(axisInfo, curr, ptr, Value(), numWarps), numWarps);
+    };
+
     // For each memory op that has a layout L1:
     // 1. Create a coalesced memory layout L2 of the pointer operands
     // 2. Convert all operands from layout L1 to layout L2
@@ -119,19 +414,29 @@ struct CoalescePass : public TritonGPUCoalesceBase<CoalescePass> {
     op->walk([&](Operation *curr) {
       OpBuilder::InsertionGuard g(builder);
       builder.setInsertionPoint(curr);
-      if (auto load = dyn_cast<triton::LoadOp>(curr))
-        coalesceOp<triton::LoadOp>(axisInfo, curr, load.ptr(), builder);
-      if (auto op = dyn_cast<triton::AtomicRMWOp>(curr))
-        coalesceOp<triton::AtomicRMWOp>(axisInfo, curr, op.ptr(), builder);
-      if (auto op = dyn_cast<triton::AtomicCASOp>(curr))
-        coalesceOp<triton::AtomicCASOp>(axisInfo, curr, op.ptr(), builder);
-      if (auto load = dyn_cast<triton::gpu::InsertSliceAsyncOp>(curr))
-        coalesceOp<triton::gpu::InsertSliceAsyncOp>(axisInfo, curr, load.src(),
-                                                    builder);
-      if (auto store = dyn_cast<triton::StoreOp>(curr))
-        coalesceOp<triton::StoreOp>(axisInfo, curr, store.ptr(), builder);
+      Attribute encoding;
+      if (auto load = dyn_cast<triton::LoadOp>(curr)) {
+        if ((encoding = getEncoding(curr, load.ptr())))
+          coalesceOp<triton::LoadOp>(encoding, curr, builder);
+      } else if (auto op = dyn_cast<triton::AtomicRMWOp>(curr)) {
+        if ((encoding = getEncoding(curr, op.ptr())))
+          coalesceOp<triton::AtomicRMWOp>(encoding, curr, builder);
+      } else if (auto op = dyn_cast<triton::AtomicCASOp>(curr)) {
+        if ((encoding = getEncoding(curr, op.ptr())))
+          coalesceOp<triton::AtomicCASOp>(encoding, curr, builder);
+      } else if (auto load = dyn_cast<triton::gpu::InsertSliceAsyncOp>(curr)) {
+        if ((encoding = getEncoding(curr, load.src())))
+          coalesceOp<triton::gpu::InsertSliceAsyncOp>(encoding, curr, builder);
+      } else if (auto store = dyn_cast<triton::StoreOp>(curr)) {
+        if ((encoding = getEncoding(curr, store.ptr())))
+          coalesceOp<triton::StoreOp>(encoding, curr, builder);
+      }
     });
   }
+
+private:
+  // Lanes of the warps of the module
+  unsigned threadsPerWarp = 32;
 };
 
 std::unique_ptr<Pass> mlir::createTritonGPUCoalescePass() {
@@ -63,17 +63,38 @@ public:
           !dstParent.isa<triton::gpu::MmaEncodingAttr>())
         return mlir::failure();
       auto dstParentMma = dstParent.cast<triton::gpu::MmaEncodingAttr>();
-      if (dstParentMma.isVolta() || dstParentMma.getWarpsPerCTA()[1] > 1)
+      if (dstParentMma.isVolta())
         return mlir::failure();
       SetVector<Operation *> bwdSlices;
       mlir::getBackwardSlice(convert.getResult(), &bwdSlices);
-      if (llvm::find_if(bwdSlices, [](Operation *op) {
-            return isa<triton::DotOp>(op);
-          }) == bwdSlices.end())
+      // Convert through the accumulator layout of a dot the operand is
+      // computed from (or else of the dot using it) when that layout converts
+      // to the operand in registers: the conversion from the blocked layout
+      // then likely cancels out with the one of the accumulators
+      auto getMmaType = [&](Attribute encoding) {
+        return RankedTensorType::get(dstType.getShape(),
+                                     dstType.getElementType(), encoding);
+      };
+      RankedTensorType tmpType;
+      bool hasDot = false;
+      for (Operation *sliceOp : bwdSlices) {
+        auto dotOp = dyn_cast<triton::DotOp>(sliceOp);
+        if (!dotOp)
+          continue;
+        hasDot = true;
+        auto dotType = dotOp.getResult().getType().cast<RankedTensorType>();
+        auto type = getMmaType(dotType.getEncoding());
+        if (isMmaToDotShortcut(type, dstType)) {
+          tmpType = type;
+          break;
+        }
+      }
+      if (!tmpType && hasDot &&
+          isMmaToDotShortcut(getMmaType(dstParentMma), dstType))
+        tmpType = getMmaType(dstParentMma);
+      if (!tmpType)
         return mlir::failure();
 
-      auto tmpType = RankedTensorType::get(
-          dstType.getShape(), dstType.getElementType(), dstParentMma);
       auto tmp = rewriter.create<triton::gpu::ConvertLayoutOp>(
           convert.getLoc(), tmpType, convert.getOperand());
       auto newConvert = rewriter.create<triton::gpu::ConvertLayoutOp>(
@@ -271,7 +292,7 @@ LogicalResult invertEncoding(Attribute targetEncoding, Operation *op,
     ret = triton::gpu::SliceEncodingAttr::get(
         op->getContext(), expand_dims.axis(), targetEncoding);
   }
-  if (auto reduce = dyn_cast<triton::ReduceOp>(op)) {
+  if (isa<triton::ReduceOp, triton::GenericReduceOp>(op)) {
     auto sliceEncoding =
         targetEncoding.dyn_cast<triton::gpu::SliceEncodingAttr>();
     if (!sliceEncoding)
@@ -288,7 +309,7 @@ LogicalResult getForwardEncoding(Attribute sourceEncoding, Operation *op,
     ret = sourceEncoding;
     return success();
   }
-  if (isa<triton::ReduceOp>(op)) {
+  if (isa<triton::ReduceOp, triton::GenericReduceOp>(op)) {
     ret = Attribute();
     return success();
   }
@@ -299,8 +320,10 @@ inline bool expensive_to_remat(Operation *op) {
   if (!op)
     return true;
   if (isa<tensor::ExtractSliceOp, triton::gpu::AllocTensorOp,
-          triton::gpu::InsertSliceAsyncOp, triton::LoadOp, triton::StoreOp,
-          triton::AtomicRMWOp, triton::AtomicCASOp, triton::DotOp>(op))
+          triton::gpu::InsertSliceAsyncOp, triton::gpu::InsertSliceTMAOp,
+          triton::LoadOp, triton::StoreOp, triton::AtomicRMWOp,
+          triton::AtomicCASOp, triton::DotOp, triton::ScanOp,
+          triton::SortOp>(op))
     return true;
   if (isa<scf::YieldOp, scf::ForOp>(op))
     return true;
@@ -482,7 +505,7 @@ public:
     SetVector<Operation *> cvtSlices;
     auto filter = [&](Operation *op) {
       return op->getBlock() == cvt->getBlock() &&
-             !(isa<triton::ReduceOp>(op) &&
+             !(isa<triton::ReduceOp, triton::GenericReduceOp>(op) &&
                !op->getResult(0).getType().isa<RankedTensorType>()) &&
              !isa<triton::gpu::ConvertLayoutOp>(op) && !isa<scf::YieldOp>(op);
     };
@@ -868,7 +891,6 @@ int computeCapabilityToMMAVersion(int computeCapability) {
   } else if (computeCapability < 90) {
     return 2;
   } else {
-    assert(false && "computeCapability > 90 not supported");
     return 3;
   }
 }
@@ -884,20 +906,57 @@ SmallVector<int64_t, 2> mmaVersionToShapePerWarp(int version) {
   }
 }
 
+// The warps of MMAv1 tile the sizes covered by a warp, which depend on the
+// rows and vec4 of its operands, see
+// https://github.com/openai/triton/blob/0e4691e6dd91e001a8d33b71badf8b3314325459/lib/codegen/analysis/layout.cc#L223
 SmallVector<unsigned, 2> warpsPerTileV1(const ArrayRef<int64_t> shape,
-                                        int numWarps) {
-  // Set a default value and ensure product of wpt equals numWarps
-  return {static_cast<unsigned>(numWarps), 1};
+                                        bool isARow, bool isBRow, bool isAVec4,
+                                        bool isBVec4, int numWarps) {
+  SmallVector<unsigned, 2> wpt({1, 1});
+  SmallVector<unsigned, 2> prevWpt;
+  std::array<int, 2> fpw{{2, 2}};
+  int packSize0 = (isARow || isAVec4) ? 1 : 2;
+  int packSize1 = (isBRow && !isBVec4) ? 2 : 1;
+  std::array<int, 2> spw{{fpw[0] * 4 * 2 * packSize0,
+                          fpw[1] * 4 * 2 * packSize1}};
+  do {
+    prevWpt = wpt;
+    if (wpt[0] * wpt[1] < numWarps)
+      wpt[0] = std::clamp<int>(wpt[0] * 2, 1, shape[0] / spw[0]);
+    if (wpt[0] * wpt[1] < numWarps)
+      wpt[1] = std::clamp<int>(wpt[1] * 2, 1, shape[1] / spw[1]);
+  } while (prevWpt != wpt);
+  return wpt;
+}
+
+// The mma layout of a Volta dot records the rows of its operands, and the
+// vec4 and warps they imply
+triton::gpu::MmaEncodingAttr
+getMmaV1Encoding(MLIRContext *context, ArrayRef<int64_t> shape,
+                 ArrayRef<int64_t> shapeA, ArrayRef<int64_t> shapeB,
+                 bool isARow, bool isBRow, int numWarps, int id) {
+  bool isAVec4 = !isARow && shapeA[isARow] <= 16;
+  bool isBVec4 = isBRow && shapeB[isBRow] <= 16;
+  auto wpt =
+      warpsPerTileV1(shape, isARow, isBRow, isAVec4, isBVec4, numWarps);
+  return triton::gpu::MmaEncodingAttr::get(context, 1, wpt, shapeA, shapeB,
+                                           isARow, isBRow, id);
 }
 
 SmallVector<unsigned, 2> warpsPerTileV2(triton::DotOp dotOp,
                                         const ArrayRef<int64_t> shape,
                                         int numWarps) {
+  // Chained dots keep all their warps along M, so that the accumulators of
+  // the first one are the $a operand of the second one in registers (see
+  // isMmaToDotShortcut)
+  auto isDot = [](Operation *op) { return isa<triton::DotOp>(op); };
   SetVector<Operation *> slices;
   mlir::getForwardSlice(dotOp.getResult(), &slices);
-  if (llvm::find_if(slices, [](Operation *op) {
-        return isa<triton::DotOp>(op);
-      }) != slices.end())
+  if (llvm::any_of(slices, isDot))
+    return {(unsigned)numWarps, 1};
+  slices.clear();
+  mlir::getBackwardSlice(dotOp.a(), &slices);
+  if (llvm::any_of(slices, isDot))
     return {(unsigned)numWarps, 1};
 
   SmallVector<unsigned, 2> ret = {1, 1};
@@ -1035,16 +1094,52 @@ public:
                                                   const ArrayRef<int64_t> shape,
                                                   int version, int numWarps) {
     switch (version) {
-    case 1:
-      return warpsPerTileV1(shape, numWarps);
     case 2:
       return warpsPerTileV2(dotOp, shape, numWarps);
+    case 3:
+      // warpgroups are stacked along M
+      return {(unsigned)numWarps, 1};
     default:
       assert(false && "not supported version");
       return {0, 0};
     }
   }
 
+  // Converts a float8 or int8 operand to `elemTy` in the layout it is
+  // converted from, so that it is still loaded from global memory as 8-bit
+  // values
+  static Value upcastOperand(Value operand, Type elemTy,
+                             mlir::PatternRewriter &rewriter) {
+    auto loc = operand.getLoc();
+    auto cvt = operand.getDefiningOp<triton::gpu::ConvertLayoutOp>();
+    Value src = cvt ? cvt.src() : operand;
+    auto srcType = src.getType().cast<RankedTensorType>();
+    auto upcastType = RankedTensorType::get(srcType.getShape(), elemTy,
+                                            srcType.getEncoding());
+    Value upcast;
+    if (triton::isFloat8(srcType.getElementType()))
+      upcast = rewriter.create<triton::FpToFpOp>(loc, upcastType, src);
+    else
+      upcast = rewriter.create<arith::SIToFPOp>(loc, upcastType, src);
+    if (!cvt)
+      return upcast;
+    auto type = operand.getType().cast<RankedTensorType>();
+    return rewriter.create<triton::gpu::ConvertLayoutOp>(
+        loc, RankedTensorType::get(type.getShape(), elemTy, type.getEncoding()),
+        upcast);
+  }
+
+  // The tensor cores of sm_89 and later multiply E4M3 or E5M2 operands of
+  // the same format, 32 along K at a time
+  bool supportFloat8MMA(triton::DotOp dotOp) const {
+    auto AType = dotOp.a().getType().cast<RankedTensorType>();
+    auto BType = dotOp.b().getType().cast<RankedTensorType>();
+    Type elemTy = AType.getElementType();
+    return computeCapability >= 89 && elemTy == BType.getElementType() &&
+           elemTy.isa<triton::Float8E4M3Type, triton::Float8E5M2Type>() &&
+           AType.getShape()[1] % 32 == 0;
+  }
+
   mlir::LogicalResult
   matchAndRewrite(mlir::Operation *op,
                   mlir::PatternRewriter &rewriter) const override {
@@ -1058,10 +1153,34 @@ public:
     auto AType = dotOp.getOperand(0).getType().cast<RankedTensorType>();
     auto BType = dotOp.getOperand(1).getType().cast<RankedTensorType>();
 
-    // for FMA, should retain the blocked layout.
-    int versionMajor = computeCapabilityToMMAVersion(computeCapability);
-    if (!supportMMA(dotOp, versionMajor))
-      return failure();
+    // Other float8 dots are computed in f16
+    bool isAFloat8 = triton::isFloat8(AType.getElementType());
+    bool isBFloat8 = triton::isFloat8(BType.getElementType());
+    if ((isAFloat8 || isBFloat8) && !supportFloat8MMA(dotOp)) {
+      Type f16Ty = rewriter.getF16Type();
+      Value a =
+          isAFloat8 ? upcastOperand(dotOp.a(), f16Ty, rewriter) : dotOp.a();
+      Value b =
+          isBFloat8 ? upcastOperand(dotOp.b(), f16Ty, rewriter) : dotOp.b();
+      rewriter.replaceOpWithNewOp<triton::DotOp>(op, oldRetType, a, b,
+                                                 dotOp.c(), dotOp.allowTF32(),
+                                                 dotOp.tf32x3());
+      return success();
+    }
+
+    // Quantized weights are dequantized in registers after their shared
+    // memory load by mma.sync only: before sm_80, int8 weights are converted
+    // to the type of the activations once loaded
+    if (isWeightOnlyQuantizedDot(dotOp) &&
+        computeCapabilityToMMAVersion(computeCapability) < 2) {
+      if (isPackedInt4Dot(dotOp))
+        return op->emitError("dots on packed int4 weights require sm_80");
+      Value b = upcastOperand(dotOp.b(), AType.getElementType(), rewriter);
+      rewriter.replaceOpWithNewOp<triton::DotOp>(
+          op, oldRetType, dotOp.a(), b, dotOp.c(), dotOp.allowTF32(),
+          dotOp.tf32x3());
+      return success();
+    }
 
     auto AOrder = AType.getEncoding()
                       .cast<triton::gpu::DotOperandEncodingAttr>()
@@ -1073,24 +1192,36 @@ public:
                       .getParent()
                       .cast<triton::gpu::BlockedEncodingAttr>()
                       .getOrder();
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+
+    // Hopper falls back to mma.sync when wgmma cannot read the operands in
+    // place
+    int versionMajor = computeCapabilityToMMAVersion(computeCapability);
+    if (versionMajor == 3 && (!supportMMA(dotOp, versionMajor) ||
+                              !supportWGMMA(dotOp, AOrder, BOrder, numWarps)))
+      versionMajor = 2;
+    // for FMA, should retain the blocked layout.
+    if (!supportMMA(dotOp, versionMajor))
+      return failure();
 
     // get MMA encoding for the given number of warps
     auto retShape = oldRetType.getShape();
-    auto mod = op->getParentOfType<mlir::ModuleOp>();
-    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
 
-    auto warpsPerTile =
-        getWarpsPerTile(dotOp, retShape, versionMajor, numWarps);
     triton::gpu::MmaEncodingAttr mmaEnc;
     if (versionMajor == 1) {
-      mmaEnc = triton::gpu::MmaEncodingAttr::get(
-          oldRetType.getContext(), versionMajor, numWarps, mmaV1Counter++);
-    } else if (versionMajor == 2) {
+      mmaEnc = getMmaV1Encoding(oldRetType.getContext(), retShape,
+                                AType.getShape(), BType.getShape(),
+                                AOrder[0] == 1, BOrder[0] == 1, numWarps,
+                                mmaV1Counter++);
+    } else if (versionMajor == 2 || versionMajor == 3) {
+      auto warpsPerTile =
+          getWarpsPerTile(dotOp, retShape, versionMajor, numWarps);
       mmaEnc = triton::gpu::MmaEncodingAttr::get(
           oldRetType.getContext(), versionMajor, 0 /*versionMinor*/,
           warpsPerTile);
     } else {
-      assert(false && "Mma layout only support versionMajor of 1 or 2");
+      assert(false && "Mma layout only support versionMajor of 1, 2 or 3");
     }
     auto newRetType =
         RankedTensorType::get(retShape, oldRetType.getElementType(), mmaEnc);
@@ -1131,8 +1262,9 @@ public:
 
     a = rewriter.create<triton::gpu::ConvertLayoutOp>(a.getLoc(), newAType, a);
     b = rewriter.create<triton::gpu::ConvertLayoutOp>(b.getLoc(), newBType, b);
-    auto newDot = rewriter.create<triton::DotOp>(dotOp.getLoc(), newRetType, a,
-                                                 b, newAcc, dotOp.allowTF32());
+    auto newDot = rewriter.create<triton::DotOp>(
+        dotOp.getLoc(), newRetType, a, b, newAcc, dotOp.allowTF32(),
+        dotOp.tf32x3());
 
     rewriter.replaceOpWithNewOp<triton::gpu::ConvertLayoutOp>(
         op, oldRetType, newDot.getResult());
@@ -1140,6 +1272,78 @@ public:
   }
 };
 
+// The mma layout of a Volta dot depends on the rows of its operands. When
+// OptimizeConvertToDotOperand flips the row of an operand to the order it is
+// converted from, the dot is rebuilt in the layout of its new operands, and
+// the conversions of its accumulator and result are left to the other
+// patterns.
+class UpdateMmaV1Layout : public mlir::RewritePattern {
+public:
+  explicit UpdateMmaV1Layout(mlir::MLIRContext *context)
+      : mlir::RewritePattern(triton::DotOp::getOperationName(), 1, context) {}
+
+  static Value convertOperand(Value operand, Attribute mmaEnc,
+                              mlir::PatternRewriter &rewriter) {
+    auto type = operand.getType().cast<RankedTensorType>();
+    auto encoding =
+        type.getEncoding().cast<triton::gpu::DotOperandEncodingAttr>();
+    auto newType = RankedTensorType::get(
+        type.getShape(), type.getElementType(),
+        triton::gpu::DotOperandEncodingAttr::get(
+            rewriter.getContext(), encoding.getOpIdx(), mmaEnc,
+            encoding.getIsMMAv1Row()));
+    auto cvt = operand.getDefiningOp<triton::gpu::ConvertLayoutOp>();
+    return rewriter.create<triton::gpu::ConvertLayoutOp>(operand.getLoc(),
+                                                         newType, cvt.src());
+  }
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::Operation *op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto dotOp = cast<triton::DotOp>(op);
+    auto retType = dotOp.getResult().getType().cast<RankedTensorType>();
+    auto mmaEnc =
+        retType.getEncoding().dyn_cast_or_null<triton::gpu::MmaEncodingAttr>();
+    if (!mmaEnc || !mmaEnc.isVolta())
+      return failure();
+    // dot operands are converted from another layout until they are lowered
+    if (!dotOp.a().getDefiningOp<triton::gpu::ConvertLayoutOp>() ||
+        !dotOp.b().getDefiningOp<triton::gpu::ConvertLayoutOp>())
+      return failure();
+    auto AType = dotOp.a().getType().cast<RankedTensorType>();
+    auto BType = dotOp.b().getType().cast<RankedTensorType>();
+    auto isRow = [](RankedTensorType type) {
+      return type.getEncoding()
+          .cast<triton::gpu::DotOperandEncodingAttr>()
+          .getIsMMAv1Row()
+          .cast<BoolAttr>()
+          .getValue();
+    };
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    int numWarps = triton::gpu::TritonGPUDialect::getNumWarps(mod);
+    int id = std::get<4>(mmaEnc.decodeVoltaLayoutStates());
+    auto newMmaEnc =
+        getMmaV1Encoding(getContext(), retType.getShape(), AType.getShape(),
+                         BType.getShape(), isRow(AType), isRow(BType),
+                         numWarps, id);
+    if (newMmaEnc == mmaEnc)
+      return failure();
+
+    auto newRetType = RankedTensorType::get(
+        retType.getShape(), retType.getElementType(), newMmaEnc);
+    Value a = convertOperand(dotOp.a(), newMmaEnc, rewriter);
+    Value b = convertOperand(dotOp.b(), newMmaEnc, rewriter);
+    auto acc = rewriter.create<triton::gpu::ConvertLayoutOp>(
+        dotOp.c().getLoc(), newRetType, dotOp.c());
+    auto newDot = rewriter.create<triton::DotOp>(dotOp.getLoc(), newRetType, a,
+                                                 b, acc, dotOp.allowTF32(),
+                                                 dotOp.tf32x3());
+    rewriter.replaceOpWithNewOp<triton::gpu::ConvertLayoutOp>(
+        op, retType, newDot.getResult());
+    return success();
+  }
+};
+
 // Convert + trans + convert
 // x = convert_layout distributed -> #shared_x
 // y = trans x -> #shared_y
@@ -1235,7 +1439,7 @@ public:
         op->getLoc(), dotOp.getResult().getType(), _0f);
     auto newDot = rewriter.create<triton::DotOp>(
         op->getLoc(), dotOp.getResult().getType(), dotOp.getOperand(0),
-        dotOp.getOperand(1), _0, dotOp.allowTF32());
+        dotOp.getOperand(1), _0, dotOp.allowTF32(), dotOp.tf32x3());
     auto newCvt = rewriter.create<triton::gpu::ConvertLayoutOp>(
         op->getLoc(), dstTy, newDot.getResult());
     auto newAdd = rewriter.replaceOpWithNewOp<arith::AddFOp>(
@@ -1249,17 +1453,35 @@ public:
 #define GEN_PASS_CLASSES
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
 
+// Hash of the structure of the IR nested under `root`, which changes whenever
+// an operation is created, erased, or updated in place
+static llvm::hash_code getFingerprint(Operation *root) {
+  llvm::hash_code hash(0);
+  root->walk([&](Operation *op) {
+    hash = llvm::hash_combine(hash, op, op->getAttrDictionary());
+    for (Value operand : op->getOperands())
+      hash = llvm::hash_combine(hash, operand);
+    for (Type type : op->getResultTypes())
+      hash = llvm::hash_combine(hash, type);
+  });
+  return hash;
+}
+
+// Upper bound on the rounds of rewrites and cleanups, which converge in two or
+// three rounds in practice
+constexpr unsigned kMaxCleanupRounds = 8;
+
 class TritonGPUCombineOpsPass
     : public TritonGPUCombineOpsBase<TritonGPUCombineOpsPass> {
 public:
   TritonGPUCombineOpsPass() = default;
-  TritonGPUCombineOpsPass(int computeCapability) {
+  TritonGPUCombineOpsPass(int computeCapability, bool cleanup) {
     this->computeCapability = computeCapability;
+    this->cleanup = cleanup;
   }
-  void runOnOperation() override {
-    MLIRContext *context = &getContext();
-    ModuleOp m = getOperation();
 
+  // The patterns are built once for all the runs of the pass
+  LogicalResult initialize(MLIRContext *context) override {
     mlir::RewritePatternSet patterns(context);
 
     patterns.add<OptimizeBlockedToShared>(context);
@@ -1273,20 +1495,53 @@ public:
     patterns.add<MoveConvertOutOfLoop>(context);
     patterns.add<MoveConvertOutOfIf>(context);
     patterns.add<BlockedToMMA>(context, computeCapability);
+    patterns.add<UpdateMmaV1Layout>(context);
     patterns.add<ConvertTransConvert>(context);
     patterns.add<ConvertDotConvert>(context);
 
-    if (applyPatternsAndFoldGreedily(m, std::move(patterns)).failed()) {
-      signalPassFailure();
+    frozenPatterns = FrozenRewritePatternSet(std::move(patterns));
+    return success();
+  }
+
+  LogicalResult combine(ModuleOp m) {
+    if (applyPatternsAndFoldGreedily(m, frozenPatterns).failed())
+      return failure();
+    return fixupLoops(m);
+  }
+
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+
+    if (!cleanup) {
+      if (combine(m).failed())
+        signalPassFailure();
+      return;
     }
 
-    if (fixupLoops(m).failed()) {
-      signalPassFailure();
+    // The cleanups expose new rewrites (e.g., conversions hoisted out of
+    // loops), so both are repeated until the rewrites leave the IR unchanged.
+    // The cleanups reach their own fixed point, so they don't need to run
+    // again after a round without rewrites.
+    OpPassManager cleanupPipeline(ModuleOp::getOperationName());
+    cleanupPipeline.addPass(createCanonicalizerPass());
+    cleanupPipeline.addPass(createCSEPass());
+    cleanupPipeline.addPass(createLoopInvariantCodeMotionPass());
+    for (unsigned round = 0; round < kMaxCleanupRounds; ++round) {
+      llvm::hash_code before = getFingerprint(m);
+      if (combine(m).failed())
+        return signalPassFailure();
+      if (round > 0 && getFingerprint(m) == before)
+        return;
+      if (runPipeline(cleanupPipeline, m).failed())
+        return signalPassFailure();
     }
   }
+
+private:
+  FrozenRewritePatternSet frozenPatterns;
 };
 
 std::unique_ptr<Pass>
-mlir::createTritonGPUCombineOpsPass(int computeCapability) {
-  return std::make_unique<TritonGPUCombineOpsPass>(computeCapability);
+mlir::createTritonGPUCombineOpsPass(int computeCapability, bool cleanup) {
+  return std::make_unique<TritonGPUCombineOpsPass>(computeCapability, cleanup);
 }
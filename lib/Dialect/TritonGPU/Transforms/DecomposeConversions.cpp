@@ -21,6 +21,140 @@
 
 using namespace mlir;
 
+namespace {
+
+using triton::gpu::BlockedEncodingAttr;
+using triton::gpu::ConvertLayoutOp;
+using triton::gpu::DotOperandEncodingAttr;
+using triton::gpu::MmaEncodingAttr;
+using triton::gpu::SharedEncodingAttr;
+
+// Whether the conversion of a tensor of layout `srcEncoding` to `dstDotOp`
+// reads it from shared memory, rather than from the registers of an mma
+bool isLoadedFromShared(Attribute srcEncoding,
+                        DotOperandEncodingAttr dstDotOp) {
+  auto srcMma = srcEncoding.dyn_cast<MmaEncodingAttr>();
+  if (!srcMma)
+    return true;
+  // wgmma operands are always read from shared memory
+  return srcMma.getVersionMajor() != 1 &&
+         (srcMma.isHopper() || srcMma.getWarpsPerCTA()[1] != 1 ||
+          dstDotOp.getParent() != srcMma);
+}
+
+// Whether a tensor of `type` can be stored to a swizzled shared tensor that
+// other layouts load from
+bool isStageable(RankedTensorType type) {
+  auto encoding = type.getEncoding();
+  auto mma = encoding.dyn_cast<MmaEncodingAttr>();
+  if (type.getRank() != 2 || !(encoding.isa<BlockedEncodingAttr>() ||
+                               (mma && mma.isAmpere())))
+    return false;
+  auto elemTy = type.getElementType();
+  return elemTy.isIntOrFloat() && elemTy.getIntOrFloatBitWidth() >= 8;
+}
+
+// Whether the conversion from `srcType` to `dstType`, a blocked layout of the
+// same order, goes through a scratch buffer that holds the whole tensor at
+// once, i.e., that a shared tensor could replace without using more memory
+bool isStagedAtOnce(RankedTensorType srcType, RankedTensorType dstType) {
+  auto dstEncoding = dstType.getEncoding().dyn_cast<BlockedEncodingAttr>();
+  if (!dstEncoding ||
+      triton::gpu::getOrder(dstEncoding) !=
+          triton::gpu::getOrder(srcType.getEncoding()) ||
+      getWarpShuffleConversion(srcType, dstType))
+    return false;
+  auto shape = srcType.getShape();
+  auto srcShapePerCTA =
+      triton::gpu::getShapePerCTA(srcType.getEncoding(), shape);
+  auto dstShapePerCTA = triton::gpu::getShapePerCTA(dstEncoding, shape);
+  for (unsigned d = 0; d < shape.size(); ++d)
+    if (shape[d] > std::max<int64_t>(srcShapePerCTA[d], dstShapePerCTA[d]))
+      return false;
+  return true;
+}
+
+// 128-byte rows swizzled by 16-byte vectors, which spreads both the rows and
+// the columns of 16-byte accesses over all the banks
+SharedEncodingAttr getStagingEncoding(RankedTensorType type) {
+  auto order = triton::gpu::getOrder(type.getEncoding());
+  unsigned elemBytes = type.getElementType().getIntOrFloatBitWidth() / 8;
+  unsigned cols = type.getShape()[order[0]];
+  unsigned vec = std::min<unsigned>(16 / elemBytes, cols);
+  unsigned perPhase = std::max<unsigned>(128 / (cols * elemBytes), 1);
+  unsigned maxPhase = std::max<unsigned>(
+      std::min<unsigned>(8 / std::min<unsigned>(perPhase, 8), cols / vec), 1);
+  return SharedEncodingAttr::get(type.getContext(), vec, perPhase, maxPhase,
+                                 order);
+}
+
+// A tensor converted to several layouts through shared memory, e.g. the
+// output of an attention block converted to the operand of the next dot and
+// to the layout of its store, is stored to shared memory once, in a layout
+// all the conversions load from, rather than once per conversion. The first
+// conversion to a dot operand picks the layout, and the conversions to
+// blocked layouts load with the swizzle of the stores.
+void shareStagedConversions(ModuleOp mod) {
+  DenseMap<Value, SmallVector<ConvertLayoutOp>> conversions;
+  SmallVector<Value> sources;
+  mod.walk([&](ConvertLayoutOp cvtOp) {
+    Value src = cvtOp.src();
+    if (!isStageable(src.getType().cast<RankedTensorType>()))
+      return;
+    auto &group = conversions[src];
+    if (group.empty())
+      sources.push_back(src);
+    group.push_back(cvtOp);
+  });
+  for (Value src : sources) {
+    auto &group = conversions[src];
+    auto srcType = src.getType().cast<RankedTensorType>();
+    auto order = triton::gpu::getOrder(srcType.getEncoding());
+    Block *block = group.front()->getBlock();
+    SharedEncodingAttr shared;
+    SmallVector<ConvertLayoutOp> staged;
+    for (ConvertLayoutOp cvtOp : group) {
+      auto dstType = cvtOp.getType().cast<RankedTensorType>();
+      auto dstDotOp = dstType.getEncoding().dyn_cast<DotOperandEncodingAttr>();
+      auto dstMma = dstDotOp ? dstDotOp.getParent().dyn_cast<MmaEncodingAttr>()
+                             : MmaEncodingAttr();
+      if (!dstMma || dstMma.isVolta() || cvtOp->getBlock() != block ||
+          !isLoadedFromShared(srcType.getEncoding(), dstDotOp))
+        continue;
+      auto encoding =
+          SharedEncodingAttr::get(mod.getContext(), dstDotOp, srcType.getShape(),
+                                  order, srcType.getElementType());
+      if (!shared)
+        shared = encoding;
+      if (encoding == shared)
+        staged.push_back(cvtOp);
+    }
+    unsigned numDistributed = 0;
+    for (ConvertLayoutOp cvtOp : group)
+      if (cvtOp->getBlock() == block &&
+          isStagedAtOnce(srcType, cvtOp.getType().cast<RankedTensorType>())) {
+        staged.push_back(cvtOp);
+        ++numDistributed;
+      }
+    if (numDistributed == 0 || staged.size() < 2)
+      continue;
+    if (!shared)
+      shared = getStagingEncoding(srcType);
+    llvm::sort(staged, [](ConvertLayoutOp a, ConvertLayoutOp b) {
+      return a->isBeforeInBlock(b);
+    });
+    OpBuilder builder(staged.front());
+    auto sharedType = RankedTensorType::get(
+        srcType.getShape(), srcType.getElementType(), shared);
+    Value stored = builder.create<ConvertLayoutOp>(staged.front().getLoc(),
+                                                   sharedType, src);
+    for (ConvertLayoutOp cvtOp : staged)
+      cvtOp->setOperand(0, stored);
+  }
+}
+
+} // anonymous namespace
+
 class TritonGPUDecomposeConversionsPass
     : public TritonGPUDecomposeConversionsBase<
           TritonGPUDecomposeConversionsPass> {
@@ -30,6 +164,7 @@ public:
   void runOnOperation() override {
     MLIRContext *context = &getContext();
     ModuleOp mod = getOperation();
+    shareStagedConversions(mod);
     mod.walk([&](triton::gpu::ConvertLayoutOp cvtOp) -> void {
       OpBuilder builder(cvtOp);
       auto srcType = cvtOp.getOperand().getType().cast<RankedTensorType>();
@@ -39,16 +174,8 @@ public:
         return;
       auto dstDotOp =
           dstType.getEncoding().dyn_cast<triton::gpu::DotOperandEncodingAttr>();
-      if (!dstDotOp)
+      if (!dstDotOp || !isLoadedFromShared(srcEncoding, dstDotOp))
         return;
-      if (auto srcMmaEncoding =
-              srcEncoding.dyn_cast<triton::gpu::MmaEncodingAttr>()) {
-
-        if (srcMmaEncoding.getVersionMajor() == 1 ||
-            (srcMmaEncoding.getWarpsPerCTA()[1] == 1 &&
-             dstDotOp.getParent() == srcMmaEncoding))
-          return;
-      }
       auto tmpType = RankedTensorType::get(
           dstType.getShape(), dstType.getElementType(),
           triton::gpu::SharedEncodingAttr::get(
@@ -61,6 +188,33 @@ public:
       cvtOp.replaceAllUsesWith(newConvert.getResult());
       cvtOp.erase();
     });
+    // The quantized weights of mma dots are dequantized by their shared
+    // memory load
+    mod.walk([&](triton::DotOp dotOp) -> void {
+      auto mmaLayout = dotOp.getResult()
+                           .getType()
+                           .cast<RankedTensorType>()
+                           .getEncoding()
+                           .dyn_cast<triton::gpu::MmaEncodingAttr>();
+      if (!mmaLayout || !isWeightOnlyQuantizedDot(dotOp))
+        return;
+      auto cvtOp = dotOp.b().getDefiningOp<triton::gpu::ConvertLayoutOp>();
+      if (!cvtOp || !isSharedEncoding(cvtOp.src())) {
+        dotOp.emitError("quantized weights must be loaded from shared memory");
+        return;
+      }
+      OpBuilder builder(dotOp);
+      auto aType = dotOp.a().getType().cast<RankedTensorType>();
+      auto bType = dotOp.b().getType().cast<RankedTensorType>();
+      auto dequantType = RankedTensorType::get(
+          {aType.getShape()[1], bType.getShape()[1]}, aType.getElementType(),
+          bType.getEncoding());
+      auto dequant = builder.create<triton::gpu::DequantizeOp>(
+          cvtOp.getLoc(), dequantType, cvtOp.src());
+      dotOp.setOperand(1, dequant.getResult());
+      if (cvtOp.use_empty())
+        cvtOp.erase();
+    });
   }
 };
 
@@ -0,0 +1,113 @@
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+//===----------------------------------------------------------------------===//
+//
+// This pass hoists the loads of dot operands that read the same tile at each
+// iteration of a scf.for, e.g., the Q block of attention:
+//
+//   scf.for %iv = %lb to %ub step %step {
+//     %q = tt.load %q_ptr
+//     %a = triton_gpu.convert_layout %q -> #dot_op
+//     tt.dot %a, ...
+//   }
+//
+// into a single load and conversion before the loop:
+//
+//   %q = tt.load %q_ptr, splat(%lb < %ub)
+//   %a = triton_gpu.convert_layout %q -> #dot_op
+//   scf.for %iv = %lb to %ub step %step { tt.dot %a, ... }
+//
+// so that the pipeliner doesn't give them stage buffers in shared memory. The
+// mask keeps the load from reading memory that the loop would not have read
+// when it does not execute. Loads are only hoisted from loops that don't
+// write to global memory, which could change the tile between iterations.
+//
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+bool writesMemory(scf::ForOp forOp) {
+  auto result = forOp.getBody()->walk([](Operation *op) {
+    if (isa<triton::StoreOp, triton::AtomicRMWOp, triton::AtomicCASOp,
+            CallOpInterface>(op))
+      return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
+bool isDotOperandConversion(Operation *op) {
+  auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op);
+  return cvt && cvt.getType()
+                    .cast<RankedTensorType>()
+                    .getEncoding()
+                    .isa<triton::gpu::DotOperandEncodingAttr>();
+}
+
+// Returns whether \param load reads the same tensor at each iteration of
+// \param forOp, and only feeds dot operands
+bool isInvariantDotOperand(triton::LoadOp load, scf::ForOp forOp) {
+  if (load.isVolatile() || !load.getType().isa<RankedTensorType>())
+    return false;
+  if (!llvm::all_of(load->getOperands(), [&](Value operand) {
+        return forOp.isDefinedOutsideOfLoop(operand);
+      }))
+    return false;
+  return !load->use_empty() &&
+         llvm::all_of(load->getUsers(), isDotOperandConversion);
+}
+
+void hoistInvariantLoads(scf::ForOp forOp) {
+  SmallVector<triton::LoadOp> loads;
+  for (Operation &op : forOp.getBody()->without_terminator())
+    if (auto load = dyn_cast<triton::LoadOp>(op))
+      if (isInvariantDotOperand(load, forOp))
+        loads.push_back(load);
+  if (loads.empty() || writesMemory(forOp))
+    return;
+
+  OpBuilder builder(forOp);
+  Location loc = forOp.getLoc();
+  Value runs = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::slt, forOp.getLowerBound(),
+      forOp.getUpperBound());
+  for (triton::LoadOp load : loads) {
+    auto type = load.getType().cast<RankedTensorType>();
+    auto maskType = RankedTensorType::get(
+        type.getShape(), builder.getI1Type(), type.getEncoding());
+    Value mask = builder.create<triton::SplatOp>(loc, maskType, runs);
+    if (load.mask())
+      mask = builder.create<arith::AndIOp>(loc, mask, load.mask());
+    load->moveBefore(forOp);
+    load.maskMutable().assign(mask);
+    for (Operation *user : llvm::to_vector(load->getUsers()))
+      user->moveBefore(forOp);
+  }
+}
+
+} // anonymous namespace
+
+struct HoistInvariantLoadsPass
+    : public TritonGPUHoistInvariantLoadsBase<HoistInvariantLoadsPass> {
+  HoistInvariantLoadsPass() = default;
+
+  void runOnOperation() override {
+    // Inner loops first, so that their loads can move out of their parents
+    SmallVector<scf::ForOp> loops;
+    getOperation().walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
+    for (scf::ForOp forOp : loops)
+      hoistInvariantLoads(forOp);
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPUHoistInvariantLoadsPass() {
+  return std::make_unique<HoistInvariantLoadsPass>();
+}
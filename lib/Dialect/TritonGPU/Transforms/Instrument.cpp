@@ -0,0 +1,131 @@
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/JSON.h"
+
+//===----------------------------------------------------------------------===//
+//
+// This pass gives the tt.profile_mark ops of the kernel the buffer their
+// records are written to, a new argument allocated by the launcher:
+//
+//   func @kernel(%x: !tt.ptr<f32>) {
+//     tt.profile_mark "softmax"
+//     ...
+//     tt.profile_mark "softmax" {isEnd}
+//   }
+//
+// becomes
+//
+//   func @kernel(%x: !tt.ptr<f32>, %buffer: !tt.ptr<i64>) {
+//     tt.profile_mark "kernel" %buffer : !tt.ptr<i64> {id = 0 : i32}
+//     tt.profile_mark "softmax" %buffer : !tt.ptr<i64> {id = 1 : i32}
+//     ...
+//     tt.profile_mark "softmax" %buffer : !tt.ptr<i64> {id = 1 : i32, isEnd}
+//     tt.profile_mark "kernel" %buffer : !tt.ptr<i64> {id = 0 : i32, isEnd}
+//   }
+//
+// It runs last, so that the automatic regions surround the loops and the
+// async waits of the pipeline.
+//
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+void createMark(OpBuilder &builder, Location loc, StringRef name, bool isEnd) {
+  builder.create<triton::ProfileMarkOp>(
+      loc, builder.getStringAttr(name),
+      isEnd ? builder.getUnitAttr() : UnitAttr(), IntegerAttr(), Value());
+}
+
+// Surrounds `op` with the marks of region `name`
+void markRegion(Operation *op, StringRef name) {
+  OpBuilder builder(op);
+  createMark(builder, op->getLoc(), name, /*isEnd=*/false);
+  builder.setInsertionPointAfter(op);
+  createMark(builder, op->getLoc(), name, /*isEnd=*/true);
+}
+
+void markKernel(FuncOp func) {
+  auto builder = OpBuilder::atBlockBegin(&func.getBody().front());
+  createMark(builder, func.getLoc(), "kernel", /*isEnd=*/false);
+  func.walk([&](ReturnOp ret) {
+    builder.setInsertionPoint(ret);
+    createMark(builder, ret.getLoc(), "kernel", /*isEnd=*/true);
+  });
+}
+
+} // anonymous namespace
+
+struct InstrumentPass : public TritonGPUInstrumentBase<InstrumentPass> {
+  InstrumentPass() = default;
+  InstrumentPass(bool automatic, int capacity) {
+    this->automatic = automatic;
+    this->capacity = capacity;
+  }
+
+  void runOnOperation() override {
+    ModuleOp mod = getOperation();
+    MLIRContext *context = &getContext();
+
+    if (automatic) {
+      SmallVector<std::pair<Operation *, StringRef>> regions;
+      mod.walk<WalkOrder::PreOrder>([&](Operation *op) {
+        if (isa<scf::ForOp>(op))
+          regions.push_back({op, "loop"});
+        else if (isa<triton::DotOp>(op))
+          regions.push_back({op, "dot"});
+        else if (isa<triton::gpu::AsyncWaitOp>(op))
+          regions.push_back({op, "async_wait"});
+      });
+      llvm::StringMap<unsigned> counts;
+      for (auto &region : regions) {
+        StringRef kind = region.second;
+        markRegion(region.first, (kind + Twine(counts[kind]++)).str());
+      }
+    }
+
+    // Calls are inlined, only the kernels are given a buffer; the marks of
+    // the other functions are no-ops
+    auto ptrTy = triton::PointerType::get(IntegerType::get(context, 64), 1);
+    llvm::StringMap<unsigned> ids;
+    llvm::json::Array names;
+    for (FuncOp func : mod.getOps<FuncOp>()) {
+      if (!func.isPublic())
+        continue;
+      markKernel(func);
+      unsigned argIdx = func.getNumArguments();
+      func.insertArgument(argIdx, ptrTy, DictionaryAttr::get(context),
+                          func.getLoc());
+      Value buffer = func.getArgument(argIdx);
+      func.walk([&](triton::ProfileMarkOp mark) {
+        auto it = ids.try_emplace(mark.name(), ids.size()).first;
+        if (it->second == names.size())
+          names.push_back(mark.name().str());
+        mark.idAttr(IntegerAttr::get(IntegerType::get(context, 32),
+                                     it->second));
+        mark.bufferMutable().assign(buffer);
+      });
+    }
+
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    os << llvm::json::Value(std::move(names));
+    mod->setAttr("triton_gpu.profile_regions",
+                 StringAttr::get(context, os.str()));
+    mod->setAttr(
+        triton::gpu::TritonGPUDialect::getProfileCapacityAttrName(),
+        IntegerAttr::get(IntegerType::get(context, 32), capacity.getValue()));
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPUInstrumentPass(bool automatic,
+                                                          int capacity) {
+  return std::make_unique<InstrumentPass>(automatic, capacity);
+}
@@ -0,0 +1,349 @@
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+#include "Utility.h"
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+using namespace mlir;
+using triton::gpu::ConvertLayoutOp;
+
+//===----------------------------------------------------------------------===//
+//
+// This pass chooses the layouts of the elementwise computations of a function
+// globally, rather than one conversion at a time like the rematerialization
+// patterns of the combine pass.
+//
+// Distributed tensors that are tied together by operations which require
+// their operands and results to share a layout (elementwise operations, and
+// splat/make_range/constant which can be created in any layout) form a
+// component. Every other operation pins the layout of the tensors it defines
+// and uses. Components are connected by the convert_layout operations between
+// them, and each of them is assigned the encoding that minimizes
+//
+//   - the cost of its operations, i.e. the number of elements held by each
+//     thread (which grows with the number of replicas of the layout);
+//   - the cost of the conversions to its neighbours, and to the layouts pinned
+//     by the operations it feeds or is fed by: the shared memory traffic per
+//     thread, plus the barriers needed by each replica of the conversion, or
+//     the number of shuffles for conversions that stay within warps.
+//
+// The assignment is solved by coordinate descent starting from the current
+// layouts, so that the total cost never increases. Conversions left redundant
+// are cleaned up by the combine pass that follows.
+//
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+constexpr unsigned kMaxIterations = 8;
+
+RankedTensorType getDistributedType(Value value) {
+  auto tensorType = value.getType().dyn_cast<RankedTensorType>();
+  if (!tensorType || !tensorType.getEncoding() ||
+      !triton::gpu::isaDistributedLayout(tensorType.getEncoding()))
+    return RankedTensorType();
+  return tensorType;
+}
+
+RankedTensorType withEncoding(RankedTensorType type, Attribute encoding) {
+  return RankedTensorType::get(type.getShape(), type.getElementType(),
+                               encoding);
+}
+
+bool isVolta(Attribute encoding) {
+  if (auto slice = encoding.dyn_cast<triton::gpu::SliceEncodingAttr>())
+    encoding = slice.getParent();
+  auto mma = encoding.dyn_cast<triton::gpu::MmaEncodingAttr>();
+  return mma && mma.isVolta();
+}
+
+/// Returns true if `op` is a conversion between two distributed layouts.
+bool isDistributedConversion(Operation *op) {
+  return isa<ConvertLayoutOp>(op) && getDistributedType(op->getOperand(0)) &&
+         getDistributedType(op->getResult(0));
+}
+
+/// Returns true if the results of `op` can be created in any distributed
+/// layout, as long as its tensor operands have the same layout.
+bool isLayoutFlexible(Operation *op) {
+  if (op->getNumResults() != 1 || op->getNumRegions() ||
+      !getDistributedType(op->getResult(0)))
+    return false;
+  if (isa<triton::SplatOp, triton::MakeRangeOp>(op))
+    return true;
+  if (auto cst = dyn_cast<arith::ConstantOp>(op))
+    return cst.getValue().isa<DenseElementsAttr>();
+  bool elementwise =
+      op->hasTrait<OpTrait::Elementwise>() ||
+      (op->hasTrait<OpTrait::SameOperandsAndResultEncoding>() &&
+       op->hasTrait<OpTrait::SameOperandsAndResultShape>());
+  if (!elementwise || !MemoryEffectOpInterface::hasNoEffect(op))
+    return false;
+  auto shape = getDistributedType(op->getResult(0)).getShape();
+  return llvm::all_of(op->getOperands(), [&](Value operand) {
+    auto type = getDistributedType(operand);
+    return type && type.getShape() == shape;
+  });
+}
+
+class LayoutPropagation {
+public:
+  LayoutPropagation(FuncOp func) : func(func) {}
+
+  void run() {
+    buildComponents();
+    solve();
+    rewrite();
+  }
+
+private:
+  struct Component {
+    SmallVector<Value> values;
+    /// Layout-flexible operations defining the values of the component
+    SmallVector<Operation *> ops;
+    /// Values defined by operations that pin their layout
+    SmallVector<Value> pinnedDefs;
+    /// Values used by operations that pin their layout
+    SmallVector<Value> pinnedUses;
+    /// Indices of the conversions from and to this component
+    SmallVector<unsigned> edges;
+    Attribute encoding;
+    Attribute assigned;
+    bool movable = true;
+  };
+
+  struct Edge {
+    ConvertLayoutOp cvt;
+    unsigned src;
+    unsigned dst;
+  };
+
+  unsigned getLeader(unsigned id) {
+    while (leaders[id] != id)
+      id = leaders[id] = leaders[leaders[id]];
+    return id;
+  }
+
+  void addValue(Value value) {
+    if (getDistributedType(value) && !valueIds.count(value)) {
+      valueIds[value] = values.size();
+      values.push_back(value);
+      leaders.push_back(leaders.size());
+    }
+  }
+
+  void merge(Value a, Value b) {
+    leaders[getLeader(valueIds.lookup(a))] = getLeader(valueIds.lookup(b));
+  }
+
+  static bool isPinnedUse(OpOperand &use) {
+    Operation *user = use.getOwner();
+    return !isLayoutFlexible(user) && !isDistributedConversion(user);
+  }
+
+  void buildComponents() {
+    func.walk([&](Block *block) {
+      for (BlockArgument arg : block->getArguments())
+        addValue(arg);
+    });
+    func.walk([&](Operation *op) {
+      for (Value result : op->getResults())
+        addValue(result);
+    });
+    func.walk([&](Operation *op) {
+      if (!isLayoutFlexible(op))
+        return;
+      for (Value operand : op->getOperands())
+        if (getDistributedType(operand))
+          merge(operand, op->getResult(0));
+    });
+
+    DenseMap<unsigned, unsigned> componentIds;
+    for (unsigned id = 0; id < values.size(); ++id) {
+      unsigned leader = getLeader(id);
+      auto it = componentIds.try_emplace(leader, components.size());
+      if (it.second)
+        components.emplace_back();
+      Component &component = components[it.first->second];
+      Value value = values[id];
+      auto type = getDistributedType(value);
+      if (component.values.empty()) {
+        component.encoding = component.assigned = type.getEncoding();
+      } else if (component.encoding != type.getEncoding() ||
+                 getDistributedType(component.values.front()).getShape() !=
+                     type.getShape()) {
+        component.movable = false;
+      }
+      component.values.push_back(value);
+      componentOf[value] = it.first->second;
+
+      Operation *def = value.getDefiningOp();
+      if (def && isLayoutFlexible(def)) {
+        component.ops.push_back(def);
+      } else if (!def || !isDistributedConversion(def)) {
+        component.pinnedDefs.push_back(value);
+        pinnedDefs.insert(value);
+        // A pinned definition feeds the pinned uses directly
+        continue;
+      }
+      if (llvm::any_of(value.getUses(), isPinnedUse))
+        component.pinnedUses.push_back(value);
+    }
+
+    func.walk([&](ConvertLayoutOp cvt) {
+      if (!isDistributedConversion(cvt))
+        return;
+      unsigned id = edges.size();
+      edges.push_back({cvt, componentOf.lookup(cvt.src()),
+                       componentOf.lookup(cvt.result())});
+      components[edges.back().src].edges.push_back(id);
+      components[edges.back().dst].edges.push_back(id);
+    });
+  }
+
+  /// Returns the cost of component `id` when it is assigned `encoding`, given
+  /// the encodings currently assigned to its neighbours.
+  unsigned getCost(unsigned id, Attribute encoding) {
+    Component &component = components[id];
+    unsigned cost = 0;
+    for (Operation *op : component.ops)
+      cost += triton::gpu::getElemsPerThread(
+          withEncoding(getDistributedType(op->getResult(0)), encoding));
+    for (Value value : component.pinnedDefs)
+      cost += getLayoutConversionCost(getDistributedType(value), encoding);
+    for (Value value : component.pinnedUses) {
+      auto type = getDistributedType(value);
+      cost += getLayoutConversionCost(withEncoding(type, encoding),
+                                type.getEncoding());
+    }
+    for (unsigned edgeId : component.edges) {
+      Edge &edge = edges[edgeId];
+      auto type = getDistributedType(edge.cvt.src());
+      // Conversions from pinned definitions keep their source layout
+      Attribute srcEncoding = type.getEncoding();
+      if (!pinnedDefs.count(edge.cvt.src()))
+        srcEncoding =
+            edge.src == id ? encoding : components[edge.src].assigned;
+      Attribute dstEncoding =
+          edge.dst == id ? encoding : components[edge.dst].assigned;
+      cost += getLayoutConversionCost(withEncoding(type, srcEncoding),
+                                      dstEncoding);
+    }
+    return cost;
+  }
+
+  void solve() {
+    for (unsigned iter = 0; iter < kMaxIterations; ++iter) {
+      bool changed = false;
+      for (unsigned id = 0; id < components.size(); ++id) {
+        Component &component = components[id];
+        if (!component.movable || component.edges.empty())
+          continue;
+        SetVector<Attribute> candidates;
+        candidates.insert(component.encoding);
+        for (unsigned edgeId : component.edges) {
+          Edge &edge = edges[edgeId];
+          unsigned other = edge.src == id ? edge.dst : edge.src;
+          candidates.insert(components[other].assigned);
+        }
+        Attribute best = component.assigned;
+        unsigned bestCost = getCost(id, best);
+        for (Attribute candidate : candidates) {
+          // MMAv1 layouts are only supported where the combine pass put them
+          if (isVolta(candidate) && candidate != component.encoding)
+            continue;
+          unsigned cost = getCost(id, candidate);
+          if (cost < bestCost) {
+            best = candidate;
+            bestCost = cost;
+          }
+        }
+        if (best != component.assigned) {
+          component.assigned = best;
+          changed = true;
+        }
+      }
+      if (!changed)
+        break;
+    }
+  }
+
+  void rewrite() {
+    OpBuilder builder(func.getContext());
+    for (Component &component : components) {
+      if (component.assigned == component.encoding)
+        continue;
+      for (Value value : component.values) {
+        auto oldType = getDistributedType(value);
+        auto newType = withEncoding(oldType, component.assigned);
+        Operation *def = value.getDefiningOp();
+        if (def)
+          builder.setInsertionPointAfter(def);
+        else
+          builder.setInsertionPointToStart(value.getParentBlock());
+        if (pinnedDefs.count(value)) {
+          auto cvt =
+              builder.create<ConvertLayoutOp>(value.getLoc(), newType, value);
+          value.replaceUsesWithIf(cvt, [&](OpOperand &use) {
+            return use.getOwner() != cvt && isLayoutFlexible(use.getOwner());
+          });
+          continue;
+        }
+        value.setType(newType);
+        if (auto cst = dyn_cast_or_null<arith::ConstantOp>(def))
+          cst->setAttr("value",
+                       cst.getValue().cast<DenseElementsAttr>().reshape(
+                           newType));
+        if (llvm::any_of(value.getUses(), isPinnedUse)) {
+          auto cvt =
+              builder.create<ConvertLayoutOp>(value.getLoc(), oldType, value);
+          value.replaceUsesWithIf(cvt, [&](OpOperand &use) {
+            return use.getOwner() != cvt && isPinnedUse(use);
+          });
+        }
+      }
+    }
+    // Remove the conversions between components that were given the same
+    // layout
+    for (Edge &edge : edges) {
+      ConvertLayoutOp cvt = edge.cvt;
+      if (cvt.src().getType() == cvt.result().getType()) {
+        cvt.result().replaceAllUsesWith(cvt.src());
+        cvt.erase();
+      }
+    }
+  }
+
+  FuncOp func;
+  SmallVector<Value> values;
+  SmallVector<unsigned> leaders;
+  DenseMap<Value, unsigned> valueIds;
+  DenseMap<Value, unsigned> componentOf;
+  DenseSet<Value> pinnedDefs;
+  SmallVector<Component> components;
+  SmallVector<Edge> edges;
+};
+
+} // namespace
+
+class TritonGPULayoutPropagationPass
+    : public TritonGPULayoutPropagationBase<TritonGPULayoutPropagationPass> {
+public:
+  TritonGPULayoutPropagationPass() = default;
+
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    m.walk([&](FuncOp func) { LayoutPropagation(func).run(); });
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPULayoutPropagationPass() {
+  return std::make_unique<TritonGPULayoutPropagationPass>();
+}
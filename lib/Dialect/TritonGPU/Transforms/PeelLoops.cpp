@@ -0,0 +1,364 @@
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "triton/Analysis/AxisInfo.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+//===----------------------------------------------------------------------===//
+//
+// This pass splits loops whose memory operations are masked by a bound on the
+// induction variable, e.g.
+//
+//   scf.for %iv = %lb to %ub step %step {
+//     %k = arith.subi %K, %iv
+//     %mask = arith.cmpi slt, %rk, splat(%k)
+//     tt.load %ptr, %mask
+//   }
+//
+// into a steady-state loop in which these masks are known to hold, and from
+// which they are removed, followed by a remainder loop that keeps the original
+// body:
+//
+//   %split = ... // first iteration for which `max(%rk) < %K - %iv` fails
+//   scf.for %iv = %lb to %split step %step { tt.load %ptr }
+//   scf.for %iv = %split to %ub step %step { tt.load %ptr, %mask }
+//
+// A mask is recognized when one side of the comparison is the sum of
+// loop-invariant tensors, whose maximum can be computed before the loop, and
+// the difference between the two sides decreases by one with each
+// increment of the induction variable. The split point is computed at
+// runtime, so the remainder is usually the single last iteration, or is empty.
+//
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+/// A scalar of the form `coeff * iv + constant + sum(sign * term)`, where the
+/// terms are defined outside of the loop.
+struct AffineScalar {
+  int coeff = 0;
+  int64_t constant = 0;
+  SmallVector<std::pair<Value, int>> terms;
+};
+
+/// An integer tensor of the form `sum(tensor) + splat(scalar)`, where the
+/// tensors are defined outside of the loop.
+struct AffineTensor {
+  SmallVector<Value> tensors;
+  AffineScalar scalar;
+};
+
+/// A mask that holds as long as `iv < bound - sum(max(tensor))`.
+struct MaskBound {
+  AffineScalar bound;
+  SmallVector<Value> tensors;
+};
+
+class LoopPeeler {
+public:
+  LoopPeeler(scf::ForOp forOp, AxisInfoAnalysis &axisInfo)
+      : forOp(forOp), axisInfo(axisInfo) {}
+
+  /// Splits the loop if some of its masks can be removed from the steady state.
+  void run();
+
+private:
+  bool isInductionVar(Value v) {
+    auto cast = v.getDefiningOp<arith::IndexCastOp>();
+    return cast && cast->getOperand(0) == forOp.getInductionVar() &&
+           v.getType().isInteger(32);
+  }
+
+  bool decompose(Value v, int sign, AffineScalar &res);
+  bool decompose(Value v, int sign, AffineTensor &res);
+  bool matchBound(Value mask, MaskBound &res);
+
+  /// Maximum of the elements of `v`, when it is a constant.
+  Optional<int64_t> getStaticMax(Value v);
+  /// True if the maximum of the elements of `v` can be emitted before the loop.
+  bool hasMax(Value v);
+  Value emitMax(OpBuilder &builder, Value v);
+  Value emitScalar(OpBuilder &builder, const AffineScalar &scalar);
+  Value emitBound(OpBuilder &builder, const MaskBound &maskBound);
+
+  scf::ForOp forOp;
+  AxisInfoAnalysis &axisInfo;
+};
+
+bool LoopPeeler::decompose(Value v, int sign, AffineScalar &res) {
+  APInt cst;
+  if (isInductionVar(v)) {
+    res.coeff += sign;
+    return true;
+  }
+  if (matchPattern(v, m_ConstantInt(&cst))) {
+    res.constant += sign * cst.getSExtValue();
+    return true;
+  }
+  if (forOp.isDefinedOutsideOfLoop(v)) {
+    res.terms.push_back({v, sign});
+    return true;
+  }
+  if (auto add = v.getDefiningOp<arith::AddIOp>())
+    return decompose(add->getOperand(0), sign, res) &&
+           decompose(add->getOperand(1), sign, res);
+  if (auto sub = v.getDefiningOp<arith::SubIOp>())
+    return decompose(sub->getOperand(0), sign, res) &&
+           decompose(sub->getOperand(1), -sign, res);
+  return false;
+}
+
+bool LoopPeeler::decompose(Value v, int sign, AffineTensor &res) {
+  Operation *def = v.getDefiningOp();
+  DenseIntElementsAttr cst;
+  if (matchPattern(v, m_Constant(&cst)) && cst.isSplat()) {
+    res.scalar.constant += sign * cst.getSplatValue<APInt>().getSExtValue();
+    return true;
+  }
+  if (auto splat = dyn_cast_or_null<triton::SplatOp>(def))
+    return decompose(splat.src(), sign, res.scalar);
+  if (def && isa<triton::BroadcastOp, triton::ExpandDimsOp,
+                 triton::gpu::ConvertLayoutOp>(def))
+    return decompose(def->getOperand(0), sign, res);
+  if (auto add = dyn_cast_or_null<arith::AddIOp>(def))
+    return decompose(add->getOperand(0), sign, res) &&
+           decompose(add->getOperand(1), sign, res);
+  if (auto sub = dyn_cast_or_null<arith::SubIOp>(def))
+    return decompose(sub->getOperand(0), sign, res) &&
+           decompose(sub->getOperand(1), -sign, res);
+  // Only upper bounds of the tensors are known
+  if (sign > 0 && forOp.isDefinedOutsideOfLoop(v)) {
+    res.tensors.push_back(v);
+    return true;
+  }
+  return false;
+}
+
+Optional<int64_t> LoopPeeler::getStaticMax(Value v) {
+  if (auto *latticeElement = axisInfo.lookupLatticeElement(v))
+    if (auto range = latticeElement->getValue().getRange())
+      return range->second;
+  if (auto makeRange = v.getDefiningOp<triton::MakeRangeOp>())
+    return int64_t(makeRange.end()) - 1;
+  return llvm::None;
+}
+
+bool LoopPeeler::hasMax(Value v) {
+  if (getStaticMax(v))
+    return true;
+  Operation *def = v.getDefiningOp();
+  if (isa_and_nonnull<triton::SplatOp>(def))
+    return true;
+  if (def && isa<triton::BroadcastOp, triton::ExpandDimsOp,
+                 triton::gpu::ConvertLayoutOp>(def))
+    return hasMax(def->getOperand(0));
+  if (auto add = dyn_cast_or_null<arith::AddIOp>(def))
+    return hasMax(add->getOperand(0)) && hasMax(add->getOperand(1));
+  return false;
+}
+
+Value LoopPeeler::emitMax(OpBuilder &builder, Value v) {
+  Location loc = v.getLoc();
+  if (Optional<int64_t> max = getStaticMax(v))
+    return builder.create<arith::ConstantIntOp>(loc, *max, 32);
+  Operation *def = v.getDefiningOp();
+  if (auto splat = dyn_cast<triton::SplatOp>(def))
+    return splat.src();
+  if (auto add = dyn_cast<arith::AddIOp>(def))
+    return builder.create<arith::AddIOp>(
+        loc, emitMax(builder, add->getOperand(0)),
+        emitMax(builder, add->getOperand(1)));
+  return emitMax(builder, def->getOperand(0));
+}
+
+Value LoopPeeler::emitScalar(OpBuilder &builder, const AffineScalar &scalar) {
+  Location loc = forOp.getLoc();
+  Value res;
+  if (scalar.constant != 0)
+    res = builder.create<arith::ConstantIntOp>(loc, scalar.constant, 32);
+  for (auto term : scalar.terms) {
+    if (!res && term.second > 0) {
+      res = term.first;
+      continue;
+    }
+    if (!res)
+      res = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+    if (term.second > 0)
+      res = builder.create<arith::AddIOp>(loc, res, term.first);
+    else
+      res = builder.create<arith::SubIOp>(loc, res, term.first);
+  }
+  return res ? res : builder.create<arith::ConstantIntOp>(loc, 0, 32);
+}
+
+bool LoopPeeler::matchBound(Value mask, MaskBound &res) {
+  auto cmp = mask.getDefiningOp<triton::gpu::CmpIOp>();
+  if (!cmp || !getElementTypeOrSelf(cmp.lhs().getType()).isInteger(32))
+    return false;
+  AffineTensor lhs, rhs;
+  if (!decompose(cmp.lhs(), 1, lhs) || !decompose(cmp.rhs(), 1, rhs))
+    return false;
+  // Bring the comparison to the form `tensors + scalar < bound`
+  bool strict;
+  AffineTensor *bounded, *bound;
+  switch (cmp.predicate()) {
+  case arith::CmpIPredicate::slt:
+  case arith::CmpIPredicate::sle:
+    strict = cmp.predicate() == arith::CmpIPredicate::slt;
+    bounded = &lhs;
+    bound = &rhs;
+    break;
+  case arith::CmpIPredicate::sgt:
+  case arith::CmpIPredicate::sge:
+    strict = cmp.predicate() == arith::CmpIPredicate::sgt;
+    bounded = &rhs;
+    bound = &lhs;
+    break;
+  default:
+    return false;
+  }
+  // Masks that are uniform across the tensor don't prevent vectorization
+  if (bounded->tensors.empty() || !bound->tensors.empty())
+    return false;
+  if (!llvm::all_of(bounded->tensors, [&](Value v) { return hasMax(v); }))
+    return false;
+  // max(tensors) < bound - scalar, where the right hand side must decrease
+  // with the induction variable
+  res.bound = bound->scalar;
+  res.bound.coeff -= bounded->scalar.coeff;
+  res.bound.constant -= bounded->scalar.constant;
+  for (auto term : bounded->scalar.terms)
+    res.bound.terms.push_back({term.first, -term.second});
+  if (res.bound.coeff != -1)
+    return false;
+  res.bound.coeff = 0;
+  if (!strict)
+    res.bound.constant += 1;
+  res.tensors = bounded->tensors;
+  return true;
+}
+
+Value LoopPeeler::emitBound(OpBuilder &builder, const MaskBound &maskBound) {
+  AffineScalar bound = maskBound.bound;
+  for (Value tensor : maskBound.tensors)
+    bound.terms.push_back({emitMax(builder, tensor), -1});
+  return emitScalar(builder, bound);
+}
+
+void LoopPeeler::run() {
+  // Masks of the memory operations of the body that can be removed from the
+  // steady state, with the part of the mask that remains (null if none)
+  SmallVector<MaskBound> bounds;
+  DenseMap<Value, Value> steadyMasks;
+  SmallVector<std::pair<size_t, Value>> peeledOps;
+  auto addBound = [&](Value mask) {
+    MaskBound bound;
+    if (!matchBound(mask, bound))
+      return false;
+    bounds.push_back(bound);
+    return true;
+  };
+  for (auto it : llvm::enumerate(forOp.getBody()->without_terminator())) {
+    Operation *op = &it.value();
+    Value mask;
+    if (auto load = dyn_cast<triton::LoadOp>(op))
+      mask = load.mask();
+    if (auto store = dyn_cast<triton::StoreOp>(op))
+      mask = store.mask();
+    if (!mask)
+      continue;
+    if (!steadyMasks.count(mask)) {
+      if (addBound(mask)) {
+        steadyMasks[mask] = Value();
+      } else if (auto andOp = mask.getDefiningOp<arith::AndIOp>()) {
+        // The other side of a conjunction stays in the steady state
+        if (addBound(andOp->getOperand(1)))
+          steadyMasks[mask] = andOp->getOperand(0);
+        else if (addBound(andOp->getOperand(0)))
+          steadyMasks[mask] = andOp->getOperand(1);
+      }
+    }
+    if (steadyMasks.count(mask))
+      peeledOps.push_back({it.index(), mask});
+  }
+  if (peeledOps.empty())
+    return;
+
+  // The steady-state loop covers the iterations `lb + i * step < split`
+  Location loc = forOp.getLoc();
+  OpBuilder builder(forOp);
+  Value split;
+  for (const MaskBound &bound : bounds) {
+    Value iv = emitBound(builder, bound);
+    split = split ? builder.create<arith::MinSIOp>(loc, split, iv) : iv;
+  }
+  Value lb = forOp.getLowerBound();
+  Value ub = forOp.getUpperBound();
+  Value step = forOp.getStep();
+  split =
+      builder.create<arith::IndexCastOp>(loc, builder.getIndexType(), split);
+  split = builder.create<arith::MinSIOp>(loc, split, ub);
+  split = builder.create<arith::MaxSIOp>(loc, split, lb);
+  Value numIters = builder.create<arith::CeilDivSIOp>(
+      loc, builder.create<arith::SubIOp>(loc, split, lb), step);
+  Value steadyUb = builder.create<arith::AddIOp>(
+      loc, lb, builder.create<arith::MulIOp>(loc, numIters, step));
+
+  BlockAndValueMapping mapping;
+  auto steadyLoop = cast<scf::ForOp>(builder.clone(*forOp, mapping));
+  steadyLoop.setUpperBound(steadyUb);
+  // Operations are cloned in order, so their positions in both bodies match
+  SmallVector<Operation *> steadyOps = llvm::to_vector(llvm::map_range(
+      steadyLoop.getBody()->without_terminator(),
+      [](Operation &op) { return &op; }));
+  for (auto it : peeledOps) {
+    Operation *steadyOp = steadyOps[it.first];
+    Value steadyMask = steadyMasks.lookup(it.second);
+    if (steadyMask)
+      steadyMask = mapping.lookupOrDefault(steadyMask);
+    if (auto load = dyn_cast<triton::LoadOp>(steadyOp)) {
+      if (steadyMask) {
+        load.maskMutable().assign(steadyMask);
+      } else {
+        load.maskMutable().clear();
+        load.otherMutable().clear();
+      }
+    }
+    if (auto store = dyn_cast<triton::StoreOp>(steadyOp)) {
+      if (steadyMask)
+        store.maskMutable().assign(steadyMask);
+      else
+        store.maskMutable().clear();
+    }
+  }
+  // The original loop becomes the remainder
+  forOp.setLowerBound(steadyUb);
+  forOp->setOperands(forOp.getNumControlOperands(), forOp.getNumIterOperands(),
+                     steadyLoop.getResults());
+}
+
+} // anonymous namespace
+
+struct PeelLoopsPass : public TritonGPUPeelLoopsBase<PeelLoopsPass> {
+  PeelLoopsPass() = default;
+
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    AxisInfoAnalysis axisInfo(&getContext());
+    axisInfo.run(m);
+    // Inner loops first, before they are cloned with their parent
+    SmallVector<scf::ForOp> loops;
+    m.walk([&](scf::ForOp forOp) { loops.push_back(forOp); });
+    for (scf::ForOp forOp : loops)
+      LoopPeeler(forOp, axisInfo).run();
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPUPeelLoopsPass() {
+  return std::make_unique<PeelLoopsPass>();
+}
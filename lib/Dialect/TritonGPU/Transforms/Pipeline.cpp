@@ -2,6 +2,7 @@
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+#include "llvm/Support/JSON.h"
 
 //===----------------------------------------------------------------------===//
 //
@@ -29,6 +30,329 @@ static Type getI1SameShape(Value v) {
 
 namespace {
 
+//===----------------------------------------------------------------------===//
+// Tensor memory accelerator
+//===----------------------------------------------------------------------===//
+
+/// The product of a constant, of scalar values and, for tensors, of the index
+/// along dimension `dim`. A null factor stands for the number of iterations of
+/// the loop that precede the one whose tile is loaded.
+struct AffineTerm {
+  int64_t coeff;
+  SmallVector<Value, 2> factors;
+  int dim;
+};
+
+using AffineSum = SmallVector<AffineTerm, 4>;
+
+AffineTerm getConstantTerm(int64_t coeff) { return {coeff, {}, -1}; }
+
+/// Terms with more factors are not worth a bulk copy
+constexpr unsigned kMaxAffineTerms = 16;
+
+/// A pipelined load whose tiles are copied by the tensor memory accelerator
+struct TMALoad {
+  /// Column and row (in elements) of the tile in the row-major matrix
+  AffineSum col;
+  AffineSum row;
+  /// Kernel arguments holding the base pointer and the row stride
+  unsigned baseArg;
+  unsigned rowStrideArg;
+  unsigned elemSize;
+  /// Columns and rows of the tile copied by each CTA
+  int64_t box[2];
+  /// Span of the swizzling pattern in bytes, or 0
+  unsigned swizzle;
+  /// Kernel argument holding the address of the tensor map
+  Value desc;
+  /// Group of mbarriers signaled by the copies
+  int mbarrier;
+  /// CTAs of the cluster sharing the tile
+  unsigned multicast = 1;
+};
+
+/// Returns the swizzling mode of the tensor memory accelerator that writes
+/// tiles in the shared layout of `bufferType`. The accelerator permutes the
+/// 16-byte chunks of a row by XOR-ing their index with bits [7, 10) of their
+/// address, which is the pattern of the shared layout when each row spans
+/// the whole 32, 64 or 128-byte pattern.
+Optional<unsigned> getTMASwizzle(RankedTensorType bufferType) {
+  auto sharedEnc = bufferType.getEncoding().cast<ttg::SharedEncodingAttr>();
+  auto shape = bufferType.getShape();
+  unsigned elemSize =
+      triton::getIntOrFloatBitWidth(bufferType.getElementType()) / 8;
+  unsigned rowBytes = shape[2] * elemSize;
+  if (sharedEnc.getOrder()[0] != 1 || shape[1] > 256 || shape[2] > 256 ||
+      rowBytes % 16 != 0)
+    return llvm::None;
+  if (sharedEnc.getMaxPhase() == 1)
+    return 0u;
+  if (sharedEnc.getVec() * elemSize != 16 ||
+      (rowBytes != 32 && rowBytes != 64 && rowBytes != 128) ||
+      sharedEnc.getPerPhase() != 128 / rowBytes ||
+      sharedEnc.getMaxPhase() != rowBytes / 16)
+    return llvm::None;
+  // Each slice must start at a repetition of the pattern
+  if (shape[1] * rowBytes % 1024 != 0)
+    return llvm::None;
+  return rowBytes;
+}
+
+/// Decomposes the pointers of loads in `forOp` into a kernel argument plus
+/// an affine offset, to find the tiles that can be described by a tensor map.
+class TileAddressMatcher {
+public:
+  TileAddressMatcher(scf::ForOp forOp) : forOp(forOp) {}
+
+  Optional<TMALoad> match(triton::LoadOp loadOp, RankedTensorType bufferType);
+
+private:
+  /// Decomposes the integer `v` or, if `base` is non-null, the offset of the
+  /// pointer `v` from `*base`.
+  Optional<AffineSum> decompose(Value v, Value *base = nullptr);
+
+  scf::ForOp forOp;
+};
+
+Optional<AffineSum> multiply(const AffineSum &lhs, const AffineSum &rhs) {
+  if (lhs.size() * rhs.size() > kMaxAffineTerms)
+    return llvm::None;
+  AffineSum product;
+  for (const AffineTerm &l : lhs)
+    for (const AffineTerm &r : rhs) {
+      if (l.dim != -1 && r.dim != -1)
+        return llvm::None;
+      AffineTerm term{l.coeff * r.coeff, l.factors, std::max(l.dim, r.dim)};
+      term.factors.append(r.factors.begin(), r.factors.end());
+      product.push_back(term);
+    }
+  return product;
+}
+
+Optional<AffineSum> TileAddressMatcher::decompose(Value v, Value *base) {
+  auto combine = [](Optional<AffineSum> lhs,
+                    Optional<AffineSum> rhs) -> Optional<AffineSum> {
+    if (!lhs || !rhs || lhs->size() + rhs->size() > kMaxAffineTerms)
+      return llvm::None;
+    lhs->append(rhs->begin(), rhs->end());
+    return lhs;
+  };
+
+  if (auto arg = v.dyn_cast<BlockArgument>()) {
+    Block *owner = arg.getOwner();
+    if (owner == forOp.getBody() && arg != forOp.getInductionVar()) {
+      // Loop-carried values must be advanced by a loop-invariant amount
+      Value next = forOp.getBody()->getTerminator()->getOperand(
+          arg.getArgNumber() - 1);
+      Operation *step = next.getDefiningOp();
+      if (!step || !isa<arith::AddIOp, triton::AddPtrOp>(step) ||
+          step->getOperand(0) != arg ||
+          !forOp.isDefinedOutsideOfLoop(step->getOperand(1)))
+        return llvm::None;
+      Optional<AffineSum> delta = decompose(step->getOperand(1));
+      if (delta)
+        for (AffineTerm &term : *delta)
+          term.factors.push_back(Value());
+      return combine(
+          decompose(forOp.getOpOperandForRegionIterArg(arg).get(), base),
+          delta);
+    }
+    if (base && owner->isEntryBlock() && isa<FuncOp>(owner->getParentOp()) &&
+        arg.getType().isa<triton::PointerType>()) {
+      *base = arg;
+      return AffineSum{};
+    }
+  }
+
+  Operation *def = v.getDefiningOp();
+  if (isa_and_nonnull<triton::SplatOp, ttg::ConvertLayoutOp>(def))
+    return decompose(def->getOperand(0), base);
+  if (auto broadcast = dyn_cast_or_null<triton::BroadcastOp>(def)) {
+    Optional<AffineSum> src = decompose(broadcast.src(), base);
+    auto srcType = broadcast.src().getType().dyn_cast<RankedTensorType>();
+    // The index along broadcast dimensions is always 0
+    if (src && srcType)
+      llvm::erase_if(*src, [&](const AffineTerm &term) {
+        return term.dim != -1 && srcType.getShape()[term.dim] == 1;
+      });
+    return src;
+  }
+  if (auto expandDims = dyn_cast_or_null<triton::ExpandDimsOp>(def)) {
+    Optional<AffineSum> src = decompose(expandDims.src(), base);
+    if (src)
+      for (AffineTerm &term : *src)
+        if (term.dim >= static_cast<int>(expandDims.axis()))
+          ++term.dim;
+    return src;
+  }
+  if (base) {
+    if (auto addPtr = dyn_cast_or_null<triton::AddPtrOp>(def))
+      return combine(decompose(addPtr.ptr(), base),
+                     decompose(addPtr.offset()));
+    return llvm::None;
+  }
+
+  if (auto cst = dyn_cast_or_null<arith::ConstantOp>(def)) {
+    Attribute value = cst.getValue();
+    if (auto splat = value.dyn_cast<SplatElementsAttr>())
+      value = splat.getSplatValue<Attribute>();
+    if (auto intAttr = value.dyn_cast<IntegerAttr>())
+      return AffineSum{getConstantTerm(intAttr.getInt())};
+    return llvm::None;
+  }
+  if (auto makeRange = dyn_cast_or_null<triton::MakeRangeOp>(def))
+    return AffineSum{getConstantTerm(makeRange.start()), AffineTerm{1, {}, 0}};
+  if (isa_and_nonnull<arith::AddIOp, arith::SubIOp, arith::MulIOp>(def)) {
+    Optional<AffineSum> lhs = decompose(def->getOperand(0));
+    Optional<AffineSum> rhs = decompose(def->getOperand(1));
+    if (!lhs || !rhs)
+      return llvm::None;
+    if (isa<arith::MulIOp>(def))
+      return multiply(*lhs, *rhs);
+    if (isa<arith::SubIOp>(def))
+      for (AffineTerm &term : *rhs)
+        term.coeff = -term.coeff;
+    return combine(lhs, rhs);
+  }
+  // Other scalars are opaque factors
+  if (v.getType().isSignlessInteger(32) || v.getType().isIndex())
+    return AffineSum{AffineTerm{1, {v}, -1}};
+  return llvm::None;
+}
+
+/// Loads can be copied by the tensor memory accelerator if they read, without
+/// mask, a tile whose pointers are `base + row * rowStride + col`, where `base`
+/// and `rowStride` are kernel arguments aligned to 16 bytes, `col` increases
+/// along the rows of the tile and `row` along its columns.
+Optional<TMALoad> TileAddressMatcher::match(triton::LoadOp loadOp,
+                                            RankedTensorType bufferType) {
+  auto ty = loadOp.getType().cast<RankedTensorType>();
+  if (loadOp.mask() || loadOp.other() || loadOp.isVolatile() ||
+      ty.getRank() != 2 || !ty.getElementType().isIntOrFloat())
+    return llvm::None;
+  Optional<unsigned> swizzle = getTMASwizzle(bufferType);
+  if (!swizzle)
+    return llvm::None;
+
+  Value base;
+  Optional<AffineSum> offset = decompose(loadOp.ptr(), &base);
+  if (!offset)
+    return llvm::None;
+  Value rowStride;
+  bool hasCols = false;
+  for (const AffineTerm &term : *offset) {
+    if (term.dim == 1) {
+      if (hasCols || term.coeff != 1 || !term.factors.empty())
+        return llvm::None;
+      hasCols = true;
+    } else if (term.dim == 0) {
+      if (rowStride || term.coeff != 1 || term.factors.size() != 1 ||
+          !term.factors[0])
+        return llvm::None;
+      rowStride = term.factors[0];
+    }
+  }
+  auto baseArg = base.cast<BlockArgument>();
+  auto rowStrideArg = rowStride.dyn_cast_or_null<BlockArgument>();
+  if (!hasCols || !rowStrideArg ||
+      rowStrideArg.getOwner() != baseArg.getOwner())
+    return llvm::None;
+
+  TMALoad tma;
+  for (const AffineTerm &term : *offset) {
+    if (term.dim != -1)
+      continue;
+    auto it = llvm::find(term.factors, rowStride);
+    if (it == term.factors.end()) {
+      tma.col.push_back(term);
+      continue;
+    }
+    AffineTerm rowTerm = term;
+    rowTerm.factors.erase(rowTerm.factors.begin() +
+                          (it - term.factors.begin()));
+    if (llvm::is_contained(rowTerm.factors, rowStride))
+      return llvm::None;
+    tma.row.push_back(rowTerm);
+  }
+
+  // The tensor map is built by the launcher, for arguments aligned to 16 bytes
+  auto func = cast<FuncOp>(baseArg.getOwner()->getParentOp());
+  auto getDivisibility = [&](BlockArgument arg) -> int64_t {
+    auto attr = func.getArgAttrOfType<IntegerAttr>(arg.getArgNumber(),
+                                                   "tt.divisibility");
+    return attr ? attr.getInt() : 1;
+  };
+  tma.elemSize = triton::getIntOrFloatBitWidth(ty.getElementType()) / 8;
+  if (func.isPrivate() || getDivisibility(baseArg) % 16 != 0 ||
+      getDivisibility(rowStrideArg) * tma.elemSize % 16 != 0)
+    return llvm::None;
+  tma.baseArg = baseArg.getArgNumber();
+  tma.rowStrideArg = rowStrideArg.getArgNumber();
+  tma.box[0] = ty.getShape()[1];
+  tma.box[1] = ty.getShape()[0];
+  tma.swizzle = *swizzle;
+
+  // Tiles loaded by all the CTAs of the cluster are split between them by
+  // rows, each share starting at a repetition of the swizzling pattern
+  unsigned numCTAs =
+      ttg::TritonGPUDialect::getNumCTAs(func->getParentOfType<ModuleOp>());
+  unsigned shareBytes = tma.box[1] / numCTAs * tma.box[0] * tma.elemSize;
+  if (loadOp.multicast() && numCTAs > 1 && tma.box[1] % numCTAs == 0 &&
+      shareBytes % (tma.swizzle ? 1024 : 128) == 0) {
+    tma.multicast = numCTAs;
+    tma.box[1] /= numCTAs;
+  }
+  return tma;
+}
+
+/// Materializes `sum` as an i32, replacing its factors with `mapFactor` and
+/// its null factors with `numIters`.
+Value materialize(OpBuilder &builder, Location loc, const AffineSum &sum,
+                  function_ref<Value(Value)> mapFactor, Value numIters) {
+  Value result = builder.create<arith::ConstantIntOp>(loc, 0, 32);
+  for (const AffineTerm &term : sum) {
+    Value product = builder.create<arith::ConstantIntOp>(loc, term.coeff, 32);
+    for (Value factor : term.factors) {
+      Value v = factor ? mapFactor(factor) : numIters;
+      if (v.getType().isIndex())
+        v = builder.create<arith::IndexCastOp>(loc, builder.getI32Type(), v);
+      product = builder.create<arith::MulIOp>(loc, product, v);
+    }
+    result = builder.create<arith::AddIOp>(loc, result, product);
+  }
+  return result;
+}
+
+/// Returns a copy of `loadOp` reading `ptr`, whose elements are masked off
+/// unless `cond` holds
+Value createPredicatedLoad(OpBuilder &builder, triton::LoadOp loadOp,
+                           Value ptr, Value mask, Value other, Value cond) {
+  Location loc = loadOp.getLoc();
+  Value condMask = cond;
+  if (loadOp.getType().isa<RankedTensorType>())
+    condMask = builder.create<triton::SplatOp>(loc, getI1SameShape(loadOp),
+                                               cond);
+  mask = mask ? builder.create<arith::AndIOp>(loc, mask, condMask) : condMask;
+  return builder.create<triton::LoadOp>(
+      loc, loadOp.getType(), ptr, mask, other, loadOp.cache(), loadOp.evict(),
+      loadOp.isVolatile(), loadOp.multicast(), loadOp.ragged());
+}
+
+/// Registers per thread (in 32-bit words) that the loads prefetched into
+/// registers may hold across iterations
+constexpr unsigned kMaxStagedWords = 64;
+
+/// Returns the number of 32-bit registers each thread needs for a value of
+/// `type`
+unsigned getNumWordsPerThread(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  Type elemType = tensorType ? tensorType.getElementType() : type;
+  unsigned bitWidth =
+      elemType.isIntOrFloat() ? elemType.getIntOrFloatBitWidth() : 64;
+  unsigned numElems = tensorType ? ttg::getElemsPerThread(tensorType) : 1;
+  return numElems * ((bitWidth + 31) / 32);
+}
+
 class LoopPipeliner {
   /// Cache forOp we are working on
   scf::ForOp forOp;
@@ -48,6 +372,22 @@ class LoopPipeliner {
   DenseMap<Value, SmallVector<Value>> loadStageBuffer;
   /// load => after extract
   DenseMap<Value, Value> loadsExtract;
+  /// Loads copied by the tensor memory accelerator
+  DenseMap<Value, TMALoad> tmaLoads;
+  /// Loads whose results are not dot operands, prefetched into registers:
+  /// the loop carries their values for the next numStages-1 iterations
+  SetVector<Value> regLoads;
+  /// regLoad => its value at stage N of the prologue
+  DenseMap<Value, SmallVector<Value>> regLoadStages;
+  /// Loads that the pointers of pipelined loads depend on (e.g. the indices
+  /// of a gather), issued one iteration ahead of them
+  SetVector<Value> indexLoads;
+  /// index load => the ops of the loop body it depends on, and itself
+  DenseMap<Value, SmallVector<Operation *>> indexLoadChains;
+  /// index load => its value for iteration numStages-1, from the prologue
+  DenseMap<Value, Value> indexLoadsNext;
+  /// Whether the loop writes to global memory
+  bool hasWrites = false;
   ///
   Value pipelineIterIdx;
   ///
@@ -77,11 +417,73 @@ class LoopPipeliner {
   /// Returns a empty buffer of size <numStages, ...>
   ttg::AllocTensorOp allocateEmptyBuffer(Operation *op, OpBuilder &builder);
 
+  /// Returns true if the copies for the next stage should be issued before
+  /// the current stage is consumed in the loop body.
+  /// With two stages, the slice copied in iteration i is the one consumed in
+  /// iteration i+1, so async_wait{num = 0} at the end of the body would expose
+  /// the whole copy latency if the copy were issued after tt.dot. The slot
+  /// written in iteration i ((i + numStages - 1) % numStages) is never the
+  /// slot read in iteration i (i % numStages), so hoisting is always safe.
+  /// It is opt-in (`copiesFirst`) for cp.async copies.
+  /// Warpgroup MMAs run asynchronously until the end of tt.dot: issuing the
+  /// copies first keeps them in flight while the tensor cores are busy.
+  bool issueCopiesFirst() const {
+    return (copiesFirst && numStages == 2) || hasAsyncDot;
+  }
+
+  /// Returns the number of loads copied with cp.async
+  unsigned getNumAsyncCopies() const { return loads.size() - tmaLoads.size(); }
+
+  /// Returns true if `op` is a load pipelined through shared memory or
+  /// registers
+  bool isPipelinedLoad(Operation *op) const {
+    return op->getNumResults() == 1 && (loads.contains(op->getResult(0)) ||
+                                        regLoads.contains(op->getResult(0)));
+  }
+
+  /// Returns true if `loadOp` may be issued in an earlier iteration than the
+  /// one using it. In loops that write to global memory, only the data that
+  /// is read-only during the whole kernel (".nc" loads) may be.
+  bool canIssueEarly(triton::LoadOp loadOp) const {
+    return !loadOp.isVolatile() &&
+           (!hasWrites || loadOp.cache() == triton::CacheModifier::NC);
+  }
+
+  /// Returns the value of index load `load` in the iteration whose induction
+  /// variable is `iv`, masked off past the end of the loop
+  Value createIndexLoad(OpBuilder &builder, Value load, Value iv);
+
+  /// Returns the bulk copy of the tile of `loadOp` loaded in iteration
+  /// `pipelineIterIdx` into slice `index` of `buffer`
+  Operation *createInsertSliceTMA(OpBuilder &builder, triton::LoadOp loadOp,
+                                  Value buffer, Value index, Value pred,
+                                  function_ref<Value(Value)> mapFactor);
+
+  /// Whether loads may be copied by the tensor memory accelerator
+  bool hasTMA;
+
+  /// Whether the copies of 2-stage pipelines are issued before the consumer
+  bool copiesFirst;
+
+  /// Whether the loop contains a dot lowered to warpgroup MMAs
+  bool hasAsyncDot = false;
+
 public:
-  LoopPipeliner(scf::ForOp forOp, int numStages)
-      : forOp(forOp), numStages(numStages) {
+  LoopPipeliner(scf::ForOp forOp, int numStages, bool hasTMA,
+                bool copiesFirst)
+      : forOp(forOp), numStages(numStages), hasTMA(hasTMA),
+        copiesFirst(copiesFirst) {
     // cache yieldOp
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
+    forOp.getBody()->walk([&](triton::DotOp dotOp) {
+      auto mmaLayout = dotOp.getResult()
+                           .getType()
+                           .cast<RankedTensorType>()
+                           .getEncoding()
+                           .dyn_cast<ttg::MmaEncodingAttr>();
+      if (mmaLayout && mmaLayout.isHopper())
+        hasAsyncDot = true;
+    });
   }
 
   /// Collect loads to pipeline. Return success if we can pipeline this loop
@@ -151,10 +553,49 @@ ttg::AllocTensorOp LoopPipeliner::allocateEmptyBuffer(Operation *op,
   llvm_unreachable("Async copy's return should be of RankedTensorType");
 }
 
+Operation *
+LoopPipeliner::createInsertSliceTMA(OpBuilder &builder, triton::LoadOp loadOp,
+                                    Value buffer, Value index, Value pred,
+                                    function_ref<Value(Value)> mapFactor) {
+  const TMALoad &tma = tmaLoads[loadOp];
+  Location loc = loadOp.getLoc();
+  SmallVector<Value, 2> coords{
+      materialize(builder, loc, tma.col, mapFactor, pipelineIterIdx),
+      materialize(builder, loc, tma.row, mapFactor, pipelineIterIdx)};
+  auto insertOp = builder.create<ttg::InsertSliceTMAOp>(
+      loc, buffer.getType(), tma.desc, coords, buffer, index, pred,
+      tma.mbarrier, tma.multicast);
+  // Copies to a single CTA keep the default multicast
+  if (tma.multicast == 1)
+    insertOp->removeAttr(insertOp.multicastAttrName());
+  return insertOp;
+}
+
+Value LoopPipeliner::createIndexLoad(OpBuilder &builder, Value load,
+                                     Value iv) {
+  Value cond = builder.create<arith::CmpIOp>(
+      iv.getLoc(), arith::CmpIPredicate::slt, iv, forOp.getUpperBound());
+  BlockAndValueMapping mapping;
+  mapping.map(forOp.getInductionVar(), iv);
+  for (Operation *op : indexLoadChains[load])
+    if (op != load.getDefiningOp())
+      builder.clone(*op, mapping);
+  auto loadOp = load.getDefiningOp<triton::LoadOp>();
+  return createPredicatedLoad(builder, loadOp,
+                              mapping.lookupOrDefault(loadOp.ptr()),
+                              mapping.lookupOrDefault(loadOp.mask()),
+                              mapping.lookupOrDefault(loadOp.other()), cond);
+}
+
 /// A load instruction can be pipelined if:
-///   - the load doesn't depend on any other loads (after loop peeling)
+///   - the load doesn't depend on any other loads (after loop peeling), but
+///     for index loads, which only depend on the induction variable and on
+///     loop-invariant values, and which the load depends on through values
+///     computed in the same iteration
 ///   - (?) this load is not a loop-invariant value (we should run LICM before
 ///                                                  this pass?)
+/// Loads converted to dot operands are copied to shared memory, the others
+/// are prefetched into registers if the loop is innermost.
 LogicalResult LoopPipeliner::initialize() {
   Block *loop = forOp.getBody();
 
@@ -168,6 +609,14 @@ LogicalResult LoopPipeliner::initialize() {
   if (allLoads.empty())
     return failure();
 
+  bool isInnermost = true;
+  loop->walk([&](Operation *op) {
+    if (isa<triton::StoreOp, triton::AtomicRMWOp, triton::AtomicCASOp>(op))
+      hasWrites = true;
+    else if (isa<scf::ForOp>(op))
+      isInnermost = false;
+  });
+
   // load => values that it depends on
   DenseMap<Value, DenseSet<Value>> loadDeps;
   for (triton::LoadOp loadOp : allLoads) {
@@ -177,23 +626,50 @@ LogicalResult LoopPipeliner::initialize() {
     loadDeps[loadOp] = deps;
   }
 
+  auto isIndexLoad = [&](triton::LoadOp loadOp) {
+    return canIssueEarly(loadOp) &&
+           llvm::none_of(loadDeps[loadOp], [](Value dep) {
+             return dep.isa<BlockArgument>() ||
+                    isa<triton::LoadOp>(dep.getDefiningOp());
+           });
+  };
+
   // Don't pipeline loads that depend on other loads
   // (Because if a load depends on another load, this load needs to wait on the
   //  other load in the prologue, which is against the point of the pipeline
-  //  pass)
+  //  pass), unless they are index loads, issued one iteration earlier.
+  // load => index loads it depends on
+  DenseMap<Value, SmallVector<Value>> loadIndices;
   for (triton::LoadOp loadOp : allLoads) {
     bool isCandidate = true;
     for (triton::LoadOp other : allLoads) {
-      if (loadDeps[loadOp].contains(other)) {
+      if (!loadDeps[loadOp].contains(other))
+        continue;
+      if (!isIndexLoad(other)) {
         isCandidate = false;
         break;
       }
+      loadIndices[loadOp].push_back(other);
+    }
+    // Loop-carried values depending on index loads would need the indices of
+    // several iterations
+    for (Value dep : loadDeps[loadOp]) {
+      auto arg = dep.dyn_cast<BlockArgument>();
+      if (!isCandidate || !arg)
+        continue;
+      DenseSet<Value> argDeps;
+      collectDeps(yieldOp->getOperand(arg.getArgNumber() - 1), numStages - 2,
+                  argDeps);
+      isCandidate = llvm::none_of(allLoads, [&](triton::LoadOp other) {
+        return argDeps.contains(other);
+      });
     }
+    if (!isCandidate)
+      continue;
 
-    // We only pipeline loads that have one covert_layout (to dot_op) use
-    // TODO: lift this constraint in the future
-    if (isCandidate && loadOp.getResult().hasOneUse()) {
-      isCandidate = false;
+    // Loads that have one covert_layout (to dot_op) use are copied to shared
+    // memory
+    if (loadOp.getResult().hasOneUse()) {
       Operation *use = *loadOp.getResult().getUsers().begin();
       if (auto convertLayout = llvm::dyn_cast<ttg::ConvertLayoutOp>(use)) {
         if (auto tensorType = convertLayout.getResult()
@@ -201,7 +677,7 @@ LogicalResult LoopPipeliner::initialize() {
                                   .dyn_cast<RankedTensorType>()) {
           if (auto dotOpEnc = tensorType.getEncoding()
                                   .dyn_cast<ttg::DotOperandEncodingAttr>()) {
-            isCandidate = true;
+            loads.insert(loadOp);
             loadsMapping[loadOp] = convertLayout;
             auto ty = loadOp.getType().cast<RankedTensorType>();
             SmallVector<int64_t> bufferShape(ty.getShape().begin(),
@@ -215,17 +691,46 @@ LogicalResult LoopPipeliner::initialize() {
           }
         }
       }
-    } else
-      isCandidate = false;
+    }
+    // The others are prefetched into registers
+    if (!loads.contains(loadOp) && isInnermost && canIssueEarly(loadOp))
+      regLoads.insert(loadOp);
+  }
 
-    if (isCandidate)
-      loads.insert(loadOp);
+  // The registers holding the values of the next iterations are not
+  // available to the loop body
+  unsigned numStagedWords = 0;
+  regLoads.remove_if([&](Value loadOp) {
+    unsigned numWords =
+        (numStages - 1) * getNumWordsPerThread(loadOp.getType());
+    if (numStagedWords + numWords > kMaxStagedWords)
+      return true;
+    numStagedWords += numWords;
+    return false;
+  });
+
+  // Index loads are only issued for the loads that use them
+  for (triton::LoadOp loadOp : allLoads)
+    if (loads.contains(loadOp) || regLoads.contains(loadOp))
+      for (Value index : loadIndices[loadOp])
+        indexLoads.insert(index);
+  for (Value index : indexLoads) {
+    loads.remove(index);
+    regLoads.remove(index);
+    DenseSet<Operation *> chainOps{index.getDefiningOp()};
+    for (Value dep : loadDeps[index])
+      chainOps.insert(dep.getDefiningOp());
+    for (Operation &op : *loop)
+      if (chainOps.contains(&op))
+        indexLoadChains[index].push_back(&op);
   }
 
   // We have some loads to pipeline
-  if (!loads.empty()) {
+  if (!loads.empty() || !regLoads.empty()) {
     // Update depArgs & depOps
-    for (Value loadOp : loads) {
+    SmallVector<Value> pipelinedLoads(loads.begin(), loads.end());
+    pipelinedLoads.append(regLoads.begin(), regLoads.end());
+    for (Value loadOp : pipelinedLoads) {
       for (Value dep : loadDeps[loadOp]) {
         // TODO: we should record the stage that the value is depended on
         if (auto arg = dep.dyn_cast<BlockArgument>())
@@ -234,6 +739,15 @@ LogicalResult LoopPipeliner::initialize() {
           depOps.insert(dep.getDefiningOp());
       }
     }
+    if (hasTMA) {
+      TileAddressMatcher matcher(forOp);
+      for (Value loadOp : loads) {
+        auto tma = matcher.match(cast<triton::LoadOp>(loadOp.getDefiningOp()),
+                                 loadsBufferType[loadOp]);
+        if (tma)
+          tmaLoads[loadOp] = *tma;
+      }
+    }
     return success();
   }
 
@@ -250,6 +764,10 @@ void LoopPipeliner::emitPrologue() {
     OpOperand &operand = forOp.getOpOperandForRegionIterArg(arg);
     setValueMapping(arg, operand.get(), 0);
   }
+  for (Value loadOp : loads)
+    if (tmaLoads.count(loadOp))
+      builder.create<ttg::InitMBarrierOp>(loadOp.getLoc(),
+                                          tmaLoads[loadOp].mbarrier, numStages);
 
   // prologue from [0, numStage-1)
   Value iv = forOp.getLowerBound();
@@ -269,10 +787,11 @@ void LoopPipeliner::emitPrologue() {
     for (Operation &op : forOp.getLoopBody().front()) {
       if (depOps.contains(&op))
         orderedDeps.push_back(&op);
-      else if (loads.contains(op.getResult(0)))
+      else if (isPipelinedLoad(&op))
         orderedDeps.push_back(&op);
     }
-    assert(depOps.size() + loads.size() == orderedDeps.size() &&
+    assert(depOps.size() + loads.size() + regLoads.size() ==
+               orderedDeps.size() &&
            "depOps contains invalid values");
     for (Operation *op : orderedDeps) {
       Operation *newOp = nullptr;
@@ -283,7 +802,13 @@ void LoopPipeliner::emitPrologue() {
           loadStageBuffer[op->getResult(0)] = {loadsBuffer[op->getResult(0)]};
         }
         // load => copy async
-        if (auto loadOp = llvm::dyn_cast<triton::LoadOp>(op)) {
+        auto loadOp = llvm::dyn_cast<triton::LoadOp>(op);
+        if (loadOp && tmaLoads.count(loadOp)) {
+          newOp = createInsertSliceTMA(
+              builder, loadOp, loadStageBuffer[loadOp][stage], pipelineIterIdx,
+              loopCond, [&](Value v) { return lookupOrDefault(v, stage); });
+          loadStageBuffer[loadOp].push_back(newOp->getResult(0));
+        } else if (loadOp) {
           Value mask = lookupOrDefault(loadOp.mask(), stage);
           Value newMask;
           if (mask) {
@@ -306,6 +831,17 @@ void LoopPipeliner::emitPrologue() {
           loadStageBuffer[loadOp].push_back(newOp->getResult(0));
         } else
           llvm_unreachable("This should be LoadOp");
+      } else if (regLoads.contains(op->getResult(0)) ||
+                 indexLoads.contains(op->getResult(0))) {
+        auto loadOp = cast<triton::LoadOp>(op);
+        newOp = createPredicatedLoad(builder, loadOp,
+                                     lookupOrDefault(loadOp.ptr(), stage),
+                                     lookupOrDefault(loadOp.mask(), stage),
+                                     lookupOrDefault(loadOp.other(), stage),
+                                     loopCond)
+                    .getDefiningOp();
+        if (regLoads.contains(loadOp))
+          regLoadStages[loadOp].push_back(newOp->getResult(0));
       } else {
         newOp = builder.clone(*op);
         // Update loop-carried uses
@@ -327,7 +863,7 @@ void LoopPipeliner::emitPrologue() {
         Value originalResult = op->getResult(dstIdx);
         // copy_async will update the value of its only use
         // TODO: load should not be used in the preheader?
-        if (loads.contains(originalResult)) {
+        if (isPipelinedLoad(op)) {
           break;
           // originalResult = loadsMapping[originalResult];
         }
@@ -347,10 +883,25 @@ void LoopPipeliner::emitPrologue() {
         builder.create<arith::ConstantIntOp>(iv.getLoc(), 1, 32));
   } // for (int stage = 0; stage < numStages - 1; ++stage)
 
+  // Index loads are issued one iteration ahead of the loads using them
+  if (!indexLoads.empty()) {
+    Value nextIV = builder.create<arith::AddIOp>(iv.getLoc(), iv,
+                                                 forOp.getStep());
+    for (Value load : indexLoads)
+      indexLoadsNext[load] = createIndexLoad(builder, load, nextIV);
+  }
+
   // async.wait & extract_slice
-  builder.create<ttg::AsyncWaitOp>(loads[0].getLoc(),
-                                   loads.size() * (numStages - 2));
+  if (getNumAsyncCopies())
+    builder.create<ttg::AsyncWaitOp>(loads[0].getLoc(),
+                                     getNumAsyncCopies() * (numStages - 2));
   loopIterIdx = builder.create<arith::ConstantIntOp>(iv.getLoc(), 0, 32);
+  // The first phase of the first mbarrier completes with the first slice
+  for (Value loadOp : loads)
+    if (tmaLoads.count(loadOp))
+      builder.create<ttg::WaitMBarrierOp>(loadOp.getLoc(), loopIterIdx,
+                                          loopIterIdx,
+                                          tmaLoads[loadOp].mbarrier);
   for (Value loadOp : loads) {
     auto sliceType = loadsMapping[loadOp].getType().cast<RankedTensorType>();
     sliceType =
@@ -377,7 +928,8 @@ void LoopPipeliner::emitEpilogue() {
   OpBuilder builder(forOp);
   OpBuilder::InsertionGuard g(builder);
   builder.setInsertionPointAfter(forOp);
-  builder.create<triton::gpu::AsyncWaitOp>(forOp.getLoc(), 0);
+  if (getNumAsyncCopies())
+    builder.create<triton::gpu::AsyncWaitOp>(forOp.getLoc(), 0);
 }
 
 scf::ForOp LoopPipeliner::createNewForOp() {
@@ -387,6 +939,8 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   //   (original args)
   //   (insertSliceAsync buffer at stage numStages - 1) for each load
   //   (extracted tensor) for each load
+  //   (values at stages [0, numStages - 1)) for each register-staged load
+  //   (value at stage numStages - 1) for each index load
   //   (depArgs at stage numStages - 2)
   //   (iv at stage numStages - 2)
   //   (pipeline iteration index)
@@ -404,6 +958,13 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   size_t loadIdx = newLoopArgs.size();
   for (Value loadOp : loads)
     newLoopArgs.push_back(loadsExtract[loadOp]);
+  size_t regLoadIdx = newLoopArgs.size();
+  for (Value loadOp : regLoads)
+    newLoopArgs.append(regLoadStages[loadOp].begin(),
+                       regLoadStages[loadOp].end());
+  size_t indexLoadIdx = newLoopArgs.size();
+  for (Value loadOp : indexLoads)
+    newLoopArgs.push_back(indexLoadsNext[loadOp]);
 
   size_t depArgsBeginIdx = newLoopArgs.size();
   for (BlockArgument depArg : depArgs) {
@@ -452,16 +1013,26 @@ scf::ForOp LoopPipeliner::createNewForOp() {
     mapping.lookup(loadUse).getDefiningOp()->erase();
     mapping.lookup(load).getDefiningOp()->erase();
   }
+  for (size_t idx = 0; idx < regLoads.size(); ++idx) {
+    Value load = regLoads[idx];
+    Value current =
+        newForOp.getRegionIterArgs()[regLoadIdx + idx * (numStages - 1)];
+    Operation *clonedLoad = mapping.lookup(load).getDefiningOp();
+    clonedLoad->getResult(0).replaceAllUsesWith(current);
+    clonedLoad->erase();
+    mapping.map(load, current);
+  }
 
   // 4. prefetch the next iteration
   SmallVector<Operation *> orderedDeps;
   for (Operation &op : forOp.getLoopBody().front()) {
     if (depOps.contains(&op))
       orderedDeps.push_back(&op);
-    else if (loads.contains(op.getResult(0)))
+    else if (isPipelinedLoad(&op))
       orderedDeps.push_back(&op);
   }
-  assert(depOps.size() + loads.size() == orderedDeps.size() &&
+  assert(depOps.size() + loads.size() + regLoads.size() ==
+             orderedDeps.size() &&
          "depOps contains invalid values");
   BlockAndValueMapping nextMapping;
   DenseMap<BlockArgument, Value> depArgsMapping;
@@ -472,6 +1043,16 @@ scf::ForOp LoopPipeliner::createNewForOp() {
     nextMapping.map(arg, nextArg);
     ++argIdx;
   }
+  // The index loads of the next stage were issued in the previous iteration
+  for (size_t idx = 0; idx < indexLoads.size(); ++idx)
+    nextMapping.map(indexLoads[idx],
+                    newForOp.getRegionIterArgs()[indexLoadIdx + idx]);
+
+  // Emit the prefetch at the top of the body if copies must be in flight
+  // while the current stage is consumed. async_wait stays at the end.
+  OpBuilder::InsertPoint bodyEnd = builder.saveInsertionPoint();
+  if (issueCopiesFirst())
+    builder.setInsertionPointToStart(newForOp.getBody());
 
   // Special handling for iv & loop condition
   Value nextIV = builder.create<arith::AddIOp>(
@@ -485,20 +1066,22 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   // Slice index
   SmallVector<Value> nextBuffers;
   SmallVector<Value> extractSlices;
+  SmallVector<Value> nextRegLoads;
 
   pipelineIterIdx = newForOp.getRegionIterArgs()[nextIVIdx + 1];
   Value insertSliceIndex = builder.create<arith::RemSIOp>(
       nextIV.getLoc(), pipelineIterIdx,
       builder.create<arith::ConstantIntOp>(nextIV.getLoc(), numStages, 32));
   loopIterIdx = newForOp.getRegionIterArgs()[nextIVIdx + 2];
-  Value extractSliceIndex = builder.create<arith::RemSIOp>(
+  Value extractSliceIntIndex = builder.create<arith::RemSIOp>(
       nextIV.getLoc(), loopIterIdx,
       builder.create<arith::ConstantIntOp>(nextIV.getLoc(), numStages, 32));
-  extractSliceIndex = builder.create<arith::IndexCastOp>(
-      extractSliceIndex.getLoc(), builder.getIndexType(), extractSliceIndex);
+  Value extractSliceIndex = builder.create<arith::IndexCastOp>(
+      extractSliceIntIndex.getLoc(), builder.getIndexType(),
+      extractSliceIntIndex);
 
   for (Operation *op : orderedDeps)
-    if (!loads.contains(op->getResult(0))) {
+    if (!isPipelinedLoad(op) && !indexLoads.contains(op->getResult(0))) {
       Operation *nextOp = builder.clone(*op, nextMapping);
 
       auto originYield = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
@@ -521,29 +1104,40 @@ scf::ForOp LoopPipeliner::createNewForOp() {
     // Update loading mask
     if (loads.contains(op->getResult(0))) {
       auto loadOp = llvm::cast<triton::LoadOp>(op);
-      Value mask = loadOp.mask();
-      Value newMask;
-      if (mask) {
-        Value splatCond = builder.create<triton::SplatOp>(
-            mask.getLoc(), mask.getType(), nextLoopCond);
-        newMask = builder.create<arith::AndIOp>(
-            mask.getLoc(), splatCond, nextMapping.lookupOrDefault(mask));
-        // If mask is defined outside the loop, don't update the map more than
-        // once
-        if (!(forOp.isDefinedOutsideOfLoop(mask) && nextMapping.contains(mask)))
-          nextMapping.map(mask, newMask);
-        newMask = nextMapping.lookupOrDefault(loadOp.mask());
-      } else
-        newMask = builder.create<triton::SplatOp>(
-            loadOp.getLoc(), getI1SameShape(loadOp), nextLoopCond);
-      Value insertAsyncOp = builder.create<triton::gpu::InsertSliceAsyncOp>(
-          op->getLoc(), loadsBuffer[loadOp].getType(),
-          nextMapping.lookupOrDefault(loadOp.ptr()),
-          newForOp.getRegionIterArgs()[bufferIdx + nextBuffers.size()],
-          insertSliceIndex, newMask,
-          nextMapping.lookupOrDefault(loadOp.other()), loadOp.cache(),
-          loadOp.evict(), loadOp.isVolatile(), /*axis*/ 0);
-      builder.create<triton::gpu::AsyncCommitGroupOp>(op->getLoc());
+      Value buffer =
+          newForOp.getRegionIterArgs()[bufferIdx + nextBuffers.size()];
+      Value insertAsyncOp;
+      if (tmaLoads.count(loadOp)) {
+        insertAsyncOp =
+            createInsertSliceTMA(
+                builder, loadOp, buffer, insertSliceIndex, nextLoopCond,
+                [&](Value v) { return nextMapping.lookupOrDefault(v); })
+                ->getResult(0);
+      } else {
+        Value mask = loadOp.mask();
+        Value newMask;
+        if (mask) {
+          Value splatCond = builder.create<triton::SplatOp>(
+              mask.getLoc(), mask.getType(), nextLoopCond);
+          newMask = builder.create<arith::AndIOp>(
+              mask.getLoc(), splatCond, nextMapping.lookupOrDefault(mask));
+          // If mask is defined outside the loop, don't update the map more
+          // than once
+          if (!(forOp.isDefinedOutsideOfLoop(mask) &&
+                nextMapping.contains(mask)))
+            nextMapping.map(mask, newMask);
+          newMask = nextMapping.lookupOrDefault(loadOp.mask());
+        } else
+          newMask = builder.create<triton::SplatOp>(
+              loadOp.getLoc(), getI1SameShape(loadOp), nextLoopCond);
+        insertAsyncOp = builder.create<triton::gpu::InsertSliceAsyncOp>(
+            op->getLoc(), loadsBuffer[loadOp].getType(),
+            nextMapping.lookupOrDefault(loadOp.ptr()), buffer,
+            insertSliceIndex, newMask,
+            nextMapping.lookupOrDefault(loadOp.other()), loadOp.cache(),
+            loadOp.evict(), loadOp.isVolatile(), /*axis*/ 0);
+        builder.create<triton::gpu::AsyncCommitGroupOp>(op->getLoc());
+      }
       nextBuffers.push_back(insertAsyncOp);
       auto sliceType = loadsMapping[loadOp].getType().cast<RankedTensorType>();
       sliceType = RankedTensorType::get(sliceType.getShape(),
@@ -573,9 +1167,24 @@ scf::ForOp LoopPipeliner::createNewForOp() {
           }
         }
       }
+    } else if (regLoads.contains(op->getResult(0))) {
+      auto loadOp = cast<triton::LoadOp>(op);
+      nextRegLoads.push_back(createPredicatedLoad(
+          builder, loadOp, nextMapping.lookupOrDefault(loadOp.ptr()),
+          nextMapping.lookupOrDefault(loadOp.mask()),
+          nextMapping.lookupOrDefault(loadOp.other()), nextLoopCond));
     }
   }
 
+  // Index loads of the stage after the next one
+  SmallVector<Value> nextIndexLoads;
+  if (!indexLoads.empty()) {
+    Value nextNextIV = builder.create<arith::AddIOp>(nextIV.getLoc(), nextIV,
+                                                     newForOp.getStep());
+    for (Value load : indexLoads)
+      nextIndexLoads.push_back(createIndexLoad(builder, load, nextNextIV));
+  }
+
   {
     OpBuilder::InsertionGuard guard(builder);
     for (Operation &op : *newForOp.getBody()) {
@@ -606,11 +1215,30 @@ scf::ForOp LoopPipeliner::createNewForOp() {
   }
 
   // async.wait & extract_slice
-  Operation *asyncWait = builder.create<ttg::AsyncWaitOp>(
-      loads[0].getLoc(), loads.size() * (numStages - 2));
+  builder.restoreInsertionPoint(bodyEnd);
+  Operation *lastWait = nullptr;
+  if (getNumAsyncCopies())
+    lastWait = builder.create<ttg::AsyncWaitOp>(
+        loads[0].getLoc(), getNumAsyncCopies() * (numStages - 2));
+  if (!tmaLoads.empty()) {
+    // Slice i % numStages is completed by phase (i / numStages) % 2 of its
+    // mbarrier
+    Value phase = builder.create<arith::AndIOp>(
+        nextIV.getLoc(),
+        builder.create<arith::DivSIOp>(
+            nextIV.getLoc(), loopIterIdx,
+            builder.create<arith::ConstantIntOp>(nextIV.getLoc(), numStages,
+                                                 32)),
+        builder.create<arith::ConstantIntOp>(nextIV.getLoc(), 1, 32));
+    for (Value loadOp : loads)
+      if (tmaLoads.count(loadOp))
+        lastWait = builder.create<ttg::WaitMBarrierOp>(
+            loadOp.getLoc(), extractSliceIntIndex, phase,
+            tmaLoads[loadOp].mbarrier);
+  }
   for (auto it = extractSlices.rbegin(); it != extractSlices.rend(); ++it) {
-    // move extract_slice after asyncWait
-    it->getDefiningOp()->moveAfter(asyncWait);
+    // move extract_slice after the waits
+    it->getDefiningOp()->moveAfter(lastWait);
   }
 
   // Bump iteration count
@@ -629,6 +1257,15 @@ scf::ForOp LoopPipeliner::createNewForOp() {
     yieldValues.push_back(nextBuffer);
   for (Value nextSlice : extractSlices)
     yieldValues.push_back(nextSlice);
+  // The values of register-staged loads shift by one stage
+  for (size_t idx = 0; idx < regLoads.size(); ++idx) {
+    for (int stage = 1; stage < numStages - 1; ++stage)
+      yieldValues.push_back(
+          newForOp
+              .getRegionIterArgs()[regLoadIdx + idx * (numStages - 1) + stage]);
+    yieldValues.push_back(nextRegLoads[idx]);
+  }
+  yieldValues.append(nextIndexLoads.begin(), nextIndexLoads.end());
 
   for (size_t i = depArgsBeginIdx; i < nextIVIdx; ++i) {
     auto arg = newForOp.getRegionIterArgs()[i];
@@ -648,7 +1285,11 @@ scf::ForOp LoopPipeliner::createNewForOp() {
 // ref: mlir/lib/Dialect/SCF/Transforms/LoopPipelining.cpp
 struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
   PipelinePass() = default;
-  PipelinePass(int numStages) { this->numStages = numStages; }
+  PipelinePass(int numStages, int computeCapability, bool issueCopiesFirst) {
+    this->numStages = numStages;
+    this->computeCapability = computeCapability;
+    this->issueCopiesFirst = issueCopiesFirst;
+  }
 
   void runOnOperation() override {
     int numStages = this->numStages;
@@ -656,12 +1297,38 @@ struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
     if (numStages <= 1)
       return;
 
+    MLIRContext *context = &getContext();
+    bool hasTMA = ttg::InsertSliceTMAOp::isSupported(computeCapability);
+    int numMBarrierGroups = 0;
+    llvm::json::Array descriptors;
     getOperation()->walk([&](scf::ForOp forOp) -> void {
-      LoopPipeliner pipeliner(forOp, numStages);
+      LoopPipeliner pipeliner(forOp, numStages, hasTMA, issueCopiesFirst);
 
       if (pipeliner.initialize().failed())
         return;
 
+      // The address of the tensor map of each bulk copy is a new argument of
+      // the kernel, built by the launcher from the arguments of the copy
+      for (Value loadOp : pipeliner.loads) {
+        auto it = pipeliner.tmaLoads.find(loadOp);
+        if (it == pipeliner.tmaLoads.end())
+          continue;
+        TMALoad &tma = it->second;
+        auto func = forOp->getParentOfType<FuncOp>();
+        unsigned argIdx = func.getNumArguments();
+        func.insertArgument(
+            argIdx, triton::PointerType::get(IntegerType::get(context, 8), 1),
+            DictionaryAttr::get(context), forOp.getLoc());
+        tma.desc = func.getArgument(argIdx);
+        tma.mbarrier = numMBarrierGroups++;
+        descriptors.push_back(llvm::json::Object{
+            {"base", tma.baseArg},
+            {"row_stride", tma.rowStrideArg},
+            {"elem_size", tma.elemSize},
+            {"box", llvm::json::Array{tma.box[0], tma.box[1]}},
+            {"swizzle", tma.swizzle}});
+      }
+
       pipeliner.emitPrologue();
 
       scf::ForOp newForOp = pipeliner.createNewForOp();
@@ -673,10 +1340,21 @@ struct PipelinePass : public TritonGPUPipelineBase<PipelinePass> {
         forOp->getResult(i).replaceAllUsesWith(newForOp->getResult(i));
       forOp->erase();
     });
+
+    if (!descriptors.empty()) {
+      std::string str;
+      llvm::raw_string_ostream os(str);
+      os << llvm::json::Value(std::move(descriptors));
+      getOperation()->setAttr("triton_gpu.tma_descriptors",
+                              StringAttr::get(context, os.str()));
+    }
   }
 };
 } // anonymous namespace
 
-std::unique_ptr<Pass> mlir::createTritonGPUPipelinePass(int numStages) {
-  return std::make_unique<PipelinePass>(numStages);
+std::unique_ptr<Pass> mlir::createTritonGPUPipelinePass(int numStages,
+                                                        int computeCapability,
+                                                        bool issueCopiesFirst) {
+  return std::make_unique<PipelinePass>(numStages, computeCapability,
+                                        issueCopiesFirst);
 }
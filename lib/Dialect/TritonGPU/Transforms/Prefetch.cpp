@@ -43,8 +43,9 @@ class Prefetcher {
   scf::ForOp forOp;
   /// cache the YieldOp of this ForOp
   scf::YieldOp yieldOp;
-  ///
-  // TODO: add a hook to infer prefetchWidth
+  /// width of the K slices requested by the user, 0 to infer it
+  unsigned requestedWidth;
+  /// width of the K slices loaded one dot ahead
   unsigned prefetchWidth = 16;
 
   /// dots to be prefetched
@@ -69,10 +70,15 @@ class Prefetcher {
 public:
   Prefetcher() = delete;
 
-  Prefetcher(scf::ForOp forOp) : forOp(forOp) {
+  Prefetcher(scf::ForOp forOp, unsigned requestedWidth)
+      : forOp(forOp), requestedWidth(requestedWidth) {
     yieldOp = cast<scf::YieldOp>(forOp.getBody()->getTerminator());
   }
 
+  /// Returns the width of the K slices of a dot with the given K and operand
+  /// element width.
+  unsigned getPrefetchWidth(int64_t kSize, unsigned elementWidth) const;
+
   LogicalResult initialize();
 
   void emitPrologue();
@@ -120,6 +126,25 @@ Value Prefetcher::generatePrefetch(Value v, unsigned opIdx, bool isPrologue,
   return prefetchSlice;
 }
 
+unsigned Prefetcher::getPrefetchWidth(int64_t kSize,
+                                      unsigned elementWidth) const {
+  // K of one mma instruction: 256 bits of each row of A, i.e., 16 halves,
+  // 32 bytes or 8 tf32
+  unsigned mmaK = 256 / elementWidth;
+  // slices must be made of whole instructions and tile K
+  if (requestedWidth > 0 && requestedWidth % mmaK == 0 &&
+      kSize % requestedWidth == 0)
+    return requestedWidth;
+  // one instruction per slice hides the latency of ldmatrix behind the
+  // previous mma as long as there are few slices; for deeper tiles, wider
+  // slices keep at most 4 of them per iteration so that fewer, larger loads
+  // are in flight
+  unsigned width = mmaK;
+  while (width * 4 < kSize && kSize % (width * 2) == 0)
+    width *= 2;
+  return width;
+}
+
 LogicalResult Prefetcher::initialize() {
   Block *loop = forOp.getBody();
 
@@ -161,13 +186,26 @@ LogicalResult Prefetcher::initialize() {
     auto kSize = dot.a().getType().cast<RankedTensorType>().getShape()[1];
 
     // works better with nvidia tensor cores
-    unsigned elementWidth =
-        dot.a().getType().cast<RankedTensorType>().getElementTypeBitWidth();
-    prefetchWidth = 256 / elementWidth;
+    unsigned elementWidth = triton::getIntOrFloatBitWidth(
+        dot.a().getType().cast<RankedTensorType>().getElementType());
+    prefetchWidth = getPrefetchWidth(kSize, elementWidth);
 
     // Skip prefetching if kSize is less than prefetchWidth
     if (kSize < prefetchWidth)
       continue;
+    // wgmma reads its operands from shared memory, there is nothing to
+    // prefetch into registers
+    auto mmaLayout = dot.getResult()
+                         .getType()
+                         .cast<RankedTensorType>()
+                         .getEncoding()
+                         .dyn_cast<triton::gpu::MmaEncodingAttr>();
+    if (mmaLayout && mmaLayout.isHopper())
+      continue;
+    // Quantized weights are dequantized while they are loaded from shared
+    // memory, by the whole tile
+    if (isWeightOnlyQuantizedDot(dot))
+      continue;
     Value aSmem = getPrefetchSrc(dot.a());
     Value bSmem = getPrefetchSrc(dot.b());
     if (aSmem && bSmem) {
@@ -297,9 +335,12 @@ scf::ForOp Prefetcher::createNewForOp() {
 }
 
 struct PrefetchPass : public TritonGPUPrefetchBase<PrefetchPass> {
+  PrefetchPass() = default;
+  PrefetchPass(int prefetchWidth) { this->prefetchWidth = prefetchWidth; }
+
   void runOnOperation() override {
     getOperation()->walk([&](scf::ForOp forOp) {
-      Prefetcher prefetcher(forOp);
+      Prefetcher prefetcher(forOp, prefetchWidth);
 
       if (prefetcher.initialize().failed())
         return;
@@ -318,6 +359,6 @@ struct PrefetchPass : public TritonGPUPrefetchBase<PrefetchPass> {
 
 } // anonymous namespace
 
-std::unique_ptr<Pass> mlir::createTritonGPUPrefetchPass() {
-  return std::make_unique<PrefetchPass>();
+std::unique_ptr<Pass> mlir::createTritonGPUPrefetchPass(int prefetchWidth) {
+  return std::make_unique<PrefetchPass>(prefetchWidth);
 }
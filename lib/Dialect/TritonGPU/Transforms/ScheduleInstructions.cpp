@@ -0,0 +1,228 @@
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+#include "Utility.h"
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+using namespace mlir;
+
+//===----------------------------------------------------------------------===//
+//
+// This pass list-schedules the operations of each block of a TritonGPU
+// module. Operations are visited top-down, picking at each step a ready
+// operation according to:
+//
+//   - its latency-weighted height in the dependence graph, so that long
+//     latency operations (global loads, async copies, mma) start as early as
+//     possible, when the estimated number of live registers is within the
+//     budget;
+//   - the change in live registers it causes, when the budget is exceeded.
+//
+// The number of registers held by a value is estimated from the number of
+// elements its distributed layout assigns to each thread and from its element
+// width. Operations that have memory effects, that touch shared memory or that
+// have regions are kept in their original relative order, so that
+// synchronization (async_wait, barriers inserted later by the membar
+// analysis) and memory dependencies are preserved.
+//
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+constexpr unsigned kGlobalMemoryLatency = 400;
+constexpr unsigned kSharedMemoryLatency = 30;
+constexpr unsigned kMmaLatency = 30;
+
+bool isSharedEncoding(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  return tensorType && tensorType.getEncoding() &&
+         tensorType.getEncoding().isa<triton::gpu::SharedEncodingAttr>();
+}
+
+unsigned getLatency(Operation *op) {
+  if (isa<triton::LoadOp, triton::gpu::InsertSliceAsyncOp,
+          triton::gpu::InsertSliceTMAOp>(op))
+    return kGlobalMemoryLatency;
+  if (isa<triton::DotOp>(op))
+    return kMmaLatency;
+  if (auto cvt = dyn_cast<triton::gpu::ConvertLayoutOp>(op))
+    if (isSharedEncoding(cvt.src().getType()))
+      return kSharedMemoryLatency;
+  return 1;
+}
+
+/// Returns true if `op` must keep its position relative to the other ordered
+/// operations of its block.
+bool isOrdered(Operation *op) {
+  if (op->getNumRegions() || !MemoryEffectOpInterface::hasNoEffect(op))
+    return true;
+  auto isShared = [](Value value) { return isSharedEncoding(value.getType()); };
+  return llvm::any_of(op->getOperands(), isShared) ||
+         llvm::any_of(op->getResults(), isShared);
+}
+
+class BlockScheduler {
+public:
+  BlockScheduler(Block *block, unsigned registerBudget)
+      : block(block), registerBudget(registerBudget) {}
+
+  void run() {
+    buildGraph();
+    computeHeights();
+    schedule();
+  }
+
+private:
+  struct Node {
+    Operation *op;
+    SmallVector<unsigned> succs;
+    unsigned numPreds = 0;
+    unsigned height = 0;
+    /// Values defined in the block that this operation uses
+    SmallVector<Value> uses;
+  };
+
+  void buildGraph() {
+    Operation *terminator = block->getTerminator();
+    for (Operation &op : block->without_terminator()) {
+      nodeIds[&op] = nodes.size();
+      nodes.push_back({&op});
+    }
+    Optional<unsigned> lastOrdered;
+    for (unsigned id = 0; id < nodes.size(); ++id) {
+      Operation *op = nodes[id].op;
+      llvm::SetVector<Value> uses;
+      llvm::SetVector<unsigned> preds;
+      op->walk([&](Operation *nested) {
+        for (Value operand : nested->getOperands()) {
+          auto *def = operand.getDefiningOp();
+          if (!def)
+            continue;
+          auto *ancestor = block->findAncestorOpInBlock(*def);
+          if (!ancestor || ancestor == op)
+            continue;
+          uses.insert(operand);
+          preds.insert(nodeIds.lookup(ancestor));
+        }
+      });
+      if (isOrdered(op)) {
+        if (lastOrdered)
+          preds.insert(*lastOrdered);
+        lastOrdered = id;
+      }
+      for (unsigned pred : preds)
+        nodes[pred].succs.push_back(id);
+      nodes[id].numPreds = preds.size();
+      nodes[id].uses = uses.takeVector();
+      for (Value use : nodes[id].uses)
+        ++remainingUses[use];
+    }
+    // Values used by the terminator stay live until the end of the block
+    terminator->walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands())
+        if (auto *def = operand.getDefiningOp())
+          if (block->findAncestorOpInBlock(*def))
+            ++remainingUses[operand];
+    });
+  }
+
+  void computeHeights() {
+    for (unsigned id = nodes.size(); id-- > 0;) {
+      unsigned succHeight = 0;
+      for (unsigned succ : nodes[id].succs)
+        succHeight = std::max(succHeight, nodes[succ].height);
+      nodes[id].height = getLatency(nodes[id].op) + succHeight;
+    }
+  }
+
+  /// Returns the change in live registers caused by scheduling `id`.
+  int getPressureDelta(unsigned id) {
+    int delta = 0;
+    for (Value result : nodes[id].op->getResults())
+      if (remainingUses.lookup(result))
+        delta += getNumRegisters(result.getType());
+    for (Value use : nodes[id].uses)
+      if (remainingUses.lookup(use) == 1)
+        delta -= getNumRegisters(use.getType());
+    return delta;
+  }
+
+  void schedule() {
+    SmallVector<unsigned> ready;
+    for (unsigned id = 0; id < nodes.size(); ++id)
+      if (nodes[id].numPreds == 0)
+        ready.push_back(id);
+    int pressure = 0;
+    Operation *terminator = block->getTerminator();
+    while (!ready.empty()) {
+      bool overBudget = pressure > static_cast<int>(registerBudget);
+      // Ties are broken by the original order
+      auto getPriority = [&](unsigned id, int delta) {
+        int height = nodes[id].height;
+        return overBudget ? std::make_tuple(-delta, height, -(int)id)
+                          : std::make_tuple(height, -delta, -(int)id);
+      };
+      auto best = ready.begin();
+      int bestDelta = getPressureDelta(*best);
+      for (auto it = std::next(ready.begin()); it != ready.end(); ++it) {
+        int delta = getPressureDelta(*it);
+        if (getPriority(*it, delta) > getPriority(*best, bestDelta)) {
+          best = it;
+          bestDelta = delta;
+        }
+      }
+      unsigned id = *best;
+      ready.erase(best);
+      pressure += bestDelta;
+      for (Value use : nodes[id].uses)
+        --remainingUses[use];
+      nodes[id].op->moveBefore(terminator);
+      for (unsigned succ : nodes[id].succs)
+        if (--nodes[succ].numPreds == 0)
+          ready.push_back(succ);
+    }
+  }
+
+  Block *block;
+  unsigned registerBudget;
+  SmallVector<Node> nodes;
+  DenseMap<Operation *, unsigned> nodeIds;
+  DenseMap<Value, unsigned> remainingUses;
+};
+
+} // namespace
+
+class TritonGPUScheduleInstructionsPass
+    : public TritonGPUScheduleInstructionsBase<
+          TritonGPUScheduleInstructionsPass> {
+public:
+  TritonGPUScheduleInstructionsPass() = default;
+  TritonGPUScheduleInstructionsPass(int registerBudget) {
+    this->registerBudget = registerBudget;
+  }
+
+  void runOnOperation() override {
+    ModuleOp m = getOperation();
+    SmallVector<Block *> blocks;
+    m.walk([&](Block *block) {
+      if (isa<FuncOp, scf::ForOp, scf::IfOp>(block->getParentOp()) &&
+          !block->empty() &&
+          block->back().hasTrait<OpTrait::IsTerminator>())
+        blocks.push_back(block);
+    });
+    for (Block *block : blocks)
+      BlockScheduler(block, registerBudget).run();
+  }
+};
+
+std::unique_ptr<Pass>
+mlir::createTritonGPUScheduleInstructionsPass(int registerBudget) {
+  return std::make_unique<TritonGPUScheduleInstructionsPass>(registerBudget);
+}
@@ -0,0 +1,158 @@
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h"
+
+#include "Utility.h"
+
+//===----------------------------------------------------------------------===//
+//
+// This pass splits the mma dots whose accumulator and operand fragments don't
+// fit in the register budget of a thread into a chain of dots along K:
+//
+//   %a = triton_gpu.convert_layout %a_smem -> tensor<256x64xf16, #dot_op_a>
+//   %b = triton_gpu.convert_layout %b_smem -> tensor<64x256xf16, #dot_op_b>
+//   %d = tt.dot %a, %b, %c
+//
+// becomes
+//
+//   %a0 = tensor.extract_slice %a_smem[0, 0] [256, 16]
+//   %b0 = tensor.extract_slice %b_smem[0, 0] [16, 256]
+//   %d0 = tt.dot (convert_layout %a0), (convert_layout %b0), %c
+//   %a1 = tensor.extract_slice %a_smem[0, 16] [256, 16]
+//   ...
+//   %d = tt.dot (convert_layout %a3), (convert_layout %b3), %d2
+//
+// Each dot only loads the fragments of its K slice from shared memory, and the
+// lowering reuses each fragment for all the mma instructions of its rows (resp.
+// columns) of the accumulator. The width of the slices is halved until the
+// estimated number of live registers fits the budget, down to the K of one
+// mma instruction.
+//
+//===----------------------------------------------------------------------===//
+
+using namespace mlir;
+
+#define GEN_PASS_CLASSES
+#include "triton/Dialect/TritonGPU/Transforms/Passes.h.inc"
+
+namespace {
+
+// Returns the shared memory tensor that dot operand `v` is loaded from
+Value getSharedSrc(Value v) {
+  if (auto cvt = v.getDefiningOp<triton::gpu::ConvertLayoutOp>())
+    if (isSharedEncoding(cvt.src()))
+      return cvt.src();
+  return Value();
+}
+
+RankedTensorType getSliceType(RankedTensorType type, unsigned kIdx,
+                              int64_t width, Attribute encoding) {
+  SmallVector<int64_t> shape(type.getShape().begin(), type.getShape().end());
+  shape[kIdx] = width;
+  return RankedTensorType::get(shape, type.getElementType(), encoding);
+}
+
+// Returns the width of the K slices of `dot` that fit in `registerBudget`
+int64_t getSplitWidth(triton::DotOp dot, unsigned registerBudget) {
+  auto aType = dot.a().getType().cast<RankedTensorType>();
+  auto bType = dot.b().getType().cast<RankedTensorType>();
+  int64_t kSize = aType.getShape()[1];
+  // K of one mma instruction: 256 bits of each row of A
+  unsigned mmaK = 256 / triton::getIntOrFloatBitWidth(aType.getElementType());
+  auto fits = [&](int64_t width) {
+    unsigned numRegisters =
+        getNumRegisters(dot.getType()) +
+        getNumRegisters(getSliceType(aType, 1, width, aType.getEncoding())) +
+        getNumRegisters(getSliceType(bType, 0, width, bType.getEncoding()));
+    return numRegisters <= registerBudget;
+  };
+  int64_t width = kSize;
+  while (!fits(width) && width % 2 == 0 && width / 2 >= mmaK)
+    width /= 2;
+  return width;
+}
+
+Value sliceOperand(OpBuilder &builder, Value smem, Value operand,
+                   unsigned opIdx, int64_t offset, int64_t width) {
+  Location loc = operand.getLoc();
+  auto smemType = smem.getType().cast<RankedTensorType>();
+  auto operandType = operand.getType().cast<RankedTensorType>();
+  unsigned kIdx = opIdx == 0 ? 1 : 0;
+  auto intAttr = [&](int64_t val) { return builder.getI64IntegerAttr(val); };
+  SmallVector<OpFoldResult> offsets{intAttr(0), intAttr(0)};
+  offsets[kIdx] = intAttr(offset);
+  auto sliceType = getSliceType(smemType, kIdx, width, smemType.getEncoding());
+  Value slice = builder.create<tensor::ExtractSliceOp>(
+      loc, sliceType, smem, offsets,
+      SmallVector<OpFoldResult>{intAttr(sliceType.getShape()[0]),
+                                intAttr(sliceType.getShape()[1])},
+      SmallVector<OpFoldResult>{intAttr(1), intAttr(1)});
+  return builder.create<triton::gpu::ConvertLayoutOp>(
+      loc,
+      getSliceType(operandType, kIdx, width, operandType.getEncoding()),
+      slice);
+}
+
+void splitDot(triton::DotOp dot, unsigned registerBudget) {
+  auto mmaLayout = dot.getType()
+                       .cast<RankedTensorType>()
+                       .getEncoding()
+                       .dyn_cast<triton::gpu::MmaEncodingAttr>();
+  // wgmma reads its operands from shared memory, and the layouts of mma v1
+  // are only completed after this pass
+  if (!mmaLayout || !mmaLayout.isAmpere())
+    return;
+  // Quantized weights are dequantized while they are loaded from shared
+  // memory, by the whole tile
+  if (isWeightOnlyQuantizedDot(dot))
+    return;
+  // Operands converted from registers, such as the mma accumulators of
+  // chained dots, are not sliced
+  Value aSmem = getSharedSrc(dot.a());
+  Value bSmem = getSharedSrc(dot.b());
+  if (!aSmem || !bSmem)
+    return;
+  int64_t kSize = dot.a().getType().cast<RankedTensorType>().getShape()[1];
+  int64_t width = getSplitWidth(dot, registerBudget);
+  if (width == kSize)
+    return;
+
+  OpBuilder builder(dot);
+  Operation *aCvt = dot.a().getDefiningOp();
+  Operation *bCvt = dot.b().getDefiningOp();
+  Value acc = dot.c();
+  for (int64_t offset = 0; offset < kSize; offset += width) {
+    Value a = sliceOperand(builder, aSmem, dot.a(), 0, offset, width);
+    Value b = sliceOperand(builder, bSmem, dot.b(), 1, offset, width);
+    Operation *newDot = builder.clone(*dot);
+    newDot->setOperand(0, a);
+    newDot->setOperand(1, b);
+    newDot->setOperand(2, acc);
+    acc = newDot->getResult(0);
+  }
+  dot.replaceAllUsesWith(acc);
+  dot.erase();
+  if (aCvt->use_empty())
+    aCvt->erase();
+  if (bCvt != aCvt && bCvt->use_empty())
+    bCvt->erase();
+}
+
+} // anonymous namespace
+
+struct SplitDotsPass : public TritonGPUSplitDotsBase<SplitDotsPass> {
+  SplitDotsPass() = default;
+  SplitDotsPass(int registerBudget) { this->registerBudget = registerBudget; }
+
+  void runOnOperation() override {
+    SmallVector<triton::DotOp> dots;
+    getOperation().walk([&](triton::DotOp dot) { dots.push_back(dot); });
+    for (triton::DotOp dot : dots)
+      splitDot(dot, registerBudget);
+  }
+};
+
+std::unique_ptr<Pass> mlir::createTritonGPUSplitDotsPass(int registerBudget) {
+  return std::make_unique<SplitDotsPass>(registerBudget);
+}
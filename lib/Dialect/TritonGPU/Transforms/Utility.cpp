@@ -1,4 +1,6 @@
 #include "Utility.h"
+#include "triton/Analysis/Utility.h"
+#include "triton/Dialect/TritonGPU/IR/Dialect.h"
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -60,4 +62,72 @@ LogicalResult fixupLoops(ModuleOp mod) {
   return success();
 }
 
+unsigned getLayoutConversionCost(RankedTensorType srcType,
+                                 Attribute dstEncoding) {
+  Attribute srcEncoding = srcType.getEncoding();
+  if (srcEncoding == dstEncoding)
+    return 0;
+  auto dstType = RankedTensorType::get(srcType.getShape(),
+                                       srcType.getElementType(), dstEncoding);
+  auto elemTy = srcType.getElementType();
+  unsigned bytes =
+      elemTy.isa<triton::PointerType>()
+          ? 8
+          : std::max(8u, triton::getIntOrFloatBitWidth(elemTy)) / 8;
+  // A shuffle moves up to 4 bytes per thread, and costs about as much as a
+  // shared memory access of the same width
+  if (auto shuffle = getWarpShuffleConversion(srcType, dstType))
+    return shuffle->getNumShuffles() * std::max(4u, bytes) *
+           kSharedMemoryByteCost;
+  unsigned elems = triton::gpu::getElemsPerThread(srcType) +
+                   triton::gpu::getElemsPerThread(dstType);
+  // The conversion is done by replicas of the largest of the two CTA tiles,
+  // each of them surrounded by barriers
+  auto shape = srcType.getShape();
+  auto srcShapePerCTA = triton::gpu::getShapePerCTA(srcEncoding, shape);
+  auto dstShapePerCTA = triton::gpu::getShapePerCTA(dstEncoding, shape);
+  unsigned numReplicates = 1;
+  for (unsigned d = 0; d < shape.size(); ++d) {
+    int64_t perCTA = std::max<int64_t>(
+        std::min<int64_t>(shape[d], srcShapePerCTA[d]),
+        std::min<int64_t>(shape[d], dstShapePerCTA[d]));
+    numReplicates *= ceil<int64_t>(shape[d], perCTA);
+  }
+  return elems * bytes * kSharedMemoryByteCost +
+         2 * numReplicates * kBarrierCost;
+}
+
+unsigned getNumRegisters(Type type) {
+  auto tensorType = type.dyn_cast<RankedTensorType>();
+  if (!tensorType)
+    return 1;
+  // Shared memory tensors are only held as a base pointer and strides
+  auto encoding = tensorType.getEncoding();
+  if (!encoding || encoding.isa<triton::gpu::SharedEncodingAttr>())
+    return 0;
+  auto elemTy = tensorType.getElementType();
+  unsigned bitwidth = elemTy.isa<triton::PointerType>()
+                          ? 64
+                          : std::max(8u, triton::getIntOrFloatBitWidth(elemTy));
+  unsigned elems = 0;
+  auto dotOpLayout = encoding.dyn_cast<triton::gpu::DotOperandEncodingAttr>();
+  if (dotOpLayout &&
+      dotOpLayout.getParent().isa<triton::gpu::MmaEncodingAttr>()) {
+    // wgmma operands stay in shared memory
+    if (dotOpLayout.getParent()
+            .cast<triton::gpu::MmaEncodingAttr>()
+            .isHopper())
+      return 0;
+    // Each warp holds its rows (resp. columns) of the operand along the whole
+    // K dimension
+    auto warpsPerCTA = triton::gpu::getWarpsPerCTA(dotOpLayout.getParent());
+    unsigned warps = dotOpLayout.getOpIdx() == 0 ? warpsPerCTA[0]
+                                                 : warpsPerCTA[1];
+    elems = std::max<int64_t>(1, tensorType.getNumElements() / (32 * warps));
+  } else {
+    elems = triton::gpu::getElemsPerThread(type);
+  }
+  return (elems * bitwidth + 31) / 32;
+}
+
 } // namespace mlir
@@ -1,12 +1,28 @@
 #ifndef TRITON_LIB_DIALECT_TRITONGPU_TRANSFORMS_UTILITY_H_
 #define TRITON_LIB_DIALECT_TRITONGPU_TRANSFORMS_UTILITY_H_
 #include "mlir/IR/Matchers.h"
+#include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/PatternMatch.h"
 
 namespace mlir {
 
 LogicalResult fixupLoops(ModuleOp mod);
 
+/// Relative costs of the layout heuristics, in bytes of shared memory accessed
+/// per thread.
+constexpr unsigned kSharedMemoryByteCost = 1;
+constexpr unsigned kBarrierCost = 64;
+
+/// Returns the estimated cost of converting a tensor of type `srcType` to
+/// `dstEncoding`, with warp shuffles when the conversion stays within warps and
+/// through shared memory otherwise.
+unsigned getLayoutConversionCost(RankedTensorType srcType,
+                                 Attribute dstEncoding);
+
+/// Returns the estimated number of 32-bit registers needed to hold a value of
+/// the given type in each thread.
+unsigned getNumRegisters(Type type);
+
 } // namespace mlir
 
 #endif // TRITON_LIB_DIALECT_TRITONGPU_TRANSFORMS_UTILITY_H_
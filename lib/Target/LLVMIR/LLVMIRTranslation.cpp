@@ -3,7 +3,6 @@
 #include "mlir/Conversion/Passes.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/ExecutionEngine/ExecutionEngine.h"
-#include "mlir/ExecutionEngine/OptUtils.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
@@ -13,12 +12,20 @@
 #include "mlir/Target/LLVMIR/LLVMTranslationInterface.h"
 #include "mlir/Transforms/Passes.h"
 #include "triton/Conversion/TritonGPUToLLVM/TritonGPUToLLVMPass.h"
+#include "triton/Tools/CompileTimings.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include <filesystem>
+#include <mutex>
 
 namespace mlir {
 namespace triton {
@@ -27,6 +34,8 @@ namespace triton {
 // information from mlir module.
 struct NVVMMetadata {
   int maxntidx{-1};
+  int maxnreg{-1};
+  int minctasm{-1};
   bool isKernel{};
   // Free to extend with other information.
 };
@@ -48,6 +57,24 @@ static void amendLLVMFunc(llvm::Function *func, const NVVMMetadata &metadata) {
         ->addOperand(llvm::MDNode::get(ctx, md_args));
   }
 
+  if (metadata.maxnreg > 0) {
+    llvm::Metadata *mdArgs[] = {
+        llvm::ValueAsMetadata::get(func), llvm::MDString::get(ctx, "maxnreg"),
+        llvm::ValueAsMetadata::get(llvm::ConstantInt::get(
+            llvm::Type::getInt32Ty(ctx), metadata.maxnreg))};
+    module->getOrInsertNamedMetadata("nvvm.annotations")
+        ->addOperand(llvm::MDNode::get(ctx, mdArgs));
+  }
+
+  if (metadata.minctasm > 0) {
+    llvm::Metadata *mdArgs[] = {
+        llvm::ValueAsMetadata::get(func), llvm::MDString::get(ctx, "minctasm"),
+        llvm::ValueAsMetadata::get(llvm::ConstantInt::get(
+            llvm::Type::getInt32Ty(ctx), metadata.minctasm))};
+    module->getOrInsertNamedMetadata("nvvm.annotations")
+        ->addOperand(llvm::MDNode::get(ctx, mdArgs));
+  }
+
   if (metadata.isKernel) {
     llvm::Metadata *mdArgs[] = {
         llvm::ValueAsMetadata::get(func), llvm::MDString::get(ctx, "kernel"),
@@ -152,12 +179,78 @@ static void linkLibdevice(llvm::Module &module) {
   module.addModuleFlag(reflect);
 }
 
+// An extern library, read once per process for each version of the file,
+// and the names of the functions it defines.
+struct ExternLib {
+  llvm::sys::TimePoint<> modified;
+  uint64_t size;
+  std::unique_ptr<llvm::MemoryBuffer> buffer;
+  llvm::StringSet<> functions;
+};
+
+// Returns the extern library at `path`, or null if it can't be loaded. Kernels
+// are compiled concurrently, in their own LLVM contexts, so only the file is
+// shared and each kernel loads its own (lazy) module from it. Libraries are
+// cached by path and reloaded when the modification time or the size of the
+// file changes, e.g. when a new libdevice is installed at the same path.
+static std::shared_ptr<const ExternLib> getExternLib(llvm::StringRef path) {
+  static std::mutex mutex;
+  static llvm::StringMap<std::shared_ptr<const ExternLib>> libs;
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path, status))
+    return nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = libs.find(path);
+  if (it != libs.end() &&
+      it->second->modified == status.getLastModificationTime() &&
+      it->second->size == status.getSize())
+    return it->second;
+
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return nullptr;
+  auto lib = std::make_shared<ExternLib>();
+  lib->modified = status.getLastModificationTime();
+  lib->size = status.getSize();
+  lib->buffer = std::move(*buffer);
+  llvm::LLVMContext ctx;
+  llvm::SMDiagnostic err;
+  auto mod = llvm::getLazyIRModule(
+      llvm::MemoryBuffer::getMemBuffer(lib->buffer->getMemBufferRef()), err,
+      ctx);
+  if (!mod)
+    return nullptr;
+  // the bodies of lazily loaded functions aren't materialized, they are still
+  // definitions
+  for (auto &func : mod->functions())
+    if (!func.isDeclaration())
+      lib->functions.insert(func.getName());
+  // kernels still linking the previous version keep it alive
+  return libs[path] = std::move(lib);
+}
+
 static bool linkExternLib(llvm::Module &module, llvm::StringRef name,
                           llvm::StringRef path) {
-  llvm::SMDiagnostic err;
   auto &ctx = module.getContext();
+  auto lib = getExternLib(path);
+  if (!lib) {
+    llvm::errs() << "Failed to load " << path;
+    return true;
+  }
+  // skip libraries that define none of the functions the kernel calls
+  bool needed = llvm::any_of(module.functions(), [&](llvm::Function &func) {
+    return func.isDeclaration() && lib->functions.count(func.getName());
+  });
+  if (!needed)
+    return false;
 
-  auto extMod = llvm::parseIRFile(path, err, ctx);
+  // the module is loaded lazily and `LinkOnlyNeeded` materializes the
+  // functions the kernel references (and their callees) only, rather than
+  // parsing all of libdevice for each kernel
+  llvm::SMDiagnostic err;
+  auto extMod = llvm::getLazyIRModule(
+      llvm::MemoryBuffer::getMemBuffer(lib->buffer->getMemBufferRef()), err,
+      ctx, /*ShouldLazyLoadMetadata=*/true);
   if (!extMod) {
     llvm::errs() << "Failed to load " << path;
     return true;
@@ -181,8 +274,57 @@ static bool linkExternLib(llvm::Module &module, llvm::StringRef name,
   return false;
 }
 
+// Runs the default LLVM pipeline of level `options.optLevel`, but for the
+// passes in `options.disabledPasses`
+static void optimizeLLVMModule(llvm::Module &module,
+                               const LLVMOptions &options) {
+  llvm::OptimizationLevel level;
+  switch (options.optLevel) {
+  case 0:
+    level = llvm::OptimizationLevel::O0;
+    break;
+  case 1:
+    level = llvm::OptimizationLevel::O1;
+    break;
+  case 2:
+    level = llvm::OptimizationLevel::O2;
+    break;
+  default:
+    level = llvm::OptimizationLevel::O3;
+  }
+  llvm::PassInstrumentationCallbacks pic;
+  llvm::StringSet<> disabled;
+  for (const std::string &name : options.disabledPasses)
+    disabled.insert(name);
+  if (!disabled.empty())
+    pic.registerShouldRunOptionalPassCallback(
+        [&](llvm::StringRef className, llvm::Any) {
+          return !disabled.contains(className) &&
+                 !disabled.contains(pic.getPassNameForClassName(className));
+        });
+  llvm::PassBuilder pb(/*TM=*/nullptr, llvm::PipelineTuningOptions(),
+                       llvm::None, &pic);
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  pb.registerModuleAnalyses(mam);
+  pb.registerCGSCCAnalyses(cgam);
+  pb.registerFunctionAnalyses(fam);
+  pb.registerLoopAnalyses(lam);
+  pb.crossRegisterProxies(lam, fam, cgam, mam);
+  llvm::ModulePassManager mpm =
+      level == llvm::OptimizationLevel::O0
+          ? pb.buildO0DefaultPipeline(level)
+          : pb.buildPerModuleDefaultPipeline(level);
+  mpm.run(module, mam);
+}
+
 std::unique_ptr<llvm::Module>
-translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module) {
+translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module,
+                      ::triton::CompileTimings *timings,
+                      const LLVMOptions &options) {
+  auto start = ::triton::CompileTimings::Clock::now();
   DialectRegistry registry;
   mlir::registerLLVMDialectTranslation(registry);
   mlir::registerNVVMDialectTranslation(registry);
@@ -190,12 +332,22 @@ translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module) {
 
   llvm::DenseMap<llvm::StringRef, NVVMMetadata> nvvmMetadata;
   extractNVVMMetadata(module, &nvvmMetadata);
+  for (auto &it : nvvmMetadata) {
+    if (!it.second.isKernel)
+      continue;
+    if (options.maxRegisters > 0)
+      it.second.maxnreg = options.maxRegisters;
+    if (options.minBlocksPerSM > 0)
+      it.second.minctasm = options.minBlocksPerSM;
+  }
 
   auto llvmModule = mlir::translateModuleToLLVMIR(module, *llvmContext);
   if (!llvmModule) {
     llvm::errs() << "Failed to emit LLVM IR\n";
     return nullptr;
   }
+  if (timings)
+    timings->record("llvm-translate", start);
 
   // Link external libraries before perform optimizations
   // Note from libdevice users guide:
@@ -205,20 +357,21 @@ translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module) {
   // generation passes. This allows the optimizers to inline and perform
   // analyses on the used library functions, and eliminate any used functions as
   // dead code.
+  start = ::triton::CompileTimings::Clock::now();
   auto externLibs = getExternLibs(module);
   for (auto &lib : externLibs) {
     if (linkExternLib(*llvmModule, lib.first, lib.second))
       return nullptr;
   }
+  if (timings && !externLibs.empty())
+    timings->record("llvm-link", start);
 
-  auto optPipeline = mlir::makeOptimizingTransformer(
-      /*optLevel=*/3, /*sizeLevel=*/0,
-      /*targetMachine=*/nullptr);
-
-  if (auto err = optPipeline(llvmModule.get())) {
-    llvm::errs() << "Failed to optimize LLVM IR " << err << "\n";
-    return nullptr;
-  }
+  // The timers of the LLVM passes are global to the process, while kernels
+  // are compiled concurrently, so the pipeline is timed as a whole
+  start = ::triton::CompileTimings::Clock::now();
+  optimizeLLVMModule(*llvmModule, options);
+  if (timings)
+    timings->record("llvm-opt", start);
 
   for (auto &func : llvmModule->functions()) {
     auto it = nvvmMetadata.find(func.getName());
@@ -231,9 +384,14 @@ translateLLVMToLLVMIR(llvm::LLVMContext *llvmContext, mlir::ModuleOp module) {
 
 std::unique_ptr<llvm::Module>
 translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
-                           mlir::ModuleOp module, int computeCapability) {
+                           mlir::ModuleOp module, int computeCapability,
+                           ::triton::CompileTimings *timings, bool fastMath,
+                           bool nativeLoadStore, const LLVMOptions &options) {
   mlir::PassManager pm(module->getContext());
   applyPassManagerCLOptions(pm);
+  if (timings)
+    pm.addInstrumentation(
+        std::make_unique<::triton::PassTimingInstrumentation>(*timings));
   auto printingFlags = mlir::OpPrintingFlags();
   printingFlags.elideLargeElementsAttrs(16);
   pm.enableIRPrinting(
@@ -246,7 +404,8 @@ translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
       /*printAfterOnlyOnChange=*/true,
       /*printAfterOnlyOnFailure*/ false, llvm::dbgs(), printingFlags);
 
-  pm.addPass(createConvertTritonGPUToLLVMPass(computeCapability));
+  pm.addPass(createConvertTritonGPUToLLVMPass(computeCapability, fastMath,
+                                              nativeLoadStore));
   // Canonicalize to eliminate the remaining UnrealizedConversionCastOp
   pm.addPass(mlir::createCanonicalizerPass());
   pm.addPass(mlir::createCSEPass()); // Simplify the IR to improve readability.
@@ -258,7 +417,7 @@ translateTritonGPUToLLVMIR(llvm::LLVMContext *llvmContext,
     return nullptr;
   }
 
-  auto llvmIR = translateLLVMToLLVMIR(llvmContext, module);
+  auto llvmIR = translateLLVMToLLVMIR(llvmContext, module, timings, options);
   if (!llvmIR) {
     llvm::errs() << "Translate to LLVM IR failed";
     return nullptr;
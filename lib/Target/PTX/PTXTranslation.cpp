@@ -1,21 +1,32 @@
 #include "triton/Target/PTX/PTXTranslation.h"
 #include "triton/Target/LLVMIR/LLVMIRTranslation.h"
 
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 namespace triton {
 
 static void initLLVM() {
-  LLVMInitializeNVPTXTargetInfo();
-  LLVMInitializeNVPTXTarget();
-  LLVMInitializeNVPTXTargetMC();
-  LLVMInitializeNVPTXAsmPrinter();
+  // Kernels may be translated from several threads at once.
+  static std::once_flag initFlag;
+  std::call_once(initFlag, []() {
+    LLVMInitializeNVPTXTargetInfo();
+    LLVMInitializeNVPTXTarget();
+    LLVMInitializeNVPTXTargetMC();
+    LLVMInitializeNVPTXAsmPrinter();
+  });
 }
 
 static bool findAndReplace(std::string &str, const std::string &begin,
@@ -30,7 +41,92 @@ static bool findAndReplace(std::string &str, const std::string &begin,
   return true;
 }
 
-std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
+// Creating a target machine costs about as much as translating a small kernel,
+// so each thread keeps the machines it created for the next translations with
+// the same options. They are not shared by threads, which would have to
+// serialize code generation.
+static llvm::TargetMachine *getTargetMachine(const std::string &triple,
+                                             const std::string &proc,
+                                             bool fastMath, int optLevel,
+                                             FPContraction contraction) {
+  using Key = std::tuple<std::string, bool, int, FPContraction>;
+  thread_local std::map<Key, std::unique_ptr<llvm::TargetMachine>> machines;
+  auto &machine = machines[Key(proc, fastMath, optLevel, contraction)];
+  if (machine)
+    return machine.get();
+
+  std::string error;
+  auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+  llvm::TargetOptions opt;
+  switch (contraction) {
+  case FPContraction::Fast:
+    opt.AllowFPOpFusion = llvm::FPOpFusion::Fast;
+    break;
+  case FPContraction::On:
+    opt.AllowFPOpFusion = llvm::FPOpFusion::Standard;
+    break;
+  case FPContraction::Off:
+    opt.AllowFPOpFusion = llvm::FPOpFusion::Strict;
+    break;
+  }
+  opt.UnsafeFPMath = fastMath;
+  opt.NoInfsFPMath = fastMath;
+  opt.NoNaNsFPMath = true;
+  opt.NoSignedZerosFPMath = fastMath;
+  opt.ApproxFuncFPMath = fastMath;
+  llvm::CodeGenOpt::Level codeGenLevel[] = {
+      llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less,
+      llvm::CodeGenOpt::Default, llvm::CodeGenOpt::Aggressive};
+  machine.reset(target->createTargetMachine(
+      triple, proc, /*features=*/"", opt, llvm::Reloc::PIC_, llvm::None,
+      codeGenLevel[optLevel]));
+  return machine.get();
+}
+
+std::unique_ptr<llvm::Module>
+linkKernelModules(std::vector<std::unique_ptr<llvm::Module>> modules) {
+  if (modules.empty())
+    return nullptr;
+  uint64_t smemAlign = 1;
+  for (auto &module : modules) {
+    // the kernels are annotated with !{<kernel>, !"kernel", i32 1}
+    llvm::SmallPtrSet<llvm::GlobalValue *, 4> kernels;
+    if (auto *annotations = module->getNamedMetadata("nvvm.annotations"))
+      for (llvm::MDNode *node : annotations->operands()) {
+        if (node->getNumOperands() < 2)
+          continue;
+        auto *kind = llvm::dyn_cast<llvm::MDString>(node->getOperand(1));
+        if (!kind || kind->getString() != "kernel")
+          continue;
+        auto *kernel = llvm::mdconst::dyn_extract_or_null<llvm::GlobalValue>(
+            node->getOperand(0));
+        if (kernel)
+          kernels.insert(kernel);
+      }
+    // each module has its own copy of the libdevice functions it calls, which
+    // are renamed by the linker once internal
+    for (llvm::GlobalValue &value : module->global_values())
+      if (!value.isDeclaration() && !value.hasLocalLinkage() &&
+          !kernels.count(&value))
+        value.setLinkage(llvm::GlobalValue::InternalLinkage);
+    // the kernels share the declaration of their dynamic shared memory
+    if (auto *smem = module->getGlobalVariable("global_smem"))
+      smemAlign = std::max<uint64_t>(smemAlign, smem->getAlignment());
+  }
+
+  std::unique_ptr<llvm::Module> linked = std::move(modules.front());
+  llvm::Linker linker(*linked);
+  for (auto &module : llvm::drop_begin(modules))
+    if (linker.linkInModule(std::move(module)))
+      return nullptr;
+  if (auto *smem = linked->getGlobalVariable("global_smem"))
+    smem->setAlignment(llvm::Align(smemAlign));
+  return linked;
+}
+
+std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version,
+                                 bool fastMath, int optLevel,
+                                 FPContraction contraction) {
   // LLVM version in use may not officially support target hardware.
   // Supported versions for LLVM 14 are here:
   // https://github.com/llvm/llvm-project/blob/f28c006a5895fc0e329fe15fead81e37457cb1d1/clang/include/clang/Basic/BuiltinsNVPTX.def
@@ -51,8 +147,6 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
   std::string triple = "nvptx64-nvidia-cuda";
   std::string proc = "sm_" + std::to_string(maxCC);
   std::string layout = "";
-  std::string features = "";
-  // std::string features = "+ptx" + std::to_string(maxPTX);
   initLLVM();
   // verify and store llvm
   llvm::legacy::PassManager pm;
@@ -62,17 +156,8 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
 
   // create machine
   module.setTargetTriple(triple);
-  std::string error;
-  auto target =
-      llvm::TargetRegistry::lookupTarget(module.getTargetTriple(), error);
-  llvm::TargetOptions opt;
-  opt.AllowFPOpFusion = llvm::FPOpFusion::Fast;
-  opt.UnsafeFPMath = false;
-  opt.NoInfsFPMath = false;
-  opt.NoNaNsFPMath = true;
-  llvm::TargetMachine *machine = target->createTargetMachine(
-      module.getTargetTriple(), proc, features, opt, llvm::Reloc::PIC_,
-      llvm::None, llvm::CodeGenOpt::Aggressive);
+  llvm::TargetMachine *machine = getTargetMachine(
+      triple, proc, fastMath, std::clamp(optLevel, 0, 3), contraction);
   // set data layout
   if (layout.empty())
     module.setDataLayout(machine->createDataLayout());
@@ -88,8 +173,23 @@ std::string translateLLVMIRToPTX(llvm::Module &module, int cc, int version) {
                                llvm::CodeGenFileType::CGFT_AssemblyFile);
   pass.run(module);
 
+  // The code emitted for sm_86 runs unchanged on sm_89 and sm_90, which LLVM
+  // 14 does not know of. Advertise the actual target so that ptxas accepts
+  // the instructions of inline assembly that are specific to them (e.g., fp8
+  // conversions and MMAs, or bulk tensor copies).
+  int minTargetPTX = cc >= 90 ? 80 : 78;
+  if (cc > maxCC && version >= minTargetPTX) {
+    sm = "sm_" + std::to_string(cc);
+    ptxMajor = version / 10;
+    ptxMinor = version % 10;
+  }
+
   // post-process
   std::string result(buffer.begin(), buffer.end());
+  // Warpgroup MMAs are only available on the architecture-specific target
+  if (cc >= 90 && version >= 80 &&
+      result.find("wgmma.mma_async") != std::string::npos)
+    sm += "a";
   findAndReplace(result, ".version", "\n",
                  ".version " + std::to_string(ptxMajor) + "." +
                      std::to_string(ptxMinor) + "\n");
@@ -147,6 +147,9 @@ class CMakeBuild(build_ext):
         ]
         if lit_dir is not None:
             cmake_args.append("-DLLVM_EXTERNAL_LIT=" + lit_dir)
+        # compiler microbenchmarks (bin/triton-bench)
+        if check_env_flag("TRITON_BUILD_BENCHMARKS"):
+            cmake_args.append("-DTRITON_BUILD_BENCHMARKS=ON")
         cmake_args.extend(thirdparty_cmake_args)
 
         # configuration
@@ -13,6 +13,7 @@
 
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "triton/Analysis/Allocation.h"
+#include "triton/BuildFingerprint.h"
 #include "triton/Conversion/TritonGPUToLLVM/TritonGPUToLLVMPass.h"
 #include "triton/Conversion/TritonToTritonGPU/TritonToTritonGPUPass.h"
 #include "triton/Dialect/Triton/IR/Dialect.h"
@@ -21,6 +22,7 @@
 #include "triton/Dialect/TritonGPU/Transforms/Passes.h"
 #include "triton/Target/LLVMIR/LLVMIRTranslation.h"
 #include "triton/Target/PTX/PTXTranslation.h"
+#include "triton/Tools/CompileTimings.h"
 #include "triton/Tools/Sys/GetEnv.hpp"
 
 #include "llvm/IR/LegacyPassManager.h"
@@ -28,12 +30,14 @@
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "llvm/Support/SourceMgr.h"
 
 #include <Python.h>
 #include <cctype>
+#include <cstdint>
 #include <fstream>
 #include <optional>
 #include <pybind11/buffer_info.h>
@@ -54,6 +58,178 @@ enum backend_t {
   ROCM,
 };
 
+/*****************************************************************************/
+/* Kernel dispatcher                                                         */
+/*****************************************************************************/
+
+// Computes the keys of the cache of the compiled kernels of a JITFunction from
+// the arguments of its launcher. The keys are those of JITFunction._key_of and
+// JITFunction._spec_of, which the launchers used to build in Python.
+class KernelDispatcher {
+public:
+  enum ArgKind { SPECIALIZED = 0, NOT_SPECIALIZED = 1, CONSTEXPR = 2 };
+
+  KernelDispatcher(py::object versionKey, std::vector<int> kinds,
+                   long long divisibility)
+      : versionKey(std::move(versionKey)), divisibility(divisibility) {
+    for (int kind : kinds)
+      this->kinds.push_back(static_cast<ArgKind>(kind));
+    for (ArgKind kind : this->kinds) {
+      numRegular += kind != CONSTEXPR;
+      numConstexpr += kind == CONSTEXPR;
+      numSpecialized += kind == SPECIALIZED;
+    }
+    dtypeStr = py::reinterpret_steal<py::object>(
+        PyUnicode_InternFromString("dtype"));
+    dataPtrStr = py::reinterpret_steal<py::object>(
+        PyUnicode_InternFromString("data_ptr"));
+    untypedStorageStr = py::reinterpret_steal<py::object>(
+        PyUnicode_InternFromString("untyped_storage"));
+    i1 = py::str("i1");
+    i32 = py::str("i32");
+    u32 = py::str("u32");
+    i64 = py::str("i64");
+    u64 = py::str("u64");
+    fp32 = py::str("fp32");
+  }
+
+  // (version_key, sig_key, constexpr_key, spec_key)
+  py::tuple key(py::args args) {
+    if (args.size() != kinds.size())
+      throw std::invalid_argument("expected " + std::to_string(kinds.size()) +
+                                  " arguments, got " +
+                                  std::to_string(args.size()));
+    py::tuple sigKey(numRegular);
+    py::tuple constexprKey(numConstexpr);
+    py::tuple specKey(numSpecialized);
+    size_t regular = 0, constexprs = 0, specialized = 0;
+    for (size_t i = 0; i < kinds.size(); ++i) {
+      PyObject *arg = PyTuple_GET_ITEM(args.ptr(), i);
+      if (kinds[i] == CONSTEXPR) {
+        constexprKey[constexprs++] = py::reinterpret_borrow<py::object>(arg);
+        continue;
+      }
+      sigKey[regular++] = typeKey(arg);
+      if (kinds[i] == SPECIALIZED)
+        specKey[specialized++] = specializationKey(arg);
+    }
+    return py::make_tuple(versionKey, sigKey, constexprKey, specKey);
+  }
+
+private:
+  // Returns the attribute `name` of `arg`, or a null object if it has none
+  py::object getAttr(PyObject *arg, const py::object &name) {
+    PyObject *attr = PyObject_GetAttr(arg, name.ptr());
+    if (!attr) {
+      if (!PyErr_ExceptionMatches(PyExc_AttributeError))
+        throw py::error_already_set();
+      PyErr_Clear();
+    }
+    return py::reinterpret_steal<py::object>(attr);
+  }
+
+  py::object intTypeKey(PyObject *arg) {
+    int overflow = 0;
+    long long value = PyLong_AsLongLongAndOverflow(arg, &overflow);
+    if (value == -1 && PyErr_Occurred())
+      throw py::error_already_set();
+    if (overflow > 0) {
+      PyLong_AsUnsignedLongLong(arg);
+      if (!PyErr_Occurred())
+        return u64;
+      PyErr_Clear();
+      return i64;
+    }
+    if (overflow < 0)
+      return i64;
+    if (value >= INT32_MIN && value <= INT32_MAX)
+      return i32;
+    if (value <= UINT32_MAX)
+      return u32;
+    return i64;
+  }
+
+  py::object typeKey(PyObject *arg) {
+    // builtin values have no dtype, which is checked first for anything else
+    if (arg == Py_None)
+      return py::none();
+    if (PyBool_Check(arg))
+      return i1;
+    if (PyLong_CheckExact(arg))
+      return intTypeKey(arg);
+    if (PyFloat_CheckExact(arg))
+      return fp32;
+    if (py::object dtype = getAttr(arg, dtypeStr))
+      return dtype;
+    if (PyLong_Check(arg))
+      return intTypeKey(arg);
+    if (PyFloat_Check(arg))
+      return fp32;
+    throw py::type_error(
+        std::string("Unsupported type ") +
+        py::str(py::handle(reinterpret_cast<PyObject *>(Py_TYPE(arg))))
+            .cast<std::string>() +
+        " for " + py::str(arg).cast<std::string>());
+  }
+
+  bool isDivisible(PyObject *value) {
+    int overflow = 0;
+    long long v = PyLong_AsLongLongAndOverflow(value, &overflow);
+    if (v == -1 && PyErr_Occurred())
+      throw py::error_already_set();
+    if (!overflow)
+      return v % divisibility == 0;
+    py::object rem = py::reinterpret_steal<py::object>(
+        PyNumber_Remainder(value, py::int_(divisibility).ptr()));
+    if (!rem)
+      throw py::error_already_set();
+    return !PyObject_IsTrue(rem.ptr());
+  }
+
+  // Whether the storage of the tensor `arg` is below 2GB, so that the offsets
+  // of its elements fit in 32 bits
+  bool isSmall(PyObject *arg) {
+    py::object storage = getAttr(arg, untypedStorageStr);
+    if (!storage)
+      return false;
+    py::object nbytes = storage().attr("nbytes")();
+    int overflow = 0;
+    long long value = PyLong_AsLongLongAndOverflow(nbytes.ptr(), &overflow);
+    if (value == -1 && PyErr_Occurred())
+      throw py::error_already_set();
+    return !overflow && value < (1LL << 31);
+  }
+
+  py::object specializationKey(PyObject *arg) {
+    if (arg != Py_None && !PyLong_CheckExact(arg) && !PyBool_Check(arg) &&
+        !PyFloat_CheckExact(arg)) {
+      if (py::object dataPtr = getAttr(arg, dataPtrStr)) {
+        py::object ptr = dataPtr();
+        if (!PyLong_Check(ptr.ptr()))
+          throw py::type_error("data_ptr() must return an int");
+        return py::make_tuple(isDivisible(ptr.ptr()), isSmall(arg));
+      }
+    }
+    if (PyLong_Check(arg)) {
+      int overflow = 0;
+      long long value = PyLong_AsLongLongAndOverflow(arg, &overflow);
+      if (value == -1 && PyErr_Occurred())
+        throw py::error_already_set();
+      return py::make_tuple(isDivisible(arg), !overflow && value == 1);
+    }
+    return py::make_tuple(false);
+  }
+
+  py::object versionKey;
+  std::vector<ArgKind> kinds;
+  long long divisibility;
+  size_t numRegular = 0;
+  size_t numConstexpr = 0;
+  size_t numSpecialized = 0;
+  py::object dtypeStr, dataPtrStr, untypedStorageStr;
+  py::object i1, i32, u32, i64, u64, fp32;
+};
+
 void init_triton_runtime(py::module &&m) {
   // wrap backend_t
   py::enum_<backend_t>(m, "backend")
@@ -61,6 +237,11 @@ void init_triton_runtime(py::module &&m) {
       .value("CUDA", CUDA)
       // .value("ROCM", ROCM)
       .export_values();
+
+  py::class_<KernelDispatcher>(m, "dispatcher")
+      .def(py::init<py::object, std::vector<int>, long long>(),
+           py::arg("version_key"), py::arg("kinds"), py::arg("divisibility"))
+      .def("key", &KernelDispatcher::key);
 }
 
 /*****************************************************************************/
@@ -75,12 +256,16 @@ void init_triton_ir(py::module &&m) {
       .value("NONE", mlir::triton::CacheModifier::NONE)
       .value("CA", mlir::triton::CacheModifier::CA)
       .value("CG", mlir::triton::CacheModifier::CG)
+      .value("CS", mlir::triton::CacheModifier::CS)
+      .value("WT", mlir::triton::CacheModifier::WT)
+      .value("NC", mlir::triton::CacheModifier::NC)
       .export_values();
 
   py::enum_<mlir::triton::EvictionPolicy>(m, "EVICTION_POLICY")
       .value("NORMAL", mlir::triton::EvictionPolicy::NORMAL)
       .value("EVICT_FIRST", mlir::triton::EvictionPolicy::EVICT_FIRST)
       .value("EVICT_LAST", mlir::triton::EvictionPolicy::EVICT_LAST)
+      .value("NO_ALLOCATE", mlir::triton::EvictionPolicy::NO_ALLOCATE)
       .export_values();
 
   py::enum_<mlir::triton::RedOp>(m, "REDUCE_OP")
@@ -121,6 +306,18 @@ void init_triton_ir(py::module &&m) {
         self.getOrLoadDialect<mlir::triton::TritonDialect>();
         self.getOrLoadDialect<mlir::LLVM::LLVMDialect>();
         self.getOrLoadDialect<mlir::gpu::GPUDialect>();
+      })
+      // Loads the dialects of all the stages up to the lowering to LLVM, so
+      // that a context reused by successive compilations loads them once
+      .def("load_compiler_dialects", [](mlir::MLIRContext &self) {
+        mlir::DialectRegistry registry;
+        registry.insert<mlir::triton::TritonDialect,
+                        mlir::triton::gpu::TritonGPUDialect,
+                        mlir::math::MathDialect, mlir::arith::ArithmeticDialect,
+                        mlir::StandardOpsDialect, mlir::scf::SCFDialect,
+                        mlir::LLVM::LLVMDialect, mlir::gpu::GPUDialect>();
+        self.appendDialectRegistry(registry);
+        self.loadAllAvailableDialects();
       });
   // .def(py::init([](){
   //   mlir::MLIRContext context;
@@ -254,6 +451,7 @@ void init_triton_ir(py::module &&m) {
   py::class_<mlir::Attribute>(m, "attribute");
   py::class_<mlir::IntegerAttr, mlir::Attribute>(m, "integer_attr");
   py::class_<mlir::BoolAttr, mlir::Attribute>(m, "bool_attr");
+  py::class_<mlir::UnitAttr, mlir::Attribute>(m, "unit_attr");
 
   // Ops
   py::class_<mlir::OpState>(m, "OpState")
@@ -334,13 +532,17 @@ void init_triton_ir(py::module &&m) {
            [](mlir::ModuleOp &self, std::string &funcName) -> mlir::FuncOp {
              return self.lookupSymbol<mlir::FuncOp>(funcName);
            })
-      .def("get_single_function", [](mlir::ModuleOp &self) -> mlir::FuncOp {
-        llvm::SmallVector<mlir::FuncOp> funcs;
-        self.walk([&](mlir::FuncOp func) { funcs.push_back(func); });
-        if (funcs.size() != 1)
-          throw std::runtime_error("Expected a single function");
-        return funcs[0];
-      });
+      .def("get_single_function",
+           [](mlir::ModuleOp &self) -> mlir::FuncOp {
+             llvm::SmallVector<mlir::FuncOp> funcs;
+             self.walk([&](mlir::FuncOp func) { funcs.push_back(func); });
+             if (funcs.size() != 1)
+               throw std::runtime_error("Expected a single function");
+             return funcs[0];
+           })
+      // Python handles don't own their module: its operations are only freed
+      // by erasing it, after which the handle must not be used
+      .def("erase", [](mlir::ModuleOp &self) { self->erase(); });
 
   m.def("make_attr",
         [](const std::vector<int> &values, mlir::MLIRContext &context) {
@@ -459,6 +661,7 @@ void init_triton_ir(py::module &&m) {
       // })
       // Attr
       .def("get_bool_attr", &mlir::OpBuilder::getBoolAttr)
+      .def("get_unit_attr", &mlir::OpBuilder::getUnitAttr)
       .def("get_int32_attr", &mlir::OpBuilder::getI32IntegerAttr)
       // Use arith.ConstantOp to create constants
       // Constants
@@ -554,6 +757,14 @@ void init_triton_ir(py::module &&m) {
            [](mlir::OpBuilder &self) -> mlir::Type {
              return self.getType<mlir::triton::Float8Type>();
            })
+      .def("get_fp8e4_ty",
+           [](mlir::OpBuilder &self) -> mlir::Type {
+             return self.getType<mlir::triton::Float8E4M3Type>();
+           })
+      .def("get_fp8e5_ty",
+           [](mlir::OpBuilder &self) -> mlir::Type {
+             return self.getType<mlir::triton::Float8E5M2Type>();
+           })
       .def(
           "get_half_ty",
           [](mlir::OpBuilder &self) -> mlir::Type { return self.getF16Type(); })
@@ -1042,10 +1253,12 @@ void init_triton_ir(py::module &&m) {
                  loc, ptrs, cacheModifier, evictionPolicy, isVolatile);
            })
       .def("create_store",
-           [](mlir::OpBuilder &self, mlir::Value &ptrs,
-              mlir::Value &value) -> void {
+           [](mlir::OpBuilder &self, mlir::Value &ptrs, mlir::Value &value,
+              mlir::triton::CacheModifier cacheModifier,
+              mlir::triton::EvictionPolicy evictionPolicy) -> void {
              auto loc = self.getUnknownLoc();
-             self.create<mlir::triton::StoreOp>(loc, ptrs, value);
+             self.create<mlir::triton::StoreOp>(loc, ptrs, value, cacheModifier,
+                                                evictionPolicy);
            })
       .def("create_masked_load",
            [](mlir::OpBuilder &self, mlir::Value &ptrs, mlir::Value &mask,
@@ -1060,9 +1273,11 @@ void init_triton_ir(py::module &&m) {
            })
       .def("create_masked_store",
            [](mlir::OpBuilder &self, mlir::Value &ptrs, mlir::Value &val,
-              mlir::Value &mask) -> void {
+              mlir::Value &mask, mlir::triton::CacheModifier cacheModifier,
+              mlir::triton::EvictionPolicy evictionPolicy) -> void {
              auto loc = self.getUnknownLoc();
-             self.create<mlir::triton::StoreOp>(loc, ptrs, val, mask);
+             self.create<mlir::triton::StoreOp>(loc, ptrs, val, mask,
+                                                cacheModifier, evictionPolicy);
            })
       .def("create_view",
            [](mlir::OpBuilder &self, mlir::Value &arg,
@@ -1174,8 +1389,11 @@ void init_triton_ir(py::module &&m) {
                                   .cast<mlir::triton::PointerType>();
                dstType = ptrType.getPointeeType();
              }
-             return self.create<mlir::triton::AtomicRMWOp>(loc, dstType, rmwOp,
-                                                           ptr, val, mask);
+             return self.create<mlir::triton::AtomicRMWOp>(
+                 loc, dstType,
+                 self.getI32IntegerAttr(static_cast<int32_t>(rmwOp)), ptr, val,
+                 mask, /*warp_aggregate=*/mlir::UnitAttr(),
+                 /*grid_sync=*/mlir::UnitAttr());
            })
       // External
       .def("create_external_elementwise",
@@ -1202,10 +1420,10 @@ void init_triton_ir(py::module &&m) {
            })
       .def("create_dot",
            [](mlir::OpBuilder &self, mlir::Value &a, mlir::Value &b,
-              mlir::Value &c, bool allowTF32) -> mlir::Value {
+              mlir::Value &c, bool allowTF32, bool tf32x3) -> mlir::Value {
              auto loc = self.getUnknownLoc();
              return self.create<mlir::triton::DotOp>(loc, c.getType(), a, b, c,
-                                                     allowTF32);
+                                                     allowTF32, tf32x3);
            })
       .def("create_exp",
            [](mlir::OpBuilder &self, mlir::Value &val) -> mlir::Value {
@@ -1249,6 +1467,53 @@ void init_triton_ir(py::module &&m) {
              return self.create<mlir::triton::ReduceOp>(loc, resType, redOp,
                                                         operand, axis);
            })
+      .def("create_generic_reduce",
+           [](mlir::OpBuilder &self, std::vector<mlir::Value> &operands,
+              int axis) -> mlir::OpState {
+             auto loc = self.getUnknownLoc();
+             // the combine region is built by the caller
+             return self.create<mlir::triton::GenericReduceOp>(loc, operands,
+                                                               axis);
+           })
+      .def("create_generic_reduce_ret",
+           [](mlir::OpBuilder &self,
+              std::vector<mlir::Value> &results) -> void {
+             auto loc = self.getUnknownLoc();
+             self.create<mlir::triton::GenericReduceReturnOp>(loc, results);
+           })
+      .def("create_scan",
+           [](mlir::OpBuilder &self, mlir::Value &operand,
+              int axis) -> mlir::OpState {
+             auto loc = self.getUnknownLoc();
+             // the combine region is built by the caller
+             return self.create<mlir::triton::ScanOp>(loc, operand.getType(),
+                                                      operand, axis);
+           })
+      .def("create_scan_ret",
+           [](mlir::OpBuilder &self, mlir::Value &result) -> void {
+             auto loc = self.getUnknownLoc();
+             self.create<mlir::triton::ScanReturnOp>(loc, result);
+           })
+      .def("create_sort",
+           [](mlir::OpBuilder &self, mlir::Value &operand, int axis, int k,
+              bool descending) -> mlir::Value {
+             auto loc = self.getUnknownLoc();
+             // only the first k elements along the axis are kept
+             auto type = operand.getType().cast<mlir::RankedTensorType>();
+             auto shape = type.getShape().vec();
+             shape[axis] = k;
+             auto resType =
+                 mlir::RankedTensorType::get(shape, type.getElementType());
+             return self.create<mlir::triton::SortOp>(loc, resType, operand,
+                                                      axis, descending);
+           })
+      .def("create_philox",
+           [](mlir::OpBuilder &self, mlir::Value &offset, mlir::Value &seedLo,
+              mlir::Value &seedHi, int nRounds) -> mlir::Value {
+             auto loc = self.getUnknownLoc();
+             return self.create<mlir::triton::PhiloxOp>(
+                 loc, offset.getType(), offset, seedLo, seedHi, nRounds);
+           })
       .def("create_ptr_to_int",
            [](mlir::OpBuilder &self, mlir::Value &val,
               mlir::Type &type) -> mlir::Value {
@@ -1278,6 +1543,15 @@ void init_triton_ir(py::module &&m) {
                                        llvm::StringRef(prefix)),
                  values);
            })
+      .def("create_profile_mark",
+           [](mlir::OpBuilder &self, const std::string &name,
+              bool isEnd) -> void {
+             auto loc = self.getUnknownLoc();
+             self.create<mlir::triton::ProfileMarkOp>(
+                 loc, self.getStringAttr(name),
+                 isEnd ? self.getUnitAttr() : mlir::UnitAttr(),
+                 mlir::IntegerAttr(), mlir::Value());
+           })
       // Undef
       .def("create_undef",
            [](mlir::OpBuilder &self, mlir::Type &type) -> mlir::Value {
@@ -1290,6 +1564,10 @@ void init_triton_ir(py::module &&m) {
         self.create<mlir::gpu::BarrierOp>(loc);
       });
 
+  py::class_<::triton::CompileTimings>(m, "compile_timings")
+      .def(py::init<>())
+      .def("records", &::triton::CompileTimings::getRecords);
+
   py::class_<mlir::PassManager>(m, "pass_manager")
       .def(py::init<mlir::MLIRContext *>())
       .def("enable_debug",
@@ -1307,8 +1585,19 @@ void init_triton_ir(py::module &&m) {
                  /*printAfterOnlyOnFailure*/ false, llvm::dbgs(),
                  printingFlags);
            })
+      .def(
+          "enable_timing",
+          [](mlir::PassManager &self, ::triton::CompileTimings &timings) {
+            self.addInstrumentation(
+                std::make_unique<::triton::PassTimingInstrumentation>(
+                    timings));
+          },
+          py::keep_alive<1, 2>())
       .def("run",
            [](mlir::PassManager &self, mlir::ModuleOp &mod) {
+             // Passes do not touch Python objects, so let other threads
+             // compile concurrently in their own contexts.
+             py::gil_scoped_release allow_threads;
              // TODO: maybe dump module to file and print error for better
              // diagnostics
              if (mlir::failed(self.run(mod.getOperation())))
@@ -1343,36 +1632,83 @@ void init_triton_ir(py::module &&m) {
            [](mlir::PassManager &self) {
              self.addPass(mlir::triton::createCombineOpsPass());
            })
-      .def("add_convert_triton_to_tritongpu_pass",
-           [](mlir::PassManager &self, int numWarps) {
-             self.addPass(
-                 mlir::triton::createConvertTritonToTritonGPUPass(numWarps));
+      .def("add_triton_rewrite_pointer_offsets_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::triton::createRewritePointerOffsetsPass());
            })
-      .def("add_tritongpu_pipeline_pass",
-           [](mlir::PassManager &self, int numStages) {
-             self.addPass(mlir::createTritonGPUPipelinePass(numStages));
+      .def(
+          "add_convert_triton_to_tritongpu_pass",
+          [](mlir::PassManager &self, int numWarps, int numCTAs,
+             const std::string &pidRemap) {
+            // warps are 32 threads wide: the NVPTX lowering of shuffles,
+            // ballots and mma, and the shared memory bank model assume it
+            self.addPass(mlir::triton::createConvertTritonToTritonGPUPass(
+                numWarps, /*threadsPerWarp=*/32, numCTAs, pidRemap));
+          },
+          py::arg("num_warps"), py::arg("num_ctas") = 1,
+          py::arg("pid_remap") = "")
+      .def(
+          "add_tritongpu_pipeline_pass",
+          [](mlir::PassManager &self, int numStages, int computeCapability,
+             bool issueCopiesFirst) {
+            self.addPass(mlir::createTritonGPUPipelinePass(
+                numStages, computeCapability, issueCopiesFirst));
+          },
+          py::arg("num_stages"), py::arg("compute_capability") = 80,
+          py::arg("issue_copies_first") = false)
+      .def("add_tritongpu_peel_loops_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPUPeelLoopsPass());
            })
-      .def("add_tritongpu_prefetch_pass",
+      .def("add_tritongpu_canonicalize_loops_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPUPrefetchPass());
+             self.addPass(mlir::createTritonGPUCanonicalizeLoopsPass());
            })
-      .def("add_tritongpu_combine_pass",
-           [](mlir::PassManager &self, int computeCapability) {
+      .def("add_tritongpu_instrument_pass",
+           [](mlir::PassManager &self, bool automatic, int capacity) {
              self.addPass(
-                 mlir::createTritonGPUCombineOpsPass(computeCapability));
+                 mlir::createTritonGPUInstrumentPass(automatic, capacity));
+           })
+      .def("add_tritongpu_hoist_invariant_loads_pass",
+           [](mlir::PassManager &self) {
+             self.addPass(mlir::createTritonGPUHoistInvariantLoadsPass());
            })
-      .def("add_tritongpu_update_mma_for_volta_pass",
+      .def(
+          "add_tritongpu_prefetch_pass",
+          [](mlir::PassManager &self, int prefetchWidth) {
+            self.addPass(mlir::createTritonGPUPrefetchPass(prefetchWidth));
+          },
+          py::arg("prefetch_width") = 0)
+      .def(
+          "add_tritongpu_combine_pass",
+          [](mlir::PassManager &self, int computeCapability, bool cleanup) {
+            self.addPass(
+                mlir::createTritonGPUCombineOpsPass(computeCapability, cleanup));
+          },
+          py::arg("compute_capability"), py::arg("cleanup") = false)
+      .def("add_tritongpu_layout_propagation_pass",
            [](mlir::PassManager &self) {
-             self.addPass(mlir::createTritonGPUUpdateMmaForVoltaPass());
+             self.addPass(mlir::createTritonGPULayoutPropagationPass());
            })
       .def("add_tritongpu_reorder_instructions_pass",
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPUReorderInstructionsPass());
            })
+      .def("add_tritongpu_schedule_instructions_pass",
+           [](mlir::PassManager &self, int registerBudget) {
+             self.addPass(
+                 mlir::createTritonGPUScheduleInstructionsPass(registerBudget));
+           })
       .def("add_tritongpu_decompose_conversions_pass",
            [](mlir::PassManager &self) {
              self.addPass(mlir::createTritonGPUDecomposeConversionsPass());
            })
+      .def(
+          "add_tritongpu_split_dots_pass",
+          [](mlir::PassManager &self, int registerBudget) {
+            self.addPass(mlir::createTritonGPUSplitDotsPass(registerBudget));
+          },
+          py::arg("register_budget") = 192)
       .def("add_triton_gpu_to_llvm",
            [](mlir::PassManager &self) {
              self.addPass(mlir::triton::createConvertTritonGPUToLLVMPass());
@@ -1385,17 +1721,51 @@ void init_triton_ir(py::module &&m) {
 void init_triton_translation(py::module &m) {
   using ret = py::return_value_policy;
 
+  // Bytes allocated with malloc by the process, which hold the operations of
+  // the modules and the types and attributes uniqued by the contexts
+  m.def("get_malloc_usage",
+        [] { return llvm::sys::Process::GetMallocUsage(); });
+
   m.def("get_shared_memory_size", [](mlir::ModuleOp mod) {
     auto shared = mod->getAttrOfType<mlir::IntegerAttr>("triton_gpu.shared");
     return shared.getInt();
   });
 
+  m.def("get_shared_memory_report", [](mlir::ModuleOp mod) -> std::string {
+    auto report =
+        mod->getAttrOfType<mlir::StringAttr>("triton_gpu.shared_report");
+    return report ? report.getValue().str() : "";
+  });
+
+  m.def("get_tma_descriptors", [](mlir::ModuleOp mod) -> std::string {
+    auto descs =
+        mod->getAttrOfType<mlir::StringAttr>("triton_gpu.tma_descriptors");
+    return descs ? descs.getValue().str() : "";
+  });
+
+  m.def("get_profile_regions", [](mlir::ModuleOp mod) -> std::string {
+    auto regions =
+        mod->getAttrOfType<mlir::StringAttr>("triton_gpu.profile_regions");
+    return regions ? regions.getValue().str() : "";
+  });
+
   m.def(
       "translate_triton_gpu_to_llvmir",
-      [](mlir::ModuleOp op, int computeCapability) {
+      [](mlir::ModuleOp op, int computeCapability,
+         ::triton::CompileTimings *timings, bool fastMath,
+         bool nativeLoadStore, int optLevel,
+         std::vector<std::string> disabledPasses, int maxRegisters,
+         int minBlocksPerSM) {
+        py::gil_scoped_release allow_threads;
         llvm::LLVMContext llvmContext;
+        ::mlir::triton::LLVMOptions options;
+        options.optLevel = optLevel;
+        options.disabledPasses = std::move(disabledPasses);
+        options.maxRegisters = maxRegisters;
+        options.minBlocksPerSM = minBlocksPerSM;
         auto llvmModule = ::mlir::triton::translateTritonGPUToLLVMIR(
-            &llvmContext, op, computeCapability);
+            &llvmContext, op, computeCapability, timings, fastMath,
+            nativeLoadStore, options);
         if (!llvmModule)
           llvm::report_fatal_error("Failed to translate TritonGPU to LLVM IR.");
 
@@ -1405,65 +1775,127 @@ void init_triton_translation(py::module &m) {
         os.flush();
         return str;
       },
+      py::arg("mod"), py::arg("compute_capability"),
+      py::arg("timings") = static_cast<::triton::CompileTimings *>(nullptr),
+      py::arg("fast_math") = false, py::arg("native_load_store") = false,
+      py::arg("opt_level") = 3,
+      py::arg("disabled_passes") = std::vector<std::string>(),
+      py::arg("max_registers") = 0, py::arg("min_blocks_per_sm") = 0,
       ret::take_ownership);
 
+  auto parseFPContraction = [](const std::string &fpContraction) {
+    if (fpContraction == "fast")
+      return triton::FPContraction::Fast;
+    if (fpContraction == "on")
+      return triton::FPContraction::On;
+    if (fpContraction == "off")
+      return triton::FPContraction::Off;
+    throw std::invalid_argument("unknown fp_contraction " + fpContraction +
+                                ", expected fast, on or off");
+  };
+
+  auto parseLLVMIR = [](const std::string &llvmIR,
+                        llvm::LLVMContext &context) {
+    std::unique_ptr<llvm::MemoryBuffer> buffer =
+        llvm::MemoryBuffer::getMemBuffer(llvmIR.c_str());
+    llvm::SMDiagnostic error;
+    std::unique_ptr<llvm::Module> module =
+        llvm::parseIR(buffer->getMemBufferRef(), error, context);
+    if (!module) {
+      llvm::report_fatal_error("failed to parse IR: " + error.getMessage() +
+                               "lineno: " + std::to_string(error.getLineNo()));
+    }
+    return module;
+  };
+
   m.def(
       "translate_llvmir_to_ptx",
-      [](const std::string llvmIR, int capability, int version) -> std::string {
+      [=](const std::string llvmIR, int capability, int version,
+          bool fastMath, int optLevel,
+          const std::string &fpContraction) -> std::string {
+        triton::FPContraction contraction = parseFPContraction(fpContraction);
+        py::gil_scoped_release allow_threads;
         // create LLVM module from C++
         llvm::LLVMContext context;
-        std::unique_ptr<llvm::MemoryBuffer> buffer =
-            llvm::MemoryBuffer::getMemBuffer(llvmIR.c_str());
-        llvm::SMDiagnostic error;
-        std::unique_ptr<llvm::Module> module =
-            llvm::parseIR(buffer->getMemBufferRef(), error, context);
-        if (!module) {
-          llvm::report_fatal_error(
-              "failed to parse IR: " + error.getMessage() +
-              "lineno: " + std::to_string(error.getLineNo()));
-        }
+        std::unique_ptr<llvm::Module> module = parseLLVMIR(llvmIR, context);
 
         // translate module to PTX
-        auto ptxCode =
-            triton::translateLLVMIRToPTX(*module, capability, version);
+        auto ptxCode = triton::translateLLVMIRToPTX(
+            *module, capability, version, fastMath, optLevel, contraction);
         return ptxCode;
       },
-      ret::take_ownership);
+      py::arg("mod"), py::arg("compute_capability"), py::arg("ptx_version"),
+      py::arg("fast_math") = false, py::arg("opt_level") = 3,
+      py::arg("fp_contraction") = "fast", ret::take_ownership);
+
+  // Translates the LLVM modules of several kernels, parsed in one context and
+  // linked together, to a single PTX module with an entry point per kernel.
+  m.def(
+      "translate_llvmir_batch_to_ptx",
+      [=](const std::vector<std::string> &llvmIRs, int capability,
+          int version, bool fastMath, int optLevel,
+          const std::string &fpContraction) -> std::string {
+        triton::FPContraction contraction = parseFPContraction(fpContraction);
+        py::gil_scoped_release allow_threads;
+        llvm::LLVMContext context;
+        std::vector<std::unique_ptr<llvm::Module>> modules;
+        for (const std::string &llvmIR : llvmIRs)
+          modules.push_back(parseLLVMIR(llvmIR, context));
+        std::unique_ptr<llvm::Module> module =
+            triton::linkKernelModules(std::move(modules));
+        if (!module)
+          llvm::report_fatal_error("failed to link the kernels of the batch");
+
+        return triton::translateLLVMIRToPTX(*module, capability, version,
+                                            fastMath, optLevel, contraction);
+      },
+      py::arg("mods"), py::arg("compute_capability"), py::arg("ptx_version"),
+      py::arg("fast_math") = false, py::arg("opt_level") = 3,
+      py::arg("fp_contraction") = "fast", ret::take_ownership);
 
   m.def("compile_ptx_to_cubin",
         [](const std::string &ptxCode, const std::string &ptxasPath,
            int capability) -> py::object {
-          py::gil_scoped_release allow_threads;
-
-          // compile ptx with ptxas
-          llvm::SmallString<64> fsrc;
-          llvm::SmallString<64> flog;
-          llvm::sys::fs::createTemporaryFile("compile-ptx-src", "", fsrc);
-          llvm::sys::fs::createTemporaryFile("compile-ptx-log", "", flog);
-          std::string fbin = std::string(fsrc) + ".o";
-          llvm::FileRemover srcRemover(fsrc);
-          llvm::FileRemover logRemover(flog);
-          llvm::FileRemover binRemover(fbin);
-          const char *_fsrc = fsrc.c_str();
-          const char *_flog = flog.c_str();
-          const char *_fbin = fbin.c_str();
-          std::ofstream ofs(_fsrc);
-          ofs << ptxCode << std::endl;
-          ofs.close();
-          std::string cmd;
-          int err;
-          cmd = ptxasPath + " -v --gpu-name=sm_" + std::to_string(capability) +
-                " " + _fsrc + " -o " + _fsrc + ".o 2> " + _flog;
-          err = system(cmd.c_str());
-          if (err != 0) {
-            std::ifstream _log(_flog);
-            std::string log(std::istreambuf_iterator<char>(_log), {});
-            throw std::runtime_error("Internal Triton PTX codegen error: \n" +
-                                     log);
+          std::string cubin;
+          {
+            py::gil_scoped_release allow_threads;
+
+            // compile ptx with ptxas
+            llvm::SmallString<64> fsrc;
+            llvm::SmallString<64> flog;
+            llvm::sys::fs::createTemporaryFile("compile-ptx-src", "", fsrc);
+            llvm::sys::fs::createTemporaryFile("compile-ptx-log", "", flog);
+            std::string fbin = std::string(fsrc) + ".o";
+            llvm::FileRemover srcRemover(fsrc);
+            llvm::FileRemover logRemover(flog);
+            llvm::FileRemover binRemover(fbin);
+            const char *_fsrc = fsrc.c_str();
+            const char *_flog = flog.c_str();
+            const char *_fbin = fbin.c_str();
+            std::ofstream ofs(_fsrc);
+            ofs << ptxCode << std::endl;
+            ofs.close();
+            // PTX using architecture-specific features (e.g., wgmma) targets
+            // sm_<capability>a
+            std::string arch = "sm_" + std::to_string(capability);
+            if (ptxCode.find(".target " + arch + "a") != std::string::npos)
+              arch += "a";
+            std::string cmd;
+            int err;
+            cmd = ptxasPath + " -v --gpu-name=" + arch + " " + _fsrc + " -o " +
+                  _fsrc + ".o 2> " + _flog;
+            err = system(cmd.c_str());
+            if (err != 0) {
+              std::ifstream _log(_flog);
+              std::string log(std::istreambuf_iterator<char>(_log), {});
+              throw std::runtime_error(
+                  "Internal Triton PTX codegen error: \n" + log);
+            }
+            std::ifstream _cubin(_fbin, std::ios::binary);
+            cubin.assign(std::istreambuf_iterator<char>(_cubin), {});
+            _cubin.close();
           }
-          std::ifstream _cubin(_fbin, std::ios::binary);
-          std::string cubin(std::istreambuf_iterator<char>(_cubin), {});
-          _cubin.close();
+          // the GIL must be held to create Python objects
           py::bytes bytes(cubin);
           return std::move(bytes);
         });
@@ -1477,6 +1909,8 @@ void init_triton_translation(py::module &m) {
 
 void init_triton(py::module &m) {
   py::module subm = m.def_submodule("triton");
+  // hash of the sources the library was built from, see version_key
+  subm.attr("build_fingerprint") = TRITON_BUILD_FINGERPRINT;
   // init_triton_codegen(subm.def_submodule("code_gen"));
   init_triton_runtime(subm.def_submodule("runtime"));
   init_triton_ir(subm.def_submodule("ir"));
@@ -0,0 +1,18 @@
+import pytest
+from perf_baselines import PerfBaselines, default_path
+
+
+def pytest_addoption(parser):
+    parser.addoption("--update-baselines", action="store_true",
+                     help="store the results of the benchmarks as the baselines of the device")
+    parser.addoption("--baselines", default=None,
+                     help="JSON database of the baselines of the benchmarks ($TRITON_PERF_BASELINES by default)")
+
+
+@pytest.fixture(scope="session")
+def perf_baselines(request):
+    baselines = PerfBaselines(request.config.getoption("--baselines") or default_path(),
+                              update=request.config.getoption("--update-baselines"))
+    yield baselines
+    if baselines.update:
+        baselines.save()
@@ -0,0 +1,121 @@
+'''
+Per-device baselines of the benchmarks of `test_suite.py`, stored as JSON:
+
+.. code-block:: json
+
+    {"version": 1,
+     "devices": {device: {benchmark: {"times": [], "compile_time": 0., "startup_time": 0., "metrics": {}}}}}
+
+`times` holds (a subsample of) the runtimes in ms of the repetitions of `do_bench`, which are tested
+against the runtimes of new runs to report slowdowns that are statistically significant rather than
+noise. Compile and startup times, in seconds, are single measurements and get a loose tolerance.
+'''
+import json
+import math
+import os
+import statistics
+
+import torch
+
+VERSION = 1
+
+# order statistics of the runtimes kept in the database
+MAX_SAMPLES = 256
+# one-sided p-value under which runtimes are significantly slower
+P_VALUE = 1e-3
+# slowdowns of the median runtime under which significant differences are ignored
+MIN_SLOWDOWN = 0.03
+# slowdowns of the compile and startup times reported, and the absolute
+# difference (in seconds) under which they are ignored
+MAX_TIME_SLOWDOWN = 0.5
+MIN_TIME_DIFF = 0.05
+
+
+def default_path():
+    return os.environ.get("TRITON_PERF_BASELINES", os.path.join(os.path.dirname(__file__), "baselines.json"))
+
+
+def device_key(device=None):
+    if device is None:
+        device = torch.cuda.current_device()
+    capability = torch.cuda.get_device_capability(device)
+    return f"{torch.cuda.get_device_name(device)}-sm{capability[0]}{capability[1]}"
+
+
+def subsample(times):
+    times = sorted(times)
+    if len(times) <= MAX_SAMPLES:
+        return times
+    n = len(times) - 1
+    return [times[round(i * n / (MAX_SAMPLES - 1))] for i in range(MAX_SAMPLES)]
+
+
+def slower_p_value(base, new):
+    '''
+    One-sided Mann-Whitney U test: p-value of the hypothesis that `new` is not
+    stochastically larger than `base`, with the normal approximation corrected
+    for ties.
+    '''
+    n1, n2 = len(base), len(new)
+    samples = sorted([(x, 0) for x in base] + [(x, 1) for x in new])
+    n = n1 + n2
+    rank_sum, ties, i = 0., 0., 0
+    while i < n:
+        j = i
+        while j < n and samples[j][0] == samples[i][0]:
+            j += 1
+        # tied samples get their average rank
+        rank = (i + j + 1) / 2
+        rank_sum += rank * sum(1 for _, s in samples[i:j] if s == 1)
+        ties += (j - i) ** 3 - (j - i)
+        i = j
+    u = rank_sum - n2 * (n2 + 1) / 2
+    var = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)))
+    if var <= 0:
+        return 1.
+    z = (u - n1 * n2 / 2 - 0.5) / math.sqrt(var)
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+
+class PerfBaselines:
+
+    def __init__(self, path, update=False):
+        # results are only saved as the new baselines with `update`
+        self.path = path
+        self.update = update
+        self.devices = dict()
+        if os.path.exists(path):
+            with open(path) as f:
+                data = json.load(f)
+            if data.get("version") == VERSION:
+                self.devices = data["devices"]
+
+    def lookup(self, benchmark, device=None):
+        return self.devices.get(device or device_key(), dict()).get(benchmark)
+
+    def record(self, benchmark, result, device=None):
+        self.devices.setdefault(device or device_key(), dict())[benchmark] = result
+
+    def save(self):
+        with open(self.path, "w") as f:
+            json.dump({"version": VERSION, "devices": self.devices}, f, indent=1, sort_keys=True)
+
+    def compare(self, benchmark, result, device=None):
+        '''
+        Returns the regressions of `result` against the baseline of `benchmark`, as messages.
+        '''
+        base = self.lookup(benchmark, device)
+        if base is None:
+            return []
+        regressions = []
+        base_ms, new_ms = statistics.median(base["times"]), statistics.median(result["times"])
+        if new_ms > base_ms * (1 + MIN_SLOWDOWN):
+            p = slower_p_value(base["times"], result["times"])
+            if p < P_VALUE:
+                regressions.append(f"runtime: {new_ms:.4f} ms, baseline {base_ms:.4f} ms (p = {p:.1e})")
+        for name in ["compile_time", "startup_time"]:
+            if name not in base or name not in result:
+                continue
+            if result[name] > base[name] * (1 + MAX_TIME_SLOWDOWN) and result[name] - base[name] > MIN_TIME_DIFF:
+                regressions.append(f"{name}: {result[name]:.2f} s, baseline {base[name]:.2f} s")
+        return regressions
@@ -162,3 +162,47 @@ def test_elementwise(N):
     cur_gpu_perf = 3. * N * z.element_size() / ms * 1e-6
     cur_gpu_util = cur_gpu_perf / max_gpu_perf
     triton.testing.assert_almost_equal(cur_gpu_util, ref_gpu_util, decimal=2)
+
+
+#######################
+# Flash-Attention
+#######################
+
+
+flash_attention_data = {
+    'a100': {
+        (4, 48, 4096, 64, True, 'forward'): 0.420,
+        (4, 48, 4096, 64, True, 'backward'): 0.202,
+        (4, 48, 4096, 64, False, 'forward'): 0.475,
+        (4, 48, 1024, 64, True, 'forward'): 0.280,
+    }
+}
+
+
+@pytest.mark.parametrize('Z, H, N_CTX, D_HEAD, causal, mode',
+                         flash_attention_data.get(DEVICE_NAME, dict()).keys())
+def test_flash_attention(Z, H, N_CTX, D_HEAD, causal, mode):
+    torch.manual_seed(0)
+    ref_gpu_util = flash_attention_data[DEVICE_NAME][(Z, H, N_CTX, D_HEAD, causal, mode)]
+    cur_sm_clock = nvsmi(['clocks.current.sm'])[0]
+    ref_sm_clock = sm_clocks[DEVICE_NAME]
+    max_gpu_perf = get_max_tensorcore_tflops(torch.float16, clock_rate=cur_sm_clock * 1e3)
+    assert abs(cur_sm_clock - ref_sm_clock) < 10, f'GPU SMs must run at {ref_sm_clock} MHz'
+    q, k, v = [torch.randn((Z, H, N_CTX, D_HEAD), dtype=torch.float16, device='cuda', requires_grad=True)
+               for _ in range(3)]
+    fn = lambda: triton.ops.attention(q, k, v, causal=causal)
+    if mode == 'backward':
+        o = fn()
+        do = torch.randn_like(o)
+        fn = lambda: o.backward(do, retain_graph=True)
+    ms = triton.testing.do_bench(fn, percentiles=None, warmup=25, rep=100)
+    # 2 matmuls in the forward pass, and 5 (of which one recomputes qk) in the
+    # backward pass; the causal mask skips half of them
+    flops = 2. * 2. * Z * H * N_CTX * N_CTX * D_HEAD
+    if mode == 'backward':
+        flops *= 2.5
+    if causal:
+        flops *= 0.5
+    cur_gpu_perf = flops / ms * 1e-9
+    cur_gpu_util = cur_gpu_perf / max_gpu_perf
+    triton.testing.assert_almost_equal(cur_gpu_util, ref_gpu_util, decimal=2)
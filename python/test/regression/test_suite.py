@@ -0,0 +1,200 @@
+'''
+Performance regression suite: measures the throughput, compile time and
+startup time of the kernels below and compares them to the baselines of the
+device (see `perf_baselines.py`). Run with `--update-baselines` to record new
+baselines, e.g. after an intended slowdown or on a new device.
+'''
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+import pytest
+import torch
+from perf_baselines import subsample
+
+import triton
+import triton.language as tl
+
+#######################
+# Kernels
+#######################
+
+
+@triton.jit
+def _softmax(Y, X, stride, N, BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    cols = tl.arange(0, BLOCK)
+    x = tl.load(X + row * stride + cols, mask=cols < N, other=-float('inf'))
+    num = tl.exp(x - tl.max(x, axis=0))
+    tl.store(Y + row * stride + cols, num / tl.sum(num, axis=0), mask=cols < N)
+
+
+@triton.jit
+def _layer_norm(Y, X, W, B, stride, N, eps, BLOCK: tl.constexpr):
+    row = tl.program_id(0)
+    cols = tl.arange(0, BLOCK)
+    mask = cols < N
+    x = tl.load(X + row * stride + cols, mask=mask, other=0.).to(tl.float32)
+    mean = tl.sum(x, axis=0) / N
+    xc = tl.where(mask, x - mean, 0.)
+    rstd = 1 / tl.sqrt(tl.sum(xc * xc, axis=0) / N + eps)
+    w = tl.load(W + cols, mask=mask)
+    b = tl.load(B + cols, mask=mask)
+    tl.store(Y + row * stride + cols, xc * rstd * w + b, mask=mask)
+
+
+#######################
+# Benchmarks
+#######################
+
+# Each benchmark builds its inputs and returns the function to time, together
+# with the function computing its throughput from its median runtime in ms.
+
+
+def bench_matmul(M, N, K, dtype):
+    if dtype in ['bfloat16', 'tfloat32', 'int8'] and torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip(f"{dtype} requires sm >= 80")
+    if dtype == 'int8':
+        a = torch.randint(-128, 127, (M, K), dtype=torch.int8, device='cuda')
+        # only the row-col layout is supported
+        b = torch.randint(-128, 127, (N, K), dtype=torch.int8, device='cuda').t()
+    else:
+        torch_dtype = {'float16': torch.float16, 'bfloat16': torch.bfloat16, 'tfloat32': torch.float32}[dtype]
+        a = torch.randn((M, K), dtype=torch_dtype, device='cuda')
+        b = torch.randn((K, N), dtype=torch_dtype, device='cuda')
+    return lambda: triton.ops.matmul(a, b), lambda ms: {'tflops': 2. * M * N * K / ms * 1e-9}
+
+
+def bench_softmax(M, N):
+    x = torch.randn((M, N), dtype=torch.float32, device='cuda')
+    y = torch.empty_like(x)
+    BLOCK = triton.next_power_of_2(N)
+    num_warps = 4 if BLOCK < 2048 else 8 if BLOCK < 4096 else 16
+    fn = lambda: _softmax[(M,)](y, x, x.stride(0), N, BLOCK=BLOCK, num_warps=num_warps)
+    return fn, lambda ms: {'gbps': 2. * x.numel() * x.element_size() / ms * 1e-6}
+
+
+def bench_layernorm(M, N):
+    x = torch.randn((M, N), dtype=torch.float16, device='cuda')
+    w = torch.rand((N,), dtype=torch.float16, device='cuda')
+    b = torch.rand((N,), dtype=torch.float16, device='cuda')
+    y = torch.empty_like(x)
+    BLOCK = triton.next_power_of_2(N)
+    num_warps = min(max(BLOCK // 256, 1), 8)
+    fn = lambda: _layer_norm[(M,)](y, x, w, b, x.stride(0), N, 1e-5, BLOCK=BLOCK, num_warps=num_warps)
+    return fn, lambda ms: {'gbps': 2. * x.numel() * x.element_size() / ms * 1e-6}
+
+
+def bench_cross_entropy(M, N):
+    logits = torch.randn((M, N), dtype=torch.float16, device='cuda')
+    indices = torch.randint(0, N, (M,), device='cuda')
+    fn = lambda: triton.ops.cross_entropy(logits, indices)
+    return fn, lambda ms: {'gbps': logits.numel() * logits.element_size() / ms * 1e-6}
+
+
+def bench_blocksparse(MODE, BLOCK, Z=4, H=8, M=2048, N=2048, K=2048):
+    torch.manual_seed(0)
+    shape = {'sdd': (M, N), 'dsd': (M, K), 'dds': (K, N)}[MODE]
+    # about half of the blocks are non-zero
+    layout = torch.randint(2, (H, shape[0] // BLOCK, shape[1] // BLOCK))
+    a = torch.randn((Z, H, M, K), dtype=torch.float16, device='cuda')
+    b = torch.randn((Z, H, K, N), dtype=torch.float16, device='cuda')
+    if MODE == 'dsd':
+        a = triton.testing.sparsify_tensor(a, layout, BLOCK)
+    if MODE == 'dds':
+        b = triton.testing.sparsify_tensor(b, layout, BLOCK)
+    op = triton.ops.blocksparse.matmul(layout, BLOCK, MODE, device='cuda')
+    density = layout.float().mean().item()
+    return lambda: op(a, b), lambda ms: {'tflops': 2. * Z * H * M * N * K * density / ms * 1e-9}
+
+
+def bench_attention(Z, H, N_CTX, D_HEAD, causal, mode):
+    if torch.cuda.get_device_capability()[0] < 8:
+        pytest.skip("attention requires sm >= 80")
+    q, k, v = [torch.randn((Z, H, N_CTX, D_HEAD), dtype=torch.float16, device='cuda', requires_grad=True)
+               for _ in range(3)]
+    fn = lambda: triton.ops.attention(q, k, v, causal=causal)
+    if mode == 'backward':
+        o = fn()
+        do = torch.randn_like(o)
+        fn = lambda: o.backward(do, retain_graph=True)
+    # 2 matmuls in the forward pass, and 5 (of which one recomputes qk) in the
+    # backward pass; the causal mask skips half of them
+    flops = 2. * 2. * Z * H * N_CTX * N_CTX * D_HEAD * (2.5 if mode == 'backward' else 1.) * (0.5 if causal else 1.)
+    return fn, lambda ms: {'tflops': flops / ms * 1e-9}
+
+
+BENCHMARKS = {
+    'matmul': bench_matmul,
+    'softmax': bench_softmax,
+    'layernorm': bench_layernorm,
+    'cross_entropy': bench_cross_entropy,
+    'blocksparse': bench_blocksparse,
+    'attention': bench_attention,
+}
+
+SUITE = [('matmul', dict(M=M, N=N, K=K, dtype=dtype))
+         for M, N, K in [(512, 512, 512), (1024, 1024, 1024), (2048, 2048, 2048), (4096, 4096, 4096),
+                         (8192, 8192, 8192),
+                         # tall-skinny
+                         (16, 4096, 4096), (64, 8192, 8192), (4096, 64, 4096),
+                         # deep reductions
+                         (256, 256, 16384), (64, 64, 65536)]
+         for dtype in ['float16', 'bfloat16', 'tfloat32', 'int8']]
+SUITE += [(name, dict(M=M, N=N)) for name in ['softmax', 'layernorm']
+          for M, N in [(4096, 256), (4096, 1024), (4096, 4096), (1024, 16384)]]
+SUITE += [('cross_entropy', dict(M=M, N=N)) for M, N in [(4096, 1024), (1024, 32768), (512, 50257)]]
+SUITE += [('blocksparse', dict(MODE=MODE, BLOCK=BLOCK)) for MODE in ['sdd', 'dsd', 'dds'] for BLOCK in [32, 64]]
+SUITE += [('attention', dict(Z=4, H=48, N_CTX=N_CTX, D_HEAD=64, causal=causal, mode=mode))
+          for N_CTX in [1024, 4096] for causal in [False, True] for mode in ['forward', 'backward']]
+
+
+def bench_id(name, params):
+    return name + '-' + '-'.join(f'{k}{v}' for k, v in params.items())
+
+
+def first_call_time(name, params, cache_dir):
+    '''
+    Runs benchmark `name` once in a new process with the cache `cache_dir`, and
+    returns the time taken by the call in seconds: a cold cache gives the
+    compile time (including auto-tuning), a warm one the startup time.
+    '''
+    env = dict(os.environ, TRITON_CACHE_DIR=cache_dir)
+    # the tuning database is kept in the cache directory
+    env.pop('TRITON_AUTOTUNE_DB', None)
+    out = subprocess.check_output([sys.executable, __file__, name, json.dumps(params)], env=env)
+    return json.loads(out.decode().strip().splitlines()[-1])['time']
+
+
+@pytest.mark.parametrize('name, params', SUITE, ids=[bench_id(name, params) for name, params in SUITE])
+def test_perf(name, params, perf_baselines):
+    torch.manual_seed(0)
+    fn, throughput = BENCHMARKS[name](**params)
+    with tempfile.TemporaryDirectory() as cache_dir:
+        compile_time = first_call_time(name, params, cache_dir)
+        startup_time = first_call_time(name, params, cache_dir)
+    times = triton.testing.do_bench(fn, warmup=25, rep=250, return_times=True)
+    result = {'times': subsample(times), 'compile_time': compile_time, 'startup_time': startup_time,
+              'metrics': throughput(statistics.median(times))}
+    key = bench_id(name, params)
+    regressions = perf_baselines.compare(key, result)
+    print(f"{key}: {statistics.median(times):.4f} ms, {result['metrics']}, "
+          f"compile {compile_time:.2f} s, startup {startup_time:.2f} s")
+    if perf_baselines.update:
+        perf_baselines.record(key, result)
+        return
+    assert not regressions, f"{key} regressed: " + '; '.join(regressions)
+
+
+if __name__ == '__main__':
+    # worker of `first_call_time`
+    fn, _ = BENCHMARKS[sys.argv[1]](**json.loads(sys.argv[2]))
+    torch.cuda.synchronize()
+    start = time.perf_counter()
+    fn()
+    torch.cuda.synchronize()
+    print(json.dumps({'time': time.perf_counter() - start}))
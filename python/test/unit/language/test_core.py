@@ -472,6 +472,40 @@ def test_math_op(expr, device='cuda'):
     _test_unary('float32', f'tl.{expr}(x)', f'np.{expr}(x) ', device=device)
 
 
+@pytest.mark.parametrize("expr, numpy_expr, instr", [
+    ('tl.exp(x)', 'np.exp(x)', 'ex2.approx.f32'),
+    ('tl.log(x)', 'np.log(x)', 'lg2.approx.f32'),
+    ('tl.cos(x)', 'np.cos(x)', 'cos.approx.f32'),
+    ('tl.sin(x)', 'np.sin(x)', 'sin.approx.f32'),
+    ('tl.libdevice.rsqrt(x)', '1 / np.sqrt(x)', 'rsqrt.approx.f32'),
+    ('tl.libdevice.tanh(x)', 'np.tanh(x)', 'tanh.approx.f32'),
+])
+def test_fast_math(expr, numpy_expr, instr, device='cuda'):
+    major, minor = torch.cuda.get_device_capability()
+    if instr.startswith('tanh') and major * 10 + minor < 75:
+        pytest.skip("tanh.approx requires sm >= 75")
+    SIZE = 128
+
+    @triton.jit
+    def kernel(Z, X, SIZE: tl.constexpr):
+        off = tl.arange(0, SIZE)
+        x = tl.load(X + off)
+        z = GENERATE_TEST_HERE
+        tl.store(Z + off, z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': expr})
+    x = numpy_random(SIZE, dtype_str='float32')
+    if 'log' in expr or 'sqrt' in expr:
+        x = np.abs(x) + 0.01
+    z_ref = eval(numpy_expr)
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty_like(z_ref), device=device)
+    pgm = kernel[(1, )](z_tri, x_tri, SIZE=SIZE, num_warps=4, fast_math=True)
+    assert instr in pgm.asm['ptx']
+    # tanh.approx has a relative error of 2^-11
+    np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=1e-3, atol=1e-5)
+
+
 # ----------------
 # test indexing
 # ----------------
@@ -680,6 +714,35 @@ def test_tensor_atomic_rmw(shape, axis, device="cuda"):
     np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=1e-4)
 
 
+@pytest.mark.parametrize("dtype_x_str, n_bins", [(dtype_x_str, n_bins)
+                                                 for dtype_x_str in ['int32', 'float32']
+                                                 for n_bins in [1, 3, 32]])
+def test_warp_aggregated_atomic_add(dtype_x_str, n_bins, device='cuda'):
+    SIZE = 1024
+
+    @triton.jit
+    def kernel(Z, X, BINS, SIZE: tl.constexpr):
+        off = tl.arange(0, SIZE)
+        x = tl.load(X + off)
+        bins = tl.load(BINS + off)
+        tl.atomic_add(Z + bins, x, warp_aggregate=True)
+    rs = RandomState(17)
+    x = numpy_random((SIZE, ), dtype_str=dtype_x_str, rs=rs)
+    bins = rs.randint(0, n_bins, size=(SIZE, )).astype(np.int32)
+    # reference result
+    z_ref = np.zeros((n_bins, ), dtype=getattr(np, dtype_x_str))
+    np.add.at(z_ref, bins, x)
+    # triton result
+    x_tri = to_triton(x, device=device)
+    bins_tri = to_triton(bins, device=device)
+    z_tri = to_triton(np.zeros((n_bins, ), dtype=getattr(np, dtype_x_str)), device=device)
+    kernel[(1,)](z_tri, x_tri, bins_tri, SIZE)
+    if dtype_x_str == 'int32':
+        np.testing.assert_equal(z_ref, to_numpy(z_tri))
+    else:
+        np.testing.assert_allclose(z_ref, to_numpy(z_tri), rtol=1e-4)
+
+
 def test_atomic_cas():
     # 1. make sure that atomic_cas changes the original value (Lock)
     @triton.jit
@@ -879,6 +942,52 @@ def test_f16_to_f8_rounding():
     ), f"f16_input[mismatch]={f16_input[mismatch]} f16_output[mismatch]={f16_output[mismatch]} abs_error[mismatch]={abs_error[mismatch]} min_error[mismatch]={min_error[mismatch]}"
 
 
+def decode_ocp_fp8(bits, exponent_bits):
+    """Reference decoding of the E4M3 (exponent_bits=4) and E5M2 (exponent_bits=5)
+    8-bit float formats to float32. Returns NaN for encodings that aren't finite."""
+    mantissa_bits = 7 - exponent_bits
+    bias = 2 ** (exponent_bits - 1) - 1
+    bits = bits.astype(np.int32)
+    sign = np.where(bits & 0x80, -1.0, 1.0)
+    exponent = (bits >> mantissa_bits) & ((1 << exponent_bits) - 1)
+    mantissa = (bits & ((1 << mantissa_bits) - 1)).astype(np.float32) / (1 << mantissa_bits)
+    values = np.where(exponent == 0,
+                      sign * mantissa * 2.0 ** (1 - bias),
+                      sign * (1 + mantissa) * 2.0 ** (exponent - bias))
+    if exponent_bits == 4:
+        non_finite = (bits & 0x7f) == 0x7f
+    else:
+        non_finite = exponent == 0x1f
+    return np.where(non_finite, np.nan, values).astype(np.float32)
+
+
+@pytest.mark.parametrize("in_dtype, exponent_bits", [(tl.float8e4, 4), (tl.float8e5, 5)])
+def test_ocp_fp8_roundtrip(in_dtype, exponent_bits):
+    """Converts all E4M3 (resp. E5M2) values to float16 and back, and checks them
+    against a reference decoding."""
+    @triton.jit
+    def copy_kernel(input_ptr, output_ptr, n_elements, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(axis=0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        mask = offsets < n_elements
+        input = tl.load(input_ptr + offsets, mask=mask)
+        output = input
+        tl.store(output_ptr + offsets, output, mask=mask)
+
+    bits = np.arange(2 ** 8, dtype=np.uint8)
+    ref = decode_ocp_fp8(bits, exponent_bits)
+    finite = np.isfinite(ref)
+    f8_tensor = torch.tensor(bits[finite], dtype=torch.uint8, device='cuda')
+    n_elements = f8_tensor.numel()
+    grid = lambda meta: (triton.cdiv(n_elements, meta['BLOCK_SIZE']),)
+    f16 = torch.empty_like(f8_tensor, dtype=torch.float16)
+    copy_kernel[grid](triton.reinterpret(f8_tensor, in_dtype), f16, n_elements, BLOCK_SIZE=1024)
+    np.testing.assert_array_equal(f16.cpu().numpy().astype(np.float32), ref[finite])
+
+    f8_output_tensor = torch.empty_like(f8_tensor)
+    copy_kernel[grid](f16, triton.reinterpret(f8_output_tensor, in_dtype), n_elements, BLOCK_SIZE=1024)
+    assert torch.all(f8_tensor == f8_output_tensor)
+
+
 # ---------------
 # test reduce
 # ---------------
@@ -1024,6 +1133,228 @@ def test_reduce2d(op, dtype_str, shape, axis, device='cuda'):
         else:
             np.testing.assert_equal(z_ref, z_tri)
 
+
+@triton.jit
+def _argmax_combine(value_a, index_a, value_b, index_b):
+    # ties go to the smallest index, so that the result doesn't depend on the
+    # order in which elements are combined
+    take_a = (value_a > value_b) | ((value_a == value_b) & (index_a < index_b))
+    return tl.where(take_a, value_a, value_b), tl.where(take_a, index_a, index_b)
+
+
+@triton.jit
+def _welford_combine(mean_a, m2_a, count_a, mean_b, m2_b, count_b):
+    count = count_a + count_b
+    delta = mean_b - mean_a
+    frac_b = count_b / count
+    return mean_a + delta * frac_b, m2_a + m2_b + delta * delta * count_a * frac_b, count
+
+
+@pytest.mark.parametrize("shape, axis, num_warps",
+                         [(shape, axis, num_warps)
+                          for shape in [(1, 128), (32, 32), (64, 128), (2, 1024)]
+                          for axis in [0, 1]
+                          for num_warps in [1, 4]])
+def test_generic_reduce(shape, axis, num_warps, device='cuda'):
+    @triton.jit
+    def kernel(X, Z_MAX, Z_IDX, Z_MEAN, Z_VAR, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr,
+               AXIS: tl.constexpr):
+        range_m = tl.arange(0, BLOCK_M)
+        range_n = tl.arange(0, BLOCK_N)
+        x = tl.load(X + range_m[:, None] * BLOCK_N + range_n[None, :])
+        zeros = tl.zeros([BLOCK_M, BLOCK_N], tl.int32)
+        if AXIS == 1:
+            idx = zeros + range_n[None, :]
+        else:
+            idx = zeros + range_m[:, None]
+        z_max, z_idx = tl.reduce((x, idx), AXIS, _argmax_combine)
+        # mean and variance in a single pass
+        z_mean, z_m2, z_count = tl.reduce((x, x * 0, x * 0 + 1), AXIS, _welford_combine)
+        if AXIS == 1:
+            offs = range_m
+        else:
+            offs = range_n
+        tl.store(Z_MAX + offs, z_max)
+        tl.store(Z_IDX + offs, z_idx)
+        tl.store(Z_MEAN + offs, z_mean)
+        tl.store(Z_VAR + offs, z_m2 / z_count)
+
+    rs = RandomState(17)
+    # small integers, so that the maximum is often tied
+    x = rs.randint(0, 8, size=shape).astype(np.float32)
+    n = shape[1 - axis]
+    z_max, z_idx, z_mean, z_var = [to_triton(np.empty(n, dtype=dtype), device=device)
+                                   for dtype in [np.float32, np.int32, np.float32, np.float32]]
+    kernel[(1,)](to_triton(x, device=device), z_max, z_idx, z_mean, z_var,
+                 BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis, num_warps=num_warps)
+    np.testing.assert_equal(np.max(x, axis=axis), to_numpy(z_max))
+    np.testing.assert_equal(np.argmax(x, axis=axis), to_numpy(z_idx))
+    np.testing.assert_allclose(np.mean(x, axis=axis), to_numpy(z_mean), rtol=1e-5)
+    np.testing.assert_allclose(np.var(x, axis=axis), to_numpy(z_var), rtol=1e-4, atol=1e-5)
+
+# ---------------
+# test scan
+# ---------------
+
+
+@triton.jit
+def _cummax_combine(a, b):
+    return tl.maximum(a, b)
+
+
+@triton.jit
+def _last_combine(a, b):
+    # associative but not commutative
+    return b
+
+
+scan_configs = [
+    (op, dtype, shape, axis, num_warps)
+    for op in ['cumsum', 'cummax', 'last']
+    for dtype in ['int32', 'float32']
+    for shape in [(1, 32), (4, 128), (32, 32), (2, 1024)]
+    for axis in [0, 1]
+    for num_warps in [1, 4]
+]
+
+
+@pytest.mark.parametrize("op, dtype_str, shape, axis, num_warps", scan_configs)
+def test_scan2d(op, dtype_str, shape, axis, num_warps, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, AXIS: tl.constexpr):
+        range_m = tl.arange(0, BLOCK_M)
+        range_n = tl.arange(0, BLOCK_N)
+        x = tl.load(X + range_m[:, None] * BLOCK_N + range_n[None, :])
+        z = GENERATE_TEST_HERE
+        tl.store(Z + range_m[:, None] * BLOCK_N + range_n[None, :], z)
+
+    combine_fn = {'cummax': '_cummax_combine', 'last': '_last_combine'}.get(op)
+    if combine_fn is None:
+        kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': 'tl.cumsum(x, axis=AXIS)'})
+    else:
+        kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.associative_scan(x, AXIS, {combine_fn})'})
+    rs = RandomState(17)
+    # limit the range of integers so that the sum does not overflow
+    x = numpy_random(shape, dtype_str=dtype_str, rs=rs, low=-100, high=100)
+    if op == 'cumsum':
+        z_ref = np.cumsum(x, axis=axis).astype(getattr(np, dtype_str))
+    elif op == 'cummax':
+        z_ref = np.maximum.accumulate(x, axis=axis)
+    else:
+        z_ref = x
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty_like(x), device=device)
+    kernel[(1,)](x_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis, num_warps=num_warps)
+    z_tri = to_numpy(z_tri)
+    if op == 'cumsum' and dtype_str == 'float32':
+        np.testing.assert_allclose(z_ref, z_tri, rtol=1e-4)
+    else:
+        np.testing.assert_equal(z_ref, z_tri)
+
+
+@triton.jit
+def _matmul2x2_combine(a, b):
+    # products of 2x2 matrices modulo 16, packed in 4 nibbles, are
+    # associative but not commutative
+    a00 = a & 15
+    a01 = (a >> 4) & 15
+    a10 = (a >> 8) & 15
+    a11 = (a >> 12) & 15
+    b00 = b & 15
+    b01 = (b >> 4) & 15
+    b10 = (b >> 8) & 15
+    b11 = (b >> 12) & 15
+    c00 = (a00 * b00 + a01 * b10) & 15
+    c01 = (a00 * b01 + a01 * b11) & 15
+    c10 = (a10 * b00 + a11 * b10) & 15
+    c11 = (a10 * b01 + a11 * b11) & 15
+    return c00 | (c01 << 4) | (c10 << 8) | (c11 << 12)
+
+
+@pytest.mark.parametrize("BLOCK, num_warps", [(32, 1), (512, 4), (2048, 4)])
+def test_scan_noncommutative(BLOCK, num_warps, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, BLOCK: tl.constexpr):
+        x = tl.load(X + tl.arange(0, BLOCK))
+        tl.store(Z + tl.arange(0, BLOCK), tl.associative_scan(x, 0, _matmul2x2_combine))
+
+    def pack(m):
+        return (m[:, 0, 0] | (m[:, 0, 1] << 4) | (m[:, 1, 0] << 8) | (m[:, 1, 1] << 12)).astype(np.int32)
+
+    rs = RandomState(17)
+    mats = rs.randint(0, 16, size=(BLOCK, 2, 2))
+    ref = [mats[0]]
+    for mat in mats[1:]:
+        ref.append((ref[-1] @ mat) % 16)
+    x_tri = to_triton(pack(mats), device=device)
+    z_tri = to_triton(np.empty(BLOCK, dtype=np.int32), device=device)
+    kernel[(1,)](x_tri, z_tri, BLOCK=BLOCK, num_warps=num_warps)
+    np.testing.assert_equal(pack(np.stack(ref)), to_numpy(z_tri))
+
+
+# ---------------
+# test sort
+# ---------------
+
+
+sort_configs = [
+    (dtype, shape, axis, descending, num_warps)
+    for dtype in ['int8', 'int32', 'uint32', 'float16', 'float32']
+    for shape in [(1, 32), (4, 128), (32, 32), (2, 1024)]
+    for axis in [0, 1]
+    for descending in [False, True]
+    for num_warps in [1, 4]
+]
+
+
+@pytest.mark.parametrize("dtype_str, shape, axis, descending, num_warps", sort_configs)
+def test_sort2d(dtype_str, shape, axis, descending, num_warps, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, AXIS: tl.constexpr,
+               DESCENDING: tl.constexpr):
+        range_m = tl.arange(0, BLOCK_M)
+        range_n = tl.arange(0, BLOCK_N)
+        x = tl.load(X + range_m[:, None] * BLOCK_N + range_n[None, :])
+        z = tl.sort(x, AXIS, DESCENDING)
+        tl.store(Z + range_m[:, None] * BLOCK_N + range_n[None, :], z)
+
+    rs = RandomState(17)
+    x = numpy_random(shape, dtype_str=dtype_str, rs=rs)
+    z_ref = np.sort(x, axis=axis)
+    if descending:
+        z_ref = np.flip(z_ref, axis=axis)
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty_like(x), device=device)
+    kernel[(1,)](x_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], AXIS=axis,
+                 DESCENDING=descending, num_warps=num_warps)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
+@pytest.mark.parametrize("dtype_str, shape, k, num_warps",
+                         [(dtype, shape, k, num_warps)
+                          for dtype in ['int32', 'float32']
+                          for shape in [(4, 128), (2, 1024)]
+                          for k in [1, 8, 32]
+                          for num_warps in [1, 4]])
+def test_topk(dtype_str, shape, k, num_warps, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, K: tl.constexpr):
+        range_m = tl.arange(0, BLOCK_M)
+        range_n = tl.arange(0, BLOCK_N)
+        range_k = tl.arange(0, K)
+        x = tl.load(X + range_m[:, None] * BLOCK_N + range_n[None, :])
+        z = tl.topk(x, K, axis=1)
+        tl.store(Z + range_m[:, None] * K + range_k[None, :], z)
+
+    rs = RandomState(17)
+    x = numpy_random(shape, dtype_str=dtype_str, rs=rs)
+    z_ref = np.flip(np.sort(x, axis=1), axis=1)[:, :k]
+    x_tri = to_triton(x, device=device)
+    z_tri = to_triton(np.empty((shape[0], k), dtype=x.dtype), device=device)
+    kernel[(1,)](x_tri, z_tri, BLOCK_M=shape[0], BLOCK_N=shape[1], K=k, num_warps=num_warps)
+    np.testing.assert_equal(z_ref, to_numpy(z_tri))
+
+
 # ---------------
 # test permute
 # ---------------
@@ -1235,6 +1566,123 @@ def test_dot(M, N, K, num_warps, col_a, col_b, epilogue, allow_tf32, dtype, devi
         assert 'mma.sync.aligned.m16n8k32.row.col.satfinite.s32.s8.s8.s32' in ptx
 
 
+@pytest.mark.parametrize("M, N, K, in_dtype",
+                         [(M, N, K, in_dtype)
+                          for M, N, K in [(64, 64, 64), (128, 128, 64), (64, 128, 128)]
+                          for in_dtype in [tl.float8e4, tl.float8e5]])
+def test_dot_fp8(M, N, K, in_dtype, device='cuda'):
+    @triton.jit
+    def copy_kernel(input_ptr, output_ptr, n_elements, BLOCK_SIZE: tl.constexpr):
+        offsets = tl.program_id(axis=0) * BLOCK_SIZE + tl.arange(0, BLOCK_SIZE)
+        mask = offsets < n_elements
+        input = tl.load(input_ptr + offsets, mask=mask)
+        tl.store(output_ptr + offsets, input, mask=mask)
+
+    @triton.jit
+    def kernel(X, Y, Z, scale, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr):
+        off_m = tl.arange(0, M)
+        off_n = tl.arange(0, N)
+        off_k = tl.arange(0, K)
+        x = tl.load(X + off_m[:, None] * K + off_k[None, :])
+        y = tl.load(Y + off_k[:, None] * N + off_n[None, :])
+        z = tl.dot(x, y) * scale
+        tl.store(Z + off_m[:, None] * N + off_n[None, :], z)
+
+    def to_fp8(x):
+        x_f8 = torch.empty_like(x, dtype=torch.int8)
+        grid = lambda meta: (triton.cdiv(x.numel(), meta['BLOCK_SIZE']),)
+        copy_kernel[grid](x, triton.reinterpret(x_f8, in_dtype), x.numel(), BLOCK_SIZE=1024)
+        return triton.reinterpret(x_f8, in_dtype)
+
+    # small integers are exactly representable in both formats
+    a = torch.randint(-4, 5, (M, K), device=device).to(torch.float16)
+    b = torch.randint(-4, 5, (K, N), device=device).to(torch.float16)
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    scale = 0.5
+    kernel[(1,)](to_fp8(a), to_fp8(b), z, scale, M, N, K)
+    z_ref = torch.matmul(a.float(), b.float()) * scale
+    assert torch.all(z == z_ref)
+
+
+@pytest.mark.parametrize("M, N, K, num_warps, weight_bits, in_dtype",
+                         [(M, N, K, num_warps, weight_bits, in_dtype)
+                          for M, N, K, num_warps in [(16, 128, 64, 4), (64, 64, 64, 4), (128, 128, 64, 8)]
+                          for weight_bits in [4, 8]
+                          for in_dtype in ['float16', 'bfloat16']])
+def test_dot_weight_only(M, N, K, num_warps, weight_bits, in_dtype, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test weight-only quantized dots on devices with sm >= 80")
+
+    @triton.jit
+    def kernel(X, W, Scale, Zero, Z, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr,
+               K_W: tl.constexpr):
+        off_m = tl.arange(0, M)
+        off_n = tl.arange(0, N)
+        off_k = tl.arange(0, K)
+        off_kw = tl.arange(0, K_W)
+        x = tl.load(X + off_m[:, None] * K + off_k[None, :])
+        # weights are stored K-major, as the rows of a N x K_W matrix
+        w = tl.load(W + off_n[None, :] * K_W + off_kw[:, None])
+        scale = tl.load(Scale + off_n)
+        zero = tl.load(Zero + off_n)
+        z = (tl.dot(x, w) - tl.sum(x.to(tl.float32), 1)[:, None] * zero[None, :]) * scale[None, :]
+        tl.store(Z + off_m[:, None] * N + off_n[None, :], z)
+
+    torch_dtype = getattr(torch, in_dtype)
+    x = torch.randn((M, K), device=device).to(torch_dtype)
+    if weight_bits == 8:
+        q = torch.randint(-128, 128, (N, K), dtype=torch.int32, device=device)
+        w = q.to(torch.int8)
+    else:
+        q = torch.randint(-8, 8, (N, K), dtype=torch.int32, device=device)
+        # the even row of each pair in the low nibble
+        w = ((q[:, 0::2] & 0xf) | (q[:, 1::2] << 4)).to(torch.int8)
+    w = w.contiguous()
+    scale = torch.rand((N,), device=device) / 32
+    zero = torch.randint(-4, 4, (N,), device=device).float()
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    pgm = kernel[(1,)](x, w, scale, zero, z, M, N, K, w.shape[1], num_warps=num_warps)
+    z_ref = torch.matmul(x.float(), (q.t().float() - zero[None, :])) * scale[None, :]
+    torch.testing.assert_close(z, z_ref, rtol=1e-2, atol=1e-2)
+    # the weights are converted after their shared memory load
+    ptx = pgm.asm['ptx']
+    assert 'mma.sync.aligned.m16n8k16.row.col.f32' in ptx
+
+
+@pytest.mark.parametrize("M, N, K, num_warps, precision",
+                         [(M, N, K, num_warps, precision)
+                          for M, N, K, num_warps in [(64, 64, 64, 4), (128, 128, 64, 8)]
+                          for precision in ['ieee', 'tf32', 'tf32x3']])
+def test_dot_precision(M, N, K, num_warps, precision, device='cuda'):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test tf32 on devices with sm >= 80")
+
+    @triton.jit
+    def kernel(X, Y, Z, M: tl.constexpr, N: tl.constexpr, K: tl.constexpr,
+               PRECISION: tl.constexpr):
+        off_m = tl.arange(0, M)
+        off_n = tl.arange(0, N)
+        off_k = tl.arange(0, K)
+        x = tl.load(X + off_m[:, None] * K + off_k[None, :])
+        y = tl.load(Y + off_k[:, None] * N + off_n[None, :])
+        z = tl.dot(x, y, precision=PRECISION)
+        tl.store(Z + off_m[:, None] * N + off_n[None, :], z)
+
+    x = torch.randn((M, K), device=device)
+    y = torch.randn((K, N), device=device)
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    pgm = kernel[(1,)](x, y, z, M, N, K, precision, num_warps=num_warps)
+    z_ref = torch.matmul(x.double(), y.double()).float()
+    # tf32 keeps 10 mantissa bits, 3xTF32 recovers about 21
+    tol = 1e-2 if precision == 'tf32' else 1e-4
+    torch.testing.assert_close(z, z_ref, rtol=tol, atol=tol)
+    ptx = pgm.asm['ptx']
+    num_mma = ptx.count('mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32')
+    assert (num_mma > 0) == (precision != 'ieee')
+
+
 @pytest.mark.parametrize("dtype_str", ['float32', 'float16'])
 def test_dot_without_load(dtype_str):
     @triton.jit
@@ -1309,6 +1757,97 @@ def test_masked_load(dtype_str, size, size_diff, device='cuda'):
     reference_out = torch.cat((input, torch.ones((size_diff,), dtype=dtype, device=device)))
     triton.testing.allclose(output, reference_out)
 
+
+@pytest.mark.parametrize("dtype_str, size_diff", [(dtype_str, size_diff) for dtype_str in ['int8', 'float16', 'float32']
+                                                  for size_diff in [0, 3]])
+def test_native_load_store(dtype_str, size_diff, device='cuda'):
+    SIZE = 512
+    dtype = getattr(torch, dtype_str)
+    input = torch.randint(0, 127, (SIZE - size_diff,), dtype=torch.int32, device=device).to(dtype)
+    output = torch.zeros((SIZE,), dtype=dtype, device=device)
+
+    @triton.jit
+    def _kernel(in_ptr, out_ptr, in_size, SIZE: tl.constexpr):
+        offsets = tl.arange(0, SIZE)
+        x = tl.load(in_ptr + offsets, mask=offsets < in_size, other=1)
+        tl.store(out_ptr + offsets, x, mask=offsets < SIZE - 1)
+
+    pgm = _kernel[(1,)](input, output, input.numel(), SIZE=SIZE, native_load_store=True)
+    # the accesses are LLVM loads and stores rather than inline PTX
+    assert 'ld.global' not in pgm.asm['llir']
+    assert 'st.global' not in pgm.asm['llir']
+    reference_out = torch.cat((input, torch.ones((size_diff,), dtype=dtype, device=device)))
+    reference_out[-1] = 0
+    triton.testing.allclose(output, reference_out)
+
+
+@pytest.mark.parametrize("opt_level, fp_contraction", [(0, "off"), (1, "on"), (3, "fast")])
+def test_compile_options(opt_level, fp_contraction, device='cuda'):
+    SIZE = 128
+    x = torch.randn((SIZE,), dtype=torch.float32, device=device)
+    y = torch.randn((SIZE,), dtype=torch.float32, device=device)
+    z = torch.empty_like(x)
+
+    @triton.jit
+    def _kernel(X, Y, Z, SIZE: tl.constexpr):
+        offsets = tl.arange(0, SIZE)
+        x = tl.load(X + offsets)
+        y = tl.load(Y + offsets)
+        tl.store(Z + offsets, x * y + x)
+
+    pgm = _kernel[(1,)](x, y, z, SIZE=SIZE, opt_level=opt_level, fp_contraction=fp_contraction,
+                        disabled_passes=["licm"], max_registers=32)
+    assert '.maxnreg 32' in pgm.asm['ptx']
+    # the multiplication and the addition are separate expressions
+    assert ('fma.rn.f32' in pgm.asm['ptx']) == (fp_contraction == "fast")
+    triton.testing.assert_almost_equal(z, x * y + x)
+
+
+@pytest.mark.parametrize("min_blocks_per_sm", [1, 4])
+def test_min_blocks_per_sm(min_blocks_per_sm, device='cuda'):
+    SIZE = 1024
+    x = torch.randn((SIZE,), dtype=torch.float32, device=device)
+    z = torch.empty_like(x)
+
+    @triton.jit
+    def _kernel(X, Z, SIZE: tl.constexpr):
+        offsets = tl.arange(0, SIZE)
+        tl.store(Z + offsets, tl.exp(tl.load(X + offsets)))
+
+    pgm = _kernel[(1,)](x, z, SIZE=SIZE, num_warps=8, min_blocks_per_sm=min_blocks_per_sm)
+    assert f'.minnctapersm {min_blocks_per_sm}' in pgm.asm['ptx']
+    assert pgm.occupancy >= min_blocks_per_sm
+    assert pgm.metadata['occupancy'] == pgm.occupancy
+    triton.testing.assert_almost_equal(z, torch.exp(x))
+
+
+@pytest.mark.parametrize("profile", [True, "auto"])
+def test_profile(profile, device='cuda'):
+    from triton.runtime import instrumentation
+    SIZE = 128
+    x = torch.randn((4, SIZE), dtype=torch.float32, device=device)
+    z = torch.empty_like(x)
+
+    @triton.jit
+    def _kernel(X, Z, SIZE: tl.constexpr):
+        offsets = tl.program_id(0) * SIZE + tl.arange(0, SIZE)
+        with tl.profile_range("exp"):
+            z = tl.exp(tl.load(X + offsets))
+        tl.store(Z + offsets, z)
+
+    pgm = _kernel[(4,)](x, z, SIZE=SIZE, num_warps=4, profile=profile)
+    torch.cuda.synchronize()
+    triton.testing.assert_almost_equal(z, torch.exp(x))
+    assert pgm.metadata['profile']['regions'][:2] == ['kernel', 'exp']
+    # every warp of every program enters and leaves both regions
+    records = instrumentation.records(pgm)
+    assert len(records) == 4 * 4 * 4
+    summary = instrumentation.summary(pgm)
+    assert summary['kernel']['count'] == summary['exp']['count'] == 4 * 4
+    assert summary['kernel']['cycles'] >= summary['exp']['cycles'] > 0
+    trace = instrumentation.chrome_trace(pgm)
+    assert len([event for event in trace['traceEvents'] if event['ph'] == 'X']) == 4 * 4 * 2
+
 # Testing masked loads with an intermate copy to shared memory run.
 
 
@@ -1361,7 +1900,7 @@ def test_masked_load_shared_memory(dtype, device='cuda'):
     triton.testing.allclose(out, reference_out)
 
 
-@pytest.mark.parametrize("cache", ["", ".ca", ".cg"])
+@pytest.mark.parametrize("cache", ["", ".ca", ".cg", ".nc"])
 def test_load_cache_modifier(cache):
     src = torch.empty(128, device='cuda')
     dst = torch.empty(128, device='cuda')
@@ -1383,6 +1922,32 @@ def test_load_cache_modifier(cache):
     if cache == '.ca':
         assert 'ld.global.ca' in ptx
         assert 'ld.global.cg' not in ptx
+    if cache == '.nc':
+        assert 'ld.global.nc' in ptx
+
+
+@pytest.mark.parametrize("cache, eviction", [("", ""), (".cs", ""), ("", "evict_first"), ("", "no_allocate")])
+def test_store_cache_hints(cache, eviction):
+    src = torch.empty(128, device='cuda')
+    dst = torch.empty(128, device='cuda')
+
+    @triton.jit
+    def _kernel(dst, src, CACHE: tl.constexpr, EVICTION: tl.constexpr):
+        offsets = tl.arange(0, 128)
+        x = tl.load(src + offsets)
+        tl.store(dst + offsets, x, cache_modifier=CACHE, eviction_policy=EVICTION)
+
+    pgm = _kernel[(1,)](dst, src, CACHE=cache, EVICTION=eviction)
+    ptx = pgm.asm['ptx']
+    has_l2_hints = torch.cuda.get_device_capability()[0] >= 8
+    if cache == '.cs':
+        assert 'st.global.cs' in ptx
+    if eviction == '':
+        assert 'createpolicy' not in ptx
+    else:
+        l1_hint = 'L1::evict_first' if eviction == 'evict_first' else 'L1::no_allocate'
+        assert f'st.global.{l1_hint}' in ptx
+        assert ('createpolicy.fractional.L2::evict_first' in ptx) == has_l2_hints
 
 
 @pytest.mark.parametrize("N", [16, 10, 11, 1024])
@@ -1403,6 +1968,87 @@ def test_vectorization(N):
         assert "ld.global.b32" in ptx
     # triton.testing.assert_almost_equal(dst, src[:N])
 
+
+@pytest.mark.parametrize("N, num_programs", [(1 << 20, 4), (1000003, 7), (512, 4)])
+def test_grid_stride(N, num_programs):
+    src = torch.randn(N, device='cuda')
+    dst = torch.empty(N, device='cuda', dtype=torch.float16)
+
+    @triton.jit
+    def _kernel(dst, src, N, BLOCK_SIZE: tl.constexpr):
+        for off in tl.grid_stride(0, N, BLOCK_SIZE):
+            offsets = off + tl.arange(0, BLOCK_SIZE)
+            x = tl.load(src + offsets, mask=offsets < N, cache_modifier=".nc", eviction_policy="no_allocate")
+            tl.store(dst + offsets, x.to(tl.float16), mask=offsets < N)
+    pgm = _kernel[(num_programs,)](dst, src, N, BLOCK_SIZE=4096)
+    assert torch.equal(dst, src.half())
+    ptx = pgm.asm["ptx"]
+    if N % 16 == 0:
+        assert "ld.global.nc.L1::no_allocate" in ptx
+        assert ".v4.b32" in ptx
+
+
+@pytest.mark.parametrize("num_stages", [2, 3, 4])
+def test_pipelined_gather(num_stages):
+    NUM_BLOCKS, BLOCK = 16, 256
+    table = torch.randperm(NUM_BLOCKS, dtype=torch.int32, device='cuda')[:11]
+    src = torch.randn(NUM_BLOCKS * BLOCK, device='cuda')
+    dst = torch.empty(BLOCK, device='cuda')
+
+    @triton.jit
+    def _kernel(dst, src, table, n, BLOCK: tl.constexpr):
+        offsets = tl.arange(0, BLOCK)
+        acc = tl.zeros([BLOCK], dtype=tl.float32)
+        for i in range(n):
+            block = tl.load(table + i)
+            acc += tl.load(src + block * BLOCK + offsets)
+        tl.store(dst + offsets, acc)
+    _kernel[(1,)](dst, src, table, table.numel(), BLOCK=BLOCK, num_stages=num_stages)
+    ref = src.view(NUM_BLOCKS, BLOCK)[table.long()].sum(0)
+    triton.testing.assert_almost_equal(dst, ref)
+
+
+def test_ragged_load():
+    ROWS, COLS = 8, 64
+    lengths = torch.tensor([64, 0, 1, 17, 30, 63, 5, 48], dtype=torch.int32, device='cuda')
+    src = torch.randn(ROWS, COLS, device='cuda')
+    dst = torch.empty(ROWS, COLS, device='cuda')
+
+    @triton.jit
+    def _kernel(dst, src, LENGTHS, ROWS: tl.constexpr, COLS: tl.constexpr):
+        rows = tl.arange(0, ROWS)
+        cols = tl.arange(0, COLS)
+        lengths = tl.load(LENGTHS + rows)
+        offsets = rows[:, None] * COLS + cols[None, :]
+        x = tl.ragged_load(src + offsets, cols[None, :], lengths[:, None], other=0.)
+        tl.store(dst + offsets, x)
+    pgm = _kernel[(1,)](dst, src, lengths, ROWS=ROWS, COLS=COLS)
+    # the lengths don't prevent the vectorization
+    assert "ld.global.v4.b32" in pgm.asm["ptx"]
+    mask = torch.arange(COLS, device='cuda')[None, :] < lengths[:, None]
+    assert torch.equal(dst, torch.where(mask, src, torch.zeros_like(src)))
+
+
+@pytest.mark.parametrize("M, N", [(64, 256), (50, 100)])
+def test_block_ptr(M, N):
+    src = torch.randn(M, N, device='cuda')
+    dst = torch.empty(M, device='cuda')
+
+    @triton.jit
+    def _kernel(dst, src, M, N, stride_m, stride_n, BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr):
+        src_ptr = tl.make_block_ptr(src, shape=(M, N), strides=(stride_m, stride_n), offsets=(0, 0),
+                                    block_shape=(BLOCK_M, BLOCK_N), order=(1, 0))
+        acc = tl.zeros([BLOCK_M], dtype=tl.float32)
+        for _ in range(0, N, BLOCK_N):
+            x = tl.load(src_ptr, boundary_check=(0, 1), padding_option="zero")
+            acc += tl.sum(x, 1)
+            src_ptr = tl.advance(src_ptr, (0, BLOCK_N))
+        dst_ptr = tl.make_block_ptr(dst, shape=(M, ), strides=(1, ), offsets=(0, ),
+                                    block_shape=(BLOCK_M, ), order=(0, ))
+        tl.store(dst_ptr, acc, boundary_check=(0, ))
+    _kernel[(1,)](dst, src, M, N, src.stride(0), src.stride(1), BLOCK_M=64, BLOCK_N=32)
+    triton.testing.assert_almost_equal(dst, src.sum(1))
+
 # ---------------
 # test store
 # ---------------
@@ -1643,6 +2289,27 @@ def test_num_warps_pow2():
     _kernel[(1,)](dst=dst, num_warps=2)
     _kernel[(1,)](dst=dst, num_warps=4)
 
+
+@pytest.mark.parametrize("pid_remap, grid", [
+    (pid_remap, grid)
+    for pid_remap in ["grouped", "grouped-3", "morton"]
+    for grid in [(16, 16), (8, 32), (13, 7), (1, 5)]
+])
+def test_pid_remap(pid_remap, grid):
+
+    @triton.jit
+    def kernel(Visits, stride):
+        pid_m = tl.program_id(0)
+        pid_n = tl.program_id(1)
+        tl.atomic_add(Visits + pid_m * stride + pid_n, 1)
+
+    # the remapped program ids still visit every position of the grid once
+    visits = torch.zeros(grid, dtype=torch.int32, device='cuda')
+    kernel[grid](visits, visits.stride(0), pid_remap=pid_remap)
+    assert torch.all(visits == 1)
+    with pytest.raises(ValueError, match='unknown pid_remap'):
+        kernel[grid](visits, visits.stride(0), pid_remap="hilbert")
+
 # -------------
 # test extern
 # -------------
@@ -1736,6 +2403,22 @@ def test_libdevice_scalar(dtype_str, expr, lib_path):
     # compare
     np.testing.assert_allclose(y_ref, to_numpy(y_tri), rtol=0.01)
 
+
+def test_libdevice_link_only_needed():
+
+    @triton.jit
+    def kernel(X, Y, BLOCK: tl.constexpr):
+        x = tl.load(X + tl.arange(0, BLOCK))
+        tl.store(Y + tl.arange(0, BLOCK), tl.libdevice.ffs(x))
+
+    x = torch.zeros(128, dtype=torch.int32, device='cuda')
+    pgm = kernel[(1,)](x, x, BLOCK=128)
+    # only the functions the kernel calls are linked, not all of libdevice
+    definitions = re.findall(r'^define .*@(\w+)\(', pgm.asm['llir'], re.MULTILINE)
+    assert '__nv_ffs' in definitions
+    assert '__nv_powf' not in definitions
+    assert len(definitions) < 10
+
 # -----------------------
 # test layout conversions
 # -----------------------
@@ -134,6 +134,37 @@ def test_randint(size, seed, device='cuda'):
     out_ref = [gen.random_raw()[0] for _ in out_tri]
     assert out_tri == out_ref
 
+# test the 4 outputs per counter generation of rand
+
+
+@pytest.mark.parametrize('size, seed, reverse',
+                         [(size, seed, reverse) for size in [10, 10000]
+                          for seed in [0, 42, 0xffffffff, 0xdeadbeefcafeb0ba]
+                          for reverse in [False, True]]
+                         )
+def test_philox(size, seed, reverse, device='cuda'):
+    @triton.jit
+    def kernel(X, N, seed, REVERSE: tl.constexpr):
+        if REVERSE:
+            # offsets aren't contiguous: each element evaluates its own counter
+            offset = tl.program_id(0) * BLOCK + (BLOCK - 1 - tl.arange(0, BLOCK))
+        else:
+            offset = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        seed = seed.to(tl.uint64)
+        seed_hi = ((seed >> 32) & 0xffffffff).to(tl.uint32)
+        seed_lo = (seed & 0xffffffff).to(tl.uint32)
+        rand = tl.philox(offset, seed_lo, seed_hi, 10)
+        tl.store(X + offset, rand, mask=offset < N)
+    # triton result
+    x = torch.empty(size, dtype=torch.int32, device=device)
+    grid = (triton.cdiv(size, BLOCK),)
+    kernel[grid](x, size, seed, REVERSE=reverse)
+    out_tri = x.cpu().numpy().astype(np.uint32).flatten().tolist()
+    # reference result: the outputs of the counters, one after the other
+    gen = CustomPhilox(seed, config=PHILOX_32)
+    out_ref = [gen.random_raw() for _ in out_tri]
+    assert out_tri == out_ref
+
 # test uniform PRNG
 
 
@@ -0,0 +1,55 @@
+import pytest
+import torch
+
+import triton
+
+
+@pytest.mark.parametrize("Z, H, N_CTX, D_HEAD, causal, varlen",
+                         [
+                             (Z, H, N_CTX, D_HEAD, causal, varlen)
+                             for Z, H, N_CTX, D_HEAD in [(4, 48, 1024, 64), (2, 4, 500, 32), (1, 2, 256, 128)]
+                             for causal in [False, True]
+                             for varlen in [False, True]
+                         ]
+                         )
+def test_op(Z, H, N_CTX, D_HEAD, causal, varlen, dtype=torch.float16):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 8:
+        pytest.skip("Only test attention on devices with sm >= 80")
+    torch.manual_seed(20)
+    q = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.1, std=0.2).requires_grad_()
+    k = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.4, std=0.2).requires_grad_()
+    v = torch.empty((Z, H, N_CTX, D_HEAD), dtype=dtype, device="cuda").normal_(mean=0.3, std=0.2).requires_grad_()
+    sm_scale = 0.2
+    dout = torch.randn_like(q)
+    seq_lens = None
+    if varlen:
+        seq_lens = torch.randint(1, N_CTX + 1, (Z,), device="cuda")
+        seq_lens[0] = N_CTX
+    # reference implementation
+    mask = torch.ones((Z, 1, N_CTX, N_CTX), dtype=torch.bool, device="cuda")
+    if causal:
+        mask &= torch.tril(torch.ones((N_CTX, N_CTX), dtype=torch.bool, device="cuda"))
+    if varlen:
+        valid = torch.arange(N_CTX, device="cuda")[None, :] < seq_lens[:, None]
+        mask &= valid[:, None, None, :]
+    p = torch.matmul(q, k.transpose(2, 3)) * sm_scale
+    p = torch.softmax(p.float().masked_fill(~mask, float("-inf")), dim=-1).half()
+    ref_out = torch.matmul(p, v)
+    if varlen:
+        ref_out = ref_out * valid[:, None, :, None]
+    ref_out.backward(dout)
+    ref_dv, v.grad = v.grad.clone(), None
+    ref_dk, k.grad = k.grad.clone(), None
+    ref_dq, q.grad = q.grad.clone(), None
+    # triton implementation
+    tri_out = triton.ops.attention(q, k, v, causal=causal, sm_scale=sm_scale, seq_lens=seq_lens)
+    tri_out.backward(dout)
+    tri_dv, v.grad = v.grad.clone(), None
+    tri_dk, k.grad = k.grad.clone(), None
+    tri_dq, q.grad = q.grad.clone(), None
+    # compare
+    triton.testing.assert_almost_equal(ref_out, tri_out)
+    triton.testing.assert_almost_equal(ref_dv, tri_dv)
+    triton.testing.assert_almost_equal(ref_dk, tri_dk)
+    triton.testing.assert_almost_equal(ref_dq, tri_dq)
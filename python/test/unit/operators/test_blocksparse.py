@@ -64,6 +64,20 @@ def test_matmul(MODE, TRANS_A, TRANS_B, BLOCK, DTYPE, Z=3, H=2, M=512, N=384, K=
     triton.testing.assert_almost_equal(db_ref, db_tri)
 
 
+
+def test_matmul_lut_cache(BLOCK=32, H=2, M=256, N=256):
+    torch.manual_seed(0)
+    layout = torch.randint(2, (H, M // BLOCK, N // BLOCK))
+    op = triton.ops.blocksparse.matmul(layout, BLOCK, "dsd", device="cuda")
+    # look-up tables are shared by the ops with the same layout
+    same = triton.ops.blocksparse.matmul(layout.clone(), BLOCK, "dsd", device="cuda")
+    assert same.c_lut is op.c_lut and same.db_lut is op.db_lut
+    other_layout = layout.clone()
+    other_layout[0, 0, 0] = 1 - other_layout[0, 0, 0]
+    other = triton.ops.blocksparse.matmul(other_layout, BLOCK, "dsd", device="cuda")
+    assert other.c_lut is not op.c_lut
+
+
 configs = [
     (16, 256),
     (32, 576),
@@ -4,6 +4,7 @@ import pytest
 import torch
 
 import triton
+import triton.language as tl
 
 
 @pytest.mark.parametrize(
@@ -71,8 +72,6 @@ def test_op(BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, NWARP, NSTAGE, M, N, K, AT, BT,
         pytest.skip("Only test tl.dot() on devices with sm >= 70")
     if capability[0] < 8 and DTYPE == "bfloat16":
         pytest.skip("Only test bfloat16 on devices with sm >= 80")
-    if DTYPE == "bfloat16" and SPLIT_K != 1:
-        pytest.skip("bfloat16 matmuls don't allow split_k for now")
     torch.manual_seed(0)
     # nuke kernel decorators -- will set meta-parameters manually
     kwargs = {'BLOCK_M': BLOCK_M, 'BLOCK_N': BLOCK_N, 'BLOCK_K': BLOCK_K, 'SPLIT_K': SPLIT_K}
@@ -96,3 +95,132 @@ def test_op(BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, NWARP, NSTAGE, M, N, K, AT, BT,
     th_c = torch.matmul(a, b)
     tt_c = triton.testing.catch_oor(lambda: triton.ops.matmul(a, b), pytest)
     triton.testing.assert_almost_equal(th_c, tt_c)
+
+
+@pytest.mark.parametrize(
+    "M, N, K, DTYPE",
+    [
+        (M, N, K, DTYPE)
+        for M, N, K in [(128, 128, 1024), (512, 384, 256), (107, 233, 311), (2048, 2048, 128), (128, 128, 0)]
+        for DTYPE in ["float16", "float32"]
+    ],
+)
+def test_op_persistent(M, N, K, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    torch.manual_seed(0)
+    DTYPE = {"float16": torch.float16, "float32": torch.float32}[DTYPE]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=DTYPE)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=DTYPE)
+    th_c = torch.matmul(a, b)
+    tt_c = triton.testing.catch_oor(lambda: triton.ops.matmul_persistent(a, b), pytest)
+    triton.testing.assert_almost_equal(th_c, tt_c)
+    # partial tiles are reduced in a fixed order, so results are bitwise reproducible
+    for _ in range(5):
+        assert torch.equal(triton.ops.matmul_persistent(a, b), tt_c)
+    # the stream-k programs don't wait on each other, so grids larger than
+    # what can be resident at once complete as well
+    num_programs = 8 * torch.cuda.get_device_properties(0).multi_processor_count + 1
+    c = triton.testing.catch_oor(lambda: triton.ops._matmul_persistent._call(a, b, num_programs=num_programs), pytest)
+    triton.testing.assert_almost_equal(th_c, c)
+
+
+@pytest.mark.parametrize("SPLIT_K, DTYPE", [
+    (SPLIT_K, DTYPE) for SPLIT_K in [2, 4, 8] for DTYPE in ["float16", "bfloat16", "float32"]
+])
+def test_op_split_k_deterministic(SPLIT_K, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    if capability[0] < 8 and DTYPE == "bfloat16":
+        pytest.skip("Only test bfloat16 on devices with sm >= 80")
+    torch.manual_seed(0)
+    kwargs = {'BLOCK_M': 16, 'BLOCK_N': 64, 'BLOCK_K': 64, 'SPLIT_K': SPLIT_K}
+    triton.ops._matmul.kernel.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=3)]
+    # small M, large K
+    M, N, K = 16, 512, 8192
+    DTYPE = {"float16": torch.float16, "bfloat16": torch.bfloat16, "float32": torch.float32}[DTYPE]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=DTYPE)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=DTYPE)
+    th_c = torch.matmul(a, b)
+    tt_c = triton.ops.matmul(a, b)
+    triton.testing.assert_almost_equal(th_c, tt_c)
+    # the reduction order is fixed, so results are bitwise reproducible
+    for _ in range(10):
+        assert torch.equal(triton.ops.matmul(a, b), tt_c)
+    # launches on concurrent streams don't share their semaphores
+    streams = [torch.cuda.Stream() for _ in range(4)]
+    outs = []
+    torch.cuda.synchronize()
+    for stream in streams:
+        with torch.cuda.stream(stream):
+            outs.append(triton.ops.matmul(a, b))
+    torch.cuda.synchronize()
+    for out in outs:
+        assert torch.equal(out, tt_c)
+
+
+@pytest.mark.parametrize("SHAPES, DTYPE", [
+    (SHAPES, DTYPE)
+    for SHAPES in [
+        [(128, 128, 256)] * 4,
+        [(64, 256, 128), (384, 128, 640), (1, 512, 64), (107, 233, 311)],
+        [(512, 1024, 32 * g) for g in range(1, 17)],
+    ]
+    for DTYPE in ["float16", "float32"]
+])
+def test_op_grouped(SHAPES, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    torch.manual_seed(0)
+    DTYPE = {"float16": torch.float16, "float32": torch.float32}[DTYPE]
+    a = [.1 * torch.randn((M, K), device="cuda", dtype=DTYPE) for M, N, K in SHAPES]
+    b = [.1 * torch.randn((K, N), device="cuda", dtype=DTYPE) for M, N, K in SHAPES]
+    # transposed operands are made contiguous first
+    b[0] = b[0].t().contiguous().t()
+    th_c = [torch.matmul(x, y) for x, y in zip(a, b)]
+    tt_c = triton.testing.catch_oor(lambda: triton.ops.matmul_grouped(a, b), pytest)
+    for th, tt in zip(th_c, tt_c):
+        triton.testing.assert_almost_equal(th, tt)
+
+
+@triton.jit
+def bias_relu(acc, rm, rn, M, N, bias):
+    acc += tl.load(bias + rn, mask=rn < N, other=0.)[None, :]
+    return tl.maximum(acc, 0.)
+
+
+@triton.jit
+def add_residual(acc, rm, rn, M, N, residual):
+    mask = (rm < M)[:, None] & (rn < N)[None, :]
+    return acc + tl.load(residual + rm[:, None] * N + rn[None, :], mask=mask, other=0.)
+
+
+@pytest.mark.parametrize("M, N, K, DTYPE", [
+    (M, N, K, DTYPE)
+    for M, N, K in [(128, 128, 256), (107, 233, 311)]
+    for DTYPE in ["float16", "float32"]
+])
+def test_op_epilogue(M, N, K, DTYPE):
+    capability = torch.cuda.get_device_capability()
+    if capability[0] < 7:
+        pytest.skip("Only test tl.dot() on devices with sm >= 70")
+    torch.manual_seed(0)
+    # epilogues are not applied to split-k partial sums
+    kwargs = {'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 32, 'SPLIT_K': 1}
+    triton.ops._matmul.kernel.configs = [triton.Config(kwargs=kwargs, num_warps=4, num_stages=2)]
+    DTYPE = {"float16": torch.float16, "float32": torch.float32}[DTYPE]
+    a = .1 * torch.randn((M, K), device="cuda", dtype=DTYPE)
+    b = .1 * torch.randn((K, N), device="cuda", dtype=DTYPE)
+    bias = torch.randn((N,), device="cuda", dtype=DTYPE)
+    residual = torch.randn((M, N), device="cuda", dtype=DTYPE)
+    # bias + activation
+    th_c = torch.relu(torch.matmul(a, b) + bias)
+    tt_c = triton.testing.catch_oor(lambda: triton.ops.matmul(a, b, bias_relu, bias), pytest)
+    triton.testing.assert_almost_equal(th_c, tt_c)
+    # residual add
+    th_c = torch.matmul(a, b) + residual
+    tt_c = triton.testing.catch_oor(lambda: triton.ops.matmul(a, b, add_residual, residual), pytest)
+    triton.testing.assert_almost_equal(th_c, tt_c)
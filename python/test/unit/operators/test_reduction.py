@@ -0,0 +1,22 @@
+import pytest
+import torch
+
+import triton
+
+
+@pytest.mark.parametrize("N, dtype, op",
+                         [
+                             (N, dtype, op) for N in [1, 1000, 1024, 65537, 4 * 1024 * 1024 + 3]
+                             for dtype in ['float16', 'float32']
+                             for op in ['sum', 'max', 'min']
+                         ]
+                         )
+def test_op(N, dtype, op):
+    dtype = {'float16': torch.float16, 'float32': torch.float32}[dtype]
+    x = torch.randn(N, dtype=dtype, device='cuda')
+    tt_y = triton.ops.grid_reduce(x, op)
+    th_y = {'sum': torch.sum, 'max': torch.max, 'min': torch.min}[op](x.float()).to(dtype)
+    assert torch.allclose(th_y.float(), tt_y.float(), rtol=1e-2, atol=1e-2)
+    # the result does not depend on the order in which the programs finish
+    for _ in range(3):
+        assert torch.equal(tt_y, triton.ops.grid_reduce(x, op))
@@ -0,0 +1,135 @@
+import os
+
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+from triton.runtime import tuning_db
+from triton.runtime.autotuner import make_bucket
+from triton.runtime.search import SuccessiveHalving
+
+
+def test_make_bucket():
+    pow2 = make_bucket('pow2')
+    assert [pow2(x) for x in [1, 3, 16, 17, 1000]] == [1, 4, 16, 32, 1024]
+    ranges = make_bucket([128, 512, 2048])
+    assert [ranges(x) for x in [1, 128, 129, 2048, 3000]] == [128, 128, 512, 2048, 4096]
+    assert make_bucket(lambda x: x // 100)(1234) == 12
+
+
+def test_bucketed_autotune():
+    os.environ["TRITON_AUTOTUNE_DB"] = ""
+    tuning_db._db = None
+    try:
+        @triton.jit
+        def add_one(X, Y, N, BLOCK: tl.constexpr):
+            offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+            mask = offsets < N
+            tl.store(Y + offsets, tl.load(X + offsets, mask=mask) + 1, mask=mask)
+        run = add_one.run
+        kernel = triton.autotune(configs=[triton.Config({'BLOCK': 128}, num_warps=4),
+                                          triton.Config({'BLOCK': 256}, num_warps=8)],
+                                 key=['N'], buckets={'N': 'pow2'})(add_one)
+
+        x = torch.randn(1024, device="cuda")
+        for N in [1000, 1001, 1008, 1024]:
+            y = torch.zeros_like(x)
+            kernel[lambda META: (triton.cdiv(N, META['BLOCK']),)](x, y, N)
+            assert torch.allclose(y[:N], x[:N] + 1)
+        # one tuning and one binary per config for the whole bucket
+        assert list(kernel.cache.keys()) == [(1024,)]
+        assert len(kernel.fn.cache[torch.cuda.current_device()]) == 2
+        # the kernel launched without the autotuner is still specialized
+        assert add_one.do_not_specialize == set() and add_one.run is run
+        assert not add_one.cache
+    finally:
+        del os.environ["TRITON_AUTOTUNE_DB"]
+        tuning_db._db = None
+
+
+def test_ncu_counters():
+    counters = triton.testing.Counters(['l2_hit_rate', 'smem_bank_conflicts'])
+    l2, conflicts = triton.testing.NCU_METRICS['l2_hit_rate'], triton.testing.NCU_METRICS['smem_bank_conflicts']
+    report = '\n'.join([f'"ID","Kernel Name","{l2}","{conflicts}"',
+                        '"","","%",""',
+                        '"0","kernel[BLOCK: 64]","50","1,000"',
+                        '"1","kernel[BLOCK: 64]","70","24"',
+                        '"2","kernel[BLOCK: 128]","90","0"'])
+    assert counters.parse_ncu_csv(report) == {'kernel[BLOCK: 64]': {'l2_hit_rate': 60., 'smem_bank_conflicts': 1024.},
+                                              'kernel[BLOCK: 128]': {'l2_hit_rate': 90., 'smem_bank_conflicts': 0.}}
+    with pytest.raises(ValueError):
+        triton.testing.Counters(['l2_hit_rate'], backend='gpm')
+
+
+def test_successive_halving():
+    # the runtime is minimal for BLOCK=256 and num_warps=4
+    def runtime(config):
+        return 1 + abs(config.kwargs['BLOCK'] - 256) / 64 + abs(config.num_warps - 4)
+    configs = [triton.Config({'BLOCK': block}, num_warps=num_warps)
+               for block in [64, 512] for num_warps in [2, 8]]
+    benched = []
+
+    def compile(configs):
+        return ((config, True) for config in configs)
+
+    def bench(config, rep):
+        benched.append((config.kwargs['BLOCK'], config.num_warps, rep))
+        return (runtime(config), runtime(config), runtime(config))
+    search = SuccessiveHalving(rep=(10, 90), eta=3)
+    best, timings = search.run(configs, compile, bench)
+    assert (best.kwargs['BLOCK'], best.num_warps) == (64, 2)
+    # all the configs are run for 10ms, and only the fastest ones for longer
+    assert sorted(rep for _, _, rep in benched) == [10, 10, 10, 10, 30, 30, 90]
+    assert len(timings) == len(configs)
+    # proposals move the fastest configs towards the optimum
+    space = {'BLOCK': [64, 128, 256, 512], 'num_warps': [2, 4, 8]}
+    search = SuccessiveHalving(rep=(10, 270), eta=3, space=space, num_proposals=2)
+    best, timings = search.run(configs, compile, bench)
+    assert (best.kwargs['BLOCK'], best.num_warps) == (256, 4)
+    assert len(timings) > len(configs)
+
+
+
+def test_search_launch_options():
+    # the runtime is minimal for 2 CTAs per SM, whatever the block
+    def runtime(config):
+        return 1 + abs(config.min_blocks_per_sm - 2) + config.kwargs['BLOCK'] / 1024
+    configs = [triton.Config({'BLOCK': block}, num_warps=4, min_blocks_per_sm=1) for block in [64, 128, 256]]
+
+    def compile(configs):
+        return ((config, True) for config in configs)
+
+    def bench(config, rep):
+        return runtime(config)
+    space = {'min_blocks_per_sm': [1, 2, 4], 'max_registers': [0, 128]}
+    search = SuccessiveHalving(rep=(10, 270), eta=3, space=space, num_proposals=2)
+    best, _ = search.run(configs, compile, bench)
+    assert (best.kwargs['BLOCK'], best.min_blocks_per_sm) == (64, 2)
+    assert 'min_blocks_per_sm: 2' in str(best)
+
+@pytest.mark.skipif(torch.cuda.device_count() < 2, reason="requires multiple GPUs")
+def test_multi_device_autotune():
+    os.environ["TRITON_AUTOTUNE_DB"] = ""
+    tuning_db._db = None
+    try:
+        configs = [triton.Config({'BLOCK': block}, num_warps=num_warps)
+                   for block in [128, 256, 512] for num_warps in [2, 4]]
+
+        @triton.autotune(configs=configs, key=['N'], devices="all")
+        @triton.jit
+        def kernel(X, Y, N, BLOCK: tl.constexpr):
+            offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+            mask = offsets < N
+            tl.store(Y + offsets, tl.load(X + offsets, mask=mask) + 1, mask=mask)
+
+        N = 1 << 20
+        x = torch.randn(N, device="cuda")
+        y = torch.zeros_like(x)
+        kernel[lambda META: (triton.cdiv(N, META['BLOCK']),)](x, y, N)
+        assert torch.allclose(y, x + 1)
+        # every config is timed once, on one of the devices
+        assert set(kernel.configs_timings) == set(configs)
+    finally:
+        del os.environ["TRITON_AUTOTUNE_DB"]
+        tuning_db._db = None
@@ -1,3 +1,4 @@
+import json
 import multiprocessing
 import os
 import re
@@ -107,6 +108,50 @@ def test_specialize(mode):
     assert counter == target
 
 
+def test_lazy_specialization():
+    @triton.jit(lazy_specialization=True)
+    def kernel_lazy(X, Y, i):
+        tl.store(Y, tl.load(X) + i)
+
+    x = torch.arange(32, dtype=torch.int32, device='cuda')
+    y = torch.empty(1, dtype=torch.int32, device='cuda')
+    cache = kernel_lazy.cache[torch.cuda.current_device()]
+    kernel_lazy[(1,)](x, y, 16)
+    assert y.item() == 16
+    # the specialized and the generic variants
+    assert len(cache) == 2
+    # misaligned pointers and new values run the generic variant
+    for offset, i in [(1, 16), (0, 1), (3, 7)]:
+        kernel_lazy[(1,)](x[offset:], y, i)
+        assert y.item() == offset + i
+    assert len({id(bin) for bin in cache.values()}) == 2
+
+
+def test_async_compile():
+    @triton.jit(async_compile=True)
+    def kernel_async(X, Y, i):
+        tl.store(Y, tl.load(X) + i)
+
+    reset_tmp_dir()
+    x = torch.arange(32, dtype=torch.int32, device='cuda')
+    y = torch.zeros(1, dtype=torch.int32, device='cuda')
+    cache = kernel_async.cache[torch.cuda.current_device()]
+    # nothing can run yet: the launch returns the future of the kernel
+    future = kernel_async[(1,)](x, y, 16)
+    bin = future.result()
+    assert y.item() == 0
+    # the generic variant compiles in the background too
+    for pending in kernel_async.pending[torch.cuda.current_device()].values():
+        pending.result()
+    assert len(cache) == 2
+    assert kernel_async[(1,)](x, y, 16) is bin
+    assert y.item() == 16
+    # new specializations run the generic variant while they compile
+    ran = kernel_async[(1,)](x[1:], y, 7)
+    assert isinstance(ran, triton.compiler.CompiledKernel)
+    assert y.item() == 8
+
+
 @pytest.mark.parametrize("value, value_type", [
     (-1, 'i32'), (0, 'i32'), (1, 'i32'), (-2**31, 'i32'), (2**31 - 1, 'i32'),
     (2**32, 'i64'), (2**63 - 1, 'i64'), (-2**63, 'i64'),
@@ -134,6 +179,20 @@ def test_value_specialization(value: int, value_type: str, device='cuda') -> Non
     assert spec_type == value_type
 
 
+def test_dispatch_key() -> None:
+    x = torch.empty(4, dtype=torch.float32)
+    values = [x, x[1:], 1, 16, -32, True, 2**31, 2**63, 2**64, -2**70, 2**70, 1.5]
+    # kinds: specialized, not specialized, constexpr
+    dispatcher = triton._C.libtriton.triton.runtime.dispatcher("v", [0, 1, 2], JITFunction.divisibility)
+    for value in values:
+        key = dispatcher.key(value, value, value)
+        assert key == ("v", (JITFunction._key_of(value),) * 2, (value,), (JITFunction._spec_of(value),))
+    with pytest.raises(TypeError):
+        dispatcher.key("x", 1, 1)
+    # the offsets into tensors below 2GB are specialized to 32 bits
+    assert dispatcher.key(x, x, x)[3] == ((True, True),)
+
+
 def test_constexpr_not_callable() -> None:
     @triton.jit
     def kernel(X, c: tl.constexpr):
@@ -154,6 +213,40 @@ def test_constexpr_not_callable() -> None:
     assert error is True
 
 
+def test_constexpr_jit_function() -> None:
+    @triton.jit
+    def kernel(X, FN: tl.constexpr):
+        tl.store(X, FN(tl.load(X)))
+
+    x = torch.zeros(1, dtype=torch.int32, device='cuda')
+    kernel[(1, )](x, FN=function_1)
+    assert x.item() == 2
+    kernel[(1, )](x, FN=function_2)
+    assert x.item() == 3
+    assert len(kernel.cache[torch.cuda.current_device()]) == 2
+
+
+def test_background_load() -> None:
+    @triton.jit
+    def kernel_store(X, i):
+        tl.store(X, i)
+
+    @triton.jit
+    def kernel_add(X, i):
+        tl.store(X, tl.load(X) + i)
+
+    x = torch.zeros(1, dtype=torch.int32, device='cuda')
+    bins = [kernel.warmup(x, 3, grid=(1,)) for kernel in [kernel_store, kernel_add]]
+    # both kernels share the launcher of their signature and start
+    # loading before their first launch
+    assert bins[0].c_wrapper is bins[1].c_wrapper
+    assert all(bin._load_future is not None for bin in bins)
+    kernel_store[(1, )](x, 3)
+    kernel_add[(1, )](x, 3)
+    assert x.item() == 6
+    assert bins[1].cu_function is not None
+
+
 def test_jit_warmup_cache() -> None:
     @triton.jit
     def kernel_add(a, b, o, N: tl.constexpr):
@@ -176,6 +269,25 @@ def test_jit_warmup_cache() -> None:
     assert len(kernel_add.cache) == 1
 
 
+def test_fast_launcher() -> None:
+    @triton.jit
+    def kernel_add(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) + tl.load(b + idx))
+
+    a = torch.randn(32, dtype=torch.float32, device="cuda")
+    b = torch.randn(32, dtype=torch.float32, device="cuda")
+    o = torch.empty(32, dtype=torch.float32, device="cuda")
+    launch = kernel_add.fast_launcher(a, b, o, N=32, grid=(1,))
+    assert len(kernel_add.cache[torch.cuda.current_device()]) == 1
+    for _ in range(3):
+        a = torch.randn(32, dtype=torch.float32, device="cuda")
+        launch(a, b, o)
+        assert torch.allclose(o, a + b)
+    assert len(kernel_add.cache[torch.cuda.current_device()]) == 1
+
+
 def test_compile_in_subproc() -> None:
     @triton.jit
     def kernel_sub(a, b, o, N: tl.constexpr):
@@ -204,3 +316,158 @@ def test_compile_in_subproc() -> None:
     proc.start()
     proc.join()
     assert proc.exitcode == 0
+
+
+def test_remote_cache(monkeypatch) -> None:
+    @triton.jit
+    def kernel_mul(a, b, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx,
+                 tl.load(a + idx) * tl.load(b + idx) * 333)
+
+    reset_tmp_dir()
+    remote_dir = os.path.join(tmpdir, "remote")
+    triton.compiler.set_remote_cache_backend(triton.compiler.FileRemoteCacheBackend(remote_dir))
+    kwargs = dict(signature={0: "*fp32", 1: "*fp32", 2: "*fp32"}, device=0, constants={3: 32})
+    try:
+        triton.compile(kernel_mul, **kwargs)
+        assert len(os.listdir(remote_dir)) == 1
+        # wipe the local tier, the kernel must be fetched instead of recompiled
+        for entry in os.listdir(tmpdir):
+            if entry != "remote":
+                shutil.rmtree(os.path.join(tmpdir, entry))
+        triton.compiler._fetch_remote_bundle.cache_clear()
+
+        def fail(*args, **kwargs):
+            raise AssertionError("kernel was recompiled")
+        monkeypatch.setattr(triton.compiler, "ast_to_ttir", fail)
+        monkeypatch.setattr(triton.compiler, "ttir_to_ttgir", fail)
+        monkeypatch.setattr(triton.compiler, "ptx_to_cubin", fail)
+        x = torch.randn(32, dtype=torch.float32, device="cuda")
+        bin = triton.compile(kernel_mul, **kwargs)
+        bin[(1, 1, 1)](x, x, x)
+    finally:
+        triton.compiler.set_remote_cache_backend(None)
+
+
+def test_remote_cache_bundle_format(tmp_path) -> None:
+    bundle = {"kernel.json": b"{}", "kernel.cubin": bytes(range(256))}
+    assert triton.compiler._decode_bundle(triton.compiler._encode_bundle(bundle)) == bundle
+    # blobs of the shared tier are data: pickles and file names escaping the
+    # cache directory are rejected
+    import pickle
+    assert triton.compiler._decode_bundle(pickle.dumps(bundle)) is None
+    evil = json.dumps({"files": {"../kernel.cubin": ""}}).encode()
+    assert triton.compiler._decode_bundle(evil) is None
+    # concurrent writers of the same key don't share a temporary file
+    backend = triton.compiler.FileRemoteCacheBackend(str(tmp_path))
+    backend.put("key", b"data")
+    assert backend.get("key") == b"data"
+    assert os.listdir(tmp_path) == ["key"]
+
+
+def test_compile_profile() -> None:
+    @triton.jit
+    def kernel_mul(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) * 3)
+
+    reset_tmp_dir()
+    a = torch.randn(32, dtype=torch.float32, device="cuda")
+    bin = kernel_mul.warmup(a, a, N=32, grid=(1,))
+    profile = bin.compile_profile
+    assert set(profile["stages"]) == {"ttir", "ttgir", "llir", "ptx", "cubin"}
+    assert profile["ptxas"] == profile["stages"]["cubin"]
+    # passes are recorded once per run, in order
+    names = [p["name"] for p in profile["passes"]]
+    assert names.index("tritongpu-coalesce") < names.index("convert-triton-gpu-to-llvm")
+    assert profile["pass_totals"]["tritongpu-combine"]["count"] == names.count("tritongpu-combine") == 3
+    assert "llvm-opt" in profile["pass_totals"]
+    assert profile["memory"]["peak"] >= 0
+
+
+def test_version_key_hashes(tmp_path, monkeypatch) -> None:
+    monkeypatch.setenv("TRITON_CACHE_DIR", str(tmp_path))
+    src = tmp_path / "src.py"
+    src.write_text("x = 1")
+    computed = []
+
+    def compute(path):
+        computed.append(path)
+        return str(len(computed))
+    hashes = triton.runtime.jit._StampedHashes()
+    assert hashes.get("md5", str(src), compute) == "1"
+    hashes.save()
+    # other processes reuse the persisted hash until the file changes
+    hashes = triton.runtime.jit._StampedHashes()
+    assert hashes.get("md5", str(src), compute) == "1"
+    src.write_text("x = 22")
+    assert hashes.get("md5", str(src), compute) == "2"
+    assert len(computed) == 2
+
+
+def test_context_reuse(monkeypatch) -> None:
+    @triton.jit
+    def kernel_sub(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) - 1)
+
+    reset_tmp_dir()
+    monkeypatch.setattr(triton.compiler, "_context_pool", triton.compiler.ContextPool(max_uses=2))
+    a = torch.randn(256, dtype=torch.float32, device="cuda")
+    # the second compilation reuses the context of the first one, which is
+    # retired after it
+    uses = [kernel_sub.warmup(a, a, N=N, grid=(1,)).compile_profile["memory"]["context_uses"]
+            for N in [64, 128, 256]]
+    assert uses == [0, 1, 0]
+
+
+def test_stage_reuse() -> None:
+    @triton.jit
+    def kernel_add(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) + 1)
+
+    reset_tmp_dir()
+    a = torch.randn(128, dtype=torch.float32, device="cuda")
+    kernel_add.warmup(a, a, N=128, grid=(1,), num_warps=4)
+    # the Triton IR doesn't depend on the number of warps
+    bin = kernel_add.warmup(a, a, N=128, grid=(1,), num_warps=8)
+    assert set(bin.compile_profile["stages"]) == {"ttgir", "llir", "ptx", "cubin"}
+    # without loops, the kernel isn't pipelined, so its TritonGPU IR and all
+    # the stages after it are shared by the number of stages
+    bin = kernel_add.warmup(a, a, N=128, grid=(1,), num_warps=8, num_stages=2)
+    assert set(bin.compile_profile["stages"]) == {"ttgir"}
+
+
+def test_compile_batch() -> None:
+    @triton.jit
+    def kernel_add(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.load(a + idx) + 1)
+
+    @triton.jit
+    def kernel_exp(a, o, N: tl.constexpr):
+        idx = tl.arange(0, N)
+        tl.store(o + idx, tl.exp(tl.load(a + idx)))
+
+    reset_tmp_dir()
+    signature = {0: "*fp32", 1: "*fp32"}
+    add, exp = triton.compile_batch([(kernel_add, dict(constants={2: 128})),
+                                     (kernel_exp, dict(constants={2: 128}, num_warps=2))],
+                                    signature=signature, device=0)
+    # one PTX module and one cubin with both entry points
+    assert add.asm["cubin"] is exp.asm["cubin"]
+    assert add.asm["ptx"].count(".entry") == 2
+    assert add.metadata["name"] != exp.metadata["name"]
+    a = torch.randn(128, dtype=torch.float32, device="cuda")
+    o = torch.empty_like(a)
+    add[(1, 1, 1)](a, o)
+    assert torch.allclose(o, a + 1)
+    exp[(1, 1, 1)](a, o)
+    assert torch.allclose(o, torch.exp(a))
+    # kernels with the same name can't be linked together
+    with pytest.raises(ValueError):
+        triton.compile_batch([(kernel_add, dict(constants={2: 128})),
+                              (kernel_add, dict(constants={2: 128}, num_warps=2))],
+                             signature=signature, device=0)
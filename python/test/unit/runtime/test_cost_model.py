@@ -0,0 +1,37 @@
+import torch
+
+import triton
+from triton.ops.matmul_perf_model import estimate_matmul_time
+from triton.runtime import cost_model
+
+
+def test_count_ops():
+    ir = """
+    %0 = tt.load %arg0 {cache = 1 : i32} : tensor<128x!tt.ptr<f16>, #blocked>
+    %1 = "triton_gpu.convert_layout"(%0) : (tensor<128xf16>) -> tensor<128xf16>
+    tt.store %arg1, %1 : tensor<128xf16, #blocked>
+    """
+    ops = cost_model.count_ops(ir)
+    assert ops["tt.load"] == 1
+    assert ops["triton_gpu.convert_layout"] == 1
+    assert ops["tt.store"] == 1
+    assert ops["tt.ptr"] == 0
+
+
+def test_compiled_matmul_estimate():
+    M, N, K = 512, 512, 512
+    a = torch.randn((M, K), device="cuda", dtype=torch.float16)
+    b = torch.randn((K, N), device="cuda", dtype=torch.float16)
+    config = triton.Config({'BLOCK_M': 128, 'BLOCK_N': 128, 'BLOCK_K': 32, 'SPLIT_K': 1}, num_stages=3, num_warps=4)
+    triton.ops._matmul.kernel.configs = [config]
+    triton.ops.matmul(a, b)
+    kernel = next(iter(triton.ops._matmul.kernel.fn.fn.cache[torch.cuda.current_device()].values()))
+    stats = cost_model.KernelStats.from_compiled(kernel)
+    assert stats.ops["tt.dot"] >= 1
+    assert stats.n_regs > 0
+    assert cost_model.get_occupancy(stats, torch.cuda.current_device()) >= 1
+    kwargs = dict(config.kwargs, num_warps=config.num_warps, num_stages=config.num_stages)
+    estimated = estimate_matmul_time(A=a, B=b, C=None, M=M, N=N, K=K, **kwargs)
+    compiled = estimate_matmul_time(A=a, B=b, C=None, M=M, N=N, K=K, kernel=kernel, **kwargs)
+    assert 0 < estimated < float('inf')
+    assert 0 < compiled < float('inf')
@@ -0,0 +1,69 @@
+import pytest
+import torch
+
+import triton
+import triton.language as tl
+
+
+@triton.jit
+def add_kernel(X, Y, Z, alpha, N: tl.constexpr):
+    idx = tl.arange(0, N)
+    tl.store(Z + idx, tl.load(X + idx) + alpha * tl.load(Y + idx))
+
+
+def test_capture_replay():
+    x = torch.randn(128, device="cuda")
+    y = torch.randn(128, device="cuda")
+    z = torch.empty(128, device="cuda")
+    w = torch.empty(128, device="cuda")
+    # compile before capturing
+    add_kernel[(1,)](x, y, z, 1., N=128)
+    graph = triton.runtime.KernelGraph()
+
+    def step():
+        add_kernel[(1,)](x, y, z, 2., N=128)
+        add_kernel[(1,)](z, y, w, 3., N=128)
+    graph.capture(step)
+    z.zero_()
+    w.zero_()
+    graph.replay()
+    torch.cuda.synchronize()
+    assert torch.allclose(z, x + 2. * y)
+    assert torch.allclose(w, z + 3. * y)
+
+
+def test_update_parameters():
+    x = torch.randn(128, device="cuda")
+    y = torch.randn(128, device="cuda")
+    z1 = torch.empty(128, device="cuda")
+    z2 = torch.empty(128, device="cuda")
+    add_kernel[(1,)](x, y, z1, 1., N=128)
+    graph = triton.runtime.KernelGraph()
+    graph.capture(lambda: add_kernel[(1,)](x, y, z1, 2., N=128))
+    exec = graph.exec
+    # same topology: kernel node parameters are updated in place
+    graph.capture(lambda: add_kernel[(1,)](y, x, z2, 4., N=128))
+    assert graph.exec == exec
+    graph.replay()
+    torch.cuda.synchronize()
+    assert torch.allclose(z2, y + 4. * x)
+
+
+def test_failed_capture():
+    x = torch.randn(128, device="cuda")
+    y = torch.randn(128, device="cuda")
+    z = torch.empty(128, device="cuda")
+    add_kernel[(1,)](x, y, z, 1., N=128)
+    graph = triton.runtime.KernelGraph()
+
+    def step():
+        add_kernel[(1,)](x, y, z, 2., N=128)
+        raise ValueError("step failed")
+    with pytest.raises(ValueError, match="step failed"):
+        graph.capture(step)
+    assert graph.exec == 0
+    # the stream isn't left capturing
+    graph.capture(lambda: add_kernel[(1,)](x, y, z, 2., N=128))
+    graph.replay()
+    torch.cuda.synchronize()
+    assert torch.allclose(z, x + 2. * y)
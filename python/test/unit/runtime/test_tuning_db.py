@@ -0,0 +1,55 @@
+import json
+import os
+
+import torch
+
+import triton
+import triton.language as tl
+from triton.runtime import tuning_db
+
+
+def make_kernel():
+    @triton.autotune(configs=[triton.Config({'BLOCK': 128}, num_warps=4),
+                              triton.Config({'BLOCK': 256}, num_warps=8)],
+                     key=['N'])
+    @triton.jit
+    def kernel(X, Y, N, BLOCK: tl.constexpr):
+        offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+        mask = offsets < N
+        tl.store(Y + offsets, tl.load(X + offsets, mask=mask) + 1, mask=mask)
+    return kernel
+
+
+def test_persistence(tmp_path):
+    path = str(tmp_path / "autotune.json")
+    os.environ["TRITON_AUTOTUNE_DB"] = path
+    tuning_db._db = None
+    try:
+        N = 4096
+        x = torch.randn(N, device="cuda")
+        y = torch.empty_like(x)
+        grid = lambda META: (triton.cdiv(N, META['BLOCK']),)
+        kernel = make_kernel()
+        kernel[grid](x, y, N)
+        assert hasattr(kernel, 'configs_timings')
+        with open(path) as f:
+            data = json.load(f)
+        assert data["version"] == tuning_db.VERSION
+        # a new process (simulated here) reuses the result without benchmarking
+        tuning_db._db = None
+        kernel = make_kernel()
+        kernel[grid](x, y, N)
+        assert not hasattr(kernel, 'configs_timings')
+        assert torch.allclose(y, x + 1)
+        # results can be exported and imported
+        exported = str(tmp_path / "exported.json")
+        triton.runtime.export_tuning_db(exported)
+        os.environ["TRITON_AUTOTUNE_DB"] = ""
+        tuning_db._db = None
+        triton.runtime.import_tuning_db(exported)
+        kernel = make_kernel()
+        kernel[grid](x, y, N)
+        assert not hasattr(kernel, 'configs_timings')
+    finally:
+        del os.environ["TRITON_AUTOTUNE_DB"]
+        tuning_db._db = None
@@ -0,0 +1,47 @@
+import ctypes
+
+import torch
+
+import triton
+import triton.language as tl
+from triton.tools.aot import AOTKernel, build_library, generate_library
+
+
+@triton.jit
+def add_kernel(X, Y, Z, N, BLOCK: tl.constexpr):
+    offsets = tl.program_id(0) * BLOCK + tl.arange(0, BLOCK)
+    mask = offsets < N
+    tl.store(Z + offsets, tl.load(X + offsets, mask=mask) + tl.load(Y + offsets, mask=mask), mask=mask)
+
+
+def test_library(tmp_path):
+    capability = torch.cuda.get_device_capability()
+    cc = capability[0] * 10 + capability[1]
+    kernels = [
+        AOTKernel(add_kernel, "add_f32", "*fp32:16, *fp32:16, *fp32:16, i32", constants={"BLOCK": 1024}),
+        AOTKernel(add_kernel, "add_f32_auto", "*fp32:16, *fp32:16, *fp32:16, i32", constants={"BLOCK": 256},
+                  grid=("(N + 255) / 256", "1", "1")),
+    ]
+    header, source = generate_library(kernels, "kernels", str(tmp_path), ccs=[cc])
+    with open(header) as f:
+        assert "CUresult add_f32(CUstream stream, unsigned int gridX" in f.read()
+    lib = ctypes.CDLL(build_library(source, str(tmp_path / "libkernels.so")))
+    # the library uses the context made current by torch
+    torch.cuda.synchronize()
+    assert lib.kernels_load() == 0
+    N = 3000
+    x = torch.randn(N, device="cuda")
+    y = torch.randn(N, device="cuda")
+    stream = ctypes.c_void_p(torch.cuda.current_stream().cuda_stream)
+    z = torch.empty_like(x)
+    ptrs = [ctypes.c_uint64(t.data_ptr()) for t in [x, y, z]]
+    assert lib.add_f32(stream, ctypes.c_uint(triton.cdiv(N, 1024)), ctypes.c_uint(1), ctypes.c_uint(1),
+                       *ptrs, ctypes.c_int32(N)) == 0
+    torch.cuda.synchronize()
+    assert torch.allclose(z, x + y)
+    z = torch.empty_like(x)
+    ptrs = [ctypes.c_uint64(t.data_ptr()) for t in [x, y, z]]
+    assert lib.add_f32_auto(stream, *ptrs, ctypes.c_int32(N)) == 0
+    torch.cuda.synchronize()
+    assert torch.allclose(z, x + y)
+    lib.kernels_unload()
@@ -25,7 +25,7 @@ from .runtime import (
     KernelInterface,
 )
 from .runtime.jit import jit
-from .compiler import compile, CompilationError
+from .compiler import compile, compile_batch, CompilationError
 from . import language
 from . import testing
 from . import ops
@@ -35,6 +35,7 @@ __all__ = [
     "cdiv",
     "CompilationError",
     "compile",
+    "compile_batch",
     "Config",
     "heuristics",
     "impl",
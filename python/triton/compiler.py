@@ -1,9 +1,11 @@
 from __future__ import annotations
 
 import ast
+import base64
 import contextlib
 import functools
 import hashlib
+import inspect
 import io
 import json
 import os
@@ -13,11 +15,14 @@ import subprocess
 import sys
 import sysconfig
 import tempfile
+import threading
+import time
 import warnings
 from collections import namedtuple
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from sysconfig import get_paths
-from typing import Any, Callable, Dict, Tuple, Union
+from typing import Any, Callable, Dict, List, Tuple, Union
 
 import setuptools
 import torch
@@ -35,6 +40,8 @@ def str_to_ty(name):
         return triton.language.pointer_type(ty)
     tys = {
         "fp8": triton.language.float8,
+        "fp8e4": triton.language.float8e4,
+        "fp8e5": triton.language.float8e5,
         "fp16": triton.language.float16,
         "bf16": triton.language.bfloat16,
         "fp32": triton.language.float32,
@@ -60,6 +67,10 @@ def mangle_ty(ty):
         return 'i' + str(ty.int_bitwidth)
     if ty.is_fp8():
         return 'fp8'
+    if ty.is_fp8e4():
+        return 'fp8e4'
+    if ty.is_fp8e5():
+        return 'fp8e5'
     if ty.is_fp16():
         return 'fp16'
     if ty.is_bf16():
@@ -77,10 +88,18 @@ def mangle_ty(ty):
     assert False, "Unsupported type"
 
 
+def mangle_constant(cst):
+    # @triton.jit functions passed as constexprs are keyed by their qualified name
+    fn = cst.value if isinstance(cst, triton.language.constexpr) else cst
+    if isinstance(fn, triton.runtime.JITFunction):
+        return f'{fn.module}_{fn.__name__}'.replace('.', '_')
+    return repr(cst)
+
+
 def mangle_fn(name, arg_tys, constants):
     # doesn't mangle ret type, which must be a function of arg tys
     mangled_arg_names = '_'.join([mangle_ty(ty) for ty in arg_tys])
-    mangled_constants = '_'.join([f'{i}c{repr(constants[i])}' for i in sorted(constants)])
+    mangled_constants = '_'.join([f'{i}c{mangle_constant(constants[i])}' for i in sorted(constants)])
     mangled_constants = mangled_constants.replace('.', '_d_')
     mangled_constants = mangled_constants.replace("'", '_sq_')
     ret = f'{name}__{mangled_arg_names}__{mangled_constants}'
@@ -230,8 +249,8 @@ class CodeGenerator(ast.NodeVisitor):
                 arg_values.append(cst)
                 continue
             else:
-                if i in self.attributes:
-                    fn.set_arg_attr(idx, "tt.divisibility", self.attributes[i][1])
+                for name, value in self.attributes.get(i, []):
+                    fn.set_arg_attr(idx, name, value)
                 arg_values.append(triton.language.tensor(fn.args(idx), self.prototype.param_types[idx]))
                 idx += 1
 
@@ -298,7 +317,7 @@ class CodeGenerator(ast.NodeVisitor):
             # by default, constexpr are assigned into python variable
             if isinstance(value, triton.language.constexpr):
                 value = value.value
-            if not isinstance(value, triton.language.tensor):
+            if not isinstance(value, (triton.language.tensor, triton.language.block_ptr)):
                 value = triton.language.core._to_tensor(value, self.builder)
             self.set_value(name, value)
 
@@ -443,6 +462,16 @@ class CodeGenerator(ast.NodeVisitor):
     def visit_Pass(self, node):
         pass
 
+    def visit_With(self, node):
+        assert len(node.items) == 1, "only one context manager per with statement is supported"
+        context = self.visit(node.items[0].context_expr)
+        if not isinstance(context, triton.language.profile_range):
+            raise NotImplementedError(f"Unsupported context manager: {type(context).__name__}")
+        context._enter(_builder=self.builder)
+        # regions left by a return end with the kernel
+        if not self.visit_compound_statement(node.body):
+            context._exit(_builder=self.builder)
+
     def visit_Compare(self, node):
         assert len(node.comparators) == 1
         assert len(node.ops) == 1
@@ -561,19 +590,57 @@ class CodeGenerator(ast.NodeVisitor):
     def visit_ExtSlice(self, node):
         return [self.visit(dim) for dim in node.dims]
 
+    def _grid_stride_bounds(self, start, end, step, axis):
+        '''
+        Returns the bounds of the loop over the blocks of `tl.grid_stride(start,
+        end, step)` visited by the current program, and the function mapping
+        the index of a block to its start. The loop is over the indices of the
+        blocks rather than their starts, so that the starts are known to be
+        multiples of `step` when it is constant.
+        '''
+        axis = triton.language.core._constexpr_to_value(axis)
+        if isinstance(step, triton.language.constexpr) and step.value <= 0:
+            raise ValueError('`tl.grid_stride` requires a positive step')
+        if isinstance(start, triton.language.constexpr) and \
+           isinstance(end, triton.language.constexpr) and \
+           isinstance(step, triton.language.constexpr):
+            num_blocks = triton.language.constexpr(triton.cdiv(end.value - start.value, step.value))
+        else:
+            size = triton.language.semantic.sub(triton.language.core._to_tensor(end, self.builder),
+                                                triton.language.core._to_tensor(start, self.builder), self.builder)
+            size = triton.language.semantic.add(size, triton.language.core._to_tensor(step, self.builder), self.builder)
+            size = triton.language.semantic.sub(size, triton.language.core._to_tensor(1, self.builder), self.builder)
+            num_blocks = triton.language.semantic.floordiv(size, triton.language.core._to_tensor(step, self.builder),
+                                                           self.builder)
+        pid = triton.language.semantic.program_id(axis, self.builder)
+        num_programs = triton.language.semantic.num_programs(axis, self.builder)
+
+        def block_start(index):
+            index = triton.language.core.tensor(index, triton.language.core.int32)
+            offset = triton.language.semantic.mul(index, triton.language.core._to_tensor(step, self.builder),
+                                                  self.builder)
+            return triton.language.semantic.add(offset, triton.language.core._to_tensor(start, self.builder),
+                                                self.builder).handle
+        return pid, num_blocks, num_programs, block_start
+
     def visit_For(self, node):
         iterator = self.visit(node.iter.func)
-        if iterator != self.builtins['range']:
-            raise RuntimeError('Only `range` iterator currently supported')
+        grid_stride = iterator is triton.language.grid_stride
+        if iterator != self.builtins['range'] and not grid_stride:
+            raise RuntimeError('Only `range` and `tl.grid_stride` iterators currently supported')
         # visit iterator arguments
-        # note: only `range` iterator is supported now
         iter_args = [self.visit(arg) for arg in node.iter.args]
+        iter_kwargs = {kw.arg: self.visit(kw.value) for kw in node.iter.keywords}
         # collect lower bound (lb), upper bound (ub), and step
         lb = iter_args[0] if len(iter_args) > 1 else self.visit(ast.Num(0))
         ub = iter_args[1] if len(iter_args) > 1 else self.visit(node.iter.args[0])
-        step = iter_args[2] if len(iter_args) > 2 else self.visit(ast.Num(1))
+        step = iter_args[2] if len(iter_args) > 2 else iter_kwargs.get('step', self.visit(ast.Num(1)))
+        block_start = None
+        if grid_stride:
+            lb, ub, step, block_start = self._grid_stride_bounds(lb, ub, step, iter_kwargs.get('axis', 0))
         # static for loops: all iterator arguments are constexpr
-        if isinstance(lb, triton.language.constexpr) and \
+        if not grid_stride and \
+           isinstance(lb, triton.language.constexpr) and \
            isinstance(ub, triton.language.constexpr) and \
            isinstance(step, triton.language.constexpr):
             sta_range = iterator(lb.value, ub.value, step.value)
@@ -618,14 +685,29 @@ class CodeGenerator(ast.NodeVisitor):
             init_args = []
             yields = []
             names = []
+            # block pointers carry the scalars that the loop changes
+            block_ptrs = dict()
+            init_args_index = dict()
             for name in self.local_defs:
-                if name in liveins:
+                if name in liveins and isinstance(liveins[name], triton.language.block_ptr):
+                    live, local = liveins[name], self.local_defs[name]
+                    assert isinstance(local, triton.language.block_ptr), f'{name} is not a block pointer'
+                    assert local.block_shape == live.block_shape and local.order == live.order, \
+                        f'{name} changes its block shape or order in the loop'
+                    carried = [i for i, (x, y) in enumerate(zip(live._flatten(), local._flatten())) if x is not y]
+                    block_ptrs[name] = (local, len(init_args), carried)
+                    for i in carried:
+                        init_args.append(live._flatten()[i])
+                        yields.append(local._flatten()[i])
+            for name in self.local_defs:
+                if name in liveins and name not in block_ptrs:
                     assert self.is_triton_tensor(self.local_defs[name]), f'{name} is not tensor'
                     assert self.is_triton_tensor(liveins[name])
                     if self.local_defs[name].type != liveins[name].type:
                         local_value = self.local_defs[name]
                         self.local_defs[name] = local_value.to(liveins[name].dtype, _builder=self.builder)
                     names.append(name)
+                    init_args_index[name] = len(init_args)
                     init_args.append(triton.language.core._to_tensor(liveins[name], self.builder))
                     yields.append(triton.language.core._to_tensor(self.local_defs[name], self.builder))
 
@@ -640,6 +722,8 @@ class CodeGenerator(ast.NodeVisitor):
             if negative_step:
                 ub_si = self.builder.create_index_to_si(ub)
                 iv = self.builder.create_sub(ub_si, iv)
+            if block_start is not None:
+                iv = block_start(iv)
             self.lscope[node.target.id].handle.replace_all_uses_with(iv)
             self.set_value(node.target.id, triton.language.core.tensor(iv, triton.language.core.int32))
 
@@ -650,13 +734,19 @@ class CodeGenerator(ast.NodeVisitor):
             for_op_region = for_op.get_body(0).get_parent()
             assert for_op_region.size() == 1, "We use SCF, so the loop body should only have one block"
             # replace global uses with block arguments
-            for i, name in enumerate(names):
+            for i, arg in enumerate(init_args):
                 # arg0 is the induction variable
-                for_op.get_body(0).replace_use_in_block_with(init_args[i].handle, for_op.get_body(0).arg(i + 1))
+                for_op.get_body(0).replace_use_in_block_with(arg.handle, for_op.get_body(0).arg(i + 1))
 
         # update lscope & local_defs (ForOp defines new values)
-        for i, name in enumerate(names):
-            self.set_value(name, triton.language.core.tensor(for_op.get_result(i), yields[i].type))
+        results = [triton.language.core.tensor(for_op.get_result(i), y.type) for i, y in enumerate(yields)]
+        for name, (local, start, carried) in block_ptrs.items():
+            values = local._flatten()
+            for j, i in enumerate(carried):
+                values[i] = results[start + j]
+            self.set_value(name, local._unflatten(values))
+        for name in names:
+            self.set_value(name, results[init_args_index[name]])
 
         for stmt in node.orelse:
             assert False, "Don't know what to do with else after for"
@@ -674,6 +764,44 @@ class CodeGenerator(ast.NodeVisitor):
     def visit_keyword(self, node):
         return {node.arg: self.visit(node.value)}
 
+    def call_JitFunction(self, fn, args, kwargs):
+        from inspect import getcallargs
+        args = getcallargs(fn.fn, *args, **kwargs)
+        args = [args[name] for name in fn.arg_names]
+        args = [arg if isinstance(arg, triton.language.tensor)
+                else triton.language.constexpr(arg) for arg in args]
+        # generate function def
+        attributes = dict()
+        constexprs = [i for i, arg in enumerate(args) if isinstance(arg, triton.language.constexpr)]
+        constants = {i: args[i] for i in constexprs}
+        # generate call
+        args = [None if i in constexprs else arg for i, arg in enumerate(args)]
+        arg_vals = [arg.handle for arg in args if arg is not None]
+        arg_types = [arg.type for arg in args if arg is not None]
+        fn_name = mangle_fn(fn.__name__, arg_types, constants)
+        # generate function def if necessary
+        if not self.module.has_function(fn_name):
+            prototype = triton.language.function_type([], arg_types)
+            gscope = sys.modules[fn.fn.__module__].__dict__
+            generator = CodeGenerator(self.builder.context, prototype, gscope, attributes, constants, module=self.module, function_name=fn_name, function_types=self.function_ret_types)
+            generator.visit(fn.parse())
+            callee_ret_type = generator.last_ret_type
+            self.function_ret_types[fn_name] = callee_ret_type
+        else:
+            callee_ret_type = self.function_ret_types[fn_name]
+        symbol = self.module.get_function(fn_name)
+        call_op = self.builder.call(symbol, arg_vals)
+        if call_op.get_num_results() == 0 or callee_ret_type is None:
+            return None
+        elif call_op.get_num_results() == 1:
+            return triton.language.tensor(call_op.get_result(0), callee_ret_type)
+        else:
+            # should return a tuple of tl.tensor
+            results = []
+            for i in range(call_op.get_num_results()):
+                results.append(triton.language.tensor(call_op.get_result(i), callee_ret_type[i]))
+            return tuple(results)
+
     def visit_Call(self, node):
         fn = self.visit(node.func)
         if isinstance(fn, triton.language.constexpr):
@@ -683,44 +811,13 @@ class CodeGenerator(ast.NodeVisitor):
             kws.update(self.visit(keyword))
         args = [self.visit(arg) for arg in node.args]
         if isinstance(fn, triton.runtime.JITFunction):
-            from inspect import getcallargs
-            args = getcallargs(fn.fn, *args, **kws)
-            args = [args[name] for name in fn.arg_names]
-            args = [arg if isinstance(arg, triton.language.tensor)
-                    else triton.language.constexpr(arg) for arg in args]
-            # generate function def
-            attributes = dict()
-            constexprs = [i for i, arg in enumerate(args) if isinstance(arg, triton.language.constexpr)]
-            constants = {i: args[i] for i in constexprs}
-            # generate call
-            args = [None if i in constexprs else arg for i, arg in enumerate(args)]
-            arg_vals = [arg.handle for arg in args if arg is not None]
-            arg_types = [arg.type for arg in args if arg is not None]
-            fn_name = mangle_fn(fn.__name__, arg_types, constants)
-            # generate function def if necessary
-            if not self.module.has_function(fn_name):
-                prototype = triton.language.function_type([], arg_types)
-                gscope = sys.modules[fn.fn.__module__].__dict__
-                generator = CodeGenerator(self.builder.context, prototype, gscope, attributes, constants, module=self.module, function_name=fn_name, function_types=self.function_ret_types)
-                generator.visit(fn.parse())
-                callee_ret_type = generator.last_ret_type
-                self.function_ret_types[fn_name] = callee_ret_type
-            else:
-                callee_ret_type = self.function_ret_types[fn_name]
-            symbol = self.module.get_function(fn_name)
-            call_op = self.builder.call(symbol, arg_vals)
-            if call_op.get_num_results() == 0 or callee_ret_type is None:
-                return None
-            elif call_op.get_num_results() == 1:
-                return triton.language.tensor(call_op.get_result(0), callee_ret_type)
-            else:
-                # should return a tuple of tl.tensor
-                results = []
-                for i in range(call_op.get_num_results()):
-                    results.append(triton.language.tensor(call_op.get_result(i), callee_ret_type[i]))
-                return tuple(results)
+            return self.call_JitFunction(fn, args, kws)
         if (hasattr(fn, '__self__') and self.is_triton_tensor(fn.__self__)) \
                 or impl.is_builtin(fn):
+            # builtins taking user functions (e.g., `associative_scan`) emit
+            # their calls through the generator
+            if '_generator' in inspect.signature(fn).parameters:
+                kws['_generator'] = self
             return fn(*args, _builder=self.builder, **kws)
         if fn in self.builtins.values():
             args = [arg.value if isinstance(arg, triton.language.constexpr) else arg
@@ -818,7 +915,7 @@ class OutOfResources(Exception):
 
 def kernel_suffix(signature, specialization):
     # suffix format:
-    # <argid><'c' if equal to 1><'d' if divisible by 16>
+    # <argid><'c' if equal to 1><'d' if divisible by 16><'s' if below 2GB>
     suffix = ''
     for i, _ in enumerate(signature):
         suffix += str(i)
@@ -826,18 +923,21 @@ def kernel_suffix(signature, specialization):
             suffix += 'c'
         if i in specialization.divisible_by_16:
             suffix += 'd'
+        if i in pointer_range_32(specialization):
+            suffix += 's'
     return suffix
 
 # ------------------------------------------------------------------------------
 # ------------------------------------------------------------------------------
 
 
-def build_triton_ir(fn, signature, specialization, constants):
+def build_triton_ir(fn, signature, specialization, constants, context=None):
     # canonicalize signature
     if isinstance(signature, str):
         signature = {k: v.strip() for k, v in enumerate(signature.split(","))}
-    context = _triton.ir.context()
-    context.load_triton()
+    if context is None:
+        context = _triton.ir.context()
+        context.load_triton()
     # create kernel prototype
     cst_key = lambda i: fn.arg_names.index(i) if isinstance(i, str) else i
     constants = {cst_key(key): value for key, value in constants.items()}
@@ -846,7 +946,10 @@ def build_triton_ir(fn, signature, specialization, constants):
     function_name = '_'.join([fn.__name__, kernel_suffix(signature.values(), specialization)])
     tys = list(signature.values())
     new_constants = {k: True if k in tys and tys[k] == "i1" else 1 for k in specialization.equal_to_1}
-    new_attrs = {k: ("multiple_of", 16) for k in specialization.divisible_by_16}
+    new_attrs = {k: [("tt.divisibility", 16)] for k in specialization.divisible_by_16}
+    # the offsets of the pointers into tensors below 2GB are carried in 32 bits
+    for k in pointer_range_32(specialization):
+        new_attrs.setdefault(k, []).append(("tt.pointer_range", 32))
     all_constants = constants.copy()
     all_constants.update(new_constants)
     arg_types = [str_to_ty(v) for k, v in signature.items() if k not in constants]
@@ -866,11 +969,14 @@ def build_triton_ir(fn, signature, specialization, constants):
     return ret, generator
 
 
-def optimize_triton_ir(mod):
+def optimize_triton_ir(mod, timings=None):
     pm = _triton.ir.pass_manager(mod.context)
     pm.enable_debug()
+    if timings is not None:
+        pm.enable_timing(timings)
     pm.add_inliner_pass()
     pm.add_triton_combine_pass()
+    pm.add_triton_rewrite_pointer_offsets_pass()
     pm.add_canonicalizer_pass()
     pm.add_cse_pass()
     pm.add_licm_pass()
@@ -878,37 +984,56 @@ def optimize_triton_ir(mod):
     return mod
 
 
-def ast_to_ttir(fn, signature, specialization, constants):
-    mod, _ = build_triton_ir(fn, signature, specialization, constants)
-    return optimize_triton_ir(mod)
+def ast_to_ttir(fn, signature, specialization, constants, timings=None, context=None):
+    mod, _ = build_triton_ir(fn, signature, specialization, constants, context)
+    return optimize_triton_ir(mod, timings)
 
 
-def ttir_to_ttgir(mod, num_warps, num_stages, compute_capability):
+def ttir_to_ttgir(mod, num_warps, num_stages, compute_capability, prefetch_width=0, timings=None,
+                  num_ctas=1, pid_remap=None, profile=None, profile_capacity=256):
     pm = _triton.ir.pass_manager(mod.context)
-    pm.add_convert_triton_to_tritongpu_pass(num_warps)
+    if timings is not None:
+        pm.enable_timing(timings)
+    pm.add_convert_triton_to_tritongpu_pass(num_warps, num_ctas, pid_remap or "")
     pm.enable_debug()
     pm.add_coalesce_pass()
     # The combine pass converts blocked layout to mma layout
     # for dot ops so that pipeline can get shared memory swizzled correctly.
     pm.add_tritongpu_combine_pass(compute_capability)
-    pm.add_tritongpu_pipeline_pass(num_stages)
+    # Peeling removes the masks of the steady-state loop before they are
+    # carried into the async copies of the pipeline
+    pm.add_tritongpu_peel_loops_pass()
+    # Dot operands that don't change across iterations are loaded once before
+    # the loop rather than given stage buffers
+    pm.add_tritongpu_hoist_invariant_loads_pass()
+    pm.add_tritongpu_pipeline_pass(num_stages, compute_capability)
     # Prefetch must be done after pipeline pass because pipeline pass
     # extracts slices from the original tensor.
-    pm.add_tritongpu_prefetch_pass()
-    pm.add_canonicalizer_pass()
-    pm.add_cse_pass()
-    pm.add_tritongpu_combine_pass(compute_capability)
-    pm.add_licm_pass()
-    pm.add_tritongpu_combine_pass(compute_capability)
-    pm.add_cse_pass()
+    pm.add_tritongpu_prefetch_pass(prefetch_width)
+    # The pipelined loops still carry the pointers of the loads they replaced
+    # by async copies, and 64-bit pointer tensors
+    pm.add_tritongpu_canonicalize_loops_pass()
+    # The combine pass interleaves canonicalization, CSE and LICM with its
+    # rewrites until they reach a fixed point.
+    pm.add_tritongpu_combine_pass(compute_capability, cleanup=True)
+    # Choose the layouts of elementwise epilogues before the cleanup patterns
+    # of the combine pass fold the conversions left around them.
+    pm.add_tritongpu_layout_propagation_pass()
+    pm.add_tritongpu_combine_pass(compute_capability, cleanup=True)
     pm.add_tritongpu_decompose_conversions_pass()
-    if compute_capability // 10 == 7:
-        # The update_mma_for_volta pass helps to compute some information for MMA encoding specifically for MMAv1
-        # NOTE this pass should be placed after all the passes those modifies mma layout
-        pm.add_tritongpu_update_mma_for_volta_pass()
+    # Dots too large for the register file are split along K, once all their
+    # operands are loaded from shared memory
+    pm.add_tritongpu_split_dots_pass(192)
     pm.add_cse_pass()
     pm.add_symbol_dce_pass()
     pm.add_tritongpu_reorder_instructions_pass()
+    # Cap the estimated number of live registers per thread below the 255
+    # registers ptxas can allocate, leaving room for addresses and indices.
+    pm.add_tritongpu_schedule_instructions_pass(192)
+    # The regions are timed once the pipeline has created the waits of the
+    # async copies, and the instructions are scheduled
+    if profile:
+        pm.add_tritongpu_instrument_pass(profile == "auto", profile_capacity)
     pm.run(mod)
     return mod
 
@@ -920,13 +1045,16 @@ def add_external_libs(mod, libs):
     _triton.add_external_libs(mod, list(libs.keys()), list(libs.values()))
 
 
-def ttgir_to_llir(mod, extern_libs, compute_capability):
+def ttgir_to_llir(mod, extern_libs, compute_capability, timings=None, fast_math=False, native_load_store=False,
+                  opt_level=3, disabled_passes=(), max_registers=0, min_blocks_per_sm=0):
     if extern_libs:
         add_external_libs(mod, extern_libs)
-    return _triton.translate_triton_gpu_to_llvmir(mod, compute_capability)
+    return _triton.translate_triton_gpu_to_llvmir(mod, compute_capability, timings, fast_math, native_load_store,
+                                                  opt_level, list(disabled_passes), max_registers, min_blocks_per_sm)
 
 
-def llir_to_ptx(mod: Any, compute_capability: int, ptx_version: int = None) -> Tuple[str, int]:
+def llir_to_ptx(mod: Any, compute_capability: int, ptx_version: int = None, fast_math: bool = False,
+                opt_level: int = 3, fp_contraction: str = "fast") -> Tuple[str, int]:
     '''
     Translate TritonGPU module to PTX code.
     :param mod: a TritonGPU dialect module
@@ -937,16 +1065,37 @@ def llir_to_ptx(mod: Any, compute_capability: int, ptx_version: int = None) -> T
     if ptx_version is None:
         _, cuda_version = path_to_ptxas()
         ptx_version = ptx_get_version(cuda_version)
-    return _triton.translate_llvmir_to_ptx(mod, compute_capability, ptx_version)
+    return _triton.translate_llvmir_to_ptx(mod, compute_capability, ptx_version, fast_math, opt_level, fp_contraction)
 
 
-def ptx_to_cubin(ptx: str, compute_capability: int):
+def llir_batch_to_ptx(mods: List[str], compute_capability: int, ptx_version: int = None,
+                      fast_math: bool = False, opt_level: int = 3, fp_contraction: str = "fast") -> str:
+    '''
+    Translate the LLVM IR of several kernels to a single PTX module, with an
+    entry point per kernel.
+    '''
+    if ptx_version is None:
+        _, cuda_version = path_to_ptxas()
+        ptx_version = ptx_get_version(cuda_version)
+    return _triton.translate_llvmir_batch_to_ptx(mods, compute_capability, ptx_version, fast_math, opt_level,
+                                                 fp_contraction)
+
+
+def ptx_to_cubin(ptx: str, compute_capability: int, device: int = None):
     '''
     Compile TritonGPU module to cubin.
     :param ptx: ptx code
     :param compute_capability: compute capability
+    :param device: if provided, compile in-process with the JIT linker of the CUDA driver
+                   and fall back on ptxas if the driver cannot compile the PTX
     :return: str
     '''
+    if device is not None and not os.getenv("TRITON_PTXAS_SUBPROCESS"):
+        try:
+            init_cuda_utils()
+            return cuda_utils.compile_ptx(ptx, compute_capability, device)
+        except Exception:
+            pass
     ptxas, _ = path_to_ptxas()
     return _triton.compile_ptx_to_cubin(ptx, ptxas, compute_capability)
 
@@ -964,6 +1113,15 @@ def ptx_get_kernel_name(ptx: str) -> str:
             return line.split()[-1]
 
 
+def llir_get_kernel_name(llir: str) -> str:
+    '''
+    Get the name of the kernel of LLVM IR code, which is that of its PTX entry point.
+    '''
+    match = re.search(r'@([\w.$]+), !"kernel", i32 1', llir)
+    assert match, "no kernel found in the LLVM IR"
+    return match.group(1)
+
+
 @functools.lru_cache
 def ptx_get_version(cuda_version) -> int:
     '''
@@ -1001,7 +1159,13 @@ def path_to_ptxas():
     raise RuntimeError("Cannot find ptxas")
 
 
-instance_descriptor = namedtuple("instance_descriptor", ["divisible_by_16", "equal_to_1"], defaults=[set(), set()])
+instance_descriptor = namedtuple("instance_descriptor", ["divisible_by_16", "equal_to_1", "pointer_range_32"],
+                                 defaults=[set(), set(), set()])
+
+
+def pointer_range_32(specialization):
+    # descriptors built by hand may predate the size class of the tensors
+    return getattr(specialization, "pointer_range_32", ())
 
 
 # ------------------------------------------------------------------------------
@@ -1042,8 +1206,122 @@ def binary_name_to_header_name(name):
     return f"{name}.h"
 
 
-def generate_launcher(constants, signature):
+def generate_tma_support(tma_descriptors):
+    if not tma_descriptors:
+        return ""
+    return """
+#if CUDA_VERSION < 12000
+#error "bulk tensor copies require CUDA 12"
+#endif
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct _TMADescriptorEntry {
+  CUcontext context;
+  int slot;
+  CUdeviceptr base;
+  uint64_t row_stride;
+  CUdeviceptr desc;
+} TMADescriptorEntry;
+
+// Tensor maps are built once per context, kernel argument, base pointer and row
+// stride, and are never freed: captured graphs may still refer to them.
+static TMADescriptorEntry *tma_cache = NULL;
+static size_t tma_cache_size = 0;
+static size_t tma_cache_capacity = 0;
+
+static size_t tmaHash(CUcontext context, int slot, CUdeviceptr base, uint64_t row_stride) {
+  uint64_t h = (uint64_t)(uintptr_t)context;
+  h = h * 0x9E3779B97F4A7C15ull ^ (uint64_t)slot;
+  h = h * 0x9E3779B97F4A7C15ull ^ (uint64_t)base;
+  h = h * 0x9E3779B97F4A7C15ull ^ row_stride;
+  return (size_t)(h ^ (h >> 32));
+}
+
+static TMADescriptorEntry *tmaLookup(CUcontext context, int slot, CUdeviceptr base, uint64_t row_stride) {
+  size_t mask = tma_cache_capacity - 1;
+  for (size_t i = tmaHash(context, slot, base, row_stride) & mask;; i = (i + 1) & mask) {
+    TMADescriptorEntry *entry = &tma_cache[i];
+    if (!entry->desc || (entry->context == context && entry->slot == slot &&
+                         entry->base == base && entry->row_stride == row_stride))
+      return entry;
+  }
+}
+
+static bool tmaReserve() {
+  if (2 * (tma_cache_size + 1) <= tma_cache_capacity)
+    return true;
+  TMADescriptorEntry *old_cache = tma_cache;
+  size_t old_capacity = tma_cache_capacity;
+  tma_cache_capacity = old_capacity ? 2 * old_capacity : 64;
+  tma_cache = (TMADescriptorEntry *)calloc(tma_cache_capacity, sizeof(TMADescriptorEntry));
+  if (!tma_cache) {
+    PyErr_NoMemory();
+    tma_cache = old_cache;
+    tma_cache_capacity = old_capacity;
+    return false;
+  }
+  for (size_t i = 0; i < old_capacity; i++)
+    if (old_cache[i].desc)
+      *tmaLookup(old_cache[i].context, old_cache[i].slot, old_cache[i].base, old_cache[i].row_stride) = old_cache[i];
+  free(old_cache);
+  return true;
+}
+
+// Returns the device address of the tensor map of the row-major matrix at
+// `base`, copied by tiles of box_rows x box_cols elements, or 0 on error.
+static CUdeviceptr getTMADescriptor(int slot, CUdeviceptr base, uint64_t row_stride,
+                                    CUtensorMapDataType dtype, uint32_t elem_size,
+                                    uint32_t box_cols, uint32_t box_rows,
+                                    CUtensorMapSwizzle swizzle) {
+  CUcontext context;
+  CUDA_CHECK(cuCtxGetCurrent(&context));
+  if (PyErr_Occurred() || !tmaReserve())
+    return 0;
+  TMADescriptorEntry *entry = tmaLookup(context, slot, base, row_stride);
+  if (entry->desc)
+    return entry->desc;
+  // Tiles are addressed by their column and row; pointer tensors give no
+  // bound on the number of rows
+  cuuint64_t dims[2] = {row_stride, INT32_MAX};
+  cuuint64_t strides[1] = {row_stride * elem_size};
+  cuuint32_t box[2] = {box_cols, box_rows};
+  cuuint32_t element_strides[2] = {1, 1};
+  CUtensorMap map;
+  CUDA_CHECK(cuTensorMapEncodeTiled(&map, dtype, 2, (void *)base, dims, strides, box,
+                                    element_strides, CU_TENSOR_MAP_INTERLEAVE_NONE, swizzle,
+                                    CU_TENSOR_MAP_L2_PROMOTION_L2_128B,
+                                    CU_TENSOR_MAP_FLOAT_OOB_FILL_NONE));
+  if (PyErr_Occurred())
+    return 0;
+  CUdeviceptr desc;
+  CUDA_CHECK(cuMemAlloc(&desc, sizeof(map)));
+  if (PyErr_Occurred())
+    return 0;
+  CUDA_CHECK(cuMemcpyHtoD(desc, &map, sizeof(map)));
+  if (PyErr_Occurred())
+    return 0;
+  entry->context = context;
+  entry->slot = slot;
+  entry->base = base;
+  entry->row_stride = row_stride;
+  entry->desc = desc;
+  tma_cache_size++;
+  return desc;
+}
+"""
+
+
+def generate_launcher(constants, signature, tma_descriptors=(), num_ctas=1, profile=False):
     arg_decls = ', '.join(f"{ty_to_cpp(ty)} arg{i}" for i, ty in signature.items())
+    # the tensor maps of bulk copies are passed after the arguments of the kernel
+    arg_decls += ''.join(f", CUdeviceptr tma_desc{j}" for j in range(len(tma_descriptors)))
+    params = [f"&arg{i}" for i in signature.keys() if i not in constants]
+    params += [f"&tma_desc{j}" for j in range(len(tma_descriptors))]
+    # followed by the buffer of the records of the profiled kernels
+    if profile:
+        arg_decls += ", CUdeviceptr profile_buffer"
+        params += ["&profile_buffer"]
 
     def _extracted_type(ty):
         if ty[0] == '*':
@@ -1075,6 +1353,59 @@ def generate_launcher(constants, signature):
 
     format = "iiiiiKKOOO" + ''.join([format_of(_extracted_type(ty)) for ty in signature.values()])
 
+    # descriptors refer to arguments of the kernel, i.e. non-constant arguments
+    kernel_args = [i for i in signature.keys() if i not in constants]
+
+    def tma_descriptor(j, desc):
+        base = kernel_args[desc["base"]]
+        row_stride = kernel_args[desc["row_stride"]]
+        dtype = {1: "UINT8", 2: "UINT16", 4: "UINT32", 8: "UINT64"}[desc["elem_size"]]
+        swizzle = {0: "NONE", 32: "32B", 64: "64B", 128: "128B"}[desc["swizzle"]]
+        cols, rows = desc["box"]
+        return f"CUdeviceptr tma_desc{j} = getTMADescriptor({j}, ptr_info{base}.dev_ptr, (uint64_t)_arg{row_stride}, " \
+               f"CU_TENSOR_MAP_DATA_TYPE_{dtype}, {desc['elem_size']}, {cols}, {rows}, CU_TENSOR_MAP_SWIZZLE_{swizzle}); " \
+               f"if (!tma_desc{j}) return NULL;"
+    tma_args = ''.join(f", tma_desc{j}" for j in range(len(tma_descriptors)))
+    # the compiled kernel allocates the buffer for the grid of the launch
+    profile_buffer = ""
+    if profile:
+        tma_args += ", profile_buffer"
+        profile_buffer = """
+  PyObject *profile_ret = PyObject_CallMethod(compiled_kernel, "_profile_buffer", "iii", gridX, gridY, gridZ);
+  if (!profile_ret) return NULL;
+  CUdeviceptr profile_buffer = PyLong_AsUnsignedLongLong(profile_ret);
+  Py_DECREF(profile_ret);
+  if (PyErr_Occurred()) return NULL;"""
+
+    # the blocks of the kernel are grouped in clusters of num_ctas consecutive
+    # blocks along the x axis of the grid, which must be a multiple of it
+    if num_ctas > 1:
+        launch = f"""
+#if CUDA_VERSION >= 12000
+    CUlaunchAttribute attr;
+    attr.id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+    attr.value.clusterDim.x = {num_ctas};
+    attr.value.clusterDim.y = 1;
+    attr.value.clusterDim.z = 1;
+    CUlaunchConfig config = {{0}};
+    config.gridDimX = gridX;
+    config.gridDimY = gridY;
+    config.gridDimZ = gridZ;
+    config.blockDimX = 32*num_warps;
+    config.blockDimY = 1;
+    config.blockDimZ = 1;
+    config.sharedMemBytes = shared_memory;
+    config.hStream = stream;
+    config.attrs = &attr;
+    config.numAttrs = 1;
+    CUDA_CHECK(cuLaunchKernelEx(&config, function, params, 0));
+#else
+    PyErr_SetString(PyExc_RuntimeError, "Triton Error: thread block clusters require CUDA 12");
+#endif"""
+    else:
+        launch = f"""
+    CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));"""
+
     # generate glue code
     src = f"""
 #include \"cuda.h\"
@@ -1096,11 +1427,10 @@ static inline void gpuAssert(CUresult code, const char *file, int line)
 }}
 
 #define CUDA_CHECK(ans) {{ gpuAssert((ans), __FILE__, __LINE__); }}
-
+{generate_tma_support(tma_descriptors)}
 void _launch(int gridX, int gridY, int gridZ, int num_warps, int shared_memory, CUstream stream, CUfunction function, {arg_decls}) {{
-  void *params[] = {{ {', '.join(f"&arg{i}" for i in signature.keys() if i not in constants)} }};
-  if(gridX*gridY*gridZ > 0){{
-    CUDA_CHECK(cuLaunchKernel(function, gridX, gridY, gridZ, 32*num_warps, 1, 1, shared_memory, stream, params, 0));
+  void *params[] = {{ {', '.join(params)} }};
+  if(gridX*gridY*gridZ > 0){{{launch}
   }}
 }}
 
@@ -1121,18 +1451,21 @@ static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
     // valid nullptr
     return ptr_info;
   }}
-  PyObject *ptr = PyObject_GetAttrString(obj, "data_ptr");
-  if(ptr){{
-    PyObject *empty_tuple = PyTuple_New(0);
-    PyObject *ret = PyObject_Call(ptr, empty_tuple, NULL);
-    Py_DECREF(empty_tuple);
-    Py_DECREF(ptr);
+  // interned once: attribute lookups by C string re-create the name on every launch
+  static PyObject *data_ptr_str = NULL;
+  if (data_ptr_str == NULL) {{
+    data_ptr_str = PyUnicode_InternFromString("data_ptr");
+  }}
+  PyObject *ret = PyObject_HasAttr(obj, data_ptr_str) ? PyObject_CallMethodObjArgs(obj, data_ptr_str, NULL) : NULL;
+  if(ret){{
     if (!PyLong_Check(ret)) {{
+      Py_DECREF(ret);
       PyErr_SetString(PyExc_TypeError, "data_ptr method of Pointer object must return 64-bit int");
       ptr_info.valid = false;
       return ptr_info;
     }}
     ptr_info.dev_ptr = PyLong_AsUnsignedLongLong(ret);
+    Py_DECREF(ret);
     unsigned attr;
     CUresult status =
         cuPointerGetAttribute(&attr, CU_POINTER_ATTRIBUTE_MEMORY_TYPE, ptr_info.dev_ptr);
@@ -1144,7 +1477,10 @@ static inline DevicePtrInfo getPointer(PyObject *obj, int idx) {{
     }}
     return ptr_info;
   }}
-  PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
+  if (!PyErr_Occurred()) {{
+    PyErr_SetString(PyExc_TypeError, "Pointer argument must be either uint64 or have data_ptr method");
+  }}
+  ptr_info.valid = false;
   return ptr_info;
 }}
 
@@ -1172,7 +1508,8 @@ static PyObject* launch(PyObject* self, PyObject* args) {{
 
   // raise exception asap
   {"; ".join([f"DevicePtrInfo ptr_info{i} = getPointer(_arg{i}, {i}); if (!ptr_info{i}.valid) return NULL;" if ty[0] == "*" else "" for i, ty in signature.items()])};
-  _launch(gridX, gridY, gridZ, num_warps, shared_memory, (CUstream)_stream, (CUfunction)_function, {', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items())});
+  {" ".join(tma_descriptor(j, desc) for j, desc in enumerate(tma_descriptors))}{profile_buffer}
+  _launch(gridX, gridY, gridZ, num_warps, shared_memory, (CUstream)_stream, (CUfunction)_function, {', '.join(f"ptr_info{i}.dev_ptr" if ty[0]=="*" else f"_arg{i}"for i, ty in signature.items())}{tma_args});
 
   if (launch_exit_hook != Py_None) {{
     PyObject *new_args = NULL;
@@ -1231,6 +1568,187 @@ def default_cuda_dir():
     return os.getenv("CUDA_HOME", default=default_dir)
 
 
+class RemoteCacheBackend:
+    '''
+    Interface of a cache tier shared between processes or machines.
+    Blobs are content-addressed by the cache key (a hash of everything that
+    determines the compiled kernel), so a key is only ever published once and
+    never updated. `put` must be atomic: concurrent readers see either no blob
+    or the complete blob.
+    '''
+
+    def get(self, key: str) -> bytes:
+        raise NotImplementedError
+
+    def put(self, key: str, data: bytes):
+        raise NotImplementedError
+
+
+class FileRemoteCacheBackend(RemoteCacheBackend):
+    '''
+    Blob store in a directory shared between machines (e.g., NFS mount).
+    '''
+
+    def __init__(self, root):
+        self.root = root
+        os.makedirs(self.root, exist_ok=True)
+
+    def get(self, key):
+        path = os.path.join(self.root, key)
+        if not os.path.exists(path):
+            return None
+        with open(path, "rb") as f:
+            return f.read()
+
+    def put(self, key, data):
+        path = os.path.join(self.root, key)
+        if os.path.exists(path):
+            return
+        # unique per writer, threads of a process included
+        fd, tmp_path = tempfile.mkstemp(dir=self.root, prefix=f"{key}.", suffix=".tmp")
+        try:
+            with os.fdopen(fd, "wb") as f:
+                f.write(data)
+            os.replace(tmp_path, path)
+        except BaseException:
+            os.unlink(tmp_path)
+            raise
+
+
+class RedisRemoteCacheBackend(RemoteCacheBackend):
+    '''
+    Blob store in a Redis server.
+    '''
+
+    def __init__(self, url):
+        import redis
+        self.client = redis.Redis.from_url(url)
+
+    def get(self, key):
+        return self.client.get(f"triton:{key}")
+
+    def put(self, key, data):
+        # SET NX is atomic and keeps the first published blob
+        self.client.set(f"triton:{key}", data, nx=True)
+
+
+def _make_remote_cache_backend():
+    url = os.environ.get("TRITON_REMOTE_CACHE", "")
+    if url.startswith("redis://") or url.startswith("rediss://"):
+        return RedisRemoteCacheBackend(url)
+    if url.startswith("file://"):
+        return FileRemoteCacheBackend(url[len("file://"):])
+    if url:
+        raise ValueError(f"Unsupported remote cache: {url}")
+    return None
+
+
+_remote_cache_backend = None
+_remote_cache_initialized = False
+
+
+def set_remote_cache_backend(backend: RemoteCacheBackend):
+    '''
+    Overrides the remote cache tier configured by `TRITON_REMOTE_CACHE`.
+    Passing None disables the remote tier.
+    '''
+    global _remote_cache_backend, _remote_cache_initialized
+    _remote_cache_backend = backend
+    _remote_cache_initialized = True
+
+
+def get_remote_cache_backend():
+    global _remote_cache_backend, _remote_cache_initialized
+    if not _remote_cache_initialized:
+        _remote_cache_backend = _make_remote_cache_backend()
+        _remote_cache_initialized = True
+    return _remote_cache_backend
+
+
+def _is_bundle_file_name(name):
+    # bundle entries are written to the cache directory of their key
+    return isinstance(name, str) and name not in ("", ".", "..") and \
+        os.path.basename(name) == name and "\\" not in name
+
+
+def _encode_bundle(bundle):
+    # blobs are JSON, which unlike pickle can't run code when loaded from a
+    # shared tier that other users may write to
+    files = {name: base64.b64encode(data).decode("ascii") for name, data in bundle.items()}
+    return json.dumps({"files": files}).encode("utf-8")
+
+
+def _decode_bundle(data):
+    # returns None for blobs that aren't well-formed bundles
+    try:
+        files = json.loads(data)["files"]
+        if not isinstance(files, dict):
+            return None
+        bundle = dict()
+        for name, payload in files.items():
+            if not _is_bundle_file_name(name) or not isinstance(payload, str):
+                return None
+            bundle[name] = base64.b64decode(payload, validate=True)
+        return bundle
+    except (ValueError, KeyError, TypeError):
+        return None
+
+
+@functools.lru_cache(maxsize=1024)
+def _fetch_remote_bundle(key):
+    # in-memory tier: a bundle is requested once per process, misses included
+    backend = get_remote_cache_backend()
+    if backend is None:
+        return None
+    try:
+        data = backend.get(key)
+    except Exception:
+        return None
+    return None if data is None else _decode_bundle(data)
+
+
+# keys of the kernels compiled (or loaded from cache) by this process
+_used_cache_keys = set()
+
+
+def dump_cache_manifest(path):
+    '''
+    Writes the cache keys of all kernels used by this process to `path`,
+    so that other processes can prefetch them with `prefetch_cache_manifest`.
+    '''
+    with open(path, "w") as f:
+        f.write("\n".join(sorted(_used_cache_keys)))
+
+
+def prefetch_cache_manifest(path):
+    '''
+    Downloads the kernels listed in a manifest from the remote cache tier.
+    '''
+    with open(path) as f:
+        keys = [key.strip() for key in f if key.strip()]
+    for key in keys:
+        CacheManager(key).prefetch()
+
+
+_env_manifest_prefetched = False
+_env_manifest_lock = threading.Lock()
+
+
+def _prefetch_env_cache_manifest():
+    # the manifest of `TRITON_CACHE_MANIFEST` is prefetched on the first
+    # compilation rather than on import, which must not do I/O
+    global _env_manifest_prefetched
+    if _env_manifest_prefetched:
+        return
+    with _env_manifest_lock:
+        if _env_manifest_prefetched:
+            return
+        _env_manifest_prefetched = True
+        path = os.environ.get("TRITON_CACHE_MANIFEST")
+        if path and os.path.exists(path):
+            prefetch_cache_manifest(path)
+
+
 class CacheManager:
 
     def __init__(self, key):
@@ -1249,7 +1767,65 @@ class CacheManager:
     def has_file(self, filename):
         if not self.cache_dir:
             return False
-        return os.path.exists(self._make_path(filename))
+        if os.path.exists(self._make_path(filename)):
+            return True
+        return self._fetch(filename)
+
+    def _fetch(self, filename):
+        # populates the local directory from the bundle published for this key
+        bundle = _fetch_remote_bundle(self.key)
+        if bundle is None or filename not in bundle:
+            return False
+        with FileLock(self.lock_path):
+            for name, data in bundle.items():
+                filepath = self._make_path(name)
+                if os.path.exists(filepath):
+                    continue
+                with open(filepath + ".tmp", "wb") as f:
+                    f.write(data)
+                os.rename(filepath + ".tmp", filepath)
+            # stages are validated against the ctime of their local file
+            for name in bundle:
+                if not name.endswith(".json"):
+                    continue
+                with open(self._make_path(name)) as f:
+                    metadata = json.load(f)
+                stem = name[:-len(".json")]
+                for ir in metadata.get("ctime", dict()):
+                    path = self._make_path(f"{stem}.{ir}")
+                    if os.path.exists(path):
+                        metadata["ctime"][ir] = os.path.getctime(path)
+                with open(self._make_path(name) + ".tmp", "w") as f:
+                    f.write(json.dumps(metadata))
+                os.rename(self._make_path(name) + ".tmp", self._make_path(name))
+        return True
+
+    def publish(self):
+        '''
+        Publishes all the files of this key to the remote tier as a single blob.
+        '''
+        backend = get_remote_cache_backend()
+        if backend is None or not self.cache_dir:
+            return
+        bundle = dict()
+        with FileLock(self.lock_path):
+            for name in os.listdir(self.cache_dir):
+                if name == "lock" or name.endswith(".tmp"):
+                    continue
+                with open(self._make_path(name), "rb") as f:
+                    bundle[name] = f.read()
+        try:
+            backend.put(self.key, _encode_bundle(bundle))
+        except Exception:
+            pass
+
+    def prefetch(self):
+        '''
+        Downloads the remote bundle of this key, if any, into the local directory.
+        '''
+        bundle = _fetch_remote_bundle(self.key)
+        if bundle:
+            self._fetch(next(iter(bundle)))
 
     def put(self, data, filename, binary=True):
         if not self.cache_dir:
@@ -1347,17 +1923,22 @@ def _build(name, src, srcdir):
     return so
 
 
-def make_so_cache_key(version_hash, signature, constants):
+def make_so_cache_key(version_hash, signature, constants, tma_descriptors=(), num_ctas=1, profile=False):
     # Get unique key for the compiled code
+    # the launcher only depends on which arguments are constants, not on their values
     signature = {k: 'ptr' if v[0] == '*' else v for k, v in signature.items()}
-    key = f"{version_hash}-{''.join(signature.values())}{constants}"
+    key = f"{version_hash}-{''.join(signature.values())}{sorted(constants)}{list(tma_descriptors)}"
+    if num_ctas != 1:
+        key += f"-cluster{num_ctas}"
+    if profile:
+        key += "-profile"
     key = hashlib.md5(key.encode("utf-8")).hexdigest()
     return key
 
 
 def make_fn_cache_key(fn_hash, signature, configs, constants, num_warps, num_stages):
     # Get unique key for the compiled code
-    get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1))
+    get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1), sorted(pointer_range_32(conf)))
     configs_key = [get_conf_key(conf) for conf in configs]
     key = f"{fn_hash}-{''.join(signature.values())}-{configs_key}-{constants}-{num_warps}-{num_stages}"
     key = hashlib.md5(key.encode("utf-8")).hexdigest()
@@ -1383,19 +1964,21 @@ def read_or_execute(cache_manager, force_compile, file_name, metadata,
 #
 
 
-def make_stub(name, signature, constants):
+def make_stub(name, signature, constants, tma_descriptors=(), num_ctas=1, profile=False):
     # name of files that are cached
-    so_cache_key = make_so_cache_key(triton.runtime.jit.version_key(), signature, constants)
+    so_cache_key = make_so_cache_key(triton.runtime.jit.version_key(), signature, constants, tma_descriptors,
+                                     num_ctas, profile)
     so_cache_manager = CacheManager(so_cache_key)
-    so_name = f"{name}.so"
+    # stubs are shared by all the kernels with the same signature
+    so_name = "launcher.so"
     # retrieve stub from cache if it exists
     if not so_cache_manager.has_file(so_name):
         with tempfile.TemporaryDirectory() as tmpdir:
-            src = generate_launcher(constants, signature)
+            src = generate_launcher(constants, signature, tma_descriptors, num_ctas, profile)
             src_path = os.path.join(tmpdir, "main.c")
             with open(src_path, "w") as f:
                 f.write(src)
-            so = _build(name, src_path, tmpdir)
+            so = _build("launcher", src_path, tmpdir)
             with open(so, "rb") as f:
                 so_cache_manager.put(f.read(), so_name, binary=True)
     return so_cache_manager._make_path(so_name)
@@ -1408,22 +1991,97 @@ def convert_type_repr(x):
     return x
 
 
+def make_source_key(fn, **kwargs):
+    '''
+    Key of the Triton IR of `fn`, which only depends on its source, signature,
+    specialization and constants.
+    '''
+    configs = kwargs["configs"]
+    signature = kwargs["signature"]
+    constants = kwargs.get("constants", dict())
+    get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1), sorted(pointer_range_32(conf)))
+    configs_key = [get_conf_key(conf) for conf in configs]
+    # @triton.jit functions passed as constexprs are inlined into the kernel
+    constants = {k: v.cache_key if isinstance(v, triton.runtime.JITFunction) else v
+                 for k, v in constants.items()}
+    return f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}"
+
+
 def make_hash(fn, **kwargs):
     if isinstance(fn, triton.runtime.JITFunction):
-        configs = kwargs["configs"]
-        signature = kwargs["signature"]
-        constants = kwargs.get("constants", dict())
         num_warps = kwargs.get("num_warps", 4)
         num_stages = kwargs.get("num_stages", 3)
+        prefetch_width = kwargs.get("prefetch_width", 0)
+        num_ctas = kwargs.get("num_ctas", 1)
+        pid_remap = canonicalize_pid_remap(kwargs.get("pid_remap", None))
+        fast_math = kwargs.get("fast_math", False)
+        native_load_store = kwargs.get("native_load_store", False)
+        opt_level = kwargs.get("opt_level", 3)
+        disabled_passes = sorted(kwargs.get("disabled_passes", None) or ())
+        max_registers = kwargs.get("max_registers", 0) or 0
+        min_blocks_per_sm = kwargs.get("min_blocks_per_sm", 0) or 0
+        fp_contraction = kwargs.get("fp_contraction", "fast")
+        profile = kwargs.get("profile", None) or None
+        profile_capacity = kwargs.get("profile_capacity", 256)
         # Get unique key for the compiled code
-        get_conf_key = lambda conf: (sorted(conf.divisible_by_16), sorted(conf.equal_to_1))
-        configs_key = [get_conf_key(conf) for conf in configs]
-        key = f"{fn.cache_key}-{''.join(signature.values())}-{configs_key}-{constants}-{num_warps}-{num_stages}"
+        cc = kwargs.get("cc", None)
+        key = f"{make_source_key(fn, **kwargs)}-{num_warps}-{num_stages}-{prefetch_width}-{cc}"
+        if num_ctas != 1:
+            key += f"-cluster{num_ctas}"
+        if pid_remap is not None:
+            key += f"-{pid_remap}"
+        if fast_math:
+            key += "-fastmath"
+        if native_load_store:
+            key += "-nativeldst"
+        if opt_level != 3:
+            key += f"-O{opt_level}"
+        if disabled_passes:
+            key += f"-disable{disabled_passes}"
+        if max_registers:
+            key += f"-maxnreg{max_registers}"
+        if min_blocks_per_sm:
+            key += f"-minctasm{min_blocks_per_sm}"
+        if fp_contraction != "fast":
+            key += f"-fpcontract-{fp_contraction}"
+        if profile:
+            key += f"-profile-{profile}-{profile_capacity}"
         return hashlib.md5(key.encode("utf-8")).hexdigest()
     assert isinstance(fn, str)
     return hashlib.md5((Path(fn).read_text() + triton.runtime.jit.version_key()).encode("utf-8")).hexdigest()
 
 
+def canonicalize_pid_remap(pid_remap):
+    '''
+    Order in which `tl.program_id(0)` and `tl.program_id(1)` enumerate the
+    programs of a 2D grid, launched x first:
+
+    - None keeps the order of the launch,
+    - "grouped-<n>" (or "grouped", for n = 8) sweeps groups of n consecutive
+      programs along axis 0 through the whole axis 1 before the next group,
+      for the L2 reuse of tiled matmuls,
+    - "morton" follows a Z-order curve on grids whose extents are powers of
+      two, and keeps the order of the launch on other grids.
+    '''
+    if pid_remap is None:
+        return None
+    if pid_remap == "grouped":
+        return "grouped-8"
+    match = re.fullmatch(r"grouped-([0-9]+)", pid_remap)
+    if (match and int(match.group(1)) > 0) or pid_remap == "morton":
+        return pid_remap
+    raise ValueError(f"unknown pid_remap {pid_remap!r}, expected None, 'grouped-<n>' or 'morton'")
+
+
+def make_stage_cache_key(ir, parent_key, params):
+    '''
+    Key of the output of stage `ir` of the pipeline, given the key of its input
+    and the parameters of the stage.
+    '''
+    key = f"{ir}-{parent_key}-{sorted(params.items())}-{triton.runtime.jit.version_key()}"
+    return hashlib.md5(key.encode("utf-8")).hexdigest()
+
+
 # - ^\s*func\s+ : match the start of the string, any leading whitespace, the keyword func,
 #    and any following whitespace
 # - (public\s+)? : optionally match the keyword public and any following whitespace
@@ -1448,35 +2106,177 @@ arg_type_pattern = {
 }
 
 
+def compile_profile(stage_times, pass_times, memory=None):
+    '''
+    Builds the compile profile of a kernel.
+    :param stage_times: wall-clock time, in seconds, of each compiled stage (e.g., "ttgir", "cubin")
+    :param pass_times: (name, seconds) of each MLIR pass and LLVM step, in the order they ran
+    :param memory: the peak and retained bytes allocated by the compilation, and the number of
+                   compilations its MLIR context was used by before, see `ContextPool`
+    :return: a dict with the times of the stages, of each run of the passes, and of
+             the passes aggregated by name
+    '''
+    totals = dict()
+    for pass_name, seconds in pass_times:
+        total = totals.setdefault(pass_name, {"time": 0., "count": 0})
+        total["time"] += seconds
+        total["count"] += 1
+    return {
+        "stages": dict(stage_times),
+        # ptxas, or the JIT linker of the driver
+        "ptxas": stage_times.get("cubin", 0.),
+        "passes": [{"name": pass_name, "time": seconds} for pass_name, seconds in pass_times],
+        "pass_totals": totals,
+        "memory": dict(memory or dict()),
+    }
+
+
+def format_compile_profile(profile):
+    '''
+    Formats a compile profile as a table, slowest passes first.
+    '''
+    lines = [f"{'stage':<40}{'time (ms)':>12}"]
+    for stage, seconds in profile["stages"].items():
+        lines.append(f"{stage:<40}{seconds * 1e3:>12.2f}")
+    lines.append(f"{'pass':<40}{'time (ms)':>12}{'runs':>6}")
+    totals = sorted(profile["pass_totals"].items(), key=lambda item: -item[1]["time"])
+    for pass_name, total in totals:
+        lines.append(f"{pass_name:<40}{total['time'] * 1e3:>12.2f}{total['count']:>6}")
+    memory = profile.get("memory", dict())
+    if memory:
+        lines.append(f"{'memory':<40}{'MiB':>12}")
+        for name in ["peak", "retained"]:
+            lines.append(f"{name:<40}{memory[name] / 2**20:>12.2f}")
+    return "\n".join(lines)
+
+
+class ContextPool:
+    '''
+    MLIR contexts reused by successive compilations, with the dialects of the
+    compiler loaded once. The types and attributes uniqued by a context are only
+    freed with it, so each context is retired after `max_uses` compilations
+    ($TRITON_CONTEXT_MAX_USES, 64 by default) to bound the memory of processes
+    that keep compiling new kernels. Concurrent compilations get different
+    contexts.
+    '''
+
+    def __init__(self, max_uses=None):
+        if max_uses is None:
+            max_uses = int(os.environ.get("TRITON_CONTEXT_MAX_USES", "64"))
+        self.max_uses = max_uses
+        self._lock = threading.Lock()
+        # (context, number of compilations it was used by)
+        self._free = []
+
+    def acquire(self):
+        '''
+        Returns a context and the number of compilations it was used by.
+        '''
+        with self._lock:
+            if self._free:
+                return self._free.pop()
+        context = _triton.ir.context()
+        context.load_compiler_dialects()
+        return context, 0
+
+    def release(self, context, uses):
+        '''
+        Returns `context` to the pool once the modules of the compilation are erased.
+        '''
+        if uses + 1 >= self.max_uses:
+            return
+        with self._lock:
+            self._free.append((context, uses + 1))
+
+    def clear(self):
+        with self._lock:
+            self._free = []
+
+
+_context_pool = ContextPool()
+
+
 # def compile(fn, signature: str, device: int = -1, constants=dict(), num_warps: int = 4, num_stages: int = 3, extern_libs=None, configs=None):
 def compile(fn, **kwargs):
+    _prefetch_env_cache_manifest()
     capability = kwargs.get("cc", None)
+    # cubins are only compiled in-process when they target the current device
+    device = None
     if capability is None:
-        device = torch.cuda.current_device()
+        device = kwargs.get("device", torch.cuda.current_device())
         capability = torch.cuda.get_device_capability(device)
         capability = capability[0] * 10 + capability[1]
     # we get the kernel, i.e. the first function generated in the module
     # if fn is not a JITFunction, then it
     # has to be a path to a file
-    context = _triton.ir.context()
+    context, context_uses = _context_pool.acquire()
+    malloc_start = _triton.get_malloc_usage()
     asm = dict()
     constants = kwargs.get("constants", dict())
     num_warps = kwargs.get("num_warps", 4)
     num_stages = kwargs.get("num_stages", 3 if capability >= 75 else 2)
+    # width of the K slices of the operands of dots loaded ahead, 0 to infer it
+    prefetch_width = kwargs.get("prefetch_width", 0)
+    # blocks per thread-block cluster (sm_90), consecutive along the x axis of
+    # the grid. Loads marked `multicast` are shared by the blocks of a cluster.
+    num_ctas = kwargs.get("num_ctas", 1)
+    assert num_ctas in [1, 2, 4, 8], "num_ctas must be a power of 2 no larger than 8"
+    assert num_ctas == 1 or capability >= 90, "thread-block clusters require sm_90 or newer"
+    # rasterization of the programs of 2D grids, see `canonicalize_pid_remap`
+    pid_remap = canonicalize_pid_remap(kwargs.get("pid_remap", None))
     extern_libs = kwargs.get("extern_libs", dict())
+    # approximate exp, log, sin, cos, rsqrt and tanh (sm_75+) in fp32 and fp16,
+    # see ElementwiseOpToLLVM.cpp for their accuracy, and let the backend ignore
+    # infinities and signed zeros
+    fast_math = kwargs.get("fast_math", False)
+    # lower global loads and stores without PTX-only cache hints to LLVM ones
+    # rather than inline PTX, which LLVM can reorder and vectorize
+    native_load_store = kwargs.get("native_load_store", False)
+    # level of the LLVM optimizations and of the code generator, from 0 to 3:
+    # lower levels compile faster (e.g., to autotune) into slower code
+    opt_level = kwargs.get("opt_level", 3)
+    assert opt_level in [0, 1, 2, 3], "opt_level must be 0, 1, 2 or 3"
+    # LLVM passes to skip, named as in `opt -passes` (e.g., "licm") or by
+    # class (e.g., "LICMPass")
+    disabled_passes = sorted(kwargs.get("disabled_passes", None) or ())
+    # registers per thread the kernel may use, which bounds its occupancy from
+    # below, 0 for the choice of ptxas
+    max_registers = kwargs.get("max_registers", 0) or 0
+    # CTAs the kernel must fit on one SM at once, from which ptxas derives a
+    # register limit of its own, 0 for no requirement. The occupancy reached
+    # is reported by `CompiledKernel.occupancy`
+    min_blocks_per_sm = kwargs.get("min_blocks_per_sm", 0) or 0
+    # fusion of multiplications and additions into FMAs: "fast" for any of
+    # them, "on" for those of the same expression, "off" for none
+    fp_contraction = kwargs.get("fp_contraction", "fast")
+    assert fp_contraction in ["fast", "on", "off"], "fp_contraction must be fast, on or off"
+    # regions of the kernel timed with the cycle counter: True for its
+    # `tl.profile_range`s, "auto" for its loops, dots and async waits too, with
+    # `profile_capacity` records per warp (see `triton.runtime.instrumentation`)
+    profile = kwargs.get("profile", None) or None
+    assert profile in [None, True, "auto"], "profile must be None, True or \"auto\""
+    profile_capacity = kwargs.get("profile_capacity", 256)
+    # times of the passes run by the stages, see `compile_profile`
+    timings = _triton.ir.compile_timings()
+    # `compile_batch` stops at the LLVM IR and translates the kernels together
+    last_stage = kwargs.get("_last_stage", "cubin")
     # build compilation stages
     stages = {
         "ast": (lambda path: fn, None),
         "ttir": (lambda path: _triton.ir.parse_mlir_module(path, context),
-                 lambda src: ast_to_ttir(src, signature, configs[0], constants)),
+                 lambda src: ast_to_ttir(src, signature, configs[0], constants, timings, context)),
         "ttgir": (lambda path: _triton.ir.parse_mlir_module(path, context),
-                  lambda src: ttir_to_ttgir(src, num_warps, num_stages, capability)),
+                  lambda src: ttir_to_ttgir(src, num_warps, num_stages, capability, prefetch_width, timings,
+                                            num_ctas, pid_remap, profile, profile_capacity)),
         "llir": (lambda path: Path(path).read_bytes(),
-                 lambda src: ttgir_to_llir(src, extern_libs, capability)),
+                 lambda src: ttgir_to_llir(src, extern_libs, capability, timings, fast_math,
+                                           native_load_store, opt_level, disabled_passes, max_registers,
+                                           min_blocks_per_sm)),
         "ptx": (lambda path: Path(path).read_text(),
-                lambda src: llir_to_ptx(src, capability)),
+                lambda src: llir_to_ptx(src, capability, fast_math=fast_math, opt_level=opt_level,
+                                        fp_contraction=fp_contraction)),
         "cubin": (lambda path: Path(path).read_bytes(),
-                  lambda src: ptx_to_cubin(src, capability))
+                  lambda src: ptx_to_cubin(src, capability, device))
     }
     # find out the signature of the function
     if isinstance(fn, triton.runtime.JITFunction):
@@ -1505,10 +2305,8 @@ def compile(fn, **kwargs):
         signature = {k: v for k, v in enumerate(param_tys)}
         first_stage = list(stages.keys()).index(ir)
 
-    # cache manager
-    so_path = make_stub(name, signature, constants)
     # create cache manager
-    fn_cache_manager = CacheManager(make_hash(fn, **kwargs))
+    fn_cache_manager = CacheManager(make_hash(fn, **dict(kwargs, cc=capability)))
     # determine name and extension type of provided function
     if isinstance(fn, triton.runtime.JITFunction):
         name, ext = fn.__name__, "ast"
@@ -1521,7 +2319,7 @@ def compile(fn, **kwargs):
         with open(fn_cache_manager._make_path(f"{name}.json")) as f:
             metadata = json.load(f)
     else:
-        metadata = {"num_warps": num_warps, "num_stages": num_stages, "ctime": dict()}
+        metadata = {"num_warps": num_warps, "num_stages": num_stages, "num_ctas": num_ctas, "ctime": dict()}
         if ext == "ptx":
             assert "shared" in kwargs, "ptx compilation must provide shared memory size"
             metadata["shared"] = kwargs["shared"]
@@ -1529,30 +2327,187 @@ def compile(fn, **kwargs):
     first_stage = list(stages.keys()).index(ext)
     asm = dict()
     module = fn
+    compiled = False
+    stage_times = dict()
+    # Stages are also cached on their own, keyed by the output of the stage
+    # before them and the parameters they depend on: configs differing only by
+    # num_warps or num_stages share their Triton IR, and configs lowered to the
+    # same TritonGPU IR share everything after it.
+    stage_params = {
+        "ttir": dict(),
+        "ttgir": dict(num_warps=num_warps, num_stages=num_stages, prefetch_width=prefetch_width,
+                      num_ctas=num_ctas, pid_remap=pid_remap, profile=profile, profile_capacity=profile_capacity,
+                      cc=capability),
+        "llir": dict(extern_libs=sorted(extern_libs.items()), cc=capability, fast_math=fast_math,
+                     native_load_store=native_load_store, opt_level=opt_level, disabled_passes=disabled_passes,
+                     max_registers=max_registers, min_blocks_per_sm=min_blocks_per_sm),
+        "ptx": dict(cc=capability, fast_math=fast_math, opt_level=opt_level, fp_contraction=fp_contraction),
+        "cubin": dict(cc=capability),
+    }
+    parent_key = None
+    # MLIR modules of the stages, by id, and the bytes allocated after each stage
+    mlir_modules = dict()
+    malloc_peak = malloc_start
     # run compilation pipeline  and populate metadata
-    for ir, (parse, compile) in list(stages.items())[first_stage:]:
+    last_stage = list(stages.keys()).index(last_stage)
+    for ir, (parse, compile) in list(stages.items())[first_stage:last_stage + 1]:
         path = fn_cache_manager._make_path(f"{name}.{ir}")
+        stage_cache = None
+        if parent_key is not None:
+            stage_cache = CacheManager(make_stage_cache_key(ir, parent_key, stage_params[ir]))
+        # metadata computed by the translation to LLVM IR
+        llir_metadata = None
         if ir == ext:
             next_module = parse(fn)
         elif os.path.exists(path) and\
                 ir in metadata["ctime"] and\
                 os.path.getctime(path) == metadata["ctime"][ir]:
             next_module = parse(path)
+        elif stage_cache is not None and stage_cache.has_file(f"{name}.{ir}") and\
+                (ir != "llir" or stage_cache.has_file(f"{name}.llir.json")):
+            next_module = parse(stage_cache._make_path(f"{name}.{ir}"))
+            if ir == "llir":
+                with open(stage_cache._make_path(f"{name}.llir.json")) as f:
+                    llir_metadata = json.load(f)
+            fn_cache_manager.put(next_module, f"{name}.{ir}")
+            compiled = True
         else:
+            start = time.perf_counter()
             next_module = compile(module)
+            stage_times[ir] = time.perf_counter() - start
             fn_cache_manager.put(next_module, f"{name}.{ir}")
+            if stage_cache is not None:
+                stage_cache.put(next_module, f"{name}.{ir}")
+            compiled = True
         if os.path.exists(path):
             metadata["ctime"][ir] = os.path.getctime(path)
         asm[ir] = next_module if ir == "cubin" else str(next_module)
         if ir == "llir" and "shared" not in metadata:
-            metadata["shared"] = _triton.get_shared_memory_size(module)
+            if llir_metadata is None:
+                llir_metadata = {"shared": _triton.get_shared_memory_size(module)}
+                report = _triton.get_shared_memory_report(module)
+                if report:
+                    llir_metadata["shared_report"] = json.loads(report)
+                descriptors = _triton.get_tma_descriptors(module)
+                if descriptors:
+                    llir_metadata["tma_descriptors"] = json.loads(descriptors)
+                regions = _triton.get_profile_regions(module)
+                if regions:
+                    llir_metadata["profile"] = {"regions": json.loads(regions), "capacity": profile_capacity}
+                if stage_cache is not None:
+                    stage_cache.put(json.dumps(llir_metadata), f"{name}.llir.json", binary=False)
+            metadata.update(llir_metadata)
         if ir == "ptx":
             metadata["name"] = ptx_get_kernel_name(next_module)
+        if ir == "ast":
+            parent_key = hashlib.md5(make_source_key(fn, **kwargs).encode("utf-8")).hexdigest()
+        else:
+            content = next_module if isinstance(next_module, bytes) else str(next_module).encode("utf-8")
+            parent_key = hashlib.md5(content).hexdigest()
+        if ir in ["ttir", "ttgir"]:
+            mlir_modules[id(next_module)] = next_module
+        malloc_peak = max(malloc_peak, _triton.get_malloc_usage())
         module = next_module
+    # operations are not freed with the Python handles of their modules, and
+    # the context is reused by the next compilation
+    for mlir_module in mlir_modules.values():
+        mlir_module.erase()
+    _context_pool.release(context, context_uses)
+    memory = {"peak": malloc_peak - malloc_start, "retained": _triton.get_malloc_usage() - malloc_start,
+              "context_uses": context_uses}
+    if compiled:
+        metadata["compile_profile"] = compile_profile(stage_times, timings.records(), memory)
+        if os.environ.get("TRITON_PRINT_COMPILE_PROFILE", "0") == "1":
+            print(f"compile profile of {name}:\n{format_compile_profile(metadata['compile_profile'])}",
+                  file=sys.stderr)
+    # the launcher builds the tensor maps of the bulk copies of the kernel
+    so_path = make_stub(name, signature, constants, metadata.get("tma_descriptors", []),
+                        metadata.get("num_ctas", 1), "profile" in metadata)
     # write-back metadata
     fn_cache_manager.put(json.dumps(metadata), f"{name}.json", binary=False)
+    if compiled:
+        fn_cache_manager.publish()
+    _used_cache_keys.add(fn_cache_manager.key)
     # return handle to compiled kernel
-    return CompiledKernel(so_path, metadata, asm)
+    kernel = CompiledKernel(so_path, metadata, asm)
+    # start loading the cubin if it targets the current device
+    if device is not None and "cubin" in asm and os.environ.get("TRITON_BACKGROUND_LOAD", "1") == "1":
+        kernel.preload(device)
+    return kernel
+
+
+def compile_batch(kernels, **kwargs):
+    '''
+    Compiles several kernels into one cubin, e.g. to build a library of kernels
+    ahead of time. `kernels` is a list of `(fn, kwargs)` pairs, whose kwargs
+    complete or override the `kwargs` of all the kernels, as passed to `compile`.
+
+    Each kernel is compiled to LLVM IR on its own and cached as by `compile`.
+    Their LLVM modules are then linked into one, translated to a single PTX
+    module with an entry point per kernel, and assembled by one ptxas call: the
+    fixed costs of the code generator and of ptxas are paid once per batch.
+    The kernels must have distinct names and share `cc`, `fast_math`,
+    `opt_level` and `fp_contraction`.
+
+    Returns the `CompiledKernel`s of `kernels`, in order, which share the PTX
+    and the cubin of the batch.
+    '''
+    capability = kwargs.get("cc", None)
+    # as by `compile`, the cubin is only compiled in-process for the current device
+    device = None
+    if capability is None:
+        device = kwargs.get("device", torch.cuda.current_device())
+        capability = torch.cuda.get_device_capability(device)
+        capability = capability[0] * 10 + capability[1]
+    kernels = [(fn, {**kwargs, **fn_kwargs, "cc": capability}) for fn, fn_kwargs in kernels]
+    codegen = {(kw.get("fast_math", False), kw.get("opt_level", 3), kw.get("fp_contraction", "fast"))
+               for _, kw in kernels}
+    if len(codegen) > 1:
+        raise ValueError("the kernels of a batch must share fast_math, opt_level and fp_contraction")
+    fast_math, opt_level, fp_contraction = codegen.pop()
+    compiled = [compile(fn, **dict(kw, _last_stage="llir")) for fn, kw in kernels]
+    names = [llir_get_kernel_name(kernel.asm["llir"]) for kernel in compiled]
+    if len(set(names)) != len(names):
+        raise ValueError(f"the kernels of a batch must have distinct names, got {names}")
+
+    params = dict(cc=capability, fast_math=fast_math, opt_level=opt_level, fp_contraction=fp_contraction)
+    key = hashlib.md5(repr(params).encode("utf-8"))
+    for kernel in compiled:
+        key.update(kernel.asm["llir"].encode("utf-8"))
+    cache_manager = CacheManager(key.hexdigest())
+    if cache_manager.has_file("batch.ptx") and cache_manager.has_file("batch.cubin"):
+        ptx = Path(cache_manager._make_path("batch.ptx")).read_text()
+        cubin = Path(cache_manager._make_path("batch.cubin")).read_bytes()
+    else:
+        ptx = llir_batch_to_ptx([kernel.asm["llir"] for kernel in compiled], capability, fast_math=fast_math,
+                                opt_level=opt_level, fp_contraction=fp_contraction)
+        cubin = ptx_to_cubin(ptx, capability, device)
+        cache_manager.put(ptx, "batch.ptx", binary=False)
+        cache_manager.put(cubin, "batch.cubin")
+        cache_manager.publish()
+    _used_cache_keys.add(cache_manager.key)
+
+    for kernel, name in zip(compiled, names):
+        kernel.asm["ptx"] = ptx
+        kernel.asm["cubin"] = cubin
+        kernel.metadata["name"] = name
+        if device is not None and os.environ.get("TRITON_BACKGROUND_LOAD", "1") == "1":
+            kernel.preload(device)
+    return compiled
+
+
+# launcher stubs already imported by this process
+_launcher_modules = dict()
+
+
+def _load_launcher(so_path):
+    if so_path not in _launcher_modules:
+        import importlib.util
+        spec = importlib.util.spec_from_file_location("launcher", so_path)
+        mod = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(mod)
+        _launcher_modules[so_path] = mod
+    return _launcher_modules[so_path]
 
 
 class CompiledKernel:
@@ -1561,17 +2516,21 @@ class CompiledKernel:
     launch_enter_hook = None
     launch_exit_hook = None
 
+    # cubins are loaded one after the other on a background thread, so that
+    # loading the kernels of a model overlaps with compiling the next ones
+    _loader = None
+
     def __init__(self, so_path, metadata, asm):
         # initialize launcher
-        import importlib.util
-        spec = importlib.util.spec_from_file_location("launcher", so_path)
-        mod = importlib.util.module_from_spec(spec)
-        spec.loader.exec_module(mod)
-        self.c_wrapper = getattr(mod, "launch")
+        self.c_wrapper = getattr(_load_launcher(so_path), "launch")
         # initialize metadata
         self.shared = metadata["shared"]
         self.num_warps = metadata["num_warps"]
         self.num_stages = metadata["num_stages"]
+        self.num_ctas = metadata.get("num_ctas", 1)
+        # times of the stages and passes of the compilation, as recorded when
+        # the kernel was compiled (see `compile_profile`)
+        self.compile_profile = metadata.get("compile_profile")
         # initialize asm dict
         self.asm = asm
         # binaries are lazily initialized
@@ -1580,21 +2539,57 @@ class CompiledKernel:
         self.metadata = metadata
         self.cu_module = None
         self.cu_function = None
+        self._load_future = None
+        # records of the last launch of the kernels compiled with `profile`
+        self.profile_buffer = None
+        self.profile_grid = None
 
-    def _init_handles(self):
-        if self.cu_module is not None:
+    def preload(self, device):
+        '''
+        Schedules the loading of the cubin on `device` on the background thread;
+        errors (e.g., running out of shared memory) are raised by the first launch.
+        '''
+        if self.cu_module is not None or self._load_future is not None:
             return
-        device = torch.cuda.current_device()
+        init_cuda_utils()
+        if CompiledKernel._loader is None:
+            CompiledKernel._loader = ThreadPoolExecutor(max_workers=1, thread_name_prefix="triton-loader")
+        self._load_future = CompiledKernel._loader.submit(self._load, device)
+
+    def _load(self, device):
         global cuda_utils
         init_cuda_utils()
         max_shared = cuda_utils.get_device_properties(device)["max_shared_mem"]
         if self.shared > max_shared:
             raise OutOfResources(self.shared, max_shared, "shared memory")
-        mod, func, n_regs, n_spills = cuda_utils.load_binary(self.metadata["name"], self.asm["cubin"], self.shared, device)
-        # print(self.shared, n_regs, n_spills)
+        num_threads = self.num_warps * 32
+        return cuda_utils.load_binary(self.metadata["name"], self.asm["cubin"], self.shared, num_threads, device)
+
+    def _init_handles(self):
+        if self.cu_module is not None:
+            return
+        if self._load_future is not None:
+            handles = self._load_future.result()
+        else:
+            handles = self._load(torch.cuda.current_device())
+        mod, func, n_regs, n_spills, occupancy = handles
+        self.n_regs = n_regs
+        self.n_spills = n_spills
+        # CTAs of the kernel resident on one SM, as computed by the driver
+        self.occupancy = occupancy
+        self.metadata["occupancy"] = occupancy
         self.cu_module = mod
         self.cu_function = func
 
+    def _profile_buffer(self, grid_x, grid_y, grid_z):
+        # called by the launcher of the kernels compiled with `profile`: the
+        # records are zeroed on the current stream, which the launch follows
+        capacity = self.metadata["profile"]["capacity"]
+        size = grid_x * grid_y * grid_z * self.num_warps * capacity * 2
+        self.profile_buffer = torch.zeros(size, dtype=torch.int64, device=torch.cuda.current_device())
+        self.profile_grid = (grid_x, grid_y, grid_z)
+        return self.profile_buffer.data_ptr()
+
     def __getattribute__(self, name):
         if name == 'c_wrapper':
             self._init_handles()
@@ -1670,18 +2665,36 @@ class CudaUtils(object):
             int sm_clock_rate;
             int mem_clock_rate;
             int mem_bus_width;
+            int max_shared_mem_per_sm;
+            int max_regs_per_sm;
+            int max_threads_per_sm;
+            int l2_cache_size;
             CUDA_CHECK(cuDeviceGetAttribute(&max_shared_mem, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN, device));
             CUDA_CHECK(cuDeviceGetAttribute(&multiprocessor_count, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT, device));
             CUDA_CHECK(cuDeviceGetAttribute(&sm_clock_rate, CU_DEVICE_ATTRIBUTE_CLOCK_RATE, device));
             CUDA_CHECK(cuDeviceGetAttribute(&mem_clock_rate, CU_DEVICE_ATTRIBUTE_MEMORY_CLOCK_RATE, device));
             CUDA_CHECK(cuDeviceGetAttribute(&mem_bus_width, CU_DEVICE_ATTRIBUTE_GLOBAL_MEMORY_BUS_WIDTH, device));
+            CUDA_CHECK(cuDeviceGetAttribute(&max_shared_mem_per_sm, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR, device));
+            CUDA_CHECK(cuDeviceGetAttribute(&max_regs_per_sm, CU_DEVICE_ATTRIBUTE_MAX_REGISTERS_PER_MULTIPROCESSOR, device));
+            CUDA_CHECK(cuDeviceGetAttribute(&max_threads_per_sm, CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR, device));
+            CUDA_CHECK(cuDeviceGetAttribute(&l2_cache_size, CU_DEVICE_ATTRIBUTE_L2_CACHE_SIZE, device));
 
 
-            return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i}", "max_shared_mem", max_shared_mem,
+            return Py_BuildValue("{s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i, s:i}", "max_shared_mem", max_shared_mem,
                                        "multiprocessor_count", multiprocessor_count,
                                        "sm_clock_rate", sm_clock_rate,
                                        "mem_clock_rate", mem_clock_rate,
-                                       "mem_bus_width", mem_bus_width);
+                                       "mem_bus_width", mem_bus_width,
+                                       "max_shared_mem_per_sm", max_shared_mem_per_sm,
+                                       "max_regs_per_sm", max_regs_per_sm,
+                                       "max_threads_per_sm", max_threads_per_sm,
+                                       "l2_cache_size", l2_cache_size);
+        }
+
+        static PyObject* getDriverVersion(PyObject* self, PyObject* args){
+            int version;
+            CUDA_CHECK(cuDriverGetVersion(&version));
+            return PyLong_FromLong(version);
         }
 
         static PyObject* loadBinary(PyObject* self, PyObject* args) {
@@ -1689,14 +2702,22 @@ class CudaUtils(object):
             const char* data;
             Py_ssize_t data_size;
             int shared;
+            int num_threads;
             int device;
-            if(!PyArg_ParseTuple(args, "ss#ii", &name, &data, &data_size, &shared, &device)) {
+            if(!PyArg_ParseTuple(args, "ss#iii", &name, &data, &data_size, &shared, &num_threads, &device)) {
                 return NULL;
             }
             CUfunction fun;
             CUmodule mod;
             int32_t n_regs = 0;
             int32_t n_spills = 0;
+            // modules may be loaded from a thread without a current context
+            CUcontext pctx;
+            CUDA_CHECK(cuCtxGetCurrent(&pctx));
+            if (!pctx) {
+              CUDA_CHECK(cuDevicePrimaryCtxRetain(&pctx, device));
+              CUDA_CHECK(cuCtxSetCurrent(pctx));
+            }
             // create driver handles
             CUDA_CHECK(cuModuleLoadData(&mod, data));
             CUDA_CHECK(cuModuleGetFunction(&fun, mod, name));
@@ -1714,16 +2735,141 @@ class CudaUtils(object):
               CUDA_CHECK(cuFuncGetAttribute(&shared_static, CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES, fun));
               CUDA_CHECK(cuFuncSetAttribute(fun, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, shared_optin - shared_static));
             }
+            // CTAs resident on one SM, given the registers and shared memory
+            int occupancy = 0;
+            CUDA_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(&occupancy, fun, num_threads, shared));
 
             if(PyErr_Occurred()) {
               return NULL;
             }
-            return Py_BuildValue("(KKii)", (uint64_t)mod, (uint64_t)fun, n_regs, n_spills);
+            return Py_BuildValue("(KKiii)", (uint64_t)mod, (uint64_t)fun, n_regs, n_spills, occupancy);
+        }
+
+        static PyObject* compilePtx(PyObject* self, PyObject* args) {
+            const char* ptx;
+            Py_ssize_t ptx_size;
+            int capability;
+            int device_id;
+            if(!PyArg_ParseTuple(args, "s#ii", &ptx, &ptx_size, &capability, &device_id)) {
+                return NULL;
+            }
+            // the JIT linker needs a context; use the primary context of `device_id`
+            // so that kernels can be compiled from threads that never touched CUDA
+            CUdevice device;
+            CUcontext ctx;
+            CUDA_CHECK(cuInit(0));
+            CUDA_CHECK(cuDeviceGet(&device, device_id));
+            CUDA_CHECK(cuDevicePrimaryCtxRetain(&ctx, device));
+            char error_log[8192] = {0};
+            CUjit_option options[] = {CU_JIT_TARGET, CU_JIT_ERROR_LOG_BUFFER, CU_JIT_ERROR_LOG_BUFFER_SIZE_BYTES};
+            void* values[] = {(void*)(uintptr_t)capability, (void*)error_log, (void*)(uintptr_t)sizeof(error_log)};
+            CUlinkState state = NULL;
+            void* cubin = NULL;
+            size_t cubin_size = 0;
+            CUresult err;
+            Py_BEGIN_ALLOW_THREADS;
+            err = cuCtxPushCurrent(ctx);
+            if (err == CUDA_SUCCESS) {
+              err = cuLinkCreate(3, options, values, &state);
+              if (err == CUDA_SUCCESS)
+                err = cuLinkAddData(state, CU_JIT_INPUT_PTX, (void*)ptx, ptx_size + 1, "kernel.ptx", 0, NULL, NULL);
+              if (err == CUDA_SUCCESS)
+                err = cuLinkComplete(state, &cubin, &cubin_size);
+              cuCtxPopCurrent(NULL);
+            }
+            Py_END_ALLOW_THREADS;
+            PyObject* ret = NULL;
+            if (err == CUDA_SUCCESS)
+              ret = PyBytes_FromStringAndSize((const char*)cubin, cubin_size);
+            else
+              PyErr_Format(PyExc_RuntimeError, "Triton Error [CUDA]: failed to compile PTX (%d): %s", (int)err, error_log);
+            // the cubin is owned by the link state
+            if (state != NULL)
+              cuLinkDestroy(state);
+            cuDevicePrimaryCtxRelease(device);
+            return ret;
+        }
+
+        static PyObject* graphBeginCapture(PyObject* self, PyObject* args) {
+            uint64_t stream;
+            if(!PyArg_ParseTuple(args, "K", &stream))
+                return NULL;
+            CUDA_CHECK(cuStreamBeginCapture((CUstream)stream, CU_STREAM_CAPTURE_MODE_RELAXED));
+            Py_RETURN_NONE;
+        }
+
+        static PyObject* graphEndCapture(PyObject* self, PyObject* args) {
+            uint64_t stream;
+            if(!PyArg_ParseTuple(args, "K", &stream))
+                return NULL;
+            CUgraph graph;
+            CUDA_CHECK(cuStreamEndCapture((CUstream)stream, &graph));
+            return Py_BuildValue("K", (uint64_t)graph);
+        }
+
+        static PyObject* graphInstantiate(PyObject* self, PyObject* args) {
+            uint64_t graph;
+            if(!PyArg_ParseTuple(args, "K", &graph))
+                return NULL;
+            CUgraphExec exec;
+        #if CUDA_VERSION >= 12000
+            CUDA_CHECK(cuGraphInstantiate(&exec, (CUgraph)graph, 0));
+        #else
+            CUDA_CHECK(cuGraphInstantiate(&exec, (CUgraph)graph, NULL, NULL, 0));
+        #endif
+            return Py_BuildValue("K", (uint64_t)exec);
+        }
+
+        static PyObject* graphExecUpdate(PyObject* self, PyObject* args) {
+            // updates the kernel parameters of `exec` in place from `graph`;
+            // returns False if the topology changed and `graph` must be re-instantiated
+            uint64_t exec;
+            uint64_t graph;
+            if(!PyArg_ParseTuple(args, "KK", &exec, &graph))
+                return NULL;
+        #if CUDA_VERSION >= 12000
+            CUgraphExecUpdateResultInfo info;
+            CUresult err = cuGraphExecUpdate((CUgraphExec)exec, (CUgraph)graph, &info);
+        #else
+            CUgraphNode error_node;
+            CUgraphExecUpdateResult info;
+            CUresult err = cuGraphExecUpdate((CUgraphExec)exec, (CUgraph)graph, &error_node, &info);
+        #endif
+            return PyBool_FromLong(err == CUDA_SUCCESS);
+        }
+
+        static PyObject* graphLaunch(PyObject* self, PyObject* args) {
+            uint64_t exec;
+            uint64_t stream;
+            if(!PyArg_ParseTuple(args, "KK", &exec, &stream))
+                return NULL;
+            CUDA_CHECK(cuGraphLaunch((CUgraphExec)exec, (CUstream)stream));
+            Py_RETURN_NONE;
+        }
+
+        static PyObject* graphDestroy(PyObject* self, PyObject* args) {
+            uint64_t graph;
+            uint64_t exec;
+            if(!PyArg_ParseTuple(args, "KK", &graph, &exec))
+                return NULL;
+            if (graph)
+              CUDA_CHECK(cuGraphDestroy((CUgraph)graph));
+            if (exec)
+              CUDA_CHECK(cuGraphExecDestroy((CUgraphExec)exec));
+            Py_RETURN_NONE;
         }
 
         static PyMethodDef ModuleMethods[] = {
           {"load_binary", loadBinary, METH_VARARGS, "Load provided cubin into CUDA driver"},
+          {"graph_begin_capture", graphBeginCapture, METH_VARARGS, "Start capturing a CUDA graph on a stream"},
+          {"graph_end_capture", graphEndCapture, METH_VARARGS, "Stop capturing a CUDA graph and return it"},
+          {"graph_instantiate", graphInstantiate, METH_VARARGS, "Instantiate an executable CUDA graph"},
+          {"graph_exec_update", graphExecUpdate, METH_VARARGS, "Update the parameters of an executable CUDA graph"},
+          {"graph_launch", graphLaunch, METH_VARARGS, "Launch an executable CUDA graph"},
+          {"graph_destroy", graphDestroy, METH_VARARGS, "Destroy a CUDA graph and its executable graph"},
+          {"compile_ptx", compilePtx, METH_VARARGS, "Compile provided PTX into cubin with the CUDA driver"},
           {"get_device_properties", getDeviceProperties, METH_VARARGS, "Get the properties for a given device"},
+          {"get_driver_version", getDriverVersion, METH_VARARGS, "Get the version of the CUDA driver"},
           {NULL, NULL, 0, NULL} // sentinel
         };
 
@@ -1763,7 +2909,15 @@ class CudaUtils(object):
         mod = importlib.util.module_from_spec(spec)
         spec.loader.exec_module(mod)
         self.load_binary = mod.load_binary
+        self.compile_ptx = mod.compile_ptx
+        self.graph_begin_capture = mod.graph_begin_capture
+        self.graph_end_capture = mod.graph_end_capture
+        self.graph_instantiate = mod.graph_instantiate
+        self.graph_exec_update = mod.graph_exec_update
+        self.graph_launch = mod.graph_launch
+        self.graph_destroy = mod.graph_destroy
         self.get_device_properties = mod.get_device_properties
+        self.get_driver_version = mod.get_driver_version
 
 
 def init_cuda_utils():
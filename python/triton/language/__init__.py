@@ -8,9 +8,11 @@ from ..impl import (
 from . import libdevice
 from .core import (
     abs,
+    advance,
     arange,
     argmin,
     argmax,
+    associative_scan,
     atomic_add,
     atomic_and,
     atomic_cas,
@@ -20,6 +22,7 @@ from .core import (
     atomic_xchg,
     atomic_xor,
     bfloat16,
+    block_ptr,
     block_type,
     broadcast,
     broadcast_to,
@@ -27,6 +30,7 @@ from .core import (
     cdiv,
     constexpr,
     cos,
+    cumsum,
     debug_barrier,
     dot,
     dtype,
@@ -37,14 +41,19 @@ from .core import (
     float32,
     float64,
     float8,
+    float8e4,
+    float8e5,
     function_type,
+    grid_stride,
     int1,
     int16,
     int32,
     int64,
     int8,
+    last_program,
     load,
     log,
+    make_block_ptr,
     max,
     max_contiguous,
     maximum,
@@ -55,17 +64,22 @@ from .core import (
     pi32_t,
     pointer_type,
     printf,
+    profile_range,
     program_id,
+    ragged_load,
     ravel,
+    reduce,
     reshape,
     sigmoid,
     sin,
     softmax,
+    sort,
     sqrt,
     store,
     sum,
     swizzle2d,
     tensor,
+    topk,
     trans,
     triton,
     uint16,
@@ -96,9 +110,11 @@ from .random import (
 
 __all__ = [
     "abs",
+    "advance",
     "arange",
     "argmin",
     "argmax",
+    "associative_scan",
     "atomic_add",
     "atomic_and",
     "atomic_cas",
@@ -108,6 +124,7 @@ __all__ = [
     "atomic_xchg",
     "atomic_xor",
     "bfloat16",
+    "block_ptr",
     "block_type",
     "broadcast",
     "broadcast_to",
@@ -116,6 +133,7 @@ __all__ = [
     "cdiv",
     "constexpr",
     "cos",
+    "cumsum",
     "debug_barrier",
     "dot",
     "dtype",
@@ -125,17 +143,22 @@ __all__ = [
     "float32",
     "float64",
     "float8",
+    "float8e4",
+    "float8e5",
     "full",
     "function_type",
+    "grid_stride",
     "int1",
     "int16",
     "int32",
     "int64",
     "int8",
     "ir",
+    "last_program",
     "libdevice",
     "load",
     "log",
+    "make_block_ptr",
     "max",
     "max_contiguous",
     "maximum",
@@ -149,7 +172,9 @@ __all__ = [
     "pi32_t",
     "pointer_type",
     "printf",
+    "profile_range",
     "program_id",
+    "ragged_load",
     "rand",
     "rand4x",
     "randint",
@@ -157,15 +182,18 @@ __all__ = [
     "randn",
     "randn4x",
     "ravel",
+    "reduce",
     "reshape",
     "sigmoid",
     "sin",
     "softmax",
+    "sort",
     "sqrt",
     "store",
     "sum",
     "swizzle2d",
     "tensor",
+    "topk",
     "trans",
     "triton",
     "uint16",
@@ -37,8 +37,8 @@ def _to_tensor(x, builder):
 class dtype:
     SINT_TYPES = ['int1', 'int8', 'int16', 'int32', 'int64']
     UINT_TYPES = ['uint8', 'uint16', 'uint32', 'uint64']
-    FP_TYPES = ['fp8', 'fp16', 'bf16', 'fp32', 'fp64']
-    CUSTOMIZED_FP_TYPES = ['fp8']
+    FP_TYPES = ['fp8', 'fp8e4', 'fp8e5', 'fp16', 'bf16', 'fp32', 'fp64']
+    CUSTOMIZED_FP_TYPES = ['fp8', 'fp8e4', 'fp8e5']
     STANDARD_FP_TYPES = ['fp16', 'bf16', 'fp32', 'fp64']
     OTHER_TYPES = ['void']
 
@@ -61,6 +61,12 @@ class dtype:
             if name == 'fp8':
                 self.fp_mantissa_width = 3
                 self.primitive_bitwidth = 8
+            elif name == 'fp8e4':
+                self.fp_mantissa_width = 3
+                self.primitive_bitwidth = 8
+            elif name == 'fp8e5':
+                self.fp_mantissa_width = 2
+                self.primitive_bitwidth = 8
             elif name == 'fp16':
                 self.fp_mantissa_width = 10
                 self.primitive_bitwidth = 16
@@ -79,6 +85,12 @@ class dtype:
     def is_fp8(self):
         return self.name == 'fp8'
 
+    def is_fp8e4(self):
+        return self.name == 'fp8e4'
+
+    def is_fp8e5(self):
+        return self.name == 'fp8e5'
+
     def is_fp16(self):
         return self.name == 'fp16'
 
@@ -181,6 +193,10 @@ class dtype:
             return builder.get_int64_ty()
         elif self.name == 'fp8':
             return builder.get_fp8_ty()
+        elif self.name == 'fp8e4':
+            return builder.get_fp8e4_ty()
+        elif self.name == 'fp8e5':
+            return builder.get_fp8e5_ty()
         elif self.name == 'fp16':
             return builder.get_half_ty()
         elif self.name == 'bf16':
@@ -311,6 +327,8 @@ uint16 = dtype('uint16')
 uint32 = dtype('uint32')
 uint64 = dtype('uint64')
 float8 = dtype('fp8')
+float8e4 = dtype('fp8e4')
+float8e5 = dtype('fp8e5')
 float16 = dtype('fp16')
 bfloat16 = dtype('bf16')
 float32 = dtype('fp32')
@@ -633,6 +651,36 @@ class tensor:
         return semantic.cast(self, dtype, _builder)
 
 
+class block_ptr:
+    '''
+    Pointer to a block of a tensor in global memory, made by :code:`make_block_ptr`.
+    Its base, shape, strides and offsets are scalars; loads and stores add per-element
+    offsets that don't depend on :code:`offsets` to the pointer to the first element
+    of the block, so that loops only carry the scalar offsets of the block.
+    '''
+
+    def __init__(self, base: tensor, shape, strides, offsets, block_shape, order):
+        self.base = base
+        self.shape = list(shape)
+        self.strides = list(strides)
+        self.offsets = list(offsets)
+        self.block_shape = list(block_shape)
+        self.order = list(order)
+        self.dtype = base.dtype.element_ty
+
+    def _flatten(self):
+        # the values carried by the loops, see CodeGenerator.visit_For
+        return [self.base] + self.shape + self.strides + self.offsets
+
+    def _unflatten(self, values):
+        rank = len(self.block_shape)
+        return block_ptr(values[0], values[1:1 + rank], values[1 + rank:1 + 2 * rank],
+                         values[1 + 2 * rank:], self.block_shape, self.order)
+
+    def __str__(self) -> str:
+        return f'block_ptr<{self.dtype}[{",".join(str(s) for s in self.block_shape)}]>'
+
+
 # -----------------------
 # SPMD Programming Model
 # -----------------------
@@ -673,6 +721,32 @@ def num_programs(axis, _builder=None):
     return semantic.num_programs(axis, _builder)
 
 
+class grid_stride:
+    """
+    Iterator over the blocks of :code:`range(start, end, step)` visited by the
+    current program when the programs launched along :code:`axis` share them in
+    turn: the program :code:`pid` visits the blocks starting at
+    :code:`start + (pid + i * num_programs(axis)) * step`. A persistent kernel
+    launched with a few programs per SM processes the whole range:
+
+    .. highlight:: python
+    .. code-block:: python
+
+        for off in tl.grid_stride(0, n, BLOCK):
+            offs = off + tl.arange(0, BLOCK)
+            x = tl.load(x_ptr + offs, mask=offs < n, cache_modifier=".nc", eviction_policy="no_allocate")
+            tl.store(y_ptr + offs, x.to(tl.float16), mask=offs < n)
+
+    Can only be used in the header of a :code:`for` loop.
+
+    :param axis: The axis of the 3D launch grid. Has to be either 0, 1 or 2.
+    :type axis: int
+    """
+
+    def __init__(self, start, end=None, step=1, axis=0):
+        raise RuntimeError("tl.grid_stride can only be used in the header of a for loop of a @triton.jit'd function")
+
+
 # -----------------------
 # Block Initialization
 # -----------------------
@@ -802,19 +876,35 @@ def reshape(input, shape, _builder=None):
 
 
 @builtin
-def dot(input, other, allow_tf32=True, _builder=None):
+def dot(input, other, allow_tf32=True, precision=None, _builder=None):
     """
     Returns the matrix product of two blocks.
 
     The two blocks must be two-dimensional and have compatible inner dimensions.
+    :code:`float8e4` and :code:`float8e5` blocks of the same type are multiplied by the
+    tensor cores of sm_89 and later GPUs; other :code:`float8` blocks are converted to
+    :code:`float16` once loaded.
+
+    A :code:`float16` or :code:`bfloat16` :code:`input` can be multiplied with quantized
+    :code:`int8` weights, which are converted to the type of :code:`input` in registers.
+    When :code:`other` has half as many rows as :code:`input` has columns, each of its
+    bytes packs two :code:`int4` weights of consecutive rows, the even row in the low
+    nibble. Per-group scales and zero points whose groups span whole blocks of K are
+    applied to the result, e.g. :code:`(tl.dot(x, w) - tl.sum(x, 1)[:, None] * zero) * scale`.
 
     :param input: The first tensor to be multiplied.
-    :type input: 2D tensor of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`}
+    :type input: 2D tensor of scalar-type in {:code:`float8e4`, :code:`float8e5`, :code:`float16`, :code:`bfloat16`, :code:`float32`}
     :param other: The second tensor to be multiplied.
-    :type other: 2D tensor of scalar-type in {:code:`float16`, :code:`bfloat16`, :code:`float32`}
+    :type other: 2D tensor of scalar-type in {:code:`float8e4`, :code:`float8e5`, :code:`float16`, :code:`bfloat16`, :code:`float32`, :code:`int8`}
+    :param precision: How :code:`float32` blocks are multiplied, overrides :code:`allow_tf32` when set.
+        :code:`"ieee"` uses fp32 FMAs, :code:`"tf32"` the tf32 tensor cores and :code:`"tf32x3"`
+        splits both blocks into high and low tf32 parts and issues three tensor core products,
+        which is close to fp32 accuracy.
+    :type precision: str, optional
     """
     allow_tf32 = _constexpr_to_value(allow_tf32)
-    return semantic.dot(input, other, allow_tf32, _builder)
+    precision = _constexpr_to_value(precision)
+    return semantic.dot(input, other, allow_tf32, precision, _builder)
 
 
 # -----------------------
@@ -823,7 +913,43 @@ def dot(input, other, allow_tf32=True, _builder=None):
 
 
 @builtin
-def load(pointer, mask=None, other=None, cache_modifier="", eviction_policy="", volatile=False, _builder=None):
+def make_block_ptr(base, shape, strides, offsets, block_shape, order, _builder=None):
+    """
+    Returns a pointer to the block of :code:`block_shape` elements at :code:`offsets`
+    in the tensor of :code:`shape` and :code:`strides` starting at :code:`base`.
+
+    :param base: Pointer to the first element of the tensor.
+    :type base: Scalar of dtype=triton.PointerDType
+    :param shape: The shape of the tensor, which bounds the accesses with :code:`boundary_check`.
+    :param strides: The strides of the tensor, in elements.
+    :param offsets: The offsets of the block in the tensor, which must be non-negative.
+    :param block_shape: The shape of the block, as constexprs.
+    :param order: The dimensions of the tensor from the fastest-varying to the slowest.
+    """
+    shape = [_to_tensor(s, _builder) for s in shape]
+    strides = [_to_tensor(s, _builder) for s in strides]
+    offsets = [_to_tensor(o, _builder) for o in offsets]
+    block_shape = _shape_check_impl(block_shape)
+    order = [_constexpr_to_value(d) for d in order]
+    return semantic.make_block_ptr(base, shape, strides, offsets, block_shape, order, _builder)
+
+
+@builtin
+def advance(base, offsets, _builder=None):
+    """
+    Returns :code:`base` moved by :code:`offsets` elements along each dimension.
+
+    :param base: The block pointer to move.
+    :type base: block_ptr
+    :param offsets: The number of elements to move the block by along each dimension.
+    """
+    offsets = [_to_tensor(o, _builder) for o in offsets]
+    return semantic.advance(base, offsets, _builder)
+
+
+@builtin
+def load(pointer, mask=None, other=None, cache_modifier="", eviction_policy="", volatile=False, multicast=False,
+         boundary_check=(), padding_option="", _builder=None):
     """
     Return a tensor of data whose values are, elementwise, loaded from memory at location defined by :code:`pointer`.
 
@@ -837,9 +963,29 @@ def load(pointer, mask=None, other=None, cache_modifier="", eviction_policy="",
     :type mask: Block of triton.int1, optional
     :param other: if mask[idx] is false, return other[idx]
     :type other: Block, optional
-    :param cache_modifier: changes cache option in nvidia ptx
+    :param cache_modifier: changes cache option in nvidia ptx (".ca", ".cg", ".cs", or ".nc" for data that is
+        read-only during the whole kernel, loaded through the non-coherent texture path)
     'type cache_modifier: str, optional
+    :param eviction_policy: changes eviction policy in nvidia ptx ("evict_first", "evict_last" or "no_allocate")
+    'type eviction_policy: str, optional
+    :param multicast: if true, all the programs of a thread-block cluster (see :code:`num_ctas`) load the same
+        data, which is then copied once to the shared memory of all of them
+    :type multicast: bool, optional
+    :param boundary_check: when :code:`pointer` is a :code:`block_ptr`, the dimensions along which the elements
+        out of the shape of its tensor are not loaded, instead of :code:`mask`
+    :type boundary_check: tuple of ints, optional
+    :param padding_option: the value of the elements out of bounds, "zero" or "nan", undefined by default
+    :type padding_option: str, optional
     """
+    if isinstance(pointer, block_ptr):
+        if _constexpr_to_value(mask) is not None or _constexpr_to_value(other) is not None:
+            raise ValueError("`mask` and `other` cannot be used with a block pointer, use `boundary_check`")
+        boundary_check = [_constexpr_to_value(d) for d in _constexpr_to_value(boundary_check)]
+        return semantic.load_block_ptr(pointer, boundary_check, _constexpr_to_value(padding_option),
+                                       _constexpr_to_value(cache_modifier), _constexpr_to_value(eviction_policy),
+                                       _constexpr_to_value(volatile), _builder)
+    if _constexpr_to_value(boundary_check) or _constexpr_to_value(padding_option):
+        raise ValueError("`boundary_check` and `padding_option` require a block pointer")
     # mask, other can be constexpr
     if _constexpr_to_value(mask) is not None:
         mask = _to_tensor(mask, _builder)
@@ -848,11 +994,45 @@ def load(pointer, mask=None, other=None, cache_modifier="", eviction_policy="",
     cache_modifier = _constexpr_to_value(cache_modifier)
     eviction_policy = _constexpr_to_value(eviction_policy)
     volatile = _constexpr_to_value(volatile)
-    return semantic.load(pointer, mask, other, cache_modifier, eviction_policy, volatile, _builder)
+    multicast = _constexpr_to_value(multicast)
+    return semantic.load(pointer, mask, other, cache_modifier, eviction_policy, volatile, _builder, multicast)
+
+
+@builtin
+def ragged_load(pointer, offsets, lengths, other=None, cache_modifier="", eviction_policy="", _builder=None):
+    """
+    Return a tensor of data loaded from memory at location defined by :code:`pointer`
+    where :code:`offsets < lengths`, and :code:`other` elsewhere, e.g., the rows of a
+    ragged tensor from their column offsets and lengths.
+
+    Unlike :code:`load` with the same mask, the accesses are vectorized when the lengths
+    are not known to be multiples of the vector width: each vector is loaded when its
+    first element is in bounds. The memory must therefore be readable up to the end of
+    those vectors, which holds for the rows of tensors allocated by PyTorch.
+
+    :code:`offsets`, :code:`lengths` and :code:`other` are implicitly broadcast to
+    :code:`pointer.shape`.
+
+    :param pointer: Pointers to the data to be loaded.
+    :type pointer: Block of dtype=triton.PointerDType
+    :param offsets: Offsets of the elements along the ragged dimension, contiguous along it.
+    :type offsets: Block of integers
+    :param lengths: Lengths of the rows along the ragged dimension.
+    :type lengths: Block of integers
+    :param other: if offsets[idx] >= lengths[idx], return other[idx]
+    :type other: Block, optional
+    """
+    offsets = _to_tensor(offsets, _builder)
+    lengths = _to_tensor(lengths, _builder)
+    if _constexpr_to_value(other) is not None:
+        other = _to_tensor(other, _builder)
+    cache_modifier = _constexpr_to_value(cache_modifier)
+    eviction_policy = _constexpr_to_value(eviction_policy)
+    return semantic.ragged_load(pointer, offsets, lengths, other, cache_modifier, eviction_policy, _builder)
 
 
 @builtin
-def store(pointer, value, mask=None, _builder=None):
+def store(pointer, value, mask=None, cache_modifier="", eviction_policy="", boundary_check=(), _builder=None):
     """
     Stores :code:`value` tensor of elements in memory, element-wise, at the memory locations specified by :code:`pointer`.
 
@@ -864,12 +1044,29 @@ def store(pointer, value, mask=None, _builder=None):
     :type value: Block
     :param mask: If mask[idx] is false, do not store :code:`value[idx]` at :code:`pointer[idx]`.
     :type mask: Block of triton.int1, optional
+    :param cache_modifier: changes cache option in nvidia ptx (".cg", ".cs" or ".wt")
+    'type cache_modifier: str, optional
+    :param eviction_policy: changes eviction policy in nvidia ptx ("evict_first", "evict_last" or "no_allocate"). On sm_80+, it also sets the L2 eviction priority of the stored lines.
+    'type eviction_policy: str, optional
+    :param boundary_check: when :code:`pointer` is a :code:`block_ptr`, the dimensions along which the elements
+        out of the shape of its tensor are not stored, instead of :code:`mask`
+    :type boundary_check: tuple of ints, optional
     """
     # value can be constexpr
     value = _to_tensor(value, _builder)
+    if isinstance(pointer, block_ptr):
+        if _constexpr_to_value(mask) is not None:
+            raise ValueError("`mask` cannot be used with a block pointer, use `boundary_check`")
+        boundary_check = [_constexpr_to_value(d) for d in _constexpr_to_value(boundary_check)]
+        return semantic.store_block_ptr(pointer, value, boundary_check, _constexpr_to_value(cache_modifier),
+                                        _constexpr_to_value(eviction_policy), _builder)
+    if _constexpr_to_value(boundary_check):
+        raise ValueError("`boundary_check` requires a block pointer")
     if _constexpr_to_value(mask) is not None:
         mask = _to_tensor(mask, _builder)
-    return semantic.store(pointer, value, mask, _builder)
+    cache_modifier = _constexpr_to_value(cache_modifier)
+    eviction_policy = _constexpr_to_value(eviction_policy)
+    return semantic.store(pointer, value, mask, cache_modifier, eviction_policy, _builder)
 
 
 # -----------------------
@@ -914,9 +1111,28 @@ def atomic_xchg(pointer, val, mask=None, _builder=None):
 
 @builtin
 @_add_atomic_docstr("add")
-def atomic_add(pointer, val, mask=None, _builder=None):
+def atomic_add(pointer, val, mask=None, warp_aggregate=False, _builder=None):
+    # With `warp_aggregate`, when the result is unused, the values destined to
+    # the same address within a warp are combined before a single thread
+    # issues the reduction
     val = _to_tensor(val, _builder)
-    return semantic.atomic_add(pointer, val, mask, _builder)
+    warp_aggregate = _constexpr_to_value(warp_aggregate)
+    return semantic.atomic_add(pointer, val, mask, warp_aggregate, _builder)
+
+
+@builtin
+def last_program(counter, _builder=None):
+    """
+    Returns whether the current program is the last program of the grid to arrive
+    at :code:`counter`, by incrementing it atomically. The writes of every program
+    made before it arrived are visible to the last program after the call, which
+    makes it possible to combine the partial results of all programs in a single
+    launch. The counter must be 0 when the grid starts and is not reset.
+
+    :param counter: The counter of the programs that arrived.
+    :type counter: Scalar of dtype=triton.PointerDType(int32)
+    """
+    return semantic.last_program(counter, _builder)
 
 
 @builtin
@@ -993,6 +1209,25 @@ def umulhi(x, y, _builder=None):
     return semantic.umulhi(x, y, _builder)
 
 
+@builtin
+def philox(offset, seed_lo, seed_hi, n_rounds, _builder=None):
+    """
+    Returns, for each element of :code:`offset`, output :code:`offset % 4` of
+    Philox4x32 on counter :code:`(offset // 4, 0, 0, 0)` and key
+    :code:`(seed_lo, seed_hi)`. Aligned groups of 4 consecutive offsets share a
+    single evaluation of Philox when they are held by the same thread.
+
+    :param offset: the 32-bit offsets
+    :param seed_lo: the low 32 bits of the seed
+    :param seed_hi: the high 32 bits of the seed
+    :param n_rounds: the number of rounds of Philox
+    """
+    n_rounds = _constexpr_to_value(n_rounds)
+    seed_lo = _to_tensor(seed_lo, _builder)
+    seed_hi = _to_tensor(seed_hi, _builder)
+    return semantic.philox(offset, seed_lo, seed_hi, n_rounds, _builder)
+
+
 @builtin
 def fdiv(x, y, ieee_rounding=False, _builder=None):
     ieee_rounding = _constexpr_to_value(ieee_rounding)
@@ -1105,6 +1340,110 @@ def xor_sum(input, axis, _builder=None):
     return semantic.xor_sum(input, axis, _builder)
 
 
+@builtin
+def reduce(input, axis, combine_fn, _builder=None, _generator=None):
+    """
+    Reduces the :code:`input` tensor, or tuple of tensors reduced together, along the provided :code:`axis`
+    with :code:`combine_fn`
+
+    :param input: the input values, a tensor or a tuple of tensors of the same shape
+    :param axis: the dimension along which the reduction should be done
+    :param combine_fn: a :code:`triton.jit`'d function taking the accumulated values followed by the current
+        ones, one scalar per input, and returning the combined values; it must be associative and commutative
+    """
+    axis = _constexpr_to_value(axis)
+    combine_fn = _constexpr_to_value(combine_fn)
+    inputs = list(input) if isinstance(input, tuple) else [input]
+
+    def make_combine_region(reduce_op):
+        scalar_tys = [t.type.scalar for t in inputs]
+        ir_scalar_tys = [ty.to_ir(_builder) for ty in scalar_tys]
+        block = _builder.create_block_with_parent(reduce_op.get_region(0), ir_scalar_tys * 2)
+        args = [tensor(block.arg(i), ty) for i, ty in enumerate(scalar_tys * 2)]
+        results = _generator.call_JitFunction(combine_fn, args, kwargs={})
+        if not isinstance(results, tuple):
+            results = (results,)
+        if [r.type if isinstance(r, tensor) else None for r in results] != scalar_tys:
+            raise ValueError(f"combine_fn of reduce must return {len(scalar_tys)} values of types {scalar_tys}")
+        _builder.create_generic_reduce_ret([r.handle for r in results])
+    ret = semantic.reduction(inputs, axis, make_combine_region, _builder)
+    return ret if isinstance(input, tuple) else ret[0]
+
+
+# -----------------------
+# Scans
+# -----------------------
+
+@builtin
+def associative_scan(input, axis, combine_fn, _builder=None, _generator=None):
+    """
+    Returns the inclusive scan of the :code:`input` tensor along the provided :code:`axis`,
+    i.e. element :code:`i` is :code:`combine_fn(... combine_fn(input[0], input[1]) ..., input[i])`
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    :param combine_fn: a :code:`triton.jit`'d function combining two scalars, which must be associative
+    """
+    axis = _constexpr_to_value(axis)
+    combine_fn = _constexpr_to_value(combine_fn)
+
+    def make_combine_region(scan_op):
+        scalar_ty = input.type.scalar
+        block = _builder.create_block_with_parent(scan_op.get_region(0), [scalar_ty.to_ir(_builder)] * 2)
+        args = [tensor(block.arg(i), scalar_ty) for i in range(2)]
+        result = _generator.call_JitFunction(combine_fn, args, kwargs={})
+        if not isinstance(result, tensor) or result.type != scalar_ty:
+            raise ValueError(f"combine_fn of associative_scan must return a {scalar_ty}")
+        _builder.create_scan_ret(result.handle)
+    return semantic.associative_scan(input, axis, make_combine_region, _builder)
+
+
+@builtin
+def cumsum(input, axis=0, _builder=None):
+    """
+    Returns the cumulative sum of the :code:`input` tensor along the provided :code:`axis`
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    """
+    axis = _constexpr_to_value(axis)
+    return semantic.cumsum(input, axis, _builder)
+
+
+# -----------------------
+# Sort
+# -----------------------
+
+@builtin
+def sort(input, axis=0, descending=False, _builder=None):
+    """
+    Returns the :code:`input` tensor sorted along the provided :code:`axis`,
+    whose size must be a power of 2
+
+    :param input: the input values
+    :param axis: the dimension along which the values should be sorted
+    :param descending: sort in descending order instead of ascending order
+    """
+    axis = _constexpr_to_value(axis)
+    descending = _constexpr_to_value(descending)
+    return semantic.sort(input, axis, None, descending, _builder)
+
+
+@builtin
+def topk(input, k, axis=0, _builder=None):
+    """
+    Returns the :code:`k` largest values of the :code:`input` tensor along the
+    provided :code:`axis`, in descending order
+
+    :param input: the input values
+    :param k: the number of values to keep, a power of 2
+    :param axis: the dimension along which the values should be selected
+    """
+    k = _constexpr_to_value(k)
+    axis = _constexpr_to_value(axis)
+    return semantic.sort(input, axis, k, True, _builder)
+
+
 # -----------------------
 # Internal for debugging
 # -----------------------
@@ -1289,3 +1628,33 @@ def printf(prefix, *args, _builder=None):
     for arg in args:
         new_args.append(_to_tensor(arg, _builder))
     return semantic.printf(new_prefix, new_args, _builder)
+
+
+class profile_range:
+    """
+    Region of the kernel timed when it is compiled with :code:`profile`, to be
+    used as a context manager:
+
+    .. highlight:: python
+    .. code-block:: python
+
+        with tl.profile_range("softmax"):
+            ...
+
+    Each warp records the cycle counter when it enters and leaves the region,
+    see :code:`triton.runtime.instrumentation`. Regions are no-ops in the
+    kernels compiled without profiling.
+
+    :param name: the name of the region, regions of the same name are merged
+    :type name: str
+    """
+
+    def __init__(self, name):
+        self.name = _constexpr_to_value(name)
+        assert isinstance(self.name, str), f"{self.name} is not a string"
+
+    def _enter(self, _builder=None):
+        semantic.profile_mark(self.name, False, _builder)
+
+    def _exit(self, _builder=None):
+        semantic.profile_mark(self.name, True, _builder)
@@ -635,6 +635,10 @@ def cast(input: tl.tensor,
     src_sca_ty = src_ty.scalar
     dst_sca_ty = dst_ty.scalar
 
+    # Casting between customized floating types goes through fp16
+    if src_sca_ty.is_customized_floating() and dst_sca_ty.is_customized_floating():
+        return cast(cast(input, tl.float16, builder), dst_sca_ty, builder)
+
     # Casting with customized floating types involved: fp8 <=> bf16, fp16, fp32, fp64
     if (src_sca_ty.is_customized_floating() and dst_sca_ty.is_floating()) or \
        (src_sca_ty.is_floating() and dst_sca_ty.is_customized_floating()):
@@ -734,13 +738,58 @@ def cast(input: tl.tensor,
 # ===----------------------------------------------------------------------===//
 
 
+def _str_to_load_cache_modifier(cache_modifier):
+    cache = ir.CACHE_MODIFIER.NONE  # default
+    if cache_modifier:
+        if cache_modifier == ".ca":
+            cache = ir.CACHE_MODIFIER.CA
+        elif cache_modifier == ".cg":
+            cache = ir.CACHE_MODIFIER.CG
+        elif cache_modifier == ".cs":
+            cache = ir.CACHE_MODIFIER.CS
+        elif cache_modifier == ".nc":
+            cache = ir.CACHE_MODIFIER.NC
+        else:
+            raise ValueError(f"Cache modifier {cache_modifier} not supported")
+    return cache
+
+
+def _str_to_store_cache_modifier(cache_modifier):
+    cache = ir.CACHE_MODIFIER.NONE  # default
+    if cache_modifier:
+        if cache_modifier == ".cg":
+            cache = ir.CACHE_MODIFIER.CG
+        elif cache_modifier == ".cs":
+            cache = ir.CACHE_MODIFIER.CS
+        elif cache_modifier == ".wt":
+            cache = ir.CACHE_MODIFIER.WT
+        else:
+            raise ValueError(f"Cache modifier {cache_modifier} not supported")
+    return cache
+
+
+def _str_to_eviction_policy(eviction_policy):
+    eviction = ir.EVICTION_POLICY.NORMAL  # default
+    if eviction_policy:
+        if eviction_policy == "evict_last":
+            eviction = ir.EVICTION_POLICY.EVICT_LAST
+        elif eviction_policy == "evict_first":
+            eviction = ir.EVICTION_POLICY.EVICT_FIRST
+        elif eviction_policy == "no_allocate":
+            eviction = ir.EVICTION_POLICY.NO_ALLOCATE
+        else:
+            raise ValueError(f"Eviction policy {eviction_policy} not supported")
+    return eviction
+
+
 def load(ptr: tl.tensor,
          mask: Optional[tl.tensor],
          other: Optional[tl.tensor],
          cache_modifier: str,
          eviction_policy: str,
          is_volatile: bool,
-         builder: ir.builder) -> tl.tensor:
+         builder: ir.builder,
+         multicast: bool = False) -> tl.tensor:
     if not ptr.type.scalar.is_ptr():
         raise ValueError("Pointer argument of load instruction is " + ptr.type.__repr__())
     if ptr.type.is_block():
@@ -761,25 +810,10 @@ def load(ptr: tl.tensor,
     if other:
         other = cast(other, elt_ty, builder)
 
-    # cache modifier
-    cache = ir.CACHE_MODIFIER.NONE  # default
-    if cache_modifier:
-        if cache_modifier == ".ca":
-            cache = ir.CACHE_MODIFIER.CA
-        elif cache_modifier == ".cg":
-            cache = ir.CACHE_MODIFIER.CG
-        else:
-            raise ValueError(f"Cache modifier {cache_modifier} not supported")
-
-    # eviction policy
-    eviction = ir.EVICTION_POLICY.NORMAL  # default
-    if eviction_policy:
-        if eviction_policy == "evict_last":
-            eviction = ir.EVICTION_POLICY.EVICT_LAST
-        elif eviction_policy == "evict_first":
-            eviction = ir.EVICTION_POLICY.EVICT_FIRST
-        else:
-            raise ValueError(f"Eviction policy {eviction_policy} not supported")
+    cache = _str_to_load_cache_modifier(cache_modifier)
+    eviction = _str_to_eviction_policy(eviction_policy)
+    if is_volatile and cache == ir.CACHE_MODIFIER.NC:
+        raise ValueError("Volatile loads cannot use the non-coherent cache (\".nc\")")
 
     if ptr.type.is_block():
         shape = ptr.type.get_block_shapes()
@@ -790,19 +824,140 @@ def load(ptr: tl.tensor,
     if not mask:
         if other:
             raise ValueError("`other` cannot be provided without `mask`")
-        return tl.tensor(builder.create_load(ptr.handle, cache, eviction, is_volatile),
-                         dst_ty)
+        ret = builder.create_load(ptr.handle, cache, eviction, is_volatile)
     else:
-        return tl.tensor(builder.create_masked_load(ptr.handle,
-                                                    mask.handle,
-                                                    other.handle if other else None,
-                                                    cache, eviction, is_volatile),
-                         dst_ty)
+        ret = builder.create_masked_load(ptr.handle,
+                                         mask.handle,
+                                         other.handle if other else None,
+                                         cache, eviction, is_volatile)
+    if multicast:
+        ret.set_attr("multicast", builder.get_unit_attr())
+    return tl.tensor(ret, dst_ty)
+
+
+def make_block_ptr(base: tl.tensor,
+                   shape: List[tl.tensor],
+                   strides: List[tl.tensor],
+                   offsets: List[tl.tensor],
+                   block_shape: List[int],
+                   order: List[int],
+                   builder: ir.builder) -> tl.block_ptr:
+    if base.type.is_block() or not base.type.scalar.is_ptr():
+        raise ValueError("Base of a block pointer must be a scalar pointer, got " + base.type.__repr__())
+    rank = len(block_shape)
+    if not (len(shape) == len(strides) == len(offsets) == len(order) == rank):
+        raise ValueError("shape, strides, offsets, block_shape and order of a block pointer must have the same length")
+    if sorted(order) != list(range(rank)):
+        raise ValueError(f"order of a block pointer must be a permutation of range({rank}), got {order}")
+    for d in block_shape:
+        if d <= 0 or d & (d - 1) != 0:
+            raise ValueError(f"block_shape of a block pointer must be powers of 2, got {block_shape}")
+    for x in shape + strides + offsets:
+        if x.type.is_block() or not x.type.scalar.is_int():
+            raise ValueError("shape, strides and offsets of a block pointer must be integer scalars")
+    offsets = [cast(o, tl.int32, builder) for o in offsets]
+    return tl.block_ptr(base, shape, strides, offsets, block_shape, order)
+
+
+def advance(base: tl.block_ptr,
+            offsets: List[tl.tensor],
+            builder: ir.builder) -> tl.block_ptr:
+    if not isinstance(base, tl.block_ptr):
+        raise ValueError("advance requires a block pointer")
+    if len(offsets) != len(base.offsets):
+        raise ValueError(f"advance requires {len(base.offsets)} offsets, got {len(offsets)}")
+    offsets = [add(o, cast(d, tl.int32, builder), builder) for o, d in zip(base.offsets, offsets)]
+    return tl.block_ptr(base.base, base.shape, base.strides, offsets, base.block_shape, base.order)
+
+
+def _block_ptr_range(ptr: tl.block_ptr, d: int, builder: ir.builder) -> tl.tensor:
+    # arange(0, block_shape[d]) along dimension `d` of the block
+    ret = arange(0, ptr.block_shape[d], builder)
+    for i in range(len(ptr.block_shape)):
+        if i != d:
+            ret = expand_dims(ret, i, builder)
+    return ret
+
+
+def _block_ptr_to_ptrs(ptr: tl.block_ptr,
+                       boundary_check: List[int],
+                       builder: ir.builder) -> Tuple[tl.tensor, Optional[tl.tensor]]:
+    rank = len(ptr.block_shape)
+    for d in boundary_check:
+        if not 0 <= d < rank:
+            raise ValueError(f"boundary_check dimension {d} is out of range for a block pointer of rank {rank}")
+    # The offsets of the block are folded into a scalar pointer to its first
+    # element, and the offsets of the elements don't depend on them, so that
+    # they are computed once outside of the loops advancing the block
+    base = ptr.base
+    elem_offsets = None
+    for d in range(rank):
+        base = add(base, mul(ptr.offsets[d], ptr.strides[d], builder), builder)
+        term = mul(_block_ptr_range(ptr, d, builder), ptr.strides[d], builder)
+        elem_offsets = term if elem_offsets is None else add(elem_offsets, term, builder)
+    ptrs = add(base, elem_offsets, builder)
+    ptrs = broadcast_impl_shape(ptrs, ptr.block_shape, builder)
+    mask = None
+    for d in sorted(set(boundary_check)):
+        idx = add(_block_ptr_range(ptr, d, builder), ptr.offsets[d], builder)
+        in_bounds = less_than(idx, ptr.shape[d], builder)
+        mask = in_bounds if mask is None else and_(mask, in_bounds, builder)
+    if mask is not None:
+        mask = broadcast_impl_shape(mask, ptr.block_shape, builder)
+    return ptrs, mask
+
+
+def load_block_ptr(ptr: tl.block_ptr,
+                   boundary_check: List[int],
+                   padding_option: str,
+                   cache_modifier: str,
+                   eviction_policy: str,
+                   is_volatile: bool,
+                   builder: ir.builder) -> tl.tensor:
+    if padding_option not in ["", "zero", "nan"]:
+        raise ValueError(f"Padding option must be \"zero\" or \"nan\", got {padding_option}")
+    ptrs, mask = _block_ptr_to_ptrs(ptr, boundary_check, builder)
+    other = None
+    if mask is not None and padding_option:
+        if padding_option == "nan" and not ptr.dtype.is_floating():
+            raise ValueError("Padding option \"nan\" requires a floating-point block pointer")
+        value = 0 if padding_option == "zero" else float('nan')
+        other = full(ptr.block_shape, value, ptr.dtype, builder)
+    return load(ptrs, mask, other, cache_modifier, eviction_policy, is_volatile, builder)
+
+
+def store_block_ptr(ptr: tl.block_ptr,
+                    val: tl.tensor,
+                    boundary_check: List[int],
+                    cache_modifier: str,
+                    eviction_policy: str,
+                    builder: ir.builder) -> tl.tensor:
+    ptrs, mask = _block_ptr_to_ptrs(ptr, boundary_check, builder)
+    return store(ptrs, val, mask, cache_modifier, eviction_policy, builder)
+
+
+def ragged_load(ptr: tl.tensor,
+                offsets: tl.tensor,
+                lengths: tl.tensor,
+                other: Optional[tl.tensor],
+                cache_modifier: str,
+                eviction_policy: str,
+                builder: ir.builder) -> tl.tensor:
+    if not ptr.type.is_block():
+        raise ValueError("ragged_load requires a block of pointers, got " + ptr.type.__repr__())
+    if not offsets.type.scalar.is_int() or not lengths.type.scalar.is_int():
+        raise ValueError("ragged_load requires integer offsets and lengths")
+    mask = less_than(offsets, lengths, builder)
+    ret = load(ptr, mask, other, cache_modifier, eviction_policy, False, builder)
+    ret.handle.set_attr("ragged", builder.get_unit_attr())
+    return ret
 
 
 def store(ptr: tl.tensor,
           val: tl.tensor,
           mask: Optional[tl.tensor],
+          cache_modifier: str,
+          eviction_policy: str,
           builder: ir.builder) -> tl.tensor:
     if not ptr.type.scalar.is_ptr():
         raise ValueError("Pointer argument of store instruction is " + ptr.type.__repr__())
@@ -818,13 +973,15 @@ def store(ptr: tl.tensor,
         ptr_ty = tl.pointer_type(elt_ty, ptr_ty.address_space)
         ptr = cast(ptr, ptr_ty, builder)
 
+    cache = _str_to_store_cache_modifier(cache_modifier)
+    eviction = _str_to_eviction_policy(eviction_policy)
     # cast to target data-type
     val = cast(val, elt_ty, builder)
     if not mask:
-        return tl.tensor(builder.create_store(ptr.handle, val.handle), tl.void)
+        return tl.tensor(builder.create_store(ptr.handle, val.handle, cache, eviction), tl.void)
     if not mask.type.scalar.is_bool():
         raise ValueError("Mask must have boolean scalar type")
-    return tl.tensor(builder.create_masked_store(ptr.handle, val.handle, mask.handle), tl.void)
+    return tl.tensor(builder.create_masked_store(ptr.handle, val.handle, mask.handle, cache, eviction), tl.void)
 
 #########
 # atomic
@@ -945,11 +1102,28 @@ def atomic_min(ptr: tl.tensor,
 def atomic_add(ptr: tl.tensor,
                val: tl.tensor,
                mask: tl.tensor,
+               warp_aggregate: bool,
                builder: ir.builder) -> tl.tensor:
     ptr, val, mask = atom_red_typechecking_impl(ptr, val, mask, 'add', builder)
     sca_ty = val.type.scalar
     op = ir.ATOMIC_OP.FADD if sca_ty.is_floating() else ir.ATOMIC_OP.ADD
-    return tl.tensor(builder.create_atomic_rmw(op, ptr.handle, val.handle, mask.handle), val.type)
+    ret = builder.create_atomic_rmw(op, ptr.handle, val.handle, mask.handle)
+    if warp_aggregate:
+        ret.set_attr("warp_aggregate", builder.get_unit_attr())
+    return tl.tensor(ret, val.type)
+
+
+def last_program(counter: tl.tensor, builder: ir.builder) -> tl.tensor:
+    if counter.type.is_block() or counter.type.scalar.element_ty is not tl.int32:
+        raise ValueError("last_program requires a scalar pointer to int32, got " + counter.type.__repr__())
+    one = tl.tensor(builder.get_int32(1), tl.int32)
+    counter, one, mask = atom_red_typechecking_impl(counter, one, None, 'add', builder)
+    ret = builder.create_atomic_rmw(ir.ATOMIC_OP.ADD, counter.handle, one.handle, mask.handle)
+    ret.set_attr("grid_sync", builder.get_unit_attr())
+    arrived = tl.tensor(ret, tl.int32)
+    num_programs = mul(mul(num_programs(0, builder), num_programs(1, builder), builder),
+                       num_programs(2, builder), builder)
+    return equal(arrived, sub(num_programs, one, builder), builder)
 
 
 def atomic_and(ptr: tl.tensor,
@@ -988,13 +1162,31 @@ def atomic_xchg(ptr: tl.tensor,
 # ===----------------------------------------------------------------------===//
 
 
+def _str_to_dot_precision(precision, allow_tf32):
+    if precision is None:
+        return allow_tf32, False
+    if precision == "ieee":
+        return False, False
+    if precision == "tf32":
+        return True, False
+    if precision == "tf32x3":
+        return True, True
+    raise ValueError(f"Dot precision {precision} not supported")
+
+
 def dot(lhs: tl.tensor,
         rhs: tl.tensor,
         allow_tf32: bool,
+        precision: str,
         builder: ir.builder) -> tl.tensor:
+    allow_tf32, tf32x3 = _str_to_dot_precision(precision, allow_tf32)
     assert lhs.type.is_block() and rhs.type.is_block()
     assert len(lhs.shape) == 2 and len(rhs.shape) == 2
-    assert lhs.shape[1].value == rhs.shape[0].value
+    if (lhs.type.scalar.is_fp16() or lhs.type.scalar.is_bf16()) and rhs.type.scalar.is_int8():
+        # weight-only quantized dot: int8 weights, or int4 pairs packed along K
+        assert lhs.shape[1].value in [rhs.shape[0].value, 2 * rhs.shape[0].value]
+    else:
+        assert lhs.shape[1].value == rhs.shape[0].value
     assert lhs.shape[0].value >= 16 and lhs.shape[1].value >= 16 \
         and rhs.shape[1].value >= 16,\
         "small blocks not supported!"
@@ -1008,7 +1200,7 @@ def dot(lhs: tl.tensor,
     N = rhs.type.shape[1]
     _0 = builder.create_splat(_0, [M, N])
     ret_ty = tl.block_type(ret_scalar_ty, [M, N])
-    return tl.tensor(builder.create_dot(lhs.handle, rhs.handle, _0, allow_tf32),
+    return tl.tensor(builder.create_dot(lhs.handle, rhs.handle, _0, allow_tf32, tf32x3),
                      ret_ty)
 
 
@@ -1116,6 +1308,110 @@ def xor_sum(input: tl.tensor, axis: int, builder: ir.builder) -> tl.tensor:
     return reduce_impl(input, axis, builder, "sum", ir.REDUCE_OP.XOR, ir.REDUCE_OP.XOR)
 
 
+def reduction(inputs: List[tl.tensor], axis: int, region_builder_fn, builder: ir.builder) -> Tuple[tl.tensor, ...]:
+    if not inputs or not all(t.type.is_block() for t in inputs):
+        raise ValueError("reduce requires one or more tensors")
+    shape = inputs[0].type.shape
+    if any(t.type.shape != shape for t in inputs):
+        raise ValueError("the operands of reduce must all have the same shape")
+    if axis < 0:
+        axis += len(shape)
+    if not 0 <= axis < len(shape):
+        raise ValueError(f"reduction axis {axis} is out of range for a tensor of rank {len(shape)}")
+    # the combine region is lowered on the LLVM types of the elements
+    for t in inputs:
+        if t.type.scalar.is_bf16() or t.type.scalar.is_fp8():
+            raise ValueError(f"reduce doesn't support {t.type.scalar}, cast the input to float32 first")
+    reduce_op = builder.create_generic_reduce([t.handle for t in inputs], axis)
+    insertion_point = builder.get_insertion_point()
+    region_builder_fn(reduce_op)
+    builder.restore_insertion_point(insertion_point)
+    assert reduce_op.verify()
+    ret_shape = shape[:axis] + shape[axis + 1:]
+
+    def wrap(handle, scalar_ty):
+        if not ret_shape:
+            return tl.tensor(handle, scalar_ty)
+        return tl.tensor(handle, tl.block_type(scalar_ty, ret_shape))
+    return tuple(wrap(reduce_op.get_result(i), t.type.scalar) for i, t in enumerate(inputs))
+
+
+def associative_scan(input: tl.tensor, axis: int, region_builder_fn, builder: ir.builder) -> tl.tensor:
+    if not input.type.is_block():
+        raise ValueError("associative_scan requires a tensor")
+    shape = input.type.shape
+    if axis < 0:
+        axis += len(shape)
+    if not 0 <= axis < len(shape):
+        raise ValueError(f"scan axis {axis} is out of range for a tensor of rank {len(shape)}")
+    scalar_ty = input.type.scalar
+    # the combine region is lowered on the LLVM types of the elements
+    if scalar_ty.is_bf16() or scalar_ty.is_fp8():
+        raise ValueError(f"associative_scan doesn't support {scalar_ty}, cast the input to float32 first")
+    scan_op = builder.create_scan(input.handle, axis)
+    insertion_point = builder.get_insertion_point()
+    region_builder_fn(scan_op)
+    builder.restore_insertion_point(insertion_point)
+    assert scan_op.verify()
+    return tl.tensor(scan_op.get_result(0), input.type)
+
+
+def cumsum(input: tl.tensor, axis: int, builder: ir.builder) -> tl.tensor:
+    scalar_ty = input.type.scalar
+    # as for `sum`, narrow integers are accumulated on 32-bits
+    if scalar_ty.is_int() and scalar_ty.int_bitwidth < 32:
+        input = cast(input, tl.int32, builder)
+    if scalar_ty is tl.bfloat16:
+        input = cast(input, tl.float32, builder)
+    scalar_ty = input.type.scalar
+
+    def make_combine_region(scan_op):
+        ir_scalar_ty = scalar_ty.to_ir(builder)
+        block = builder.create_block_with_parent(scan_op.get_region(0), [ir_scalar_ty] * 2)
+        lhs, rhs = [tl.tensor(block.arg(i), scalar_ty) for i in range(2)]
+        builder.create_scan_ret(add(lhs, rhs, builder).handle)
+    return associative_scan(input, axis, make_combine_region, builder)
+
+
+def sort(input: tl.tensor, axis: int, k, descending: bool, builder: ir.builder) -> tl.tensor:
+    if not input.type.is_block():
+        raise ValueError("sort requires a tensor")
+    shape = input.type.shape
+    if axis < 0:
+        axis += len(shape)
+    if not 0 <= axis < len(shape):
+        raise ValueError(f"sort axis {axis} is out of range for a tensor of rank {len(shape)}")
+    size = shape[axis]
+    if size & (size - 1) != 0:
+        raise ValueError(f"sort requires a power of 2 number of elements along the axis, got {size}")
+    if k is None:
+        k = size
+    if not 0 < k <= size or k & (k - 1) != 0:
+        raise ValueError(f"k must be a power of 2 no larger than {size}, got {k}")
+    scalar_ty = input.type.scalar
+    # elements are compared as signed integers or floats: other types are
+    # mapped to one of those, which preserves their order
+    if scalar_ty.is_fp8():
+        raise ValueError(f"sort doesn't support {scalar_ty}, cast the input to float16 first")
+    if scalar_ty.is_bf16():
+        return cast(sort(cast(input, tl.float32, builder), axis, k, descending, builder), scalar_ty, builder)
+    if scalar_ty.is_bool():
+        return cast(sort(cast(input, tl.int8, builder), axis, k, descending, builder), scalar_ty, builder)
+    if scalar_ty.is_int_unsigned():
+        if scalar_ty.int_bitwidth < 64:
+            wide_ty = tl.int32 if scalar_ty.int_bitwidth < 32 else tl.int64
+            return cast(sort(cast(input, wide_ty, builder), axis, k, descending, builder), scalar_ty, builder)
+        # flipping the sign bit maps the order of uint64 to the one of int64
+        sign_bit = tl.tensor(builder.get_int64(-2**63), tl.int64)
+        flipped = xor_(bitcast(input, tl.int64, builder), sign_bit, builder)
+        ret = sort(flipped, axis, k, descending, builder)
+        return bitcast(xor_(ret, sign_bit, builder), scalar_ty, builder)
+    ret_shape = list(shape)
+    ret_shape[axis] = k
+    ret_ty = tl.block_type(scalar_ty, ret_shape)
+    return tl.tensor(builder.create_sort(input.handle, axis, k, descending), ret_ty)
+
+
 # ===----------------------------------------------------------------------===
 #                               Math
 # ===----------------------------------------------------------------------===
@@ -1127,6 +1423,20 @@ def umulhi(x: tl.tensor, y: tl.tensor, builder: ir.builder) -> tl.tensor:
     return libdevice.mulhi(x, y, _builder=builder)
 
 
+def philox(offset: tl.tensor, seed_lo: tl.tensor, seed_hi: tl.tensor, n_rounds: int,
+           builder: ir.builder) -> tl.tensor:
+    if not offset.type.is_block() or not offset.type.scalar.is_int() or offset.type.scalar.int_bitwidth != 32:
+        raise ValueError(f"philox requires a tensor of 32-bit offsets, got {offset.type}")
+    shape = offset.type.get_block_shapes()
+    seeds = []
+    for seed in [seed_lo, seed_hi]:
+        if not seed.type.scalar.is_int() or seed.type.scalar.int_bitwidth != 32:
+            raise ValueError(f"philox requires 32-bit seeds, got {seed.type}")
+        seeds.append(broadcast_impl_shape(seed, shape, builder))
+    return tl.tensor(builder.create_philox(offset.handle, seeds[0].handle, seeds[1].handle, n_rounds),
+                     offset.type)
+
+
 def floor(x: tl.tensor, builder: ir.builder) -> tl.tensor:
     # FIXME(Keren): not portable, should be fixed
     from . import libdevice
@@ -1178,3 +1488,7 @@ def printf(prefix: str, args: List[tl.tensor], builder: ir.builder) -> tl.tensor
     for arg in args:
         new_args.append(arg.handle)
     return tl.tensor(builder.create_printf(prefix, new_args), tl.void)
+
+
+def profile_mark(name: str, is_end: bool, builder: ir.builder) -> tl.tensor:
+    return tl.tensor(builder.create_profile_mark(name, is_end), tl.void)
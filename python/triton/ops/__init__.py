@@ -1,12 +1,21 @@
 # from .conv import _conv, conv
 from . import blocksparse
+from .attention import _attention, attention
 from .cross_entropy import _cross_entropy, cross_entropy
-from .matmul import _matmul, matmul
+from .matmul import _matmul, _matmul_grouped, _matmul_persistent, matmul, matmul_grouped, matmul_persistent
+from .reduction import grid_reduce
 
 __all__ = [
     "blocksparse",
+    "_attention",
+    "attention",
     "_cross_entropy",
     "cross_entropy",
+    "grid_reduce",
     "_matmul",
+    "_matmul_grouped",
+    "_matmul_persistent",
     "matmul",
+    "matmul_grouped",
+    "matmul_persistent",
 ]
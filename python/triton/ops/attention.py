@@ -0,0 +1,252 @@
+"""
+Fused attention, after the Flash Attention algorithm
+(see: Dao et al., https://arxiv.org/pdf/2205.14135v2.pdf; Rabe and Staats https://arxiv.org/pdf/2112.05682v2.pdf)
+"""
+
+import torch
+
+import triton
+import triton.language as tl
+
+
+@triton.jit
+def _fwd_kernel(
+    Q, K, V, sm_scale, SEQ_LENS,
+    LSE, Out,
+    H, N_CTX,
+    BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr,
+    BLOCK_DMODEL: tl.constexpr, IS_CAUSAL: tl.constexpr,
+):
+    start_m = tl.program_id(0)
+    off_hz = tl.program_id(1)
+    # rows past the length of the sequence are padding
+    seq_len = N_CTX
+    if SEQ_LENS is not None:
+        seq_len = tl.load(SEQ_LENS + off_hz // H)
+    # initialize offsets
+    offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    offs_n = tl.arange(0, BLOCK_N)
+    offs_d = tl.arange(0, BLOCK_DMODEL)
+    off_q = (off_hz * N_CTX + offs_m[:, None]) * BLOCK_DMODEL + offs_d[None, :]
+    off_k = (off_hz * N_CTX + offs_n[None, :]) * BLOCK_DMODEL + offs_d[:, None]
+    off_v = (off_hz * N_CTX + offs_n[:, None]) * BLOCK_DMODEL + offs_d[None, :]
+    # Initialize pointers to Q, K, V
+    q_ptrs = Q + off_q
+    k_ptrs = K + off_k
+    v_ptrs = V + off_v
+    # running maximum and sum of the exponentials of each row
+    m_i = tl.zeros([BLOCK_M], dtype=tl.float32) - float("inf")
+    l_i = tl.zeros([BLOCK_M], dtype=tl.float32)
+    acc = tl.zeros([BLOCK_M, BLOCK_DMODEL], dtype=tl.float32)
+    # load q: it will stay in SRAM throughout
+    q = tl.load(q_ptrs, mask=offs_m[:, None] < seq_len, other=0.)
+    # only the columns up to the diagonal are needed with a causal mask
+    hi = seq_len
+    if IS_CAUSAL:
+        hi = tl.minimum((start_m + 1) * BLOCK_M, seq_len)
+    # loop over k, v and update accumulator; the loads of the next tiles are
+    # pipelined with the computations of the current ones
+    for start_n in range(0, hi, BLOCK_N):
+        offs_n_curr = start_n + offs_n
+        # -- compute qk ----
+        k = tl.load(k_ptrs, mask=offs_n_curr[None, :] < seq_len, other=0.)
+        qk = tl.zeros([BLOCK_M, BLOCK_N], dtype=tl.float32)
+        qk += tl.dot(q, k)
+        qk *= sm_scale
+        mask = offs_n_curr[None, :] < seq_len
+        if IS_CAUSAL:
+            mask = mask & (offs_m[:, None] >= offs_n_curr[None, :])
+        qk = tl.where(mask, qk, float("-inf"))
+        # -- online softmax: rescale what was accumulated to the new maximum
+        m_curr = tl.maximum(tl.max(qk, 1), m_i)
+        alpha = tl.exp(m_i - m_curr)
+        p = tl.exp(qk - m_curr[:, None])
+        l_i = l_i * alpha + tl.sum(p, 1)
+        acc *= alpha[:, None]
+        # update acc
+        v = tl.load(v_ptrs, mask=offs_n_curr[:, None] < seq_len, other=0.)
+        acc += tl.dot(p.to(v.dtype), v)
+        m_i = m_curr
+        # update pointers
+        k_ptrs += BLOCK_N * BLOCK_DMODEL
+        v_ptrs += BLOCK_N * BLOCK_DMODEL
+    # rematerialize offsets to save registers
+    start_m = tl.program_id(0)
+    offs_m = start_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    # padding rows are written as zeros
+    acc = tl.where(offs_m[:, None] < seq_len, acc / l_i[:, None], 0.)
+    # write back the logsumexp of the rows, from which the backward pass
+    # recomputes the probabilities
+    lse_ptrs = LSE + off_hz * N_CTX + offs_m
+    tl.store(lse_ptrs, m_i + tl.log(l_i), mask=offs_m < N_CTX)
+    # initialize pointers to output
+    off_o = (off_hz * N_CTX + offs_m[:, None]) * BLOCK_DMODEL + offs_d[None, :]
+    out_ptrs = Out + off_o
+    tl.store(out_ptrs, acc.to(Out.dtype.element_ty), mask=offs_m[:, None] < N_CTX)
+
+
+@triton.jit
+def _bwd_preprocess(
+    Out, DO, Delta, N_ROWS,
+    BLOCK_M: tl.constexpr, D_HEAD: tl.constexpr,
+):
+    off_m = tl.program_id(0) * BLOCK_M + tl.arange(0, BLOCK_M)
+    off_n = tl.arange(0, D_HEAD)
+    mask = off_m < N_ROWS
+    # load
+    o = tl.load(Out + off_m[:, None] * D_HEAD + off_n[None, :], mask=mask[:, None], other=0.).to(tl.float32)
+    do = tl.load(DO + off_m[:, None] * D_HEAD + off_n[None, :], mask=mask[:, None], other=0.).to(tl.float32)
+    # compute
+    delta = tl.sum(o * do, axis=1)
+    # write-back
+    tl.store(Delta + off_m, delta, mask=mask)
+
+
+@triton.jit
+def _bwd_kernel(
+    Q, K, V, sm_scale, SEQ_LENS, DO,
+    LSE, Delta,
+    DQ, DK, DV,
+    H, N_CTX,
+    BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr,
+    BLOCK_DMODEL: tl.constexpr, IS_CAUSAL: tl.constexpr,
+):
+    off_hz = tl.program_id(0)
+    seq_len = N_CTX
+    if SEQ_LENS is not None:
+        seq_len = tl.load(SEQ_LENS + off_hz // H)
+    # offset pointers for batch/head
+    off_qkv = off_hz * N_CTX * BLOCK_DMODEL
+    Q += off_qkv
+    K += off_qkv
+    V += off_qkv
+    DO += off_qkv
+    DQ += off_qkv
+    DK += off_qkv
+    DV += off_qkv
+    LSE += off_hz * N_CTX
+    Delta += off_hz * N_CTX
+    offs_d = tl.arange(0, BLOCK_DMODEL)
+    for start_n in range(0, seq_len, BLOCK_N):
+        offs_n = start_n + tl.arange(0, BLOCK_N)
+        mask_n = offs_n < seq_len
+        off_kv = offs_n[:, None] * BLOCK_DMODEL + offs_d[None, :]
+        # k and v stay in SRAM throughout
+        k = tl.load(K + off_kv, mask=mask_n[:, None], other=0.)
+        v = tl.load(V + off_kv, mask=mask_n[:, None], other=0.)
+        # initialize dv and dk
+        dv = tl.zeros([BLOCK_N, BLOCK_DMODEL], dtype=tl.float32)
+        dk = tl.zeros([BLOCK_N, BLOCK_DMODEL], dtype=tl.float32)
+        # rows above the diagonal don't attend to these columns
+        lo = 0
+        if IS_CAUSAL:
+            lo = start_n // BLOCK_M * BLOCK_M
+        # loop over rows
+        for start_m in range(lo, seq_len, BLOCK_M):
+            offs_m = start_m + tl.arange(0, BLOCK_M)
+            mask_m = offs_m < seq_len
+            off_qo = offs_m[:, None] * BLOCK_DMODEL + offs_d[None, :]
+            # recompute p = softmax(qk, dim=-1) from the logsumexp of the rows
+            q = tl.load(Q + off_qo, mask=mask_m[:, None], other=0.)
+            qk = tl.dot(q, tl.trans(k)) * sm_scale
+            mask = mask_n[None, :]
+            if IS_CAUSAL:
+                mask = mask & (offs_m[:, None] >= offs_n[None, :])
+            qk = tl.where(mask, qk, float("-inf"))
+            lse = tl.load(LSE + offs_m, mask=mask_m, other=0.)
+            p = tl.exp(qk - lse[:, None])
+            # compute dv
+            do = tl.load(DO + off_qo, mask=mask_m[:, None], other=0.)
+            dv += tl.dot(tl.trans(p.to(do.dtype)), do)
+            # compute ds = p * (dp - delta[:, None]), with dp = dot(do, v.T)
+            Di = tl.load(Delta + offs_m, mask=mask_m, other=0.)
+            dp = tl.dot(do, tl.trans(v)) - Di[:, None]
+            ds = p * dp * sm_scale
+            # compute dk = dot(ds.T, q)
+            dk += tl.dot(tl.trans(ds.to(q.dtype)), q)
+            # compute dq
+            dq = tl.load(DQ + off_qo, mask=mask_m[:, None], other=0.)
+            dq += tl.dot(ds.to(k.dtype), k)
+            tl.store(DQ + off_qo, dq, mask=mask_m[:, None])
+        # write-back
+        tl.store(DV + off_kv, dv.to(DV.dtype.element_ty), mask=mask_n[:, None])
+        tl.store(DK + off_kv, dk.to(DK.dtype.element_ty), mask=mask_n[:, None])
+
+
+class _attention(torch.autograd.Function):
+
+    @staticmethod
+    def forward(ctx, q, k, v, causal, sm_scale, seq_lens):
+        # shape constraints
+        assert q.shape == k.shape and k.shape == v.shape, "q, k and v must have the same shape"
+        Z, H, N_CTX, D_HEAD = q.shape
+        assert D_HEAD in {16, 32, 64, 128}
+        assert q.dtype in {torch.float16, torch.bfloat16}
+        if sm_scale is None:
+            sm_scale = D_HEAD ** -0.5
+        if seq_lens is not None:
+            assert seq_lens.shape == (Z,), "seq_lens must hold the length of each sequence of the batch"
+            seq_lens = seq_lens.to(device=q.device, dtype=torch.int32)
+        # the kernels assume (Z, H, N_CTX, D_HEAD) row-major tensors
+        q, k, v = q.contiguous(), k.contiguous(), v.contiguous()
+        BLOCK = 128
+        o = torch.empty_like(q)
+        lse = torch.empty((Z * H, N_CTX), device=q.device, dtype=torch.float32)
+        grid = (triton.cdiv(N_CTX, BLOCK), Z * H, 1)
+        num_warps = 4 if D_HEAD <= 64 else 8
+        _fwd_kernel[grid](
+            q, k, v, sm_scale, seq_lens,
+            lse, o,
+            H, N_CTX,
+            BLOCK_M=BLOCK, BLOCK_N=BLOCK,
+            BLOCK_DMODEL=D_HEAD, IS_CAUSAL=causal,
+            num_warps=num_warps, num_stages=2,
+        )
+        ctx.save_for_backward(q, k, v, o, lse)
+        ctx.seq_lens = seq_lens
+        ctx.sm_scale = sm_scale
+        ctx.causal = causal
+        return o
+
+    @staticmethod
+    def backward(ctx, do):
+        q, k, v, o, lse = ctx.saved_tensors
+        Z, H, N_CTX, D_HEAD = q.shape
+        BLOCK = 128 if D_HEAD <= 64 else 64
+        do = do.contiguous()
+        # dq is accumulated over the tiles of columns
+        dq = torch.zeros_like(q, dtype=torch.float32)
+        # the gradients of the padding columns are never written
+        dk = torch.zeros_like(k)
+        dv = torch.zeros_like(v)
+        delta = torch.empty_like(lse)
+        n_rows = Z * H * N_CTX
+        _bwd_preprocess[(triton.cdiv(n_rows, BLOCK), )](
+            o, do, delta, n_rows,
+            BLOCK_M=BLOCK, D_HEAD=D_HEAD,
+        )
+        _bwd_kernel[(Z * H, )](
+            q, k, v, ctx.sm_scale, ctx.seq_lens, do,
+            lse, delta,
+            dq, dk, dv,
+            H, N_CTX,
+            BLOCK_M=BLOCK, BLOCK_N=BLOCK,
+            BLOCK_DMODEL=D_HEAD, IS_CAUSAL=ctx.causal,
+            num_warps=8, num_stages=1,
+        )
+        return dq.to(q.dtype), dk, dv, None, None, None
+
+
+def attention(q, k, v, causal=False, sm_scale=None, seq_lens=None):
+    """
+    Computes :code:`softmax(q @ k.T * sm_scale) @ v` for tensors of shape
+    :code:`(batch, heads, seq_len, head_dim)`, without materializing the
+    attention matrix. Supports autograd.
+
+    :param causal: mask out the columns past the row (the future)
+    :param sm_scale: the scale of the logits, :code:`head_dim ** -0.5` by default
+    :param seq_lens: the lengths of the sequences of the batch, if they are
+        padded to :code:`seq_len`: the padding is neither attended to, nor
+        attends (its outputs and gradients are zeros)
+    """
+    return _attention.apply(q, k, v, causal, sm_scale, seq_lens)
@@ -1,3 +1,6 @@
+import hashlib
+from collections import OrderedDict
+
 import torch
 
 import triton
@@ -116,7 +119,7 @@ def sdd_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, widths, out=
 
 
 def sdd_lut(layout, block, device):
-    lut = layout.nonzero(as_tuple=False).to(device).int()
+    lut = layout.to(device).nonzero(as_tuple=False).int()
     lut = lut.contiguous()
     return lut, None
 
@@ -153,20 +156,15 @@ def _dsd_kernel(
     off_h = tl.load(header + 3)
     pinc = lut + offset
     # initialize pointers to A (sparse)
-    block_id = tl.load(pinc + 1)
-    block_id = tl.multiple_of(block_id, 8)  # compiler hint
     offs_am = tl.arange(0, TILE_M)
     offs_ak = tl.arange(0, TILE_K)
     pa = A + pidz * stride_az \
-        + block_id * stride_ha \
         + offs_am[:, None] * stride_am \
         + offs_ak[None, :] * stride_ak
     # initialize pointers to B (dense)
     offs_bn = pid_m * TILE_N + tl.arange(0, TILE_N)
     offs_bn = tl.max_contiguous(tl.multiple_of(offs_bn % DS0, TILE_N), TILE_N)
-    start_bk = tl.load(pinc)
-    start_bk = tl.multiple_of(start_bk, 8)  # compiler hint
-    offs_bk = start_bk + tl.arange(0, TILE_K)
+    offs_bk = tl.arange(0, TILE_K)
     pb = B + pidz * stride_zb \
         + off_h * stride_hb \
         + offs_bn[None, :] * stride_bn \
@@ -174,23 +172,18 @@ def _dsd_kernel(
     # ---------------- #
     #    Inner Loop    #
     # ---------------- #
+    # the look-up table holds the absolute offsets of the tiles of each
+    # iteration, so their loads don't depend on those of the previous ones
     acc = tl.zeros((TILE_M, TILE_N), dtype=tl.float32)
-    pinc += 2
-    inc_a = tl.load(pinc + 1)
-    inc_a = tl.multiple_of(inc_a, 8)
-    inc_b = tl.load(pinc)
-    inc_b = tl.multiple_of(inc_b, 8)
-    for k in range(K, 0, -TILE_K):
-        a = tl.load(pa, mask=True)
-        b = tl.load(pb, mask=offs_bn[None, :] < DS0)
+    for k in range(0, K, TILE_K):
+        start_bk = tl.load(pinc)
+        start_bk = tl.multiple_of(start_bk, 8)  # compiler hint
+        block_id = tl.load(pinc + 1)
+        start_ak = start_bk % BLOCK
+        a = tl.load(pa + block_id * stride_ha + start_ak * stride_ak, mask=True)
+        b = tl.load(pb + start_bk * stride_bk, mask=offs_bn[None, :] < DS0)
         acc += tl.dot(a, b)
-        pa += inc_a
-        pb += inc_b * stride_bk
         pinc += 2
-        inc_a = tl.load(pinc + 1)
-        inc_a = tl.multiple_of(inc_a, 8)
-        inc_b = tl.load(pinc)
-        inc_b = tl.multiple_of(inc_b, 8)
     c = acc.to(C.dtype.element_ty)
     # initialize pointers to C
     offs_cm = column * TILE_M + tl.arange(0, TILE_M)
@@ -241,100 +234,72 @@ def dsd_matmul(a, b, trans_a, trans_b, trans_c, spdims, block, lut, width, out=N
     return c
 
 
+@triton.jit
+def _dsd_lut_kernel(
+    LUT, COLUMNS, BLOCK_IDS, num_steps,
+    DIV: tl.constexpr, STEP: tl.constexpr, BLOCK: tl.constexpr,
+    TILE: tl.constexpr,
+):
+    # each nonzero block is reduced over in DIV steps of STEP
+    offs = tl.program_id(0) * TILE + tl.arange(0, TILE)
+    mask = offs < num_steps
+    nnz = offs // DIV
+    column = tl.load(COLUMNS + nnz, mask=mask, other=0)
+    block_id = tl.load(BLOCK_IDS + nnz, mask=mask, other=0)
+    tl.store(LUT + 2 * offs, column * BLOCK + (offs % DIV) * STEP, mask=mask)
+    tl.store(LUT + 2 * offs + 1, block_id, mask=mask)
+
+
 def dsd_lut(layout, block, step, trans, device):
     """
-    Generates the look-up table for incrementing pointers in the DSD/DDS matmul.
-    Example (BLOCK=32, STEP=16)
+    Generates, on device, the look-up table of the offsets of the tiles of the
+    DSD/DDS matmul. Example (BLOCK=32, STEP=16)
     [[1, 0, 0, 1, 0],
      [0, 1, 1, 0, 1],
      [1, 0, 1, 0, 0]]
 
-    Then the offsets for A are
-     [0 , 16, 32, 48] <- row 0
-      \\----/  \\----/
-      col=0   col=3
-     [64, 80, 96, 112, 128, 144] <- row 1
-      \\----/   \\----/  \\------/
-       col=1    col=2    col=3
-     [160, 176, 192, 208]
-    which leads to increments table
-    [0, 16, 16, 16, || 64, 16, 16, 16, 16, 16, || 160, 16, 16, 16]
-
-    Because B is dense, the offsets are
-    [0, 16, 96, 112] <- row 0
-    [32, 48, 64, 80]  <- row 1
-    [0, 16, 64, 80]   <- row 2
+    Without transposition, the output has a column for each column of the
+    layout, which is reduced over the nonzero blocks of that column (in the
+    order of the rows). Each block takes block // step iterations, which read
+    - the dense input at row `row * BLOCK + i * STEP`: for column 0,
+      [0, 16, 64, 80]
+    - the sparse input at the index of the block (plus the same offset
+      modulo BLOCK): for column 0, [0, 0, 5, 5]
+    and the header of each column of the output holds the offset of its
+    iterations in the table, their number (times STEP), the column and the
+    head.
     """
-    sizes = torch.sum(layout, 2 if trans else 1)
-    head_id, col_id = torch.ones_like(sizes).nonzero(as_tuple=True)
-    sizes = sizes.flatten()
-    segments = sizes * step
-    # pointer increments
-    if trans:
-        nnz = layout.nonzero(as_tuple=False)
-    else:
-        nnz = layout.transpose(1, 2).nonzero(as_tuple=False)
-    num_blocks = nnz.size(0)
-    offsets = torch.zeros_like(sizes)
-    offsets[1:] = torch.cumsum(sizes[:-1], dim=0)
-    offsets = torch.min(offsets, (num_blocks - 1) * torch.ones_like(offsets))
-    # -------------------------------
-    # dense input pointer increments
-    # -------------------------------
-    # Note that the inner loop matmul kernel may have a fixed step size (e.g., TILE_K)
-    # that is smaller than the block size, so we need to do a bit of extra work
-    # to handle this case
-    B_idx = nnz[:, 2] * block
-    B_incs = B_idx.clone()
-    B_incs[1:] -= B_idx[:-1]
+    layout = layout.to(device)
+    # the blocks of the sparse input are stored in the order of the layout
+    block_ids = torch.cumsum(layout.flatten(), dim=0).view(layout.shape) - 1
+    if not trans:
+        layout = layout.transpose(1, 2)
+        block_ids = block_ids.transpose(1, 2)
+    H, width_per_head = layout.shape[0], layout.shape[1]
+    sizes = torch.sum(layout, 2).flatten().long()
+    nnz = layout.nonzero(as_tuple=True)
+    columns = nnz[2].int().contiguous()
+    block_ids = block_ids[nnz].int().contiguous()
+    num_blocks = columns.numel()
     div = block // step
-    B_incs = B_incs.view(-1, 1).repeat(1, div)
-    B_incs[:, 1:] = step
-    B_incs[:, 0] -= (div - 1) * step
-    # first increment for each reduction is actually the offset
-    B_incs[offsets[segments > 0], 0] = B_idx[offsets[segments > 0]]
-    B_incs = B_incs.view(-1)
-    # -------------------------------
-    # sparse input pointer increments
-    # -------------------------------
-    # same as above, except that the increments are in the sparse memory layout
-    if trans:
-        A_idx = torch.arange(num_blocks, device=layout.device)
-    else:
-        A_idx = torch.tensor([], dtype=torch.int64, device=layout.device)
-        current_offset = 0
-        for z in range(layout.size(0)):
-            layoutw = layout[z, :, :].clone().long()
-            msum = layoutw.sum()
-            layoutw[layoutw > 0] = 1 + torch.arange(msum, device=layout.device)
-            A_idx = torch.cat((A_idx, current_offset + layoutw.T[layoutw.T > 0] - 1))
-            current_offset += msum
-    A_incs = A_idx * block * block
-    A_incs[1:] -= A_idx[:-1] * block * block
-    A_incs = A_incs.view(-1, 1).repeat(1, div)
-    if trans:
-        A_incs[:, 1:] = step
-        A_incs[:, 0] -= (div - 1) * step
-    else:
-        A_incs[:, 1:] = step * block
-        A_incs[:, 0] -= (div - 1) * step * block
-    A_incs[offsets[segments > 0], 0] = A_idx[offsets[segments > 0]]
-    A_incs = A_incs.view(-1)
     # create header
-    width = col_id.size(0)
-    offsets = offsets * 2 * div + 4 * width
-    segments = segments * div
-    header = torch.stack((offsets, segments, col_id, head_id), dim=1).view(-1).contiguous()
-    # create increments
-    incs = torch.stack((B_incs, A_incs), dim=1).view(-1).contiguous()
-    # pad by a factor 2*MAX_NUM_STAGES
-    # to accommodate pre-fetching inside the kernel
-    pad = torch.zeros(20, device=incs.device, dtype=incs.dtype)
-    incs = torch.cat((incs, pad))
-    # create lut
-    lut = torch.cat((header, incs))
-    lut = lut.type(torch.int32).to(device)
-    # create locks
+    width = H * width_per_head
+    offsets = torch.zeros_like(sizes)
+    offsets[1:] = torch.cumsum(sizes[:-1], dim=0)
+    offsets = torch.clamp(offsets, max=max(num_blocks - 1, 0))
+    col_id = torch.arange(width_per_head, device=device).repeat(H)
+    head_id = torch.arange(H, device=device).repeat_interleave(width_per_head)
+    header = torch.stack((offsets * 2 * div + 4 * width, sizes * block, col_id, head_id), dim=1)
+    header = header.view(-1).int()
+    # create offsets, padded to accommodate pre-fetching inside the kernel
+    num_steps = num_blocks * div
+    lut = torch.zeros(4 * width + 2 * num_steps + 20, dtype=torch.int32, device=device)
+    lut[:4 * width] = header
+    if num_steps > 0:
+        TILE = 1024
+        grid = (triton.cdiv(num_steps, TILE), )
+        _dsd_lut_kernel[grid](lut[4 * width:], columns, block_ids, num_steps,
+                              DIV=div, STEP=step, BLOCK=block, TILE=TILE)
     return lut, width
 
 # -----------------------------
@@ -400,6 +365,37 @@ class _matmul(torch.autograd.Function):
             None, None, None, None, None, dout
 
 
+# look-up tables, keyed by the hash of their layout
+_lut_cache = OrderedDict()
+_LUT_CACHE_SIZE = 64
+
+
+def make_luts(layout, block, mode, trans_a, trans_b, device):
+    key = (mode, block, trans_a, trans_b, str(device), tuple(layout.shape),
+           hashlib.sha1(layout.cpu().bool().numpy().tobytes()).hexdigest())
+    if key in _lut_cache:
+        _lut_cache.move_to_end(key)
+        return _lut_cache[key]
+    step = min(block, 32)
+    if mode == 'sdd':
+        c_lut, c_width = sdd_lut(layout, block, device)
+        da_lut, da_width = dsd_lut(layout, block, step, True, device)
+        db_lut, db_width = dsd_lut(layout, block, step, False, device)
+    if mode == 'dsd':
+        c_lut, c_width = dsd_lut(layout, block, step, not trans_a, device)
+        da_lut, da_width = sdd_lut(layout, block, device)
+        db_lut, db_width = dsd_lut(layout, block, step, trans_a, device)
+    if mode == 'dds':
+        c_lut, c_width = dsd_lut(layout, block, step, trans_b, device)
+        da_lut, da_width = dsd_lut(layout, block, step, not trans_b, device)
+        db_lut, db_width = sdd_lut(layout, block, device)
+    luts = (c_lut, c_width, da_lut, da_width, db_lut, db_width)
+    _lut_cache[key] = luts
+    if len(_lut_cache) > _LUT_CACHE_SIZE:
+        _lut_cache.popitem(last=False)
+    return luts
+
+
 class matmul:
 
     def __init__(self, layout, block, mode, device, trans_a=False, trans_b=False, trans_c=False):
@@ -412,19 +408,8 @@ class matmul:
         self.trans_c = trans_c
         self.layout = layout
         self.spdims = layout.shape
-        step = min(block, 32)
-        if self.mode == 'sdd':
-            self.c_lut, self.c_width = sdd_lut(layout, block, device)
-            self.da_lut, self.da_width = dsd_lut(layout, block, step, True, device)
-            self.db_lut, self.db_width = dsd_lut(layout, block, step, False, device)
-        if self.mode == 'dsd':
-            self.c_lut, self.c_width = dsd_lut(layout, block, step, not self.trans_a, device)
-            self.da_lut, self.da_width = sdd_lut(layout, block, device)
-            self.db_lut, self.db_width = dsd_lut(layout, block, step, self.trans_a, device)
-        if self.mode == 'dds':
-            self.c_lut, self.c_width = dsd_lut(layout, block, step, self.trans_b, device)
-            self.da_lut, self.da_width = dsd_lut(layout, block, step, not self.trans_b, device)
-            self.db_lut, self.db_width = sdd_lut(layout, block, device)
+        self.c_lut, self.c_width, self.da_lut, self.da_width, self.db_lut, self.db_width = \
+            make_luts(layout, block, mode, trans_a, trans_b, device)
 
     def __call__(self, a, b, out=None):
         c = _matmul.apply(
@@ -3,6 +3,10 @@ import torch
 import triton
 import triton.language as tl
 
+# the vocabulary is processed in chunks of at most this many columns, so
+# that huge vocabularies don't spill the row to local memory
+MAX_BLOCK = 4096
+
 
 def next_power_of_2(n):
     n -= 1
@@ -15,57 +19,62 @@ def next_power_of_2(n):
     return n
 
 
-def num_warps(N):
-    if N < 2048:
+def block_size(N):
+    return min(next_power_of_2(N), MAX_BLOCK)
+
+
+def num_warps(BLOCK):
+    if BLOCK < 2048:
         return 4
-    elif N < 8192:
-        return 8
-    return 16
+    return 8
 
 
-@triton.heuristics({'num_warps': lambda nargs: num_warps(nargs['N'])})
-@triton.heuristics({'BLOCK': lambda nargs: next_power_of_2(nargs['N'])})
+@triton.heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@triton.heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
 @triton.jit
-def _forward(LOGITS, PROBS, IDX, LOSS, N, BLOCK: tl.constexpr):
+def _forward(LOGITS, LSE, IDX, LOSS, N, BLOCK: tl.constexpr):
     row = tl.program_id(0)
     cols = tl.arange(0, BLOCK)
+    LOGITS = LOGITS + row * N
+    # online logsumexp over the chunks of the row: `s` is the sum of the
+    # exponentials of the logits seen so far, relative to their maximum `m`
+    m = -float('inf')
+    s = 0.
+    for start in range(0, N, BLOCK):
+        mask = start + cols < N
+        logits = tl.load(LOGITS + start + cols, mask=mask, other=-float('inf'))
+        logits = logits.to(tl.float32)
+        m_new = tl.maximum(m, tl.max(logits, 0))
+        s = s * tl.exp(m - m_new) + tl.sum(tl.exp(logits - m_new), 0)
+        m = m_new
+    lse = m + tl.log(s)
+    # write-back the logsumexp, from which the backward pass recomputes the
+    # probabilities, and the loss
     idx = tl.load(IDX + row)
-    # pointers to logit and probs
-    LOGITS = LOGITS + row * N + cols
-    WRIT_PROBS = PROBS + row * N + cols
-    READ_PROBS = PROBS + row * N + idx
-    # write-back negative log-probs
-    logits = tl.load(LOGITS, mask=cols < N, other=-float('inf'))
-    logits = logits.to(tl.float32)
-    logits = logits - tl.max(logits, 0)
-    probs = tl.log(tl.sum(tl.exp(logits), 0)) - logits
-    tl.store(WRIT_PROBS, probs, mask=cols < N)
-    # There is a bug in the compiler, which fails to insert a barrier here.
-    # We add it explicitly for now. Will be fixed soon.
-    tl.debug_barrier()
-    # write-back loss
-    probs = tl.load(READ_PROBS)
-    tl.store(LOSS + row, probs)
-
-
-@triton.heuristics({'num_warps': lambda nargs: num_warps(nargs['N'])})
-@triton.heuristics({'BLOCK': lambda nargs: next_power_of_2(nargs['N'])})
+    logit = tl.load(LOGITS + idx).to(tl.float32)
+    tl.store(LSE + row, lse)
+    tl.store(LOSS + row, lse - logit)
+
+
+@triton.heuristics({'num_warps': lambda nargs: num_warps(block_size(nargs['N']))})
+@triton.heuristics({'BLOCK': lambda nargs: block_size(nargs['N'])})
 @triton.jit
-def _backward(PROBS, IDX, DPROBS, N, BLOCK: tl.constexpr):
+def _backward(LOGITS, LSE, IDX, DLOSS, DLOGITS, N, BLOCK: tl.constexpr):
     row = tl.program_id(0)
     cols = tl.arange(0, BLOCK)
     idx = tl.load(IDX + row)
-    # pointers to probs
-    PROBS = PROBS + row * N + cols
+    lse = tl.load(LSE + row)
+    dout = tl.load(DLOSS + row)
+    LOGITS = LOGITS + row * N
+    DLOGITS = DLOGITS + row * N
     # We know d(-log(p[i])/dlogit[k] = -id_mat[i,k] + p[k]
-    # and we have -log(p[k]) stored in PROBS, so this is easy
-    probs = -tl.load(PROBS, mask=cols < N, other=float('inf'))
-    probs = tl.exp(probs.to(tl.float32))
-    delta = cols == idx
-    # write result in-place in PROBS
-    dout = tl.load(DPROBS + row)
-    din = (probs - delta) * dout
-    tl.store(PROBS, din.to(PROBS.dtype.element_ty), mask=cols < N)
+    for start in range(0, N, BLOCK):
+        mask = start + cols < N
+        logits = tl.load(LOGITS + start + cols, mask=mask, other=0.)
+        probs = tl.exp(logits.to(tl.float32) - lse)
+        delta = start + cols == idx
+        din = (probs - delta) * dout
+        tl.store(DLOGITS + start + cols, din.to(DLOGITS.dtype.element_ty), mask=mask)
 
 
 class _cross_entropy(torch.autograd.Function):
@@ -73,33 +82,36 @@ class _cross_entropy(torch.autograd.Function):
     def forward(cls, ctx, logits, indices):
         # make sure we can use triton
         assert (indices.dtype == torch.int64), "Indices are expected to be of type long."
+        logits = logits.contiguous()
         # make kernel
         device, dtype = logits.device, logits.dtype
         n_cols = logits.shape[-1]
+        n_rows = logits.numel() // n_cols
         # run the kernel
         result = torch.empty_like(indices, dtype=dtype, device=device)
-        neg_logprobs = torch.empty_like(logits, dtype=dtype, device=device)
-        grid = lambda opt: (logits.numel() // n_cols, )
-        _forward[grid](logits, neg_logprobs, indices, result, n_cols)
-        # save for backward
-        ctx.save_for_backward(neg_logprobs, indices)
+        lse = torch.empty((n_rows, ), dtype=torch.float32, device=device)
+        grid = lambda opt: (n_rows, )
+        _forward[grid](logits, lse, indices, result, n_cols)
+        # save for backward: only the logsumexp of the rows is kept on top of
+        # the logits
+        ctx.save_for_backward(logits, indices, lse)
         return result
 
     @classmethod
-    def backward(cls, ctx, dneg_logprobs):
+    def backward(cls, ctx, dloss):
         """We know d(-log(p[i])/dlogit[k] = -id_mat[i,k] + p[k]
-        so we initialize the gradient as neg_logprobs, so we can just exponentiate
-        to get p[k], which is most of what we need...  neg_logprobs will be
-        modified in place to become the gradient we want
+        where p[k] = exp(logit[k] - logsumexp(logits)), so the probabilities
+        are recomputed chunk by chunk from the logsumexp saved by the forward
+        pass
         """
         # load saved tensors
-        neg_logprobs, indices = ctx.saved_tensors
+        logits, indices, lse = ctx.saved_tensors
         # run the kernel
-        # neg_logprobs will be modified in place to become our gradient:
-        n_cols = neg_logprobs.shape[-1]
-        grid = lambda opt: (neg_logprobs.numel() // n_cols, )
-        _backward[grid](neg_logprobs, indices, dneg_logprobs, n_cols)
-        return neg_logprobs, None
+        dlogits = torch.empty_like(logits)
+        n_cols = logits.shape[-1]
+        grid = lambda opt: (logits.numel() // n_cols, )
+        _backward[grid](logits, lse, indices, dloss.contiguous(), dlogits, n_cols)
+        return dlogits, None
 
 
 cross_entropy = _cross_entropy.apply
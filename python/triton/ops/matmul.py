@@ -2,13 +2,10 @@ import torch
 
 import triton
 import triton.language as tl
+from ..runtime.cost_model import KernelStats, get_device_properties, get_occupancy
 from .matmul_perf_model import early_config_prune, estimate_matmul_time
 
 
-def init_to_zero(name):
-    return lambda nargs: nargs[name].zero_()
-
-
 def get_configs_io_bound():
     configs = []
     for num_stages in [2, 3, 4, 5, 6]:
@@ -22,7 +19,7 @@ def get_configs_io_bound():
                     # split_k
                     for split_k in [2, 4, 8, 16]:
                         configs.append(triton.Config({'BLOCK_M': block_m, 'BLOCK_N': block_n, 'BLOCK_K': block_k, 'SPLIT_K': split_k},
-                                                     num_stages=num_stages, num_warps=num_warps, pre_hook=init_to_zero('C')))
+                                                     num_stages=num_stages, num_warps=num_warps))
     return configs
 
 
@@ -48,8 +45,12 @@ def get_configs_io_bound():
         triton.Config({'BLOCK_M': 64, 'BLOCK_N': 128, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=4, num_warps=4),
         triton.Config({'BLOCK_M': 128, 'BLOCK_N': 32, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=4, num_warps=4),
         triton.Config({'BLOCK_M': 64, 'BLOCK_N': 32, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=5, num_warps=2),
+        # deeper prefetching of the operands from shared memory
+        triton.Config({'BLOCK_M': 128, 'BLOCK_N': 128, 'BLOCK_K': 128, 'SPLIT_K': 1}, num_stages=4, num_warps=4, prefetch_width=64),
+        triton.Config({'BLOCK_M': 128, 'BLOCK_N': 64, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=4, num_warps=4, prefetch_width=32),
+        triton.Config({'BLOCK_M': 64, 'BLOCK_N': 128, 'BLOCK_K': 64, 'SPLIT_K': 1}, num_stages=4, num_warps=4, prefetch_width=32),
     ] + get_configs_io_bound(),
-    key=['M', 'N', 'K'],
+    key=['M', 'N', 'K', 'EPILOGUE'],
     prune_configs_by={
         'early_config_prune': early_config_prune,
         'perf_model': estimate_matmul_time,
@@ -60,10 +61,12 @@ def get_configs_io_bound():
     'EVEN_K': lambda args: args['K'] % (args['BLOCK_K'] * args['SPLIT_K']) == 0,
 })
 @triton.jit
-def _kernel(A, B, C, M, N, K,
+def _kernel(A, B, C, LOCKS, M, N, K,
             stride_am, stride_ak,
             stride_bk, stride_bn,
             stride_cm, stride_cn,
+            E0, E1, E2, E3,
+            EPILOGUE: tl.constexpr, NUM_EPILOGUE_ARGS: tl.constexpr,
             BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
             GROUP_M: tl.constexpr, SPLIT_K: tl.constexpr, EVEN_K: tl.constexpr,
             ACC_TYPE: tl.constexpr
@@ -99,26 +102,241 @@ def _kernel(A, B, C, M, N, K,
         acc += tl.dot(a, b)
         A += BLOCK_K * SPLIT_K * stride_ak
         B += BLOCK_K * SPLIT_K * stride_bk
-    acc = acc.to(C.dtype.element_ty)
     # rematerialize rm and rn to save registers
     rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
     rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    # fused epilogue; it is inlined and runs on the accumulator
+    # before it is written back to global memory
+    if EPILOGUE is not None:
+        if NUM_EPILOGUE_ARGS == 0:
+            acc = EPILOGUE(acc, rm, rn, M, N)
+        elif NUM_EPILOGUE_ARGS == 1:
+            acc = EPILOGUE(acc, rm, rn, M, N, E0)
+        elif NUM_EPILOGUE_ARGS == 2:
+            acc = EPILOGUE(acc, rm, rn, M, N, E0, E1)
+        elif NUM_EPILOGUE_ARGS == 3:
+            acc = EPILOGUE(acc, rm, rn, M, N, E0, E1, E2)
+        else:
+            acc = EPILOGUE(acc, rm, rn, M, N, E0, E1, E2, E3)
     C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
     mask = (rm < M)[:, None] & (rn < N)[None, :]
     # handles write-back with reduction-splitting
     if SPLIT_K == 1:
-        tl.store(C, acc, mask=mask)
+        tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
     else:
-        tl.atomic_add(C, acc, mask=mask)
+        # partial tiles are reduced into C in order of pid_z so that results
+        # are reproducible; the lock of each tile holds the pid_z whose turn
+        # it is and is reset to zero by the last one
+        LOCKS = LOCKS + pid
+        while tl.atomic_cas(LOCKS, pid_z, pid_z) != pid_z:
+            pass
+        if pid_z > 0:
+            acc += tl.load(C, mask=mask, other=0., cache_modifier=".cg").to(ACC_TYPE)
+        tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
+        # all the partial results of this program must be visible first
+        tl.debug_barrier()
+        tl.atomic_xchg(LOCKS, (pid_z + 1) % SPLIT_K)
+
+
+@triton.jit
+def _persistent_tile_coords(tile_id, M, N,
+                            BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, GROUP_M: tl.constexpr):
+    # re-order tile ID for better L2 performance
+    grid_m = (M + BLOCK_M - 1) // BLOCK_M
+    grid_n = (N + BLOCK_N - 1) // BLOCK_N
+    width = GROUP_M * grid_n
+    group_id = tile_id // width
+    group_size = min(grid_m - group_id * GROUP_M, GROUP_M)
+    pid_m = group_id * GROUP_M + (tile_id % group_size)
+    pid_n = (tile_id % width) // (group_size)
+    return pid_m, pid_n
+
+
+@triton.jit
+def _persistent_acc(A, B, M, N, K,
+                    stride_am, stride_ak,
+                    stride_bk, stride_bn,
+                    pid_m, pid_n, start_iter, end_iter,
+                    BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                    ACC_TYPE: tl.constexpr
+                    ):
+    # accumulates the K iterations [start_iter, end_iter) of output tile (pid_m, pid_n)
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    ram = tl.max_contiguous(tl.multiple_of(rm % M, BLOCK_M), BLOCK_M)
+    rbn = tl.max_contiguous(tl.multiple_of(rn % N, BLOCK_N), BLOCK_N)
+    rk = start_iter * BLOCK_K + tl.arange(0, BLOCK_K)
+    A = A + (ram[:, None] * stride_am + rk[None, :] * stride_ak)
+    B = B + (rk[:, None] * stride_bk + rbn[None, :] * stride_bn)
+    acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=ACC_TYPE)
+    for k in range(start_iter, end_iter):
+        k_remaining = K - k * BLOCK_K
+        a = tl.load(A, mask=tl.arange(0, BLOCK_K)[None, :] < k_remaining, other=0.)
+        b = tl.load(B, mask=tl.arange(0, BLOCK_K)[:, None] < k_remaining, other=0.)
+        acc += tl.dot(a, b)
+        A += BLOCK_K * stride_ak
+        B += BLOCK_K * stride_bk
+    return acc
+
+
+@triton.jit
+def _persistent_store(C, M, N, stride_cm, stride_cn, pid_m, pid_n, acc,
+                      BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr):
+    rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+    rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+    C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
+    mask = (rm < M)[:, None] & (rn < N)[None, :]
+    tl.store(C, acc.to(C.dtype.element_ty), mask=mask)
+
+
+@triton.jit
+def _persistent_tile(A, B, C, M, N, K,
+                     stride_am, stride_ak,
+                     stride_bk, stride_bn,
+                     stride_cm, stride_cn,
+                     tile_id, start_iter, end_iter,
+                     BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                     GROUP_M: tl.constexpr, ACC_TYPE: tl.constexpr
+                     ):
+    # computes the K iterations [start_iter, end_iter) of output tile `tile_id`
+    # and stores them
+    pid_m, pid_n = _persistent_tile_coords(tile_id, M, N, BLOCK_M, BLOCK_N, GROUP_M)
+    acc = _persistent_acc(A, B, M, N, K, stride_am, stride_ak, stride_bk, stride_bn,
+                          pid_m, pid_n, start_iter, end_iter, BLOCK_M, BLOCK_N, BLOCK_K, ACC_TYPE)
+    _persistent_store(C, M, N, stride_cm, stride_cn, pid_m, pid_n, acc, BLOCK_M, BLOCK_N)
+
+
+@triton.jit
+def _kernel_persistent(A, B, C, PARTIALS, COUNTERS, M, N, K,
+                       stride_am, stride_ak,
+                       stride_bk, stride_bn,
+                       stride_cm, stride_cn,
+                       BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                       GROUP_M: tl.constexpr, ACC_TYPE: tl.constexpr
+                       ):
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    total_tiles = tl.cdiv(M, BLOCK_M) * tl.cdiv(N, BLOCK_N)
+    iters_per_tile = tl.cdiv(K, BLOCK_K)
+    total_full_tiles = (total_tiles // num_programs) * num_programs
+    total_sk_iters = (total_tiles - total_full_tiles) * iters_per_tile
+    # data-parallel phase: full waves of tiles are distributed round-robin
+    # over the persistent programs
+    for tile_id in range(pid, total_full_tiles, num_programs):
+        _persistent_tile(A, B, C, M, N, K,
+                         stride_am, stride_ak, stride_bk, stride_bn, stride_cm, stride_cn,
+                         tile_id, 0, iters_per_tile,
+                         BLOCK_M, BLOCK_N, BLOCK_K, GROUP_M, ACC_TYPE)
+    # stream-k phase: the K iterations of the last partial wave are split
+    # evenly between all programs. The programs sharing a tile publish their
+    # partial accumulators and the last one to arrive adds them in program
+    # order, and rounds and stores the tile once: results are reproducible and
+    # no program waits on another, so they needn't be resident at once. Each
+    # program publishes at most two partial accumulators in PARTIALS, the end
+    # of its first tile in slot 2 * pid and the start of its last tile in slot
+    # 2 * pid + 1, and COUNTERS counts the arrivals on each stream-k tile
+    iters_per_pid = (total_sk_iters + num_programs - 1) // num_programs
+    start_iter = min(pid * iters_per_pid, total_sk_iters)
+    end_iter = min(start_iter + iters_per_pid, total_sk_iters)
+    rpm = tl.arange(0, BLOCK_M)
+    rpn = tl.arange(0, BLOCK_N)
+    partial_offs = rpm[:, None] * BLOCK_N + rpn[None, :]
+    it = start_iter
+    while it < end_iter:
+        sk_tile = it // iters_per_tile
+        tile_first = sk_tile * iters_per_tile
+        tile_last = tile_first + iters_per_tile
+        last = min(end_iter, tile_last)
+        pid_m, pid_n = _persistent_tile_coords(total_full_tiles + sk_tile, M, N, BLOCK_M, BLOCK_N, GROUP_M)
+        acc = _persistent_acc(A, B, M, N, K, stride_am, stride_ak, stride_bk, stride_bn,
+                              pid_m, pid_n, it - tile_first, last - tile_first,
+                              BLOCK_M, BLOCK_N, BLOCK_K, ACC_TYPE)
+        if it == tile_first and last == tile_last:
+            _persistent_store(C, M, N, stride_cm, stride_cn, pid_m, pid_n, acc, BLOCK_M, BLOCK_N)
+        else:
+            slot = 2 * pid
+            if it == tile_first:
+                slot += 1
+            tl.store(PARTIALS + slot * BLOCK_M * BLOCK_N + partial_offs, acc)
+            # the partial accumulator must be visible before the arrival
+            tl.debug_barrier()
+            first_pid = tile_first // iters_per_pid
+            last_pid = (tile_last - 1) // iters_per_pid
+            if tl.atomic_add(COUNTERS + sk_tile, 1) == last_pid - first_pid:
+                acc = tl.load(PARTIALS + (2 * first_pid + 1) * BLOCK_M * BLOCK_N + partial_offs,
+                              cache_modifier=".cg")
+                for next_pid in range(first_pid + 1, last_pid + 1):
+                    acc += tl.load(PARTIALS + 2 * next_pid * BLOCK_M * BLOCK_N + partial_offs,
+                                   cache_modifier=".cg")
+                _persistent_store(C, M, N, stride_cm, stride_cn, pid_m, pid_n, acc, BLOCK_M, BLOCK_N)
+        it = last
+
+
+# number of int64 fields of the descriptor of each problem of a grouped matmul
+GROUPED_DESC_SIZE = 9
+
+
+@triton.autotune(
+    configs=[
+        triton.Config({'BLOCK_M': 128, 'BLOCK_N': 128, 'BLOCK_K': 32}, num_stages=4, num_warps=4),
+        triton.Config({'BLOCK_M': 128, 'BLOCK_N': 64, 'BLOCK_K': 32}, num_stages=4, num_warps=4),
+        triton.Config({'BLOCK_M': 64, 'BLOCK_N': 128, 'BLOCK_K': 32}, num_stages=4, num_warps=4),
+        triton.Config({'BLOCK_M': 64, 'BLOCK_N': 64, 'BLOCK_K': 64}, num_stages=4, num_warps=4),
+        triton.Config({'BLOCK_M': 128, 'BLOCK_N': 256, 'BLOCK_K': 32}, num_stages=3, num_warps=8),
+        triton.Config({'BLOCK_M': 64, 'BLOCK_N': 32, 'BLOCK_K': 64}, num_stages=5, num_warps=2),
+    ],
+    key=['G', 'TOTAL_M', 'MAX_N', 'MAX_K'],
+)
+@triton.jit
+def _kernel_grouped(A, B, C, DESC, G, TOTAL_M, MAX_N, MAX_K,
+                    BLOCK_M: tl.constexpr, BLOCK_N: tl.constexpr, BLOCK_K: tl.constexpr,
+                    GROUP_M: tl.constexpr, ALIGN: tl.constexpr, ACC_TYPE: tl.constexpr
+                    ):
+    # the output tiles of all the problems are numbered one problem after the
+    # other and distributed round-robin over the persistent programs
+    pid = tl.program_id(0)
+    num_programs = tl.num_programs(0)
+    tile_id = pid
+    first_tile = 0
+    for g in range(0, G):
+        # offsets and leading dimensions are stored in units of ALIGN elements
+        # so that the compiler knows the alignment of the rows
+        desc = DESC + g * GROUPED_DESC_SIZE
+        M = tl.load(desc + 0).to(tl.int32)
+        N = tl.load(desc + 1).to(tl.int32)
+        K = tl.load(desc + 2).to(tl.int32)
+        problem_a = A + tl.load(desc + 3) * ALIGN
+        problem_b = B + tl.load(desc + 4) * ALIGN
+        problem_c = C + tl.load(desc + 5) * ALIGN
+        lda = tl.load(desc + 6).to(tl.int32) * ALIGN
+        ldb = tl.load(desc + 7).to(tl.int32) * ALIGN
+        ldc = tl.load(desc + 8).to(tl.int32) * ALIGN
+        num_tiles = tl.cdiv(M, BLOCK_M) * tl.cdiv(N, BLOCK_N)
+        while tile_id < first_tile + num_tiles:
+            _persistent_tile(problem_a, problem_b, problem_c, M, N, K,
+                             lda, 1, ldb, 1, ldc, 1,
+                             tile_id - first_tile, 0, tl.cdiv(K, BLOCK_K),
+                             BLOCK_M, BLOCK_N, BLOCK_K, GROUP_M, ACC_TYPE)
+            tile_id += num_programs
+        first_tile += num_tiles
 
 
 class _matmul(torch.autograd.Function):
     kernel = _kernel
 
-    _locks = dict()
+    # maximum number of extra arguments forwarded to an epilogue
+    max_epilogue_args = 4
 
     @staticmethod
-    def _call(a, b):
+    def _get_locks(device, size):
+        # split-k semaphores, one per output tile. Each launch gets its own
+        # zeroed buffer from the (stream-ordered) caching allocator: launches
+        # on other streams may run concurrently and must not share the turns
+        # of their tiles
+        return torch.zeros(size, device=device, dtype=torch.int32)
+
+    @staticmethod
+    def _call(a, b, epilogue=None, epilogue_args=()):
         device = a.device
         # handle non-contiguous inputs if necessary
         if a.stride(0) > 1 and a.stride(1) > 1:
@@ -127,24 +345,170 @@ class _matmul(torch.autograd.Function):
             b = b.contiguous()
         # checks constraints
         assert a.shape[1] == b.shape[0], "incompatible dimensions"
+        assert len(epilogue_args) <= _matmul.max_epilogue_args, \
+            f"at most {_matmul.max_epilogue_args} epilogue arguments are supported"
         M, K = a.shape
         _, N = b.shape
         # allocates output
         c = torch.empty((M, N), device=device, dtype=a.dtype)
         # accumulator types
         ACC_TYPE = tl.float32 if a.dtype in [torch.float16, torch.bfloat16, torch.float32] else tl.int32
+        # unused epilogue arguments are specialized away
+        num_epilogue_args = len(epilogue_args)
+        epilogue_args = list(epilogue_args) + [None] * (_matmul.max_epilogue_args - num_epilogue_args)
+        # enough locks for the smallest supported tiles
+        locks = _matmul._get_locks(device, triton.cdiv(M, 16) * triton.cdiv(N, 16))
         # launch kernel
         grid = lambda META: (triton.cdiv(M, META['BLOCK_M']) * triton.cdiv(N, META['BLOCK_N']), META['SPLIT_K'])
-        _kernel[grid](a, b, c, M, N, K,
+        _kernel[grid](a, b, c, locks, M, N, K,
                       a.stride(0), a.stride(1),
                       b.stride(0), b.stride(1),
                       c.stride(0), c.stride(1),
+                      *epilogue_args, epilogue, num_epilogue_args,
                       GROUP_M=8, ACC_TYPE=ACC_TYPE)
         return c
 
+    @staticmethod
+    def forward(ctx, a, b, epilogue=None, *epilogue_args):
+        """
+        Computes `a @ b`. If given, the `@triton.jit` function `epilogue` is
+        fused into the kernel and applied to each accumulator tile before it is
+        written back, as `acc = epilogue(acc, rm, rn, M, N, *epilogue_args)`:
+
+        - `acc` is the (BLOCK_M, BLOCK_N) accumulator in float32 (int32 for
+          integer inputs); it is cast to the output type afterwards,
+        - `rm` and `rn` are the row and column indices of the tile; they may
+          exceed `M` and `N` on the boundary, so loads must be masked,
+        - `epilogue_args` are up to 4 tensors or scalars forwarded unchanged,
+          e.g. a bias vector or a row-major residual.
+
+        Reductions in the epilogue only see the current tile. Split-k
+        configurations are not used when an epilogue is given.
+        """
+        return _matmul._call(a, b, epilogue, epilogue_args)
+
+
+class _matmul_persistent(torch.autograd.Function):
+    kernel = _kernel_persistent
+
+    @staticmethod
+    def _call(a, b, BLOCK_M=128, BLOCK_N=128, BLOCK_K=32, num_warps=4, num_stages=3, num_programs=None):
+        device = a.device
+        # handle non-contiguous inputs if necessary
+        if a.stride(0) > 1 and a.stride(1) > 1:
+            a = a.contiguous()
+        if b.stride(0) > 1 and b.stride(1) > 1:
+            b = b.contiguous()
+        # checks constraints
+        assert a.shape[1] == b.shape[0], "incompatible dimensions"
+        M, K = a.shape
+        _, N = b.shape
+        # accumulator types
+        ACC_TYPE = tl.float32 if a.dtype in [torch.float16, torch.bfloat16, torch.float32] else tl.int32
+        # empty products are zero, without entering the stream-k phase
+        if M == 0 or N == 0 or K == 0:
+            return torch.zeros((M, N), device=device, dtype=a.dtype)
+        c = torch.empty((M, N), device=device, dtype=a.dtype)
+        acc_dtype = torch.float32 if ACC_TYPE == tl.float32 else torch.int32
+        args = [M, N, K, a.stride(0), a.stride(1), b.stride(0), b.stride(1), c.stride(0), c.stride(1)]
+        kwargs = dict(BLOCK_M=BLOCK_M, BLOCK_N=BLOCK_N, BLOCK_K=BLOCK_K, GROUP_M=8, ACC_TYPE=ACC_TYPE,
+                      num_warps=num_warps, num_stages=num_stages)
+        # workspace of the stream-k phase, private to this launch: two partial
+        # accumulators per program and an arrival counter per stream-k tile
+        def workspace(num_programs):
+            partials = torch.empty((2 * num_programs, BLOCK_M, BLOCK_N), device=device, dtype=acc_dtype)
+            counters = torch.zeros(num_programs, device=device, dtype=torch.int32)
+            return partials, counters
+        device_id = torch.cuda.current_device()
+        num_sms = get_device_properties(device_id)["multiprocessor_count"]
+        partials, counters = workspace(num_sms)
+        if num_programs is None:
+            # one wave of programs, SMs x occupancy of the binary that is
+            # launched: the launch below hits the cache of this warmup since
+            # larger workspaces get the same specialization (fresh allocations
+            # below 2GB)
+            bin = _kernel_persistent.warmup(a, b, c, partials, counters, *args, grid=(1,), **kwargs)
+            num_programs = num_sms * max(get_occupancy(KernelStats.from_compiled(bin), device_id), 1)
+        # full waves of tiles are computed data-parallel and the remaining
+        # tiles are split along K (stream-k)
+        total_tiles = triton.cdiv(M, BLOCK_M) * triton.cdiv(N, BLOCK_N)
+        if total_tiles % num_programs != 0 and num_programs > num_sms:
+            partials, counters = workspace(num_programs)
+        # launch kernel
+        _kernel_persistent[(num_programs,)](a, b, c, partials, counters, *args, **kwargs)
+        return c
+
+    @staticmethod
+    def forward(ctx, a, b):
+        return _matmul_persistent._call(a, b)
+
+
+class _matmul_grouped(torch.autograd.Function):
+    kernel = _kernel_grouped
+
+    @staticmethod
+    def _alignment(tensors, elem_size):
+        # largest number of elements, up to 16 bytes, dividing the addresses
+        # and leading dimensions of all the operands
+        align = 16 // elem_size
+        while align > 1:
+            if all(t.data_ptr() % (align * elem_size) == 0 and t.stride(0) % align == 0 for t in tensors):
+                break
+            align //= 2
+        return max(align, 1)
+
+    @staticmethod
+    def _call(a, b):
+        # checks constraints
+        assert len(a) == len(b) and len(a) > 0, "expected as many left-hand sides as right-hand sides"
+        device, dtype = a[0].device, a[0].dtype
+        assert all(x.device == device and x.dtype == dtype for x in a + b), \
+            "all the operands must have the same type and device"
+        assert all(x.shape[1] == y.shape[0] for x, y in zip(a, b)), "incompatible dimensions"
+        # the kernel assumes row-major operands
+        a = [x if x.stride(1) == 1 else x.contiguous() for x in a]
+        b = [y if y.stride(1) == 1 else y.contiguous() for y in b]
+        # allocates outputs
+        c = [torch.empty((x.shape[0], y.shape[1]), device=device, dtype=dtype) for x, y in zip(a, b)]
+        # problems are scheduled by decreasing K, so that the last tiles of the
+        # round-robin, which determine when the launch ends, are the shortest
+        order = sorted(range(len(a)), key=lambda g: -a[g].shape[1])
+        # operands are addressed relative to the first one of each kind
+        elem_size = a[0].element_size()
+        align = _matmul_grouped._alignment(a + b + c, elem_size)
+        descs = []
+        for g in order:
+            M, K = a[g].shape
+            N = b[g].shape[1]
+            offsets = [(t.data_ptr() - base.data_ptr()) // (align * elem_size)
+                       for t, base in [(a[g], a[0]), (b[g], b[0]), (c[g], c[0])]]
+            descs.append([M, N, K] + offsets + [a[g].stride(0) // align, b[g].stride(0) // align,
+                                                c[g].stride(0) // align])
+        desc = torch.tensor(descs, dtype=torch.int64, device=device)
+        # accumulator types
+        ACC_TYPE = tl.float32 if dtype in [torch.float16, torch.bfloat16, torch.float32] else tl.int32
+        # one program per SM, or per tile if there are fewer
+        num_sms = triton.compiler.cuda_utils.get_device_properties(device.index)["multiprocessor_count"]
+        shapes = [(x.shape[0], y.shape[1]) for x, y in zip(a, b)]
+        total_tiles = lambda META: sum(triton.cdiv(M, META['BLOCK_M']) * triton.cdiv(N, META['BLOCK_N'])
+                                       for M, N in shapes)
+        grid = lambda META: (min(num_sms, total_tiles(META)),)
+        # launch kernel
+        _kernel_grouped[grid](a[0], b[0], c[0], desc, len(a),
+                              sum(M for M, _ in shapes), max(N for _, N in shapes), max(x.shape[1] for x in a),
+                              GROUP_M=8, ALIGN=align, ACC_TYPE=ACC_TYPE)
+        return c
+
     @staticmethod
     def forward(ctx, a, b):
-        return _matmul._call(a, b)
+        """
+        Computes `tuple(x @ y for x, y in zip(a, b))` in a single persistent launch,
+        e.g. for the experts of a mixture-of-experts layer. The (M, N, K)
+        problems may differ but all the operands must have the same type.
+        """
+        return tuple(_matmul_grouped._call(list(a), list(b)))
 
 
 matmul = _matmul.apply
+matmul_persistent = _matmul_persistent.apply
+matmul_grouped = _matmul_grouped.apply
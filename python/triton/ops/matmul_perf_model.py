@@ -4,6 +4,7 @@ import torch
 
 import triton
 import triton._C.libtriton.triton as _triton
+from triton.runtime import cost_model
 from triton.testing import get_dram_gbps, get_max_simd_tflops, get_max_tensorcore_tflops
 
 
@@ -32,52 +33,120 @@ def get_tflops(backend, device, num_ctas, num_warps, dtype):
     return get_tensorcore_tflops(backend, device, num_ctas, num_warps, dtype)
 
 
+def get_warps_per_tile(BLOCK_M, BLOCK_N, num_warps):
+    ''' mirror of the warp layout picked for mma v2 accumulators '''
+    ret = [1, 1]
+    while ret[0] * ret[1] < num_warps:
+        if BLOCK_M // 16 // ret[0] >= BLOCK_N // 16 // ret[1] and ret[0] < BLOCK_M // 16:
+            ret[0] *= 2
+        else:
+            ret[1] *= 2
+    return ret
+
+
+def estimate_shared_memory(BLOCK_M, BLOCK_N, BLOCK_K, num_stages, dtsize):
+    return (BLOCK_M + BLOCK_N) * BLOCK_K * num_stages * dtsize
+
+
+def estimate_registers(BLOCK_M, BLOCK_N, BLOCK_K, num_warps, dtsize):
+    ''' float32 accumulators, double-buffered operand fragments and addressing '''
+    num_threads = num_warps * 32
+    acc = BLOCK_M * BLOCK_N // num_threads
+    warps_m, warps_n = get_warps_per_tile(BLOCK_M, BLOCK_N, num_warps)
+    operands = 2 * (BLOCK_M // warps_m + BLOCK_N // warps_n) * 16 * dtsize // 4 // 32
+    return min(acc + operands + 32, 255)
+
+
 def estimate_matmul_time(
     # backend, device,
     num_warps, num_stages,
     A, B, C,
     M, N, K,
     BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K,
+    GROUP_M=8, kernel=None,
     debug=False, **kwargs
 ):
     ''' return estimated running time in ms
-          = max(compute, loading) + store '''
+          = max(compute, loading, shared memory) + store
+
+        `kernel` is the compiled binary of the config, if available; its
+        shared memory, registers, spills and op counts replace the estimates
+    '''
     backend = _triton.runtime.backend.CUDA
     device = torch.cuda.current_device()
     dtype = A.dtype
     dtsize = A.element_size()
+    props = cost_model.get_device_properties(device)
+    num_sm = props["multiprocessor_count"]
 
     num_cta_m = triton.cdiv(M, BLOCK_M)
     num_cta_n = triton.cdiv(N, BLOCK_N)
     num_cta_k = SPLIT_K
     num_ctas = num_cta_m * num_cta_n * num_cta_k
 
+    # resident CTAs per SM; configs that cannot run are never picked
+    if kernel is not None:
+        stats = cost_model.KernelStats.from_compiled(kernel)
+    else:
+        stats = cost_model.KernelStats(num_warps,
+                                       estimate_shared_memory(BLOCK_M, BLOCK_N, BLOCK_K, num_stages, dtsize),
+                                       estimate_registers(BLOCK_M, BLOCK_N, BLOCK_K, num_warps, dtsize))
+    ctas_per_sm = cost_model.get_occupancy(stats, device)
+    if ctas_per_sm == 0:
+        return float('inf')
+    ctas_per_wave = num_sm * ctas_per_sm
+    active_ctas = min(num_ctas, ctas_per_wave)
+    active_sms = min(num_sm, num_ctas)
+
     # If the input is smaller than the block size
     M, N = max(M, BLOCK_M), max(N, BLOCK_N)
 
-    # time to compute
+    # time to compute, the last partial wave takes as long as a full one
     total_ops = 2 * M * N * K / (1024 * 1024 * 1024)  # GOPS
-    tput = get_tflops(backend, device, num_ctas, num_warps, dtype)
-    compute_ms = total_ops / tput
+    tput = get_tflops(backend, device, active_ctas, num_warps, dtype)
+    compute_ms = total_ops / tput / cost_model.get_wave_efficiency(num_ctas, ctas_per_sm, device)
 
     # time to load data
-    num_sm = triton.compiler.cuda_utils.get_device_properties(device)["multiprocessor_count"]
-    active_cta_ratio = min(1, num_ctas / num_sm)
-    active_cta_ratio_bw1 = min(1, num_ctas / 32)  # 32 active ctas are enough to saturate
-    active_cta_ratio_bw2 = max(min(1, (num_ctas - 32) / (108 - 32)), 0)  # 32-108, remaining 5%
-    dram_bw = get_dram_gbps(backend, device) * (active_cta_ratio_bw1 * 0.95 + active_cta_ratio_bw2 * 0.05)  # in GB/s
-    l2_bw = dram_bw * 4  # rough estimation (should be 4.7 for A100?)
-    # assume 80% of (following) loads are in L2 cache
-    load_a_dram = M * K * dtsize * (1 + 0.2 * (num_cta_n - 1))
-    load_a_l2 = M * K * dtsize * 0.8 * (num_cta_n - 1)
-    load_b_dram = N * K * dtsize * (1 + 0.2 * (num_cta_m - 1))
-    load_b_l2 = N * K * dtsize * 0.8 * (num_cta_m - 1)
+    # programs are grouped by GROUP_M, so a wave of tiles reads a few row-panels
+    # of A and column-panels of B: once from DRAM, then from L2 for the other
+    # programs of the wave that share them
+    k_per_cta = K / SPLIT_K
+    wave_tiles = max(active_ctas // SPLIT_K, 1)
+    group_m = min(GROUP_M, num_cta_m)
+    wave_rows = min(num_cta_m, group_m * triton.cdiv(wave_tiles, group_m * num_cta_n))
+    wave_cols = min(num_cta_n, triton.cdiv(wave_tiles, group_m))
+    wave_unique = (wave_rows * BLOCK_M + wave_cols * BLOCK_N) * k_per_cta * dtsize
+    wave_total = wave_tiles * (BLOCK_M + BLOCK_N) * k_per_cta * dtsize
+    # panels evicted before they are reused are re-read from DRAM
+    l2_hit_rate = cost_model.get_l2_hit_rate(wave_unique * SPLIT_K, device)
+    num_waves = num_ctas / (wave_tiles * SPLIT_K)
+    load_dram = num_waves * SPLIT_K * (wave_unique + (wave_total - wave_unique) * (1 - l2_hit_rate))
+    load_l2 = num_waves * SPLIT_K * (wave_total - wave_unique) * l2_hit_rate
+    # spilled registers are stored and reloaded on every iteration
+    num_iters = triton.cdiv(int(k_per_cta), BLOCK_K)
+    load_l2 += 2 * stats.n_spills * 4 * num_warps * 32 * num_ctas * num_iters
+    # the stages in flight bound the bandwidth a SM can draw (latency hiding)
+    bytes_in_flight = max(num_stages - 1, 1) * (BLOCK_M + BLOCK_N) * BLOCK_K * dtsize
+    bytes_in_flight *= min(ctas_per_sm, triton.cdiv(num_ctas, num_sm))
+    dram_bw = min(get_dram_gbps(backend, device),
+                  cost_model.get_latency_bound_gbps(bytes_in_flight, active_sms, cost_model.DRAM_LATENCY_NS))  # in GB/s
+    l2_bw = min(get_dram_gbps(backend, device) * 4,  # rough estimation (should be 4.7 for A100?)
+                cost_model.get_latency_bound_gbps(bytes_in_flight, active_sms, cost_model.L2_LATENCY_NS))
     # total
-    total_dram = (load_a_dram + load_b_dram) / (1024 * 1024)  # MB
-    total_l2 = (load_a_l2 + load_b_l2) / (1024 * 1024)
+    total_dram = load_dram / (1024 * 1024)  # MB
+    total_l2 = load_l2 / (1024 * 1024)
     # loading time in ms
     load_ms = total_dram / dram_bw + total_l2 / l2_bw
 
+    # time to move operands through shared memory: each tile is written once,
+    # and read by every warp that shares its rows (resp. columns)
+    warps_m, warps_n = get_warps_per_tile(BLOCK_M, BLOCK_N, num_warps)
+    smem_bytes = num_ctas * k_per_cta * dtsize * (BLOCK_M * (warps_n + 1) + BLOCK_N * (warps_m + 1))
+    # layout conversions outside of the dot operands round trip the accumulator
+    num_cvts = stats.ops["triton_gpu.convert_layout"] - 2 * stats.ops["tt.dot"]
+    smem_bytes += max(num_cvts, 0) * 2 * M * N * 4
+    smem_ms = smem_bytes / (1024 * 1024) / cost_model.get_smem_gbps(device)
+
     # estimate storing time
     store_bw = dram_bw * 0.6  # :o
     store_c_dram = M * N * dtsize * SPLIT_K / (1024 * 1024)  # MB
@@ -86,15 +155,16 @@ def estimate_matmul_time(
     else:
         reduce_bw = store_bw
         store_ms = store_c_dram / reduce_bw
-        # c.zero_()
-        zero_ms = M * N * 2 / (1024 * 1024) / store_bw
-        store_ms += zero_ms
+        # partial tiles are read back in order, mostly from L2
+        load_c_l2 = M * N * dtsize * (SPLIT_K - 1) / (1024 * 1024)
+        store_ms += load_c_l2 / l2_bw
 
-    total_time_ms = max(compute_ms, load_ms) + store_ms
+    total_time_ms = max(compute_ms, load_ms, smem_ms) + store_ms
     if debug:
         print(f'Total time: {total_time_ms}ms, compute time: {compute_ms}ms, '
-              f'loading time: {load_ms}ms, store time: {store_ms}ms, '
-              f'Activate CTAs: {active_cta_ratio*100}%')
+              f'loading time: {load_ms}ms, shared memory time: {smem_ms}ms, '
+              f'store time: {store_ms}ms, '
+              f'Activate CTAs: {active_ctas / ctas_per_wave * 100}%')
     return total_time_ms
 
 
@@ -103,7 +173,6 @@ def early_config_prune(configs, named_args):
     capability = torch.cuda.get_device_capability()
     # BLOCK_M, BLOCK_N, BLOCK_K, SPLIT_K, num_warps, num_stages
     dtsize = named_args['A'].element_size()
-    dtype = named_args['A'].dtype
 
     # 1. make sure we have enough smem
     pruned_configs = []
@@ -112,16 +181,14 @@ def early_config_prune(configs, named_args):
         BLOCK_M, BLOCK_N, BLOCK_K, num_stages = \
             kw['BLOCK_M'], kw['BLOCK_N'], kw['BLOCK_K'], config.num_stages
 
-        # TODO: move to `cuda_utils` submodule
-        triton.compiler.init_cuda_utils()
-        max_shared_memory = triton.compiler.cuda_utils.get_device_properties(device)["max_shared_mem"]
-        required_shared_memory = (BLOCK_M + BLOCK_N) * BLOCK_K * num_stages * dtsize
+        max_shared_memory = cost_model.get_device_properties(device)["max_shared_mem"]
+        required_shared_memory = estimate_shared_memory(BLOCK_M, BLOCK_N, BLOCK_K, num_stages, dtsize)
         if required_shared_memory <= max_shared_memory:
             pruned_configs.append(config)
     configs = pruned_configs
 
-    # Some dtypes do not allow atomic_add
-    if dtype not in [torch.float16, torch.float32]:
+    # Fused epilogues cannot be applied to split-k partial sums
+    if named_args.get('EPILOGUE') is not None:
         configs = [config for config in configs if config.kwargs['SPLIT_K'] == 1]
 
     # group configs by (BLOCK_M,_N,_K, SPLIT_K, num_warps)
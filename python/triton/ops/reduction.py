@@ -0,0 +1,103 @@
+import torch
+
+import triton
+import triton.language as tl
+
+BLOCK = 1024
+# the last program reduces the partial results of all programs in a block,
+# which bounds the size of the grid
+MAX_PROGRAMS = 1024
+
+IDENTITY = {"sum": 0., "max": -float('inf'), "min": float('inf')}
+
+
+def next_power_of_2(n):
+    n -= 1
+    n |= n >> 1
+    n |= n >> 2
+    n |= n >> 4
+    n |= n >> 8
+    n |= n >> 16
+    n += 1
+    return n
+
+
+@triton.jit
+def _combine(a, b, OP: tl.constexpr):
+    if OP == "max":
+        c = tl.maximum(a, b)
+    elif OP == "min":
+        c = tl.minimum(a, b)
+    else:
+        c = a + b
+    return c
+
+
+@triton.jit
+def _reduce_block(x, OP: tl.constexpr):
+    if OP == "max":
+        r = tl.max(x, 0)
+    elif OP == "min":
+        r = tl.min(x, 0)
+    else:
+        r = tl.sum(x, 0)
+    return r
+
+
+@triton.jit
+def _grid_reduce(X, PARTIALS, COUNTER, OUT, N, OP: tl.constexpr, IDENTITY: tl.constexpr,
+                 BLOCK: tl.constexpr, NUM_PROGRAMS: tl.constexpr):
+    pid = tl.program_id(0)
+    offs = tl.arange(0, BLOCK)
+    # each program combines its blocks elementwise and then reduces the result,
+    # so that the order of the operations only depends on N
+    acc = tl.full([BLOCK], IDENTITY, tl.float32)
+    for start in range(pid * BLOCK, N, NUM_PROGRAMS * BLOCK):
+        x = tl.load(X + start + offs, mask=start + offs < N, other=IDENTITY)
+        acc = _combine(acc, x.to(tl.float32), OP)
+    tl.store(PARTIALS + pid, _reduce_block(acc, OP))
+    # the last program to finish reduces the partial results of all programs;
+    # they are read from L2 since L1 is not coherent across programs
+    if tl.last_program(COUNTER):
+        partials = tl.load(PARTIALS + tl.arange(0, NUM_PROGRAMS), cache_modifier=".cg")
+        tl.store(OUT, _reduce_block(partials, OP).to(OUT.dtype.element_ty))
+        tl.store(COUNTER, 0)
+
+
+class _grid_reduce_op:
+    # counters of the programs that finished, per device and stream. The last
+    # program resets its counter, so that they are only zeroed once.
+    counters = dict()
+
+    @classmethod
+    def _counter(cls, device):
+        stream = torch.cuda.current_stream(device).cuda_stream
+        key = (device.index, stream)
+        if key not in cls.counters:
+            cls.counters[key] = torch.zeros((1, ), dtype=torch.int32, device=device)
+        return cls.counters[key]
+
+    @classmethod
+    def forward(cls, x, op):
+        if op not in IDENTITY:
+            raise ValueError(f"unsupported reduction {op}, expected one of {list(IDENTITY)}")
+        x = x.contiguous()
+        N = x.numel()
+        num_programs = min(next_power_of_2(triton.cdiv(max(N, 1), BLOCK)), MAX_PROGRAMS)
+        partials = torch.empty((num_programs, ), dtype=torch.float32, device=x.device)
+        out = torch.empty((), dtype=x.dtype, device=x.device)
+        _grid_reduce[(num_programs, )](x, partials, cls._counter(x.device), out, N,
+                                       OP=op, IDENTITY=IDENTITY[op], BLOCK=BLOCK,
+                                       NUM_PROGRAMS=num_programs, num_warps=4)
+        return out
+
+
+def grid_reduce(x, op="sum"):
+    """
+    Reduces all the elements of :code:`x` with :code:`op` ("sum", "max" or "min")
+    in a single launch, without atomics on the result. The partial results of
+    the programs are combined by the last program to finish, in a fixed order,
+    so that the result is deterministic. Accumulates in float32 and returns a
+    0-d tensor of the type of :code:`x`.
+    """
+    return _grid_reduce_op.forward(x, op)
@@ -1,12 +1,19 @@
 from .autotuner import Config, Heuristics, autotune, heuristics
+from .graph import KernelGraph
 from .jit import JITFunction, KernelInterface, version_key
+from .search import SuccessiveHalving
+from .tuning_db import export_tuning_db, import_tuning_db
 
 __all__ = [
     "Config",
     "Heuristics",
     "autotune",
+    "export_tuning_db",
     "heuristics",
+    "import_tuning_db",
     "JITFunction",
+    "KernelGraph",
     "KernelInterface",
+    "SuccessiveHalving",
     "version_key",
 ]
@@ -1,27 +1,86 @@
 from __future__ import annotations
 
+import bisect
 import builtins
+import copy
+import os
+import threading
 import time
+import warnings
+from collections import defaultdict
+from concurrent.futures import ThreadPoolExecutor, as_completed
 from typing import Dict
 
+import torch
+
 from ..compiler import OutOfResources
-from ..testing import do_bench
-from .jit import KernelInterface
+from ..testing import Counters, do_bench
+from ..utils import next_power_of_2
+from . import tuning_db
+from .jit import JITFunction, KernelInterface
+from .search import _ms
+
+
+def make_bucket(spec):
+    '''
+    Returns the function mapping a runtime value to its bucket:
+    'pow2' rounds up to the next power of two, a sorted list of boundaries
+    rounds up to the next boundary (values past the last one are rounded to a
+    power of two), and callables are used as is.
+    '''
+    if callable(spec):
+        return spec
+    if spec == 'pow2':
+        return next_power_of_2
+    boundaries = sorted(spec)
+
+    def bucket(x):
+        i = bisect.bisect_left(boundaries, x)
+        return boundaries[i] if i < len(boundaries) else next_power_of_2(x)
+    return bucket
+
+
+def _despecialize(fn, indices):
+    '''
+    Returns a copy of the kernel `fn` (and of the heuristics wrapping it) that
+    isn't specialized on the arguments at `indices`. The copy has its own
+    launcher and binaries, so other launches of `fn` are left untouched.
+    '''
+    fn = copy.copy(fn)
+    if isinstance(fn, JITFunction):
+        fn.do_not_specialize = fn.do_not_specialize | indices
+        fn.cache = defaultdict(dict)
+        fn.pending = defaultdict(dict)
+        fn.run = fn._make_launcher()
+    else:
+        fn.fn = _despecialize(fn.fn, indices)
+    return fn
 
 
 class Autotuner(KernelInterface):
-    def __init__(self, fn, arg_names, configs, key, reset_to_zero, prune_configs_by: Dict = None):
+    def __init__(self, fn, arg_names, configs, key, reset_to_zero, prune_configs_by: Dict = None, buckets: Dict = None,
+                 counters: Counters = None, search=None, devices=None):
         '''
         :param prune_configs_by: a dict of functions that are used to prune configs, fields:
             'perf_model': performance model used to predicate running time with different configs, returns running time
             'top_k': number of configs to bench
             'prune_num_stages_by'(optional): a function used to prune num_stages. It take configs:List[Config] as its input, and returns pruned configs.
+            'compiled'(optional): if True, configs are compiled before the perf model is evaluated, and the model
+                                  is passed the binary as `kernel`
         '''
         if not configs:
             self.configs = [Config(dict(), num_warps=4, num_stages=2)]
         else:
             self.configs = configs
         self.key_idx = [arg_names.index(k) for k in key]
+        # values of bucketed arguments are mapped to a representative bucket
+        # before the lookup, and the autotuned copy of the kernel isn't
+        # specialized on them, so all the values of a bucket share a tuned
+        # config and a binary
+        buckets = dict() if buckets is None else buckets
+        self.buckets = {arg_names.index(k): make_bucket(v) for k, v in buckets.items()}
+        if self.buckets:
+            fn = _despecialize(fn, set(self.buckets))
         self.cache = dict()
         # hook to reset all required tensor to zeros before relaunching a kernel
         self.hook = lambda args: 0
@@ -38,13 +97,24 @@ class Autotuner(KernelInterface):
             perf_model, top_k = prune_configs_by['perf_model'], prune_configs_by['top_k']
             if 'early_config_prune' in prune_configs_by:
                 early_config_prune = prune_configs_by['early_config_prune']
+            compiled_perf_model = prune_configs_by.get('compiled', False)
         else:
-            perf_model, top_k, early_config_prune = None, None, None
+            perf_model, top_k, early_config_prune, compiled_perf_model = None, None, None, False
         self.perf_model, self.configs_top_k = perf_model, top_k
+        self.compiled_perf_model = compiled_perf_model
         self.early_config_prune = early_config_prune
         self.fn = fn
+        # hardware counters of the benchmarked configs, kept along their timings
+        self.counters = counters if counters is not None else Counters.from_env()
+        # strategy searching the configs, all of them are benchmarked in full if None
+        self.search = search
+        # GPUs the configs are benchmarked on concurrently
+        self.devices = devices
+        # relative difference of the timings of a config on two GPUs above
+        # which they are not considered comparable
+        self.device_tolerance = 0.05
 
-    def _bench(self, *args, config, **meta):
+    def _bench(self, *args, config, rep=100, **meta):
         # check for conflicts, i.e. meta-parameters both provided
         # as kwargs and by the autotuner
         conflicts = meta.keys() & config.kwargs.keys()
@@ -58,36 +128,192 @@ class Autotuner(KernelInterface):
 
         def kernel_call():
             if config.pre_hook:
-                config.pre_hook(self.nargs)
+                config.pre_hook(dict(zip(self.arg_names, args)))
             self.hook(args)
-            self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, **current)
+            self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages,
+                        prefetch_width=config.prefetch_width, pid_remap=config.pid_remap,
+                        max_registers=config.max_registers, min_blocks_per_sm=config.min_blocks_per_sm, **current)
         try:
-            return do_bench(kernel_call)
+            if self.counters is None:
+                return do_bench(kernel_call, warmup=rep / 4, rep=rep)
+            with self.counters.scope(f'{self._jit_fn().__name__}[{config}]'):
+                timing = do_bench(kernel_call, warmup=rep / 4, rep=rep)
+            self.configs_counters[config] = self.counters.last
+            return timing
         except OutOfResources:
             return float('inf')
 
+    def _precompile(self, device, *args, config, **meta):
+        # compiles `config` without launching it so that the benchmark
+        # only hits the kernel cache; errors are reported by `_bench`
+        current = dict(meta, **config.kwargs)
+        try:
+            with torch.cuda.device(device):
+                return self.fn.warmup(*args, num_warps=config.num_warps, num_stages=config.num_stages,
+                                      prefetch_width=config.prefetch_width, pid_remap=config.pid_remap,
+                                      max_registers=config.max_registers,
+                                      min_blocks_per_sm=config.min_blocks_per_sm, **current)
+        except Exception:
+            return None
+
+    def _compile_all(self, configs, *args, **kwargs):
+        num_threads = int(os.environ.get("TRITON_COMPILE_THREADS", min(32, os.cpu_count() or 1)))
+        device = torch.cuda.current_device()
+        with ThreadPoolExecutor(max_workers=max(num_threads, 1)) as executor:
+            futures = {config: executor.submit(self._precompile, device, *args, config=config, **kwargs)
+                       for config in configs}
+            return {config: future.result() for config, future in futures.items()}
+
+    def _bench_all(self, configs, *args, **kwargs):
+        num_threads = int(os.environ.get("TRITON_COMPILE_THREADS", min(32, os.cpu_count() or 1)))
+        if num_threads <= 1 or len(configs) <= 1:
+            return {config: self._bench(*args, config=config, **kwargs) for config in configs}
+        # compile all configs in a thread pool and benchmark each of them
+        # as soon as its compilation finishes
+        device = torch.cuda.current_device()
+        timings = dict()
+        with ThreadPoolExecutor(max_workers=num_threads) as executor:
+            futures = {executor.submit(self._precompile, device, *args, config=config, **kwargs): config
+                       for config in configs}
+            for future in as_completed(futures):
+                config = futures[future]
+                timings[config] = self._bench(*args, config=config, **kwargs)
+        return timings
+
+    def _tuning_devices(self):
+        devices = self.devices if self.devices is not None else os.environ.get("TRITON_AUTOTUNE_DEVICES")
+        current = torch.cuda.current_device()
+        # hardware counters are collected for one device at a time
+        if not devices or self.counters is not None:
+            return [current]
+        if devices == "all":
+            devices = range(torch.cuda.device_count())
+        elif isinstance(devices, str):
+            devices = [int(device) for device in devices.split(",")]
+        # timings are only comparable across GPUs of the same model
+        key = tuning_db.device_key(current)
+        return [current] + [device for device in devices
+                            if device != current and tuning_db.device_key(device) == key]
+
+    def _bench_devices(self, devices, configs, *args, **kwargs):
+        # each device benchmarks its own copy of the arguments
+        def to(device, arg):
+            return arg.to(device) if isinstance(arg, torch.Tensor) else arg
+        device_args = {device: ([to(device, arg) for arg in args], {k: to(device, v) for k, v in kwargs.items()})
+                       for device in devices}
+
+        def bench(device, config):
+            device_args_, device_kwargs = device_args[device]
+            with torch.cuda.device(device):
+                return self._bench(*device_args_, config=config, **device_kwargs)
+        # the GPUs are calibrated on the first config that runs, and those
+        # which are off by more than `device_tolerance` don't take part
+        timings = dict()
+        pending = list(configs)
+        config = None
+        while pending and (config is None or _ms(timings[config]) == float('inf')):
+            config = pending.pop(0)
+            timings[config] = bench(devices[0], config)
+        if pending and _ms(timings[config]) < float('inf'):
+            reference = _ms(timings[config])
+            with ThreadPoolExecutor(max_workers=len(devices) - 1) as executor:
+                calibration = dict(zip(devices[1:], executor.map(lambda device: bench(device, config), devices[1:])))
+            outliers = [device for device, timing in calibration.items()
+                        if abs(_ms(timing) - reference) > self.device_tolerance * reference]
+            if outliers:
+                warnings.warn(f"Timings of {config} on devices {outliers} differ from device {devices[0]} by more than "
+                              f"{self.device_tolerance:.0%}, they are not used for autotuning")
+            devices = [device for device in devices if device not in outliers]
+        # one worker per device takes the next config until there are none
+        lock = threading.Lock()
+
+        def worker(device):
+            results = dict()
+            while True:
+                with lock:
+                    if not pending:
+                        return results
+                    config = pending.pop(0)
+                results[config] = bench(device, config)
+        with ThreadPoolExecutor(max_workers=len(devices)) as executor:
+            for results in executor.map(worker, devices):
+                timings.update(results)
+        return timings
+
+    def _search_all(self, configs, *args, **kwargs):
+        num_threads = int(os.environ.get("TRITON_COMPILE_THREADS", min(32, os.cpu_count() or 1)))
+        device = torch.cuda.current_device()
+        with ThreadPoolExecutor(max_workers=max(num_threads, 1)) as executor:
+            def compile(configs):
+                futures = {executor.submit(self._precompile, device, *args, config=config, **kwargs): config
+                           for config in configs}
+                return ((futures[future], future.result() is not None) for future in as_completed(futures))
+
+            def bench(config, rep):
+                return self._bench(*args, config=config, rep=rep, **kwargs)
+            return self.search.run(configs, compile, bench)
+
     def run(self, *args, **kwargs):
         self.nargs = dict(zip(self.arg_names, args))
         if len(self.configs) > 1:
-            key = tuple(args[i] for i in self.key_idx)
+            key = tuple(self.buckets[i](args[i]) if i in self.buckets else args[i] for i in self.key_idx)
             if key not in self.cache:
-                # prune configs
-                pruned_configs = self.prune_configs(kwargs)
-                bench_start = time.time()
-                timings = {config: self._bench(*args, config=config, **kwargs)
-                           for config in pruned_configs}
-                bench_end = time.time()
-                self.bench_time = bench_end - bench_start
-                self.cache[key] = builtins.min(timings, key=timings.get)
-                self.hook(args)
-                self.configs_timings = timings
+                # results tuned by a previous run (or shipped pre-tuned)
+                config = self._lookup_db(key)
+                if config is None:
+                    # prune configs
+                    pruned_configs = self.prune_configs(kwargs)
+                    bench_start = time.time()
+                    self.configs_counters = dict()
+                    devices = self._tuning_devices() if self.search is None else []
+                    if len(devices) > 1 and len(pruned_configs) > 1:
+                        timings = self._bench_devices(devices, pruned_configs, *args, **kwargs)
+                        config = builtins.min(timings, key=lambda config: _ms(timings[config]))
+                    elif self.search is None:
+                        timings = self._bench_all(pruned_configs, *args, **kwargs)
+                        config = builtins.min(timings, key=timings.get)
+                    else:
+                        config, timings = self._search_all(pruned_configs, *args, **kwargs)
+                    bench_end = time.time()
+                    self.bench_time = bench_end - bench_start
+                    self.hook(args)
+                    self.configs_timings = timings
+                    self._record_db(key, config)
+                self.cache[key] = config
             config = self.cache[key]
         else:
             config = self.configs[0]
         self.best_config = config
         if config.pre_hook is not None:
             config.pre_hook(self.nargs)
-        return self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages, **kwargs, **config.kwargs)
+        return self.fn.run(*args, num_warps=config.num_warps, num_stages=config.num_stages,
+                           prefetch_width=config.prefetch_width, pid_remap=config.pid_remap,
+                           max_registers=config.max_registers, min_blocks_per_sm=config.min_blocks_per_sm,
+                           **kwargs, **config.kwargs)
+
+    def _jit_fn(self):
+        fn = self.fn
+        while not isinstance(fn, JITFunction):
+            fn = fn.fn
+        return fn
+
+    def _db_keys(self, key):
+        return self._jit_fn().cache_key, tuning_db.device_key(), repr(key)
+
+    def _lookup_db(self, key):
+        entry = tuning_db.get_tuning_db().lookup(*self._db_keys(key))
+        if entry is None:
+            return None
+        config = tuning_db.find_config(self.configs, entry)
+        # configs proposed by the search are rebuilt, with the pre-hook of
+        # the configs they were derived from when they all share one
+        pre_hooks = {config.pre_hook for config in self.configs}
+        if config is None and getattr(self.search, 'space', None) and len(pre_hooks) == 1:
+            config = tuning_db.config_from_dict(entry, pre_hook=pre_hooks.pop())
+        return config
+
+    def _record_db(self, key, config):
+        tuning_db.get_tuning_db().record(*self._db_keys(key), config)
 
     def prune_configs(self, kwargs):
         pruned_configs = self.configs
@@ -98,9 +324,16 @@ class Autotuner(KernelInterface):
             if isinstance(top_k, float) and top_k <= 1.0:
                 top_k = int(len(self.configs) * top_k)
             if len(pruned_configs) > top_k:
+                model_kwargs = {config: dict() for config in pruned_configs}
+                if self.compiled_perf_model:
+                    # compiled binaries give the model their actual shared memory,
+                    # register and op counts; configs that fail to compile are dropped
+                    kernels = self._compile_all(pruned_configs, *self.nargs.values(), **kwargs)
+                    pruned_configs = [config for config in pruned_configs if kernels[config] is not None]
+                    model_kwargs = {config: {'kernel': kernels[config]} for config in pruned_configs}
                 est_timing = {
                     config: self.perf_model(**self.nargs, **kwargs, **config.kwargs, num_stages=config.num_stages,
-                                            num_warps=config.num_warps)
+                                            num_warps=config.num_warps, **model_kwargs[config])
                     for config in pruned_configs
                 }
                 pruned_configs = sorted(est_timing.keys(), key=lambda x: est_timing[x])[:top_k]
@@ -113,6 +346,10 @@ class Autotuner(KernelInterface):
                 *args,
                 num_warps=config.num_warps,
                 num_stages=config.num_stages,
+                prefetch_width=config.prefetch_width,
+                pid_remap=config.pid_remap,
+                max_registers=config.max_registers,
+                min_blocks_per_sm=config.min_blocks_per_sm,
                 **kwargs,
                 **config.kwargs,
             )
@@ -131,14 +368,35 @@ class Config:
     :ivar num_stages: the number of stages that the compiler should use when software-pipelining loops.
                        Mostly useful for matrix multiplication workloads on SM80+ GPUs.
     :type num_stages: int
+    :ivar prefetch_width: the width along K of the slices of the operands of `tl.dot` that are loaded
+                          from shared memory ahead of the tensor core instructions consuming them. It
+                          must be a multiple of the K of one instruction (e.g., 16 for fp16 and 32 for
+                          int8) and divide `BLOCK_K`; 0 lets the compiler infer it.
+    :type prefetch_width: int
+    :ivar pid_remap: the order in which `tl.program_id(0)` and `tl.program_id(1)` enumerate the programs
+                     of a 2D grid: None for the order of the launch, "grouped-<n>" to sweep groups of n
+                     rows through all the columns for L2 reuse, or "morton" for a Z-order curve.
+    :type pid_remap: str
+    :ivar max_registers: the number of registers each thread may use, 0 to let ptxas choose. Fewer registers
+                         fit more CTAs on an SM at the cost of spills.
+    :type max_registers: int
+    :ivar min_blocks_per_sm: the number of CTAs that must fit on one SM at once, from which ptxas derives
+                             a register limit, 0 for no requirement. The occupancy reached is reported by
+                             the :code:`occupancy` of the compiled kernel.
+    :type min_blocks_per_sm: int
     :ivar pre_hook: a function that will be called before the kernel is called. Parameters of this
                     function are args.
     """
 
-    def __init__(self, kwargs, num_warps=4, num_stages=2, pre_hook=None):
+    def __init__(self, kwargs, num_warps=4, num_stages=2, prefetch_width=0, pre_hook=None, pid_remap=None,
+                 max_registers=0, min_blocks_per_sm=0):
         self.kwargs = kwargs
         self.num_warps = num_warps
         self.num_stages = num_stages
+        self.prefetch_width = prefetch_width
+        self.pid_remap = pid_remap
+        self.max_registers = max_registers
+        self.min_blocks_per_sm = min_blocks_per_sm
         self.pre_hook = pre_hook
 
     def __str__(self):
@@ -147,10 +405,19 @@ class Config:
             res.append(f'{k}: {v}')
         res.append(f'num_warps: {self.num_warps}')
         res.append(f'num_stages: {self.num_stages}')
+        if self.prefetch_width:
+            res.append(f'prefetch_width: {self.prefetch_width}')
+        if self.pid_remap is not None:
+            res.append(f'pid_remap: {self.pid_remap}')
+        if self.max_registers:
+            res.append(f'max_registers: {self.max_registers}')
+        if self.min_blocks_per_sm:
+            res.append(f'min_blocks_per_sm: {self.min_blocks_per_sm}')
         return ', '.join(res)
 
 
-def autotune(configs, key, prune_configs_by=None, reset_to_zero=None):
+def autotune(configs, key, prune_configs_by=None, reset_to_zero=None, buckets=None, counters=None, search=None,
+             devices=None):
     """
     Decorator for auto-tuning a :code:`triton.jit`'d function.
     .. highlight:: python
@@ -169,6 +436,10 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None):
            This means that whatever value the kernel updates will be updated multiple times.
            To avoid this undesired behavior, you can use the `reset_to_zero` argument, which
            reset the value of the provided tensor to `zero` before running any configuration.
+    :note: The best configuration for each key is persisted in an on-disk database (see
+           :code:`triton.runtime.tuning_db`), so it is only benchmarked once per kernel, device and key.
+           Databases can be moved between hosts with :code:`triton.runtime.export_tuning_db` and
+           :code:`triton.runtime.import_tuning_db`.
     :param configs: a list of :code:`triton.Config` objects
     :type configs: list[triton.Config]
     :param key: a list of argument names whose change in value will trigger the evaluation of all provided configs.
@@ -177,11 +448,30 @@ def autotune(configs, key, prune_configs_by=None, reset_to_zero=None):
         'perf_model': performance model used to predicate running time with different configs, returns running time
         'top_k': number of configs to bench
         'early_config_prune'(optional): a function used to do early prune (eg, num_stages). It take configs:List[Config] as its input, and returns pruned configs.
+        'compiled'(optional): compile configs before evaluating 'perf_model', which then receives the binary as `kernel`.
     :param reset_to_zero: a list of argument names whose value will be reset to zero before evaluating any configs.
     :type reset_to_zero: list[str]
+    :param buckets: a dict mapping names of `key` arguments to buckets ('pow2', a list of boundaries, or a function
+        of the value). Values of the same bucket are tuned once and share a binary, as the kernel is not
+        specialized on these arguments, e.g. :code:`buckets={'seq_len': 'pow2'}`.
+    :type buckets: dict[str, Any]
+    :param counters: hardware counters collected for each benchmarked config, available in :code:`configs_counters`
+        after tuning, along with :code:`configs_timings`. Defaults to the counters set by the
+        :code:`TRITON_BENCH_COUNTERS` environment variable (see :code:`triton.testing.Counters.from_env`).
+    :type counters: triton.testing.Counters
+    :param search: the strategy searching the configs, e.g. :code:`triton.runtime.SuccessiveHalving()` to stop
+        benchmarking the slowest configs early and propose new ones. All the configs are benchmarked in full if None.
+    :type search: triton.runtime.SuccessiveHalving
+    :param devices: the GPUs benchmarking the configs concurrently, one worker each: "all" or a list of indices.
+        Only the GPUs of the same model as the current one are used, and those whose timing of a first config
+        differs from the current one's by more than 5% are left out. Defaults to :code:`TRITON_AUTOTUNE_DEVICES`
+        ("all" or e.g. "0,1,2,3"), and to the current GPU only if unset. Doesn't apply to searches and to
+        autotuners collecting counters.
+    :type devices: str or list[int]
     """
     def decorator(fn):
-        return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, prune_configs_by)
+        return Autotuner(fn, fn.arg_names, configs, key, reset_to_zero, prune_configs_by, buckets, counters, search,
+                         devices)
 
     return decorator
 
@@ -198,6 +488,11 @@ class Heuristics(KernelInterface):
             kwargs[v] = heur({**dict(zip(self.arg_names, args)), **kwargs})
         return self.fn.run(*args, **kwargs)
 
+    def warmup(self, *args, **kwargs):
+        for v, heur in self.values.items():
+            kwargs[v] = heur({**dict(zip(self.arg_names, args)), **kwargs})
+        return self.fn.warmup(*args, **kwargs)
+
 
 def heuristics(values):
     """
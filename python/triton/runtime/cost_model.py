@@ -0,0 +1,122 @@
+from __future__ import annotations
+
+import functools
+import math
+import re
+from collections import Counter
+
+import torch
+
+import triton
+
+# latency of a global load, used to bound the bandwidth a given
+# number of bytes in flight can sustain (Little's law)
+DRAM_LATENCY_NS = 600
+L2_LATENCY_NS = 250
+# shared memory bandwidth of one SM
+SMEM_BYTES_PER_CLK = 128
+
+
+@functools.lru_cache()
+def get_device_properties(device):
+    triton.compiler.init_cuda_utils()
+    return triton.compiler.cuda_utils.get_device_properties(device)
+
+
+def get_max_ctas_per_sm(device):
+    capability = torch.cuda.get_device_capability(device)
+    # sm_75 and sm_86/89 only schedule 16 resident CTAs per SM
+    if capability in [(7, 5), (8, 6), (8, 9)]:
+        return 16
+    return 32
+
+
+def count_ops(ir):
+    '''
+    Returns a Counter of the operation names found in the textual IR `ir`,
+    e.g. `count_ops(kernel.asm["ttgir"])["tt.dot"]`.
+    '''
+    pattern = r'^\s*(?:%[^=]*=\s*)?"?([a-z_0-9]+\.[a-z_0-9.]+)'
+    return Counter(re.findall(pattern, ir, re.MULTILINE))
+
+
+class KernelStats:
+    '''
+    Resource usage of a kernel: shared memory comes from the allocation
+    analysis, registers and spills from ptxas and op counts from the TTGIR.
+    Performance models can build it from a compiled kernel, or from their
+    own estimates when the kernel has not been compiled yet.
+    '''
+
+    def __init__(self, num_warps, shared, n_regs, n_spills=0, ops=None, occupancy=None):
+        self.num_warps = num_warps
+        self.shared = shared
+        self.n_regs = n_regs
+        self.n_spills = n_spills
+        self.ops = Counter() if ops is None else ops
+        # CTAs resident on one SM as reported by the driver, if known
+        self.occupancy = occupancy
+
+    @staticmethod
+    def from_compiled(kernel):
+        # registers and spills are only known once the binary is loaded
+        kernel._init_handles()
+        ops = count_ops(kernel.asm["ttgir"]) if "ttgir" in kernel.asm else None
+        return KernelStats(kernel.num_warps, kernel.shared, kernel.n_regs,
+                           kernel.n_spills, ops, kernel.occupancy)
+
+
+def get_occupancy(stats, device):
+    ''' return the number of CTAs resident on one SM, 0 if it doesn't fit '''
+    if stats.occupancy is not None:
+        return stats.occupancy
+    props = get_device_properties(device)
+    num_threads = stats.num_warps * 32
+    limits = [get_max_ctas_per_sm(device),
+              props["max_threads_per_sm"] // num_threads]
+    if stats.shared > 0:
+        # the driver reserves 1KB of shared memory per CTA on sm_80+
+        reserved = 1024 if torch.cuda.get_device_capability(device)[0] >= 8 else 0
+        limits.append(props["max_shared_mem_per_sm"] // (stats.shared + reserved))
+    if stats.n_regs > 0:
+        # registers are allocated per warp, in units of 256
+        regs_per_warp = math.ceil(stats.n_regs * 32 / 256) * 256
+        limits.append(props["max_regs_per_sm"] // (regs_per_warp * stats.num_warps))
+    return max(min(limits), 0)
+
+
+def get_num_waves(num_ctas, ctas_per_sm, device):
+    num_sm = get_device_properties(device)["multiprocessor_count"]
+    return triton.cdiv(num_ctas, num_sm * ctas_per_sm)
+
+
+def get_wave_efficiency(num_ctas, ctas_per_sm, device):
+    '''
+    return the fraction of the occupied SM slots doing useful work;
+    the last, partial wave takes as long as a full one
+    '''
+    ctas_per_wave = get_device_properties(device)["multiprocessor_count"] * ctas_per_sm
+    if num_ctas <= ctas_per_wave:
+        return 1.
+    num_waves = triton.cdiv(num_ctas, ctas_per_wave)
+    return num_ctas / (num_waves * ctas_per_wave)
+
+
+def get_latency_bound_gbps(bytes_in_flight_per_sm, num_active_sms, latency_ns):
+    ''' return the bandwidth in GB/s sustained by the loads in flight '''
+    return bytes_in_flight_per_sm * num_active_sms / latency_ns
+
+
+def get_smem_gbps(device):
+    ''' return the aggregate shared memory bandwidth in GB/s '''
+    props = get_device_properties(device)
+    clock_khz = props["sm_clock_rate"]
+    return props["multiprocessor_count"] * SMEM_BYTES_PER_CLK * clock_khz / 1e6
+
+
+def get_l2_hit_rate(footprint, device):
+    ''' return the fraction of a `footprint`-byte working set held in L2 '''
+    l2_size = get_device_properties(device)["l2_cache_size"]
+    if footprint <= 0:
+        return 1.
+    return min(1., l2_size / footprint)
@@ -0,0 +1,74 @@
+from __future__ import annotations
+
+import torch
+
+import triton
+
+
+class KernelGraph:
+    '''
+    Records a sequence of kernel launches into a CUDA graph, and replays it
+    with a single launch.
+
+    .. highlight:: python
+    .. code-block:: python
+
+        graph = triton.runtime.KernelGraph()
+        graph.capture(lambda: decode_step(x, y))
+        for _ in range(n):
+            graph.replay()
+        # pointers and scalars can change between replays
+        graph.capture(lambda: decode_step(x2, y2))
+
+    Kernels must have been compiled (e.g., launched or warmed up once) before
+    they are captured, and the captured function must not allocate memory.
+    Re-capturing with the same sequence of kernels only updates the parameters
+    of the kernel nodes of the executable graph, which is much cheaper than
+    instantiating a new one.
+    '''
+
+    def __init__(self, device=None):
+        triton.compiler.init_cuda_utils()
+        self.utils = triton.compiler.cuda_utils
+        self.device = torch.cuda.current_device() if device is None else device
+        self.stream = torch.cuda.Stream(device=self.device)
+        self.graph = 0
+        self.exec = 0
+
+    def capture(self, fn):
+        '''
+        Records all launches issued by `fn`. `fn` runs with the private stream
+        of the graph as the current stream, which is ordered after the work
+        already queued on the current stream of the caller.
+        '''
+        stream = self.stream.cuda_stream
+        # the capture stream must be ordered after prior work of the caller
+        self.stream.wait_stream(torch.cuda.current_stream(self.device))
+        with torch.cuda.stream(self.stream):
+            self.utils.graph_begin_capture(stream)
+            try:
+                fn()
+            except BaseException:
+                # the capture is ended and its partial graph dropped
+                self.utils.graph_destroy(self.utils.graph_end_capture(stream), 0)
+                raise
+            graph = self.utils.graph_end_capture(stream)
+        if self.exec and self.utils.graph_exec_update(self.exec, graph):
+            self.utils.graph_destroy(graph, 0)
+            return
+        self.utils.graph_destroy(self.graph, self.exec)
+        self.graph = graph
+        self.exec = self.utils.graph_instantiate(graph)
+
+    def replay(self, stream=None):
+        '''
+        Launches the recorded graph on `stream` (the current stream by default).
+        '''
+        assert self.exec, "KernelGraph.replay() called before capture()"
+        if stream is None:
+            stream = torch.cuda.current_stream(self.device).cuda_stream
+        self.utils.graph_launch(self.exec, stream)
+
+    def __del__(self):
+        if getattr(self, "exec", 0) or getattr(self, "graph", 0):
+            self.utils.graph_destroy(self.graph, self.exec)
@@ -0,0 +1,128 @@
+'''
+Reads the records of the kernels compiled with `profile`. Each warp of each
+program records the SM it runs on and the value of its cycle counter when it
+enters or leaves a region: the whole kernel ("kernel"), the
+`tl.profile_range`s, and with `profile="auto"` the loops, dots and async waits
+of the kernel. The records of the last launch are kept by the kernel:
+
+    pgm = kernel[grid](..., profile="auto")
+    torch.cuda.synchronize()
+    instrumentation.chrome_trace(pgm, "trace.json")  # for chrome://tracing
+
+The cycle counters of different SMs are not synchronized: the timeline of each
+SM starts with the first record of the SM.
+'''
+
+from __future__ import annotations
+
+import json
+from collections import defaultdict
+
+from . import cost_model
+
+
+def records(kernel):
+    '''
+    Returns the records of the last launch of `kernel`, as a list of
+    `(program, warp, sm, region, is_end, clock)` ordered by program and warp,
+    and in the order of the warp. Programs are numbered in the order of the
+    launch, x first. Only the first `profile_capacity` records of each warp
+    are kept.
+    '''
+    profile = kernel.metadata.get("profile")
+    if profile is None:
+        raise ValueError("kernel was not compiled with profile")
+    if kernel.profile_buffer is None:
+        return []
+    capacity = profile["capacity"]
+    regions = profile["regions"]
+    words = kernel.profile_buffer.view(-1, 2).cpu()
+    tags = (words[:, 0] & 0xffffffff).tolist()
+    sms = (words[:, 0] >> 32).tolist()
+    clocks = words[:, 1].tolist()
+    result = []
+    for i, tag in enumerate(tags):
+        # unused records are zero
+        if tag == 0:
+            continue
+        warp, _ = divmod(i, capacity)
+        program, warp = divmod(warp, kernel.num_warps)
+        result.append((program, warp, sms[i], regions[(tag - 1) >> 1], bool((tag - 1) & 1), clocks[i]))
+    return result
+
+
+def intervals(kernel):
+    '''
+    Returns the time spent in the regions of the last launch of `kernel`, as a
+    list of `(program, warp, sm, region, start, end)`, in cycles. Regions left
+    open, e.g. by an early return or a full buffer, end at the last record of
+    their warp.
+    '''
+    result = []
+    open_regions = dict()
+    last = None
+    for program, warp, sm, region, is_end, clock in records(kernel):
+        if last is not None and last[:2] != (program, warp):
+            result += _close(open_regions, last)
+        last = (program, warp, sm, clock)
+        if not is_end:
+            open_regions.setdefault(region, []).append(clock)
+        elif open_regions.get(region):
+            result.append((program, warp, sm, region, open_regions[region].pop(), clock))
+    if last is not None:
+        result += _close(open_regions, last)
+    return result
+
+
+def _close(open_regions, last):
+    program, warp, sm, clock = last
+    closed = [(program, warp, sm, region, start, clock)
+              for region, starts in open_regions.items() for start in starts]
+    open_regions.clear()
+    return closed
+
+
+def summary(kernel):
+    '''
+    Returns, for each region of the last launch of `kernel`, the number of
+    times a warp went through it and the total and mean cycles it spent there.
+    '''
+    stats = defaultdict(lambda: {"count": 0, "cycles": 0})
+    for _, _, _, region, start, end in intervals(kernel):
+        stats[region]["count"] += 1
+        stats[region]["cycles"] += end - start
+    for region in stats.values():
+        region["mean_cycles"] = region["cycles"] / region["count"]
+    return dict(stats)
+
+
+def chrome_trace(kernel, path=None):
+    '''
+    Returns the regions of the last launch of `kernel` in the Chrome trace
+    event format, with a process per SM and a thread per warp, and writes it
+    to `path` if any. Times are converted from cycles with the SM clock rate.
+    '''
+    device = kernel.profile_buffer.device.index if kernel.profile_buffer is not None else 0
+    clock_khz = cost_model.get_device_properties(device)["sm_clock_rate"]
+    spans = intervals(kernel)
+    sm_start = dict()
+    for _, _, sm, _, start, _ in spans:
+        sm_start[sm] = min(start, sm_start.get(sm, start))
+    events = []
+    threads = set()
+    for program, warp, sm, region, start, end in spans:
+        tid = program * kernel.num_warps + warp
+        threads.add((sm, tid, program, warp))
+        events.append({"name": region, "ph": "X", "pid": sm, "tid": tid,
+                       "ts": (start - sm_start[sm]) * 1e3 / clock_khz,
+                       "dur": (end - start) * 1e3 / clock_khz})
+    for sm in sm_start:
+        events.append({"name": "process_name", "ph": "M", "pid": sm, "args": {"name": f"SM {sm}"}})
+    for sm, tid, program, warp in threads:
+        events.append({"name": "thread_name", "ph": "M", "pid": sm, "tid": tid,
+                       "args": {"name": f"program {program} warp {warp}"}})
+    trace = {"traceEvents": events, "displayTimeUnit": "ns"}
+    if path is not None:
+        with open(path, "w") as f:
+            json.dump(trace, f)
+    return trace
@@ -4,10 +4,14 @@ import ast
 import functools
 import hashlib
 import inspect
+import json
 import os
+import shutil
 import subprocess
 import textwrap
+import threading
 from collections import defaultdict, namedtuple
+from concurrent.futures import ThreadPoolExecutor
 from typing import Callable, Generic, Iterable, Optional, TypeVar, Union, cast, overload
 
 import torch
@@ -73,28 +77,80 @@ class DependenciesFinder(ast.NodeVisitor):
 # -----------------------------------------------------------------------------
 
 
+class _StampedHashes:
+    '''
+    Hashes derived from files (their contents, the output of a tool), persisted in
+    `$TRITON_CACHE_DIR/version_key.json` with the mtime and size of the file they
+    were computed from, so that each process only recomputes those of the files
+    that changed.
+    '''
+
+    def __init__(self):
+        cache_dir = os.environ.get('TRITON_CACHE_DIR', triton.compiler.default_cache_dir())
+        self.path = os.path.join(cache_dir, "version_key.json")
+        try:
+            with open(self.path) as f:
+                self.entries = json.load(f)
+        except (OSError, ValueError):
+            self.entries = dict()
+        self.changed = False
+
+    def get(self, kind, path, compute):
+        st = os.stat(path)
+        stamp = [st.st_mtime_ns, st.st_size]
+        key = f"{kind}:{path}"
+        entry = self.entries.get(key)
+        if entry is None or entry[:2] != stamp:
+            entry = stamp + [compute(path)]
+            self.entries[key] = entry
+            self.changed = True
+        return entry[2]
+
+    def save(self):
+        if not self.changed:
+            return
+        try:
+            os.makedirs(os.path.dirname(self.path), exist_ok=True)
+            tmp_path = f"{self.path}.{os.getpid()}.tmp"
+            with open(tmp_path, "w") as f:
+                json.dump(self.entries, f)
+            os.replace(tmp_path, self.path)
+        except OSError:
+            pass
+
+
+def _md5_file(path):
+    with open(path, "rb") as f:
+        return hashlib.md5(f.read()).hexdigest()
+
+
+def _md5_ptxas_version(path):
+    return hashlib.md5(subprocess.check_output([path, "--version"])).hexdigest()
+
+
 @functools.lru_cache()
 def version_key():
     import pkgutil
+    hashes = _StampedHashes()
     contents = []
     # frontend
-    with open(__file__, "rb") as f:
-        contents += [hashlib.md5(f.read()).hexdigest()]
-    with open(triton.compiler.__file__, "rb") as f:
-        contents += [hashlib.md5(f.read()).hexdigest()]
-    # backend
-    with open(triton._C.libtriton.__file__, "rb") as f:
-        contents += [hashlib.md5(f.read()).hexdigest()]
+    contents += [hashes.get("md5", __file__, _md5_file)]
+    contents += [hashes.get("md5", triton.compiler.__file__, _md5_file)]
+    # backend: libtriton embeds a hash of the sources it was built from
+    fingerprint = getattr(triton._C.libtriton.triton, "build_fingerprint", None)
+    if fingerprint is None:
+        fingerprint = hashes.get("md5", triton._C.libtriton.__file__, _md5_file)
+    contents += [fingerprint]
     # language
     language_path = os.path.join(*triton.__path__, 'language')
     for lib in pkgutil.iter_modules([language_path]):
-        with open(lib.module_finder.find_spec(lib.name).origin, "rb") as f:
-            contents += [hashlib.md5(f.read()).hexdigest()]
+        contents += [hashes.get("md5", lib.module_finder.find_spec(lib.name).origin, _md5_file)]
     # ptxas version
     try:
-        ptxas_version = hashlib.md5(subprocess.check_output(["ptxas", "--version"])).hexdigest()
+        ptxas_version = hashes.get("ptxas-version", shutil.which("ptxas"), _md5_ptxas_version)
     except Exception:
         ptxas_version = ''
+    hashes.save()
     return '-'.join(triton.__version__) + '-' + ptxas_version + '-' + '-'.join(contents)
 
 
@@ -115,6 +171,9 @@ class JITFunction(KernelInterface[T]):
     # Hook for inspecting compiled functions and modules
     cache_hook = None
     divisibility = 16
+    # pool compiling the kernels of the functions with `async_compile`
+    _compiler = None
+    _compiler_lock = threading.Lock()
 
     @staticmethod
     def _key_of(arg):
@@ -138,10 +197,24 @@ class JITFunction(KernelInterface[T]):
         else:
             raise TypeError(f'Unsupported type {type(arg)} for {arg}')
 
+    @staticmethod
+    def _generic_key(key):
+        # the dispatch key, innermost, is wrapped by the launch options
+        if isinstance(key[0], tuple):
+            return (JITFunction._generic_key(key[0]),) + key[1:]
+        # integers and pointers are specialized on two properties
+        return key[:3] + (tuple((False, False) if len(spec) == 2 else spec for spec in key[3]),)
+
+    @staticmethod
+    def _is_small(arg):
+        # the offsets into a storage below 2GB fit in 32 bits
+        storage = getattr(arg, "untyped_storage", None)
+        return storage is not None and storage().nbytes() < 2**31
+
     @staticmethod
     def _spec_of(arg):
         if hasattr(arg, "data_ptr"):
-            return (arg.data_ptr() % JITFunction.divisibility == 0)
+            return (arg.data_ptr() % JITFunction.divisibility == 0, JITFunction._is_small(arg))
         elif isinstance(arg, int):
             return (arg % 16 == 0, arg == 1)
         return (arg is None, )
@@ -157,7 +230,8 @@ class JITFunction(KernelInterface[T]):
             return False
         divisible_by_16 = {i for i, arg in enumerate(args) if is_divisible_by_16(arg) and i not in self.do_not_specialize}
         equal_to_1 = {i for i, arg in enumerate(args) if isinstance(arg, int) and arg == 1 and i not in self.do_not_specialize}
-        return namedtuple("instance_descriptor", ["divisible_by_16", "equal_to_1"])(tuple(divisible_by_16), tuple(equal_to_1))
+        pointer_range_32 = {i for i, arg in enumerate(args) if hasattr(arg, "data_ptr") and self._is_small(arg) and i not in self.do_not_specialize}
+        return namedtuple("instance_descriptor", ["divisible_by_16", "equal_to_1", "pointer_range_32"])(tuple(divisible_by_16), tuple(equal_to_1), tuple(pointer_range_32))
         # return _triton.code_gen.instance_descriptor(divisible_by_16, equal_to_1)
 
     @staticmethod
@@ -180,6 +254,8 @@ class JITFunction(KernelInterface[T]):
                 triton.language.uint32: 'u32',
                 triton.language.uint64: 'u64',
                 triton.language.float8: 'fp8',
+                triton.language.float8e4: 'fp8e4',
+                triton.language.float8e5: 'fp8e5',
                 triton.language.float16: 'fp16',
                 triton.language.bfloat16: 'bf16',
                 triton.language.float32: 'fp32',
@@ -221,31 +297,37 @@ class JITFunction(KernelInterface[T]):
 
     def _make_launcher(self):
         regular_args = [f'{arg}' for i, arg in enumerate(self.arg_names) if i not in self.constexprs]
-        constexpr_args = [f'{arg}' for i, arg in enumerate(self.arg_names) if i in self.constexprs]
         args = ', '.join(regular_args)
-        # cache key for regular argument type
-        sig_keys = ', '.join([f'_key_of({arg})' for arg in regular_args])
-        # cache key for constexpr argument values
-        constexpr_keys = ', '.join(constexpr_args)
-        # cache key for argument specialization
-        specializations = []
-        for i, arg in enumerate(regular_args):
-            if i in self.do_not_specialize:
-                continue
-            specializations += [f'({arg}.data_ptr() % {JITFunction.divisibility} == 0) if hasattr({arg}, "data_ptr") '
-                                f'else ({arg} % {JITFunction.divisibility} == 0, {arg} == 1) if isinstance({arg}, int) '
-                                f'else (False,)']
-        spec_keys = ', '.join(specializations)
         grid_args = ','.join([f'"{arg}": {arg}' for arg in self.arg_names])
 
         src = f"""
-def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stages=3, extern_libs=None, stream=None, warmup=False):
-    sig_key =  {sig_keys},
-    constexpr_key = {f'{constexpr_keys},' if len(constexpr_keys) > 0 else tuple()}
-    spec_key = {f'{spec_keys},' if len(spec_keys) > 0 else tuple()}
-    key = (version_key, sig_key, constexpr_key, spec_key)
+def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stages=3, prefetch_width=0, num_ctas=1, pid_remap=None, fast_math=False, native_load_store=False, opt_level=3, disabled_passes=None, max_registers=0, min_blocks_per_sm=0, fp_contraction='fast', profile=None, extern_libs=None, stream=None, warmup=False):
+    key = dispatch_key({', '.join(self.arg_names)})
+    constexpr_key = key[2]
     if not extern_libs is None:
       key = (key, tuple(extern_libs.items()))
+    if prefetch_width:
+      key = (key, prefetch_width)
+    if num_ctas != 1:
+      key = (key, 'cluster', num_ctas)
+    if pid_remap is not None:
+      key = (key, pid_remap)
+    if fast_math:
+      key = (key, 'fast_math')
+    if native_load_store:
+      key = (key, 'native_load_store')
+    if opt_level != 3:
+      key = (key, 'opt_level', opt_level)
+    if disabled_passes:
+      key = (key, 'disabled_passes', tuple(sorted(disabled_passes)))
+    if max_registers:
+      key = (key, 'max_registers', max_registers)
+    if min_blocks_per_sm:
+      key = (key, 'min_blocks_per_sm', min_blocks_per_sm)
+    if fp_contraction != 'fast':
+      key = (key, 'fp_contraction', fp_contraction)
+    if profile:
+      key = (key, 'profile', profile)
     assert num_warps > 0 and (num_warps & (num_warps - 1)) == 0, "num_warps must be a power of 2"
     if callable(grid):
         grid = grid({{{grid_args}}})
@@ -264,8 +346,26 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
       return bin
     # kernel not cached -- compile
     except KeyError:
-      # build dict of constant values
       args = [{args}]
+      generic_key = self._generic_key(key)
+      if self.async_compile and not warmup:
+        future = self.pending[device].get(key)
+        if future is not None:
+          # still compiling: run the generic variant meanwhile, if any
+          bin = self._async_fallback(device, generic_key, future)
+          if bin is None:
+            return future
+          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, *args)
+          return bin
+      elif self.lazy_specialization:
+        bin = cache[device].get(generic_key)
+        if bin is not None:
+          # new specializations of a compiled kernel run its generic variant
+          cache[device][key] = bin
+          if not warmup:
+              bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, *args)
+          return bin
+      # build dict of constant values
       all_args = {', '.join([f'{arg}' for arg in self.arg_names])},
       configs = self._get_config(*all_args),
       constants = self._make_constants(constexpr_key)
@@ -275,23 +375,82 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
       signature = {{ i: self._type_of(_key_of(arg)) for i, arg in enumerate(all_args) if i not in self.constexprs }}
       # build stub signature -- includes arguments that are specialized
       for i, arg in constants.items():
-        if callable(arg):
+        if callable(arg) and not isinstance(arg, JITFunction):
           raise TypeError(f"Callable constexpr at index {{i}} is not supported")
       if not self._call_hook(key, signature, device, constants, num_warps, num_stages, extern_libs, configs):
-        bin = triton.compile(self, signature=signature, device=device, constants=constants, num_warps=num_warps, num_stages=num_stages, extern_libs=extern_libs, configs=configs)
+        options = dict(signature=signature, device=device, num_warps=num_warps, num_stages=num_stages, prefetch_width=prefetch_width, num_ctas=num_ctas, pid_remap=pid_remap, fast_math=fast_math, native_load_store=native_load_store, opt_level=opt_level, disabled_passes=disabled_passes, max_registers=max_registers, min_blocks_per_sm=min_blocks_per_sm, fp_contraction=fp_contraction, profile=profile, extern_libs=extern_libs)
+        if self.async_compile and not warmup:
+          future = self._compile_async(device, key, generic_key, constants, configs, options)
+          bin = self._async_fallback(device, generic_key, future)
+          if bin is None:
+            return future
+          bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, *args)
+          return bin
+        bin = triton.compile(self, constants=constants, configs=configs, **options)
+        if (self.lazy_specialization or self.async_compile) and generic_key != key:
+          # compiled along the specialized variant, with no assumption on the
+          # values of the arguments
+          self.cache[device][generic_key] = triton.compile(self, **self._generic_variant(constants, configs), **options)
         if not warmup:
             bin.c_wrapper(grid_0, grid_1, grid_2, bin.num_warps, bin.shared, stream, bin.cu_function, triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook, bin, *args)
         self.cache[device][key] = bin
         return bin
       return None
 """
-        scope = {"version_key": version_key(), "get_cuda_stream": get_cuda_stream,
+        # the cache key of the arguments is computed natively on every launch
+        kinds = [2 if i in self.constexprs else 1 if i in self.do_not_specialize else 0
+                 for i in range(len(self.arg_names))]
+        dispatcher = triton._C.libtriton.triton.runtime.dispatcher(version_key(), kinds, JITFunction.divisibility)
+        scope = {"dispatch_key": dispatcher.key, "get_cuda_stream": get_cuda_stream,
                  "self": self, "_spec_of": self._spec_of, "_key_of": self._key_of,
-                 "cache": self.cache, "triton": triton, "torch": torch}
+                 "cache": self.cache, "triton": triton, "torch": torch,
+                 "JITFunction": JITFunction}
         exec(src, scope)
         return scope[self.fn.__name__]
 
-    def __init__(self, fn, version=None, do_not_specialize=None):
+    def _generic_variant(self, constants, configs):
+        # the constants and configs of the generic variant of a kernel
+        constants = {i: arg for i, arg in constants.items() if i in self.constexprs or i not in configs[0].equal_to_1}
+        return dict(constants=constants, configs=(triton.compiler.instance_descriptor(),))
+
+    def _compile_async(self, device, key, generic_key, constants, configs, options):
+        '''
+        Compiles the kernel of `key` on the background pool, followed by its
+        generic variant if it is neither compiled nor compiling, and returns
+        the future of the kernel. Each kernel is loaded on `device` before it
+        is added to the cache, in a single store, so that the launches either
+        miss it or run it without waiting.
+        '''
+        with JITFunction._compiler_lock:
+            if JITFunction._compiler is None:
+                num_threads = int(os.environ.get("TRITON_COMPILE_THREADS", min(32, os.cpu_count() or 1)))
+                JITFunction._compiler = ThreadPoolExecutor(max_workers=max(num_threads, 1),
+                                                           thread_name_prefix="triton-compiler")
+            pending = self.pending[device]
+            if key in pending:
+                return pending[key]
+
+            def compile(key, constants, configs):
+                with torch.cuda.device(device):
+                    bin = triton.compile(self, constants=constants, configs=configs, **options)
+                    bin._init_handles()
+                self.cache[device][key] = bin
+                return bin
+            # failed compilations stay pending, their launches get the error
+            # from the future rather than compiling again
+            pending[key] = JITFunction._compiler.submit(compile, key, constants, configs)
+            if generic_key not in self.cache[device] and generic_key not in pending:
+                generic = self._generic_variant(constants, configs)
+                pending[generic_key] = JITFunction._compiler.submit(compile, generic_key, **generic)
+            return pending[key]
+
+    def _async_fallback(self, device, generic_key, future):
+        # the kernel run by a launch whose kernel is compiled by `future`
+        if future.done() and future.exception() is None:
+            return future.result()
+        return self.cache[device].get(generic_key)
+
+    def __init__(self, fn, version=None, do_not_specialize=None, lazy_specialization=False, async_compile=False):
         self.fn = fn
         self.module = fn.__module__
         self.version = version
@@ -302,6 +461,11 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         # specialization hints
         self.do_not_specialize = [] if do_not_specialize is None else do_not_specialize
         self.do_not_specialize = {self.arg_names.index(arg) if isinstance(arg, str) else arg for arg in self.do_not_specialize}
+        # launches with new specializations fall back to a generic variant
+        self.lazy_specialization = lazy_specialization
+        # launches that miss the cache compile in the background
+        self.async_compile = async_compile
+        self.pending = defaultdict(dict)
         # function source code (without decorators)
         self.src = textwrap.dedent(inspect.getsource(fn))
         self.src = self.src[self.src.find("def"):]
@@ -337,6 +501,20 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
     def warmup(self, *args, **kwargs):
         return self.run(*map(MockTensor.wrap_dtype, args), **kwargs, warmup=True)
 
+    def fast_launcher(self, *args, grid, **kwargs):
+        '''
+        Compiles the kernel for the given arguments and returns a launcher bound to the
+        resulting binary. The launcher skips argument type inference, specialization
+        (e.g., divisibility by 16) and cache lookup, so the caller promises that all
+        subsequent launches use arguments of the same types and alignments.
+        '''
+        bin = self.warmup(*args, grid=grid, **kwargs)
+        if bin is None:
+            raise RuntimeError(f"{self} was not compiled by the launcher (cache_hook?)")
+        # constexprs passed positionally are baked into the binary
+        regular_idx = [i for i in range(len(args)) if i not in self.constexprs]
+        return FastLauncher(bin, regular_idx, grid, torch.cuda.current_device())
+
     # we do not parse `src` in the constructor because
     # the user might want to monkey-patch self.src dynamically.
     # Our unit tests do this, for example.
@@ -365,6 +543,43 @@ def {self.fn.__name__}({', '.join(self.arg_names)}, grid, num_warps=4, num_stage
         return f"JITFunction({self.module}:{self.fn.__name__})"
 
 
+class FastLauncher:
+    '''
+    Launcher bound to a compiled kernel. It is called with the same positional
+    arguments as the kernel it was created from; constexprs are ignored.
+    '''
+
+    def __init__(self, bin, regular_idx, grid, device):
+        self.bin = bin
+        self.regular_idx = regular_idx
+        self.device = device
+        self.grid = self._normalize_grid(grid)
+        # resolve driver handles once
+        self.c_wrapper = bin.c_wrapper
+        self.cu_function = bin.cu_function
+        self.num_warps = bin.num_warps
+        self.shared = bin.shared
+
+    @staticmethod
+    def _normalize_grid(grid):
+        if grid is None or callable(grid):
+            return None
+        return tuple(grid) + (1,) * (3 - len(grid))
+
+    def __call__(self, *args, grid=None, stream=None):
+        grid = self.grid if grid is None else self._normalize_grid(grid)
+        if grid is None:
+            raise ValueError("FastLauncher requires a static grid")
+        grid_0, grid_1, grid_2 = grid
+        if stream is None:
+            stream = get_cuda_stream(self.device)
+        if len(args) != len(self.regular_idx):
+            args = [args[i] for i in self.regular_idx]
+        self.c_wrapper(grid_0, grid_1, grid_2, self.num_warps, self.shared, stream, self.cu_function,
+                       triton.compiler.CompiledKernel.launch_enter_hook, triton.compiler.CompiledKernel.launch_exit_hook,
+                       self.bin, *args)
+
+
 # -----------------------------------------------------------------------------
 # `jit` decorator
 # -----------------------------------------------------------------------------
@@ -380,6 +595,8 @@ def jit(
     *,
     version=None,
     do_not_specialize: Optional[Iterable[int]] = None,
+    lazy_specialization: bool = False,
+    async_compile: bool = False,
 ) -> Callable[[T], JITFunction[T]]:
     ...
 
@@ -389,6 +606,8 @@ def jit(
     *,
     version=None,
     do_not_specialize: Optional[Iterable[int]] = None,
+    lazy_specialization: bool = False,
+    async_compile: bool = False,
 ) -> Union[JITFunction[T], Callable[[T], JITFunction[T]]]:
     """
     Decorator for JIT-compiling a function using the Triton compiler.
@@ -405,6 +624,16 @@ def jit(
 
     :param fn: the function to be jit-compiled
     :type fn: Callable
+    :param lazy_specialization: the first launch with a given signature also compiles a generic variant of the
+        kernel, which makes no assumption on the alignment of pointers and on the values of integers. Later
+        launches with new alignments or values run the generic variant instead of compiling on the hot path.
+    :type lazy_specialization: bool
+    :param async_compile: launches that miss the cache return immediately while the kernel compiles on a
+        background thread pool, along with its generic variant. Until the kernel is ready, they run the generic
+        variant if it was compiled by an earlier launch, and otherwise return a
+        :code:`concurrent.futures.Future` of the kernel without running anything, so that the caller can fall
+        back to another implementation or wait for the result. :code:`warmup` still compiles synchronously.
+    :type async_compile: bool
     """
 
     def decorator(fn: T) -> JITFunction[T]:
@@ -413,6 +642,8 @@ def jit(
             fn,
             version=version,
             do_not_specialize=do_not_specialize,
+            lazy_specialization=lazy_specialization,
+            async_compile=async_compile,
         )
 
     if fn is not None:
@@ -432,6 +663,9 @@ class TensorWrapper:
     def data_ptr(self):
         return self.base.data_ptr()
 
+    def untyped_storage(self):
+        return self.base.untyped_storage()
+
     def __str__(self) -> str:
         return f'TensorWrapper[{self.dtype}]({self.base})'
 
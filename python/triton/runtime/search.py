@@ -0,0 +1,146 @@
+from __future__ import annotations
+
+import copy
+import math
+from itertools import chain
+
+
+def config_key(config):
+    return (tuple(sorted(config.kwargs.items())), config.num_warps, config.num_stages,
+            config.prefetch_width, config.pid_remap, config.max_registers, config.min_blocks_per_sm)
+
+
+def _ms(timing):
+    # benchmarks return the percentiles of the runtime, led by the median
+    return timing[0] if isinstance(timing, (tuple, list)) else timing
+
+
+# launch options that can be searched along with the meta-parameters
+_OPTIONS = ('num_warps', 'num_stages', 'max_registers', 'min_blocks_per_sm')
+
+
+def _get(config, name):
+    if name in _OPTIONS:
+        return getattr(config, name)
+    return config.kwargs.get(name)
+
+
+def _with(config, name, value):
+    config = copy.copy(config)
+    if name in _OPTIONS:
+        setattr(config, name, value)
+    else:
+        config.kwargs = dict(config.kwargs, **{name: value})
+    return config
+
+
+class SuccessiveHalving:
+    '''
+    Searches the configs of an autotuner in rounds of increasingly long
+    benchmarks: every config is first run for `rep[0]` ms, and only the fastest
+    `1/eta` of each round are benchmarked again, `eta` times longer, up to
+    `rep[1]` ms. The best config is the fastest of the last round.
+
+    Given a `space` (a dict mapping meta-parameters, `num_warps`, `num_stages`,
+    `max_registers` or `min_blocks_per_sm` to their sorted candidate values), up to `num_proposals`
+    configs outside of the list of the autotuner are proposed after each round.
+    They differ from a survivor of the round in one parameter, taking the
+    neighbouring candidate value. The model of the runtime is an inverse
+    distance weighting of the logarithm of the runtimes measured so far, and the
+    proposals minimize its lower confidence bound, which grows with the distance
+    to the closest measured config by `exploration` times the spread of the
+    measured runtimes. Proposals are compiled while the survivors are
+    benchmarked, and join the next round.
+    '''
+
+    def __init__(self, rep=(10, 100), eta=3, space=None, num_proposals=4, exploration=1.0):
+        if eta < 2:
+            raise ValueError(f"eta must be at least 2, got {eta}")
+        self.rep = rep
+        self.eta = eta
+        self.space = dict() if space is None else space
+        self.num_proposals = num_proposals if self.space else 0
+        self.exploration = exploration
+
+    def run(self, configs, compile, bench):
+        '''
+        Returns the best of `configs` and the proposals, and the timings of their
+        last round. `compile(configs)` starts compiling `configs` and returns an
+        iterator of `(config, compiled)` in the order they finish, and
+        `bench(config, rep)` benchmarks a compiled config for `rep` ms.
+        '''
+        seen = {config_key(config) for config in configs}
+        proposed = set()
+        timings = dict()
+        ready = compile(configs)
+        rep = self.rep[0]
+        while True:
+            results = dict()
+            for config, compiled in ready:
+                if not compiled and config_key(config) in proposed:
+                    results[config] = float('inf')
+                    continue
+                results[config] = bench(config, rep)
+            timings.update(results)
+            if rep >= self.rep[1] or len(results) <= 1:
+                break
+            survivors = sorted(results, key=lambda config: _ms(results[config]))
+            survivors = survivors[:math.ceil(len(survivors) / self.eta)]
+            proposals = self.propose(survivors, timings, seen)
+            proposed |= {config_key(config) for config in proposals}
+            # the survivors are already compiled, the proposals compile while
+            # they run
+            ready = chain(((config, True) for config in survivors), compile(proposals))
+            rep = min(rep * self.eta, self.rep[1])
+        best = min(results, key=lambda config: _ms(results[config]))
+        return best, timings
+
+    def _features(self, config):
+        features = []
+        for name, values in self.space.items():
+            value = _get(config, name)
+            index = values.index(value) if value in values else (len(values) - 1) / 2
+            features.append(index / max(len(values) - 1, 1))
+        return features
+
+    def _lower_bound(self, config, measured, spread):
+        x = self._features(config)
+        weights, total, closest = 0., 0., float('inf')
+        for features, y in measured:
+            distance = math.dist(x, features)
+            closest = min(closest, distance)
+            weight = 1. / max(distance, 1e-6)**2
+            weights += weight
+            total += weight * y
+        return total / weights - self.exploration * spread * closest
+
+    def propose(self, survivors, timings, seen):
+        '''
+        Returns up to `num_proposals` new neighbours of `survivors`, which are
+        added to `seen`.
+        '''
+        if not self.num_proposals:
+            return []
+        candidates = dict()
+        for config in survivors:
+            for name, values in self.space.items():
+                value = _get(config, name)
+                if value not in values:
+                    continue
+                index = values.index(value)
+                for neighbour in values[max(index - 1, 0):index + 2]:
+                    candidate = _with(config, name, neighbour)
+                    key = config_key(candidate)
+                    if key not in seen and key not in candidates:
+                        candidates[key] = candidate
+        measured = [(self._features(config), math.log(_ms(timing)))
+                    for config, timing in timings.items() if 0 < _ms(timing) < float('inf')]
+        if not candidates or not measured:
+            return []
+        logs = [y for _, y in measured]
+        mean = sum(logs) / len(logs)
+        spread = math.sqrt(sum((y - mean)**2 for y in logs) / len(logs))
+        scores = {key: self._lower_bound(config, measured, spread) for key, config in candidates.items()}
+        best = sorted(scores, key=scores.get)[:self.num_proposals]
+        seen |= set(best)
+        return [candidates[key] for key in best]
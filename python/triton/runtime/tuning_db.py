@@ -0,0 +1,162 @@
+from __future__ import annotations
+
+import json
+import os
+
+import torch
+from filelock import FileLock
+
+import triton
+
+# bumped whenever the layout of the database changes
+VERSION = 1
+
+
+def default_db_path():
+    cache_dir = os.environ.get('TRITON_CACHE_DIR', triton.compiler.default_cache_dir())
+    return os.path.join(cache_dir, "autotune.json")
+
+
+def device_key(device=None):
+    '''
+    Identifies the GPU model, SM count and driver version results were tuned on.
+    '''
+    if device is None:
+        device = torch.cuda.current_device()
+    triton.compiler.init_cuda_utils()
+    num_sm = triton.compiler.cuda_utils.get_device_properties(device)["multiprocessor_count"]
+    driver = triton.compiler.cuda_utils.get_driver_version()
+    capability = torch.cuda.get_device_capability(device)
+    name = torch.cuda.get_device_name(device)
+    return f"{name}-sm{capability[0]}{capability[1]}-{num_sm}sms-driver{driver}"
+
+
+def config_to_dict(config):
+    entry = {"kwargs": config.kwargs, "num_warps": config.num_warps, "num_stages": config.num_stages}
+    # only stored when set, so that existing entries still match
+    if config.prefetch_width:
+        entry["prefetch_width"] = config.prefetch_width
+    if config.pid_remap is not None:
+        entry["pid_remap"] = config.pid_remap
+    if config.max_registers:
+        entry["max_registers"] = config.max_registers
+    if config.min_blocks_per_sm:
+        entry["min_blocks_per_sm"] = config.min_blocks_per_sm
+    return entry
+
+
+def config_from_dict(entry, pre_hook=None):
+    return triton.Config(entry["kwargs"], num_warps=entry["num_warps"], num_stages=entry["num_stages"],
+                         prefetch_width=entry.get("prefetch_width", 0), pre_hook=pre_hook,
+                         pid_remap=entry.get("pid_remap"), max_registers=entry.get("max_registers", 0),
+                         min_blocks_per_sm=entry.get("min_blocks_per_sm", 0))
+
+
+def find_config(configs, entry):
+    # pre-hooks can't be serialized, so entries are matched back to
+    # the configs of the autotuner
+    for config in configs:
+        if config_to_dict(config) == entry:
+            return config
+    return None
+
+
+class TuningDatabase:
+    '''
+    Autotuning results, keyed by kernel (its `cache_key`, which changes with the
+    source of the kernel and the version of Triton), device (see `device_key`)
+    and problem (the values of the autotuner's `key` arguments):
+
+    .. code-block:: json
+
+        {"version": 1,
+         "entries": {kernel: {device: {problem: {"kwargs": {}, "num_warps": 4, "num_stages": 2}}}}}
+
+    Results are written through to `path` as soon as they are tuned, and files
+    from other hosts can be merged with `load` so that pre-tuned tables can be
+    shipped without running benchmarks.
+    '''
+
+    def __init__(self, path=None):
+        self.path = path
+        self.entries = dict()
+        if self.path and os.path.exists(self.path):
+            self.load(self.path)
+
+    def load(self, path):
+        with open(path) as f:
+            data = json.load(f)
+        if data.get("version") != VERSION:
+            return
+        for kernel, devices in data["entries"].items():
+            for device, problems in devices.items():
+                self.entries.setdefault(kernel, dict()).setdefault(device, dict()).update(problems)
+
+    def save(self, path):
+        data = {"version": VERSION, "entries": self.entries}
+        with open(path + ".tmp", "w") as f:
+            json.dump(data, f, indent=1, sort_keys=True)
+        os.replace(path + ".tmp", path)
+
+    def lookup(self, kernel, device, problem):
+        return self.entries.get(kernel, dict()).get(device, dict()).get(problem)
+
+    def record(self, kernel, device, problem, config):
+        entry = config_to_dict(config)
+        try:
+            json.dumps(entry)
+        except TypeError:
+            return
+        self.entries.setdefault(kernel, dict()).setdefault(device, dict())[problem] = entry
+        if not self.path:
+            return
+        os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+        with FileLock(self.path + ".lock"):
+            # merge the results tuned concurrently by other processes
+            if os.path.exists(self.path):
+                self.load(self.path)
+                self.entries[kernel][device][problem] = entry
+            self.save(self.path)
+
+
+_db = None
+
+
+def get_tuning_db():
+    '''
+    Returns the database shared by all autotuners of the process. It lives in
+    `$TRITON_AUTOTUNE_DB` if set (an empty value keeps results in memory), and
+    in the cache directory otherwise.
+    '''
+    global _db
+    if _db is None:
+        _db = TuningDatabase(os.environ.get("TRITON_AUTOTUNE_DB", default_db_path()))
+    return _db
+
+
+def export_tuning_db(path, device=None):
+    '''
+    Writes the results tuned so far to `path`; only those of `device` if given
+    (e.g. `device_key()` for the current GPU).
+    '''
+    db = TuningDatabase()
+    for kernel, devices in get_tuning_db().entries.items():
+        for key, problems in devices.items():
+            if device is None or key == device:
+                db.entries.setdefault(kernel, dict())[key] = dict(problems)
+    db.save(path)
+
+
+def import_tuning_db(path):
+    '''
+    Merges the results found in `path` into the database of the process.
+    '''
+    db = get_tuning_db()
+    if not db.path:
+        db.load(path)
+        return
+    with FileLock(db.path + ".lock"):
+        if os.path.exists(db.path):
+            db.load(db.path)
+        db.load(path)
+        db.save(db.path)
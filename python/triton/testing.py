@@ -1,3 +1,4 @@
+import csv
 import functools
 import os
 import subprocess
@@ -118,9 +119,164 @@ def nvsmi(attrs):
     return ret
 
 
+# hardware counters collected by `Counters`, by name, for each backend. ncu
+# gives per-kernel metrics (including L2 hit rate, bank conflicts and stall
+# reasons) but only in a report read after the run; NVML's GPU performance
+# monitoring (sm_90+) samples a few device-wide utilizations in-process
+NCU_METRICS = {
+    'dram_bw': 'dram__throughput.avg.pct_of_peak_sustained_elapsed',
+    'l2_hit_rate': 'lts__t_sector_hit_rate.pct',
+    'smem_bank_conflicts': 'l1tex__data_bank_conflicts_pipe_lsu_mem_shared.sum',
+    'tensor_util': 'sm__pipe_tensor_op_hmma_cycles_active.avg.pct_of_peak_sustained_active',
+    'stall_long_scoreboard': 'smsp__average_warps_issue_stalled_long_scoreboard_per_issue_active.ratio',
+    'stall_short_scoreboard': 'smsp__average_warps_issue_stalled_short_scoreboard_per_issue_active.ratio',
+    'stall_barrier': 'smsp__average_warps_issue_stalled_barrier_per_issue_active.ratio',
+    'stall_mio_throttle': 'smsp__average_warps_issue_stalled_mio_throttle_per_issue_active.ratio',
+    'stall_math_pipe_throttle': 'smsp__average_warps_issue_stalled_math_pipe_throttle_per_issue_active.ratio',
+}
+GPM_METRICS = {
+    'dram_bw': 'NVML_GPM_METRIC_DRAM_BW_UTIL',
+    'tensor_util': 'NVML_GPM_METRIC_ANY_TENSOR_UTIL',
+    'sm_util': 'NVML_GPM_METRIC_SM_UTIL',
+    'sm_occupancy': 'NVML_GPM_METRIC_SM_OCCUPANCY',
+}
+_active_counters = None
+
+
+class Counters:
+    """
+    Collects hardware counters of the functions benchmarked by :code:`do_bench`, in addition to their runtime.
+
+    With the :code:`'ncu'` backend, one extra call of each benchmarked function is profiled in its own NVTX range,
+    and the metrics are read back with :code:`Counters.load` from the report of a run such as
+    :code:`ncu --profile-from-start off --nvtx --print-nvtx-rename kernel --metrics <Counters.ncu_metrics()> -o bench python bench.py`.
+    With the :code:`'gpm'` backend, the function is run for :code:`interval` ms between two samples of the GPU
+    performance monitors through :code:`pynvml`, and the utilizations (in %) are available right away.
+
+    :param names: Names of the counters to collect, keys of :code:`NCU_METRICS` or :code:`GPM_METRICS`.
+    :type names: List[str], optional
+    :param backend: :code:`'ncu'` or :code:`'gpm'`.
+    :type backend: str
+    :ivar records: :code:`(label, counters)` pairs in benchmark order, :code:`counters` is empty with :code:`'ncu'`.
+    """
+
+    def __init__(self, names=None, backend='ncu', interval=100):
+        metrics = {'ncu': NCU_METRICS, 'gpm': GPM_METRICS}.get(backend)
+        if metrics is None:
+            raise ValueError(f"unknown counter backend '{backend}', expected 'ncu' or 'gpm'")
+        self.names = list(metrics) if names is None else list(names)
+        unknown = [name for name in self.names if name not in metrics]
+        if unknown:
+            raise ValueError(f"counters {', '.join(unknown)} are not supported by the '{backend}' backend")
+        self.backend = backend
+        self.interval = interval
+        self.label = None
+        self.records = []
+
+    @staticmethod
+    def from_env(var="TRITON_BENCH_COUNTERS"):
+        """
+        Returns the counters configured by the environment, e.g. :code:`gpm` or :code:`ncu:dram_bw,l2_hit_rate`,
+        or None.
+        """
+        spec = os.environ.get(var, "")
+        if not spec:
+            return None
+        backend, _, names = spec.partition(':')
+        return Counters(names.split(',') if names else None, backend)
+
+    def ncu_metrics(self):
+        return ','.join(NCU_METRICS[name] for name in self.names)
+
+    @property
+    def last(self):
+        return self.records[-1][1] if self.records else None
+
+    @contextmanager
+    def scope(self, label):
+        """
+        Collects the counters of the functions benchmarked with :code:`do_bench` in the scope, under :code:`label`.
+        """
+        global _active_counters
+        prev, prev_label = _active_counters, self.label
+        _active_counters, self.label = self, label
+        try:
+            yield self
+        finally:
+            _active_counters, self.label = prev, prev_label
+
+    def collect(self, fn, estimate_ms):
+        label = self.label or getattr(fn, '__name__', 'fn')
+        torch.cuda.synchronize()
+        if self.backend == 'ncu':
+            counters = dict()
+            torch.cuda.nvtx.range_push(label)
+            torch.cuda.profiler.start()
+            fn()
+            torch.cuda.synchronize()
+            torch.cuda.profiler.stop()
+            torch.cuda.nvtx.range_pop()
+        else:
+            counters = self._collect_gpm(fn, max(1, int(self.interval / estimate_ms)))
+        self.records.append((label, counters))
+        return counters
+
+    def _collect_gpm(self, fn, n_repeat):
+        import pynvml
+        pynvml.nvmlInit()
+        handle = pynvml.nvmlDeviceGetHandleByIndex(torch.cuda.current_device())
+        if not pynvml.nvmlGpmQueryDeviceSupport(handle).isSupportedDevice:
+            raise RuntimeError("GPU performance monitoring is not supported by this device")
+        samples = [pynvml.nvmlGpmSampleAlloc() for _ in range(2)]
+        try:
+            pynvml.nvmlGpmSampleGet(handle, samples[0])
+            for _ in range(n_repeat):
+                fn()
+            torch.cuda.synchronize()
+            pynvml.nvmlGpmSampleGet(handle, samples[1])
+            get = pynvml.c_nvmlGpmMetricsGet_t()
+            get.version = pynvml.NVML_GPM_METRICS_GET_VERSION
+            get.numMetrics = len(self.names)
+            get.sample1, get.sample2 = samples
+            for i, name in enumerate(self.names):
+                get.metrics[i].metricId = getattr(pynvml, GPM_METRICS[name])
+            pynvml.nvmlGpmMetricsGet(get)
+            return {name: get.metrics[i].value for i, name in enumerate(self.names)}
+        finally:
+            for sample in samples:
+                pynvml.nvmlGpmSampleFree(sample)
+
+    def load(self, report):
+        """
+        Reads the counters of an ncu report, returns a dict mapping the labels of the profiled ranges to
+        their counters. Counters of ranges that launched several kernels are summed for :code:`.sum`
+        metrics and averaged otherwise.
+        """
+        out = subprocess.check_output(['ncu', '--import', report, '--csv', '--page', 'raw',
+                                       '--print-nvtx-rename', 'kernel', '--metrics', self.ncu_metrics()])
+        return self.parse_ncu_csv(out.decode(sys.stdout.encoding))
+
+    def parse_ncu_csv(self, text):
+        # the first row holds the metric names and the second one their units
+        rows = list(csv.DictReader(text.strip().splitlines()))[1:]
+        kernels = dict()
+        for row in rows:
+            # NVTX-renamed kernels are named after the range that launched them
+            kernels.setdefault(row['Kernel Name'], []).append(row)
+        ret = dict()
+        for label, rows in kernels.items():
+            counters = dict()
+            for name in self.names:
+                metric = NCU_METRICS[name]
+                values = [float(row[metric].replace(',', '')) for row in rows]
+                counters[name] = sum(values) if metric.endswith('.sum') else sum(values) / len(values)
+            ret[label] = counters
+        return ret
+
+
 def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
              percentiles=(0.5, 0.2, 0.8),
-             record_clocks=False, fast_flush=False):
+             record_clocks=False, fast_flush=False, counters=None, return_times=False):
     """
     Benchmark the runtime of the provided function. By default, return the median runtime of :code:`fn` along with
     the 20-th and 80-th performance percentile.
@@ -137,6 +293,12 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     :type percentiles: list[float]
     :param fast_flush: Use faster kernel to flush L2 between measurements
     :type fast_flush: bool
+    :param counters: Hardware counters to collect after the measurements, defaults to those of the enclosing
+        :code:`Counters.scope`. They are recorded by :code:`counters`, the return value is unchanged.
+    :type counters: Counters, optional
+    :param return_times: Return the runtimes of all the repetitions (in ms) instead of their percentiles, e.g. to
+        test whether they differ significantly from another set of repetitions.
+    :type return_times: bool
     """
 
     # Estimate the runtime of the function
@@ -182,6 +344,12 @@ def do_bench(fn, warmup=25, rep=100, grad_to_none=None,
     # Record clocks
     torch.cuda.synchronize()
     times = torch.tensor([s.elapsed_time(e) for s, e in zip(start_event, end_event)])
+    # counters are collected on separate runs, profiling skews the timings
+    counters = counters or _active_counters
+    if counters is not None:
+        counters.collect(fn, estimate_ms)
+    if return_times:
+        return times.tolist()
     if percentiles:
         percentiles = torch.quantile(times, torch.tensor(percentiles)).tolist()
         return tuple(percentiles)
@@ -209,6 +377,7 @@ class Benchmark:
         y_log=False,
         color=None,
         styles=None,
+        counters=None,
     ):
         """
         Constructor
@@ -235,6 +404,9 @@ class Benchmark:
         :type x_log: bool, optional
         :param y_log: Whether the y axis should be log scale.
         :type y_log: bool, optional
+        :param counters: Hardware counters collected by the :code:`do_bench` calls of the benchmark, reported
+            in the data as :code:`<line name>-<counter>` columns.
+        :type counters: Counters, optional
         """
         self.x_names = x_names
         self.x_vals = x_vals
@@ -249,6 +421,7 @@ class Benchmark:
         self.ylabel = ylabel
         self.plot_name = plot_name
         self.args = args
+        self.counters = counters
 
 
 class Mark:
@@ -264,12 +437,22 @@ class Mark:
         y_mean = bench.line_names
         y_min = [f'{x}-min' for x in bench.line_names]
         y_max = [f'{x}-max' for x in bench.line_names]
-        df = pd.DataFrame(columns=[bench.x_names[0]] + y_mean + y_min + y_max)
+        counters = bench.counters
+        y_counters = [f'{x}-{c}' for x in bench.line_names for c in counters.names] if counters else []
+        df = pd.DataFrame(columns=[bench.x_names[0]] + y_mean + y_min + y_max + y_counters)
         for x in bench.x_vals:
             x_args = {x_name: x for x_name in bench.x_names}
-            row_mean, row_min, row_max = [], [], []
-            for y in bench.line_vals:
-                ret = self.fn(**x_args, **{bench.line_arg: y}, **bench.args)
+            row_mean, row_min, row_max, row_counters = [], [], [], []
+            for y, y_name in zip(bench.line_vals, bench.line_names):
+                if counters:
+                    with counters.scope(f'{bench.plot_name}/{x}/{y_name}'):
+                        n_records = len(counters.records)
+                        ret = self.fn(**x_args, **{bench.line_arg: y}, **bench.args)
+                    # counters of the last benchmark run by `fn`
+                    last = counters.last if len(counters.records) > n_records else None
+                    row_counters += [last.get(c) if last else None for c in counters.names]
+                else:
+                    ret = self.fn(**x_args, **{bench.line_arg: y}, **bench.args)
                 try:
                     y_mean, y_min, y_max = ret
                 except TypeError:
@@ -277,7 +460,7 @@ class Mark:
                 row_mean += [y_mean]
                 row_min += [y_min]
                 row_max += [y_max]
-            df.loc[len(df)] = [x] + row_mean + row_min + row_max
+            df.loc[len(df)] = [x] + row_mean + row_min + row_max + row_counters
         if bench.plot_name:
             plt.figure()
             ax = plt.subplot()
@@ -300,7 +483,7 @@ class Mark:
                 plt.show()
             if save_path:
                 plt.savefig(os.path.join(save_path, f"{bench.plot_name}.png"))
-        df = df[[bench.x_names[0]] + bench.line_names]
+        df = df[[bench.x_names[0]] + bench.line_names + y_counters]
         if print_data:
             print(bench.plot_name + ':')
             print(df)
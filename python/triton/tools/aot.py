@@ -1,9 +1,212 @@
 import argparse
+import os
+import subprocess
 import sys
 
 import triton
 import triton._C.libtriton.triton as libtriton
 
+
+class AOTKernel:
+    '''
+    A specialization of a :code:`triton.jit`'d function to compile ahead of time.
+
+    :param fn: the jit'd function
+    :param name: name of the C entry point
+    :param signature: comma-separated types of the arguments that aren't in
+        `constants`, e.g. "*fp32:16, *fp32:16, i32"; ":16" declares that a
+        pointer (resp. integer) is always 16-byte aligned (resp. a multiple of 16)
+    :param constants: values of the constexpr arguments, by name
+    :param grid: optional C expressions of the grid, in terms of the argument
+        names, e.g. ("(n + 1023) / 1024", "1", "1"); the entry point then
+        doesn't take a grid
+    '''
+
+    def __init__(self, fn, name, signature, constants=None, num_warps=4, num_stages=3, grid=None):
+        self.fn = fn
+        self.name = name
+        self.constants = dict() if constants is None else constants
+        self.num_warps = num_warps
+        self.num_stages = num_stages
+        self.grid = grid
+        constant_idx = {fn.arg_names.index(name) for name in self.constants}
+        self.arg_idx = [i for i in range(len(fn.arg_names)) if i not in constant_idx]
+        tys = [ty.strip() for ty in signature.split(",")]
+        assert len(tys) == len(self.arg_idx), f"{name}: expected {len(self.arg_idx)} argument types"
+        self.signature = dict()
+        divisible_by_16 = set()
+        for i, ty in zip(self.arg_idx, tys):
+            ty, _, hint = ty.partition(":")
+            self.signature[i] = ty
+            if hint == "16":
+                divisible_by_16.add(i)
+        self.specialization = triton.compiler.instance_descriptor(divisible_by_16=divisible_by_16)
+
+    def compile(self, cc):
+        constants = {self.fn.arg_names.index(name): value for name, value in self.constants.items()}
+        kernel = triton.compile(self.fn, signature=self.signature, constants=constants,
+                                num_warps=self.num_warps, num_stages=self.num_stages,
+                                configs=[self.specialization], cc=cc)
+        if kernel.metadata.get("tma_descriptors"):
+            raise NotImplementedError(f"{self.name}: bulk copies aren't supported ahead of time")
+        return kernel
+
+
+def _c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join(f"0x{b:02x}" for b in data[i:i + 16]) + ",")
+    return f"static const unsigned char {name}[{len(data)}] = {{\n" + "\n".join(lines) + "\n};\n"
+
+
+def generate_library(kernels, name, out_dir, ccs=(80,)):
+    '''
+    Compiles `kernels` for the compute capabilities `ccs` and writes a C library
+    without any dependency on Python: `{name}.h` declares typed entry points and
+    `{name}.c` embeds the cubins together with their launch metadata (kernel
+    name, number of warps, shared memory).
+
+    `{name}_load()` loads, for the device of the current context, the cubin of
+    the highest compute capability of the same major version that it supports;
+    each kernel is then launched by its own entry point, e.g.
+    `CUresult add(CUstream stream, unsigned int gridX, unsigned int gridY, unsigned int gridZ, CUdeviceptr x, ...)`.
+    '''
+    header = ["/* generated by triton.tools.aot, do not edit */",
+              "#pragma once",
+              "#include <cuda.h>",
+              "#include <stdint.h>",
+              "",
+              "#ifdef __cplusplus",
+              "extern \"C\" {",
+              "#endif",
+              "",
+              "/* loads the kernels for the device of the current context */",
+              f"CUresult {name}_load(void);",
+              f"void {name}_unload(void);",
+              ""]
+    source = ["/* generated by triton.tools.aot, do not edit */",
+              f"#include \"{name}.h\"",
+              "",
+              "typedef struct {",
+              "  int cc;",
+              "  const unsigned char *image;",
+              "  const char *name;",
+              "  int shared;",
+              "} image_t;",
+              "",
+              "typedef struct {",
+              "  CUmodule module;",
+              "  CUfunction function;",
+              "  int shared;",
+              "} kernel_t;",
+              ""]
+    load = []
+    unload = []
+    for kernel in kernels:
+        images = []
+        for cc in sorted(ccs):
+            compiled = kernel.compile(cc)
+            array = f"{kernel.name}_sm{cc}"
+            source.append(_c_array(array, compiled.asm["cubin"]))
+            images.append(f"{{{cc}, {array}, \"{compiled.metadata['name']}\", {compiled.shared}}}")
+        source.append(f"static const image_t {kernel.name}_images[] = {{{', '.join(images)}}};")
+        source.append(f"static kernel_t {kernel.name}_kernel;")
+        source.append("")
+        # entry point
+        arg_names = [kernel.fn.arg_names[i] for i in kernel.arg_idx]
+        args = [f"{triton.compiler.ty_to_cpp(kernel.signature[i])} {kernel.fn.arg_names[i]}" for i in kernel.arg_idx]
+        grid_args = [] if kernel.grid else ["unsigned int gridX", "unsigned int gridY", "unsigned int gridZ"]
+        prototype = f"CUresult {kernel.name}({', '.join(['CUstream stream'] + grid_args + args)})"
+        constants = ", ".join(f"{k}={v}" for k, v in kernel.constants.items())
+        header.append(f"/* {kernel.fn.__name__}({constants}), num_warps={kernel.num_warps}, num_stages={kernel.num_stages} */")
+        header.append(prototype + ";")
+        header.append("")
+        source.append(prototype + " {")
+        if kernel.grid:
+            for dim, expr in zip("XYZ", kernel.grid):
+                source.append(f"  unsigned int grid{dim} = {expr};")
+        source.append(f"  void *params[] = {{ {', '.join('&' + arg for arg in arg_names)} }};")
+        source.append("  if (gridX * gridY * gridZ == 0)")
+        source.append("    return CUDA_SUCCESS;")
+        source.append(f"  return cuLaunchKernel({kernel.name}_kernel.function, gridX, gridY, gridZ, "
+                      f"{32 * kernel.num_warps}, 1, 1, {kernel.name}_kernel.shared, stream, params, NULL);")
+        source.append("}")
+        source.append("")
+        load.append(f"  err = load_kernel(&{kernel.name}_kernel, {kernel.name}_images, "
+                    f"{len(images)}, cc, device);")
+        load.append("  if (err != CUDA_SUCCESS)")
+        load.append("    return err;")
+        unload.append(f"  if ({kernel.name}_kernel.module)")
+        unload.append(f"    cuModuleUnload({kernel.name}_kernel.module);")
+        unload.append(f"  {kernel.name}_kernel.module = NULL;")
+    source += ["static CUresult load_kernel(kernel_t *kernel, const image_t *images, int n, int cc, CUdevice device) {",
+               "  const image_t *image = NULL;",
+               "  /* cubins run on devices of the same major version and higher minor version */",
+               "  for (int i = 0; i < n; ++i)",
+               "    if (images[i].cc / 10 == cc / 10 && images[i].cc <= cc)",
+               "      image = &images[i];",
+               "  if (!image)",
+               "    return CUDA_ERROR_NO_BINARY_FOR_GPU;",
+               "  CUresult err = cuModuleLoadData(&kernel->module, image->image);",
+               "  if (err != CUDA_SUCCESS)",
+               "    return err;",
+               "  err = cuModuleGetFunction(&kernel->function, kernel->module, image->name);",
+               "  if (err != CUDA_SUCCESS)",
+               "    return err;",
+               "  kernel->shared = image->shared;",
+               "  /* set dynamic shared memory if necessary */",
+               "  int shared_optin, shared_static;",
+               "  cuDeviceGetAttribute(&shared_optin, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK_OPTIN, device);",
+               "  if (image->shared > 49152 && shared_optin > 49152) {",
+               "    cuFuncSetCacheConfig(kernel->function, CU_FUNC_CACHE_PREFER_SHARED);",
+               "    cuFuncGetAttribute(&shared_static, CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES, kernel->function);",
+               "    err = cuFuncSetAttribute(kernel->function, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,",
+               "                             shared_optin - shared_static);",
+               "  }",
+               "  return err;",
+               "}",
+               "",
+               f"CUresult {name}_load(void) {{",
+               "  CUdevice device;",
+               "  int major, minor;",
+               "  CUresult err = cuCtxGetDevice(&device);",
+               "  if (err != CUDA_SUCCESS)",
+               "    return err;",
+               "  cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device);",
+               "  cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, device);",
+               "  int cc = major * 10 + minor;"] + load + \
+              ["  return CUDA_SUCCESS;",
+               "}",
+               "",
+               f"void {name}_unload(void) {{"] + unload + ["}", ""]
+    header += ["#ifdef __cplusplus",
+               "}",
+               "#endif",
+               ""]
+    os.makedirs(out_dir, exist_ok=True)
+    header_path = os.path.join(out_dir, f"{name}.h")
+    source_path = os.path.join(out_dir, f"{name}.c")
+    with open(header_path, "w") as f:
+        f.write("\n".join(header))
+    with open(source_path, "w") as f:
+        f.write("\n".join(source))
+    return header_path, source_path
+
+
+def build_library(source_path, out_path):
+    '''
+    Builds the shared library of a source generated by `generate_library`;
+    it only links against libcuda.
+    '''
+    cuda_path = os.environ.get('CUDA_PATH', triton.compiler.default_cuda_dir())
+    cc = os.environ.get("CC", "gcc")
+    cmd = [cc, source_path, "-O3", "-shared", "-fPIC", f"-I{os.path.join(cuda_path, 'include')}",
+           "-lcuda", "-o", out_path]
+    cmd += [f"-L{dir}" for dir in triton.compiler.libcuda_dirs()]
+    subprocess.check_call(cmd)
+    return out_path
+
+
 if __name__ == '__main__':
 
     # valid source and target formats
@@ -139,3 +139,67 @@ func @vecadd_mask_align_1(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg
   tt.store %15, %13, %10 : tensor<64xf32>
   return
 }
+
+// -----
+
+func @range(%arg0: i32) {
+  // CHECK: Range: [0, 65534] ( %{{.*}} = tt.get_program_id {axis = 1 : i32}
+  %pid = tt.get_program_id {axis = 1 : i32} : i32
+  // CHECK-NEXT: Range: [0, 127] ( %{{.*}} = tt.make_range
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK-NEXT: Range: [128, 128] ( %{{.*}} = arith.constant
+  %c128 = arith.constant dense<128> : tensor<128xi32>
+  // CHECK-NEXT: Range: [64, 64] ( %{{.*}} = arith.constant
+  %c64 = arith.constant dense<64> : tensor<128xi32>
+  // CHECK-NEXT: Range: [-64, 63] ( %{{.*}} = arith.subi
+  %1 = arith.subi %0, %c64 : tensor<128xi32>
+  // CHECK-NEXT: Range: [1, 1] ( %{{.*}} = arith.cmpi slt
+  %2 = arith.cmpi slt, %0, %c128 : tensor<128xi32>
+  // CHECK-NEXT: Range: [0, 1] ( %{{.*}} = arith.cmpi slt
+  %3 = arith.cmpi slt, %0, %c64 : tensor<128xi32>
+  // CHECK-NEXT: Range: [0, 1] ( %{{.*}} = arith.andi
+  %4 = arith.andi %2, %3 : tensor<128xi1>
+  // CHECK-NEXT: Range: [0, 63] ( %{{.*}} = arith.remsi
+  %5 = arith.remsi %0, %c64 : tensor<128xi32>
+  // CHECK-NEXT: Range: [1, 1] ( %{{.*}} = arith.cmpi slt
+  %6 = arith.cmpi slt, %5, %c64 : tensor<128xi32>
+  // CHECK-NEXT: Constancy: [128] ( %{{.*}} = tt.splat
+  %7 = tt.splat %arg0 : (i32) -> tensor<128xi32>
+  // CHECK-NEXT: Constancy: [1] ( %{{.*}} = arith.cmpi slt
+  %8 = arith.cmpi slt, %0, %7 : tensor<128xi32>
+  return
+}
+
+// -----
+
+func @loop_range(%arg0: i32) {
+  %c0 = arith.constant 0 : i32
+  %c8 = arith.constant 8 : i32
+  %c100 = arith.constant 100 : i32
+  scf.for %iv = %c0 to %c100 step %c8 : i32 {
+    // CHECK: Range: [0, 96] ( %{{.*}} = arith.addi
+    %0 = arith.addi %iv, %c0 : i32
+  }
+  return
+}
+
+// -----
+
+func @extsi_range() {
+  %c64 = arith.constant dense<64> : tensor<128xi32>
+  %c128 = arith.constant dense<128> : tensor<128xi32>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32>
+  // CHECK: Range: [1, 1] ( %{{.*}} = arith.cmpi slt
+  %1 = arith.cmpi slt, %0, %c128 : tensor<128xi32>
+  // CHECK-NEXT: Range: [-1, -1] ( %{{.*}} = arith.extsi
+  %2 = arith.extsi %1 : tensor<128xi1> to tensor<128xi32>
+  // CHECK-NEXT: Range: [0, 1] ( %{{.*}} = arith.cmpi slt
+  %3 = arith.cmpi slt, %0, %c64 : tensor<128xi32>
+  // CHECK-NEXT: Range: [-1, 0] ( %{{.*}} = arith.extsi
+  %4 = arith.extsi %3 : tensor<128xi1> to tensor<128xi32>
+  // CHECK-NEXT: Range: [0, 1] ( %{{.*}} = arith.extui
+  %5 = arith.extui %3 : tensor<128xi1> to tensor<128xi32>
+  // CHECK-NEXT: Range: [0, 127] ( %{{.*}} = arith.extsi
+  %6 = arith.extsi %0 : tensor<128xi32> to tensor<128xi64>
+  return
+}
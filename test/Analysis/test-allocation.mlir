@@ -7,6 +7,10 @@
 #A_SHARED_T = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [0, 1]}>
 #B_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
 #C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#ROW8 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#COL8 = #triton_gpu.blocked<{sizePerThread = [8, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [0, 1]}>
+#ROW4 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#COL4 = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [0, 1]}>
 #A_DOT = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
 #B_DOT = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
 
@@ -155,6 +159,29 @@ func @longlive(%A : !tt.ptr<f16>) {
   // CHECK-NEXT: size = 2560
 }
 
+// The coloring places %cst3 at 4608, above both %cst0 and %cst1, although
+// %cst0 is dead by then: compaction moves it down to 2560
+// CHECK-LABEL: compact
+func @compact(%A : !tt.ptr<f16>) {
+  // CHECK: offset = 0, size = 2048
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<64x16xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 2048, size = 512
+  %cst1 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  %a0 = triton_gpu.convert_layout %cst0 : (tensor<64x16xf16, #A_SHARED>) -> tensor<64x16xf16, #A_DOT>
+  // CHECK-NEXT: offset = 0, size = 512
+  %cst2 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK-NEXT: offset = 2560, size = 2048
+  %cst3 = arith.constant dense<0.000000e+00> : tensor<64x16xf16, #A_SHARED>
+  %a1 = triton_gpu.convert_layout %cst1 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #A_DOT>
+  %a2 = triton_gpu.convert_layout %cst2 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #A_DOT>
+  %a3 = triton_gpu.convert_layout %cst1 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #A_DOT>
+  // CHECK-NEXT: offset = 0, size = 2048
+  %cst4 = arith.constant dense<0.000000e+00> : tensor<64x16xf16, #A_SHARED>
+  %a4 = triton_gpu.convert_layout %cst3 : (tensor<64x16xf16, #A_SHARED>) -> tensor<64x16xf16, #A_DOT>
+  return
+  // CHECK-NEXT: size = 4608
+}
+
 // CHECK-LABEL: alloc
 func @alloc(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 512
@@ -175,6 +202,47 @@ func @scratch() {
   // CHECK-NEXT: size = 512
 }
 
+// CHECK-LABEL: cvt_scratch
+func @cvt_scratch() {
+  // The 32x32 block transposed at a time is swizzled, without padding
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xbf16, #ROW8>
+  // CHECK: scratch offset = 0, size = 2048
+  %0 = triton_gpu.convert_layout %cst0 : (tensor<64x64xbf16, #ROW8>) -> tensor<64x64xbf16, #COL8>
+  // No swizzle avoids the conflicts of the scalar accesses: the columns of
+  // the block are padded
+  %cst1 = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #ROW4>
+  // CHECK-NEXT: scratch offset = 0, size = 4224
+  %1 = triton_gpu.convert_layout %cst1 : (tensor<32x32xf32, #ROW4>) -> tensor<32x32xf32, #COL4>
+  return
+  // CHECK-NEXT: size = 4224
+}
+
+// The accumulator stored by an epilogue is converted in one replica when it
+// fits in the shared memory of the buffers dead by then
+// CHECK-LABEL: epilogue_cvt_whole
+func @epilogue_cvt_whole(%A : !tt.ptr<f16>) {
+  // CHECK: offset = 0, size = 32768
+  %a = triton_gpu.alloc_tensor : tensor<128x128xf16, #A_SHARED>
+  %c = arith.constant dense<0.000000e+00> : tensor<128x64xf16, #C>
+  // CHECK-NEXT: scratch offset = 0, size = 18432
+  %0 = triton_gpu.convert_layout %c : (tensor<128x64xf16, #C>) -> tensor<128x64xf16, #ROW8>
+  %ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<128x64x!tt.ptr<f16>, #ROW8>
+  tt.store %ptr, %0 : tensor<128x64xf16, #ROW8>
+  return
+  // CHECK-NEXT: size = 32768
+}
+
+// CHECK-LABEL: epilogue_cvt_replicas
+func @epilogue_cvt_replicas(%A : !tt.ptr<f16>) {
+  %c = arith.constant dense<0.000000e+00> : tensor<128x64xf16, #C>
+  // CHECK: scratch offset = 0, size = 5120
+  %0 = triton_gpu.convert_layout %c : (tensor<128x64xf16, #C>) -> tensor<128x64xf16, #ROW8>
+  %ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<128x64x!tt.ptr<f16>, #ROW8>
+  tt.store %ptr, %0 : tensor<128x64xf16, #ROW8>
+  return
+  // CHECK-NEXT: size = 5120
+}
+
 // CHECK-LABEL: trans
 func @trans(%A : !tt.ptr<f16>) {
   // CHECK: offset = 0, size = 1024
@@ -151,6 +151,51 @@ func @insert_slice(%A : !tt.ptr<f16>, %i1 : i1) {
   return
 }
 
+// Reading a slice of the buffer does not depend on the copy into another slice
+// CHECK-LABEL: insert_slice_async_disjoint
+func @insert_slice_async_disjoint(%A : !tt.ptr<f16>, %i1 : i1) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %mask = tt.splat %i1 : (i1) -> tensor<16x16xi1, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %tensor = triton_gpu.alloc_tensor : tensor<2x16x16xf16, #A_SHARED>
+  %index = arith.constant 0 : i32
+  %a = triton_gpu.insert_slice_async %a_ptr, %tensor, %index, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<2x16x16xf16, #A_SHARED>
+  %b = tensor.extract_slice %a[1, 0, 0][1, 16, 16][1, 1, 1] : tensor<2x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  %b_ = triton_gpu.convert_layout %b : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  %c = tensor.extract_slice %a[0, 0, 0][1, 16, 16][1, 1, 1] : tensor<2x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  // CHECK-NEXT: Membar 9
+  %c_ = triton_gpu.convert_layout %c : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  return
+}
+
+// Values derived from a slice of the buffer, such as its transposition, only span the slice
+// CHECK-LABEL: insert_slice_async_disjoint_trans
+func @insert_slice_async_disjoint_trans(%A : !tt.ptr<f16>, %i1 : i1) {
+  %a_ptr = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>, #AL>
+  %mask = tt.splat %i1 : (i1) -> tensor<16x16xi1, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #AL>
+  %tensor = triton_gpu.alloc_tensor : tensor<2x16x16xf16, #A_SHARED>
+  %index = arith.constant 0 : i32
+  %a = triton_gpu.insert_slice_async %a_ptr, %tensor, %index, %mask, %other {axis = 0 : i32, cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<16x16x!tt.ptr<f16>, #AL> -> tensor<2x16x16xf16, #A_SHARED>
+  %b = tensor.extract_slice %a[1, 0, 0][1, 16, 16][1, 1, 1] : tensor<2x16x16xf16, #A_SHARED> to tensor<16x16xf16, #A_SHARED>
+  %b_t = tt.trans %b : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #A_SHARED_T>
+  // CHECK-NOT: Membar
+  %b_ = triton_gpu.convert_layout %b_t : (tensor<16x16xf16, #A_SHARED_T>) -> tensor<16x16xf16, #AL>
+  return
+}
+
+// A barrier that follows another one without any shared memory access in between is removed
+// CHECK-LABEL: redundant_barrier
+func @redundant_barrier() {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<16x16xf16, #A_SHARED>
+  // CHECK-NEXT: Membar 1
+  gpu.barrier
+  // CHECK-NOT: Membar 2
+  gpu.barrier
+  %a = triton_gpu.convert_layout %cst0 : (tensor<16x16xf16, #A_SHARED>) -> tensor<16x16xf16, #AL>
+  return
+}
+
 // If branch inserted a barrier for %cst0 and %cst1, but else didn't, then the barrier should be inserted in the parent region
 // CHECK-LABEL: multi_blocks
 func @multi_blocks(%i1 : i1) {
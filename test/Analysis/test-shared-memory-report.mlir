@@ -0,0 +1,74 @@
+// RUN: triton-opt %s -split-input-file --mlir-disable-threading -test-print-shared-memory-report 2>&1 | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#A_SHARED = #triton_gpu.shared<{vec = 2, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: store_load
+func @store_load(%A : tensor<128x32xf16, #AL>) {
+  // CHECK-NEXT: "accesses":[{
+  // CHECK-SAME: "ideal_wavefronts":1,"kind":"store"
+  // CHECK-SAME: "vec_bytes":4,"wavefronts":1}
+  // CHECK-SAME: "ideal_wavefronts":1,"kind":"load"
+  // CHECK-SAME: "vec_bytes":4,"wavefronts":1}]
+  // CHECK-SAME: "barriers":[{"before":"triton_gpu.convert_layout","before_id":1,
+  // CHECK-SAME: "buffers":[{
+  // CHECK-SAME: "kind":"explicit","liveness":[0,2]
+  // CHECK-SAME: "offset":0,"op":"triton_gpu.convert_layout","op_id":0,"size":8192}]
+  // CHECK-SAME: "eliminated_barriers":0,"size":8192}
+  %0 = triton_gpu.convert_layout %A : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A_SHARED>
+  %1 = triton_gpu.convert_layout %0 : (tensor<128x32xf16, #A_SHARED>) -> tensor<128x32xf16, #AL>
+  return
+}
+
+}
+
+// -----
+
+#COL = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
+#PLAIN = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#SWIZZLED = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: column_store
+func @column_store(%A : tensor<32x32xf32, #COL>) {
+  // Every lane of the warp hits bank 0 without swizzling, and 8 banks with it
+  // CHECK-NEXT: "accesses":[{
+  // CHECK-SAME: "ideal_wavefronts":1,"kind":"store"
+  // CHECK-SAME: "vec_bytes":4,"wavefronts":32}
+  // CHECK-SAME: "ideal_wavefronts":1,"kind":"store"
+  // CHECK-SAME: "vec_bytes":4,"wavefronts":4}]
+  %0 = triton_gpu.convert_layout %A : (tensor<32x32xf32, #COL>) -> tensor<32x32xf32, #PLAIN>
+  %1 = triton_gpu.convert_layout %A : (tensor<32x32xf32, #COL>) -> tensor<32x32xf32, #SWIZZLED>
+  %2 = triton_gpu.convert_layout %0 : (tensor<32x32xf32, #PLAIN>) -> tensor<32x32xf32, #COL>
+  %3 = triton_gpu.convert_layout %1 : (tensor<32x32xf32, #SWIZZLED>) -> tensor<32x32xf32, #COL>
+  return
+}
+
+}
+
+// -----
+
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A_DOT = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#PLAIN = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#SWIZZLED = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// CHECK-LABEL: ldmatrix
+func @ldmatrix(%A : tensor<128x32xf16, #PLAIN>, %B : tensor<128x32xf16, #SWIZZLED>) {
+  // Rows of 64 bytes map every other row to the same banks without swizzling
+  // CHECK-NEXT: "accesses":[{"buffers":[],"ideal_wavefronts":1,"kind":"load"
+  // CHECK-SAME: "vec_bytes":16,"wavefronts":4}
+  // CHECK-SAME: "buffers":[],"ideal_wavefronts":1,"kind":"load"
+  // CHECK-SAME: "vec_bytes":16,"wavefronts":1}]
+  // CHECK-SAME: "barriers":[],"buffers":[],"eliminated_barriers":0,"size":0}
+  %0 = triton_gpu.convert_layout %A : (tensor<128x32xf16, #PLAIN>) -> tensor<128x32xf16, #A_DOT>
+  %1 = triton_gpu.convert_layout %B : (tensor<128x32xf16, #SWIZZLED>) -> tensor<128x32xf16, #A_DOT>
+  return
+}
+
+}
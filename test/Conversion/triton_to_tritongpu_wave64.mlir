@@ -0,0 +1,18 @@
+// RUN: triton-opt %s -convert-triton-to-tritongpu="num-warps=4 threads-per-warp=64" | FileCheck %s
+
+// CHECK-DAG: [[blocked:#.*]] = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [64], warpsPerCTA = [4], order = [0]}>
+// CHECK-DAG: [[dot:#.*]] = #triton_gpu.blocked<{sizePerThread = [4, 4], threadsPerWarp = [2, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+// CHECK: module attributes {"triton_gpu.num-ctas" = 1 : i32, "triton_gpu.num-warps" = 4 : i32, "triton_gpu.threads-per-warp" = 64 : i32}
+
+func @wave64(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+  // CHECK: tensor<256xf32, [[blocked]]>
+  %0 = arith.constant dense<1.00e+00> : tensor<256xf32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>>
+  tt.store %1, %0 : tensor<256xf32>
+  %a = arith.constant dense<1.00e+00> : tensor<128x32xf16>
+  %b = arith.constant dense<2.00e+00> : tensor<32x128xf16>
+  %c = arith.constant dense<3.00e+00> : tensor<128x128xf32>
+  // CHECK: tt.dot {{.*}} -> tensor<128x128xf32, [[dot]]>
+  %2 = tt.dot %a, %b, %c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16> * tensor<32x128xf16> -> tensor<128x128xf32>
+  return
+}
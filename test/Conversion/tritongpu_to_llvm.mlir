@@ -40,6 +40,35 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: store_cache_hints
+  func @store_cache_hints(%ptr : tensor<128x!tt.ptr<f32>, #blocked0>, %val : tensor<128xf32, #blocked0>) {
+    // CHECK: createpolicy.fractional.L2::evict_first.b64
+    // CHECK: st.global.L1::no_allocate.L2::cache_hint.b32
+    tt.store %ptr, %val {evict = 4 : i32} : tensor<128xf32, #blocked0>
+    // CHECK-NOT: createpolicy
+    // CHECK: st.global.cs.b32
+    tt.store %ptr, %val {cache = 4 : i32} : tensor<128xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: streaming_load
+  func @streaming_load(%ptr : tensor<128x!tt.ptr<f32>, #blocked0>) {
+    // CHECK: createpolicy.fractional.L2::evict_first.b64
+    // CHECK: ld.global.nc.L1::no_allocate.L2::cache_hint.b32
+    %0 = tt.load %ptr {cache = 6 : i32, evict = 4 : i32, isVolatile = false} : tensor<128xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [8], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 1 : i32} {
   // CHECK-LABEL: vectorized_load_f16
@@ -229,6 +258,36 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   }
 }
 
+// -----
+
+// The pointers are contiguous along the columns, which are vectorized although
+// they aren't first in the order of the layout
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 1], order = [1, 0]}>
+#slice0 = #triton_gpu.slice<{dim = 0, parent = #blocked0}>
+#slice1 = #triton_gpu.slice<{dim = 1, parent = #blocked0}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: global_store_vec4_minor_axis
+  func @global_store_vec4_minor_axis(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<8x64xf32, #blocked0>
+    %0 = tt.make_range {end = 8 : i32, start = 0 : i32} : tensor<8xi32, #slice1>
+    %1 = tt.expand_dims %0 {axis = 1 : i32} : (tensor<8xi32, #slice1>) -> tensor<8x1xi32, #blocked0>
+    %2 = tt.make_range {end = 64 : i32, start = 0 : i32} : tensor<64xi32, #slice0>
+    %3 = tt.expand_dims %2 {axis = 0 : i32} : (tensor<64xi32, #slice0>) -> tensor<1x64xi32, #blocked0>
+    %4 = tt.splat %arg1 : (i32) -> tensor<1x64xi32, #blocked0>
+    %5 = arith.muli %3, %4 : tensor<1x64xi32, #blocked0>
+    %6 = tt.broadcast %1 : (tensor<8x1xi32, #blocked0>) -> tensor<8x64xi32, #blocked0>
+    %7 = tt.broadcast %5 : (tensor<1x64xi32, #blocked0>) -> tensor<8x64xi32, #blocked0>
+    %8 = arith.addi %6, %7 : tensor<8x64xi32, #blocked0>
+    %9 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<8x64x!tt.ptr<f32>, #blocked0>
+    %10 = tt.addptr %9, %8 : tensor<8x64x!tt.ptr<f32>, #blocked0>, tensor<8x64xi32, #blocked0>
+    // Each thread stores its 4x4 elements with 4 vectorized store instructions
+    // CHECK-COUNT-4: st.global.v4.b32 [ ${{.*}} + 0 ], { ${{.*}}, ${{.*}}, ${{.*}}, ${{.*}} };
+    // CHECK-NOT: st.global.b32
+    tt.store %10, %cst : tensor<8x64xf32, #blocked0>
+    return
+  }
+}
+
 // TODO: Add a testcase to verify the optimization when ptr of the LoadOp
 //       is from an addptr with const idx
 
@@ -287,6 +346,32 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: packed_addf_f16
+  func @packed_addf_f16(%arg0 : tensor<256xf16,#blocked0>, %arg1 : tensor<256xf16,#blocked0>) {
+    // CHECK: llvm.fadd {{.*}} : vector<2xf16>
+    // CHECK-NOT: llvm.fadd
+    %1 = arith.addf %arg0, %arg1 : tensor<256xf16,#blocked0>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: packed_mulf_bf16
+  func @packed_mulf_bf16(%arg0 : tensor<256xbf16,#blocked0>, %arg1 : tensor<256xbf16,#blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: fma.rn.bf16x2
+    %1 = arith.mulf %arg0, %arg1 : tensor<256xbf16,#blocked0>
+    return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: basic_addi
@@ -387,6 +472,51 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#A = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-DAG: llvm.mlir.global internal @tma_mbarrier_0() {{.*}} : !llvm.array<3 x i64>
+  // CHECK-DAG: llvm.mlir.global external @global_smem() {{.*}}alignment = 1024
+  // CHECK-LABEL: basic_insert_slice_tma
+  func @basic_insert_slice_tma(%desc: !tt.ptr<i8>, %col: i32, %row: i32, %pred: i1) {
+    // CHECK: mbarrier.init.shared.b64
+    // CHECK-SAME: fence.proxy.async.shared::cta
+    triton_gpu.init_mbarrier {id = 0 : i32, num = 3 : i32}
+    %tensor = triton_gpu.alloc_tensor : tensor<3x128x32xf16, #A>
+    %index = arith.constant 1 : i32
+    // CHECK: mbarrier.arrive.expect_tx.shared.b64
+    // CHECK-SAME: cp.async.bulk.tensor.2d.shared::cluster.global.mbarrier::complete_tx::bytes
+    %a = triton_gpu.insert_slice_tma %desc[%col, %row], %tensor, %index, %pred {mbarrier = 0 : i32} : !tt.ptr<i8>, tensor<3x128x32xf16, #A>
+    // CHECK: mbarrier.try_wait.parity.shared.b64
+    triton_gpu.wait_mbarrier %index, %index {id = 0 : i32}
+    return
+  }
+}
+
+// -----
+
+#A = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+module attributes {"triton_gpu.num-ctas" = 2 : i32, "triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: multicast_insert_slice_tma
+  func @multicast_insert_slice_tma(%desc: !tt.ptr<i8>, %col: i32, %row: i32, %pred: i1) {
+    // CHECK: barrier.cluster.arrive.release.aligned
+    // CHECK: mbarrier.init.shared.b64
+    // CHECK-SAME: fence.mbarrier_init.release.cluster
+    // CHECK: barrier.cluster.arrive.release.aligned
+    triton_gpu.init_mbarrier {id = 0 : i32, num = 3 : i32}
+    %tensor = triton_gpu.alloc_tensor : tensor<3x128x32xf16, #A>
+    %index = arith.constant 1 : i32
+    // CHECK: barrier.cluster.arrive.release.aligned
+    // CHECK: mov.u32 $0, %cluster_ctarank;
+    // CHECK: mbarrier.arrive.expect_tx.shared.b64
+    // CHECK-SAME: complete_tx::bytes.multicast::cluster
+    %a = triton_gpu.insert_slice_tma %desc[%col, %row], %tensor, %index, %pred {mbarrier = 0 : i32, multicast = 2 : i32} : !tt.ptr<i8>, tensor<3x128x32xf16, #A>
+    triton_gpu.wait_mbarrier %index, %index {id = 0 : i32}
+    return
+  }
+}
+
+// -----
+
 #block0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [4], warpsPerCTA = [4], order = [0]}>
 #block1 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [8], warpsPerCTA = [4], order = [0]}>
 #block2 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [4, 1], warpsPerCTA = [4, 1], order = [1, 0]}>
@@ -653,16 +783,11 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   // CHECK: llvm.mlir.global external @global_smem() {addr_space = 3 : i32} : !llvm.array<0 x i8>
   // CHECK-LABEL: convert_layout_blocked_blocked_vec
   func @convert_layout_blocked_blocked_vec(%arg0: tensor<16x16xf32, #blocked0>) {
-    // CHECK: llvm.mlir.addressof @global_smem
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: llvm.store
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: nvvm.barrier0
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
-    // CHECK: llvm.load
-    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    // Each warp keeps its elements: the conversion is done with shuffles
+    // CHECK-NOT: llvm.store
+    // CHECK-COUNT-16: shfl.sync.idx.b32
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK-NOT: llvm.load
     %0 = triton_gpu.convert_layout %arg0 : (tensor<16x16xf32, #blocked0>) -> tensor<16x16xf32, #blocked1>
     return
   }
@@ -699,6 +824,30 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [1, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: convert_layout_blocked_blocked_swizzled
+  func @convert_layout_blocked_blocked_swizzled(%arg0: tensor<32x32xf32, #blocked0>) {
+    // Rows of 32 floats put the two rows stored by 8 lanes in the same banks:
+    // odd rows xor their chunks of 16 columns instead of being padded
+    // CHECK: llvm.xor
+    // CHECK: llvm.store
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    // CHECK: llvm.xor
+    // CHECK: llvm.store
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.xor
+    // CHECK: llvm.load
+    // CHECK-SAME: !llvm.ptr<vector<4xf32>, 3>
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<32x32xf32, #blocked0>) -> tensor<32x32xf32, #blocked1>
+    return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 #shared0 = #triton_gpu.shared<{vec = 1, perPhase=2, maxPhase=8 ,order = [1, 0]}>
 #mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,1]}>
@@ -727,6 +876,63 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
   }
 }
 
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 8, perPhase=1, maxPhase=8 ,order = [1, 0]}>
+#mma0 = #triton_gpu.mma<{versionMajor=3, warpsPerCTA=[4,1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_dot_wgmma
+  func @convert_dot_wgmma(%A: tensor<64x64xf16, #blocked0>, %B: tensor<64x64xf16, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<64x64xf16, #blocked0>) -> tensor<64x64xf16, #shared0>
+    %BB = triton_gpu.convert_layout %B : (tensor<64x64xf16, #blocked0>) -> tensor<64x64xf16, #shared0>
+    // CHECK-NOT: ldmatrix
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<64x64xf16, #shared0>) -> tensor<64x64xf16, #dot_operand_a>
+    %BB_DOT = triton_gpu.convert_layout %BB : (tensor<64x64xf16, #shared0>) -> tensor<64x64xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #mma0>
+
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: fence.proxy.async.shared::cta
+    // CHECK-SAME: wgmma.fence.sync.aligned
+    // CHECK-SAME: wgmma.mma_async.sync.aligned.m64n64k16.f32.f16.f16
+    // CHECK-SAME: wgmma.commit_group.sync.aligned
+    // CHECK-SAME: wgmma.wait_group.sync.aligned
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true, transA = false, transB = false} : tensor<64x64xf16, #dot_operand_a> * tensor<64x64xf16, #dot_operand_b> -> tensor<64x64xf32, #mma0>
+
+    return
+  }
+}
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [4, 8], warpsPerCTA = [1, 4], order = [0, 1]}>
+#shared0 = #triton_gpu.shared<{vec = 8, perPhase=1, maxPhase=8 ,order = [1, 0]}>
+#shared1 = #triton_gpu.shared<{vec = 16, perPhase=1, maxPhase=4 ,order = [0, 1]}>
+#mma0 = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[1,4]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma0}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma0}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_dot_int4_weights
+  func @convert_dot_int4_weights(%A: tensor<16x64xf16, #blocked0>, %W: tensor<32x128xi8, #blocked0>) {
+    %AA = triton_gpu.convert_layout %A : (tensor<16x64xf16, #blocked0>) -> tensor<16x64xf16, #shared0>
+    %WW = triton_gpu.convert_layout %W : (tensor<32x128xi8, #blocked0>) -> tensor<32x128xi8, #shared1>
+    %AA_DOT = triton_gpu.convert_layout %AA : (tensor<16x64xf16, #shared0>) -> tensor<16x64xf16, #dot_operand_a>
+    // CHECK-NOT: ldmatrix
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: lop3.b32 a, a, 0x000f000f, 0x64006400, 0xea
+    // CHECK-SAME: sub.f16x2
+    %BB_DOT = triton_gpu.dequantize %WW : (tensor<32x128xi8, #shared1>) -> tensor<64x128xf16, #dot_operand_b>
+    %cst0 = arith.constant dense<0.000000e+00> : tensor<16x128xf32, #mma0>
+
+    // CHECK: mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32
+    %D = tt.dot %AA_DOT, %BB_DOT, %cst0 {allowTF32 = true, transA = false, transB = false} : tensor<16x64xf16, #dot_operand_a> * tensor<64x128xf16, #dot_operand_b> -> tensor<16x128xf32, #mma0>
+
+    return
+  }
+}
+
+// -----
+
 // TODO: problems in MLIR's parser on slice layout
 // #blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [1, 1], order = [1, 0]}>
 // module attributes {"triton_gpu.num-warps" = 1 : i32} {
@@ -841,6 +1047,22 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
 
 // -----
 
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The f16 accumulators are the $a fragments in registers
+  // CHECK-LABEL: convert_mma_to_dot_operand
+  func @convert_mma_to_dot_operand(%acc : tensor<64x64xf16, #mma>) {
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK: llvm.return
+    %0 = triton_gpu.convert_layout %acc : (tensor<64x64xf16, #mma>) -> tensor<64x64xf16, #dot_operand_a>
+    return
+  }
+}
+
+// -----
+
 #blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
 #shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
 #mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [2, 2]}>
@@ -952,6 +1174,36 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 // -----
 
+#mma = #triton_gpu.mma<{versionMajor=2, warpsPerCTA=[2, 2]}>
+#shared = #triton_gpu.shared<{vec = 1, perPhase = 1, maxPhase = 1, order = [1, 0]}>
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [1, 4], order = [1, 0]}>
+#dot_operand_a = #triton_gpu.dot_op<{opIdx=0, parent=#mma}>
+#dot_operand_b = #triton_gpu.dot_op<{opIdx=1, parent=#mma}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: matmul_tf32x3dot
+  func @matmul_tf32x3dot(%ptr:!tt.ptr<f32> {tt.divisibility = 16 : i32},
+  %a:tensor<32x16xf32, #shared>, %b:tensor<16x32xf32, #shared>) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<32x32xf32, #mma>
+    %a_mat = triton_gpu.convert_layout %a : (tensor<32x16xf32, #shared>) -> tensor<32x16xf32, #dot_operand_a>
+    %b_mat = triton_gpu.convert_layout %b : (tensor<16x32xf32, #shared>) -> tensor<16x32xf32, #dot_operand_b>
+
+    // CHECK: llvm.and {{.*}} : i32
+    // CHECK: llvm.fsub {{.*}} : vector<1xf32>
+    // three mma per tile of the tf32 dot above
+    // CHECK-COUNT-12: mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32
+    // CHECK-NOT: mma.sync
+    %28 = tt.dot %a_mat, %b_mat, %cst {allowTF32 = true, tf32x3} : tensor<32x16xf32, #dot_operand_a> * tensor<16x32xf32, #dot_operand_b> -> tensor<32x32xf32, #mma>
+    %38 = triton_gpu.convert_layout %28 : (tensor<32x32xf32, #mma>) -> tensor<32x32xf32, #blocked>
+
+    %30 = tt.splat %ptr : (!tt.ptr<f32>) -> tensor<32x1x!tt.ptr<f32>, #blocked>
+    %36 = tt.broadcast %30 : (tensor<32x1x!tt.ptr<f32>, #blocked>) -> tensor<32x32x!tt.ptr<f32>, #blocked>
+    tt.store %36, %38 : tensor<32x32xf32, #blocked>
+    return
+  }
+}
+
+// -----
+
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
   // CHECK-LABEL: atomic_add_f32
@@ -959,6 +1211,78 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
     // CHECK: llvm.inline_asm
     // CHECK-SAME: atom.global.gpu.add.f32
     %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    tt.store %arg0, %0 : tensor<256xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // An atomic whose result is unused is lowered to a reduction
+  // CHECK-LABEL: atomic_add_f32_unused
+  func @atomic_add_f32_unused(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
+    // CHECK: llvm.inline_asm
+    // CHECK-SAME: red.global.gpu.add.f32
+    // CHECK-NOT: atom.global
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: atomic_add_f32_warp_aggregate
+  func @atomic_add_f32_warp_aggregate(%arg0 : tensor<256x!tt.ptr<f32>, #blocked0>, %arg1 : tensor<256xi1, #blocked0>, %arg2 : tensor<256xf32, #blocked0>) {
+    // CHECK: match.any.sync.b64
+    // CHECK: vote.sync.ballot.b32
+    // CHECK: fns.b32
+    // CHECK: shfl.sync.idx.b32
+    // CHECK: red.global.gpu.add.f32
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 5 : i32, warp_aggregate} : (tensor<256x!tt.ptr<f32>, #blocked0>, tensor<256xf32, #blocked0>, tensor<256xi1, #blocked0>) -> tensor<256xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The update is released after the writes of all the threads, and its
+  // result acquired before the reads of all the threads
+  // CHECK-LABEL: atomic_add_i32_grid_sync
+  func @atomic_add_i32_grid_sync(%arg0 : !tt.ptr<i32>, %arg1 : i1, %arg2 : i32) {
+    // CHECK: nvvm.barrier0
+    // CHECK: membar.gl
+    // CHECK: atom.global.gpu.add.s32
+    // CHECK: membar.gl
+    // CHECK: llvm.store
+    // CHECK: nvvm.barrier0
+    %0 = "tt.atomic_rmw" (%arg0, %arg2, %arg1) {atomic_rmw_op = 4 : i32, grid_sync} : (!tt.ptr<i32>, i32, i1) -> i32
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // A ragged load is vectorized whatever the divisibility of its bounds, and
+  // its masked-out elements are replaced by `other` after the load
+  // CHECK-LABEL: ragged_load
+  func @ragged_load(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32) {
+    %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked0>
+    %1 = tt.splat %arg1 : (i32) -> tensor<512xi32, #blocked0>
+    %2 = "triton_gpu.cmpi"(%0, %1) {predicate = 2 : i64} : (tensor<512xi32, #blocked0>, tensor<512xi32, #blocked0>) -> tensor<512xi1, #blocked0>
+    %3 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked0>
+    %4 = tt.addptr %3, %0 : tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xi32, #blocked0>
+    %cst = arith.constant dense<0.000000e+00> : tensor<512xf32, #blocked0>
+    // CHECK: ld.global.v4.b32
+    // CHECK-NOT: ld.global.b32
+    // CHECK-COUNT-4: llvm.select
+    %5 = tt.load %4, %2, %cst {cache = 1 : i32, evict = 1 : i32, isVolatile = false, ragged} : tensor<512xf32, #blocked0>
     return
   }
 }
@@ -1003,6 +1327,33 @@ module attributes {"triton_gpu.num-warps" = 4 : i32} {
   }
 }
 
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32, "triton_gpu.pid-remap" = "grouped-8"} {
+  // The programs are numbered in launch order, then swept by groups of 8
+  // along axis 0
+  // CHECK-LABEL: test_get_program_id_grouped
+  func @test_get_program_id_grouped(%a: tensor<32x!tt.ptr<i32>, #blocked0>) {
+    // CHECK: nvvm.read.ptx.sreg.nctaid.x
+    // CHECK: nvvm.read.ptx.sreg.nctaid.y
+    // CHECK: nvvm.read.ptx.sreg.ctaid.x
+    // CHECK: nvvm.read.ptx.sreg.ctaid.y
+    // CHECK: llvm.mlir.constant(8 : i32)
+    // CHECK: llvm.udiv
+    // CHECK: llvm.intr.umin
+    // CHECK: llvm.urem
+    // CHECK: llvm.urem
+    // CHECK: llvm.udiv
+    %blockidx = tt.get_program_id {axis=0:i32} : i32
+    %blockidy = tt.get_program_id {axis=1:i32} : i32
+    %v0 = arith.addi %blockidx, %blockidy : i32
+    %0 = tt.splat %v0 : (i32) -> tensor<32xi32, #blocked0>
+    tt.store %a, %0 : tensor<32xi32, #blocked0>
+
+    return
+  }
+}
+
 // -----
 #blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
@@ -1045,3 +1396,194 @@ module attributes {"triton_gpu.num-warps" = 1 : i32} {
     return
   }
 }
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: test_index_cache_first_func
+  func @test_index_cache_first_func() {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    return
+  }
+  // CHECK-LABEL: test_index_cache_second_func
+  func @test_index_cache_second_func() {
+    // CHECK: nvvm.read.ptx.sreg.tid.x
+    %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32, #blocked0>
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [32, 1], warpsPerCTA = [1, 4], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [2, 2]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: test_index_cache_convert_replicas
+  func @test_index_cache_convert_replicas(%arg0: tensor<128x32xf32, #mma>) {
+    // CHECK-COUNT-2: nvvm.read.ptx.sreg.tid.x
+    // CHECK-NOT: nvvm.read.ptx.sreg.tid.x
+    // CHECK: llvm.return
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<128x32xf32, #mma>) -> tensor<128x32xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: reduce_warp_sync
+  func @reduce_warp_sync(%arg0: tensor<8x64xf32, #blocked0>) {
+    // CHECK-COUNT-4: shfl.sync.bfly.b32
+    // CHECK-NOT: barrier0
+    // CHECK-NOT: llvm.store
+    %0 = tt.reduce %arg0 {redOp = 2 : i32, axis = 1 : i32} : tensor<8x64xf32, #blocked0> -> tensor<8xf32, #triton_gpu.slice<{dim = 1, parent = #blocked0}>>
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [2, 2], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: convert_layout_mmav2_blocked_shuffle
+  func @convert_layout_mmav2_blocked_shuffle(%arg0: tensor<64x8xf32, #mma>) {
+    // Rows 8 apart are held by the same mma lane, so that each shuffle is
+    // done for both source registers
+    // CHECK-NOT: llvm.store
+    // CHECK-COUNT-8: shfl.sync.idx.b32
+    // CHECK-NOT: nvvm.barrier0
+    // CHECK-NOT: llvm.load
+    %0 = triton_gpu.convert_layout %arg0 : (tensor<64x8xf32, #mma>) -> tensor<64x8xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: scan_warp
+  func @scan_warp(%arg0: tensor<32xf32, #blocked0>) {
+    // CHECK-COUNT-6: shfl.sync.up.b32
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    %0 = tt.scan %arg0 {
+    ^bb0(%a: f32, %b: f32):
+      %1 = arith.addf %a, %b : f32
+      tt.scan.return %1 : f32
+    } {axis = 0 : i32} : tensor<32xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: scan_cta
+  func @scan_cta(%arg0: tensor<128xi32, #blocked0>) {
+    // CHECK-COUNT-6: shfl.sync.up.b32
+    // CHECK: llvm.store
+    // CHECK: nvvm.barrier0
+    // CHECK-COUNT-3: llvm.load
+    %0 = tt.scan %arg0 {
+    ^bb0(%a: i32, %b: i32):
+      %1 = arith.addi %a, %b : i32
+      tt.scan.return %1 : i32
+    } {axis = 0 : i32} : tensor<128xi32, #blocked0>
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: sort_warp
+  func @sort_warp(%arg0: tensor<32xf32, #blocked0>) {
+    // CHECK-COUNT-15: shfl.sync.bfly.b32
+    // CHECK-NOT: llvm.store
+    // CHECK-NOT: nvvm.barrier0
+    %0 = tt.sort %arg0 {axis = 0 : i32, descending = false} : tensor<32xf32, #blocked0> -> tensor<32xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: generic_reduce_warp_sync
+  func @generic_reduce_warp_sync(%arg0: tensor<32xf32, #blocked0>, %arg1: tensor<32xi32, #blocked0>) {
+    // Both operands are shuffled in lockstep
+    // CHECK-COUNT-10: shfl.sync.bfly.b32
+    // CHECK-NOT: llvm.store
+    %0:2 = tt.generic_reduce %arg0, %arg1 {
+    ^bb0(%a0: f32, %a1: i32, %b0: f32, %b1: i32):
+      %1 = arith.addf %a0, %b0 : f32
+      %2 = arith.addi %a1, %b1 : i32
+      tt.generic_reduce.return %1, %2 : f32, i32
+    } {axis = 0 : i32} : tensor<32xf32, #blocked0>, tensor<32xi32, #blocked0> -> f32, i32
+    return
+  }
+}
+
+// -----
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [1], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 1 : i32} {
+  // CHECK-LABEL: philox_grouped
+  func @philox_grouped(%arg0: i32, %arg1: i32) {
+    // The 4 elements of each thread share a single evaluation
+    // CHECK-COUNT-2: llvm.mul {{.*}} : i64
+    // CHECK-NOT: llvm.mul {{.*}} : i64
+    // CHECK-NOT: llvm.select
+    %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #blocked0>
+    %1 = tt.splat %arg0 : (i32) -> tensor<128xi32, #blocked0>
+    %2 = tt.splat %arg1 : (i32) -> tensor<128xi32, #blocked0>
+    %3 = tt.philox %0, %1, %2 {nRounds = 1 : i32} : tensor<128xi32, #blocked0>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#blocked2 = #triton_gpu.blocked<{sizePerThread = [1, 1], threadsPerWarp = [32, 1], warpsPerCTA = [4, 1], order = [0, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The elements of a thread with the same operands are computed once
+  // CHECK-LABEL: splat_operands
+  func @splat_operands(%a: f32, %b: f32) {
+    // CHECK: llvm.fadd
+    // CHECK-NOT: llvm.fadd
+    %0 = tt.splat %a : (f32) -> tensor<512xf32, #blocked0>
+    %1 = tt.splat %b : (f32) -> tensor<512xf32, #blocked0>
+    %2 = arith.addf %0, %1 : tensor<512xf32, #blocked0>
+    return
+  }
+
+  // CHECK-LABEL: broadcast_operands
+  func @broadcast_operands(%arg : tensor<256x1xf32, #blocked2>, %b: f32) {
+    // the 8 elements of each thread repeat the 2 of %arg
+    // CHECK-COUNT-2: llvm.fadd
+    // CHECK-NOT: llvm.fadd
+    %0 = tt.broadcast %arg : (tensor<256x1xf32, #blocked2>) -> tensor<256x4xf32, #blocked2>
+    %1 = tt.splat %b : (f32) -> tensor<256x4xf32, #blocked2>
+    %2 = arith.addf %0, %1 : tensor<256x4xf32, #blocked2>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#shared0 = #triton_gpu.shared<{vec = 8, perPhase = 2, maxPhase = 4, order = [1, 0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // A staged tensor is loaded with the swizzle it was stored with
+  // CHECK-LABEL: convert_shared_to_blocked
+  func @convert_shared_to_blocked(%src: tensor<32x32xf16, #blocked0>) {
+    // CHECK: llvm.store {{.*}} : !llvm.ptr<vector<4xf16>, 3>
+    %0 = triton_gpu.convert_layout %src : (tensor<32x32xf16, #blocked0>) -> tensor<32x32xf16, #shared0>
+    // CHECK: nvvm.barrier0
+    // CHECK: llvm.load {{.*}} : !llvm.ptr<vector<8xf16>, 3>
+    // CHECK-NOT: llvm.load
+    %1 = triton_gpu.convert_layout %0 : (tensor<32x32xf16, #shared0>) -> tensor<32x32xf16, #blocked1>
+    return
+  }
+}
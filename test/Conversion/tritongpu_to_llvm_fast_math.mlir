@@ -0,0 +1,32 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="compute-capability=80 fast-math=true" | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_math_f32
+  func @fast_math_f32(%arg0 : tensor<128xf32, #blocked0>) {
+    // CHECK: lg2.approx.f32
+    %0 = math.log %arg0 : tensor<128xf32, #blocked0>
+    // CHECK: sin.approx.f32
+    %1 = math.sin %0 : tensor<128xf32, #blocked0>
+    // CHECK: cos.approx.f32
+    %2 = math.cos %1 : tensor<128xf32, #blocked0>
+    // CHECK: tanh.approx.f32
+    // CHECK-NOT: llvm.call
+    %3 = tt.ext_elemwise %2 {libname = "libdevice", libpath = "", symbol = "__nv_tanhf"} : tensor<128xf32, #blocked0> -> tensor<128xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: fast_math_f16
+  func @fast_math_f16(%arg0 : tensor<128xf16, #blocked0>) {
+    // CHECK: llvm.fpext
+    // CHECK: ex2.approx.f32
+    // CHECK: llvm.fptrunc
+    %0 = math.exp %arg0 : tensor<128xf16, #blocked0>
+    return
+  }
+}
@@ -0,0 +1,44 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="native-load-store=true" | FileCheck %s
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: native_load_store
+  func @native_load_store(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f32> {tt.divisibility = 16 : i32}) {
+    %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked0>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xi32, #blocked0>
+    %3 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked0>
+    %4 = tt.addptr %3, %0 : tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xi32, #blocked0>
+    // CHECK-NOT: llvm.inline_asm
+    // CHECK: llvm.load {{.*}} {alignment = 16 : i64} : !llvm.ptr<vector<4xf32>, 1>
+    %5 = tt.load %2 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #blocked0>
+    // CHECK: llvm.store {{.*}} {alignment = 16 : i64, nontemporal} : !llvm.ptr<vector<4xf32>, 1>
+    tt.store %4, %5 {cache = 4 : i32} : tensor<512xf32, #blocked0>
+    return
+  }
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // CHECK-LABEL: native_masked_load
+  func @native_masked_load(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32 {tt.divisibility = 16 : i32}) {
+    %cst = arith.constant dense<0.000000e+00> : tensor<512xf32, #blocked0>
+    %0 = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #blocked0>
+    %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #blocked0>
+    %2 = tt.addptr %1, %0 : tensor<512x!tt.ptr<f32>, #blocked0>, tensor<512xi32, #blocked0>
+    %3 = tt.splat %arg1 : (i32) -> tensor<512xi32, #blocked0>
+    %4 = "triton_gpu.cmpi"(%0, %3) {predicate = 2 : i64} : (tensor<512xi32, #blocked0>, tensor<512xi32, #blocked0>) -> tensor<512xi1, #blocked0>
+    // Masked-out elements take `other` through the block argument
+    // CHECK: llvm.cond_br %{{.*}}, ^[[LOAD:.*]], ^[[END:.*]](%{{.*}} : vector<4xf32>)
+    // CHECK: ^[[LOAD]]:
+    // CHECK: %[[VAL:.*]] = llvm.load {{.*}} : !llvm.ptr<vector<4xf32>, 1>
+    // CHECK: llvm.br ^[[END]](%[[VAL]] : vector<4xf32>)
+    %5 = tt.load %2, %4, %cst {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #blocked0>
+    // Eviction policies are only available in inline PTX
+    // CHECK: st.global.L1::evict_last
+    tt.store %2, %5, %4 {evict = 3 : i32} : tensor<512xf32, #blocked0>
+    return
+  }
+}
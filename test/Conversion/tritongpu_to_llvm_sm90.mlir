@@ -0,0 +1,32 @@
+// RUN: triton-opt %s -split-input-file --convert-triton-gpu-to-llvm="compute-capability=90" | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // The f16 accumulator is stored to shared memory with one stmatrix per
+  // 16x8 tile of each warp
+  // CHECK-LABEL: convert_layout_mma_blocked_stmatrix
+  func @convert_layout_mma_blocked_stmatrix(%ptr : !tt.ptr<f16> {tt.divisibility = 16 : i32}, %acc : tensor<64x64xf16, #mma>) {
+    // CHECK-COUNT-8: stmatrix.sync.aligned.m8n8.x2.shared.b16
+    // CHECK-NOT: stmatrix
+    %0 = triton_gpu.convert_layout %acc : (tensor<64x64xf16, #mma>) -> tensor<64x64xf16, #blocked>
+    %1 = tt.splat %ptr : (!tt.ptr<f16>) -> tensor<64x64x!tt.ptr<f16>, #blocked>
+    tt.store %1, %0 : tensor<64x64xf16, #blocked>
+    return
+  }
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+  // 32-bit elements are stored to shared memory one vector at a time
+  // CHECK-LABEL: convert_layout_mma_blocked_f32
+  func @convert_layout_mma_blocked_f32(%acc : tensor<64x64xf32, #mma>) {
+    // CHECK-NOT: stmatrix
+    // CHECK: llvm.store
+    %0 = triton_gpu.convert_layout %acc : (tensor<64x64xf32, #mma>) -> tensor<64x64xf32, #blocked>
+    return
+  }
+}
@@ -0,0 +1,83 @@
+// RUN: triton-opt %s -split-input-file -triton-rewrite-pointer-offsets -canonicalize | FileCheck %s
+
+// CHECK-LABEL: @loop_carried_pointers
+func @loop_carried_pointers(%arg0: !tt.ptr<f32> {tt.pointer_range = 32 : i32}, %arg1: !tt.ptr<f32>, %arg2: i32) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %cst = arith.constant dense<0.000000e+00> : tensor<256xf32>
+  %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32>
+  %1 = tt.addptr %arg0, %arg2 : !tt.ptr<f32>, i32
+  %2 = tt.splat %1 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>>
+  %3 = tt.addptr %2, %0 : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+  %4 = tt.splat %arg1 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>>
+  %5 = tt.addptr %4, %0 : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+  %6 = tt.splat %arg2 : (i32) -> tensor<256xi32>
+  // the pointers into %arg0 are carried as i32 offsets
+  // CHECK: scf.for {{.*}} iter_args(%{{.*}} = %{{.*}}, %[[offs:.*]] = %{{.*}}, %{{.*}} = %{{.*}}) -> (tensor<256xf32>, tensor<256xi32>, tensor<256x!tt.ptr<f32>>)
+  %7:3 = scf.for %arg3 = %c0 to %c8 step %c1 iter_args(%arg4 = %cst, %arg5 = %3, %arg6 = %5) -> (tensor<256xf32>, tensor<256x!tt.ptr<f32>>, tensor<256x!tt.ptr<f32>>) {
+    // CHECK: %[[ptrs:.*]] = tt.addptr %{{.*}}, %[[offs]] : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+    // CHECK: tt.load %[[ptrs]]
+    %8 = tt.load %arg5 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32>
+    %9 = tt.load %arg6 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<256xf32>
+    %10 = arith.addf %arg4, %8 : tensor<256xf32>
+    %11 = arith.addf %10, %9 : tensor<256xf32>
+    // CHECK: %[[next:.*]] = arith.addi %[[offs]], %{{.*}} : tensor<256xi32>
+    %12 = tt.addptr %arg5, %6 : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+    %13 = tt.addptr %arg6, %6 : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+    // CHECK: scf.yield %{{.*}}, %[[next]], %{{.*}} : tensor<256xf32>, tensor<256xi32>, tensor<256x!tt.ptr<f32>>
+    scf.yield %11, %12, %13 : tensor<256xf32>, tensor<256x!tt.ptr<f32>>, tensor<256x!tt.ptr<f32>>
+  }
+  tt.store %7#1, %7#0 : tensor<256xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @broadcast_pointers
+func @broadcast_pointers(%arg0: !tt.ptr<f16> {tt.pointer_range = 32 : i32}, %arg1: i32) {
+  %0 = tt.make_range {end = 16 : i32, start = 0 : i32} : tensor<16xi32>
+  %1 = tt.splat %arg1 : (i32) -> tensor<16xi32>
+  %2 = arith.muli %0, %1 : tensor<16xi32>
+  %3 = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<16x!tt.ptr<f16>>
+  %4 = tt.addptr %3, %2 : tensor<16x!tt.ptr<f16>>, tensor<16xi32>
+  %5 = tt.expand_dims %4 {axis = 1 : i32} : (tensor<16x!tt.ptr<f16>>) -> tensor<16x1x!tt.ptr<f16>>
+  %6 = tt.broadcast %5 : (tensor<16x1x!tt.ptr<f16>>) -> tensor<16x16x!tt.ptr<f16>>
+  %7 = tt.expand_dims %0 {axis = 0 : i32} : (tensor<16xi32>) -> tensor<1x16xi32>
+  %8 = tt.broadcast %7 : (tensor<1x16xi32>) -> tensor<16x16xi32>
+  %9 = tt.addptr %6, %8 : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  // the offsets are broadcast instead of the pointers, and added to the base
+  // of the tensor at the store
+  // CHECK: %[[rows:.*]] = tt.expand_dims %{{.*}} {axis = 1 : i32} : (tensor<16xi32>) -> tensor<16x1xi32>
+  // CHECK: %[[offs:.*]] = tt.broadcast %[[rows]] : (tensor<16x1xi32>) -> tensor<16x16xi32>
+  // CHECK: %[[sum:.*]] = arith.addi %[[offs]], %{{.*}} : tensor<16x16xi32>
+  // CHECK: %[[base:.*]] = tt.splat %arg0 : (!tt.ptr<f16>) -> tensor<16x16x!tt.ptr<f16>>
+  // CHECK: %[[ptrs:.*]] = tt.addptr %[[base]], %[[sum]] : tensor<16x16x!tt.ptr<f16>>, tensor<16x16xi32>
+  // CHECK: tt.store %[[ptrs]]
+  %cst = arith.constant dense<0.000000e+00> : tensor<16x16xf16>
+  tt.store %9, %cst : tensor<16x16xf16>
+  return
+}
+
+// -----
+
+// the offsets of the pointers into arguments without a size class may not
+// fit in 32 bits
+// CHECK-LABEL: @unknown_size
+func @unknown_size(%arg0: !tt.ptr<f32>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %0 = tt.make_range {end = 256 : i32, start = 0 : i32} : tensor<256xi32>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<256x!tt.ptr<f32>>
+  %2 = tt.addptr %1, %0 : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+  %cst = arith.constant dense<256> : tensor<256xi32>
+  %val = arith.constant dense<0.000000e+00> : tensor<256xf32>
+  // CHECK: scf.for {{.*}} -> (tensor<256x!tt.ptr<f32>>)
+  %3 = scf.for %arg1 = %c0 to %c8 step %c1 iter_args(%arg2 = %2) -> (tensor<256x!tt.ptr<f32>>) {
+    tt.store %arg2, %val : tensor<256xf32>
+    %4 = tt.addptr %arg2, %cst : tensor<256x!tt.ptr<f32>>, tensor<256xi32>
+    scf.yield %4 : tensor<256x!tt.ptr<f32>>
+  }
+  return
+}
@@ -0,0 +1,48 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-canonicalize-loops -canonicalize | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// CHECK-LABEL: @strength_reduce_pointers
+func @strength_reduce_pointers(%a_ptr_init : !tt.ptr<f16>, %lb : index, %ub : index, %step : index, %stride : i32) -> tensor<128x32xf16, #AL> {
+  %a_ptr_splat = tt.splat %a_ptr_init : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_offs = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32, #triton_gpu.slice<{dim = 0, parent = #AL}>>
+  %a_offs_e = tt.expand_dims %a_offs {axis = 0 : i32} : (tensor<32xi32, #triton_gpu.slice<{dim = 0, parent = #AL}>>) -> tensor<1x32xi32, #AL>
+  %a_offs_b = tt.broadcast %a_offs_e : (tensor<1x32xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %a_ptr = tt.addptr %a_ptr_splat, %a_offs_b : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  %a_mask = arith.constant dense<true> : tensor<128x32xi1, #AL>
+  %a_other = arith.constant dense<0.00e+00> : tensor<128x32xf16, #AL>
+  %a_step = tt.splat %stride : (i32) -> tensor<128x32xi32, #AL>
+  // the pointer tensor is carried as a scalar pointer
+  // CHECK: scf.for {{.*}} iter_args(%{{.*}} = %{{.*}}, %[[base:.*]] = %arg0) -> (tensor<128x32xf16, #{{.*}}>, !tt.ptr<f16>)
+  %res:2 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %a_other, %a_ptr_ = %a_ptr) -> (tensor<128x32xf16, #AL>, tensor<128x32x!tt.ptr<f16>, #AL>) {
+    // CHECK: %[[splat:.*]] = tt.splat %[[base]]
+    // CHECK: %[[ptrs:.*]] = tt.addptr %[[splat]]
+    // CHECK: tt.load %[[ptrs]]
+    %a = tt.load %a_ptr_, %a_mask, %a_other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %acc_ = arith.addf %acc, %a : tensor<128x32xf16, #AL>
+    // CHECK: %[[next:.*]] = tt.addptr %[[base]], %arg4 : !tt.ptr<f16>, i32
+    // CHECK: scf.yield %{{.*}}, %[[next]] : tensor<128x32xf16, #{{.*}}>, !tt.ptr<f16>
+    %next_a_ptr = tt.addptr %a_ptr_, %a_step : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    scf.yield %acc_, %next_a_ptr : tensor<128x32xf16, #AL>, tensor<128x32x!tt.ptr<f16>, #AL>
+  }
+  return %res#0 : tensor<128x32xf16, #AL>
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+
+// CHECK-LABEL: @dead_iter_args
+func @dead_iter_args(%lb : index, %ub : index, %step : index, %x : tensor<128x32xf32, #AL>, %out : tensor<128x32x!tt.ptr<f32>, #AL>) {
+  %zero = arith.constant dense<0.00e+00> : tensor<128x32xf32, #AL>
+  // %dead only feeds itself, and %live is stored
+  // CHECK: scf.for {{.*}} iter_args(%[[live:.*]] = %{{.*}}) -> (tensor<128x32xf32, #{{.*}}>)
+  // CHECK-NOT: arith.mulf
+  %res:2 = scf.for %iv = %lb to %ub step %step iter_args(%live = %zero, %dead = %zero) -> (tensor<128x32xf32, #AL>, tensor<128x32xf32, #AL>) {
+    %live_ = arith.addf %live, %x : tensor<128x32xf32, #AL>
+    %dead_ = arith.mulf %dead, %x : tensor<128x32xf32, #AL>
+    tt.store %out, %live_ : tensor<128x32xf32, #AL>
+    scf.yield %live_, %dead_ : tensor<128x32xf32, #AL>, tensor<128x32xf32, #AL>
+  }
+  return
+}
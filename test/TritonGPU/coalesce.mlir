@@ -9,16 +9,14 @@
 module attributes {"triton_gpu.num-warps" = 4 : i32} {
 
 
-// CHECK: [[row_layout:#.*]] = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
-// CHECK: [[col_layout:#.*]] = #triton_gpu.blocked<{sizePerThread = [4, 1], threadsPerWarp = [16, 2], warpsPerCTA = [1, 4], order = [0, 1]}>
-// CHECK: [[load_ptr:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64x!tt.ptr<f32>, [[row_layout]]>
-// CHECK: [[load_mask:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64xi1, [[row_layout]]>
-// CHECK: [[load_other:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64xf32, [[row_layout]]>
-// CHECK: [[load_val:%.*]] = tt.load [[load_ptr]], [[load_mask]], [[load_other]] {{.*}} : tensor<64x64xf32, [[row_layout]]>
-// CHECK: [[store_ptr:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64x!tt.ptr<f32>, [[col_layout]]>
-// CHECK: [[store_val:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64xf32, [[col_layout]]>
-// CHECK: [[store_mask:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64xi1, [[col_layout]]>
-// CHECK: tt.store [[store_ptr]], [[store_val]], [[store_mask]]
+// The load and the store are both vectorized within a single layout, holding
+// 4x4 elements per thread
+// CHECK: [[layout:#.*]] = #triton_gpu.blocked<{sizePerThread = [4, 4], threadsPerWarp = [2, 16], warpsPerCTA = [4, 1], order = [1, 0]}>
+// CHECK-LABEL: transpose
+// CHECK: [[load_ptr:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64x!tt.ptr<f32>, [[layout]]>
+// CHECK: [[load_val:%.*]] = tt.load [[load_ptr]] {cache = 1 : i32, {{.*}}} : tensor<64x64xf32, [[layout]]>
+// CHECK: [[store_ptr:%.*]] = triton_gpu.convert_layout {{.*}} -> tensor<64x64x!tt.ptr<f32>, [[layout]]>
+// CHECK-NEXT: tt.store [[store_ptr]], [[load_val]] : tensor<64x64xf32, [[layout]]>
 func @transpose(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32},
                 %arg1: i32 {tt.divisibility = 16 : i32},
                 %arg2: !tt.ptr<f32> {tt.divisibility = 16 : i32},
@@ -50,4 +48,29 @@ func @transpose(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32},
   return
 }
 
-}
\ No newline at end of file
+}
+
+// -----
+
+#blocked0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The mask of the first load always holds, since the offsets are below 128
+// CHECK-LABEL: drop_true_mask
+// CHECK: tt.load %{{.*}} {cache = 1 : i32, {{.*}}} : tensor<128xf32, [[layout:#.*]]>
+// CHECK: tt.load %{{.*}}, %{{.*}} {cache = 1 : i32, {{.*}}} : tensor<128xf32, [[layout]]>
+func @drop_true_mask(%arg0: !tt.ptr<f32> {tt.divisibility = 16 : i32}, %arg1: i32) -> (tensor<128xf32, #blocked0>, tensor<128xf32, #blocked0>) {
+  %c128 = arith.constant dense<128> : tensor<128xi32, #blocked0>
+  %0 = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #blocked0>
+  %1 = tt.splat %arg0 : (!tt.ptr<f32>) -> tensor<128x!tt.ptr<f32>, #blocked0>
+  %2 = tt.addptr %1, %0 : tensor<128x!tt.ptr<f32>, #blocked0>, tensor<128xi32, #blocked0>
+  %3 = "triton_gpu.cmpi"(%0, %c128) {predicate = 2 : i64} : (tensor<128xi32, #blocked0>, tensor<128xi32, #blocked0>) -> tensor<128xi1, #blocked0>
+  %4 = tt.load %2, %3 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32, #blocked0>
+  %5 = tt.splat %arg1 : (i32) -> tensor<128xi32, #blocked0>
+  %6 = "triton_gpu.cmpi"(%0, %5) {predicate = 2 : i64} : (tensor<128xi32, #blocked0>, tensor<128xi32, #blocked0>) -> tensor<128xi1, #blocked0>
+  %7 = tt.load %2, %6 {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128xf32, #blocked0>
+  return %4, %7 : tensor<128xf32, #blocked0>, tensor<128xf32, #blocked0>
+}
+
+}
@@ -0,0 +1,36 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-combine=cleanup=true 2>&1 | FileCheck %s
+
+#layout0 = #triton_gpu.blocked<{sizePerThread = [1], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+#layout1 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The conversion of the loop-invariant argument is hoisted out of the loop
+// CHECK-LABEL: hoist_invariant_convert
+// CHECK: triton_gpu.convert_layout %arg0
+// CHECK-NEXT: scf.for
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: scf.yield
+func @hoist_invariant_convert(%arg0: tensor<1024xf32, #layout0>, %lb: index, %ub: index, %step: index) -> tensor<1024xf32, #layout1> {
+  %init = arith.constant dense<0.000000e+00> : tensor<1024xf32, #layout1>
+  %0 = scf.for %iv = %lb to %ub step %step iter_args(%acc = %init) -> (tensor<1024xf32, #layout1>) {
+    %1 = triton_gpu.convert_layout %arg0 : (tensor<1024xf32, #layout0>) -> tensor<1024xf32, #layout1>
+    %2 = arith.addf %acc, %1 : tensor<1024xf32, #layout1>
+    scf.yield %2 : tensor<1024xf32, #layout1>
+  }
+  return %0 : tensor<1024xf32, #layout1>
+}
+
+// Duplicated conversions are merged by CSE
+// CHECK-LABEL: merge_duplicates
+// CHECK-COUNT-1: triton_gpu.convert_layout
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: return
+func @merge_duplicates(%arg0: tensor<1024xf32, #layout0>) -> tensor<1024xf32, #layout1> {
+  %0 = triton_gpu.convert_layout %arg0 : (tensor<1024xf32, #layout0>) -> tensor<1024xf32, #layout1>
+  %1 = triton_gpu.convert_layout %arg0 : (tensor<1024xf32, #layout0>) -> tensor<1024xf32, #layout1>
+  %2 = arith.mulf %0, %1 : tensor<1024xf32, #layout1>
+  return %2 : tensor<1024xf32, #layout1>
+}
+
+}
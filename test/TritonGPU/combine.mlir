@@ -234,4 +234,57 @@ func @select(%arg0: !tt.ptr<f64> {tt.divisibility = 16 : i32}, %arg1: !tt.ptr<f6
     scf.yield %30 : tensor<1x512xf64, #blocked2>
   }
   return
-}
\ No newline at end of file
+}
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Without fp8 tensor cores, fp8 operands are converted to f16 in the layout
+// they are loaded in
+// CHECK-LABEL: upcast_fp8_dot
+// CHECK: tt.fp_to_fp {{.*}} : tensor<64x32x!tt.f8E4M3, #blocked> -> tensor<64x32xf16, #blocked>
+// CHECK: tt.fp_to_fp {{.*}} : tensor<32x64x!tt.f8E4M3, #blocked> -> tensor<32x64xf16, #blocked>
+// CHECK: tt.dot {{.*}} : tensor<64x32xf16, {{.*}}> * tensor<32x64xf16, {{.*}}> -> tensor<64x64xf32, #mma>
+func @upcast_fp8_dot(%a : tensor<64x32x!tt.f8E4M3, #blocked>, %b : tensor<32x64x!tt.f8E4M3, #blocked>, %ptr : tensor<64x64x!tt.ptr<f32>, #blocked>) {
+  %cst = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+  %0 = triton_gpu.convert_layout %a : (tensor<64x32x!tt.f8E4M3, #blocked>) -> tensor<64x32x!tt.f8E4M3, #dot_a>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x64x!tt.f8E4M3, #blocked>) -> tensor<32x64x!tt.f8E4M3, #dot_b>
+  %2 = tt.dot %0, %1, %cst {allowTF32 = true} : tensor<64x32x!tt.f8E4M3, #dot_a> * tensor<32x64x!tt.f8E4M3, #dot_b> -> tensor<64x64xf32, #blocked>
+  tt.store %ptr, %2 : tensor<64x64xf32, #blocked>
+  return
+}
+
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #blocked}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #blocked}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Both dots keep all their warps along M, so that the accumulators of the
+// first one are the $a operand of the second one in registers
+// CHECK-LABEL: chained_dot
+// CHECK: tt.dot {{.*}} -> tensor<64x64xf32, #mma>
+// CHECK: tt.dot {{.*}} -> tensor<64x128xf32, #mma>
+func @chained_dot(%q : tensor<64x32xf16, #blocked>, %k : tensor<32x64xf16, #blocked>, %v : tensor<64x128xf16, #blocked>, %ptr : tensor<64x128x!tt.ptr<f32>, #blocked>) {
+  %cst0 = arith.constant dense<0.000000e+00> : tensor<64x64xf32, #blocked>
+  %cst1 = arith.constant dense<0.000000e+00> : tensor<64x128xf32, #blocked>
+  %0 = triton_gpu.convert_layout %q : (tensor<64x32xf16, #blocked>) -> tensor<64x32xf16, #dot_a>
+  %1 = triton_gpu.convert_layout %k : (tensor<32x64xf16, #blocked>) -> tensor<32x64xf16, #dot_b>
+  %2 = tt.dot %0, %1, %cst0 {allowTF32 = true} : tensor<64x32xf16, #dot_a> * tensor<32x64xf16, #dot_b> -> tensor<64x64xf32, #blocked>
+  %3 = arith.truncf %2 : tensor<64x64xf32, #blocked> to tensor<64x64xf16, #blocked>
+  %4 = triton_gpu.convert_layout %3 : (tensor<64x64xf16, #blocked>) -> tensor<64x64xf16, #dot_a>
+  %5 = triton_gpu.convert_layout %v : (tensor<64x128xf16, #blocked>) -> tensor<64x128xf16, #dot_b>
+  %6 = tt.dot %4, %5, %cst1 {allowTF32 = true} : tensor<64x64xf16, #dot_a> * tensor<64x128xf16, #dot_b> -> tensor<64x128xf32, #blocked>
+  tt.store %ptr, %6 : tensor<64x128xf32, #blocked>
+  return
+}
+
+}
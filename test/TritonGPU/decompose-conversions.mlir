@@ -0,0 +1,49 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-decompose-conversions | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#blocked1 = #triton_gpu.blocked<{sizePerThread = [1, 8], threadsPerWarp = [8, 4], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Conversions to dot operands go through shared memory
+// CHECK-LABEL: decompose_dot_operand
+// CHECK: triton_gpu.convert_layout {{.*}} : (tensor<64x32xf16, #blocked>) -> tensor<64x32xf16, #shared{{.*}}>
+// CHECK-NEXT: triton_gpu.convert_layout {{.*}} -> tensor<64x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+func @decompose_dot_operand(%a : tensor<64x32xf16, #blocked>, %b : tensor<32x64xf16, #blocked>, %c : tensor<64x64xf32, #mma>) -> tensor<64x64xf32, #mma> {
+  %0 = triton_gpu.convert_layout %a : (tensor<64x32xf16, #blocked>) -> tensor<64x32xf16, #dot_a>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x64xf16, #blocked>) -> tensor<32x64xf16, #dot_b>
+  %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<64x32xf16, #dot_a> * tensor<32x64xf16, #dot_b> -> tensor<64x64xf32, #mma>
+  return %2 : tensor<64x64xf32, #mma>
+}
+
+// A tensor converted to a dot operand and to another blocked layout is
+// stored to shared memory once
+// CHECK-LABEL: share_staged_conversions
+// CHECK: %[[smem:.*]] = triton_gpu.convert_layout %arg0 : (tensor<32x32xf16, #blocked>) -> tensor<32x32xf16, #shared{{.*}}>
+// CHECK-NOT: triton_gpu.convert_layout %arg0
+// CHECK-DAG: triton_gpu.convert_layout %[[smem]] : {{.*}} -> tensor<32x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+// CHECK-DAG: triton_gpu.convert_layout %[[smem]] : {{.*}} -> tensor<32x32xf16, #blocked1>
+func @share_staged_conversions(%a : tensor<32x32xf16, #blocked>, %b : tensor<32x64xf16, #dot_b>, %c : tensor<32x64xf32, #mma>, %ptr : tensor<32x32x!tt.ptr<f16>, #blocked1>) -> tensor<32x64xf32, #mma> {
+  %0 = triton_gpu.convert_layout %a : (tensor<32x32xf16, #blocked>) -> tensor<32x32xf16, #dot_a>
+  %1 = tt.dot %0, %b, %c {allowTF32 = true} : tensor<32x32xf16, #dot_a> * tensor<32x64xf16, #dot_b> -> tensor<32x64xf32, #mma>
+  %2 = triton_gpu.convert_layout %a : (tensor<32x32xf16, #blocked>) -> tensor<32x32xf16, #blocked1>
+  tt.store %ptr, %2 : tensor<32x32xf16, #blocked1>
+  return %1 : tensor<32x64xf32, #mma>
+}
+
+// Packed int4 weights are dequantized by their shared memory load
+// CHECK-LABEL: dequantize_int4_weights
+// CHECK: triton_gpu.convert_layout {{.*}} : (tensor<16x64xi8, #blocked>) -> tensor<16x64xi8, #shared{{.*}}>
+// CHECK-NEXT: triton_gpu.dequantize {{.*}} -> tensor<32x64xf16, #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>>
+// CHECK-NEXT: tt.dot {{.*}} : tensor<64x32xf16, {{.*}}> * tensor<32x64xf16, {{.*}}> -> tensor<64x64xf32, #mma>
+func @dequantize_int4_weights(%a : tensor<64x32xf16, #blocked>, %w : tensor<16x64xi8, #blocked>, %c : tensor<64x64xf32, #mma>) -> tensor<64x64xf32, #mma> {
+  %0 = triton_gpu.convert_layout %a : (tensor<64x32xf16, #blocked>) -> tensor<64x32xf16, #dot_a>
+  %1 = triton_gpu.convert_layout %w : (tensor<16x64xi8, #blocked>) -> tensor<16x64xi8, #dot_b>
+  %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<64x32xf16, #dot_a> * tensor<16x64xi8, #dot_b> -> tensor<64x64xf32, #mma>
+  return %2 : tensor<64x64xf32, #mma>
+}
+
+}
@@ -0,0 +1,56 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-hoist-invariant-loads | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The tile of `a` is loaded and converted once, when the loop runs
+// CHECK-LABEL: hoist_invariant_operand
+// CHECK: %[[RUNS:.*]] = arith.cmpi slt, %[[LB:.*]], %[[UB:.*]] : index
+// CHECK: %[[MASK:.*]] = tt.splat %[[RUNS]] : (i1) -> tensor<128x32xi1, #[[AL:.*]]>
+// CHECK: %[[A:.*]] = tt.load %{{.*}}, %[[MASK]]
+// CHECK: triton_gpu.convert_layout %[[A]] : (tensor<128x32xf16, #[[AL]]>) -> tensor<128x32xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+// CHECK: scf.for
+// CHECK-NOT: triton_gpu.convert_layout {{.*}} -> tensor<128x32xf16
+// CHECK: tt.load
+// CHECK: tt.dot
+func @hoist_invariant_operand(%lb : index, %ub : index, %step : index,
+                              %a_ptr : tensor<128x32x!tt.ptr<f16>, #AL>,
+                              %b_ptr_init : tensor<32x128x!tt.ptr<f16>, #AL>,
+                              %b_off : tensor<32x128xi32, #AL>) -> tensor<128x128xf32, #C> {
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  %loop:2 = scf.for %iv = %lb to %ub step %step iter_args(%b_ptr = %b_ptr_init, %prev_c = %c_init) -> (tensor<32x128x!tt.ptr<f16>, #AL>, tensor<128x128xf32, #C>) {
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %b_ = tt.load %b_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #AL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #AL>) -> tensor<32x128xf16, #B>
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #AL>, tensor<32x128xi32, #AL>
+    scf.yield %next_b_ptr, %c : tensor<32x128x!tt.ptr<f16>, #AL>, tensor<128x128xf32, #C>
+  }
+  return %loop#1 : tensor<128x128xf32, #C>
+}
+
+// Stores in the loop may change the tile between iterations
+// CHECK-LABEL: keep_loads_of_loops_with_stores
+// CHECK: scf.for
+// CHECK: tt.load
+// CHECK: tt.store
+func @keep_loads_of_loops_with_stores(%lb : index, %ub : index, %step : index,
+                                      %a_ptr : tensor<128x32x!tt.ptr<f16>, #AL>,
+                                      %b : tensor<32x128xf16, #B>,
+                                      %c_ptr : tensor<128x128x!tt.ptr<f32>, #C>) {
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+  scf.for %iv = %lb to %ub step %step {
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %c = tt.dot %a, %b, %c_init {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+    tt.store %c_ptr, %c : tensor<128x128xf32, #C>
+  }
+  return
+}
+
+}
@@ -0,0 +1,25 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-instrument="automatic=true capacity=64" | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+// CHECK: module attributes {{.*}}triton_gpu.profile-capacity = 64 : i32, triton_gpu.profile_regions = "[\22kernel\22,\22loop0\22,\22softmax\22]"
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+// CHECK-LABEL: func @regions
+// CHECK-SAME: %[[buffer:.*]]: !tt.ptr<i64>)
+func @regions(%x : tensor<128xf32, #AL>, %out : tensor<128x!tt.ptr<f32>, #AL>, %lb : index, %ub : index, %step : index) {
+  // CHECK-NEXT: tt.profile_mark "kernel" %[[buffer]] : !tt.ptr<i64> {id = 0 : i32}
+  // CHECK-NEXT: tt.profile_mark "loop0" %[[buffer]] : !tt.ptr<i64> {id = 1 : i32}
+  // CHECK-NEXT: scf.for
+  scf.for %iv = %lb to %ub step %step {
+    // CHECK: tt.profile_mark "softmax" %[[buffer]] : !tt.ptr<i64> {id = 2 : i32}
+    tt.profile_mark "softmax"
+    tt.store %out, %x : tensor<128xf32, #AL>
+    // CHECK: tt.profile_mark "softmax" %[[buffer]] : !tt.ptr<i64> {id = 2 : i32, isEnd}
+    tt.profile_mark "softmax" {isEnd}
+  }
+  // CHECK: tt.profile_mark "loop0" %[[buffer]] : !tt.ptr<i64> {id = 1 : i32, isEnd}
+  // CHECK-NEXT: tt.profile_mark "kernel" %[[buffer]] : !tt.ptr<i64> {id = 0 : i32, isEnd}
+  // CHECK-NEXT: return
+  return
+}
+}
@@ -0,0 +1,49 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-layout-propagation | FileCheck %s
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The epilogue is computed in the mma layout, and only its f16 result is
+// converted to the layout of the store
+// CHECK-LABEL: epilogue_in_mma
+// CHECK-NOT: triton_gpu.convert_layout
+// CHECK: arith.mulf {{.*}} : tensor<128x128xf32, #mma>
+// CHECK-NEXT: arith.addf {{.*}} : tensor<128x128xf32, #mma>
+// CHECK-NEXT: arith.truncf {{.*}} : tensor<128x128xf32, #mma> to tensor<128x128xf16, #mma>
+// CHECK-NEXT: triton_gpu.convert_layout {{.*}} : (tensor<128x128xf16, #mma>) -> tensor<128x128xf16, #blocked>
+// CHECK-NEXT: tt.store
+func @epilogue_in_mma(%acc : tensor<128x128xf32, #mma>, %ptr : tensor<128x128x!tt.ptr<f16>, #blocked>) {
+  %0 = triton_gpu.convert_layout %acc : (tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #blocked>
+  %1 = arith.mulf %0, %0 : tensor<128x128xf32, #blocked>
+  %2 = arith.addf %1, %1 : tensor<128x128xf32, #blocked>
+  %3 = arith.truncf %2 : tensor<128x128xf32, #blocked> to tensor<128x128xf16, #blocked>
+  tt.store %ptr, %3 : tensor<128x128xf16, #blocked>
+  return
+}
+
+}
+
+// -----
+
+#blocked = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Moving the computation to the mma layout would need two conversions
+// CHECK-LABEL: keep_single_conversion
+// CHECK: triton_gpu.convert_layout {{.*}} -> tensor<128x128xf32, #blocked>
+// CHECK-NEXT: arith.mulf {{.*}} : tensor<128x128xf32, #blocked>
+// CHECK-NOT: triton_gpu.convert_layout
+func @keep_single_conversion(%acc : tensor<128x128xf32, #mma>, %ptr : tensor<128x128x!tt.ptr<f32>, #blocked>) {
+  %0 = triton_gpu.convert_layout %acc : (tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #blocked>
+  %1 = arith.mulf %0, %0 : tensor<128x128xf32, #blocked>
+  tt.store %ptr, %1 : tensor<128x128xf32, #blocked>
+  %2 = arith.addf %1, %1 : tensor<128x128xf32, #blocked>
+  tt.store %ptr, %2 : tensor<128x128xf32, #blocked>
+  return
+}
+
+}
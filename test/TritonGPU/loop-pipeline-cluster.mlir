@@ -0,0 +1,58 @@
+// RUN: triton-opt %s -tritongpu-pipeline="num-stages=3 compute-capability=90" -canonicalize | FileCheck %s
+
+// 4 warps, clusters of 2 CTAs
+// matmul: 128x32 @ 32x128 -> 128x128
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#BL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [1, 32], warpsPerCTA = [4, 1], order = [1, 0]}>
+#C = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#A = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
+#B = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
+#SA0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
+#SA1 = #triton_gpu.slice<{dim = 1, parent = #AL}>
+
+// The tile of A is shared by the CTAs of the cluster: each of them copies 64
+// of its rows and multicasts them to both CTAs.
+// CHECK: triton_gpu.tma_descriptors = "[{\22base\22:3,\22box\22:[32,64],
+// CHECK-LABEL: func @matmul_loop_multicast(
+// CHECK: triton_gpu.init_mbarrier {id = 0 : i32, num = 3 : i32}
+// CHECK: triton_gpu.insert_slice_tma {{.*}} {mbarrier = 0 : i32, multicast = 2 : i32}
+// CHECK: scf.for
+// CHECK:   triton_gpu.insert_slice_tma {{.*}} {mbarrier = 0 : i32, multicast = 2 : i32}
+// CHECK:   triton_gpu.wait_mbarrier
+module attributes {"triton_gpu.num-ctas" = 2 : i32, "triton_gpu.num-warps" = 4 : i32} {
+func @matmul_loop_multicast(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16> {tt.divisibility = 16 : i32}, %B : !tt.ptr<f16>, %stride_am : i32 {tt.divisibility = 16 : i32}) {
+  %rm = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #SA1>
+  %rk = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32, #SA0>
+  %rm_2d = tt.expand_dims %rm {axis = 1 : i32} : (tensor<128xi32, #SA1>) -> tensor<128x1xi32, #AL>
+  %rk_2d = tt.expand_dims %rk {axis = 0 : i32} : (tensor<32xi32, #SA0>) -> tensor<1x32xi32, #AL>
+  %stride = tt.splat %stride_am : (i32) -> tensor<128x1xi32, #AL>
+  %rows = arith.muli %rm_2d, %stride : tensor<128x1xi32, #AL>
+  %rows_b = tt.broadcast %rows : (tensor<128x1xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %cols_b = tt.broadcast %rk_2d : (tensor<1x32xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %a_off_init = arith.addi %rows_b, %cols_b : tensor<128x32xi32, #AL>
+  %a_base = tt.splat %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_ptr_init = tt.addptr %a_base, %a_off_init : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  %b_ptr_init = tt.broadcast %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
+
+  %b_mask = arith.constant dense<true> : tensor<32x128xi1, #BL>
+  %b_other = arith.constant dense<0.00e+00> : tensor<32x128xf16, #BL>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+
+  %a_off = arith.constant dense<32> : tensor<128x32xi32, #AL>
+  %b_off = arith.constant dense<4> : tensor<32x128xi32, #BL>
+
+  scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %prev_c = %c_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>) {
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false, multicast} : tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %b_ = tt.load %b_ptr, %b_mask, %b_other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #BL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #BL>) -> tensor<32x128xf16, #B>
+
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    scf.yield %next_a_ptr, %next_b_ptr, %c : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>
+  }
+  return
+}
+}
@@ -1,4 +1,7 @@
 // RUN: triton-opt %s -split-input-file -tritongpu-pipeline=num-stages=3 -canonicalize | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline="num-stages=2 issue-copies-first=true" -canonicalize | FileCheck %s --check-prefix=STAGE2
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline=num-stages=2 -canonicalize | FileCheck %s --check-prefix=DEFAULT2
+// RUN: triton-opt %s -split-input-file -tritongpu-pipeline="num-stages=3 compute-capability=90" -canonicalize | FileCheck %s --check-prefix=TMA
 
 // 4 warps
 // matmul: 128x32 @ 32x128 -> 128x128
@@ -8,6 +11,23 @@
 #A = #triton_gpu.dot_op<{opIdx = 0, parent = #C}>
 #B = #triton_gpu.dot_op<{opIdx = 1, parent = #C}>
 
+// With two stages and issue-copies-first, the next copies are issued before
+// the current tt.dot; by default they follow it.
+// DEFAULT2-LABEL: func @matmul_loop(
+// DEFAULT2: scf.for
+// DEFAULT2: tt.dot
+// DEFAULT2: triton_gpu.insert_slice_async
+// DEFAULT2: triton_gpu.insert_slice_async
+// DEFAULT2: triton_gpu.async_commit_group
+// DEFAULT2: scf.yield
+// STAGE2-LABEL: func @matmul_loop(
+// STAGE2: scf.for
+// STAGE2: triton_gpu.insert_slice_async
+// STAGE2: triton_gpu.insert_slice_async
+// STAGE2: triton_gpu.async_commit_group
+// STAGE2: tt.dot
+// STAGE2: triton_gpu.async_wait {num = 0 : i32}
+// STAGE2: scf.yield
 // CHECK: func @matmul_loop
 // CHECK-DAG: %[[CONSTANT_0:.*]] = arith.constant 0 : i32
 // CHECK-DAG: %[[CONSTANT_1:.*]] = arith.constant 1 : i32
@@ -181,3 +201,100 @@ func @matmul_loop_single_pipeline(%lb : index, %ub : index, %step : index, %A :
   }
   return
 }
+
+// On sm_90, the tile of A is copied with the tensor memory accelerator, with
+// its tensor map passed as a new argument. B is masked and keeps cp.async.
+#SA0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
+#SA1 = #triton_gpu.slice<{dim = 1, parent = #AL}>
+// TMA: module attributes {triton_gpu.tma_descriptors = "[{\22base\22:3,\22box\22:[32,128],\22elem_size\22:2,\22row_stride\22:5,\22swizzle\22:64}]"}
+// TMA-LABEL: func @matmul_loop_tma(
+// TMA-SAME: %[[DESC:.*]]: !tt.ptr<i8>) {
+// TMA-DAG: %[[CONSTANT_0:.*]] = arith.constant 0 : i32
+// TMA: triton_gpu.init_mbarrier {id = 0 : i32, num = 3 : i32}
+// TMA: triton_gpu.insert_slice_tma %[[DESC]][%{{.*}}, %{{.*}}], %{{.*}}, %[[CONSTANT_0]], %{{.*}} {mbarrier = 0 : i32}
+// TMA: triton_gpu.insert_slice_async
+// TMA: triton_gpu.insert_slice_tma %[[DESC]]
+// TMA: triton_gpu.insert_slice_async
+// TMA: triton_gpu.async_wait {num = 1 : i32}
+// TMA: triton_gpu.wait_mbarrier %[[CONSTANT_0]], %[[CONSTANT_0]] {id = 0 : i32}
+// TMA: scf.for
+// TMA:   triton_gpu.insert_slice_tma %[[DESC]]
+// TMA:   triton_gpu.insert_slice_async
+// TMA:   triton_gpu.async_wait {num = 1 : i32}
+// TMA:   triton_gpu.wait_mbarrier
+// TMA:   tensor.extract_slice
+// TMA:   tensor.extract_slice
+// TMA: triton_gpu.async_wait {num = 0 : i32}
+func @matmul_loop_tma(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16> {tt.divisibility = 16 : i32}, %B : !tt.ptr<f16>, %stride_am : i32 {tt.divisibility = 16 : i32}) {
+  %rm = tt.make_range {end = 128 : i32, start = 0 : i32} : tensor<128xi32, #SA1>
+  %rk = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32, #SA0>
+  %rm_2d = tt.expand_dims %rm {axis = 1 : i32} : (tensor<128xi32, #SA1>) -> tensor<128x1xi32, #AL>
+  %rk_2d = tt.expand_dims %rk {axis = 0 : i32} : (tensor<32xi32, #SA0>) -> tensor<1x32xi32, #AL>
+  %stride = tt.splat %stride_am : (i32) -> tensor<128x1xi32, #AL>
+  %rows = arith.muli %rm_2d, %stride : tensor<128x1xi32, #AL>
+  %rows_b = tt.broadcast %rows : (tensor<128x1xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %cols_b = tt.broadcast %rk_2d : (tensor<1x32xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %a_off_init = arith.addi %rows_b, %cols_b : tensor<128x32xi32, #AL>
+  %a_base = tt.splat %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
+  %a_ptr_init = tt.addptr %a_base, %a_off_init : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+  %b_ptr_init = tt.broadcast %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
+
+  %b_mask = arith.constant dense<true> : tensor<32x128xi1, #BL>
+  %b_other = arith.constant dense<0.00e+00> : tensor<32x128xf16, #BL>
+  %c_init = arith.constant dense<0.00e+00> : tensor<128x128xf32, #C>
+
+  %a_off = arith.constant dense<32> : tensor<128x32xi32, #AL>
+  %b_off = arith.constant dense<4> : tensor<32x128xi32, #BL>
+
+  scf.for %iv = %lb to %ub step %step iter_args(%a_ptr = %a_ptr_init, %b_ptr = %b_ptr_init, %prev_c = %c_init) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>) {
+    %a_ = tt.load %a_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %a = triton_gpu.convert_layout %a_ : (tensor<128x32xf16, #AL>) -> tensor<128x32xf16, #A>
+    %b_ = tt.load %b_ptr, %b_mask, %b_other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<32x128xf16, #BL>
+    %b = triton_gpu.convert_layout %b_ : (tensor<32x128xf16, #BL>) -> tensor<32x128xf16, #B>
+
+    %c = tt.dot %a, %b, %prev_c {allowTF32 = true, transA = false, transB = false} : tensor<128x32xf16, #A> * tensor<32x128xf16, #B> -> tensor<128x128xf32, #C>
+
+    %next_a_ptr = tt.addptr %a_ptr, %a_off : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    %next_b_ptr = tt.addptr %b_ptr, %b_off : tensor<32x128x!tt.ptr<f16>, #BL>, tensor<32x128xi32, #BL>
+    scf.yield %next_a_ptr, %next_b_ptr, %c : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<32x128x!tt.ptr<f16>, #BL>, tensor<128x128xf32, #C>
+  }
+  return
+}
+
+// The index loaded from %table is issued one iteration ahead of the gather
+// using it, and the gathered values are carried in registers
+#BL1 = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+// CHECK-LABEL: func @gather_loop
+// CHECK: %[[IDX0:.*]] = tt.load %{{.*}}, %{{.*}} {{.*}} : i32
+// CHECK: arith.muli %[[IDX0]]
+// CHECK: %[[X0:.*]] = tt.load %{{.*}}, %{{.*}} {{.*}} : tensor<512xf32
+// CHECK: %[[IDX1:.*]] = tt.load %{{.*}}, %{{.*}} {{.*}} : i32
+// CHECK: arith.muli %[[IDX1]]
+// CHECK: %[[X1:.*]] = tt.load %{{.*}}, %{{.*}} {{.*}} : tensor<512xf32
+// CHECK: %[[IDX2:.*]] = tt.load %{{.*}}, %{{.*}} {{.*}} : i32
+// CHECK: scf.for {{.*}} iter_args(%[[ACC:.*]] = %{{.*}}, %[[ARG_X0:.*]] = %[[X0]], %[[ARG_X1:.*]] = %[[X1]], %[[ARG_IDX:.*]] = %[[IDX2]],
+// CHECK-NOT: tt.load
+// CHECK: %[[SUM:.*]] = arith.addf %[[ACC]], %[[ARG_X0]]
+// CHECK: arith.muli %[[ARG_IDX]]
+// CHECK: %[[NEXT_X:.*]] = tt.load %{{.*}}, %{{.*}} {{.*}} : tensor<512xf32
+// CHECK: %[[NEXT_IDX:.*]] = tt.load %{{.*}}, %{{.*}} {{.*}} : i32
+// CHECK: scf.yield %[[SUM]], %[[ARG_X1]], %[[NEXT_X]], %[[NEXT_IDX]],
+func @gather_loop(%lb : index, %ub : index, %step : index, %table : !tt.ptr<i32>, %X : !tt.ptr<f32>) -> tensor<512xf32, #BL1> {
+  %c512 = arith.constant 512 : i32
+  %range = tt.make_range {end = 512 : i32, start = 0 : i32} : tensor<512xi32, #BL1>
+  %x_base = tt.splat %X : (!tt.ptr<f32>) -> tensor<512x!tt.ptr<f32>, #BL1>
+  %acc_init = arith.constant dense<0.00e+00> : tensor<512xf32, #BL1>
+  %acc = scf.for %iv = %lb to %ub step %step iter_args(%prev = %acc_init) -> (tensor<512xf32, #BL1>) {
+    %i = arith.index_cast %iv : index to i32
+    %entry = tt.addptr %table, %i : !tt.ptr<i32>, i32
+    %block = tt.load %entry {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : i32
+    %start = arith.muli %block, %c512 : i32
+    %start_splat = tt.splat %start : (i32) -> tensor<512xi32, #BL1>
+    %offs = arith.addi %start_splat, %range : tensor<512xi32, #BL1>
+    %x_ptr = tt.addptr %x_base, %offs : tensor<512x!tt.ptr<f32>, #BL1>, tensor<512xi32, #BL1>
+    %x = tt.load %x_ptr {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #BL1>
+    %sum = arith.addf %prev, %x : tensor<512xf32, #BL1>
+    scf.yield %sum : tensor<512xf32, #BL1>
+  }
+  return %acc : tensor<512xf32, #BL1>
+}
@@ -0,0 +1,75 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-peel-loops | FileCheck %s
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#ALs0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The K loop is split where `rk < K - k` starts to fail for some rk, i.e.
+// at K - 31
+// CHECK-LABEL: peel_k_loop
+// CHECK: %[[MAX:.*]] = arith.constant 31 : i32
+// CHECK: %[[BOUND:.*]] = arith.subi %[[K:.*]], %[[MAX]] : i32
+// CHECK: arith.index_cast %[[BOUND]] : i32 to index
+// CHECK: arith.ceildivsi
+// CHECK: %[[STEADY_UB:.*]] = arith.addi %{{.*}}, %{{.*}} : index
+// CHECK: %[[STEADY:.*]]:2 = scf.for %{{.*}} = %{{.*}} to %[[STEADY_UB]] step
+// CHECK:   tt.load %{{.*}} {cache = 1 : i32, {{.*}}} : tensor<128x32xf16, #blocked>
+// CHECK: scf.for %{{.*}} = %[[STEADY_UB]] to %{{.*}} step %{{.*}} iter_args(%{{.*}} = %[[STEADY]]#0, %{{.*}} = %[[STEADY]]#1)
+// CHECK:   tt.load %{{.*}}, %{{.*}}, %{{.*}} {cache = 1 : i32, {{.*}}} : tensor<128x32xf16, #blocked>
+func @peel_k_loop(%A : tensor<128x32x!tt.ptr<f16>, #AL>, %K : i32, %out : tensor<128x32x!tt.ptr<f16>, #AL>) {
+  %c0 = arith.constant 0 : index
+  %c32 = arith.constant 32 : index
+  %ub = arith.index_cast %K : i32 to index
+  %rk = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32, #ALs0>
+  %rk_2d = tt.expand_dims %rk {axis = 0 : i32} : (tensor<32xi32, #ALs0>) -> tensor<1x32xi32, #AL>
+  %rk_b = tt.broadcast %rk_2d : (tensor<1x32xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #AL>
+  %step = arith.constant dense<32> : tensor<128x32xi32, #AL>
+  %res:2 = scf.for %iv = %c0 to %ub step %c32 iter_args(%ptr = %A, %acc = %other) -> (tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xf16, #AL>) {
+    %iv_i32 = arith.index_cast %iv : index to i32
+    %k = arith.subi %K, %iv_i32 : i32
+    %k_b = tt.splat %k : (i32) -> tensor<128x32xi32, #AL>
+    %mask = "triton_gpu.cmpi"(%rk_b, %k_b) {predicate = 2 : i64} : (tensor<128x32xi32, #AL>, tensor<128x32xi32, #AL>) -> tensor<128x32xi1, #AL>
+    %a = tt.load %ptr, %mask, %other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %next_acc = arith.addf %acc, %a : tensor<128x32xf16, #AL>
+    %next_ptr = tt.addptr %ptr, %step : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xi32, #AL>
+    scf.yield %next_ptr, %next_acc : tensor<128x32x!tt.ptr<f16>, #AL>, tensor<128x32xf16, #AL>
+  }
+  tt.store %out, %res#1 : tensor<128x32xf16, #AL>
+  return
+}
+
+}
+
+// -----
+
+#AL = #triton_gpu.blocked<{sizePerThread = [1, 4], threadsPerWarp = [4, 8], warpsPerCTA = [4, 1], order = [1, 0]}>
+#ALs0 = #triton_gpu.slice<{dim = 0, parent = #AL}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// The mask doesn't depend on the induction variable
+// CHECK-LABEL: keep_invariant_mask
+// CHECK: scf.for
+// CHECK-NOT: scf.for
+func @keep_invariant_mask(%A : tensor<128x32x!tt.ptr<f16>, #AL>, %N : i32, %out : tensor<128x32x!tt.ptr<f16>, #AL>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %rk = tt.make_range {end = 32 : i32, start = 0 : i32} : tensor<32xi32, #ALs0>
+  %rk_2d = tt.expand_dims %rk {axis = 0 : i32} : (tensor<32xi32, #ALs0>) -> tensor<1x32xi32, #AL>
+  %rk_b = tt.broadcast %rk_2d : (tensor<1x32xi32, #AL>) -> tensor<128x32xi32, #AL>
+  %n_b = tt.splat %N : (i32) -> tensor<128x32xi32, #AL>
+  %other = arith.constant dense<0.000000e+00> : tensor<128x32xf16, #AL>
+  %res = scf.for %iv = %c0 to %c8 step %c1 iter_args(%acc = %other) -> (tensor<128x32xf16, #AL>) {
+    %mask = "triton_gpu.cmpi"(%rk_b, %n_b) {predicate = 2 : i64} : (tensor<128x32xi32, #AL>, tensor<128x32xi32, #AL>) -> tensor<128x32xi1, #AL>
+    %a = tt.load %A, %mask, %other {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<128x32xf16, #AL>
+    %next_acc = arith.addf %acc, %a : tensor<128x32xf16, #AL>
+    scf.yield %next_acc : tensor<128x32xf16, #AL>
+  }
+  tt.store %out, %res : tensor<128x32xf16, #AL>
+  return
+}
+
+}
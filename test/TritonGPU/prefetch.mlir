@@ -1,4 +1,6 @@
 // RUN: triton-opt %s -split-input-file -tritongpu-prefetch | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-prefetch=prefetch-width=32 | FileCheck %s --check-prefix=WIDTH
+// RUN: triton-opt %s -split-input-file -tritongpu-prefetch=prefetch-width=24 | FileCheck %s
 
 // 4 warps
 // matmul: 128x32 @ 32x128 -> 128x128
@@ -28,6 +30,14 @@
 // CHECK-DAG:   %[[NEXT_B_PREFETCH_SMEM:.*]] = tensor.extract_slice {{.*}}[0, 0] [16, 128]
 // CHECK-DAG:   %[[NEXT_B_PREFETCH:.*]] = triton_gpu.convert_layout %[[NEXT_B_PREFETCH_SMEM]]
 // CHECK:     scf.yield {{.*}}, {{.*}}, {{.*}}, {{.*}}, {{.*}}, %[[NEXT_A_PREFETCH]], %[[NEXT_B_PREFETCH]]
+// the whole tile is prefetched by the previous iteration
+// WIDTH: func @matmul_loop
+// WIDTH-DAG: tensor.extract_slice %{{.*}}[0, 0] [128, 32]
+// WIDTH-DAG: tensor.extract_slice %{{.*}}[0, 0] [32, 128]
+// WIDTH:     scf.for
+// WIDTH:       tt.dot
+// WIDTH-NOT:   tt.dot
+// WIDTH:       scf.yield
 func @matmul_loop(%lb : index, %ub : index, %step : index, %A : !tt.ptr<f16>, %B : !tt.ptr<f16>) {
   %a_ptr_init = tt.broadcast %A : (!tt.ptr<f16>) -> tensor<128x32x!tt.ptr<f16>, #AL>
   %b_ptr_init = tt.broadcast %B : (!tt.ptr<f16>) -> tensor<32x128x!tt.ptr<f16>, #BL>
@@ -0,0 +1,50 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-schedule-instructions | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-schedule-instructions=register-budget=0 | FileCheck %s --check-prefix=BUDGET
+
+#BL = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Global loads are issued before independent arithmetic
+// CHECK-LABEL: hoist_load
+// CHECK: tt.load
+// CHECK-NEXT: arith.addf
+// CHECK-NEXT: arith.mulf
+// CHECK-NEXT: tt.store
+// CHECK-NEXT: tt.store
+func @hoist_load(%x : tensor<512xf32, #BL>, %p : tensor<512x!tt.ptr<f32>, #BL>, %q : tensor<512x!tt.ptr<f32>, #BL>) {
+  %0 = arith.addf %x, %x : tensor<512xf32, #BL>
+  %1 = arith.mulf %0, %0 : tensor<512xf32, #BL>
+  %2 = tt.load %p {cache = 1 : i32, evict = 1 : i32, isVolatile = false} : tensor<512xf32, #BL>
+  tt.store %p, %2 : tensor<512xf32, #BL>
+  tt.store %q, %1 : tensor<512xf32, #BL>
+  return
+}
+
+}
+
+// -----
+
+#BL = #triton_gpu.blocked<{sizePerThread = [4], threadsPerWarp = [32], warpsPerCTA = [4], order = [0]}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// Past the register budget, a chain is completed before the next one starts
+// BUDGET-LABEL: release_registers
+// BUDGET: arith.addf
+// BUDGET-NEXT: arith.mulf
+// BUDGET-NEXT: tt.store
+// BUDGET-NEXT: arith.addf
+// BUDGET-NEXT: arith.mulf
+// BUDGET-NEXT: tt.store
+func @release_registers(%x : tensor<512xf32, #BL>, %y : tensor<512xf32, #BL>, %p : tensor<512x!tt.ptr<f32>, #BL>, %q : tensor<512x!tt.ptr<f32>, #BL>) {
+  %a0 = arith.addf %x, %x : tensor<512xf32, #BL>
+  %b0 = arith.addf %y, %y : tensor<512xf32, #BL>
+  %a1 = arith.mulf %a0, %a0 : tensor<512xf32, #BL>
+  %b1 = arith.mulf %b0, %b0 : tensor<512xf32, #BL>
+  tt.store %p, %a1 : tensor<512xf32, #BL>
+  tt.store %q, %b1 : tensor<512xf32, #BL>
+  return
+}
+
+}
@@ -0,0 +1,81 @@
+// RUN: triton-opt %s -split-input-file -tritongpu-split-dots | FileCheck %s
+// RUN: triton-opt %s -split-input-file -tritongpu-split-dots=register-budget=256 | FileCheck %s --check-prefix=BUDGET
+
+#shared = #triton_gpu.shared<{vec = 8, perPhase = 1, maxPhase = 8, order = [1, 0]}>
+#mma = #triton_gpu.mma<{versionMajor = 2, warpsPerCTA = [4, 1]}>
+#dot_a = #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>
+#dot_b = #triton_gpu.dot_op<{opIdx = 1, parent = #mma}>
+
+module attributes {"triton_gpu.num-warps" = 4 : i32} {
+
+// 128 registers of accumulator, and 80 of operands for the whole K
+// CHECK-LABEL: split_dot
+// CHECK: %[[A0_SMEM:.*]] = tensor.extract_slice %[[A:.*]][0, 0] [128, 16]
+// CHECK: %[[A0:.*]] = triton_gpu.convert_layout %[[A0_SMEM]] : (tensor<128x16xf16, #shared>) -> tensor<128x16xf16, #triton_gpu.dot_op<{opIdx = 0, parent = #mma}>>
+// CHECK: %[[B0_SMEM:.*]] = tensor.extract_slice %[[B:.*]][0, 0] [16, 128]
+// CHECK: %[[B0:.*]] = triton_gpu.convert_layout %[[B0_SMEM]]
+// CHECK: %[[D0:.*]] = tt.dot %[[A0]], %[[B0]], %[[C:.*]] {{.*}} -> tensor<128x128xf32, #mma>
+// CHECK: %[[A1_SMEM:.*]] = tensor.extract_slice %[[A]][0, 16] [128, 16]
+// CHECK: %[[A1:.*]] = triton_gpu.convert_layout %[[A1_SMEM]]
+// CHECK: %[[B1_SMEM:.*]] = tensor.extract_slice %[[B]][16, 0] [16, 128]
+// CHECK: %[[B1:.*]] = triton_gpu.convert_layout %[[B1_SMEM]]
+// CHECK: %[[D1:.*]] = tt.dot %[[A1]], %[[B1]], %[[D0]]
+// CHECK-NOT: tt.dot
+// CHECK: return %[[D1]]
+// BUDGET-LABEL: split_dot
+// BUDGET: tt.dot
+// BUDGET-NOT: tt.dot
+func @split_dot(%a : tensor<128x32xf16, #shared>, %b : tensor<32x128xf16, #shared>, %c : tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #mma> {
+  %0 = triton_gpu.convert_layout %a : (tensor<128x32xf16, #shared>) -> tensor<128x32xf16, #dot_a>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x128xf16, #shared>) -> tensor<32x128xf16, #dot_b>
+  %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<128x32xf16, #dot_a> * tensor<32x128xf16, #dot_b> -> tensor<128x128xf32, #mma>
+  return %2 : tensor<128x128xf32, #mma>
+}
+
+// Slices are as wide as the budget allows
+// BUDGET-LABEL: split_deep_dot
+// BUDGET: tensor.extract_slice %{{.*}}[0, 0] [128, 32]
+// BUDGET: tensor.extract_slice %{{.*}}[0, 0] [32, 128]
+// BUDGET: tt.dot
+// BUDGET: tensor.extract_slice %{{.*}}[0, 32] [128, 32]
+// BUDGET: tensor.extract_slice %{{.*}}[32, 0] [32, 128]
+// BUDGET: tt.dot
+// BUDGET: tensor.extract_slice %{{.*}}[0, 64] [128, 32]
+// BUDGET: tensor.extract_slice %{{.*}}[64, 0] [32, 128]
+// BUDGET: tt.dot
+// BUDGET: tensor.extract_slice %{{.*}}[0, 96] [128, 32]
+// BUDGET: tensor.extract_slice %{{.*}}[96, 0] [32, 128]
+// BUDGET: tt.dot
+// BUDGET-NOT: tt.dot
+func @split_deep_dot(%a : tensor<128x128xf16, #shared>, %b : tensor<128x128xf16, #shared>, %c : tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #mma> {
+  %0 = triton_gpu.convert_layout %a : (tensor<128x128xf16, #shared>) -> tensor<128x128xf16, #dot_a>
+  %1 = triton_gpu.convert_layout %b : (tensor<128x128xf16, #shared>) -> tensor<128x128xf16, #dot_b>
+  %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<128x128xf16, #dot_a> * tensor<128x128xf16, #dot_b> -> tensor<128x128xf32, #mma>
+  return %2 : tensor<128x128xf32, #mma>
+}
+
+// Dots within the budget are left unchanged
+// CHECK-LABEL: keep_small_dot
+// CHECK-NOT: tensor.extract_slice
+// CHECK: tt.dot
+// CHECK-NOT: tt.dot
+func @keep_small_dot(%a : tensor<64x32xf16, #shared>, %b : tensor<32x64xf16, #shared>, %c : tensor<64x64xf32, #mma>) -> tensor<64x64xf32, #mma> {
+  %0 = triton_gpu.convert_layout %a : (tensor<64x32xf16, #shared>) -> tensor<64x32xf16, #dot_a>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x64xf16, #shared>) -> tensor<32x64xf16, #dot_b>
+  %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<64x32xf16, #dot_a> * tensor<32x64xf16, #dot_b> -> tensor<64x64xf32, #mma>
+  return %2 : tensor<64x64xf32, #mma>
+}
+
+// Operands held in registers are not sliced
+// CHECK-LABEL: keep_register_operand
+// CHECK-NOT: tensor.extract_slice
+// CHECK: tt.dot
+// CHECK-NOT: tt.dot
+func @keep_register_operand(%a : tensor<128x32xf16, #mma>, %b : tensor<32x128xf16, #shared>, %c : tensor<128x128xf32, #mma>) -> tensor<128x128xf32, #mma> {
+  %0 = triton_gpu.convert_layout %a : (tensor<128x32xf16, #mma>) -> tensor<128x32xf16, #dot_a>
+  %1 = triton_gpu.convert_layout %b : (tensor<32x128xf16, #shared>) -> tensor<32x128xf16, #dot_b>
+  %2 = tt.dot %0, %1, %c {allowTF32 = true} : tensor<128x32xf16, #dot_a> * tensor<32x128xf16, #dot_b> -> tensor<128x128xf32, #mma>
+  return %2 : tensor<128x128xf32, #mma>
+}
+
+}
@@ -51,6 +51,8 @@ struct TestAxisInfoPass
         print("Divisibility", os, info.getDivisibility());
         os << " ; ";
         print("Constancy", os, info.getConstancy());
+        if (auto range = info.getRange())
+          os << " ; Range: [" << range->first << ", " << range->second << "]";
         os << " ( ";
         result.print(os);
         os << " ) ";
@@ -0,0 +1,44 @@
+#include "mlir/Pass/Pass.h"
+#include "triton/Analysis/Allocation.h"
+#include "triton/Analysis/Membar.h"
+#include "triton/Analysis/SharedMemoryReport.h"
+
+using namespace mlir;
+
+namespace {
+
+struct TestSharedMemoryReportPass
+    : public PassWrapper<TestSharedMemoryReportPass, OperationPass<FuncOp>> {
+
+  // LLVM15+
+  // MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestSharedMemoryReportPass);
+
+  StringRef getArgument() const final {
+    return "test-print-shared-memory-report";
+  }
+  StringRef getDescription() const final {
+    return "print the shared memory report of a function";
+  }
+
+  void runOnOperation() override {
+    Operation *operation = getOperation();
+    auto &os = llvm::errs();
+    // Convert to std::string can remove quotes from op_name
+    auto op_name = SymbolTable::getSymbolName(operation).getValue().str();
+    os << op_name << "\n";
+    Allocation allocation(operation);
+    MembarAnalysis membarPass(&allocation);
+    membarPass.run();
+    os << getSharedMemoryReport(allocation, membarPass) << "\n";
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace test {
+void registerTestSharedMemoryReportPass() {
+  PassRegistration<TestSharedMemoryReportPass>();
+}
+} // namespace test
+} // namespace mlir
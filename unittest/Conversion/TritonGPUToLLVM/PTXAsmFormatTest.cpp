@@ -143,5 +143,51 @@ TEST_F(PTXAsmFormatTest, onlyAttachMLIRArgs) {
   ASSERT_EQ(builder.getAllMLIRArgs().size(), 3);
 }
 
+TEST_F(PTXAsmFormatTest, sharedOperands) {
+  PTXBuilder builder(/*shareOperands=*/true);
+
+  auto &st = *builder.create("st.global.b32");
+  auto *addr0 = builder.newAddrOperand(v[1], "l", 0);
+  auto *addr1 = builder.newAddrOperand(v[1], "l", 4);
+  auto *val0 = builder.newOperand(v[2], "r");
+  auto *val1 = builder.newOperand(v[2], "r");
+  EXPECT_EQ(val0, val1);
+
+  st(addr0, val0).predicate(v[0], "b");
+  st(addr1, val1).predicateNot(v[0], "b");
+
+  EXPECT_EQ(builder.dump(), "@$2 st.global.b32 [ $0 + 0 ], $1;\n\t"
+                            "@!$2 st.global.b32 [ $0 + 4 ], $1;");
+  auto values = builder.getAllMLIRArgs();
+  ASSERT_EQ(values.size(), 3);
+  EXPECT_EQ(values[0], v[1]); // $0 -> v[1]
+  EXPECT_EQ(values[1], v[2]); // $1 -> v[2]
+  EXPECT_EQ(values[2], v[0]); // $2 -> v[0]
+  EXPECT_EQ(builder.getConstraints(), "l,r,b");
+}
+
+TEST_F(PTXAsmFormatTest, sharedConstants) {
+  PTXBuilder builder(/*shareOperands=*/true);
+
+  // A constant equal to v[2]
+  OpBuilder opBuilder(&ctx);
+  opBuilder.setInsertionPointToEnd(&block);
+  Value one =
+      opBuilder.create<arith::ConstantIntOp>(opBuilder.getUnknownLoc(), 1, 32);
+
+  auto *opr0 = builder.newOperand(v[2], "r");
+  auto *opr1 = builder.newOperand(one, "r");
+  auto *opr2 = builder.newOperand(v[3], "r");
+  EXPECT_EQ(opr0, opr1);
+  EXPECT_NE(opr0, opr2);
+  // Outputs and other constraints are not shared
+  EXPECT_NE(opr0, builder.newOperand(v[2], "l"));
+  auto *dst0 = builder.newOperand(v[4], "=r");
+  auto *dst1 = builder.newOperand(v[4], "=r");
+  EXPECT_NE(dst0, dst1);
+
+  EXPECT_EQ(builder.getAllMLIRArgs().size(), 5);
+}
+
 } // namespace triton
 } // namespace mlir